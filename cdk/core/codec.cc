@@ -35,6 +35,9 @@
 PUSH_SYS_WARNINGS_CDK
 #include <sstream>
 #include <algorithm>  // std::min
+#if defined(_MSC_VER)
+#include <intrin.h>   // _BitScanForward64()
+#endif
 POP_SYS_WARNINGS_CDK
 
 // Include Protobuf headers needed for decoding float numbers
@@ -257,6 +260,157 @@ size_t Codec<TYPE_INTEGER>::internal_from_bytes(bytes buf, T &val)
 }
 
 
+/*
+  SWAR varint decoding
+  --------------------
+  Decode a protobuf varint directly from raw bytes, without setting up
+  a CodedInputStream per value. The continuation bits of the first 8
+  bytes are examined at once in a 64-bit word and the 7-bit groups are
+  compacted with three shift-mask steps. Varints longer than 8 bytes
+  (values above 2^56), short buffers and big-endian hosts take the
+  scalar loop.
+
+  Returns the number of bytes consumed, 0 if the input is not a valid
+  varint.
+*/
+
+
+// Index of the first byte whose continuation bit is clear, given the
+// inverted continuation bit mask of an 8 byte (little-endian) word.
+
+static inline unsigned varint_terminal_byte(uint64_t cont)
+{
+  assert(cont);
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+  unsigned long bit;
+  _BitScanForward64(&bit, cont);
+  return (unsigned)(bit / 8);
+#elif defined(__GNUC__) || defined(__clang__)
+  return (unsigned)(__builtin_ctzll(cont) / 8);
+#else
+  unsigned pos = 0;
+  while (!(cont & 0x80))
+  {
+    cont >>= 8;
+    ++pos;
+  }
+  return pos;
+#endif
+}
+
+
+static inline size_t decode_varint(const byte *beg, size_t len, uint64_t &val)
+{
+  if (0 == len)
+    return 0;
+
+  // Single byte values - the common case for small integers.
+
+  if (!(*beg & 0x80))
+  {
+    val = *beg;
+    return 1;
+  }
+
+#if !CDK_BIG_ENDIAN
+
+  if (len >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, beg, sizeof(word));
+
+    uint64_t cont = ~word & UINT64_C(0x8080808080808080);
+
+    if (cont)
+    {
+      unsigned last = varint_terminal_byte(cont);
+
+      // Drop bytes after the terminal one, then the continuation bits.
+
+      if (last < 7)
+        word &= (UINT64_C(1) << (8 * (last + 1))) - 1;
+      word &= UINT64_C(0x7F7F7F7F7F7F7F7F);
+
+      // Compact the eight 7-bit groups into the low 56 bits.
+
+      word = (word & UINT64_C(0x007F007F007F007F))
+             | ((word & UINT64_C(0x7F007F007F007F00)) >> 1);
+      word = (word & UINT64_C(0x00003FFF00003FFF))
+             | ((word & UINT64_C(0x3FFF00003FFF0000)) >> 2);
+      word = (word & UINT64_C(0x000000000FFFFFFF))
+             | ((word & UINT64_C(0x0FFFFFFF00000000)) >> 4);
+
+      val = word;
+      return last + 1;
+    }
+  }
+
+#endif
+
+  // Longer varints (9-10 bytes) and buffers shorter than 8 bytes.
+
+  uint64_t result = 0;
+  unsigned shift = 0;
+
+  for (size_t i = 0; i < len && i < 10; ++i, shift += 7)
+  {
+    result |= (uint64_t)(beg[i] & 0x7F) << shift;
+    if (!(beg[i] & 0x80))
+    {
+      val = result;
+      return i + 1;
+    }
+  }
+
+  return 0;
+}
+
+
+template <typename T>
+size_t Codec<TYPE_INTEGER>::internal_from_bytes_batch(
+  const bytes *raw, size_t count, T *out
+)
+{
+  bool uns = m_fmt.is_unsigned();
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (0 == raw[i].size())
+    {
+      out[i] = 0;
+      continue;
+    }
+
+    uint64_t val_tmp;
+
+    if (!decode_varint(raw[i].begin(), raw[i].size(), val_tmp))
+      throw Error(cdkerrc::conversion_error,
+                  "Codec<TYPE_INTEGER>: integer conversion error");
+
+    out[i] = uns ? zigzag_decode_unsigned<T>(val_tmp)
+                 : zigzag_decode_signed<T>(val_tmp);
+  }
+
+  return count;
+}
+
+
+size_t Codec<TYPE_INTEGER>::from_bytes_batch(
+  const bytes *raw, size_t count, int64_t *out
+)
+{
+  return internal_from_bytes_batch(raw, count, out);
+}
+
+
+size_t Codec<TYPE_INTEGER>::from_bytes_batch(
+  const bytes *raw, size_t count, uint64_t *out
+)
+{
+  return internal_from_bytes_batch(raw, count, out);
+}
+
+
 size_t Codec<TYPE_INTEGER>::from_bytes(bytes buf, int8_t &val)
 {
   return internal_from_bytes(buf, val);
@@ -430,12 +584,116 @@ std::string Codec<TYPE_FLOAT>::internal_decimal_to_string(bytes buf)
   }
 
   if (last_digit + 1)
+  {
+    /* The decimal point can fall right before the digit in the sign byte */
+    if (total_digits - scale_digits == pos)
+      sstream << std::use_facet< std::numpunct<char> >(sstream.getloc()).decimal_point();
+
     sstream << last_digit;
+  }
 
   return sstream.str();
 }
 
 
+/*
+  Fast path for DECIMAL decoding
+  ------------------------------
+  The X protocol DECIMAL format is: one byte holding the scale, packed
+  BCD digits, and a sign nibble (0xC positive / 0xD negative) in the
+  last byte, possibly preceded by the final digit. The generic path
+  above renders the digits into a string through a stringstream and
+  calls strtod() on it, which costs a locale facet lookup and a parse
+  per value.
+
+  Here values of up to 15 significant digits - which covers typical
+  money and measurement columns - are unpacked into an int64 mantissa,
+  two digits per byte through a lookup table, and scaled with a power
+  of ten table. Both the mantissa and the divisor are exactly
+  representable as doubles in this range, so a single division yields
+  the correctly rounded result, identical to what strtod() produces.
+  Wider or malformed values fall back to the string path.
+*/
+
+struct Bcd_table
+{
+  // Value of a packed BCD byte, or -1 if either nibble is not a digit.
+
+  int16_t val[256];
+
+  Bcd_table()
+  {
+    for (unsigned b = 0; b < 256; ++b)
+    {
+      unsigned hi = b >> 4, lo = b & 0x0F;
+      val[b] = (hi > 9 || lo > 9) ? int16_t(-1) : int16_t(10 * hi + lo);
+    }
+  }
+};
+
+static const Bcd_table bcd_table;
+
+static const double pow10_table[16] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+  1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+
+bool Codec<TYPE_FLOAT>::internal_decimal_to_double(bytes buf, double &val)
+{
+  if (buf.size() < 2)
+    return false;
+
+  byte scale_digits = *buf.begin();
+  byte sign_byte = *(buf.end() - 1);
+  int last_digit = -1;
+  bool is_negative;
+
+  if ((sign_byte & 0x0C) == 0x0C)
+  {
+    last_digit = (int)(sign_byte >> 4);
+    if (last_digit > 9)
+      return false;
+    is_negative = (sign_byte & 0x0D) == 0x0D;
+  }
+  else if ((sign_byte & 0xC0) == 0xC0)
+  {
+    is_negative = (sign_byte & 0xD0) == 0xD0;
+  }
+  else
+    return false;
+
+  size_t total_digits
+    = 2 * (buf.size() - 2) + (last_digit >= 0 ? 1 : 0);
+
+  if (total_digits > 15 || total_digits <= scale_digits)
+    return false;
+
+  int64_t mant = 0;
+
+  for (const byte *b = buf.begin() + 1; b < buf.end() - 1; ++b)
+  {
+    int16_t two = bcd_table.val[*b];
+    if (two < 0)
+      return false;
+    mant = 100 * mant + two;
+  }
+
+  if (last_digit >= 0)
+    mant = 10 * mant + last_digit;
+
+  val = (double)mant / pow10_table[scale_digits];
+
+  // Note: negating the double, not the mantissa, preserves the sign of
+  // a negative zero, as produced by strtod() on the generic path.
+
+  if (is_negative)
+    val = -val;
+
+  return true;
+}
+
+
 size_t Codec<TYPE_FLOAT>::from_bytes(bytes buf, float &val)
 {
   if (m_fmt.type() == cdk::Format<cdk::TYPE_FLOAT>::DECIMAL)
@@ -472,6 +730,9 @@ size_t Codec<TYPE_FLOAT>::from_bytes(bytes buf, double &val)
 {
   if (m_fmt.type() == cdk::Format<cdk::TYPE_FLOAT>::DECIMAL)
   {
+    if (internal_decimal_to_double(buf, val))
+      return buf.size();
+
     std::string s = internal_decimal_to_string(buf);
     const char *data = s.c_str();
     char *str_end;
@@ -506,6 +767,64 @@ size_t Codec<TYPE_FLOAT>::from_bytes(bytes buf, double &val)
 }
 
 
+size_t Codec<TYPE_FLOAT>::from_bytes_batch(
+  const bytes *raw, size_t count, double *out
+)
+{
+  auto fmt = m_fmt.type();
+
+  /*
+    DECIMAL values have a string based representation - decode them
+    through the per-value path.
+  */
+
+  if (cdk::Format<cdk::TYPE_FLOAT>::DECIMAL == fmt)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      out[i] = 0;
+      if (raw[i].size())
+        from_bytes(raw[i], out[i]);
+    }
+    return count;
+  }
+
+  bool single = (cdk::Format<cdk::TYPE_FLOAT>::FLOAT == fmt);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (0 == raw[i].size())
+    {
+      out[i] = 0;
+      continue;
+    }
+
+    size_t sz;
+
+    if (single)
+    {
+      uint32_t val_tmp;
+      sz = m_cvt.from_bytes(raw[i], val_tmp);
+      if (sz < raw[i].size())
+        throw Error(cdkerrc::conversion_error,
+                    "Codec<TYPE_FLOAT>: conversion overflow");
+      out[i] = google::protobuf::internal::WireFormatLite::DecodeFloat(val_tmp);
+    }
+    else
+    {
+      uint64_t val_tmp;
+      sz = m_cvt.from_bytes(raw[i], val_tmp);
+      if (sz < raw[i].size())
+        throw Error(cdkerrc::conversion_error,
+                    "Codec<TYPE_FLOAT>: conversion overflow");
+      out[i] = google::protobuf::internal::WireFormatLite::DecodeDouble(val_tmp);
+    }
+  }
+
+  return count;
+}
+
+
 size_t Codec<TYPE_FLOAT>::to_bytes(float val, bytes buf)
 {
   if (buf.size() < sizeof(float))
@@ -32,6 +32,10 @@
 #include <mysql/cdk/session.h>
 #include <mysql/cdk/mysqlx/session.h>
 
+PUSH_SYS_WARNINGS_CDK
+#include <chrono>
+POP_SYS_WARNINGS_CDK
+
 
 namespace cdk {
 
@@ -57,10 +61,17 @@ struct Session_builder
     option_t m_status = false;
     Session_builder::ep_filter_t m_filter;
     size_t m_id;
+    ds::Multi_source *m_src;
+    std::chrono::steady_clock::time_point m_start;
 
-    ReportStatus(Session_builder::ep_filter_t filter, size_t id)
+    ReportStatus(
+      Session_builder::ep_filter_t filter, size_t id,
+      ds::Multi_source *src = nullptr
+    )
       : m_filter(filter)
       , m_id(id)
+      , m_src(src)
+      , m_start(std::chrono::steady_clock::now())
     {}
 
 
@@ -68,6 +79,28 @@ struct Session_builder
     {
       if(m_filter)
         m_filter(m_id, m_status);
+
+      /*
+        Feed the source's latency statistics used for adaptive host
+        selection: report the session setup time on success, the failure
+        otherwise.
+      */
+
+      if (m_src)
+      {
+        if (option_t::YES == m_status.state())
+        {
+          uint64_t usec = (uint64_t)
+            std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - m_start
+            ).count();
+          m_src->report_latency(m_id, usec);
+        }
+        else
+        {
+          m_src->report_failure(m_id);
+        }
+      }
     }
 
   };
@@ -81,6 +114,13 @@ struct Session_builder
   size_t                m_id = 0;
   ep_filter_t           m_filter;
 
+  /*
+    When visiting a multi source, points back at it so that connection
+    outcomes feed its latency statistics (see ds::Multi_source).
+  */
+
+  ds::Multi_source     *m_src = nullptr;
+
 
   Session_builder(bool throw_errors = false, ep_filter_t filter = nullptr)
     : m_throw_errors(throw_errors)
@@ -155,6 +195,26 @@ bool Session_builder::connect(Conn &connection)
     connection.connect();
     return true;
   }
+  catch (const Internal_error &e)
+  {
+    /*
+      Fast path for lightweight, code-only errors: failing over to the
+      next candidate host needs only the code, so no rich error object
+      is wrapped or cloned. A full Error is built from the code only if
+      this attempt's error is the one reported to the user.
+    */
+
+    error_code code = e.code();
+
+    if (m_throw_errors ||
+      code == cdkerrc::auth_failure ||
+      code == cdkerrc::protobuf_error ||
+      code == cdkerrc::tls_error)
+      throw Error(code);  // surfaced failures use the rich hierarchy
+
+    m_error.reset(new Error(code));
+    return false;
+  }
   catch (...)
   {
     // Use rethrow_error() to wrap arbitrary exception in cdk::Error.
@@ -191,14 +251,43 @@ Session_builder::operator() (
   using foundation::connection::TCPIP;
   using foundation::connection::Socket_base;
 
-  ReportStatus report_status(m_filter, id);
+  ReportStatus report_status(m_filter, id, m_src);
 
   unique_ptr<TCPIP> connection(new TCPIP(ds.host(), ds.port(),
                                options));
 
+  // Per-phase timings of the setup sequence (see mysqlx::Connect_timings).
+
+  auto phase_start = std::chrono::steady_clock::now();
+
+  auto phase_usec = [&phase_start]() -> uint64_t {
+    auto now = std::chrono::steady_clock::now();
+    uint64_t usec = (uint64_t)
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        now - phase_start
+      ).count();
+    phase_start = now;
+    return usec;
+  };
+
   if (!connect(*connection))
     return false;  // continue to next host if available
 
+  uint64_t tcp_usec = phase_usec();
+  uint64_t tls_usec = 0;
+
+  /*
+    If the authentication mechanism was left at DEFAULT and an earlier
+    session to this data source already resolved it through the fallback
+    chain, hint the session to start with the mechanism that worked
+    (see ds::Multi_source::auth_method_hint()).
+  */
+
+  ds::TCPIP::Options opts(options);
+
+  if (m_src)
+    opts.set_auth_method_hint(m_src->auth_method_hint(id));
+
 #ifdef WITH_SSL
 
   /*
@@ -224,13 +313,15 @@ Session_builder::operator() (
     // Now tls_conn owns the plain connection.
     connection.release();
 
+    tls_usec = phase_usec();
+
     /*
       Note: Order is important! We need to take ownership of tls_conn before
       calling mysqlx::Session() ctor which might throw errors.
     */
 
     m_conn.reset(tls_conn);
-    m_sess = new mysqlx::Session(*tls_conn, options);
+    m_sess = new mysqlx::Session(*tls_conn, opts);
   }
   else
 #endif
@@ -242,10 +333,17 @@ Session_builder::operator() (
       will still take care of deleting the connection object.
     */
 
-    m_sess = new mysqlx::Session(*connection, options);
+    m_sess = new mysqlx::Session(*connection, opts);
     m_conn.reset(connection.release());
   }
 
+  m_sess->set_transport_timings(tcp_usec, tls_usec);
+
+  // Remember which mechanism worked for later connects to this source.
+
+  if (m_src)
+    m_src->report_auth_method(id, m_sess->auth_method_used());
+
   m_database = options.database();
   m_id = id;
   report_status.m_status = true;
@@ -263,16 +361,35 @@ Session_builder::operator() (
   using foundation::connection::Unix_socket;
   using foundation::connection::Socket_base;
 
-  ReportStatus report_status(m_filter, id);
+  ReportStatus report_status(m_filter, id, m_src);
 
   unique_ptr<Unix_socket> connection(new Unix_socket(ds.path(), options));
 
+  auto phase_start = std::chrono::steady_clock::now();
+
   if (!connect(*connection))
     return false;  // continue to next host if available
 
-  m_sess = new mysqlx::Session(*connection, options);
+  uint64_t tcp_usec = (uint64_t)
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - phase_start
+    ).count();
+
+  // Hint the last working authentication mechanism, as for TCPIP above.
+
+  ds::Unix_socket::Options opts(options);
+
+  if (m_src)
+    opts.set_auth_method_hint(m_src->auth_method_hint(id));
+
+  m_sess = new mysqlx::Session(*connection, opts);
   m_conn.reset(connection.release());
 
+  m_sess->set_transport_timings(tcp_usec, 0);
+
+  if (m_src)
+    m_src->report_auth_method(id, m_sess->auth_method_used());
+
   m_database = options.database();
   m_id = id;
   report_status.m_status = true;
@@ -440,6 +557,7 @@ Session::Session(ds::Multi_source &ds, ep_filter_t ep_filter)
   , m_connection(NULL)
 {
   Session_builder sb(false, ep_filter);
+  sb.m_src = &ds;
 
   auto filter = [&ep_filter](size_t id) -> bool {
     if(ep_filter)
@@ -38,6 +38,8 @@ PUSH_SYS_WARNINGS_CDK
 #include <openssl/err.h>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <mutex>
 POP_SYS_WARNINGS_CDK
 #include <mysql/cdk/foundation/error.h>
 #include <mysql/cdk/foundation/connection_openssl.h>
@@ -233,16 +235,197 @@ static void throw_ssl_error(SSL* tls, int err)
 */
 
 
-connection::TLS::Options::TLS_version::TLS_version(const std::string &ver)
+bool
+connection::TLS::Options::TLS_version::parse(
+  const std::string &ver, TLS_version &out
+)
 {
 #define TLS_VERSION_GET(V,N,X,Y) \
-  if (ver == V) { m_major = X; m_minor = Y; return; }
+  if (ver == V) { out.m_major = X; out.m_minor = Y; return true; }
 
   TLS_VERSIONS(TLS_VERSION_GET)
-  throw Error(ver);
+  return false;
+}
+
+
+connection::TLS::Options::TLS_version::TLS_version(const std::string &ver)
+{
+  if (!parse(ver, *this))
+    throw Error(ver);
 }
 
 
+/*
+  Cache of TLS sessions used to resume connections with an abbreviated
+  handshake.
+
+  After a successful handshake the negotiated session (a session ticket,
+  or a TLS 1.3 PSK) is stored here keyed by the peer host name. The next
+  connection to the same host offers the cached session to the server
+  before the handshake, which avoids the extra round trip and asymmetric
+  crypto of a full handshake. The cache is shared by all connections of
+  the process; if the server refuses resumption, a full handshake is
+  performed and the cache entry is refreshed.
+*/
+
+class TLS_session_cache
+{
+  std::mutex m_mutex;
+  std::map<std::string, SSL_SESSION*> m_sessions;
+
+  TLS_session_cache()
+  {}
+
+public:
+
+  ~TLS_session_cache()
+  {
+    for (auto &it : m_sessions)
+      SSL_SESSION_free(it.second);
+  }
+
+  static TLS_session_cache& instance()
+  {
+    static TLS_session_cache cache;
+    return cache;
+  }
+
+  /*
+    Store session of the given TLS connection for later resumption.
+    Replaces previously stored session for the same key.
+  */
+
+  void store(const std::string &key, SSL *tls)
+  {
+    if (key.empty())
+      return;
+
+    // Note: SSL_get1_session() bumps the reference count, the cache
+    // keeps that reference until the entry is replaced.
+
+    SSL_SESSION *sess = SSL_get1_session(tls);
+
+    if (!sess)
+      return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = m_sessions.find(key);
+
+    if (it != m_sessions.end())
+    {
+      SSL_SESSION_free(it->second);
+      it->second = sess;
+    }
+    else
+    {
+      m_sessions[key] = sess;
+    }
+  }
+
+  /*
+    If a session is cached for the given key, offer it to the server on
+    the given not yet connected TLS object.
+  */
+
+  void resume(const std::string &key, SSL *tls)
+  {
+    if (key.empty())
+      return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = m_sessions.find(key);
+
+    // Note: SSL_set_session() bumps the reference count, the cached
+    // entry remains valid for further connections.
+
+    if (it != m_sessions.end())
+      SSL_set_session(tls, it->second);
+  }
+};
+
+
+/*
+  Cache of SSL contexts shared by connections with the same TLS
+  configuration.
+
+  Building an SSL_CTX reads and parses the CA bundle from disk and
+  processes cipher lists, which with a large trust store is a noticeable
+  per-connect cost. The context is immutable once configured (per-host
+  verification data is set on the SSL object, not the context), so one
+  context per distinct TLS configuration is built and then shared,
+  refcounted, by all connections of the process.
+
+  clear() drops the cached contexts so that subsequent connections
+  rebuild them from disk - this is how rotated certificates are picked
+  up (see TLS::reload_contexts()). Contexts still referenced by open
+  connections remain valid until those connections are closed.
+*/
+
+class TLS_ctx_cache
+{
+  std::mutex m_mutex;
+  std::map<std::string, std::shared_ptr<SSL_CTX>> m_contexts;
+
+  TLS_ctx_cache()
+  {}
+
+public:
+
+  static TLS_ctx_cache& instance()
+  {
+    static TLS_ctx_cache cache;
+    return cache;
+  }
+
+  /*
+    Key identifying all configuration that affects the constructed
+    context: whether server certificates are verified, the trust store
+    locations and any TLS version or cipher restrictions.
+  */
+
+  static std::string key(connection::TLS::Options &opts)
+  {
+    using SSL_MODE = connection::TLS::Options::SSL_MODE;
+
+    std::string key(opts.ssl_mode() >= SSL_MODE::VERIFY_CA ? "v;" : "-;");
+
+    key += opts.get_ca() + ";" + opts.get_ca_path() + ";";
+
+    for (auto &ver : opts.get_tls_versions())
+      key += std::to_string(ver.m_major) + "."
+           + std::to_string(ver.m_minor) + ",";
+    key += ";";
+
+    for (auto &suite : opts.get_ciphersuites())
+      key += suite + ",";
+
+    return key;
+  }
+
+  std::shared_ptr<SSL_CTX> get(const std::string &key)
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = m_contexts.find(key);
+    return it != m_contexts.end() ? it->second : std::shared_ptr<SSL_CTX>();
+  }
+
+  void store(const std::string &key, const std::shared_ptr<SSL_CTX> &ctx)
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_contexts[key] = ctx;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_contexts.clear();
+  }
+};
+
+
 /*
   Implementation of TLS connection class.
 */
@@ -262,7 +445,6 @@ public:
                       connection::TLS::Options options)
     : m_tcpip(tcpip)
     , m_tls(NULL)
-    , m_tls_ctx(NULL)
     , m_options(options)
   {}
 
@@ -278,9 +460,6 @@ public:
       SSL_free(m_tls);
     }
 
-    if (m_tls_ctx)
-      SSL_CTX_free(m_tls_ctx);
-
     delete m_tcpip;
   }
 
@@ -290,7 +469,12 @@ public:
 
   connection::Socket_base* m_tcpip;
   SSL* m_tls;
-  SSL_CTX* m_tls_ctx;
+
+  // Note: the context is shared with other connections which use the
+  // same TLS configuration (see TLS_ctx_cache).
+
+  std::shared_ptr<SSL_CTX> m_tls_ctx;
+
   connection::TLS::Options m_options;
 };
 
@@ -562,62 +746,95 @@ void connection_TLS_impl::do_connect()
 
   try
   {
-    const SSL_METHOD* method = SSLv23_client_method();
+    /*
+      Re-use a shared SSL context if one was already built for this TLS
+      configuration. Building a context reads and parses the CA bundle
+      from disk, so sharing it avoids that cost on every connect (see
+      TLS_ctx_cache).
+    */
 
-    if (!method)
-      throw_openssl_error();
+    std::string ctx_key = TLS_ctx_cache::key(m_options);
+
+    m_tls_ctx = TLS_ctx_cache::instance().get(ctx_key);
 
-    m_tls_ctx = SSL_CTX_new(method);
     if (!m_tls_ctx)
-      throw_openssl_error();
+    {
+      const SSL_METHOD* method = SSLv23_client_method();
 
-    // Set allowed TLS protocol versions and ciphers
+      if (!method)
+        throw_openssl_error();
 
-    {
-      // Note: copy defaults from static instance
-      TLS_helper helper(TLS_helper::m_instance);
+      SSL_CTX *ctx = SSL_CTX_new(method);
+      if (!ctx)
+        throw_openssl_error();
 
-      auto vlist = m_options.get_tls_versions();
-      if (!vlist.empty())
-        helper.set_versions(vlist);
+      m_tls_ctx = std::shared_ptr<SSL_CTX>(ctx, SSL_CTX_free);
 
-      auto clist = m_options.get_ciphersuites();
-      if (!clist.empty())
-        helper.set_ciphers(clist);
+#ifdef SSL_OP_ENABLE_KTLS
+      /*
+        Enable kernel TLS offload where the OpenSSL build supports it. Once
+        the handshake completes, symmetric record processing is then done by
+        the kernel inside the socket send/receive path, which removes one
+        user-space copy per direction and allows sendfile-style transfers.
+        If kTLS is not usable for the negotiated cipher or kernel, OpenSSL
+        falls back to user-space records transparently.
+      */
+      SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#endif
 
-      helper.setup(m_tls_ctx);
-    }
+      // Set allowed TLS protocol versions and ciphers
 
+      {
+        // Note: copy defaults from static instance
+        TLS_helper helper(TLS_helper::m_instance);
 
-    // Certificate data, if requested.
+        auto vlist = m_options.get_tls_versions();
+        if (!vlist.empty())
+          helper.set_versions(vlist);
 
-    if (
-      m_options.ssl_mode()
-      >=
-      cdk::foundation::connection::TLS::Options::SSL_MODE::VERIFY_CA
-    )
-    {
-      /*
-        Warnings must be disabled because of a bug in Visual Studio 2017 compiler:
-        https://developercommunity.visualstudio.com/content/problem/130244/c-warning-c5039-reported-for-nullptr-argument.html
-      */
-      SSL_CTX_set_verify(m_tls_ctx, SSL_VERIFY_PEER, nullptr);
+        auto clist = m_options.get_ciphersuites();
+        if (!clist.empty())
+          helper.set_ciphers(clist);
 
-      if (SSL_CTX_load_verify_locations(
-            m_tls_ctx,
-            m_options.get_ca().c_str(),
-            m_options.get_ca_path().empty()
-            ? NULL : m_options.get_ca_path().c_str()) == 0)
-        throw_openssl_error();
-    }
-    else
-    {
-      SSL_CTX_set_verify(m_tls_ctx, SSL_VERIFY_NONE, nullptr);
+        helper.setup(ctx);
+      }
+
+
+      // Certificate data, if requested.
+
+      if (
+        m_options.ssl_mode()
+        >=
+        cdk::foundation::connection::TLS::Options::SSL_MODE::VERIFY_CA
+      )
+      {
+        /*
+          Warnings must be disabled because of a bug in Visual Studio 2017 compiler:
+          https://developercommunity.visualstudio.com/content/problem/130244/c-warning-c5039-reported-for-nullptr-argument.html
+        */
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER, nullptr);
+
+        if (SSL_CTX_load_verify_locations(
+              ctx,
+              m_options.get_ca().c_str(),
+              m_options.get_ca_path().empty()
+              ? NULL : m_options.get_ca_path().c_str()) == 0)
+          throw_openssl_error();
+      }
+      else
+      {
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, nullptr);
+      }
+
+      // Note: stored only after complete configuration, so that other
+      // connections never see a partially configured context.
+
+      TLS_ctx_cache::instance().store(ctx_key, m_tls_ctx);
     }
 
     // Establish TLS connection
 
-    m_tls = SSL_new(m_tls_ctx);
+    m_tls = SSL_new(m_tls_ctx.get());
     if (!m_tls)
       throw_openssl_error();
 
@@ -627,6 +844,11 @@ void connection_TLS_impl::do_connect()
 
     SSL_set_fd(m_tls, static_cast<int>(fd));
 
+    // Offer a cached session of this host, if any, to attempt an
+    // abbreviated handshake.
+
+    TLS_session_cache::instance().resume(m_options.get_host_name(), m_tls);
+
 #ifdef HAVE_REQUIRED_X509_FUNCTIONS
     /*
       The new way of server certificate verification
@@ -648,6 +870,10 @@ void connection_TLS_impl::do_connect()
     verify_server_cert();
 #endif
 
+    // Cache the negotiated session so that future connections to this
+    // host can resume it.
+
+    TLS_session_cache::instance().store(m_options.get_host_name(), m_tls);
 
   }
   catch (...)
@@ -659,11 +885,7 @@ void connection_TLS_impl::do_connect()
       m_tls = NULL;
     }
 
-    if (m_tls_ctx)
-    {
-      SSL_CTX_free(m_tls_ctx);
-      m_tls_ctx = NULL;
-    }
+    m_tls_ctx.reset();
 
     throw;
   }
@@ -878,6 +1100,12 @@ Socket_base::Impl& TLS::get_base_impl()
 }
 
 
+void TLS::reload_contexts()
+{
+  TLS_ctx_cache::instance().clear();
+}
+
+
 TLS::Read_op::Read_op(TLS &conn, const buffers &bufs, time_t deadline)
   : IO_op(conn, bufs, deadline)
   , m_tls(conn)
@@ -899,8 +1127,17 @@ bool TLS::Read_op::do_cont()
 
 void TLS::Read_op::do_wait()
 {
+  /*
+    The retry loop spins on SSL_read() when no data is available yet, so
+    the I/O deadline (if armed) is checked explicitly on each round:
+    remaining_usec() throws Error_timeout once the deadline has passed.
+  */
+
   while (!is_completed())
+  {
+    m_tls.get_impl().remaining_usec();
     common_read();
+  }
 }
 
 
@@ -961,8 +1198,13 @@ bool TLS::Read_some_op::do_cont()
 
 void TLS::Read_some_op::do_wait()
 {
+  // See TLS::Read_op::do_wait() for the deadline check.
+
   while (!is_completed())
+  {
+    m_tls.get_impl().remaining_usec();
     common_read();
+  }
 }
 
 
@@ -1013,8 +1255,13 @@ bool TLS::Write_op::do_cont()
 
 void TLS::Write_op::do_wait()
 {
+  // See TLS::Read_op::do_wait() for the deadline check.
+
   while (!is_completed())
+  {
+    m_tls.get_impl().remaining_usec();
     common_write();
+  }
 }
 
 
@@ -1075,8 +1322,13 @@ bool TLS::Write_some_op::do_cont()
 
 void TLS::Write_some_op::do_wait()
 {
+  // See TLS::Read_op::do_wait() for the deadline check.
+
   while (!is_completed())
+  {
+    m_tls.get_impl().remaining_usec();
     common_write();
+  }
 }
 
 
@@ -34,6 +34,17 @@
 
 #include "connection_tcpip_base.h"
 #include <list>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+#ifdef __linux__
+PUSH_SYS_WARNINGS_CDK
+#include <sys/epoll.h>
+#include <errno.h>
+POP_SYS_WARNINGS_CDK
+#endif
 
 using namespace ::cdk::foundation;
 
@@ -76,6 +87,17 @@ void connection_TCPIP_impl::do_connect()
 
   m_sock = connection::detail::connect(m_host.c_str(), m_port,
                                        m_opts.get_connection_timeout());
+
+  // Apply socket tuning options requested in session settings.
+
+  detail::set_tcp_nodelay(m_sock, m_opts.get_tcp_nodelay());
+
+  if (m_opts.get_tcp_cork())
+    detail::set_tcp_cork(m_sock, true);
+
+  detail::set_buf_sizes(m_sock,
+                        m_opts.get_snd_buf_size(),
+                        m_opts.get_rcv_buf_size());
 }
 
 
@@ -120,6 +142,22 @@ void connection_Unix_socket_impl::do_connect()
 
   m_sock = connection::detail::connect(m_path.c_str(),
                                        m_opts.get_connection_timeout());
+
+  /*
+    Note: TCP options do not apply to Unix domain sockets, but kernel
+    buffer sizes do. For local connections larger buffers directly
+    reduce the number of system calls per transferred byte, so unless
+    the user configured sizes explicitly, a 256KB default is used.
+  */
+
+  const size_t default_local_buf_size = 256*1024;
+
+  size_t snd_size = m_opts.get_snd_buf_size();
+  size_t rcv_size = m_opts.get_rcv_buf_size();
+
+  detail::set_buf_sizes(m_sock,
+                        snd_size ? snd_size : default_local_buf_size,
+                        rcv_size ? rcv_size : default_local_buf_size);
 }
 
 
@@ -176,17 +214,56 @@ SRV_host::SRV_host(detail::Srv_host_detail &&detail)
 {}
 
 
+/*
+  Results of DNS+SRV queries are cached for a short time, so that a burst
+  of session creations for the same service name does not issue one DNS
+  round trip per connect. Entries expire after SRV_CACHE_TTL seconds and
+  the next lookup for the name refreshes them. An empty query result is
+  not cached, so transient resolver failures are retried.
+*/
+
+static const std::chrono::seconds SRV_CACHE_TTL(60);
+
+
 std::forward_list<SRV_host> srv_list(const std::string &host_name)
 {
- std::forward_list<SRV_host> list;
- std::forward_list<SRV_host>::const_iterator it = list.before_begin();
+  struct Cache_entry
+  {
+    std::chrono::steady_clock::time_point expires;
+    std::forward_list<SRV_host> hosts;
+  };
+
+  static std::mutex cache_mutex;
+  static std::map<std::string, Cache_entry> cache;
+
+  {
+    std::lock_guard<std::mutex> guard(cache_mutex);
+
+    auto it = cache.find(host_name);
+
+    if (it != cache.end()
+        && std::chrono::steady_clock::now() < it->second.expires)
+      return it->second.hosts;
+  }
+
+  std::forward_list<SRV_host> list;
+  std::forward_list<SRV_host>::const_iterator it = list.before_begin();
+
+  for(auto &el : detail::srv_list(host_name))
+  {
+    it = list.insert_after(it, std::move(el));
+  }
+
+  if (!list.empty())
+  {
+    std::lock_guard<std::mutex> guard(cache_mutex);
 
- for(auto &el : detail::srv_list(host_name))
- {
-   it = list.insert_after(it, std::move(el));
- }
+    Cache_entry &entry = cache[host_name];
+    entry.expires = std::chrono::steady_clock::now() + SRV_CACHE_TTL;
+    entry.hosts = list;
+  }
 
- return list;
+  return list;
 }
 
 
@@ -249,7 +326,7 @@ bool Socket_base::Read_op::do_cont()
   byte* data =buffer.begin() + m_currentBufferOffset;
   size_t buffer_size = buffer.size() - m_currentBufferOffset;
 
-  m_currentBufferOffset += detail::recv_some(impl.m_sock, data, buffer_size, 0);
+  m_currentBufferOffset += impl.recv_some(data, buffer_size, false);
 
   if (m_currentBufferOffset == buffer.size())
   {
@@ -279,7 +356,7 @@ void Socket_base::Read_op::do_wait()
     byte* data = buffer.begin() + m_currentBufferOffset;
     size_t buffer_size = buffer.size() - m_currentBufferOffset;
 
-    detail::recv(impl.m_sock, data, buffer_size); // TODO: Implement operation deadline.
+    impl.recv(data, buffer_size);  // honors the I/O deadline, if armed
 
     m_currentBufferOffset = 0;
   }
@@ -321,8 +398,8 @@ void Socket_base::Read_some_op::common_read(bool wait)
 
   const bytes& buffer = m_bufs.get_buffer(0);
 
-  // TODO: Add timeout support.
-  set_completed(detail::recv_some(impl.m_sock, buffer.begin(), buffer.size(), wait));
+  // recv_some() honors the I/O deadline, if armed.
+  set_completed(impl.recv_some(buffer.begin(), buffer.size(), wait));
 }
 
 
@@ -340,51 +417,64 @@ Socket_base::Write_op::Write_op(Socket_base &conn, const buffers &bufs, time_t d
 
 bool Socket_base::Write_op::do_cont()
 {
-  if (is_completed())
-    return true;
-
-  Impl& impl = m_conn.get_base_impl();
-
-  const bytes& buffer = m_bufs.get_buffer(m_currentBufferIdx);
-  byte* data = buffer.begin() + m_currentBufferOffset;
-  size_t buffer_size = buffer.size() - m_currentBufferOffset;
-
-  m_currentBufferOffset += detail::send_some(impl.m_sock, data, buffer_size, 0);
+  common_write(false);
 
-  if (m_currentBufferOffset == buffer.size())
-  {
-    ++m_currentBufferIdx;
+  return is_completed();
+}
 
-    if (m_currentBufferIdx == m_bufs.buf_count())
-    {
-      set_completed(m_bufs.length());
-      return true;
-    }
-  }
 
-  return false;
+void Socket_base::Write_op::do_wait()
+{
+  while (!is_completed())
+    common_write(true);
 }
 
 
-void Socket_base::Write_op::do_wait()
+/*
+  Send as much of the remaining data as the kernel accepts, handing all
+  not yet written buffers over with a single vectored send. This way a
+  pipeline of header+payload pairs costs one system call instead of one
+  per buffer.
+*/
+
+void Socket_base::Write_op::common_write(bool wait)
 {
   if (is_completed())
     return;
 
   Impl& impl = m_conn.get_base_impl();
 
-  for (unsigned int end = m_bufs.buf_count(); m_currentBufferIdx != end; ++m_currentBufferIdx)
+  // Gather the not yet written buffers, the first one possibly
+  // written in part.
+
+  std::vector<bytes> bufs;
+  bufs.reserve(m_bufs.buf_count() - m_currentBufferIdx);
+
   {
-    const bytes& buffer = m_bufs.get_buffer(m_currentBufferIdx);
-    byte* data = buffer.begin() + m_currentBufferOffset;
-    size_t buffer_size = buffer.size() - m_currentBufferOffset;
+    const bytes& first = m_bufs.get_buffer(m_currentBufferIdx);
+    bufs.push_back(bytes(first.begin() + m_currentBufferOffset,
+                         first.size() - m_currentBufferOffset));
+  }
 
-    detail::send(impl.m_sock, data, buffer_size); // TODO: Implement operation deadline.
+  for (unsigned int i = m_currentBufferIdx + 1; i < m_bufs.buf_count(); ++i)
+    bufs.push_back(m_bufs.get_buffer(i));
 
-    m_currentBufferOffset = 0;
+  size_t sent = detail::send_some(impl.m_sock, bufs.data(), bufs.size(), wait,
+                                  wait ? impl.remaining_usec() : 0);
+
+  // Advance current position by the number of bytes accepted.
+
+  m_currentBufferOffset += sent;
+
+  while (m_currentBufferIdx < m_bufs.buf_count() &&
+         m_currentBufferOffset >= m_bufs.get_buffer(m_currentBufferIdx).size())
+  {
+    m_currentBufferOffset -= m_bufs.get_buffer(m_currentBufferIdx).size();
+    ++m_currentBufferIdx;
   }
 
-  set_completed(m_bufs.length());
+  if (m_currentBufferIdx == m_bufs.buf_count())
+    set_completed(m_bufs.length());
 }
 
 
@@ -421,8 +511,8 @@ void Socket_base::Write_some_op::common_write(bool wait)
 
   const bytes& buffer = m_bufs.get_buffer(0);
 
-  // TODO: Add timeout support.
-  set_completed(detail::send_some(impl.m_sock, buffer.begin(), buffer.size(), wait));
+  set_completed(detail::send_some(impl.m_sock, buffer.begin(), buffer.size(), wait,
+                                  wait ? impl.remaining_usec() : 0));
 }
 
 
@@ -451,6 +541,26 @@ unsigned int Socket_base::get_fd() const
   return static_cast<unsigned int>(get_base_impl().m_sock);
 }
 
+void Socket_base::set_io_deadline(uint64_t budget_ms)
+{
+  get_base_impl().set_deadline(budget_ms);
+}
+
+bool Socket_base::check_alive() const
+{
+  const Impl &impl = get_base_impl();
+
+  if (!impl.is_open())
+    return false;
+
+  // Data waiting in the read-ahead buffer means the connection is in use.
+
+  if (impl.buffered() > 0)
+    return true;
+
+  return detail::is_alive(impl.m_sock);
+}
+
 bool Socket_base::eos() const
 {
   return !get_base_impl().is_open();
@@ -478,6 +588,205 @@ void Socket_base::flush()
 }
 
 
+/*
+  Implementation of the I/O event loop.
+
+  On Linux registered sockets are monitored with a persistent epoll
+  instance, so waiting for readiness costs a single epoll_wait() call
+  regardless of the number of connections. On other platforms a single
+  poll()/WSAPoll() call covering all registered sockets is used instead
+  (see detail::poll_many()).
+*/
+
+class IO_event_loop::Impl
+{
+public:
+
+  struct Entry
+  {
+    Socket_base        *conn;
+    api::Async_op_base *op;
+    IO_event_loop::Direction dir;
+  };
+
+  std::map<detail::Socket, Entry> m_entries;
+
+#ifdef __linux__
+
+  int m_epfd;
+
+  Impl()
+  {
+    m_epfd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (m_epfd < 0)
+      throw_system_error();
+  }
+
+  ~Impl()
+  {
+    ::close(m_epfd);
+  }
+
+  void watch(detail::Socket sock, IO_event_loop::Direction dir)
+  {
+    struct epoll_event ev = {};
+    ev.events = (IO_event_loop::READ == dir ? EPOLLIN : EPOLLOUT);
+    ev.data.fd = (int)sock;
+    if (::epoll_ctl(m_epfd, EPOLL_CTL_ADD, (int)sock, &ev) < 0)
+      throw_system_error();
+  }
+
+  void unwatch(detail::Socket sock)
+  {
+    // Note: socket might have been closed already, errors are ignored.
+    ::epoll_ctl(m_epfd, EPOLL_CTL_DEL, (int)sock, NULL);
+  }
+
+  void wait_ready(std::vector<detail::Socket> &ready, uint64_t timeout_usec)
+  {
+    std::vector<struct epoll_event> evs(m_entries.size());
+
+    //milliseconds
+    int timeout =
+      timeout_usec > 0 ? static_cast<int>((1000+timeout_usec) / 1000) : -1;
+
+    int result = ::epoll_wait(m_epfd, evs.data(), (int)evs.size(), timeout);
+
+    if (result < 0)
+    {
+      if (EINTR == errno)
+        return;
+      throw_system_error();
+    }
+
+    for (int i = 0; i < result; ++i)
+      ready.push_back((detail::Socket)evs[i].data.fd);
+  }
+
+#else
+
+  void watch(detail::Socket, IO_event_loop::Direction)
+  {}
+
+  void unwatch(detail::Socket)
+  {}
+
+  void wait_ready(std::vector<detail::Socket> &ready, uint64_t timeout_usec)
+  {
+    std::vector<detail::Poll_entry> entries;
+    entries.reserve(m_entries.size());
+
+    for (auto &it : m_entries)
+    {
+      detail::Poll_entry entry = {
+        it.first,
+        IO_event_loop::READ == it.second.dir ? detail::POLL_MODE_READ
+                                             : detail::POLL_MODE_WRITE,
+        false
+      };
+      entries.push_back(entry);
+    }
+
+    detail::poll_many(entries.data(), entries.size(), true, timeout_usec);
+
+    for (auto &entry : entries)
+    {
+      if (entry.ready)
+        ready.push_back(entry.sock);
+    }
+  }
+
+#endif
+};
+
+
+IO_event_loop::IO_event_loop()
+  : m_impl(new Impl())
+{}
+
+
+IO_event_loop::~IO_event_loop()
+{
+  delete m_impl;
+}
+
+
+void IO_event_loop::add(Socket_base &conn, api::Async_op_base &op,
+                        Direction dir)
+{
+  Socket_base::Impl &impl = conn.get_base_impl();
+
+  if (!impl.is_open())
+    throw Error_no_connection();
+
+  Impl::Entry entry = { &conn, &op, dir };
+
+  if (!m_impl->m_entries.emplace(impl.m_sock, entry).second)
+    throw_error("Connection is already registered with the event loop");
+
+  try
+  {
+    m_impl->watch(impl.m_sock, dir);
+  }
+  catch (...)
+  {
+    m_impl->m_entries.erase(impl.m_sock);
+    throw;
+  }
+}
+
+
+void IO_event_loop::remove(Socket_base &conn)
+{
+  const Socket_base::Impl &impl = conn.get_base_impl();
+
+  auto it = m_impl->m_entries.find(impl.m_sock);
+
+  if (it != m_impl->m_entries.end())
+  {
+    m_impl->unwatch(it->first);
+    m_impl->m_entries.erase(it);
+  }
+}
+
+
+bool IO_event_loop::empty() const
+{
+  return m_impl->m_entries.empty();
+}
+
+
+size_t IO_event_loop::run_once(uint64_t timeout_usec)
+{
+  if (m_impl->m_entries.empty())
+    return 0;
+
+  std::vector<detail::Socket> ready;
+  m_impl->wait_ready(ready, timeout_usec);
+
+  size_t completed = 0;
+
+  for (auto sock : ready)
+  {
+    auto it = m_impl->m_entries.find(sock);
+
+    if (it == m_impl->m_entries.end())
+      continue;
+
+    // Continue the operation; remove it from the loop once it completes.
+
+    if (it->second.op->cont())
+    {
+      m_impl->unwatch(sock);
+      m_impl->m_entries.erase(it);
+      ++completed;
+    }
+  }
+
+  return completed;
+}
+
+
 DIAGNOSTIC_PUSH_CDK
 #ifdef _MSC_VER
   // 4702 = unreachable code
@@ -33,6 +33,8 @@
 
 PUSH_SYS_WARNINGS_CDK
 #include <sys/types.h>
+#include <string.h>  // for memcpy
+#include <chrono>
 POP_SYS_WARNINGS_CDK
 
 #include "socket_detail.h"
@@ -51,8 +53,29 @@ class Socket_base::Impl
 public:
   typedef detail::Socket socket;
 
+  /*
+    Size of the read-ahead buffer. Incoming data is pulled from the
+    kernel in chunks of up to this size and small reads (such as message
+    headers) are then served from the buffer without a system call.
+  */
+
+  static const size_t RD_BUF_SIZE = 16*1024;
+
   socket m_sock;
 
+  byte   m_rd_buf[RD_BUF_SIZE];
+  size_t m_rd_pos = 0;    // start of buffered data
+  size_t m_rd_len = 0;    // end of buffered data
+
+  /*
+    Deadline for blocking I/O, see set_deadline(). When armed, blocking
+    reads and writes get the remaining budget as their poll timeout and
+    fail with Error_timeout instead of waiting past the deadline.
+  */
+
+  std::chrono::steady_clock::time_point m_deadline;
+  bool m_has_deadline = false;
+
   Impl()
     : m_sock(detail::NULL_SOCKET)
   {
@@ -84,7 +107,119 @@ public:
       {
       }
       m_sock = detail::NULL_SOCKET;
+      m_rd_pos = m_rd_len = 0;
+    }
+  }
+
+  /*
+    Arm a deadline `budget_ms` milliseconds from now for subsequent
+    blocking I/O on this connection, or remove it when `budget_ms` is 0.
+    Reads served from the read-ahead buffer are not affected.
+  */
+
+  void set_deadline(uint64_t budget_ms)
+  {
+    m_has_deadline = (0 != budget_ms);
+    if (m_has_deadline)
+      m_deadline = std::chrono::steady_clock::now()
+                 + std::chrono::milliseconds(budget_ms);
+  }
+
+  /*
+    Budget remaining until the deadline in microseconds, passed as the
+    poll timeout to the detail:: I/O functions. Returns 0 (meaning: no
+    timeout) when no deadline is armed, throws Error_timeout when the
+    deadline has already passed. A nearly expired deadline yields at
+    least 1, so that it is not mistaken for "no timeout".
+  */
+
+  uint64_t remaining_usec() const
+  {
+    if (!m_has_deadline)
+      return 0;
+
+    auto rest = std::chrono::duration_cast<std::chrono::microseconds>(
+      m_deadline - std::chrono::steady_clock::now()
+    ).count();
+
+    if (rest <= 0)
+      throw Error_timeout();
+
+    return static_cast<uint64_t>(rest);
+  }
+
+  /// Amount of data available in the read-ahead buffer.
+
+  size_t buffered() const
+  {
+    return m_rd_len - m_rd_pos;
+  }
+
+  /*
+    Serve a read from the read-ahead buffer. Returns the number of bytes
+    copied (can be less than requested if the buffer holds less data).
+  */
+
+  size_t read_from_buf(byte *data, size_t size)
+  {
+    size_t howmuch = buffered() < size ? buffered() : size;
+
+    memcpy(data, m_rd_buf + m_rd_pos, howmuch);
+    m_rd_pos += howmuch;
+
+    if (m_rd_pos == m_rd_len)
+      m_rd_pos = m_rd_len = 0;
+
+    return howmuch;
+  }
+
+  /*
+    Receive at most `size` bytes. Buffered data is served first; small
+    reads pull a full chunk from the kernel into the read-ahead buffer,
+    large reads go directly into the caller's buffer, with the read-ahead
+    buffer filled by the same (vectored) system call.
+  */
+
+  size_t recv_some(byte *data, size_t size, bool wait)
+  {
+    if (buffered())
+      return read_from_buf(data, size);
+
+    if (size >= RD_BUF_SIZE)
+    {
+      bytes bufs[2] = { bytes(data, size), bytes(m_rd_buf, RD_BUF_SIZE) };
+      size_t howmuch = detail::recv_some(m_sock, bufs, 2, wait,
+                                         wait ? remaining_usec() : 0);
+
+      if (howmuch > size)
+      {
+        m_rd_len = howmuch - size;
+        howmuch = size;
+      }
+
+      return howmuch;
     }
+
+    m_rd_len = detail::recv_some(m_sock, m_rd_buf, RD_BUF_SIZE, wait,
+                                 wait ? remaining_usec() : 0);
+
+    return read_from_buf(data, size);
+  }
+
+  /*
+    Receive exactly `size` bytes, blocking until all data arrived or
+    the deadline (if armed) expired.
+  */
+
+  void recv(byte *data, size_t size)
+  {
+    size_t howmuch = 0;
+
+    if (buffered())
+      howmuch = read_from_buf(data, size);
+
+    if (howmuch < size)
+      detail::recv(m_sock, data + howmuch, size - howmuch, remaining_usec());
   }
 
   std::size_t available() const
@@ -94,12 +229,12 @@ public:
 
     try
     {
-      return detail::bytes_available(m_sock);
+      return buffered() + detail::bytes_available(m_sock);
     }
     catch (...)
     {
       // We couldn't establish if there's still data to be read. Assuming there isn't.
-      return 0;
+      return buffered();
     }
   }
 
@@ -55,11 +55,46 @@ void delete_entry(Entry *e)
   delete e;
 }
 
+/*
+  Move entries pushed by add_entry() from the lock-free ingestion queue
+  into m_entries. The whole queue is claimed with a single atomic
+  exchange; it holds entries newest-first, so they are reversed into
+  arrival order.
+*/
+
+void Diagnostic_arena::collect()
+{
+  Node *head = m_incoming.exchange(nullptr, std::memory_order_acquire);
+
+  if (!head)
+    return;
+
+  size_t first = m_entries.size();
+
+  while (head)
+  {
+    m_entries.push_back(head->entry);
+    Node *done = head;
+    head = head->next;
+    delete done;
+  }
+
+  std::reverse(m_entries.begin() + first, m_entries.end());
+}
+
+
 void Diagnostic_arena::clear()
 {
+  collect();
+
+  if (m_entries.empty())
+    return;
+
   std::for_each(m_entries.begin(), m_entries.end(), delete_entry);
   m_entries.clear();
-  m_counts.clear();
+
+  for (unsigned lvl = 0; lvl <= Severity::ERROR; ++lvl)
+    m_counts[lvl].store(0, std::memory_order_relaxed);
 }
 
 
@@ -122,6 +157,8 @@ bool Diagnostic_iterator::next()
 
 const Error& Diagnostic_arena::get_error()
 {
+  collect();
+
   Entry_list::const_iterator it;
   it= std::find_if(m_entries.begin(), m_entries.end(),
                    check_level(api::Severity::ERROR));
@@ -38,6 +38,7 @@
 PUSH_SYS_WARNINGS_CDK
 #include <stdexcept>
 #include <sstream>
+#include <cstdio>
 POP_SYS_WARNINGS_CDK
 
 
@@ -51,7 +52,7 @@ using std::string;
   what().
 */
 
-const string Error::m_default_prefix = "CDK Error: ";
+const char Error::m_default_prefix[] = "CDK Error: ";
 
 
 void Error::description_materialize() const
@@ -193,6 +194,22 @@ public:
 };
 
 
+/*
+  Lightweight errors (see Internal_error in error.h)
+*/
+
+
+const char* Internal_error::what() const NOEXCEPT
+{
+  // The message is formatted on first request only.
+
+  if (!m_msg[0])
+    snprintf(m_msg, sizeof(m_msg),
+             "CDK error %s:%d", m_code.category().name(), m_code.value());
+  return m_msg;
+}
+
+
 void rethrow_error()
 {
   try {
@@ -203,6 +220,16 @@ void rethrow_error()
     // CDK errors do not need any wrapping
     throw;
   }
+  catch (const Internal_error &e)
+  {
+    /*
+      An internal error which reached a surfacing boundary - convert it
+      to a plain Error with the same code. Only now is a message
+      materialized for it.
+    */
+
+    throw Error(e.code());
+  }
   catch (const std::system_error &e)
   {
     throw Error(e);
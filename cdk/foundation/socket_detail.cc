@@ -44,11 +44,15 @@ PUSH_SYS_WARNINGS_CDK
 #include <map>
 #include <functional>
 #include <iostream>
+#include <vector>
+#include <exception>
 
 #ifndef _WIN32
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <signal.h>
 #include <sys/un.h>
+#include <sys/uio.h>
 #include <poll.h>
 #include <resolv.h>
 #include <arpa/nameser.h>
@@ -361,6 +365,53 @@ void set_nonblocking(Socket socket, bool nonblocking)
 }
 
 
+void set_tcp_nodelay(Socket socket, bool nodelay)
+{
+  int flag = nodelay ? 1 : 0;
+
+  if (::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY,
+                   (const char*)&flag, sizeof(flag)) != 0)
+    throw_socket_error();
+}
+
+
+void set_tcp_cork(Socket socket, bool cork)
+{
+#ifdef TCP_CORK
+  int flag = cork ? 1 : 0;
+
+  if (::setsockopt(socket, IPPROTO_TCP, TCP_CORK,
+                   (const char*)&flag, sizeof(flag)) != 0)
+    throw_socket_error();
+#else
+  (void)socket;
+  (void)cork;
+#endif
+}
+
+
+void set_buf_sizes(Socket socket, size_t snd_size, size_t rcv_size)
+{
+  if (snd_size > 0)
+  {
+    int size = (int)snd_size;
+
+    if (::setsockopt(socket, SOL_SOCKET, SO_SNDBUF,
+                     (const char*)&size, sizeof(size)) != 0)
+      throw_socket_error();
+  }
+
+  if (rcv_size > 0)
+  {
+    int size = (int)rcv_size;
+
+    if (::setsockopt(socket, SOL_SOCKET, SO_RCVBUF,
+                     (const char*)&size, sizeof(size)) != 0)
+      throw_socket_error();
+  }
+}
+
+
 #if defined WITH_SSL && OPENSSL_VERSION_NUMBER < 0x10100000L
 //Not needed after 1.1
 
@@ -647,85 +698,183 @@ Socket connect(const char *host_name, unsigned short port,
   }
   guard = { host_list };
 
-  // Connect to host.
-  int connect_result = SOCKET_ERROR;
+  /*
+    Connect to host.
+
+    Attempts to the resolved addresses are raced in a "happy eyeballs"
+    fashion (cf. RFC 8305): a non-blocking connect is started for the
+    first address and, if it has not completed within the stagger
+    interval, the next address is started in parallel while earlier
+    attempts continue. The first attempt which completes successfully
+    wins and all other sockets are closed. This way an unreachable or
+    slow address family (e.g. broken IPv6 routing) delays connecting by
+    the stagger interval instead of a full connect timeout.
+  */
+
+  // Interval after which next address is tried in parallel (300 ms).
+  const uint64_t attempt_delay_usec = 300000;
+
+  std::vector<Socket> pending;
   addrinfo* host = host_list;
+  std::exception_ptr last_error;
 
-  while (connect_result != 0 && host)
+  try
   {
-    try
+    while (NULL_SOCKET == socket)
     {
-      socket = detail::socket(true, host);
-      connect_result = ::connect(socket, host->ai_addr, static_cast<int>(host->ai_addrlen));
+      // Start an attempt for the next address, if any.
 
-      if (connect_result != 0)
+      if (host)
       {
-      #ifdef _WIN32
-        if (connect_result == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK)
-      #else
-        if (connect_result == SOCKET_ERROR && errno == EINPROGRESS)
-      #endif
+        Socket attempt = NULL_SOCKET;
+
+        try
         {
+          attempt = detail::socket(true, host);
+          int connect_result
+            = ::connect(attempt, host->ai_addr,
+                        static_cast<int>(host->ai_addrlen));
 
-          int select_result = 0;
+          if (0 == connect_result)
+          {
+            socket = attempt;
+          }
+#ifdef _WIN32
+          else if (WSAGetLastError() == WSAEWOULDBLOCK)
+#else
+          else if (errno == EINPROGRESS)
+#endif
+          {
+            pending.push_back(attempt);
+          }
+          else
+          {
+            throw_socket_error();
+          }
+        }
+        catch (...)
+        {
+          last_error = std::current_exception();
+          if (NULL_SOCKET != attempt)
+            close(attempt);
+        }
 
-          do{
+        host = host->ai_next;
 
-            auto timeout = duration_cast<microseconds>(
-              deadline - system_clock::now()
-            ).count();
+        if (NULL_SOCKET != socket)
+          break;
+      }
 
-            select_result = poll_one(
-                              socket, POLL_MODE_CONNECT, true,
-                              0 == timeout_usec ? 0 : timeout > 0 ? timeout : 1
-                                                                    );
-          // Note: if poll_one() returns 0 then, according to POSIX specs:
-          // A value of 0 indicates that the call timed out and no file descriptors have been selected
-          // Due to a bug on WSApool, it may return 0 even if no timeout occur..
-          // So we will check if timeout occurs and try again if not
+      if (pending.empty())
+      {
+        if (host)
+          continue;
 
-          } while ((select_result == 0) &&
-                   ((timeout_usec == 0) ||
-                    (std::chrono::system_clock::now() < deadline)
-                    )
-                   );
+        // All attempts have failed - report the last error seen.
 
-          if ((timeout_usec > 0) &&
-              (std::chrono::system_clock::now() >= deadline))
-          {
-            // Throw the error in milliseconds, which we did not adjust.
-            // Otherwise the user will be confused why the timeout
-            // in the error message is smaller than defined
-            // (original timeout minus DNS resolution time)
-            throw Connect_timeout_error(timeout_usec / 1000);
-          }
+        assert(last_error);
+        std::rethrow_exception(last_error);
+      }
 
-          if (select_result < 0)
-            throw_socket_error();
-          else
-            check_socket_error(socket);
+      /*
+        Wait for one of the pending attempts to complete, but no longer
+        than the stagger interval if further addresses can still be
+        started (and never past the overall connect deadline).
+      */
+
+      uint64_t wait_usec = host ? attempt_delay_usec : 0;
 
-          connect_result = 0;
+      if (timeout_usec > 0)
+      {
+        auto remaining = duration_cast<microseconds>(
+          deadline - system_clock::now()
+        ).count();
+
+        if (remaining <= 0)
+        {
+          // Throw the error in milliseconds, which we did not adjust.
+          // Otherwise the user will be confused why the timeout
+          // in the error message is smaller than defined
+          // (original timeout minus DNS resolution time)
+          throw Connect_timeout_error(timeout_usec / 1000);
         }
-        else
+
+        if (0 == wait_usec || (uint64_t)remaining < wait_usec)
+          wait_usec = (uint64_t)remaining;
+      }
+
+      std::vector<struct pollfd> fds(pending.size());
+
+      for (size_t i = 0; i < pending.size(); ++i)
+      {
+        fds[i].fd = pending[i];
+        fds[i].events = POLLIN | POLLOUT;
+        fds[i].revents = 0;
+      }
+
+      //milliseconds
+      int timeout =
+        wait_usec > 0 ? static_cast<int>((1000+wait_usec) / 1000) : -1;
+
+#ifdef _WIN32
+      int poll_result = ::WSAPoll(fds.data(), (ULONG)fds.size(), timeout);
+#else
+      int poll_result = ::poll(fds.data(), (nfds_t)fds.size(), timeout);
+#endif
+
+      if (poll_result < 0)
+        throw_socket_error();
+
+      // Inspect attempts which reported activity.
+
+      std::vector<Socket> still_pending;
+
+      for (size_t i = 0; i < fds.size(); ++i)
+      {
+        if (0 == fds[i].revents)
         {
-          throw_socket_error();
+          still_pending.push_back(pending[i]);
+          continue;
+        }
+
+        if (NULL_SOCKET != socket)
+        {
+          // We already have a winner, drop this attempt.
+          close(pending[i]);
+          continue;
+        }
+
+        try
+        {
+          check_socket_error(pending[i]);
+          socket = pending[i];
+        }
+        catch (...)
+        {
+          last_error = std::current_exception();
+          close(pending[i]);
         }
       }
+
+      pending.swap(still_pending);
     }
-    catch (Connect_timeout_error&)
+
+    // Close attempts which lost the race.
+
+    for (Socket s : pending)
+      close(s);
+  }
+  catch (...)
+  {
+    for (Socket s : pending)
     {
-      close(socket);
-      throw;
+      try { close(s); } catch (...) {}
     }
-    catch (...)
+    if (NULL_SOCKET != socket)
     {
-      close(socket);
-
-      host = host->ai_next;
-      if (!host)
-        throw;
+      try { close(socket); } catch (...) {}
     }
+    throw;
   }
 
   return socket;
@@ -890,6 +1039,74 @@ DIAGNOSTIC_POP_CDK
 }
 
 
+size_t poll_many(Poll_entry *entries, size_t count, bool wait,
+                 uint64_t timeout_usec)
+{
+  if (0 == count)
+    return 0;
+
+DIAGNOSTIC_PUSH_CDK
+
+#ifdef _WIN32
+  // 4548 = expression has no effect
+  // This warning is generated by FD_SET
+  DISABLE_WARNING_CDK(4548)
+#endif
+
+  std::vector<struct pollfd> fds(count);
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    fds[i].fd = entries[i].sock;
+    fds[i].revents = 0;
+    switch (entries[i].mode)
+    {
+    case POLL_MODE_CONNECT:
+      fds[i].events = POLLIN | POLLOUT;
+      break;
+    case POLL_MODE_READ:
+      fds[i].events = POLLIN;
+      break;
+    case POLL_MODE_WRITE:
+      fds[i].events = POLLOUT;
+      break;
+    }
+  }
+
+DIAGNOSTIC_POP_CDK
+
+  //milliseconds
+  int timeout =
+    !wait ? 0
+    : timeout_usec > 0 ? static_cast<int>((1000+timeout_usec) / 1000) : -1;
+
+#ifdef _WIN32
+  int result = ::WSAPoll(fds.data(), (ULONG)count, timeout);
+#else
+  int result = ::poll(fds.data(), (nfds_t)count, timeout);
+#endif
+
+  if (result < 0)
+    throw_socket_error();
+
+  size_t ready = 0;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL))
+    {
+      check_socket_error(entries[i].sock);
+    }
+
+    entries[i].ready = (fds[i].revents & fds[i].events) != 0;
+    if (entries[i].ready)
+      ++ready;
+  }
+
+  return ready;
+}
+
+
 size_t bytes_available(Socket socket)
 {
   unsigned long bytes_available;
@@ -907,7 +1124,85 @@ size_t bytes_available(Socket socket)
 }
 
 
-void recv(Socket socket, byte *buffer, size_t buffer_size)
+bool is_alive(Socket socket)
+{
+  struct pollfd fds = {};
+  fds.fd = socket;
+  fds.events = POLLIN;
+
+#ifdef _WIN32
+  int result = ::WSAPoll(&fds, 1, 0);
+#else
+  int result = ::poll(&fds, 1, 0);
+#endif
+
+  if (result < 0)
+    return true;  // could not determine the state - assume alive
+
+  if (0 == result)
+    return true;  // idle socket with no pending events
+
+  if (fds.revents & (POLLERR | POLLHUP | POLLNVAL))
+    return false;
+
+  if (fds.revents & POLLIN)
+  {
+    /*
+      Pending data on an idle connection is either a server notice or the
+      end-of-stream marker of a connection closed by the peer - peek one
+      byte (without consuming it) to tell the two apart.
+    */
+
+    char byte;
+    int len = (int)::recv(socket, &byte, 1, MSG_PEEK);
+
+    if (0 == len)
+      return false;  // orderly shutdown by the peer
+
+    if (len < 0)
+    {
+#ifdef _WIN32
+      return WSAEWOULDBLOCK == WSAGetLastError();
+#else
+      return EAGAIN == errno || EWOULDBLOCK == errno;
+#endif
+    }
+  }
+
+  return true;
+}
+
+
+/*
+  Helper for deadline handling in the blocking recv()/send() loops below.
+  Returns the budget remaining until the deadline in microseconds (at
+  least 1, so that the result is never mistaken for "no deadline") or
+  throws Error_timeout if the deadline has already passed. A zero
+  `timeout_usec` means no deadline and is returned as-is.
+*/
+
+static uint64_t remaining_budget(
+  uint64_t timeout_usec,
+  std::chrono::steady_clock::time_point start
+)
+{
+  if (0 == timeout_usec)
+    return 0;
+
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+
+  if (elapsed >= (int64_t)timeout_usec)
+    throw connection::Error_timeout();
+
+  uint64_t rest = timeout_usec - (uint64_t)elapsed;
+  return rest > 0 ? rest : 1;
+}
+
+
+void recv(Socket socket, byte *buffer, size_t buffer_size,
+          uint64_t timeout_usec)
 {
   // TODO: Investigate if more efficient implementation is possible with ::recv() and MSG_WAITALL flag.
 
@@ -915,25 +1210,31 @@ void recv(Socket socket, byte *buffer, size_t buffer_size)
     return;
 
   size_t bytes_received = 0;
+  auto start = std::chrono::steady_clock::now();
 
   while (bytes_received != buffer_size)
-    bytes_received += recv_some(socket, buffer + bytes_received, buffer_size - bytes_received, true);
+    bytes_received += recv_some(socket, buffer + bytes_received, buffer_size - bytes_received, true,
+                                remaining_budget(timeout_usec, start));
 }
 
 
-void send(Socket socket, const byte *buffer, size_t buffer_size)
+void send(Socket socket, const byte *buffer, size_t buffer_size,
+          uint64_t timeout_usec)
 {
   if (buffer_size == 0)
     return;
 
   size_t bytes_sent = 0;
+  auto start = std::chrono::steady_clock::now();
 
   while (bytes_sent != buffer_size)
-    bytes_sent += send_some(socket, buffer + bytes_sent, buffer_size - bytes_sent, true);
+    bytes_sent += send_some(socket, buffer + bytes_sent, buffer_size - bytes_sent, true,
+                            remaining_budget(timeout_usec, start));
 }
 
 
-size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait)
+size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait,
+                 uint64_t timeout_usec)
 {
   if (buffer_size == 0)
     return 0;
@@ -947,7 +1248,17 @@ size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait)
 
   size_t bytes_received = 0;
 
-  int select_result = poll_one(socket, POLL_MODE_READ, wait);
+  /*
+    Fast path: the socket is non-blocking, so for a non-waiting read we
+    can skip the poll and let recv() itself report EWOULDBLOCK. This
+    saves one system call per operation on the fetch hot path (notably
+    for loopback/Unix domain connections where data is usually ready).
+  */
+
+  int select_result = wait ? poll_one(socket, POLL_MODE_READ, true, timeout_usec) : 1;
+
+  if (0 == select_result && 0 != timeout_usec)
+    throw connection::Error_timeout();
 
   if (select_result > 0)
   {
@@ -992,7 +1303,110 @@ size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait)
 }
 
 
-size_t send_some(Socket socket, const byte *buffer, size_t buffer_size, bool wait)
+size_t recv_some(Socket socket, const bytes *bufs, size_t buf_count, bool wait,
+                 uint64_t timeout_usec)
+{
+  if (0 == buf_count)
+    return 0;
+
+  // For a single buffer the plain receive path is used.
+
+  if (1 == buf_count)
+    return recv_some(socket, bufs[0].begin(), bufs[0].size(), wait, timeout_usec);
+
+  size_t bytes_received = 0;
+
+  /*
+    Fast path: the socket is non-blocking, so for a non-waiting read we
+    can skip the poll and let recv() itself report EWOULDBLOCK. This
+    saves one system call per operation on the fetch hot path (notably
+    for loopback/Unix domain connections where data is usually ready).
+  */
+
+  int select_result = wait ? poll_one(socket, POLL_MODE_READ, true, timeout_usec) : 1;
+
+  if (0 == select_result && 0 != timeout_usec)
+    throw connection::Error_timeout();
+
+  if (select_result > 0)
+  {
+#ifdef _WIN32
+
+    std::vector<WSABUF> iov(buf_count);
+
+    for (size_t i = 0; i < buf_count; ++i)
+    {
+      iov[i].buf = reinterpret_cast<CHAR*>(bufs[i].begin());
+      iov[i].len = static_cast<ULONG>(bufs[i].size());
+    }
+
+    DWORD received = 0;
+    DWORD flags = 0;
+
+    if (::WSARecv(socket, iov.data(), (DWORD)buf_count, &received, &flags,
+                  NULL, NULL)
+        == SOCKET_ERROR)
+    {
+      if (WSAGetLastError() == WSAEWOULDBLOCK)
+      {
+        bytes_received = 0;
+      }
+      else
+      {
+        throw_socket_error();
+      }
+    }
+    else if (0 == received)
+    {
+      throw connection::Error_eos();
+    }
+    else
+    {
+      bytes_received = static_cast<size_t>(received);
+    }
+
+#else
+
+    std::vector<struct iovec> iov(buf_count);
+
+    for (size_t i = 0; i < buf_count; ++i)
+    {
+      iov[i].iov_base = bufs[i].begin();
+      iov[i].iov_len = bufs[i].size();
+    }
+
+    ssize_t recv_result = ::readv(socket, iov.data(), (int)buf_count);
+
+    if (recv_result == 0)
+    {
+      throw connection::Error_eos();
+    }
+    else if (recv_result == SOCKET_ERROR)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        bytes_received = 0;
+      }
+      else
+      {
+        throw_socket_error();
+      }
+    }
+    else
+    {
+      assert(recv_result > 0);
+      bytes_received = static_cast<size_t>(recv_result);
+    }
+
+#endif
+  }
+
+  return bytes_received;
+}
+
+
+size_t send_some(Socket socket, const byte *buffer, size_t buffer_size, bool wait,
+                 uint64_t timeout_usec)
 {
   if (buffer_size == 0)
     return 0;
@@ -1006,7 +1420,13 @@ size_t send_some(Socket socket, const byte *buffer, size_t buffer_size, bool wai
 
   size_t bytes_sent = 0;
 
-  int select_result = poll_one(socket, POLL_MODE_WRITE, wait);
+  // Fast path: skip the poll for non-waiting writes, send() reports
+  // EWOULDBLOCK itself on a non-blocking socket.
+
+  int select_result = wait ? poll_one(socket, POLL_MODE_WRITE, true, timeout_usec) : 1;
+
+  if (0 == select_result && 0 != timeout_usec)
+    throw connection::Error_timeout();
 
   if (select_result > 0)
   {
@@ -1046,6 +1466,95 @@ size_t send_some(Socket socket, const byte *buffer, size_t buffer_size, bool wai
   return bytes_sent;
 }
 
+
+size_t send_some(Socket socket, const bytes *bufs, size_t buf_count, bool wait,
+                 uint64_t timeout_usec)
+{
+  if (0 == buf_count)
+    return 0;
+
+  // For a single buffer the plain send path is used.
+
+  if (1 == buf_count)
+    return send_some(socket, bufs[0].begin(), bufs[0].size(), wait, timeout_usec);
+
+  size_t bytes_sent = 0;
+
+  // Fast path: skip the poll for non-waiting writes, send() reports
+  // EWOULDBLOCK itself on a non-blocking socket.
+
+  int select_result = wait ? poll_one(socket, POLL_MODE_WRITE, true, timeout_usec) : 1;
+
+  if (0 == select_result && 0 != timeout_usec)
+    throw connection::Error_timeout();
+
+  if (select_result > 0)
+  {
+#ifdef _WIN32
+
+    std::vector<WSABUF> iov(buf_count);
+
+    for (size_t i = 0; i < buf_count; ++i)
+    {
+      iov[i].buf = reinterpret_cast<CHAR*>(bufs[i].begin());
+      iov[i].len = static_cast<ULONG>(bufs[i].size());
+    }
+
+    DWORD sent = 0;
+
+    if (::WSASend(socket, iov.data(), (DWORD)buf_count, &sent, 0, NULL, NULL)
+        == SOCKET_ERROR)
+    {
+      if (WSAGetLastError() == WSAEWOULDBLOCK)
+      {
+        bytes_sent = 0;
+      }
+      else
+      {
+        throw_socket_error();
+      }
+    }
+    else
+    {
+      bytes_sent = static_cast<size_t>(sent);
+    }
+
+#else
+
+    std::vector<struct iovec> iov(buf_count);
+
+    for (size_t i = 0; i < buf_count; ++i)
+    {
+      iov[i].iov_base = bufs[i].begin();
+      iov[i].iov_len = bufs[i].size();
+    }
+
+    ssize_t send_result = ::writev(socket, iov.data(), (int)buf_count);
+
+    if (send_result == SOCKET_ERROR)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        bytes_sent = 0;
+      }
+      else
+      {
+        throw_socket_error();
+      }
+    }
+    else
+    {
+      assert(send_result >= 0);
+      bytes_sent = static_cast<size_t>(send_result);
+    }
+
+#endif
+  }
+
+  return bytes_sent;
+}
+
+
 std::string get_local_hostname()
 {
   char buf[1024] = {0};
@@ -112,6 +112,40 @@ enum Poll_mode
 void set_nonblocking(Socket socket, bool nonblocking);
 
 
+/**
+  Enables or disables the TCP_NODELAY option of a TCP socket.
+
+  @throw cdk::foundation::Error
+    Setting the option failed.
+*/
+
+void set_tcp_nodelay(Socket socket, bool nodelay);
+
+
+/**
+  Enables or disables the TCP_CORK option of a TCP socket.
+
+  Does nothing on platforms which do not support TCP_CORK.
+
+  @throw cdk::foundation::Error
+    Setting the option failed.
+*/
+
+void set_tcp_cork(Socket socket, bool cork);
+
+
+/**
+  Sets kernel send/receive buffer sizes (SO_SNDBUF/SO_RCVBUF) of a socket.
+
+  A size of 0 leaves the corresponding kernel default unchanged.
+
+  @throw cdk::foundation::Error
+    Setting the option failed.
+*/
+
+void set_buf_sizes(Socket socket, size_t snd_size, size_t rcv_size);
+
+
 /**
   Initialize socket system.
 
@@ -324,6 +358,49 @@ Socket listen_and_accept(unsigned short port);
 int poll_one(Socket socket, Poll_mode mode, bool wait,
              uint64_t timeout_usec = 0);
 
+
+/*
+  Entry describing single socket monitored by poll_many(). After the call,
+  `ready` is set if the requested I/O can be performed without blocking.
+*/
+
+struct Poll_entry
+{
+  Socket    sock;
+  Poll_mode mode;
+  bool      ready;
+};
+
+
+/**
+  Test I/O state of many sockets with a single system call.
+
+  Tests if data can be read from or written to each of the given sockets
+  without blocking. Unlike `poll_one`, a single call covers all sockets,
+  which avoids per-connection polling syscalls when multiplexing many
+  connections on one thread.
+
+  @param[in,out] entries
+    Array of entries describing sockets and I/O modes to be tested. The
+    `ready` flag of each entry is updated by this function.
+  @param[in] count
+    Number of entries.
+  @param[in] wait
+    If `true`, function blocks until at least one socket is ready or the
+    timeout expires. Otherwise, it returns immediately.
+  @param[in] timeout_usec
+    Timeout in microseconds. 0 means wait indefinitely.
+
+  @return
+    Number of sockets which are ready.
+
+  @throw cdk::foundation::Error
+    If after testing a socket is in an erroneous state, function throws.
+*/
+
+size_t poll_many(Poll_entry *entries, size_t count, bool wait,
+                 uint64_t timeout_usec = 0);
+
 /**
   Get the number of bytes pending read.
 
@@ -342,6 +419,30 @@ int poll_one(Socket socket, Poll_mode mode, bool wait,
 size_t bytes_available(Socket socket);
 
 
+/**
+  Check that the peer of a connected socket is still there.
+
+  Performs a non-blocking, zero round-trip liveness test: the socket is
+  polled for error conditions and, if data is pending, one byte is peeked
+  to distinguish readable data from an end-of-stream marker left by a
+  peer which closed the connection.
+
+  @param[in] socket
+    Socket to be tested.
+
+  @return
+    `false` if the connection is known to be dead (peer closed it or the
+    socket is in an erroneous state), `true` otherwise.
+
+  @note
+    This function never blocks and never throws - a socket whose state
+    can not be determined is reported as alive and any error surfaces
+    later, on the first regular I/O operation.
+*/
+
+bool is_alive(Socket socket);
+
+
 /**
   Receives data from a socket.
 
@@ -355,9 +456,15 @@ size_t bytes_available(Socket socket);
   @param[in] buffer_size
     Number of bytes that will be read from a socket. May not be larger than
     the size of `buffer`.
+  @param[in] timeout_usec
+    Deadline for the whole operation in microseconds, `0` meaning no
+    deadline. The remaining budget is re-computed before each internal
+    wait, so the limit covers all reads together, not each one.
 
   @throw cdk::foundation::connection::Error_eos
     End-of-stream encountered.
+  @throw cdk::foundation::connection::Error_timeout
+    Deadline expired before all bytes were read.
   @throw cdk::foundation::Error
     Socket read failed.
 
@@ -365,7 +472,8 @@ size_t bytes_available(Socket socket);
     This function always blocks.
 */
 
-void recv(Socket socket, byte *buffer, size_t buffer_size);
+void recv(Socket socket, byte *buffer, size_t buffer_size,
+          uint64_t timeout_usec = 0);
 
 
 /**
@@ -381,7 +489,12 @@ void recv(Socket socket, byte *buffer, size_t buffer_size);
   @param[in] buffer_size
     Number of bytes that will be sent to a socket. May not be larger than
     the size of `buffer`.
+  @param[in] timeout_usec
+    Deadline for the whole operation in microseconds, `0` meaning no
+    deadline (see `recv()`).
 
+  @throw cdk::foundation::connection::Error_timeout
+    Deadline expired before all bytes were sent.
   @throw cdk::foundation::Error
     Socket write failed.
 
@@ -389,7 +502,8 @@ void recv(Socket socket, byte *buffer, size_t buffer_size);
     This function always blocks.
 */
 
-void send(Socket socket, const byte *buffer, size_t buffer_size);
+void send(Socket socket, const byte *buffer, size_t buffer_size,
+          uint64_t timeout_usec = 0);
 
 
 /**
@@ -406,17 +520,57 @@ void send(Socket socket, const byte *buffer, size_t buffer_size);
     than the size of `buffer`.
   @param[in] wait
     If `true`, operation will block. Otherwise, data is immediately available.
+  @param[in] timeout_usec
+    For a blocking read, how long to wait for data in microseconds, `0`
+    meaning indefinitely. Ignored when `wait` is `false`.
 
   @return
     The number of bytes read from a socket.
 
   @throw cdk::foundation::connection::Error_eos
     End-of-stream encountered.
+  @throw cdk::foundation::connection::Error_timeout
+    No data arrived within `timeout_usec`.
   @throw cdk::foundation::Error
     Socket read failed.
 */
 
-size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait);
+size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait,
+                 uint64_t timeout_usec = 0);
+
+
+/**
+  Receives data into several buffers from a socket.
+
+  Vectored variant of `recv_some` which fills the buffers in order with
+  a single readv()/WSARecv() call. Used to combine reading requested data
+  with filling a read-ahead buffer in one system call.
+
+  @param[in] socket
+    Socket used for reading.
+  @param[in,out] bufs
+    Array of data buffers filled in order.
+  @param[in] buf_count
+    Number of buffers in `bufs`.
+  @param[in] wait
+    If `true`, operation will block. Otherwise, it will return immediately.
+  @param[in] timeout_usec
+    For a blocking read, how long to wait for data in microseconds, `0`
+    meaning indefinitely. Ignored when `wait` is `false`.
+
+  @return
+    The total number of bytes read from a socket.
+
+  @throw cdk::foundation::connection::Error_eos
+    End-of-stream encountered.
+  @throw cdk::foundation::connection::Error_timeout
+    No data arrived within `timeout_usec`.
+  @throw cdk::foundation::Error
+    Socket read failed.
+*/
+
+size_t recv_some(Socket socket, const bytes *bufs, size_t buf_count, bool wait,
+                 uint64_t timeout_usec = 0);
 
 
 /**
@@ -433,15 +587,54 @@ size_t recv_some(Socket socket, byte *buffer, size_t buffer_size, bool wait);
     than the size of `buffer`.
   @param[in] wait
     If `true`, operation will block. Otherwise, it will return immediately.
+  @param[in] timeout_usec
+    For a blocking write, how long to wait for kernel buffer space in
+    microseconds, `0` meaning indefinitely. Ignored when `wait` is `false`.
 
   @return
     The number of bytes sent to a socket.
 
+  @throw cdk::foundation::connection::Error_timeout
+    No buffer space became available within `timeout_usec`.
+  @throw cdk::foundation::Error
+    Socket write failed.
+*/
+
+size_t send_some(Socket socket, const byte *buffer, size_t buffer_size, bool wait,
+                 uint64_t timeout_usec = 0);
+
+
+/**
+  Sends data from several buffers to a socket.
+
+  Vectored variant of `send_some` which hands all buffers to the kernel
+  with a single writev()/WSASend() call. Used to flush a sequence of
+  header+payload pairs without per-buffer system calls.
+
+  @param[in] socket
+    Socket used for sending.
+  @param[in] bufs
+    Array of data buffers sent in order.
+  @param[in] buf_count
+    Number of buffers in `bufs`.
+  @param[in] wait
+    If `true`, operation will block. Otherwise, it will return immediately.
+  @param[in] timeout_usec
+    For a blocking write, how long to wait for kernel buffer space in
+    microseconds, `0` meaning indefinitely. Ignored when `wait` is `false`.
+
+  @return
+    The total number of bytes sent to a socket. The kernel can accept
+    less than the combined size of all buffers.
+
+  @throw cdk::foundation::connection::Error_timeout
+    No buffer space became available within `timeout_usec`.
   @throw cdk::foundation::Error
     Socket write failed.
 */
 
-size_t send_some(Socket socket, const byte *buffer, size_t buffer_size, bool wait);
+size_t send_some(Socket socket, const bytes *bufs, size_t buf_count, bool wait,
+                 uint64_t timeout_usec = 0);
 
 
 /**
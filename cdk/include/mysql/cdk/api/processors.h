@@ -98,6 +98,28 @@ public:
   virtual size_t field_data(col_count_t pos, bytes data) = 0;
 
 
+  /*
+     Optional wire passthrough mode. Before decoding a row, the processor
+     is offered the complete payload of the Mysqlx::Resultset::Row frame
+     that carries it (after de-compression), exactly as received from the
+     server. If this method returns true the frame counts as consumed and
+     no row_begin()/field_xxx()/row_end() callbacks are made for that row.
+     The default implementation declines, keeping the regular decoded
+     path. The bytes are valid only for the duration of the call.
+  */
+  virtual bool row_raw(row_count_t /*pos*/, bytes /*data*/) { return false; }
+
+
+  /*
+     Called before the field callbacks of a row whose data is backed by a
+     refcounted buffer. The argument shares ownership of that buffer: a
+     processor which stores the field_data() bytes of the row as views
+     instead of copying them keeps a copy of the slab, so that the views
+     stay valid for as long as it is held. The default ignores the offer.
+  */
+  virtual void row_slab(const foundation::shared_bytes& /*slab*/) {}
+
+
   /*
      Called when there are no more rows in the result set. Note that if a
      requested number of rows has been passed to row processor then this method
@@ -333,10 +333,29 @@ class Codec<TYPE_INTEGER>
   template <typename T>
   size_t internal_to_bytes(T val, bytes buf);
 
+  template <typename T>
+  size_t internal_from_bytes_batch(const bytes *raw, size_t count, T *out);
+
 public:
 
   Codec(const Format_info &fi) : Codec_base<TYPE_INTEGER>(fi) {}
 
+  /*
+    Batch decoding entry points used by columnar result fetch. Decode
+    count values, each given by its own byte range in raw[], into the
+    out[] array. An empty byte range (a NULL field) decodes to 0 - the
+    caller tracks NULL positions separately. Returns the number of
+    values decoded.
+
+    Unlike the from_bytes() overloads below these are not virtual and
+    decode the varint representation in place, so per-value dispatch
+    and decoder stream setup costs are paid once per column instead of
+    once per value.
+  */
+
+  size_t from_bytes_batch(const bytes *raw, size_t count, int64_t *out);
+  size_t from_bytes_batch(const bytes *raw, size_t count, uint64_t *out);
+
   virtual size_t from_bytes(bytes buf, int8_t &val);
   virtual size_t from_bytes(bytes buf, int16_t &val);
   virtual size_t from_bytes(bytes buf, int32_t &val);
@@ -366,6 +385,7 @@ class Codec<TYPE_FLOAT>
   foundation::Codec<foundation::Type::NUMBER> m_cvt;
 
   std::string internal_decimal_to_string(bytes buf);
+  bool internal_decimal_to_double(bytes buf, double &val);
 
 public:
 
@@ -373,6 +393,16 @@ public:
 
   virtual ~Codec() {}
 
+  /*
+    Batch decoding of a column of values into doubles - see
+    Codec<TYPE_INTEGER>::from_bytes_batch(). The format branch
+    (FLOAT/DOUBLE/DECIMAL) is resolved once per batch; DECIMAL values,
+    which use a string based representation, fall back to per-value
+    decoding.
+  */
+
+  size_t from_bytes_batch(const bytes *raw, size_t count, double *out);
+
   virtual size_t from_bytes(bytes buf, float &val);
   virtual size_t from_bytes(bytes buf, double &val);
 
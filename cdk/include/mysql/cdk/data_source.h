@@ -37,6 +37,9 @@ PUSH_SYS_WARNINGS_CDK
 #include <functional>
 #include <algorithm>
 #include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <random>
 #include "api/expression.h"
@@ -206,7 +209,19 @@ class Protocol_options
   };
 
   virtual auth_method_t auth_method() const = 0;
+
+  /*
+    Mechanism to try first when auth_method() is DEFAULT, typically the
+    one that worked for this data source last time (see
+    ds::Multi_source::auth_method_hint()). Unlike auth_method() it is
+    only a preference: if it fails, the usual fallback chain is walked.
+  */
+
+  virtual auth_method_t auth_method_hint() const = 0;
   virtual compression_mode_t compression() const = 0;
+  virtual int compression_level() const = 0;
+  virtual bool compression_long_matching() const = 0;
+  virtual int compression_window_log() const = 0;
 
   using Compression_algorithms = std::vector<compression_algorithm_t>;
   virtual const Compression_algorithms& compression_algorithms() const = 0;
@@ -225,9 +240,13 @@ public:
 protected:
 
   auth_method_t m_auth_method = DEFAULT;
+  auth_method_t m_auth_hint = DEFAULT;
   compression_mode_t m_compression = PREFERRED;
   bool m_has_compression_alg = false;
   Compression_algorithms m_compression_algorithms;
+  int m_compression_level = -1;
+  bool m_compression_ldm = false;
+  int m_compression_window_log = 0;
 
 public:
 
@@ -248,6 +267,16 @@ public:
     return m_auth_method;
   }
 
+  void set_auth_method_hint(auth_method_t auth_method)
+  {
+    m_auth_hint = auth_method;
+  }
+
+  auth_method_t auth_method_hint() const
+  {
+    return m_auth_hint;
+  }
+
   void set_compression(compression_mode_t val)
   {
     m_compression = val;
@@ -258,6 +287,49 @@ public:
     return m_compression;
   }
 
+  /*
+    Compression effort level passed to the negotiated algorithm.
+    Negative value (the default) keeps the algorithm's default level;
+    the meaning of other values is algorithm specific.
+  */
+
+  void set_compression_level(int level)
+  {
+    m_compression_level = level;
+  }
+
+  int compression_level() const
+  {
+    return m_compression_level;
+  }
+
+  /*
+    Zstd long distance matching and match window size (as a power of
+    two), for bulk transfer sessions. Ignored when another compression
+    algorithm is negotiated. Zero window log (the default) keeps the
+    window implied by the compression level.
+  */
+
+  void set_compression_long_matching(bool enable)
+  {
+    m_compression_ldm = enable;
+  }
+
+  bool compression_long_matching() const
+  {
+    return m_compression_ldm;
+  }
+
+  void set_compression_window_log(int wlog)
+  {
+    m_compression_window_log = wlog;
+  }
+
+  int compression_window_log() const
+  {
+    return m_compression_window_log;
+  }
+
   void add_compression_alg(compression_algorithm_t val)
   {
     m_has_compression_alg = true;
@@ -471,8 +543,156 @@ namespace ds {
     DS_list m_ds_list;
     uint32_t m_total_weight = 0;
 
+    /*
+      Per-host latency statistics used by the adaptive selection mode
+      (see visit()). They are fed through report_latency() and
+      report_failure() by whoever creates connections from this data
+      source.
+    */
+
+    struct Host_stats
+    {
+      double ewma_usec = 0;  // EWMA of reported latencies
+      double ramp = 1;       // slow-start factor in (0,1]
+      bool   valid = false;  // whether ewma_usec holds any samples
+    };
+
+    struct Latency_stats
+    {
+      std::mutex m_mutex;
+      std::map<size_t, Host_stats> m_stats;
+    };
+
+    /*
+      Note: shared between copies of this multi source, so that latencies
+      observed through one copy (e.g. held by a session pool) inform host
+      selection done through another.
+    */
+
+    std::shared_ptr<Latency_stats> m_latency{ new Latency_stats() };
+
+    /*
+      Last authentication mechanism that worked per data source, fed
+      through report_auth_method() by whoever creates sessions from this
+      source. When the mechanism is left at DEFAULT over a non-secure
+      connection, authentication walks a fallback chain (MYSQL41, then
+      SHA256_MEMORY) and a failed probe costs a server round trip on
+      every connect; the cache lets later connects to the same source
+      start with the mechanism known to work (see Session_builder in
+      core/session.cc).
+    */
+
+    struct Auth_stats
+    {
+      std::mutex m_mutex;
+      std::map<size_t, mysqlx::Protocol_options::auth_method_t> m_method;
+    };
+
+    // Note: shared between copies, like the latency statistics above.
+
+    std::shared_ptr<Auth_stats> m_auth{ new Auth_stats() };
+
+    bool m_adaptive = true;
+
+    // EWMA smoothing factor for latency samples.
+
+    static constexpr double EWMA_WEIGHT = 0.2;
+
+    // Initial slow-start factor of a host which recovers after a failure.
+
+    static constexpr double SLOW_START = 1.0 / 16;
+
+    /*
+      Smallest selection weight factor of a slow host - keeping it above
+      zero lets a trickle of traffic observe the host recovering.
+    */
+
+    static constexpr double MIN_FACTOR = 0.05;
+
   public:
 
+    /*
+      Report an observed latency (in microseconds) for the data source
+      with the given identifier. Connect times as well as statement
+      round-trip times can be reported - the adaptive selection mode only
+      compares hosts against each other, so any consistently reported
+      signal works.
+    */
+
+    void report_latency(size_t id, uint64_t usec)
+    {
+      std::lock_guard<std::mutex> guard(m_latency->m_mutex);
+      Host_stats &stats = m_latency->m_stats[id];
+
+      if (!stats.valid)
+      {
+        stats.ewma_usec = double(usec);
+        stats.valid = true;
+      }
+      else
+      {
+        stats.ewma_usec += EWMA_WEIGHT * (double(usec) - stats.ewma_usec);
+      }
+
+      // A recovering host ramps back to its full weight, one step per
+      // successful report.
+
+      if (stats.ramp < 1)
+        stats.ramp = std::min(1.0, 2 * stats.ramp);
+    }
+
+    /*
+      Report a failure of the data source with the given identifier. Its
+      latency history is dropped (it is stale by now) and when the host
+      comes back it re-enters selection in slow-start, so that a barely
+      recovered host is not flooded with its full weighted share at once.
+    */
+
+    void report_failure(size_t id)
+    {
+      std::lock_guard<std::mutex> guard(m_latency->m_mutex);
+      Host_stats &stats = m_latency->m_stats[id];
+      stats.valid = false;
+      stats.ramp = SLOW_START;
+    }
+
+    /*
+      Record the authentication mechanism that succeeded for the data
+      source with the given identifier.
+    */
+
+    void report_auth_method(size_t id,
+                            mysqlx::Protocol_options::auth_method_t am)
+    {
+      std::lock_guard<std::mutex> guard(m_auth->m_mutex);
+      m_auth->m_method[id] = am;
+    }
+
+    /*
+      The authentication mechanism that last worked for the given data
+      source, DEFAULT if none was recorded yet.
+    */
+
+    mysqlx::Protocol_options::auth_method_t auth_method_hint(size_t id)
+    {
+      std::lock_guard<std::mutex> guard(m_auth->m_mutex);
+      auto it = m_auth->m_method.find(id);
+      if (it == m_auth->m_method.end())
+        return mysqlx::Protocol_options::DEFAULT;
+      return it->second;
+    }
+
+    /*
+      Enable or disable latency-aware host selection (enabled by
+      default). When disabled, hosts are selected using the static
+      weights only.
+    */
+
+    void set_adaptive(bool flag)
+    {
+      m_adaptive = flag;
+    }
+
     // Add data source without explicit priority.
 
     template <class DS_t, class DS_opt>
@@ -552,7 +772,7 @@ namespace ds {
 
       std::random_device rnd;
       bool stop_processing = false;
-      std::vector<uint16_t> weights;
+      std::vector<double> weights;
       std::set<std::pair<size_t,DS_variant&>> same_prio;
 
       for (auto it = m_ds_list.begin(); !stop_processing;)
@@ -590,6 +810,61 @@ namespace ds {
             for (auto& w : weights)
               w = 1;
           }
+
+          /*
+            Adaptive mode: bias selection towards currently-fast hosts by
+            scaling each static weight with the ratio of the fastest
+            latency observed in this priority group to the host's own
+            latency, floored at MIN_FACTOR so that a slow host still gets
+            a trickle of traffic which can observe it recovering. Hosts
+            without latency samples keep their static weight (a new host
+            should receive traffic so its latency gets measured), and the
+            slow-start factor dampens hosts which recently failed.
+          */
+
+          if (m_adaptive && weights.size() > 1)
+          {
+            std::map<size_t, Host_stats> stats;
+            {
+              std::lock_guard<std::mutex> guard(m_latency->m_mutex);
+              stats = m_latency->m_stats;
+            }
+
+            double fastest = 0;
+
+            for (auto &el : same_prio)
+            {
+              auto it_st = stats.find(el.first);
+              if (it_st != stats.end() && it_st->second.valid &&
+                  (0 == fastest || it_st->second.ewma_usec < fastest))
+                fastest = it_st->second.ewma_usec;
+            }
+
+            size_t pos = 0;
+
+            for (auto &el : same_prio)
+            {
+              auto it_st = stats.find(el.first);
+
+              if (it_st != stats.end())
+              {
+                double factor = it_st->second.ramp;
+
+                if (it_st->second.valid && fastest > 0 &&
+                    it_st->second.ewma_usec > 0)
+                {
+                  double ratio = fastest / it_st->second.ewma_usec;
+                  if (ratio < MIN_FACTOR)
+                    ratio = MIN_FACTOR;
+                  factor *= ratio;
+                }
+
+                weights[pos] *= factor;
+              }
+
+              ++pos;
+            }
+          }
         }
 
         for (size_t size = same_prio.size(); size > 0; size = same_prio.size())
@@ -665,8 +940,10 @@ namespace ds {
       DNS_SRV_source dns_srv(name, opts);
       Multi_source   src = dns_srv.get();
 
-    Note: Each call to get() issues new DNS query and can result in
-    different list of sources.
+    Note: Results of DNS queries are cached for a short time (see
+    foundation srv_list()), so a call to get() issues a new DNS query
+    only if the cached result for the name has expired. The returned
+    list of sources can change between calls.
   */
 
   class DNS_SRV_source
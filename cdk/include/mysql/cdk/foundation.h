@@ -33,6 +33,11 @@
 
 #include "foundation/common.h"
 #include "foundation/types.h"
+#include "foundation/allocator.h"
+#include "foundation/alloc_stats.h"
+#include "foundation/probes.h"
+#include "foundation/cpu_dispatch.h"
+#include "foundation/escape.h"
 #include "foundation/error.h"
 #include "foundation/async.h"
 #include "foundation/stream.h"
@@ -57,6 +62,7 @@ namespace cdk {
   using foundation::opt;
 
   using foundation::bytes;
+  using foundation::shared_bytes;
   using foundation::buffers;
 
   using foundation::Error;
@@ -66,7 +72,9 @@ namespace cdk {
   using foundation::error_code;
   using foundation::errc;
   using foundation::cdkerrc;
+  using foundation::Internal_error;
   using foundation::throw_error;
+  using foundation::throw_code;
   using foundation::throw_posix_error;
   using foundation::throw_system_error;
   using foundation::rethrow_error;
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDK_FOUNDATION_ALLOC_STATS_H
+#define SDK_FOUNDATION_ALLOC_STATS_H
+
+/*
+  Allocation-tracking instrumentation
+  ===================================
+
+  Containers on the hot paths (row buffers, result metadata, statement
+  parameters) declare their allocator as Tracking_allocator<T>, which
+  obtains memory through the pluggable entry points of allocator.h (the
+  global operator new unless an allocator was registered). When the code
+  is built with the ALLOC_STATS option (cmake -DALLOC_STATS=ON) every
+  allocation made through these containers additionally increments a
+  process-wide counter which can be read with alloc_stats_count() and is
+  surfaced through the session statistics APIs.
+
+  The counter measures allocation count, not size: the number of heap
+  allocations per operation is a stable, repeatable quantity and a good
+  leading indicator of latency regressions, while sizes and timings are
+  noisy. Benchmarks snapshot the counter around an operation and assert
+  on the difference.
+*/
+
+#include "common.h"
+#include "allocator.h"
+
+PUSH_SYS_WARNINGS_CDK
+#include <stdint.h>
+#ifdef ALLOC_STATS
+#include <atomic>
+#endif
+POP_SYS_WARNINGS_CDK
+
+
+namespace cdk {
+namespace foundation {
+
+#ifdef ALLOC_STATS
+
+/*
+  Note: the counter lives in a function-local static so that no
+  dedicated translation unit is needed and the header works in every
+  build configuration. It is atomic because results can be fetched from
+  background threads.
+*/
+
+inline
+std::atomic<uint64_t>& alloc_stats_counter()
+{
+  static std::atomic<uint64_t> count(0);
+  return count;
+}
+
+inline
+uint64_t alloc_stats_count()
+{
+  return alloc_stats_counter().load(std::memory_order_relaxed);
+}
+
+
+#else  // !ALLOC_STATS
+
+
+inline
+uint64_t alloc_stats_count()
+{
+  return 0;
+}
+
+
+#endif
+
+
+template <typename T>
+class Tracking_allocator
+{
+public:
+
+  typedef T value_type;
+
+  Tracking_allocator() noexcept
+  {}
+
+  template <typename U>
+  Tracking_allocator(const Tracking_allocator<U>&) noexcept
+  {}
+
+  T* allocate(size_t howmany)
+  {
+#ifdef ALLOC_STATS
+    alloc_stats_counter().fetch_add(1, std::memory_order_relaxed);
+#endif
+    return (T*)alloc_bytes(howmany * sizeof(T));
+  }
+
+  void deallocate(T *ptr, size_t howmany) noexcept
+  {
+    free_bytes(ptr, howmany * sizeof(T));
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const Tracking_allocator<T>&, const Tracking_allocator<U>&)
+{ return true; }
+
+template <typename T, typename U>
+bool operator!=(const Tracking_allocator<T>&, const Tracking_allocator<U>&)
+{ return false; }
+
+
+}}  // cdk::foundation
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDK_FOUNDATION_ALLOCATOR_H
+#define SDK_FOUNDATION_ALLOCATOR_H
+
+/*
+  Pluggable allocator for connector-internal storage
+  ==================================================
+
+  The containers on the hot paths (row buffers, result metadata,
+  statement parameters - everything declared with Tracking_allocator,
+  see alloc_stats.h) obtain their memory through alloc_bytes() and
+  free_bytes() below. By default these call the global operator new and
+  operator delete. An embedding application can redirect them, for
+  example to a dedicated jemalloc arena, to keep connector memory
+  segregated and accounted separately from its own:
+
+    static cdk::foundation::Allocator_fns my_arena
+      = { &arena_alloc, &arena_free };
+
+    cdk::foundation::set_allocator(&my_arena);
+
+  The registered structure must have static storage duration and must be
+  installed before the connector is first used and never changed while
+  any connector object exists - memory allocated through one set of
+  functions is freed through the functions registered at that later
+  time. Passing nullptr restores the default.
+
+  Note: the I/O buffer pool of the protocol layer is not routed through
+  this hook - it relies on realloc() and on huge-page aligned
+  allocation (see Buffer_pool).
+*/
+
+#include "common.h"
+
+PUSH_SYS_WARNINGS_CDK
+#include <stddef.h>
+#include <new>
+#include <atomic>
+POP_SYS_WARNINGS_CDK
+
+
+namespace cdk {
+namespace foundation {
+
+
+struct Allocator_fns
+{
+  void* (*alloc)(size_t size);
+  void  (*dealloc)(void *ptr, size_t size);
+};
+
+
+/*
+  Note: the registration slot lives in a function-local static so that
+  no dedicated translation unit is needed. It is atomic because
+  connector background threads (pool maintenance, fetch-ahead) allocate
+  concurrently with application threads.
+*/
+
+inline
+std::atomic<const Allocator_fns*>& allocator_fns()
+{
+  static std::atomic<const Allocator_fns*> fns(nullptr);
+  return fns;
+}
+
+
+inline
+void set_allocator(const Allocator_fns *fns)
+{
+  allocator_fns().store(fns, std::memory_order_release);
+}
+
+
+inline
+void* alloc_bytes(size_t size)
+{
+  const Allocator_fns *fns
+    = allocator_fns().load(std::memory_order_acquire);
+
+  if (fns)
+    return fns->alloc(size);
+
+  return ::operator new(size);
+}
+
+
+inline
+void free_bytes(void *ptr, size_t size) noexcept
+{
+  const Allocator_fns *fns
+    = allocator_fns().load(std::memory_order_acquire);
+
+  if (fns)
+    fns->dealloc(ptr, size);
+  else
+    ::operator delete(ptr);
+}
+
+
+}}  // cdk::foundation
+
+#endif
@@ -33,6 +33,8 @@
 
 #include "types.h"   // for nocopy
 #include <stddef.h>  // for NULL
+#include <vector>
+#include <algorithm>
 
 namespace cdk {
 namespace foundation {
@@ -114,6 +116,81 @@ class Async_op<void>
 };
 
 
+/**
+  Helper which drives several asynchronous operations on the calling
+  thread.
+
+  Operations, typically belonging to different sessions, are registered
+  with add() and then progressed together: each call to cont_all()
+  performs one continuation round over all pending operations, removing
+  the ones which completed. Method wait_all() repeats rounds until every
+  registered operation is done. This way one thread multiplexes the work
+  of many sessions instead of blocking inside wait() of each operation
+  in turn.
+
+  Note: the driver does not own the operations; they must stay alive
+  until they complete or are removed. For blocking on socket readiness
+  across many connections see connection::IO_event_loop.
+*/
+
+class Async_driver : nocopy
+{
+  std::vector<Async_op_base*> m_ops;
+
+public:
+
+  /// Register an operation to be driven.
+
+  void add(Async_op_base &op)
+  {
+    m_ops.push_back(&op);
+  }
+
+  /// Remove an operation without waiting for its completion.
+
+  void remove(Async_op_base &op)
+  {
+    m_ops.erase(std::remove(m_ops.begin(), m_ops.end(), &op), m_ops.end());
+  }
+
+  /// Number of operations which have not completed yet.
+
+  size_t pending() const
+  {
+    return m_ops.size();
+  }
+
+  /**
+    Perform one continuation round over all pending operations.
+
+    Returns true if all registered operations have completed.
+  */
+
+  bool cont_all()
+  {
+    auto it = m_ops.begin();
+
+    while (it != m_ops.end())
+    {
+      if ((*it)->cont())
+        it = m_ops.erase(it);
+      else
+        ++it;
+    }
+
+    return m_ops.empty();
+  }
+
+  /// Drive rounds until all registered operations complete.
+
+  void wait_all()
+  {
+    while (!cont_all())
+    {}
+  }
+};
+
+
 }}} // cdk::foundation::api
 
 #endif
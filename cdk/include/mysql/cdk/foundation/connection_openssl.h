@@ -61,6 +61,15 @@ public:
     return true;
   }
 
+  /*
+    Drop the cached SSL contexts shared between connections, so that
+    subsequent connections rebuild them from the files on disk. Call
+    after rotating CA or client certificates. Already established
+    connections are not affected.
+  */
+
+  static void reload_contexts();
+
   class Read_op;
   class Read_some_op;
   class Write_op;
@@ -105,6 +114,15 @@ public:
 
     TLS_version(const std::string &);
 
+    /*
+      Parse a version name into `ver` without throwing, returning false
+      if it is not recognized. Used when probing a user-supplied version
+      list, where rejected entries are expected and should not pay for
+      error object construction.
+    */
+
+    static bool parse(const std::string &, TLS_version &ver);
+
     // Note: needed for STL containers
     bool operator<(const TLS_version &other) const
     {
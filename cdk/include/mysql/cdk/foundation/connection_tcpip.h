@@ -167,6 +167,8 @@ public:
   virtual void connect();
   virtual void close();
   virtual bool is_closed() const;
+  virtual bool check_alive() const;
+  virtual void set_io_deadline(uint64_t budget_ms);
   virtual unsigned int get_fd() const;
 
   // Input stream
@@ -191,6 +193,7 @@ protected:
   friend class IO_op;
   friend class TCPIP;
   friend class TLS;
+  friend class IO_event_loop;
 };
 
 
@@ -201,6 +204,21 @@ class Socket_base::Options
     // By default the timeout is 10 seconds
     uint64_t m_timeout_usec = DEFAULT_CN_TIMEOUT_US;
 
+    /*
+      Socket tuning knobs applied when the connection is established.
+
+      TCP_NODELAY is enabled by default: the X Protocol is request/reply
+      oriented and sends are already batched by the protocol layer, so
+      Nagle's algorithm only adds latency. TCP_CORK (where available)
+      can be enabled for bulk-transfer workloads which prefer full
+      segments over latency. Buffer sizes of 0 keep kernel defaults.
+    */
+
+    bool   m_tcp_nodelay = true;
+    bool   m_tcp_cork = false;
+    size_t m_snd_buf_size = 0;
+    size_t m_rcv_buf_size = 0;
+
   public:
 
     Options()
@@ -216,6 +234,38 @@ class Socket_base::Options
     {
       m_timeout_usec = timeout_usec;
     }
+
+    bool get_tcp_nodelay() const
+    { return m_tcp_nodelay; }
+
+    void set_tcp_nodelay(bool nodelay)
+    {
+      m_tcp_nodelay = nodelay;
+    }
+
+    bool get_tcp_cork() const
+    { return m_tcp_cork; }
+
+    void set_tcp_cork(bool cork)
+    {
+      m_tcp_cork = cork;
+    }
+
+    size_t get_snd_buf_size() const
+    { return m_snd_buf_size; }
+
+    void set_snd_buf_size(size_t size)
+    {
+      m_snd_buf_size = size;
+    }
+
+    size_t get_rcv_buf_size() const
+    { return m_rcv_buf_size; }
+
+    void set_rcv_buf_size(size_t size)
+    {
+      m_rcv_buf_size = size;
+    }
 };
 
 class TCPIP
@@ -259,6 +309,69 @@ private:
 #endif //_WIN32
 
 
+/**
+  Event loop which multiplexes I/O operations of many connections on
+  a single thread.
+
+  Asynchronous operations created for different connections are registered
+  with add() together with the I/O direction they wait for. A call to
+  run_once() waits, with a single system call covering all registered
+  sockets (epoll on Linux, poll elsewhere), until some of them become ready
+  and then continues only the operations which can make progress. Operations
+  which complete during the round are removed from the loop.
+
+  This way many concurrent sessions can be driven by one thread instead of
+  dedicating an OS thread to each active connection.
+*/
+
+class IO_event_loop : nocopy
+{
+public:
+
+  /// I/O direction an operation is waiting for.
+
+  enum Direction { READ, WRITE };
+
+  IO_event_loop();
+  ~IO_event_loop();
+
+  /**
+    Register asynchronous operation of the given connection. The operation
+    will be continued by run_once() whenever the connection's socket is
+    ready for the given I/O direction. Only one operation per connection
+    can be registered at a time.
+  */
+
+  void add(Socket_base &conn, api::Async_op_base &op, Direction dir);
+
+  /// Remove registered operation of the given connection, if any.
+
+  void remove(Socket_base &conn);
+
+  /// Return true if no operations are registered with the loop.
+
+  bool empty() const;
+
+  /**
+    Wait until some of the monitored sockets become ready and continue
+    the corresponding operations.
+
+    @param[in] timeout_usec
+      Timeout in microseconds. 0 means wait indefinitely.
+
+    @return
+      Number of operations which completed during this round.
+  */
+
+  size_t run_once(uint64_t timeout_usec = 0);
+
+private:
+
+  class Impl;
+  Impl *m_impl;
+};
+
+
 // Socket_base
 
 class Socket_base::IO_op : public Base::IO_op
@@ -319,6 +432,8 @@ public:
   virtual void do_wait();
 
 private:
+  void common_write(bool wait);
+
   unsigned int m_currentBufferIdx;
   size_t m_currentBufferOffset;
 };
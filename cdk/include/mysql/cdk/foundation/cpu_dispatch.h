@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDK_FOUNDATION_CPU_DISPATCH_H
+#define SDK_FOUNDATION_CPU_DISPATCH_H
+
+/*
+  Runtime CPU feature dispatch
+  ============================
+
+  Performance kernels (the transcoding fast paths of string.h, the scan
+  kernels of the tokenizer, future vectorized decoders) come in variants
+  for different instruction set levels. The same binary runs on CPU
+  generations ranging from the compile-time baseline up to recent AVX
+  capable parts, so a kernel picks its variant at run-time:
+
+    if (cpu_features().avx2)
+      ... AVX2 variant ...
+
+  Features are detected with CPUID on the first call and cached, so the
+  test compiles to a load and a branch. A kernel which resolves its
+  variant into a function pointer (or a file-scope flag) evaluated once
+  keeps even that off its hot path.
+
+  Setting the environment variable CDK_CPU_BASELINE (to any value)
+  reports every feature as absent, which forces each kernel consulting
+  the dispatch onto its portable path - useful for ruling the vector
+  paths in or out when chasing a miscompare or a regression.
+
+  On architectures without CPUID (or unknown compilers) all optional
+  features read as absent and only compile-time selected code runs.
+*/
+
+#include "common.h"
+
+PUSH_SYS_WARNINGS_CDK
+#include <stdlib.h>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CDK_CPUID_MSVC
+#elif (defined(__GNUC__) || defined(__clang__)) \
+      && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define CDK_CPUID_GCC
+#endif
+POP_SYS_WARNINGS_CDK
+
+
+namespace cdk {
+namespace foundation {
+
+
+struct Cpu_features
+{
+  bool sse2 = false;
+  bool ssse3 = false;
+  bool sse4_2 = false;
+  bool avx2 = false;
+  bool avx512bw = false;
+};
+
+
+inline
+Cpu_features detect_cpu_features()
+{
+  Cpu_features f;
+
+#if defined(CDK_CPUID_MSVC) || defined(CDK_CPUID_GCC)
+
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+#if defined(CDK_CPUID_MSVC)
+  int regs[4];
+  __cpuid(regs, 0);
+  unsigned int max_leaf = (unsigned int)regs[0];
+  __cpuid(regs, 1);
+  ecx = (unsigned int)regs[2];
+  edx = (unsigned int)regs[3];
+#else
+  unsigned int max_leaf = __get_cpuid_max(0, nullptr);
+  if (max_leaf < 1)
+    return f;
+  __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+#endif
+
+  f.sse2   = 0 != (edx & (1u << 26));
+  f.ssse3  = 0 != (ecx & (1u << 9));
+  f.sse4_2 = 0 != (ecx & (1u << 20));
+
+  /*
+    AVX features additionally require OS support for saving the extended
+    register state, reported through OSXSAVE + XGETBV.
+  */
+
+  bool ymm_ok = false;
+
+  if ((ecx & (1u << 27)) && (ecx & (1u << 28)))  // OSXSAVE and AVX
+  {
+#if defined(CDK_CPUID_MSVC)
+    unsigned long long xcr0 = _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+    unsigned long long xcr0 = ((unsigned long long)hi << 32) | lo;
+#endif
+    ymm_ok = 0x6 == (xcr0 & 0x6);           // XMM and YMM state enabled
+  }
+
+  if (ymm_ok && max_leaf >= 7)
+  {
+#if defined(CDK_CPUID_MSVC)
+    __cpuidex(regs, 7, 0);
+    ebx = (unsigned int)regs[1];
+#else
+    __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx);
+#endif
+    f.avx2     = 0 != (ebx & (1u << 5));
+    f.avx512bw = 0 != (ebx & (1u << 30));
+  }
+
+#endif  // CDK_CPUID_MSVC || CDK_CPUID_GCC
+
+  return f;
+}
+
+
+/*
+  Features of the CPU this process runs on, detected once on first use.
+  With CDK_CPU_BASELINE set in the environment an empty feature set is
+  reported instead, see above.
+*/
+
+inline
+const Cpu_features& cpu_features()
+{
+  static const Cpu_features features
+    = getenv("CDK_CPU_BASELINE") ? Cpu_features() : detect_cpu_features();
+  return features;
+}
+
+
+}}  // cdk::foundation
+
+#endif
@@ -37,6 +37,7 @@
 PUSH_SYS_WARNINGS_CDK
 #include <vector>
 #include <map>
+#include <atomic>
 POP_SYS_WARNINGS_CDK
 
 namespace cdk {
@@ -245,6 +246,12 @@ public:
   Note: it is not possible to create STL container with diagnostic
   entries because they inherit from Error class which is not
   copy-assignable as required by STL containers.
+
+  Thread safety: add_entry() is lock-free and can run concurrently with
+  entry_count() and with other add_entry() calls, so a protocol reader
+  can deliver notices while another thread consumes the result. Methods
+  which return stored entries (get_entries(), get_entry(), get_error())
+  must be called by one thread at a time.
 */
 
 class Diagnostic_arena
@@ -252,17 +259,51 @@ class Diagnostic_arena
 {
   typedef Diagnostic_iterator::Entry_list Entry_list;
 
+  /*
+    Collected entries in arrival order. Only consumer methods touch this
+    list - entries are moved here from the ingestion queue by collect().
+  */
+
   Entry_list m_entries;
-  std::map<api::Severity::value, unsigned int> m_counts;
+
+  /*
+    Lock-free ingestion queue. New entries are pushed onto this atomic
+    singly-linked list (newest first) with a single compare-and-swap,
+    so the producer never blocks and never contends with a consumer
+    iterating already collected entries.
+  */
+
+  struct Node
+  {
+    Entry *entry;
+    Node  *next;
+  };
+
+  std::atomic<Node*> m_incoming;
+
+  /*
+    Per-severity counts of the stored entries. Severity levels are small
+    consecutive values (see api::Severity), so a plain array can serve as
+    the counter table. The counters are atomic so that entry_count() is
+    a cheap snapshot which does not require collecting the queue.
+  */
+
+  std::atomic<unsigned int> m_counts[api::Severity::ERROR + 1];
   Diagnostic_iterator m_it;
 
+  // Move entries from the ingestion queue to m_entries (consumer side).
+
+  void collect();
+
 public:
 
   typedef api::Severity Severity;
   typedef Diagnostic_iterator Iterator;
 
   Diagnostic_arena()
-    : m_it(m_entries, Severity::ERROR)
+    : m_incoming(nullptr)
+    , m_counts()
+    , m_it(m_entries, Severity::ERROR)
   {}
 
   virtual ~Diagnostic_arena()
@@ -276,25 +317,32 @@ public:
 
   void add_entry(Severity::value level, const Error *e)
   {
-    m_entries.push_back(new Entry(level, e));
-    m_counts[level]++;
+    Node *node = new Node{ new Entry(level, e), nullptr };
+    node->next = m_incoming.load(std::memory_order_relaxed);
+    while (!m_incoming.compare_exchange_weak(
+             node->next, node,
+             std::memory_order_release, std::memory_order_relaxed))
+    {}
+    m_counts[level].fetch_add(1, std::memory_order_release);
   }
 
   void clear();
 
   unsigned int entry_count(Severity::value level=Severity::ERROR)
   {
-    return m_counts[level];
+    return m_counts[level].load(std::memory_order_acquire);
   }
 
   Diagnostic_iterator& get_entries(Severity::value level=Severity::ERROR)
   {
+    collect();
     m_it.reset(level);
     return m_it;
   }
 
   Entry* get_entry(unsigned int pos)
   {
+    collect();
     return m_entries.at(pos);
   }
 
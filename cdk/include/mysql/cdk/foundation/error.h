@@ -245,6 +245,72 @@ void throw_system_error();
 void throw_system_error(const std::string &prefix);
 
 
+/*
+  Lightweight error-code channel
+  ------------------------------
+  Some errors are pure control flow: they are thrown on expected failure
+  paths and caught and handled internally, such as during option probing
+  or when failing over across a list of candidate hosts. Building a full
+  Error object for each of them costs a heap allocation and message
+  formatting that no one ever looks at.
+
+  For these cases Internal_error carries just the error code: its
+  construction allocates nothing and no message is formatted unless one
+  is actually requested. Code which handles such errors internally
+  should catch Internal_error and look at code(). If the error escapes
+  to a boundary which surfaces errors, rethrow_error() converts it to a
+  plain Error with the same code, so that user-visible failures always
+  go through the rich Error hierarchy.
+
+  Use throw_code() to throw errors on such internal paths.
+*/
+
+class Internal_error : public std::exception
+{
+  error_code m_code;
+
+  /*
+    Buffer for the what() message, filled only if it is requested
+    (normally it is not: these errors are handled by looking at the
+    code).
+  */
+
+  mutable char m_msg[64];
+
+public:
+
+  explicit Internal_error(const error_code &ec) NOEXCEPT
+    : m_code(ec)
+  {
+    m_msg[0] = '\0';
+  }
+
+  const error_code& code() const NOEXCEPT
+  { return m_code; }
+
+  virtual const char* what() const NOEXCEPT;
+};
+
+
+inline
+void throw_code(const error_code &ec)
+{
+  throw Internal_error(ec);
+}
+
+inline
+void throw_code(int code, const error_category &cat)
+{
+  throw Internal_error(error_code(code, cat));
+}
+
+inline
+void throw_code(cdkerrc::code code)
+{
+  throw Internal_error(error_code(code));
+}
+
+
 /*
   Base Error class
   ----------------
@@ -258,7 +324,10 @@ void throw_system_error(const std::string &prefix);
 
 class Error : public std::system_error
 {
-  static const std::string m_default_prefix;
+  // Note: a plain character array is constant initialized and runs no
+  // constructor when the library is loaded.
+
+  static const char m_default_prefix[];
 
 protected:
 
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDK_FOUNDATION_ESCAPE_H
+#define SDK_FOUNDATION_ESCAPE_H
+
+/*
+  Escape kernels
+  ==============
+
+  Helpers for producing escaped text representations of string and
+  binary data, shared by document serialization (JSON output of DbDoc)
+  and value printing:
+
+  - json_escape() appends the body of a JSON string (the part between
+    the quotes) with the characters that JSON requires to be escaped -
+    the quote, the backslash and control characters - replaced by their
+    escape sequences,
+
+  - hex_encode() appends the lowercase hex representation of a byte
+    sequence.
+
+  Typical input consists almost entirely of characters that pass
+  through unchanged, so json_escape() scans for the next character
+  needing an escape and appends the clean run in front of it wholesale.
+  Where SSE2 is available the scan examines 16 bytes at a time, gated
+  on the runtime dispatch of cpu_dispatch.h like the other vector
+  kernels (the scalar loops remain as the portable fallback and the
+  CDK_CPU_BASELINE escape hatch).
+*/
+
+#include "common.h"
+#include "cpu_dispatch.h"
+
+PUSH_SYS_WARNINGS_CDK
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+/*
+  Same SSE2 availability test as in string.h - SSE2 is part of the
+  x86-64 baseline, so on these platforms the intrinsics are always
+  available.
+*/
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define CDK_ESCAPE_SSE2 1
+#include <emmintrin.h>
+#endif
+POP_SYS_WARNINGS_CDK
+
+
+namespace cdk {
+namespace foundation {
+
+
+/*
+  Length of the leading run of bytes which pass into a JSON string
+  unescaped - everything except the quote, the backslash and control
+  characters. Bytes >= 0x80 (UTF8 lead and continuation bytes) need no
+  escape and pass through.
+*/
+
+inline size_t json_clear_run(const char *beg, size_t len)
+{
+  size_t pos = 0;
+
+#ifdef CDK_ESCAPE_SSE2
+
+  if (cpu_features().sse2)
+  {
+    /*
+      The control character test must be unsigned (bytes >= 0x80 are
+      negative in a signed compare): saturated subtraction of 0x1F
+      yields zero exactly for bytes < 0x20.
+    */
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i ctl_max = _mm_set1_epi8(0x1F);
+
+    for (; pos + 16 <= len; pos += 16)
+    {
+      __m128i chunk
+        = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg + pos));
+      __m128i esc = _mm_or_si128(
+        _mm_or_si128(
+          _mm_cmpeq_epi8(chunk, quote),
+          _mm_cmpeq_epi8(chunk, bslash)
+        ),
+        _mm_cmpeq_epi8(_mm_subs_epu8(chunk, ctl_max), zero)
+      );
+      if (_mm_movemask_epi8(esc))
+        break;
+    }
+  }
+
+#endif
+
+  for (; pos < len; ++pos)
+  {
+    unsigned char c = (unsigned char)beg[pos];
+    if (c < 0x20 || '"' == c || '\\' == c)
+      break;
+  }
+
+  return pos;
+}
+
+
+/*
+  Append to `out` the body of the JSON string representation of the
+  given UTF8 data (the surrounding quotes are not added). Characters
+  with a short escape form use it; other control characters use the
+  \u00XX form.
+*/
+
+inline void json_escape(const char *beg, const char *end, std::string &out)
+{
+  while (beg < end)
+  {
+    size_t run = json_clear_run(beg, (size_t)(end - beg));
+    out.append(beg, run);
+    beg += run;
+
+    if (beg == end)
+      break;
+
+    unsigned char c = (unsigned char)*beg++;
+
+    switch (c)
+    {
+    case '"':  out.append("\\\""); continue;
+    case '\\': out.append("\\\\"); continue;
+    case '\b': out.append("\\b");  continue;
+    case '\t': out.append("\\t");  continue;
+    case '\n': out.append("\\n");  continue;
+    case '\f': out.append("\\f");  continue;
+    case '\r': out.append("\\r");  continue;
+    default:
+      {
+        const char digits[] = "0123456789abcdef";
+        char buf[6] = { '\\', 'u', '0', '0',
+                        digits[c >> 4], digits[c & 0xF] };
+        out.append(buf, sizeof(buf));
+      }
+    }
+  }
+}
+
+inline void json_escape(const std::string &str, std::string &out)
+{
+  json_escape(str.data(), str.data() + str.length(), out);
+}
+
+
+/*
+  Append to `out` the lowercase hex representation of the given byte
+  sequence (two characters per byte, no separators).
+
+  The SSE2 path converts 8 bytes per iteration: the high and low
+  nibbles are interleaved and turned into ASCII with '0' added to each
+  nibble and a further 'a'-'0'-10 added where the nibble exceeds 9.
+*/
+
+inline void hex_encode(const byte *beg, const byte *end, std::string &out)
+{
+#ifdef CDK_ESCAPE_SSE2
+
+  if (cpu_features().sse2)
+  {
+    const __m128i low_mask = _mm_set1_epi8(0x0F);
+    const __m128i ascii0 = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i alpha_ofs = _mm_set1_epi8('a' - '0' - 10);
+
+    for (; beg + 8 <= end; beg += 8)
+    {
+      __m128i in
+        = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(beg));
+      __m128i hi = _mm_and_si128(_mm_srli_epi16(in, 4), low_mask);
+      __m128i lo = _mm_and_si128(in, low_mask);
+      __m128i nib = _mm_unpacklo_epi8(hi, lo);
+      __m128i ascii = _mm_add_epi8(nib, ascii0);
+      ascii = _mm_add_epi8(
+        ascii,
+        _mm_and_si128(_mm_cmpgt_epi8(nib, nine), alpha_ofs)
+      );
+      char buf[16];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(buf), ascii);
+      out.append(buf, sizeof(buf));
+    }
+  }
+
+#endif
+
+  const char digits[] = "0123456789abcdef";
+
+  for (; beg < end; ++beg)
+  {
+    char buf[2] = { digits[*beg >> 4], digits[*beg & 0xF] };
+    out.append(buf, sizeof(buf));
+  }
+}
+
+
+}}  // cdk::foundation
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef SDK_FOUNDATION_PROBES_H
+#define SDK_FOUNDATION_PROBES_H
+
+/*
+  Static tracing probes
+  =====================
+
+  Hot-path boundaries are marked with CDK_PROBEn() statements so that
+  perf, bpftrace or systemtap can attach to them by name instead of
+  chasing inlined symbols. Building with the WITH_SDT option
+  (cmake -DWITH_SDT=ON, requires <sys/sdt.h> from systemtap-sdt-dev)
+  compiles the markers in as SDT probes under the `concpp` provider; a
+  disabled probe is a single nop instruction, so the option is safe for
+  production builds. Without the option the macros expand to nothing.
+
+  Example (count received messages by type, sizes in a histogram):
+
+    bpftrace -e 'usdt:libmysqlcppconn8.so:concpp:msg_rcv
+                 { @[arg0] = count(); @sz = hist(arg1); }'
+
+  Probes (all arguments are integers):
+
+    msg_snd(type, size)        - message serialized into the send buffer
+    snd_flush(bytes)           - pipelined commands flushed to the wire
+    msg_rcv(type, size)        - received message dispatched for processing
+    compress_out(in, out)      - payload compressed before sending
+    compress_in(in, out)       - received compression frame decoded
+    row_convert(pos, type)     - row field converted to a user value
+*/
+
+#include "common.h"
+
+#ifdef WITH_SDT
+
+PUSH_SYS_WARNINGS_CDK
+#include <sys/sdt.h>
+POP_SYS_WARNINGS_CDK
+
+#define CDK_PROBE(name)             DTRACE_PROBE(concpp, name)
+#define CDK_PROBE1(name, a)         DTRACE_PROBE1(concpp, name, a)
+#define CDK_PROBE2(name, a, b)      DTRACE_PROBE2(concpp, name, a, b)
+#define CDK_PROBE3(name, a, b, c)   DTRACE_PROBE3(concpp, name, a, b, c)
+
+#else
+
+#define CDK_PROBE(name)
+#define CDK_PROBE1(name, a)
+#define CDK_PROBE2(name, a, b)
+#define CDK_PROBE3(name, a, b, c)
+
+#endif
+
+#endif
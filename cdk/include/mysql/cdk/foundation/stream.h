@@ -79,6 +79,24 @@ public:
   virtual void connect() =0;
   virtual void close() =0;
   virtual bool is_closed() const =0;
+
+  /*
+    Cheap, non-blocking test whether the connection is still usable.
+    Implementations which can not do better fall back to is_closed();
+    a connection reported as alive can still fail on the next I/O.
+  */
+
+  virtual bool check_alive() const { return !is_closed(); }
+
+  /*
+    Set a deadline `budget_ms` milliseconds from now for blocking I/O
+    performed on this connection; 0 removes the deadline. When the
+    deadline expires, blocking operations fail instead of waiting
+    further. Implementations which can not enforce a deadline ignore it
+    and block indefinitely as before.
+  */
+
+  virtual void set_io_deadline(uint64_t /*budget_ms*/) {}
 };
 
 }  // cdk::foundation::api
@@ -44,6 +44,18 @@ PUSH_SYS_WARNINGS_CDK
 #include <string.h>
 #include <string>
 #include <memory>
+
+/*
+  SSE2 intrinsics used by the ASCII fast paths of the transcoding
+  functions below. SSE2 is part of the x86-64 baseline, so on these
+  platforms the intrinsics are always available.
+*/
+
+#if defined(__SSE2__) || defined(_M_X64) \
+    || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define CDK_TRANSCODE_SSE2 1
+#include <emmintrin.h>
+#endif
 POP_SYS_WARNINGS_CDK
 
 
@@ -233,6 +245,141 @@ struct Str_stream
 };
 
 
+/*
+  ASCII run detection
+  -------------------
+  Helpers returning the length of the leading run of ASCII characters in
+  the input. Such runs can be transcoded between UTF8 and UTF16 with a
+  plain widening/narrowing copy, bypassing the per-code-point transcoder
+  loop - see the str_decode()/str_encode() specializations below.
+
+  Where SSE2 is available (all x86-64 builds) the input is scanned 16
+  bytes at a time; other platforms, including ARM, use a word-at-a-time
+  scan (NEON has no byte mask extraction that would beat the 64-bit word
+  test for this purpose).
+*/
+
+
+// Length of the leading run of ASCII (< 0x80) bytes.
+
+inline size_t ascii_run(const char *beg, size_t len)
+{
+  size_t pos = 0;
+
+#ifdef CDK_TRANSCODE_SSE2
+
+  for (; pos + 16 <= len; pos += 16)
+  {
+    __m128i chunk
+      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg + pos));
+    if (_mm_movemask_epi8(chunk))
+      break;
+  }
+
+#else
+
+  for (; pos + 8 <= len; pos += 8)
+  {
+    uint64_t word;
+    memcpy(&word, beg + pos, sizeof(word));
+    if (word & UINT64_C(0x8080808080808080))
+      break;
+  }
+
+#endif
+
+  for (; pos < len; ++pos)
+    if ((unsigned char)beg[pos] >= 0x80)
+      break;
+
+  return pos;
+}
+
+
+/*
+  As above, but the run additionally stops at a 0x00 byte. Used by the
+  str_decode() variant which treats its input as a NUL terminated byte
+  sequence.
+*/
+
+inline size_t ascii_run_nz(const byte *beg, size_t len)
+{
+  size_t pos = 0;
+
+#ifdef CDK_TRANSCODE_SSE2
+
+  const __m128i zero = _mm_setzero_si128();
+  for (; pos + 16 <= len; pos += 16)
+  {
+    __m128i chunk
+      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg + pos));
+    if (_mm_movemask_epi8(chunk)
+        | _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero)))
+      break;
+  }
+
+#else
+
+  for (; pos + 8 <= len; pos += 8)
+  {
+    uint64_t word;
+    memcpy(&word, beg + pos, sizeof(word));
+    // The second test detects a zero byte inside the word.
+    if ((word & UINT64_C(0x8080808080808080))
+        || ((word - UINT64_C(0x0101010101010101))
+            & ~word & UINT64_C(0x8080808080808080)))
+      break;
+  }
+
+#endif
+
+  for (; pos < len; ++pos)
+    if (0 == beg[pos] || beg[pos] >= 0x80)
+      break;
+
+  return pos;
+}
+
+
+// Length of the leading run of ASCII code units in UTF16 data.
+
+inline size_t ascii_run(const char16_t *beg, size_t len)
+{
+  size_t pos = 0;
+
+#ifdef CDK_TRANSCODE_SSE2
+
+  const __m128i zero = _mm_setzero_si128();
+  for (; pos + 8 <= len; pos += 8)
+  {
+    __m128i chunk
+      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg + pos));
+    // A unit is ASCII if nothing remains after shifting out its low 7 bits.
+    if (0xFFFF != _mm_movemask_epi8(
+          _mm_cmpeq_epi16(_mm_srli_epi16(chunk, 7), zero)))
+      break;
+  }
+
+#else
+
+  for (; pos + 4 <= len; pos += 4)
+  {
+    uint64_t word;
+    memcpy(&word, beg + pos, sizeof(word));
+    if (word & UINT64_C(0xFF80FF80FF80FF80))
+      break;
+  }
+
+#endif
+
+  for (; pos < len; ++pos)
+    if (beg[pos] >= 0x80)
+      break;
+
+  return pos;
+}
+
+
 /*
   Decode sequence of code points of encoding FROM into a string that uses
   encoding TO.
@@ -373,6 +520,197 @@ size_t str_encode(
 }
 
 
+/*
+  Fast paths for UTF8 <-> UTF16 transcoding
+  -----------------------------------------
+  The entry points used on hot paths - column values and document data
+  decoded by Codec<>, string session data and the string conversion
+  operators - are specialized below. They copy runs of ASCII characters
+  in bulk (for such runs transcoding is a plain widening or narrowing
+  copy) and hand only the non-ASCII characters to the generic rapidjson
+  transcoder, resuming the bulk copy at the next ASCII run. ASCII runs
+  are detected with the ascii_run() helpers defined above.
+
+  Each specialization preserves the termination and return value
+  semantics of the generic template it replaces.
+*/
+
+template<>
+inline size_t
+str_decode<String_encoding::UTF8, String_encoding::UTF16>(
+  const char *beg, size_t len,
+  std::basic_string<char16_t> &out
+)
+{
+  using Transcoder
+    = rapidjson::Transcoder<String_encoding::UTF8, String_encoding::UTF16>;
+
+  size_t pos = 0;
+
+  while (pos < len)
+  {
+    // Bulk-append the leading ASCII run (plain widening copy).
+
+    size_t run = ascii_run(beg + pos, len - pos);
+    out.append(beg + pos, beg + pos + run);
+    pos += run;
+
+    if (pos >= len)
+      break;
+
+    // Transcode consecutive non-ASCII characters the generic way.
+
+    Mem_stream<char> input(beg + pos, len - pos);
+    Str_stream<char16_t> output(out);
+
+    while (input.hasData() && (unsigned char)input.Peek() >= 0x80)
+    {
+      if (!Transcoder::Transcode(input, output))
+        throw_error("Failed string conversion");
+    }
+
+    pos += input.Tell();
+  }
+
+  return pos;
+}
+
+
+template<>
+inline size_t
+str_decode<String_encoding::UTF8, String_encoding::UTF16>(
+  const byte *beg, size_t len,
+  std::basic_string<char16_t> &out
+)
+{
+  using Transcoder
+    = rapidjson::Transcoder<String_encoding::UTF8, String_encoding::UTF16>;
+
+  size_t pos = 0;
+
+  while (pos < len)
+  {
+    size_t run = ascii_run_nz(beg + pos, len - pos);
+    out.append(beg + pos, beg + pos + run);
+    pos += run;
+
+    // Like the generic variant, stop at a 0x00 byte.
+
+    if (pos >= len || 0 == beg[pos])
+      break;
+
+    Mem_stream<char> input((const char*)(beg + pos), len - pos);
+    Str_stream<char16_t> output(out);
+
+    while ((unsigned char)input.Peek() >= 0x80)
+    {
+      if (!Transcoder::Transcode(input, output))
+        throw_error("Failed string conversion");
+    }
+
+    pos += input.Tell();
+  }
+
+  return pos;
+}
+
+
+template<>
+inline size_t
+str_decode<String_encoding::UTF16, String_encoding::UTF8>(
+  const char16_t *beg, size_t len,
+  std::basic_string<char> &out
+)
+{
+  using Transcoder
+    = rapidjson::Transcoder<String_encoding::UTF16, String_encoding::UTF8>;
+
+  size_t pos = 0;
+
+  while (pos < len)
+  {
+    size_t run = ascii_run(beg + pos, len - pos);
+
+    if (run)
+    {
+      // Plain narrowing copy of the ASCII run.
+
+      size_t out_len = out.length();
+      out.resize(out_len + run);
+      for (size_t i = 0; i < run; ++i)
+        out[out_len + i] = (char)beg[pos + i];
+      pos += run;
+    }
+
+    if (pos >= len)
+      break;
+
+    Mem_stream<char16_t> input(beg + pos, len - pos);
+    Str_stream<char> output(out);
+
+    while (input.hasData() && input.Peek() >= 0x80)
+    {
+      if (!Transcoder::Transcode(input, output))
+        throw_error("Failed string conversion");
+    }
+
+    pos += input.Tell();
+  }
+
+  return pos;
+}
+
+
+template<>
+inline size_t
+str_encode<String_encoding::UTF8, String_encoding::UTF16>(
+  const std::basic_string<char16_t> &in,
+  byte *out, size_t len
+)
+{
+  using Transcoder
+    = rapidjson::Transcoder<String_encoding::UTF16, String_encoding::UTF8>;
+
+  const char16_t *beg = in.data();
+  size_t in_len = in.length();
+  size_t pos = 0;
+  size_t out_pos = 0;
+
+  while (pos < in_len && out_pos < len)
+  {
+    size_t run = ascii_run(beg + pos, in_len - pos);
+
+    // Narrowing copy of the ASCII run, clipped to the output buffer.
+
+    if (run > len - out_pos)
+      run = len - out_pos;
+
+    for (size_t i = 0; i < run; ++i)
+      out[out_pos + i] = (byte)beg[pos + i];
+
+    pos += run;
+    out_pos += run;
+
+    if (pos >= in_len || out_pos >= len)
+      break;
+
+    Mem_stream<char16_t> input(beg + pos, in_len - pos);
+    Mem_stream<char> output((char*)(out + out_pos), len - out_pos);
+
+    while (input.hasData() && output.hasData() && input.Peek() >= 0x80)
+    {
+      if (!Transcoder::Transcode(input, output))
+        throw_error("Failed string conversion");
+    }
+
+    pos += input.Tell();
+    out_pos += output.Tell();
+  }
+
+  return out_pos;
+}
+
+
 
 
 /*
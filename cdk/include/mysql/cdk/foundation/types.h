@@ -101,6 +101,58 @@ public:
 };
 
 
+/*
+  A refcounted slab of memory accessed through the `bytes` interface.
+
+  Copies of a shared_bytes object share ownership of the underlying
+  block, which is freed when the last of them goes away. This allows
+  handing out views into I/O buffers without copying the data: the
+  producer of the buffer and any number of consumers keep the block
+  alive for as long as any of them refers to it (see the result fetch
+  path, where raw row data is kept as views into the receive buffer).
+*/
+
+class shared_bytes : public bytes
+{
+  std::shared_ptr<byte> m_owner;
+
+public:
+
+  shared_bytes() {}
+
+  /*
+    Take ownership of a block allocated by the caller. The deleter is
+    invoked on the block pointer when the last reference goes away.
+  */
+
+  template <class D>
+  shared_bytes(byte *buf, size_t len, D del)
+    : bytes(buf, len), m_owner(buf, del)
+  {}
+
+  // Tells whether this object owns a block.
+
+  explicit operator bool() const { return nullptr != m_owner; }
+
+  // Tells whether this is the only reference to the block.
+
+  bool unique() const { return 1 == m_owner.use_count(); }
+
+  // Tells whether the given memory range lies within the block.
+
+  bool contains(bytes range) const
+  {
+    return range.begin() >= begin() && range.end() <= end();
+  }
+
+  void reset()
+  {
+    m_owner.reset();
+    static_cast<bytes&>(*this) = bytes();
+  }
+};
+
+
 class buffers
 {
   bytes    m_first;
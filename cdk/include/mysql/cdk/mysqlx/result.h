@@ -34,6 +34,10 @@
 #include "common.h"
 #include "session.h"
 
+PUSH_SYS_WARNINGS_CDK
+#include <chrono>
+POP_SYS_WARNINGS_CDK
+
 
 namespace cdk {
 namespace mysqlx {
@@ -319,6 +323,34 @@ public:
 typedef std::map<col_count_t, Col_metadata>  Mdata_storage;
 
 
+// ---------------------------------------------------------
+
+/*
+  Monotonic timestamps taken at reply phase boundaries, used to tell
+  server-side latency from connector-side processing when debugging
+  slow statements. A default-constructed time point means that the
+  corresponding phase was not (yet) reached - for example `first_row`
+  and `last_row` stay unset for replies without row data.
+*/
+
+struct Reply_timings
+{
+  typedef std::chrono::steady_clock clock;
+  typedef clock::time_point         time_point;
+
+  time_point sent;         ///< command handed over to the connection
+  time_point first_reply;  ///< first message of the reply decoded
+  time_point mdata_done;   ///< meta-data of a result set complete
+  time_point first_row;    ///< first row of the reply decoded
+  time_point last_row;     ///< end of the row stream
+
+  void clear()
+  {
+    *this = Reply_timings();
+  }
+};
+
+
 // ---------------------------------------------------------
 
 /*
@@ -451,7 +483,11 @@ public:
     discard();
     wait();
     if (m_session)
+    {
+      // Return the meta-data store for reuse by later statements.
+      m_session->recycle_mdata_storage(m_col_metadata.release());
       m_session->deregister_stmt(this);
+    }
   }
 
   Session& get_session()
@@ -654,6 +690,20 @@ public:
   }
   m_stmt_stats;
 
+  /*
+    Reply phase timestamps (@see Reply_timings). Cleared when the
+    command has been sent and filled from the processor callbacks as
+    the reply is decoded.
+  */
+
+  Reply_timings m_timings;
+
+  void note_first_reply()
+  {
+    if (Reply_timings::time_point() == m_timings.first_reply)
+      m_timings.first_reply = Reply_timings::clock::now();
+  }
+
   virtual bool has_stats()
   {
     wait();
@@ -743,13 +793,42 @@ public:
   void col_decimals(col_count_t pos, unsigned short decimals) override;
   void col_flags(col_count_t, uint32_t) override;
 
+  /*
+    When the reply is being discarded, consume ColumnMetaData frames
+    here so that their payloads are dropped without the protobuf parse
+    (the column count, which drives the reply state machine, is still
+    maintained by the protocol layer).
+  */
+
+  bool col_raw(col_count_t, bytes) override
+  {
+    if (m_discard)
+      note_first_reply();
+    return m_discard;
+  }
+
   // Row_processor
 
   bool row_begin(row_count_t) override
   {
+    if (Reply_timings::time_point() == m_timings.first_row)
+      m_timings.first_row = Reply_timings::clock::now();
     return false;  // ignore all rows
   }
 
+  /*
+    Rows reach this processor only when a result set is being discarded
+    - consume the frame so that the payload is dropped without any
+    decoding.
+  */
+
+  bool row_raw(row_count_t, bytes) override
+  {
+    if (Reply_timings::time_point() == m_timings.first_row)
+      m_timings.first_row = Reply_timings::clock::now();
+    return true;
+  }
+
   void done(bool eod, bool more) override;
 
   /*
@@ -764,6 +843,7 @@ public:
     sql_state_t sql_state, const string &msg
   ) override
   {
+    note_first_reply();
     if (Severity::ERROR == severity)
       m_state = ERROR;
     add_diagnostics(severity, new Server_error(code, sql_state, msg));
@@ -870,6 +950,8 @@ private:
 
   bool   row_begin(row_count_t row);
   void   row_end(row_count_t row);
+  bool   row_raw(row_count_t row, bytes data);
+  void   row_slab(const foundation::shared_bytes &slab);
   void   col_null(col_count_t pos);
   void   col_unknown(col_count_t pos, int fmt);
   size_t col_begin(col_count_t pos, size_t data_len);
@@ -38,7 +38,11 @@
 #include "common.h"
 
 PUSH_SYS_WARNINGS_CDK
+#include <chrono>
 #include <deque>
+#include <functional>
+#include <map>
+#include <vector>
 POP_SYS_WARNINGS_CDK
 
 #undef max
@@ -118,6 +122,11 @@ class Reply;
 class Cursor;
 class SessionAuth;
 class Stmt_op;
+class Col_metadata;
+
+// Note: must be the same as the definition in result.h.
+
+typedef std::map<col_count_t, Col_metadata>  Mdata_storage;
 
 typedef Stmt_op* Reply_init;
 typedef protocol::mysqlx::api::Protocol_fields Protocol_fields;
@@ -205,6 +214,23 @@ private:
 };
 
 
+/*
+  Wall-clock duration of each phase of the session setup sequence, in
+  microseconds. The transport phases are measured by the code which
+  creates the connection (see core/session.cc), the protocol phases by
+  the Session constructor. Values are filled while the session is being
+  established and remain constant afterwards.
+*/
+
+struct Connect_timings
+{
+  uint64_t tcp_usec  = 0;  ///< transport connect (incl. name resolution)
+  uint64_t tls_usec  = 0;  ///< TLS capability exchange and handshake
+  uint64_t caps_usec = 0;  ///< capability negotiation (compression, attributes)
+  uint64_t auth_usec = 0;  ///< authentication exchange
+};
+
+
 /*
   Represents active session with a server.
 
@@ -243,12 +269,60 @@ protected:
 
   Stmt_op* m_last_stmt = nullptr;
 
+  // Set when the current pipeline is wrapped in an expectation block.
+
+  bool m_pipeline_expect = false;
+
+  // Set while a pipeline is open (see pipeline_active()).
+
+  bool m_pipeline_active = false;
+
+  /*
+    Operation which consumes the reply to the Expect_Close command closing
+    the expectation block of the last pipelined batch (see
+    start_pipeline()).
+  */
+
+  std::unique_ptr<Stmt_op> m_expect_close;
+
+  /*
+    Operation which consumes the reply to a session reset command that was
+    sent without waiting for its confirmation (see reset_async()). The
+    reply is read together with the reply to the first statement executed
+    after the reset, or by check_pending_reset() at the latest.
+  */
+
+  std::unique_ptr<Stmt_op> m_pending_reset;
+
+  /*
+    Set when the session was reset and no statement was executed since.
+    A reset request on a clean session is a no-op, so a session which was
+    reset when it was returned to a pool is not reset again on checkout.
+  */
+
+  bool m_clean = false;
+
   unsigned long m_id = 0;
   bool m_expired = false;
   string m_cur_schema;
   uint64_t m_checked_proto_fields = 0;
   uint64_t m_proto_fields = 0;
 
+  /*
+    Meta-data stores recycled between statements executed in this session.
+    A statement takes a store from this pool when it starts reading
+    result-set meta-data and returns it when the statement is destroyed
+    (see Stmt_op). A recycled store keeps its map nodes and the string
+    buffers inside them, so that statements repeatedly executed in the
+    session do not re-allocate this storage each time.
+  */
+
+  std::vector<Mdata_storage*> m_mdata_pool;
+
+  // Per-phase timings of the session setup (see Connect_timings).
+
+  Connect_timings m_connect_timings;
+
 
 public:
 
@@ -261,6 +335,11 @@ public:
   Session(C &conn, const Options &options)
     : m_protocol(conn)
   {
+    using std::chrono::steady_clock;
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    auto phase_start = steady_clock::now();
 
     /*
       Check if the compression is needed and the compression type
@@ -277,10 +356,23 @@ public:
         throw_error("Compression requested but the server does not support it.");
     }
     send_connection_attr(options);
+
+    auto caps_done = steady_clock::now();
+    m_connect_timings.caps_usec = (uint64_t)
+      duration_cast<microseconds>(caps_done - phase_start).count();
+
     authenticate(options, conn.is_secure());
+
+    m_connect_timings.auth_usec = (uint64_t)
+      duration_cast<microseconds>(steady_clock::now() - caps_done).count();
+
     m_isvalid = true;
 
     // start using compression now with the default threshold (1000)
+    m_protocol.set_compression_level(options.compression_level());
+    m_protocol.set_compression_long_matching(
+      options.compression_long_matching());
+    m_protocol.set_compression_window_log(options.compression_window_log());
     m_protocol.set_compression(compression, 1000);
   }
 
@@ -306,6 +398,18 @@ public:
   option_t is_valid();
   option_t check_valid();
 
+  /*
+    Mark the session as invalid without touching the connection. Used
+    when the transport was left in an undefined state, for example after
+    a reply was abandoned half-way because an I/O deadline expired. An
+    invalid session is not re-used by the session pool.
+  */
+
+  void invalidate()
+  {
+    m_isvalid = false;
+  }
+
   /*
     Check that xplugin is supporting certain new fields in the protocol
     such as row locking, etc. The function sets binary flags in
@@ -336,8 +440,112 @@ public:
   void clean_up();
 
   void reset();
+
+  /*
+    Variant of reset() which does not wait for the server's confirmation.
+    The reset command is sent down the wire and its reply overlaps with
+    the first statement executed afterwards, so that re-using the session
+    does not cost a round trip. Returns false (leaving the session
+    untouched) if the pipelined reset can not be used - in that case the
+    caller should fall back to the blocking reset().
+  */
+
+  bool reset_async();
+
+  // Consume the reply to a pipelined reset (if any), see reset_async().
+
+  void check_pending_reset();
+
   void close();
 
+  /*
+    Statement pipelining
+    --------------------
+
+    Between start_pipeline() and flush_pipeline() commands of statements
+    executed in this session are accumulated in the protocol write buffer
+    instead of being sent individually. flush_pipeline() sends the whole
+    batch with a single write. Replies must be processed only after the
+    pipeline was flushed. clear_pipeline() drops accumulated commands
+    without sending them.
+
+    When a pipeline is started with expect_no_error set, the batch is
+    wrapped in a Mysqlx.Expect no_error block. If a statement of the batch
+    fails, the server then does not execute the remaining statements but
+    rejects them right away, so a failed batch is aborted server-side
+    instead of each statement being tried in turn. The failed and rejected
+    statements still report errors through their replies as usual. Errors
+    of the expectation block itself are recorded in session diagnostics.
+  */
+
+  void start_pipeline(bool expect_no_error = false);
+  void flush_pipeline();
+  void clear_pipeline();
+
+  // Tell whether a pipeline is open (started but not yet flushed/cleared).
+
+  bool pipeline_active() const
+  {
+    return m_pipeline_active;
+  }
+
+  /*
+    Enable validated-transport mode of the underlying protocol instance
+    (@see protocol::mysqlx::Protocol::set_validated_transport()).
+  */
+
+  void set_validated_transport(bool enable)
+  {
+    m_protocol.set_validated_transport(enable);
+  }
+
+  /*
+    Drop warning notices of the underlying protocol instance at message
+    dispatch (@see protocol::mysqlx::Protocol::set_skip_warnings()).
+  */
+
+  void set_skip_warnings(bool enable)
+  {
+    m_protocol.set_skip_warnings(enable);
+  }
+
+  /*
+    Traffic counters of the underlying protocol instance
+    (@see protocol::mysqlx::Protocol_stats).
+  */
+
+  const protocol::mysqlx::Protocol_stats& protocol_stats() const
+  {
+    return m_protocol.get_stats();
+  }
+
+  /*
+    Per-phase timings of the session setup sequence (see Connect_timings).
+    The transport phases are not known to this class - they are filled in
+    by the code which created the connection.
+  */
+
+  const Connect_timings& connect_timings() const
+  {
+    return m_connect_timings;
+  }
+
+  void set_transport_timings(uint64_t tcp_usec, uint64_t tls_usec)
+  {
+    m_connect_timings.tcp_usec = tcp_usec;
+    m_connect_timings.tls_usec = tls_usec;
+  }
+
+  /*
+    The mechanism with which this session authenticated
+    (see m_used_auth_method).
+  */
+
+  ds::mysqlx::Protocol_options::auth_method_t auth_method_used() const
+  {
+    return m_used_auth_method;
+  }
+
   /*
     Transactions
   */
@@ -352,9 +560,15 @@ public:
     Prepared Statments
   */
 
+  /*
+    If compact_metadata is set, the server is asked to omit textual column
+    meta-data from the reply (see Protocol::snd_PrepareExecute()).
+  */
+
   Reply_init prepared_execute(uint32_t stmt_id,
                                const Limit *lim,
-                               const Param_source *param
+                               const Param_source *param,
+                               bool compact_metadata = false
                                );
   Reply_init prepared_execute(uint32_t stmt_id,
                                const cdk::Any_list *list
@@ -466,18 +680,66 @@ public:
     return m_cur_schema;
   }
 
+  /*
+    Subscription to global notices pushed by the server.
+
+    The handler is called with the raw notice type and frame payload of
+    every notice with GLOBAL scope, before the session's own notice
+    processing. It runs on the thread which drives protocol reading, so
+    it is invoked while some reply is being read - the protocol reads
+    frames only when an operation is in progress. The handler must not
+    throw and must not issue commands on this session.
+  */
+
+  using Notice_handler = std::function<void(unsigned int, bytes)>;
+
+  void set_notice_handler(Notice_handler h)
+  {
+    m_notice_handler = std::move(h);
+  }
+
 private:
 
-  // Send Connection Attributes
+  Notice_handler m_notice_handler;
+
+
+  /*
+    Send Connection Attributes.
+
+    Note: Only the CapabilitiesSet message is sent here - the reply is
+    consumed later by check_attr_reply(), from within the authentication
+    handshake. This way the capability message and AuthenticateStart are
+    pipelined and the connection attributes do not cost an extra round
+    trip.
+  */
   void send_connection_attr(const Options &options);
+  void check_attr_reply();
+
+  bool m_attr_reply_pending = false;
+
   // Authentication (cdk::protocol::mysqlx::Auth_processor)
   void authenticate(const Options &options, bool secure = false);
   void do_authenticate(const Options &options, int auth_method, bool secure);
 
+  /*
+    The mechanism with which authentication eventually succeeded. When
+    the configured mechanism is DEFAULT this can differ from it because
+    of the fallback chain in do_authenticate(); callers use it to skip
+    the failed probe on later connects to the same data source
+    (see ds::Multi_source::report_auth_method()).
+  */
+
+  ds::mysqlx::Protocol_options::auth_method_t m_used_auth_method
+    = ds::mysqlx::Protocol_options::DEFAULT;
+
   //  Reply registration
   virtual void register_stmt(Stmt_op* reply);
   virtual void deregister_stmt(Stmt_op*);
 
+  //  Meta-data store recycling (see m_mdata_pool)
+  Mdata_storage* get_mdata_storage();
+  void recycle_mdata_storage(Mdata_storage*);
+
   /*
     Errors and notices.
   */
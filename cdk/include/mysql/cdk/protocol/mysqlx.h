@@ -527,6 +527,37 @@ public:
 */
 enum Data_model { DEFAULT= 0, DOCUMENT = 1, TABLE = 2 };
 
+
+/*
+  Aggregate counters describing traffic handled by a protocol instance.
+
+  Counters are updated inline on the send/receive paths. Building with
+  CDK_DISABLE_PROTOCOL_STATS compiles the updates out, in which case all
+  counters stay at zero.
+*/
+
+struct Protocol_stats
+{
+  uint64_t bytes_sent = 0;        ///< raw bytes handed to the stream
+  uint64_t bytes_received = 0;    ///< raw bytes read from the stream
+  uint64_t msgs_sent = 0;         ///< protocol messages written
+  uint64_t msgs_received = 0;     ///< protocol messages read
+  uint64_t frames_sent = 0;       ///< compressed frames written
+  uint64_t frames_received = 0;   ///< compressed frames read
+
+  /*
+    Payload bytes before compression (sending) and after uncompression
+    (receiving). Together with bytes_sent/received these give the
+    achieved compression ratio.
+  */
+
+  uint64_t uncompressed_sent = 0;
+  uint64_t uncompressed_received = 0;
+
+  uint64_t max_write_size = 0;    ///< largest single write (pipeline depth in bytes)
+};
+
+
 class Protocol
   : foundation::opaque_impl<Protocol>
   , foundation::nocopy
@@ -536,13 +567,79 @@ public:
   void set_compression(api::Compression_type::value compression_type,
                        size_t threshold);
 
+  /*
+    Set a pre-trained dictionary for ZSTD compression. Must be called
+    before set_compression() and requires that the other end of the
+    connection uses the same dictionary. Ignored by other compression
+    algorithms.
+  */
+
+  void set_compression_dictionary(bytes dict);
+
+  /*
+    Set compression effort level for the algorithm selected later with
+    set_compression(). Negative value (the default) keeps the
+    algorithm's default level.
+  */
+
+  void set_compression_level(int level);
+
+  /*
+    Enable long distance matching for ZSTD compression. LDM searches
+    for matches over the whole window instead of the near past, which
+    improves ratio on large, repetitive transfers. Must be called
+    before set_compression(); ignored by other compression algorithms.
+  */
+
+  void set_compression_long_matching(bool enable);
+
+  /*
+    Set the ZSTD match window size as a power of two. Zero (the
+    default) keeps the window implied by the compression level. Must be
+    called before set_compression(); ignored by other compression
+    algorithms.
+  */
+
+  void set_compression_window_log(int wlog);
+
+  /*
+    Enable validated-transport mode, meant for connections on which the
+    transport already excludes corruption (e.g. TLS record MACs). Small
+    fixed-shape server messages which repeat byte-identically - FetchDone
+    and friends, state-change notices - then reuse the parse of their
+    first validated instance instead of being re-parsed frame by frame.
+  */
+
+  void set_validated_transport(bool enable);
+
+  /*
+    Drop warning notices of server replies at message dispatch, before
+    any message object is constructed, for sessions which never examine
+    warnings. State-change notices, which carry statement statistics and
+    generated ids, are always processed.
+  */
+
+  void set_skip_warnings(bool enable);
+
+  /*
+    Return traffic counters accumulated by this protocol instance
+    (@see Protocol_stats).
+  */
+
+  const Protocol_stats& get_stats() const;
+
   typedef cdk::api::Async_op<size_t> Op;
 
   class Stream;
 
   template <class C> Protocol(C &conn);
 
-  void start_Pipeline();
+  /*
+    A non-zero expected_size pre-reserves the write buffer for the
+    estimated summed wire size of the messages about to be queued.
+  */
+
+  void start_Pipeline(size_t expected_size = 0);
   Op&  snd_Pipeline();
   void clear_Pipeline();
 
@@ -690,11 +787,16 @@ public:
        of values.
     2. Executing prepared CRUD statement with parameters given by name-value map
        and with possibility to set limits.
+
+    If compact_metadata is set, the server is asked to omit textual column
+    meta-data (names etc.) from the reply. To be used only when the caller
+    holds complete meta-data from an earlier execution of the statement.
   */
 
   Op& snd_PrepareExecute(uint32_t stmt_id,
                          const api::Limit *limit = nullptr,
-                         const api::Args_map *args = nullptr);
+                         const api::Args_map *args = nullptr,
+                         bool compact_metadata = false);
 
   Op& snd_PrepareExecute(uint32_t stmt_id,
                          const api::Any_list *args = nullptr);
@@ -1087,6 +1189,26 @@ public:
   virtual size_t col_begin(col_count_t /*pos*/, size_t /*data_len*/) { return 0; }
   virtual size_t col_data(col_count_t /*pos*/, bytes /*data*/) { return 0;}
   virtual void col_end(col_count_t /*pos*/, size_t /*data_len*/) {}
+
+  /*
+    Wire passthrough hook: offered the complete payload of a Row frame
+    (post-decompression) before it is decoded. Returning true consumes
+    the frame - no per-column callbacks follow for that row.
+  */
+
+  virtual bool row_raw(row_count_t /*row*/, bytes /*data*/) { return false; }
+
+  /*
+    Called before the col_xxx() callbacks of a row which is decoded
+    straight from the receive buffer. The argument shares ownership of
+    the buffer backing the col_data() bytes of this row: a processor
+    which stores those bytes as views instead of copying them keeps a
+    copy of the slab, so that the views stay valid for as long as it is
+    held. The default ignores the offer, in which case the buffer is
+    re-used once the row has been processed.
+  */
+
+  virtual void row_slab(const foundation::shared_bytes& /*slab*/) {}
 // LCOV_EXCL_STOP
 
   /*
@@ -1121,6 +1243,15 @@ public:
   virtual void col_decimals(col_count_t /*pos*/, unsigned short /*decimals*/) {}
   virtual void col_content_type(col_count_t /*pos*/, unsigned short /*type*/) {}
   virtual void col_flags(col_count_t /*pos*/, uint32_t /*flags*/) {}
+
+  /*
+    Skip hook: offered the complete payload of a ColumnMetaData frame
+    before it is parsed. Returning true consumes the frame - the column
+    is counted, but none of the col_xxx() callbacks above are made for
+    it. Used when a reply is being discarded (see cdk::mysqlx::Stmt_op).
+  */
+
+  virtual bool col_raw(col_count_t /*pos*/, bytes /*data*/) { return false; }
 // LCOV_EXCL_STOP
 
   size_t message_begin(msg_type_t type, bool &flag)
@@ -99,12 +99,23 @@ public:
   row_count_t affected_rows() override
   { return m_impl->affected_rows(); }
 
-  row_count_t last_insert_id()
+  virtual row_count_t last_insert_id()
   { return m_impl->last_insert_id(); }
 
-  const std::vector<std::string>& generated_ids() const
+  virtual const std::vector<std::string>& generated_ids() const
   { return m_impl->generated_ids(); }
 
+  /*
+    Timestamps taken at reply phase boundaries
+    (@see mysqlx::Reply_timings).
+  */
+
+  const mysqlx::Reply_timings& get_timings() const
+  {
+    assert(m_impl);
+    return m_impl->m_timings;
+  }
+
   // Diagnostics interface
 
   unsigned int entry_count(Severity::value level=Severity::ERROR) override
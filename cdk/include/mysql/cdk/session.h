@@ -85,6 +85,38 @@ public:
   option_t is_valid() { return m_session->is_valid(); }
   option_t check_valid() { return m_session->check_valid(); }
 
+  /*
+    Non-blocking test whether the underlying connection is still usable,
+    e.g. was not closed by the server while the session sat idle in a
+    pool. Unlike check_valid(), this costs no server round trip - it only
+    inspects the local socket state.
+  */
+
+  bool check_alive() { return m_connection->check_alive(); }
+
+  /*
+    Set a deadline `budget_ms` milliseconds from now for blocking I/O on
+    the underlying connection; 0 removes the deadline. When the deadline
+    expires, blocking operations throw Error_timeout instead of waiting
+    further (@see api::Connection::set_io_deadline()).
+  */
+
+  void set_io_deadline(uint64_t budget_ms)
+  {
+    m_connection->set_io_deadline(budget_ms);
+  }
+
+  /*
+    Mark the session as invalid so that it is not re-used by the session
+    pool. Used when the transport was left in an undefined state, e.g.
+    after a reply was abandoned half-way because an I/O deadline expired.
+  */
+
+  void invalidate()
+  {
+    m_session->invalidate();
+  }
+
   option_t has_prepared_statements();
   void set_has_prepared_statements(bool x);
 
@@ -92,6 +124,17 @@ public:
     m_session->reset();
   }
 
+  /*
+    Reset the session without waiting for the server's confirmation - the
+    reply to the reset command overlaps with the first statement executed
+    afterwards. Returns false if the pipelined reset can not be used, in
+    which case the caller should fall back to the blocking reset().
+  */
+
+  bool reset_async() {
+    return m_session->reset_async();
+  }
+
   void close() {
     m_session->close();
     m_connection->close();
@@ -169,6 +212,83 @@ public:
     m_session->savepoint_remove(savepoint);
   }
 
+  /*
+    Statement pipelining
+    --------------------
+    Commands of statements executed between start_pipeline() and
+    flush_pipeline() are accumulated and sent to the server as a single
+    batch when the pipeline is flushed. This saves round-trips when
+    issuing many small statements whose replies are processed afterwards.
+    Replies to pipelined statements must not be waited for before the
+    pipeline is flushed. clear_pipeline() discards accumulated commands
+    without sending them.
+
+    If expect_no_error is set, the batch is wrapped in a Mysqlx.Expect
+    no_error block: when a statement of the batch fails, the server
+    rejects the remaining statements right away instead of executing
+    them, so a failed batch is aborted without waiting out each reply.
+  */
+
+  void start_pipeline(bool expect_no_error = false)
+  {
+    m_session->start_pipeline(expect_no_error);
+  }
+
+  void flush_pipeline()
+  {
+    m_session->flush_pipeline();
+  }
+
+  void clear_pipeline()
+  {
+    m_session->clear_pipeline();
+  }
+
+  bool pipeline_active() const
+  {
+    return m_session->pipeline_active();
+  }
+
+  void set_validated_transport(bool enable)
+  {
+    m_session->set_validated_transport(enable);
+  }
+
+  void set_skip_warnings(bool enable)
+  {
+    m_session->set_skip_warnings(enable);
+  }
+
+  /*
+    Aggregate counters describing protocol traffic of this session
+    (@see protocol::mysqlx::Protocol_stats).
+  */
+
+  const protocol::mysqlx::Protocol_stats& protocol_stats() const
+  {
+    return m_session->protocol_stats();
+  }
+
+  /*
+    Per-phase timings of the session setup sequence
+    (@see mysqlx::Connect_timings).
+  */
+
+  const mysqlx::Connect_timings& connect_timings() const
+  {
+    return m_session->connect_timings();
+  }
+
+  /*
+    Install a callback invoked for global notices pushed by the server
+    (@see mysqlx::Session::set_notice_handler()).
+  */
+
+  void set_notice_handler(mysqlx::Session::Notice_handler h)
+  {
+    m_session->set_notice_handler(std::move(h));
+  }
+
   /*
     Diagnostics
     -----------
@@ -481,10 +601,11 @@ public:
   // --------------------------
 
   Reply_init prepared_execute(
-    uint32_t stmt_id, const Limit* lim, const Param_source *param = nullptr
+    uint32_t stmt_id, const Limit* lim, const Param_source *param = nullptr,
+    bool compact_metadata = false
   )
   {
-    return m_session->prepared_execute(stmt_id, lim, param);
+    return m_session->prepared_execute(stmt_id, lim, param, compact_metadata);
   }
 
   Reply_init prepared_execute(
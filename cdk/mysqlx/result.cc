@@ -92,6 +92,8 @@ bool Stmt_op::do_cont()
       if (do_send())
       {
         m_stmt_stats.clear();
+        m_timings.clear();
+        m_timings.sent = Reply_timings::clock::now();
         m_op = nullptr;
 
         /*
@@ -154,7 +156,9 @@ bool Stmt_op::do_cont()
         break;
       case MDATA:
         m_nr_cols = 0;
-        m_col_metadata.reset(new Mdata_storage());
+        // Note: the store of the previous result set (if any) is recycled.
+        get_session().recycle_mdata_storage(m_col_metadata.release());
+        m_col_metadata.reset(get_session().get_mdata_storage());
         m_op = &get_protocol().rcv_MetaData(*this);
         m_op_mdata = true;
         break;
@@ -186,6 +190,7 @@ bool Stmt_op::do_cont()
 
     if (m_op_mdata)
     {
+      m_timings.mdata_done = Reply_timings::clock::now();
       m_state = m_nr_cols > 0 ? (m_discard ? DISCARD : ROWS) : FINISH;
     }
 
@@ -249,11 +254,13 @@ void Stmt_op::do_wait()
 
 void Stmt_op::ok(string)
 {
+  note_first_reply();
   m_state = DONE;
 }
 
 void Stmt_op::execute_ok()
 {
+  note_first_reply();
   m_state = DONE;
 }
 
@@ -262,6 +269,9 @@ void Stmt_op::done(bool eod, bool more)
   if (!eod)
     return;
 
+  if (Reply_timings::time_point() != m_timings.first_row)
+    m_timings.last_row = Reply_timings::clock::now();
+
   m_state = more ? (m_discard ? MDATA : NEXT) : FINISH;
 }
 
@@ -350,6 +360,8 @@ void Stmt_op::generated_document_id(const std::string& id)
 
 void Stmt_op::notice(unsigned int type, short int scope, bytes payload)
 {
+  note_first_reply();
+
   using namespace protocol::mysqlx;
 
   switch (type)
@@ -399,11 +411,24 @@ void Stmt_op::col_count(col_count_t nr_cols)
   //When all columns metadata arrived...
   m_nr_cols = nr_cols;
   //m_has_results = m_nr_cols != 0;
+
+  /*
+    A recycled meta-data store can have more entries than this result set
+    has columns - drop the surplus ones so that the store describes only
+    the columns reported above.
+  */
+
+  if (m_col_metadata && m_col_metadata->size() > size_t(nr_cols))
+    m_col_metadata->erase(
+      m_col_metadata->lower_bound(nr_cols), m_col_metadata->end()
+    );
 }
 
 
 void Stmt_op::col_type(col_count_t pos, unsigned short type)
 {
+  note_first_reply();
+
   if (m_discard)
     return;
 
@@ -783,6 +808,10 @@ const cdk::api::Event_info* Cursor::get_event_info() const
 
 bool Cursor::row_begin(row_count_t row)
 {
+  if (m_reply
+      && Reply_timings::time_point() == m_reply->m_timings.first_row)
+    m_reply->m_timings.first_row = Reply_timings::clock::now();
+
   if (m_row_prc)
     return m_row_prc->row_begin(row);
   return false;
@@ -800,6 +829,35 @@ void Cursor::row_end(row_count_t row)
 }
 
 
+/*
+  Wire passthrough: forward the raw Row frame payload to the row
+  processor. If it consumes the frame, account for the row as if it was
+  processed the regular way (see row_end()).
+*/
+
+bool Cursor::row_raw(row_count_t row, bytes data)
+{
+  if (!m_row_prc || !m_row_prc->row_raw(row, data))
+    return false;
+
+  if (m_reply
+      && Reply_timings::time_point() == m_reply->m_timings.first_row)
+    m_reply->m_timings.first_row = Reply_timings::clock::now();
+
+  if (m_limited)
+    --m_rows_limit;
+
+  return true;
+}
+
+
+void Cursor::row_slab(const foundation::shared_bytes &slab)
+{
+  if (m_row_prc)
+    m_row_prc->row_slab(slab);
+}
+
+
 void Cursor::col_null(col_count_t pos)
 {
   if (m_row_prc)
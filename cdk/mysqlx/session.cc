@@ -294,6 +294,13 @@ void SessionAuth::do_wait()
     case START:
     case CONT:
     {
+      /*
+        If a capability reply is still pending (see
+        send_connection_attr()), it precedes the authentication replies
+        on the wire and must be consumed first.
+      */
+      m_sess.check_attr_reply();
+
       // note: while processing incoming message, m_op might be set
       // to another operation that needs to be executed.
       m_sess.m_protocol.rcv_AuthenticateReply(*this).wait();
@@ -569,34 +576,51 @@ void Session::send_connection_attr(const Options &options)
   {
     m_protocol.snd_CapabilitiesSet(Attr_converter(options.attributes())).wait();
 
-    struct Check_reply_prc : cdk::protocol::mysqlx::Reply_processor
-    {
-      string m_msg;
-      unsigned int m_code = 0;
-      cdk::protocol::mysqlx::sql_state_t m_sql_state;
-      void error(unsigned int code, short int,
-                 cdk::protocol::mysqlx::sql_state_t state, const string &msg) override
-      {
-        m_code = code;
-        m_sql_state = state;
-        m_msg = msg;
-      }
+    /*
+      Note: The reply is not read here. It is consumed by
+      check_attr_reply() after the AuthenticateStart message has been
+      sent, so that both messages travel to the server in one round
+      trip (server replies preserve the request order).
+    */
+
+    m_attr_reply_pending = true;
+  }
+}
 
-      void ok(string) override
-      {}
-    };
 
-    Check_reply_prc prc;
+void Session::check_attr_reply()
+{
+  if (!m_attr_reply_pending)
+    return;
 
-    m_protocol.rcv_Reply(prc).wait();
+  m_attr_reply_pending = false;
 
-    if(prc.m_code != 0 &&    prc.m_code != 5002)
+  struct Check_reply_prc : cdk::protocol::mysqlx::Reply_processor
+  {
+    string m_msg;
+    unsigned int m_code = 0;
+    cdk::protocol::mysqlx::sql_state_t m_sql_state;
+    void error(unsigned int code, short int,
+               cdk::protocol::mysqlx::sql_state_t state, const string &msg) override
     {
-      //code: 5002
-      //msg: "Capability \'session_connect_attrs\' doesn\'t exist"
-      throw Server_error(prc.m_code, prc.m_sql_state, prc.m_msg);
+      m_code = code;
+      m_sql_state = state;
+      m_msg = msg;
     }
 
+    void ok(string) override
+    {}
+  };
+
+  Check_reply_prc prc;
+
+  m_protocol.rcv_Reply(prc).wait();
+
+  if(prc.m_code != 0 &&    prc.m_code != 5002)
+  {
+    //code: 5002
+    //msg: "Capability \'session_connect_attrs\' doesn\'t exist"
+    throw Server_error(prc.m_code, prc.m_sql_state, prc.m_msg);
   }
 }
 
@@ -609,7 +633,17 @@ void Session::do_authenticate(const Options &options,
 
   auto am = original_am;
   if (Protocol_options::DEFAULT == am)
-    am = secure_conn ? Protocol_options::PLAIN : Protocol_options::MYSQL41;
+  {
+    /*
+      Prefer the mechanism that worked for this data source last time,
+      if known - each probe that fails while walking the fallback chain
+      below costs a server round trip.
+    */
+
+    am = options.auth_method_hint();
+    if (Protocol_options::DEFAULT == am)
+      am = secure_conn ? Protocol_options::PLAIN : Protocol_options::MYSQL41;
+  }
 
   switch (am)
   {
@@ -632,7 +666,10 @@ void Session::do_authenticate(const Options &options,
   }
 
   if (m_auth->get_result())
+  {
+    m_used_auth_method = (Protocol_options::auth_method_t)am;
     return;
+  }
 
   // second attempt
 
@@ -641,13 +678,29 @@ void Session::do_authenticate(const Options &options,
     //Cleanup Diagnostic_area
     clear_errors();
 
-    m_auth.reset(new AuthSha256Memory(*this, options));
+    /*
+      Note: When the first attempt was made with the hinted mechanism
+      SHA256_MEMORY (which can go stale, e.g. after a server restart
+      cleared its cache), fall back to MYSQL41; otherwise the chain is
+      the usual MYSQL41 -> SHA256_MEMORY.
+    */
+
+    auto second_am = Protocol_options::SHA256_MEMORY == am ?
+                     Protocol_options::MYSQL41 :
+                     Protocol_options::SHA256_MEMORY;
+
+    if (Protocol_options::MYSQL41 == second_am)
+      m_auth.reset(new AuthMysql41(*this, options));
+    else
+      m_auth.reset(new AuthSha256Memory(*this, options));
 
     if (!m_auth->get_result())
     {
       throw_error("Authentication failed using MYSQL41 and SHA256_MEMORY, "
                     "check username and password or try a secure connection");
     }
+
+    m_used_auth_method = second_am;
   }
 }
 
@@ -672,6 +725,9 @@ Session::~Session()
     // Something went wrong - do not try to use this session again.
     m_isvalid = false;
   }
+
+  for (Mdata_storage *mdata : m_mdata_pool)
+    delete mdata;
 }
 
 
@@ -727,8 +783,82 @@ public:
 
 };
 
+// Defined below, before clean_up().
+
+void discard_results(Stmt_op *stmt);
+
+
+void Session::check_pending_reset()
+{
+  if (!m_pending_reset)
+    return;
+
+  m_pending_reset->wait();
+
+  // A failed reset means the session can not be re-used.
+
+  if (m_pending_reset->entry_count())
+    m_isvalid = false;
+
+  m_pending_reset.reset();
+}
+
+
+bool Session::reset_async()
+{
+  // Nothing to do if the session was already reset and not used since.
+
+  if (m_clean)
+    return true;
+
+  check_pending_reset();
+
+  if (!is_valid())
+    return false;
+
+  /*
+    The pipelined variant covers only servers which keep the session open
+    after a reset. Whether the server does so is known only after the
+    first blocking reset() checked the KEEP_OPEN expectation.
+  */
+
+  if (has_protocol_field(Protocol_fields::KEEP_OPEN).state()
+      != option_t::YES)
+    return false;
+
+  /*
+    Note: unlike the blocking reset(), no explicit ROLLBACK statement is
+    issued here - Mysqlx.Session.Reset rolls back the open transaction
+    (if any) server-side, so the rollback piggybacks on the reset
+    command.
+  */
+
+  discard_results(m_last_stmt);
+  clear_errors();
+
+  /*
+    Register the reset operation and drive it until the command is in the
+    write buffer, without waiting for the confirmation. The reply is
+    consumed through the statement queue, before the reply to the first
+    statement executed after the reset (or by check_pending_reset() if no
+    statement follows).
+  */
+
+  m_pending_reset.reset(new Reset_op(*this, true));
+  while (!m_pending_reset->stmt_sent())
+    m_pending_reset->cont();
+
+  // Note: set after the Reset_op registration cleared it.
+
+  m_clean = true;
+
+  return true;
+}
+
+
 void Session::reset()
 {
+  check_pending_reset();
   clean_up();
 
   if (is_valid())
@@ -746,20 +876,41 @@ void Session::reset()
       keep_open = has_protocol_field(Protocol_fields::KEEP_OPEN);
     }
 
-    Reset_op reset(*this, keep_open);
-    reset.wait();
-
-    if (!keep_open)
+    if (keep_open)
     {
-      // Re-authenticate for servers not supporting keep-open
+      Reset_op reset(*this, true);
+      reset.wait();
+    }
+    else
+    {
+      /*
+        Servers which do not support keep-open expect re-authentication
+        after a session reset. The authentication handshake is a
+        challenge-response exchange whose response depends on a fresh
+        server nonce, so it cannot be short-circuited - but the
+        AuthenticateStart message can be sent right behind the reset
+        message, merging the reset confirmation and the start of the
+        handshake into a single round trip.
+      */
+
       m_isvalid = false;
       clear_errors();
+
+      m_protocol.snd_SessionReset(false).wait();
       m_auth->restart();
+
+      // The reset reply precedes the authentication replies on the wire.
+
+      m_protocol.rcv_Reply(*this).wait();
+
       m_auth->wait();
       if (entry_count())
         get_error().rethrow();
       m_isvalid = m_auth->get_result();
     }
+
+    if (m_isvalid.state() == option_t::YES)
+      m_clean = true;
   }
 }
 
@@ -792,6 +943,8 @@ void Session::clean_up()
 
 void Session::close()
 {
+  check_pending_reset();
+
   if (is_valid())
   try {
     clean_up();
@@ -822,6 +975,10 @@ void Session::register_stmt(Stmt_op *stmt)
 
   stmt->m_session = this;
 
+  // Whatever the statement does, the session is no longer clean.
+
+  m_clean = false;
+
   // Append stmt to the end of the list of active statements.
 
   stmt->m_prev_stmt = m_last_stmt;
@@ -858,6 +1015,150 @@ void Session::deregister_stmt(Stmt_op *stmt)
 }
 
 
+/*
+  Return a meta-data store for use by a statement executed in this session,
+  recycling one returned by a previous statement if possible (see
+  m_mdata_pool).
+*/
+
+Mdata_storage* Session::get_mdata_storage()
+{
+  if (m_mdata_pool.empty())
+    return new Mdata_storage();
+
+  Mdata_storage *mdata = m_mdata_pool.back();
+  m_mdata_pool.pop_back();
+
+  /*
+    Reset the recycled entries in place - this keeps the map nodes and the
+    capacity of the string buffers inside them. Entries which the next
+    result set does not use are dropped in Stmt_op::col_count().
+  */
+
+  for (auto &col : *mdata)
+    col.second = Col_metadata();
+
+  return mdata;
+}
+
+
+void Session::recycle_mdata_storage(Mdata_storage *mdata)
+{
+  if (!mdata)
+    return;
+
+  PUSH_SYS_WARNINGS_CDK
+  m_mdata_pool.push_back(mdata);
+  POP_SYS_WARNINGS_CDK
+}
+
+
+/*
+  Statement pipelining
+  ====================
+*/
+
+
+// Expectation list which sets the single no_error condition.
+
+struct No_error_expectation
+  : public protocol::mysqlx::api::Expectations
+{
+  void process(Processor &prc) const
+  {
+    prc.list_begin();
+    prc.list_el()->set(NO_ERROR);
+    prc.list_end();
+  }
+};
+
+
+/*
+  Statement operation which closes the expectation block opened around
+  a pipelined batch. Sending it appends Expect_Close as the last command
+  of the batch; its OK reply is consumed through the regular statement
+  queue, after the replies to all statements of the batch.
+*/
+
+class Cmd_ExpectClose
+  : public Stmt_op
+{
+public:
+
+  Cmd_ExpectClose(Session &s)
+    : Stmt_op(s)
+  {}
+
+  Proto_op* send_cmd() override
+  {
+    return &get_protocol().snd_Expect_Close();
+  }
+};
+
+
+void Session::start_pipeline(bool expect_no_error)
+{
+  m_protocol.start_Pipeline();
+  m_pipeline_active = true;
+
+  if (!expect_no_error)
+    return;
+
+  /*
+    Open an expectation block around the batch. Inside a pipeline
+    snd_Expect_Open() only appends the command to the write buffer, so
+    waiting for it returns at once.
+  */
+
+  No_error_expectation exp;
+  m_protocol.snd_Expect_Open(exp, false).wait();
+  m_pipeline_expect = true;
+}
+
+
+void Session::flush_pipeline()
+{
+  m_pipeline_active = false;
+
+  if (m_pipeline_expect)
+  {
+    m_pipeline_expect = false;
+
+    /*
+      Register the operation closing the expectation block and drive it
+      (and, through the statement queue, any batch statement which did not
+      send its commands yet) until Expect_Close is in the write buffer.
+    */
+
+    m_expect_close.reset(new Cmd_ExpectClose(*this));
+    while (!m_expect_close->stmt_sent())
+      m_expect_close->cont();
+
+    m_protocol.snd_Pipeline().wait();
+
+    /*
+      The first reply to the batch is the OK for Expect_Open - consume it
+      here, before any statement starts reading its own reply. The OK for
+      Expect_Close is consumed by m_expect_close once the replies to all
+      batch statements were processed.
+    */
+
+    m_protocol.rcv_Reply(*this).wait();
+    return;
+  }
+
+  m_protocol.snd_Pipeline().wait();
+}
+
+
+void Session::clear_pipeline()
+{
+  m_pipeline_active = false;
+  m_pipeline_expect = false;
+  m_protocol.clear_Pipeline();
+}
+
+
 
 Reply_init
 Session::sql(uint32_t stmt_id,const string &stmt, Any_list *args)
@@ -931,11 +1232,12 @@ void Session::savepoint_remove(const string &savepoint)
 
 
 Reply_init Session::prepared_execute(
-  uint32_t stmt_id, const Limit *lim, const Param_source *param
+  uint32_t stmt_id, const Limit *lim, const Param_source *param,
+  bool compact_metadata
 )
 {
   return new
-      Prepared<Query_stmt>(*this, stmt_id, lim, param);
+      Prepared<Query_stmt>(*this, stmt_id, lim, param, compact_metadata);
 }
 
 Reply_init Session::prepared_execute(
@@ -1144,6 +1446,15 @@ void Session::notice(unsigned int type, short int scope, bytes payload)
 {
   using namespace protocol::mysqlx;
 
+  /*
+    Hand global notices to a subscribed handler first (including types
+    this session does not process itself, such as group replication
+    state changes).
+  */
+
+  if (notice_scope::GLOBAL == scope && m_notice_handler)
+    m_notice_handler(type, payload);
+
   switch (type)
   {
   case notice_type::Warning:
@@ -424,17 +424,28 @@ protected:
   bool m_prepare_error = false;
   bool m_receive_prepare = false;
 
+  /*
+    If set, the execute command asks the server to omit textual column
+    meta-data (names etc.) from the reply. Only used when the caller
+    already holds full meta-data from an earlier execution of the same
+    prepared statement.
+  */
+
+  bool m_compact_metadata = false;
+
 public:
 
   Prepared(
     Session &s,
     uint32_t stmt_id,
     const cdk::Limit *lim,
-    const Param_source *param
+    const Param_source *param,
+    bool compact_metadata = false
   )
   : Base(s, stmt_id != 0)
     , m_stmt_id(stmt_id)
     , m_limit(lim)
+    , m_compact_metadata(compact_metadata)
   {
     if (param)
     {
@@ -474,9 +485,10 @@ public:
   {
     uint32_t id = m_stmt_id;
     m_stmt_id = 0;  // so that we directly process reply to Execute
-    if (m_limit || m_param_map)
+    if (m_limit || m_param_map || m_compact_metadata)
     {
-      return &Base::get_protocol().snd_PrepareExecute(id, m_limit, m_param_map);
+      return &Base::get_protocol().snd_PrepareExecute(
+                id, m_limit, m_param_map, m_compact_metadata);
     }
     else
     {
@@ -96,11 +96,20 @@ namespace parser {
       return nullptr != strchr(set, *(char*)cur_pos());
     }
 
-    static std::locale m_cloc;
+    /*
+      The "C" locale used for character classification, created on first
+      use so that loading the library runs no locale constructor.
+    */
+
+    static const std::locale& cloc()
+    {
+      static const std::locale c_locale("C");
+      return c_locale;
+    }
 
     bool cur_char_is_space() const noexcept
     {
-      static const std::ctype<char> &ctf = std::use_facet<std::ctype<char>>(m_cloc);
+      static const std::ctype<char> &ctf = std::use_facet<std::ctype<char>>(cloc());
       assert(!at_end());
       return ctf.is(ctf.space, *(char*)cur_pos());
     }
@@ -109,7 +118,7 @@ namespace parser {
 
     bool cur_char_is_word() const noexcept
     {
-      static const std::ctype<char> &ctf = std::use_facet<std::ctype<char>>(m_cloc);
+      static const std::ctype<char> &ctf = std::use_facet<std::ctype<char>>(cloc());
       assert(!at_end());
       char c = *(char*)cur_pos();
       if ('_' == c)
@@ -216,12 +225,36 @@ namespace parser {
 
     bool skip_ws() noexcept
     {
-      bool ret = false;
+      bool ret = skip_ws_run();
       for (; !at_end() && cur_char_is_space(); ret=true, next_unit());
       return ret;
     }
 
 
+    // -- Bulk scanning ------------------------------------------------------
+
+    /*
+      Methods which skip the longest run of characters of a given class,
+      examining 16 input bytes at a time where SSE2 is available (see the
+      scan kernels in tokenizer.cc). All the classes consist of ASCII
+      characters only, so single-byte classification is exact: bytes
+      >= 0x80 never match, end the run and are left to the scalar,
+      decoding paths. Return true if at least one character was skipped.
+    */
+
+    bool skip_ws_run() noexcept;
+    bool skip_digit_run() noexcept;
+    bool skip_word_run() noexcept;
+
+    /*
+      Skip the longest run of plain quoted string body characters: ASCII
+      characters other than the given quote character and the '\\' escape
+      character.
+    */
+
+    bool skip_string_run(char qchar) noexcept;
+
+
     // -- Other --------------------------------------------------------------
 
 
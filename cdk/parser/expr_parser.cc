@@ -46,15 +46,234 @@ using cdk::safe_prc;
 
 
 /*
-  Set up keyword and operator maps.
+  Keyword and operator lookup tables.
 */
 
-Keyword::map_t  Keyword::kw_map;
-Keyword         Keyword::init;
+/*
+  The keyword table generated from KEYWORD_LIST() declarations. Entries
+  are string literals and enum constants, so the table is
+  constant-initialized by the compiler.
+*/
+
+#define kw_entry_add(A,B)  { B, sizeof(B) - 1, Keyword::A },
+
+const Keyword::kw_entry Keyword::kw_list[] = {
+  KEYWORD_LIST(kw_entry_add)
+};
+
+const size_t Keyword::kw_count
+  = sizeof(Keyword::kw_list) / sizeof(Keyword::kw_list[0]);
+
+
+Keyword::Type Keyword::lookup(const char *word, size_t len)
+{
+  /*
+    Index of kw_list: keywords are bucketed by their first letter and a
+    bucket holds only a few of them. The index is built from the keyword
+    table on first use.
+  */
+
+  static const struct index_t
+  {
+    enum { BUCKETS = 26, DEPTH = 8 };
+
+    unsigned char m_count[BUCKETS];
+    unsigned char m_bucket[BUCKETS][DEPTH];
+
+    index_t()
+    {
+      memset(m_count, 0, sizeof(m_count));
+
+      for (size_t i = 0; i < kw_count; ++i)
+      {
+        unsigned b = unsigned(kw_list[i].name[0] - 'a');
+        assert(b < BUCKETS && m_count[b] < DEPTH);
+        m_bucket[b][m_count[b]++] = (unsigned char)i;
+      }
+    }
+  }
+  index;
+
+  // The longest keyword has 11 characters ("microsecond").
+
+  static const size_t max_len = 11;
+
+  if (0 == len || len > max_len)
+    return NONE;
+
+  char c0 = lower(word[0]);
+
+  if (c0 < 'a' || 'z' < c0)
+    return NONE;
+
+  // Lower-case the word once, then compare against the few candidates
+  // of its bucket with plain memcmp.
+
+  char low[max_len];
 
-Op::tok_map_t   Op::unary_tok_map, Op::binary_tok_map;
-Op::kw_map_t    Op::unary_kw_map, Op::binary_kw_map;
-Op              Op::init;
+  for (size_t i = 0; i < len; ++i)
+    low[i] = lower(word[i]);
+
+  unsigned b = unsigned(c0 - 'a');
+
+  for (unsigned k = 0; k < index.m_count[b]; ++k)
+  {
+    const kw_entry &entry = kw_list[index.m_bucket[b][k]];
+
+    if (entry.len == len && 0 == memcmp(low, entry.name, len))
+      return entry.type;
+  }
+
+  return NONE;
+}
+
+
+/*
+  The operator tables, filled from UNARY/BINARY_OP() declarations on
+  first use. Entries for tokens and keywords which do not name an
+  operator hold Op::NONE.
+*/
+
+Op::tables_t::tables_t()
+{
+  std::fill_n(unary_tok, size_t(TOKEN_COUNT), NONE);
+  std::fill_n(unary_kw, size_t(KEYWORD_COUNT), NONE);
+  std::fill_n(binary_tok, size_t(TOKEN_COUNT), NONE);
+  std::fill_n(binary_kw, size_t(KEYWORD_COUNT), NONE);
+
+#define op_add(X, A,B,T,K) \
+  for(Token::Type tt : Token::Set T) \
+    X##_tok[tt] = Op::A; \
+  for(Keyword::Type kk : Keyword::Set K) \
+    X##_kw[kk] = Op::A;
+
+#define op_add_unary(A,B,T,K)   op_add(unary,A,B,T,K)
+#define op_add_binary(A,B,T,K)  op_add(binary,A,B,T,K)
+
+  UNARY_OP(op_add_unary)
+  BINARY_OP(op_add_binary)
+}
+
+
+const Op::tables_t& Op::tables()
+{
+  static const tables_t instance;
+  return instance;
+}
+
+
+// -------------------------------------------------------------------------
+
+/*
+  Arena allocation of stored expression nodes.
+*/
+
+// Alignment sufficient for any node type.
+
+union arena_align_t { long double m_fp; void *m_ptr; uint64_t m_int; };
+
+
+void* Expr_arena::alloc(size_t size)
+{
+  static const size_t align = alignof(arena_align_t);
+
+  size = (size + align - 1) & ~(align - 1);
+
+  // Take the bytes from the current block if they fit, moving on to the
+  // following blocks kept from before the last reset() otherwise.
+
+  while (m_current < m_blocks.size())
+  {
+    Block &blk = m_blocks[m_current];
+
+    if (m_used + size <= blk.m_size)
+    {
+      void *ptr = blk.m_data + m_used;
+      m_used += size;
+      return ptr;
+    }
+
+    ++m_current;
+    m_used = 0;
+  }
+
+  // Start a new block, sized up for over-sized requests.
+
+  m_blocks.reserve(m_blocks.size() + 1);
+
+  Block blk = { NULL, size > BLOCK_SIZE ? size : (size_t)BLOCK_SIZE };
+  blk.m_data = new char[blk.m_size];
+  m_blocks.push_back(blk);
+
+  m_current = m_blocks.size() - 1;
+  m_used = size;
+  return blk.m_data;
+}
+
+
+/*
+  The arena, if any, which stored expression nodes created by this
+  thread are allocated from (see Expr_arena::Scope).
+*/
+
+static thread_local Expr_arena *current_arena = NULL;
+
+
+Expr_arena::Scope::Scope(Expr_arena &arena)
+  : m_prev(current_arena)
+{
+  current_arena = &arena;
+}
+
+
+Expr_arena::Scope::~Scope()
+{
+  current_arena = m_prev;
+}
+
+
+/*
+  Each node is prefixed with an (alignment preserving) header whose
+  first byte records whether the node was taken from an arena, so that
+  heap nodes and arena nodes can be deleted through the same pointers.
+*/
+
+static const size_t node_header = alignof(arena_align_t);
+
+
+void* Arena_allocated::operator new(size_t size)
+{
+  char *raw;
+  char  tag;
+
+  if (current_arena)
+  {
+    raw = (char*)current_arena->alloc(node_header + size);
+    tag = 1;
+  }
+  else
+  {
+    raw = (char*)::operator new(node_header + size);
+    tag = 0;
+  }
+
+  raw[0] = tag;
+  return raw + node_header;
+}
+
+
+void Arena_allocated::operator delete(void *ptr)
+{
+  if (!ptr)
+    return;
+
+  char *raw = (char*)ptr - node_header;
+
+  if (0 == raw[0])
+    ::operator delete(raw);
+
+  // Note: arena nodes are reclaimed wholesale by Expr_arena::reset().
+}
 
 
 // -------------------------------------------------------------------------
@@ -1911,6 +2130,9 @@ void Order_parser::parse(Processor& prc)
   if (!tokens_available())
     parse_error("Expected sorting order specification");
 
+  m_arena.reset();
+  Expr_arena::Scope arena_scope(m_arena);
+
   Stored_any store_expr;
 
   Expr_parser_base parser(cur_pos(), end_pos(), m_mode);
@@ -1952,6 +2174,9 @@ void Projection_parser::parse_tbl_mode(Projection_processor& prc)
   if (!tokens_available())
     parse_error("Expected projection specification");
 
+  m_arena.reset();
+  Expr_arena::Scope arena_scope(m_arena);
+
   Expr_parser_base parser(cur_pos(), end_pos(), m_mode);
   parser.process_if(prc.expr());
 
@@ -1982,6 +2207,9 @@ void Projection_parser::parse_doc_mode(Document_processor& prc)
   if (!tokens_available())
     parse_error("Expected projection specification");
 
+  m_arena.reset();
+  Expr_arena::Scope arena_scope(m_arena);
+
   /*
     note: passing m_toks.end() directly as constructor argument results
     in "incompatible iterators" exception when comparing iterators (at
@@ -239,60 +239,59 @@ public:
     keywords.
 
     TODO: First argument can be a cdk string - avoid utf8 conversion.
-    TODO: Simpler implementation that is not sensitive to locale settings.
   */
 
   static bool equal(const string &a, const string &b)
   {
-    static kw_cmp  cmp;
+    if (a.length() != b.length())
+      return false;
+
+    for (size_t i = 0; i < a.length(); ++i)
+      if (lower(a[i]) != lower(b[i]))
+        return false;
 
-    return (!cmp(a, b) && !cmp(b, a));
+    return true;
   }
 
 private:
 
-  struct kw_cmp
+  /*
+    ASCII lower-case conversion used when matching keywords. Keywords
+    consist of ASCII letters only, so locale settings are irrelevant
+    here.
+  */
+
+  static char lower(char c)
   {
-    struct char_cmp
-    {
-      bool operator()(char, char) const;
-    };
+    return ('A' <= c && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+  }
 
-    bool operator()(const std::string &a, const std::string &b) const
-    {
-      static char_cmp cmp;
-      return std::lexicographical_compare(
-        a.begin(), a.end(),
-        b.begin(), b.end(), cmp
-      );
-    }
+  // One entry of the keyword table.
+
+  struct kw_entry
+  {
+    const char *name;
+    unsigned    len;
+    Type        type;
   };
 
   /*
-    Map which maps words to keyword ids. Case insensitive comparison is
-    used to locate words in this map.
+    Table of keywords generated from KEYWORD_LIST() declarations (see
+    expr_parser.cc). Unlike the std::map used before, the table is
+    constant-initialized - no initialization code runs at program
+    start-up.
   */
 
-  typedef std::map<std::string, Type, kw_cmp> map_t;
-
-  static map_t kw_map;
+  static const kw_entry kw_list[];
+  static const size_t   kw_count;
 
   /*
-    Default ctor builds the keyword map based on keyword declarations given
-    by KEYWORD_LIST() macro.
+    Classify a word of the given length: hash it to a bucket of few
+    keywords and compare, case insensitively, against each of them.
+    Returns NONE if the word is not a keyword.
   */
 
-  Keyword()
-  {
-
-#define kw_add(A,B)  kw_map[B] = A;
-
-    KEYWORD_LIST(kw_add);
-  }
-
-  // This initializer instance makes sure that the keyword map is built.
-
-  static Keyword init;
+  static Type lookup(const char *word, size_t len);
 };
 
 
@@ -304,12 +303,11 @@ Keyword::Type Keyword::get(const Token &t)
   if (Token::WORD != t.get_type())
     return NONE;
 
-  // Locate WORD in the keyword map.
-  cdk::bytes data = t.get_bytes();
+  // Locate WORD in the keyword table.
 
-  auto x = kw_map.find(std::string((const char*)data.begin(), data.size()));
+  cdk::bytes data = t.get_bytes();
 
-  return (x == kw_map.end() ? NONE : x->second);
+  return lookup((const char*)data.begin(), data.size());
 }
 
 
@@ -319,27 +317,6 @@ bool operator==(Keyword::Type type, const Token &tok)
   return type == Keyword::get(tok);
 }
 
-
-#if 1
-
-inline
-bool Keyword::kw_cmp::char_cmp::operator()(char a, char b) const
-{
-  /*
-    Note: Explicitly using "C" locale's ctype facet to not depend on
-    default locale settings. This comparison needs to work correctly only
-    for ASCII characters. (only these characters are used in keywords).
-  */
-
-  static std::locale c_loc("C");
-  static const auto &ctf
-    = std::use_facet<std::ctype<char>>(c_loc);
-
-  return ctf.tolower(a) < ctf.tolower(b);
-}
-
-#endif
-
 // --------------------------------------------------------------------------
 
 /*
@@ -401,74 +378,67 @@ public:
 private:
 
   /*
-    Maps used to recognize operators.
-
-    Operator can be a keyword or other token. For each kind of operator (unary
-    or binary) we have two maps. One map maps keyword ids to operators. The
-    other map maps other token types to operators. These maps are filled based
-    on the information given by UNARY/BINARY_OP() macros that declare
-    operators.
+    Lookup tables used to recognize operators.
+
+    Operator can be a keyword or other token. For each kind of operator
+    (unary or binary) we have two flat arrays, one indexed by token type
+    and one indexed by keyword id, filled based on the information given
+    by UNARY/BINARY_OP() macros. The arrays are built on first use (see
+    expr_parser.cc), so no initialization code runs at program start-up,
+    and recognizing an operator is a single array access.
   */
 
-  typedef std::map<Token::Type, Type>   tok_map_t;
-  typedef std::map<Keyword::Type, Type> kw_map_t;
-
-  static tok_map_t  unary_tok_map;
-  static kw_map_t   unary_kw_map;
+#define op_count_token(T,X)  +1
+#define op_count_kw(A,B)     +1
 
-  static tok_map_t  binary_tok_map;
-  static kw_map_t   binary_kw_map;
+  enum {
+    TOKEN_COUNT   = 1 TOKEN_LIST(op_count_token),
+    KEYWORD_COUNT = 1 KEYWORD_LIST(op_count_kw)
+  };
 
-  Op()
+  struct tables_t
   {
+    Type unary_tok[TOKEN_COUNT];
+    Type unary_kw[KEYWORD_COUNT];
+    Type binary_tok[TOKEN_COUNT];
+    Type binary_kw[KEYWORD_COUNT];
 
-#define op_add(X, A,B,T,K) \
-  for(Token::Type tt : Token::Set T) \
-    X##_tok_map[tt] = Op::A; \
-  for(Keyword::Type kk : Keyword::Set K) \
-    X##_kw_map[kk] = Op::A;
-
-#define op_add_unary(A,B,T,K)   op_add(unary,A,B,T,K)
-#define op_add_binary(A,B,T,K)  op_add(binary,A,B,T,K)
-
-    UNARY_OP(op_add_unary)
-    BINARY_OP(op_add_binary)
-  }
+    tables_t();
+  };
 
-  static Op init;
+  static const tables_t& tables();
 };
 
 
 inline
 Op::Type Op::get_unary(const Token &tok)
 {
-  // First check the token map.
+  const tables_t &t = tables();
+
+  // First check the token table.
 
-  auto find = unary_tok_map.find(tok.get_type());
-  if (find != unary_tok_map.end())
-    return find->second;
+  Type op = t.unary_tok[tok.get_type()];
+  if (NONE != op)
+    return op;
 
-  // If operator not found, try keyword map.
+  // If operator not found, try the keyword table.
 
   Keyword::Type kw = Keyword::get(tok);
-  if (Keyword::NONE == kw)
-    return NONE;
-  auto find1 = unary_kw_map.find(kw);
-  return find1 == unary_kw_map.end() ? NONE : find1->second;
+  return Keyword::NONE == kw ? NONE : t.unary_kw[kw];
 }
 
 
 inline
 Op::Type Op::get_binary(const Token &tok)
 {
-  auto find = binary_tok_map.find(tok.get_type());
-  if (find != binary_tok_map.end())
-    return find->second;
+  const tables_t &t = tables();
+
+  Type op = t.binary_tok[tok.get_type()];
+  if (NONE != op)
+    return op;
+
   Keyword::Type kw = Keyword::get(tok);
-  if (Keyword::NONE == kw)
-    return NONE;
-  auto find1 = binary_kw_map.find(kw);
-  return find1 == binary_kw_map.end() ? NONE : find1->second;
+  return Keyword::NONE == kw ? NONE : t.binary_kw[kw];
 }
 
 
@@ -836,12 +806,119 @@ private:
 };
 
 
+/*
+  Bump arena for stored expression nodes.
+
+  The nodes which store partial parsing results (see below) are small,
+  numerous and all die before a parse call returns. This makes them a
+  good fit for a bump allocator: an allocation just moves a pointer
+  within a block and reset() makes all blocks available for re-use
+  without returning them to the heap. A parser which owns an arena and
+  resets it between parses performs no steady-state heap allocation for
+  nodes once the arena has grown to the size of its workload.
+*/
+
+class Expr_arena
+{
+public:
+
+  Expr_arena()
+  {}
+
+  ~Expr_arena()
+  {
+    for (Block &blk : m_blocks)
+      delete[] blk.m_data;
+  }
+
+  // Return size bytes of memory, aligned for any node type.
+
+  void* alloc(size_t size);
+
+  /*
+    Make all arena memory available for re-use. Must be called only when
+    no node allocated from the arena is alive any more.
+  */
+
+  void reset()
+  {
+    m_current = 0;
+    m_used = 0;
+  }
+
+  /*
+    While a Scope instance exists, stored expression nodes created by
+    the current thread are allocated from the given arena (see
+    Arena_allocated below).
+  */
+
+  class Scope
+  {
+    Expr_arena *m_prev;
+
+  public:
+
+    Scope(Expr_arena&);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+private:
+
+  static const size_t BLOCK_SIZE = 4 * 1024;
+
+  struct Block
+  {
+    char   *m_data;
+    size_t  m_size;
+  };
+
+  std::vector<Block> m_blocks;
+  size_t m_current = 0;   // block the next allocation is taken from
+  size_t m_used = 0;      // bytes used within the current block
+
+  Expr_arena(const Expr_arena&) = delete;
+  Expr_arena& operator=(const Expr_arena&) = delete;
+};
+
+
+/*
+  Base class for the stored expression nodes, which routes their
+  allocation to the arena bound to the current thread, if any.
+
+  While an Expr_arena::Scope is active, nodes are taken from its arena
+  and deleting a node only runs its destructor - the memory is reclaimed
+  wholesale by Expr_arena::reset(). Without a bound arena nodes live on
+  the heap as before. A small header in front of each node records where
+  it was allocated, so that nodes from both sources can be deleted
+  through the same pointers.
+*/
+
+struct Arena_allocated
+{
+  static void* operator new(size_t);
+  static void  operator delete(void*);
+};
+
+
+
 class Expression_parser
   : public Expression
 {
   Tokenizer m_tokenizer;
   Parser_mode::value m_mode;
 
+  /*
+    Arena for expression nodes stored while parsing. All such nodes die
+    before process() returns, so the arena memory is re-used by the next
+    process() call and a re-used parser instance does not allocate in
+    steady state.
+  */
+
+  mutable Expr_arena m_arena;
+
 public:
 
 
@@ -859,6 +936,9 @@ public:
     if (m_tokenizer.empty())
       throw Expr_token_base::Error(first, "Expected an expression");
 
+    m_arena.reset();
+    Expr_arena::Scope arena_scope(m_arena);
+
     /*
       note: passing m_toks.end() directly as constructor argument results
       in "incompatible iterators" exception when comparing iterators (at
@@ -899,6 +979,10 @@ class Order_parser
   Tokenizer m_tokenizer;
   Parser_mode::value m_mode;
 
+  // Arena for nodes stored while parsing (see Expression_parser).
+
+  Expr_arena m_arena;
+
 public:
 
   Order_parser(Parser_mode::value parser_mode, bytes expr)
@@ -948,6 +1032,10 @@ class Projection_parser
   Parser_mode::value m_mode;
   It m_it;
 
+  // Arena for nodes stored while parsing (see Expression_parser).
+
+  Expr_arena m_arena;
+
 public:
 
   Projection_parser(Parser_mode::value parser_mode, bytes expr)
@@ -1033,6 +1121,7 @@ public:
 struct Stored_expr
   : public Expression
   , public Expression::Processor
+  , public Arena_allocated
 {
   virtual ~Stored_expr() {}
 };
@@ -1068,6 +1157,7 @@ struct Stored_any
 struct Stored_list
   : public Expression::List
   , public Expression::List::Processor
+  , public Arena_allocated
 {
   typedef std::vector<Stored_expr*> Ptr_list;
   Ptr_list m_elements;
@@ -1113,6 +1203,7 @@ struct Stored_list
 struct Stored_doc
   : public Expression::Document
   , public Expression::Document::Processor
+  , public Arena_allocated
 {
   typedef std::map<cdk::string, scoped_ptr<Stored_expr> > Ptr_map;
   Ptr_map m_keyval_map;
@@ -1160,6 +1251,7 @@ struct Stored_scalar
   , public Expression::Scalar::Processor
   , public Expression::List::Processor
   , public cdk::Value_processor
+  , public Arena_allocated
 {
   // Storage for the values
 
@@ -30,6 +30,35 @@
 
 #include "json_parser.h"
 #include <mysql/cdk.h>
+
+/*
+  Enable SSE2 code paths of the rapidjson reader (bulk whitespace
+  skipping and string scanning) on platforms which guarantee SSE2.
+  Same platform logic as CDK_TRANSCODE_SSE2 in foundation/string.h.
+  This translation unit is the only one which includes the reader,
+  so the setting has no effect on other uses of rapidjson.
+
+  Note: The SSE2 scanning loops use aligned loads which can read (but
+  never use) bytes past the end of the parsed string. Such reads stay
+  within the 16-byte line of the last byte and never cross a page
+  boundary, but AddressSanitizer reports them, so the code paths are
+  not enabled in sanitized builds.
+*/
+
+#if defined(__SANITIZE_ADDRESS__)
+#define JSON_PARSER_SANITIZED
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define JSON_PARSER_SANITIZED
+#endif
+#endif
+
+#if !defined(JSON_PARSER_SANITIZED) \
+    && (defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define RAPIDJSON_SSE2
+#endif
+
 PUSH_SYS_WARNINGS_CDK
 #include "rapidjson/reader.h"
 #include "rapidjson/error/en.h"
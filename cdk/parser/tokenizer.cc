@@ -163,7 +163,7 @@ bool Tokenizer::iterator::get_next_token()
 
 bool Tokenizer::iterator::parse_digits() noexcept
 {
-  bool has_digits = false;
+  bool has_digits = skip_digit_run();
 
   while (!char_iterator::at_end() && cur_char_in("0123456789"))
   {
@@ -334,7 +334,7 @@ bool Tokenizer::iterator::parse_word()
     return true;
   }
 
-  bool has_word = false;
+  bool has_word = skip_word_run();
 
   while (!char_iterator::at_end() && cur_char_is_word())
   {
@@ -387,6 +387,22 @@ bool Tokenizer::iterator::parse_quotted_string(char qchar)
 
   while (!char_iterator::at_end())
   {
+    /*
+      Fast-forward over the plain body of the string, but only once the
+      first start_len characters were seen, so that the error message
+      context is collected by the per-character path below. The bulk
+      scan stops at the quote character, at an escape and at non-ASCII
+      bytes, which are decoded (and so validated) as before.
+    */
+
+    if (char_iterator::cur_pos() >= start_pos + start_len)
+    {
+      skip_string_run(qchar);
+
+      if (char_iterator::at_end())
+        break;
+    }
+
     // if we do not have escaped char, look at the end of the string
 
     if (!consume_char('\\'))
@@ -417,11 +433,225 @@ bool Tokenizer::iterator::parse_quotted_string(char qchar)
 
 
 /*
-  Low-level character iterator.
+  Scan kernels used by the bulk skip methods below.
+
+  The tokenizer spends most of its time advancing over long homogeneous
+  runs - whitespace between tokens, identifier characters, digit runs and
+  quoted string bodies. Each kernel returns the first position in
+  [beg, end) which is not in the scanned class, examining 16 input bytes
+  at a time where SSE2 is available (CDK_TRANSCODE_SSE2, see
+  foundation/string.h) and leaving the exact boundary to a scalar loop.
+
+  All the scanned classes consist of ASCII characters only, so bytes
+  >= 0x80 never belong to a class and end the run - multi-byte utf8
+  characters are handled by the scalar decoding paths of the tokenizer.
+*/
+
+namespace {
+
+#ifdef CDK_TRANSCODE_SSE2
+
+/*
+  Runtime dispatch flag for the vector kernels, resolved on first use
+  (see foundation/cpu_dispatch.h). SSE2 is part of the compile-time
+  baseline wherever CDK_TRANSCODE_SSE2 is defined, so this reads true
+  unless the CDK_CPU_BASELINE override forces the scalar paths.
 */
 
+inline bool use_sse2()
+{
+  static const bool flag = cdk::foundation::cpu_features().sse2;
+  return flag;
+}
+
+/*
+  Return mask of bytes of the chunk which are inside the given inclusive
+  range of ASCII characters. After subtracting lo, class members are
+  exactly the values 0 .. hi-lo; anything else, including bytes >= 0x80,
+  falls outside of that range in signed byte arithmetic.
+*/
+
+inline __m128i in_range_mask(__m128i chunk, char lo, char hi)
+{
+  __m128i t = _mm_sub_epi8(chunk, _mm_set1_epi8(lo));
+  return _mm_and_si128(
+    _mm_cmpgt_epi8(t, _mm_set1_epi8(-1)),
+    _mm_cmplt_epi8(t, _mm_set1_epi8((char)(hi - lo + 1)))
+  );
+}
+
+#endif
+
+
+const char* scan_ws(const char *beg, const char *end)
+{
+#ifdef CDK_TRANSCODE_SSE2
+
+  // Note: the "C" locale white-space characters are ' ' and the
+  // contiguous range '\t' .. '\r'.
+
+  while (use_sse2() && beg + 16 <= end)
+  {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg));
+    __m128i ws = _mm_or_si128(
+      _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+      in_range_mask(chunk, '\t', '\r')
+    );
+    if (0xFFFF != _mm_movemask_epi8(ws))
+      break;
+    beg += 16;
+  }
+
+#endif
+
+  for (; beg < end && (' ' == *beg || ('\t' <= *beg && *beg <= '\r')); ++beg);
+  return beg;
+}
+
+
+const char* scan_digits(const char *beg, const char *end)
+{
+#ifdef CDK_TRANSCODE_SSE2
+
+  while (use_sse2() && beg + 16 <= end)
+  {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg));
+    if (0xFFFF != _mm_movemask_epi8(in_range_mask(chunk, '0', '9')))
+      break;
+    beg += 16;
+  }
+
+#endif
+
+  for (; beg < end && '0' <= *beg && *beg <= '9'; ++beg);
+  return beg;
+}
+
+
+const char* scan_word(const char *beg, const char *end)
+{
+#ifdef CDK_TRANSCODE_SSE2
+
+  while (use_sse2() && beg + 16 <= end)
+  {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg));
+    __m128i word = _mm_or_si128(
+      _mm_or_si128(
+        in_range_mask(chunk, 'a', 'z'),
+        in_range_mask(chunk, 'A', 'Z')
+      ),
+      _mm_or_si128(
+        in_range_mask(chunk, '0', '9'),
+        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_'))
+      )
+    );
+    if (0xFFFF != _mm_movemask_epi8(word))
+      break;
+    beg += 16;
+  }
+
+#endif
+
+  for (; beg < end
+         && (('a' <= *beg && *beg <= 'z') || ('A' <= *beg && *beg <= 'Z')
+             || ('0' <= *beg && *beg <= '9') || '_' == *beg);
+       ++beg);
+  return beg;
+}
+
+
+const char* scan_string_body(const char *beg, const char *end, char qchar)
+{
+#ifdef CDK_TRANSCODE_SSE2
+
+  while (use_sse2() && beg + 16 <= end)
+  {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(beg));
+    __m128i stop = _mm_or_si128(
+      _mm_cmpeq_epi8(chunk, _mm_set1_epi8(qchar)),
+      _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))
+    );
+
+    // Note: non-ASCII bytes show up in the movemask of the chunk itself.
+
+    if (_mm_movemask_epi8(chunk) | _mm_movemask_epi8(stop))
+      break;
+    beg += 16;
+  }
+
+#endif
+
+  for (; beg < end
+         && (unsigned char)*beg < 0x80 && qchar != *beg && '\\' != *beg;
+       ++beg);
+  return beg;
+}
+
+}  // anonymous namespace
+
+
+bool char_iterator::skip_ws_run() noexcept
+{
+  if (at_end())
+    return false;
+
+  const char *pos = scan_ws(cur_pos(), get_end());
+
+  if (pos == cur_pos())
+    return false;
+
+  set_pos(pos);
+  m_char = 0;  // position changed, current character no longer decoded
+  return true;
+}
+
+
+bool char_iterator::skip_digit_run() noexcept
+{
+  if (at_end())
+    return false;
+
+  const char *pos = scan_digits(cur_pos(), get_end());
 
-std::locale char_iterator::m_cloc("C");
+  if (pos == cur_pos())
+    return false;
+
+  set_pos(pos);
+  m_char = 0;
+  return true;
+}
+
+
+bool char_iterator::skip_word_run() noexcept
+{
+  if (at_end())
+    return false;
+
+  const char *pos = scan_word(cur_pos(), get_end());
+
+  if (pos == cur_pos())
+    return false;
+
+  set_pos(pos);
+  m_char = 0;
+  return true;
+}
+
+
+bool char_iterator::skip_string_run(char qchar) noexcept
+{
+  if (at_end())
+    return false;
+
+  const char *pos = scan_string_body(cur_pos(), get_end(), qchar);
+
+  if (pos == cur_pos())
+    return false;
+
+  set_pos(pos);
+  m_char = 0;
+  return true;
+}
 
 
 bytes char_iterator::get_seen(size_t len, bool *complete)
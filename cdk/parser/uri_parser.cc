@@ -289,8 +289,17 @@ struct URI_parser::Guard
 
 #define LIST(X,Y)  T_##X,
 
-const URI_parser::TokSet URI_parser::unreserved{ T_CHAR, T_DIGIT, URI_UNRESERVED(LIST) };
-const URI_parser::TokSet URI_parser::gen_delims{ URI_GEN_DELIMS(LIST) };
+const URI_parser::TokSet& URI_parser::unreserved()
+{
+  static const TokSet set{ T_CHAR, T_DIGIT, URI_UNRESERVED(LIST) };
+  return set;
+}
+
+const URI_parser::TokSet& URI_parser::gen_delims()
+{
+  static const TokSet set{ URI_GEN_DELIMS(LIST) };
+  return set;
+}
 
 /*
   user-char ::= unreserved | pct-encoded | "(" | ")" | ","
@@ -299,17 +308,25 @@ const URI_parser::TokSet URI_parser::gen_delims{ URI_GEN_DELIMS(LIST) };
              | "[" | "]" | ":" | "@"
 */
 
-const URI_parser::TokSet URI_parser::user_chars{
-  unreserved, T_POPEN, T_PCLOSE, T_COMMA
-};
+const URI_parser::TokSet& URI_parser::user_chars()
+{
+  static const TokSet set{ unreserved(), T_POPEN, T_PCLOSE, T_COMMA };
+  return set;
+}
 
-const URI_parser::TokSet URI_parser::host_chars{
-  unreserved, T_POPEN, T_PCLOSE, T_AT
-};
+const URI_parser::TokSet& URI_parser::host_chars()
+{
+  static const TokSet set{ unreserved(), T_POPEN, T_PCLOSE, T_AT };
+  return set;
+}
 
-const URI_parser::TokSet URI_parser::db_chars{
-  unreserved, T_POPEN, T_PCLOSE, T_COMMA, T_SQOPEN, T_SQCLOSE, T_COLON, T_AT
-};
+const URI_parser::TokSet& URI_parser::db_chars()
+{
+  static const TokSet set{
+    unreserved(), T_POPEN, T_PCLOSE, T_COMMA, T_SQOPEN, T_SQCLOSE, T_COLON, T_AT
+  };
+  return set;
+}
 
 
 // ---------------------------------------------------------------
@@ -347,7 +364,7 @@ void URI_parser::parse_path(Processor &prc)
 
   std::string db;
 
-  consume_while(db, db_chars);
+  consume_while(db, db_chars());
 
   prc.schema(db);
 }
@@ -441,7 +458,7 @@ URI_parser::Addr_opts URI_parser::parse_host(std::string &address,
     return opts;
   }
 
-  consume_while(address, host_chars);
+  consume_while(address, host_chars());
   return opts;
 }
 
@@ -622,7 +639,7 @@ bool URI_parser::parse_ip_address(std::string &host, std::string &port)
 
     if (count < 4)
     {
-      consume_while(addr, host_chars);
+      consume_while(addr, host_chars());
       if (!next_token_is(T_COLON))
         return false;
     }
@@ -654,7 +671,7 @@ bool URI_parser::parse_ip_address(std::string &host, std::string &port)
 
 void URI_parser::parse_balanced(std::string &chars, bool include_parens)
 {
-  static TokSet np_char{ unreserved, gen_delims, T_COMMA };
+  static TokSet np_char{ unreserved(), gen_delims(), T_COMMA };
 
   if (!consume_token(T_POPEN))
     parse_error("Expected opening '('");
@@ -693,7 +710,7 @@ bool URI_parser::parse_userinfo(Processor &prc)
   std::string password;
   bool has_pwd = false;
 
-  consume_while(user, user_chars);
+  consume_while(user, user_chars());
 
   if (user.empty())
     return false;
@@ -701,7 +718,7 @@ bool URI_parser::parse_userinfo(Processor &prc)
   if (consume_token(T_COLON))
   {
     has_pwd = true;
-    consume_while(password, { user_chars, T_COLON });
+    consume_while(password, { user_chars(), T_COLON });
   }
 
   if (!consume_token(T_AT))
@@ -270,13 +270,16 @@ private:
 
   struct TokSet;
 
-  // Character classes used in the grammar.
+  /*
+    Character classes used in the grammar. Each accessor builds its set
+    on first use, so that loading the library runs no set constructors.
+  */
 
-  static const TokSet unreserved;
-  static const TokSet gen_delims;
-  static const TokSet host_chars;
-  static const TokSet user_chars;
-  static const TokSet db_chars;
+  static const TokSet& unreserved();
+  static const TokSet& gen_delims();
+  static const TokSet& host_chars();
+  static const TokSet& user_chars();
+  static const TokSet& db_chars();
 
   void parse(Processor &prc);
 
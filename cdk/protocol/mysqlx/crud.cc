@@ -833,7 +833,8 @@ Protocol::snd_Delete(Data_model dm,
 Protocol::Op&
 Protocol::snd_PrepareExecute(uint32_t stmt_id,
                              const api::Limit *lim,
-                             const api::Args_map *args)
+                             const api::Args_map *args,
+                             bool compact_metadata)
 {
   auto& prepare_execute = get_impl().m_prepare_execute;
   auto& conv = get_impl().m_args_conv;
@@ -858,6 +859,13 @@ Protocol::snd_PrepareExecute(uint32_t stmt_id,
 
   prepare_execute.set_stmt_id(stmt_id);
 
+  // Note: the message object is re-used, so the flag is always (re)set.
+
+  if (compact_metadata)
+    prepare_execute.set_compact_metadata(true);
+  else
+    prepare_execute.clear_compact_metadata();
+
   return get_impl().snd_start(prepare_execute, msg_type::cli_PrepareExecute);
 }
 
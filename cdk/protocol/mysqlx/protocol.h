@@ -34,11 +34,14 @@
 
 #include <mysql/cdk/protocol/mysqlx.h>
 #include <mysql/cdk/foundation/opaque_impl.i>
+#include <mysql/cdk/foundation/probes.h>
 #include <mysql/cdk/config.h>
 #include "protocol_compression.h"
 
 PUSH_PB_WARNINGS
 
+#include <google/protobuf/arena.h>
+
 #if defined DELETE
 //Remove DELETE macro from windows..
 #undef DELETE
@@ -58,6 +61,12 @@ POP_PB_WARNINGS
 
 #include "builders.h"
 
+PUSH_SYS_WARNINGS_CDK
+#include <map>
+#include <memory>
+#include <string>
+POP_SYS_WARNINGS_CDK
+
 namespace google {
 namespace protobuf {
 
@@ -117,6 +126,19 @@ const size_t max_rd_size= max_wr_size;
 
 enum Protocol_side { SERVER, CLIENT};
 
+
+/*
+  Instrumentation counters (@see Protocol_stats) are updated through this
+  macro so that building with CDK_DISABLE_PROTOCOL_STATS removes the
+  updates from the send/receive paths altogether.
+*/
+
+#ifndef CDK_DISABLE_PROTOCOL_STATS
+#define PROTOCOL_STATS(X) X
+#else
+#define PROTOCOL_STATS(X)
+#endif
+
 inline
 Protocol_side other_side(Protocol_side side)
 {
@@ -154,11 +176,157 @@ public:
   size_t m_compress_threshold = 0;
 
   void set_compression(Compression_type::value, size_t);
+  void set_compression_dictionary(bytes);
+  void set_compression_level(int);
+  void set_compression_long_matching(bool);
+  void set_compression_window_log(int);
+
+  // Traffic counters, updated via PROTOCOL_STATS() macro.
+
+  Protocol_stats m_stats;
+
+  /*
+    Adaptive compression
+    --------------------
+
+    Achieved compression ratio is sampled over windows of
+    COMPRESS_SAMPLE_SIZE uncompressed bytes. If a window saved less than
+    ~5% (e.g. the payload carries already-compressed blobs), subsequent
+    messages are sent uncompressed - which the protocol permits at any
+    time - and one message out of every COMPRESS_PROBE_INTERVAL is
+    compressed to detect when the data becomes compressible again.
+  */
+
+  static const size_t COMPRESS_SAMPLE_SIZE = 64*1024;
+  static const size_t COMPRESS_PROBE_INTERVAL = 256;
+
+  size_t m_compress_sample_in = 0;   // Uncompressed bytes in current window
+  size_t m_compress_sample_out = 0;  // Compressed bytes produced for them
+  bool   m_compress_passthrough = false;
+  size_t m_compress_skipped = 0;     // Messages skipped in passthrough mode
+
+  bool compress_passthrough()
+  {
+    if (!m_compress_passthrough)
+      return false;
+
+    if (++m_compress_skipped >= COMPRESS_PROBE_INTERVAL)
+    {
+      m_compress_skipped = 0;
+      return false;  // probe: compress this message
+    }
+
+    return true;
+  }
+
+  void update_compress_stats(size_t in_size, size_t out_size)
+  {
+    m_compress_sample_in += in_size;
+    m_compress_sample_out += out_size;
+
+    if (m_compress_sample_in < COMPRESS_SAMPLE_SIZE)
+      return;
+
+    m_compress_passthrough =
+      m_compress_sample_out + m_compress_sample_in/20 > m_compress_sample_in;
+
+    m_compress_sample_in = m_compress_sample_out = 0;
+  }
 
   Placeholder_conv_imp m_args_conv;
 
   Mysqlx::Prepare::Execute m_prepare_execute;
 
+  /*
+    Arena from which incoming protobuf messages are allocated. One message
+    object is created per received frame (one per row on the fetch path),
+    so allocating them from an arena which is reset after each message
+    avoids heap allocation churn. The initial block keeps typical messages
+    entirely inside the protocol object.
+  */
+
+  byte m_arena_block[4096];
+  google::protobuf::Arena m_msg_arena;
+
+  void reset_msg_arena()
+  {
+    m_msg_arena.Reset();
+  }
+
+  /*
+    Validated-transport mode (see Protocol::set_validated_transport()).
+
+    Small fixed-shape server messages - FetchDone and friends,
+    StmtExecuteOk, state-change notices - tend to repeat byte-identically
+    frame after frame. In this mode the last validated payload of each
+    such message type is remembered together with its parsed form, and a
+    later frame with an identical payload reuses the stored parse instead
+    of re-running the protobuf parse (see Op_rcv::process_payload()).
+  */
+
+  bool m_validated_transport = false;
+
+  void set_validated_transport(bool enable)
+  {
+    m_validated_transport = enable;
+    if (!enable)
+      m_parsed_cache.clear();
+  }
+
+  // Largest payload worth remembering in the parse cache.
+
+  static const size_t VALIDATED_MSG_MAX = 128;
+
+  struct Parsed_msg
+  {
+    std::string payload;
+    std::unique_ptr<Message> msg;
+  };
+
+  std::map<msg_type_t, Parsed_msg> m_parsed_cache;
+
+  /*
+    Return the stored parse of the given frame if its payload is
+    byte-identical to the last validated instance of this message type,
+    null otherwise (also when the mode is off).
+  */
+
+  Message* find_validated_msg(msg_type_t, bytes);
+
+  // Remember the payload of a just validated fixed-shape message.
+
+  void store_validated_msg(msg_type_t, bytes);
+
+  /*
+    Warning-notice filter (see Protocol::set_skip_warnings()).
+
+    When enabled, warning notices in server replies are dropped as soon
+    as the notice type was peeked from the raw frame payload - no
+    protobuf object is constructed and the processor is not called (see
+    Op_rcv::process_payload()). State-change notices are never dropped;
+    statement statistics and generated ids travel in them.
+  */
+
+  bool m_skip_warnings = false;
+
+  void set_skip_warnings(bool enable)
+  {
+    m_skip_warnings = enable;
+  }
+
+  /*
+    Tell whether the given raw payload of a Mysqlx.Notice.Frame message
+    carries a warning notice. Frame.type is the frame's first field
+    (tag 1, varint) and the Warning type value 1 is a single byte.
+  */
+
+  static bool is_warning_notice(bytes payload)
+  {
+    return payload.size() >= 2
+        && 0x08 == payload.begin()[0]
+        && 0x01 == payload.begin()[1];
+  }
+
 protected:
 
   Protocol_impl(Protocol::Stream*, Protocol_side);
@@ -166,7 +334,14 @@ protected:
 
 public:
 
-  void          start_Pipeline();
+  /*
+    Start collecting messages in the write buffer instead of sending
+    each one. A non-zero expected_size reserves the buffer for the
+    estimated summed wire size of the messages about to be queued, so
+    that appending them does not grow it along the way.
+  */
+
+  void          start_Pipeline(size_t expected_size = 0);
   Protocol::Op& snd_Pipeline();
   void clear_Pipeline();
 
@@ -234,8 +409,61 @@ protected:
   byte   *m_rd_buf;              // Reading buffer or data after uncompression
   size_t  m_rd_size;             // Size of allocated m_rd_buf
 
+  /*
+    Shared ownership of the read buffer, engaged by rd_slab(). Once a
+    consumer holds a reference, the block belongs to the slab and its
+    holders instead of the buffer pool; before new data is read into
+    m_rd_buf, rd_detach() checks whether the slab is still referenced
+    elsewhere and, if so, leaves the block to its remaining holders and
+    acquires a fresh read buffer.
+  */
+
+  foundation::shared_bytes m_rd_slab;
+
+  void rd_detach();
+
+public:
+
+  /*
+    Hand out shared ownership of the current read buffer, so that data
+    received into it can be kept as views instead of being copied out.
+    The views stay valid for as long as the returned slab (or a copy of
+    it) is held.
+  */
+
+  const foundation::shared_bytes& rd_slab();
+
+protected:
+
   scoped_ptr<Protocol::Stream::Op> m_rd_op;
 
+  /*
+    Prefetching the next frame header
+    ---------------------------------
+
+    While messages decoded from a compression frame are being dispatched
+    the input stream is idle. After a frame is decoded, reading of the
+    next frame header is started into m_hdr_prefetch and progressed
+    opportunistically from rd_cont(). When the header is eventually
+    needed, read_header() serves it from the prefetch buffer (or adopts
+    the still pending prefetch operation) instead of only then touching
+    the stream.
+  */
+
+  byte m_hdr_prefetch[header_length];
+  scoped_ptr<Protocol::Stream::Op> m_prefetch_op;
+  bool m_hdr_prefetched = false; // m_hdr_prefetch holds a complete header
+  bool m_hdr_adopt = false;      // m_rd_op reads into m_hdr_prefetch
+
+  /*
+    Pool from which the read, write and compression output buffers are
+    allocated. Buffers shrunk or replaced while resizing are recycled
+    through the pool instead of being freed, so steady-state message
+    traffic does not hit the allocator.
+  */
+
+  Buffer_pool m_buf_pool;
+
   Protocol_compression m_compressor;
 
 
@@ -481,6 +709,7 @@ public:
   Op_snd_pipeline(Protocol_impl &proto)
     : Op_base(proto)
   {
+    CDK_PROBE1(snd_flush, proto.m_pipeline_size);
     m_proto.write();
   }
 
@@ -643,6 +872,16 @@ protected:
   virtual void process_msg(msg_type_t, Message&);
   virtual void do_process_msg(msg_type_t, Message&) {} // GCOV_EXCL_LINE
 
+  /*
+    Hook which lets derived operations process the raw message payload
+    without constructing a protobuf message. Should return true if the
+    message was fully handled this way; returning false falls back to
+    the regular parse + process_msg() path. Used on the result fetch
+    path to decode Row messages straight from the receive buffer.
+  */
+
+  virtual bool process_raw(msg_type_t, bytes) { return false; }
+
   /**
     This method is called after processing each message to determine
     if operation should continue processing next message or stop.
@@ -1003,7 +1242,12 @@ public:
   {
     if (m_stmt_id != 0)
     {
-      m_protocol.start_Pipeline();
+      // Both message sizes are known - reserve the pipeline buffer once.
+
+      m_protocol.start_Pipeline(
+        2 * header_length
+        + m_prepare.ByteSizeLong() + m_prepare_execute.ByteSizeLong()
+      );
       m_protocol.snd_start(m_prepare, msg_type::cli_PreparePrepare).wait();
       m_protocol.snd_start(m_prepare_execute, msg_type::cli_PrepareExecute)
           .wait();
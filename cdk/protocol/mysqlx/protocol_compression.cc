@@ -41,6 +41,10 @@
 
 PUSH_SYS_WARNINGS_CDK
 #include <memory.h> // for memcpy
+#ifdef __linux__
+#include <stdlib.h>   // for posix_memalign
+#include <sys/mman.h> // for madvise
+#endif
 POP_SYS_WARNINGS_CDK
 
 
@@ -69,8 +73,9 @@ void Compression_zlib::init()
   m_c_zstream.opaque = Z_NULL;
   m_c_zstream.total_out = 0;
 
-  // TODO: Make the compression level adjustable
-  if (deflateInit(&m_c_zstream, 9) != Z_OK)
+  int level = m_protocol_compression.compression_level();
+
+  if (deflateInit(&m_c_zstream, level < 0 ? 9 : level) != Z_OK)
     throw_error("Could not initialize compression output stream");
 
   // Initial functions mapping, keep the internal implementation
@@ -167,6 +172,9 @@ void Compression_lz4::init()
 
   m_lz4f_pref.autoFlush = 1;
   m_lz4f_pref.frameInfo.contentSize = 0;
+
+  int level = m_protocol_compression.compression_level();
+  m_lz4f_pref.compressionLevel = level < 0 ? 0 : level;
 }
 
 
@@ -277,7 +285,13 @@ void Compression_zstd::init()
   if (m_c_zstd == nullptr)
   {
     m_c_zstd = ZSTD_createCStream();
-    if (ZSTD_isError(ZSTD_initCStream(m_c_zstd, -1)))
+
+    // Note: negative levels select the zstd "fast" modes; the historical
+    // default for this connector is level -1.
+
+    if (ZSTD_isError(
+          ZSTD_initCStream(m_c_zstd,
+                           m_protocol_compression.compression_level())))
       throw_error("Error creating ZSTD compression stream");
   }
 
@@ -287,6 +301,61 @@ void Compression_zstd::init()
     if (ZSTD_isError(ZSTD_initDStream(m_u_zstd)))
       throw_error("Error creating ZSTD decompression stream");
   }
+
+  /*
+    If a pre-trained dictionary was set, load it into both streams.
+    Note: dictionary must be loaded after stream initialization, which
+    resets stream parameters.
+  */
+
+#if ZSTD_VERSION_NUMBER >= 10400
+  const std::vector<byte> &dict = m_protocol_compression.zstd_dictionary();
+
+  if (!dict.empty())
+  {
+    if (ZSTD_isError(
+          ZSTD_CCtx_loadDictionary(m_c_zstd, dict.data(), dict.size())))
+      throw_error("Error loading ZSTD compression dictionary");
+
+    if (ZSTD_isError(
+          ZSTD_DCtx_loadDictionary(m_u_zstd, dict.data(), dict.size())))
+      throw_error("Error loading ZSTD decompression dictionary");
+  }
+
+  /*
+    Advanced stream parameters, like the dictionary, must be applied
+    after stream initialization. The decompression window limit is
+    raised accordingly so that large-window frames produced by a server
+    configured with the same parameters can be decoded.
+  */
+
+  int wlog = m_protocol_compression.zstd_window_log();
+
+  if (m_protocol_compression.zstd_long_matching())
+  {
+    if (ZSTD_isError(
+          ZSTD_CCtx_setParameter(m_c_zstd,
+                                 ZSTD_c_enableLongDistanceMatching, 1)))
+      throw_error("Error enabling ZSTD long distance matching");
+  }
+
+  if (wlog > 0)
+  {
+    if (ZSTD_isError(
+          ZSTD_CCtx_setParameter(m_c_zstd, ZSTD_c_windowLog, wlog)))
+      throw_error("Error setting ZSTD window log");
+  }
+
+  if (m_protocol_compression.zstd_long_matching() || wlog > 0)
+  {
+    // 30 is the largest window log valid on all platforms.
+
+    if (ZSTD_isError(
+          ZSTD_DCtx_setParameter(m_u_zstd, ZSTD_d_windowLogMax,
+                                 wlog > 0 ? wlog : 30)))
+      throw_error("Error setting ZSTD decompression window limit");
+  }
+#endif
 }
 
 
@@ -355,11 +424,115 @@ Protocol_compression::Protocol_compression()
 { }
 
 
+Buffer_pool::~Buffer_pool()
+{
+  for (auto &entry : m_free)
+    free(entry.first);
+}
+
+
+byte* Buffer_pool::acquire(size_t &size)
+{
+  // Round the requested size up to its size class (powers of two).
+
+  size_t block_size = MIN_BLOCK_SIZE;
+  while (block_size < size)
+    block_size *= 2;
+
+  // Reuse the smallest cached buffer that fits, if any.
+
+  auto best = m_free.end();
+  for (auto it = m_free.begin(); it != m_free.end(); ++it)
+  {
+    if (it->second >= block_size
+        && (best == m_free.end() || it->second < best->second))
+      best = it;
+  }
+
+  if (best != m_free.end())
+  {
+    byte *buf = best->first;
+    size = best->second;
+    m_cached -= best->second;
+    m_free.erase(best);
+    return buf;
+  }
+
+  /*
+    Large buffers are allocated aligned to the huge page size and marked
+    as huge-page candidates, so that the kernel can back them with
+    transparent huge pages. This reduces TLB pressure when the receive
+    path streams large results through the buffer. Size classes at or
+    above HUGE_BLOCK_SIZE are multiples of it, so the whole block is
+    eligible. Memory from posix_memalign() can be passed to free(), so
+    release() and the destructor handle these buffers like any other;
+    on alignment failure the plain allocation below is used instead.
+  */
+
+#ifdef __linux__
+  if (block_size >= HUGE_BLOCK_SIZE)
+  {
+    void *mem = nullptr;
+    if (0 == posix_memalign(&mem, HUGE_BLOCK_SIZE, block_size))
+    {
+#ifdef MADV_HUGEPAGE
+      madvise(mem, block_size, MADV_HUGEPAGE);
+#endif
+      size = block_size;
+      return (byte*)mem;
+    }
+  }
+#endif
+
+  byte *buf = (byte*)malloc(block_size);
+  if (!buf)
+    throw_error("Could not allocate I/O buffer");
+
+  size = block_size;
+  return buf;
+}
+
+
+void Buffer_pool::release(byte *buf, size_t size)
+{
+  if (!buf)
+    return;
+
+  // High-water trim: above the limit buffers go back to the allocator.
+
+  if (m_cached + size > HIGH_WATER)
+  {
+    free(buf);
+    return;
+  }
+
+  PUSH_SYS_WARNINGS_CDK
+  m_free.emplace_back(buf, size);
+  POP_SYS_WARNINGS_CDK
+  m_cached += size;
+}
+
+
 byte* Protocol_compression::get_out_buf(size_t size)
 {
   if (m_c_out_size && size <= m_c_out_size)
     return m_c_out_buf;
 
+  if (m_buf_pool)
+  {
+    /*
+      Note: contents of the output buffer do not need to be preserved -
+      it is always resized before a compression run writes into it.
+    */
+
+    size_t new_size = size;
+    byte *tmp = m_buf_pool->acquire(new_size);
+    m_buf_pool->release(m_c_out_buf, m_c_out_size);
+    m_c_out_buf = tmp;
+    m_c_out_size = new_size;
+    return m_c_out_buf;
+  }
+
   byte *tmp = (byte*)realloc(m_c_out_buf, size);
   if (!tmp)
     throw_error("Could not reallocate compression output buffer");
@@ -375,9 +548,54 @@ size_t Protocol_compression::do_compress(byte *src, size_t len)
   if (!m_algorithm)
     throw_error("Unknown compression type");
 
-  return m_algorithm->compress(src, len);
+  size_t out_len = m_algorithm->compress(src, len);
+  CDK_PROBE2(compress_out, len, out_len);
+  return out_len;
 }
 
+/*
+  Eagerly decompress the frame set with set_compressed_buf() into the
+  internal frame buffer. Running the codec once over the whole frame is
+  cheaper than interleaving small per-message decompression calls with
+  message parsing, and it releases the compressed input early so the
+  protocol can start reading the next frame from the stream while
+  messages decoded from this one are still being dispatched.
+*/
+
+void Protocol_compression::decode_frame()
+{
+  size_t total = m_u_total_size;
+
+  if (0 == total)
+    return;
+
+  CDK_PROBE2(compress_in, m_c_inp_size, total);
+
+  PUSH_SYS_WARNINGS_CDK
+  m_u_frame.resize(total);
+  POP_SYS_WARNINGS_CDK
+
+  size_t size = total;
+
+  do
+  {
+    size_t res = do_uncompress(m_u_frame.data() + total - size, size);
+
+    if (COMPRESSION_ERROR == res)
+      throw_error("Error uncompressing frame data");
+
+    if (0 == res)
+      throw_error("Truncated compressed frame");
+
+    size -= res;
+  }
+  while (size);
+
+  m_u_pos = 0;
+  m_u_eager = true;
+}
+
+
 bool
   Protocol_compression::uncompress(byte *buf, size_t size)
 {
@@ -385,6 +603,18 @@ bool
   if (0 == size)
     return true;
 
+  // Serve data from the eagerly decoded frame, if present.
+
+  if (m_u_eager)
+  {
+    if (m_u_pos + size > m_u_frame.size())
+      return false;
+
+    memcpy(buf, m_u_frame.data() + m_u_pos, size);
+    m_u_pos += size;
+    return true;
+  }
+
   size_t orig_size = size;
 
   do
@@ -38,6 +38,11 @@
 #include <lz4frame.h>
 #include <zstd.h>
 
+PUSH_SYS_WARNINGS_CDK
+#include <vector>
+#include <utility>
+POP_SYS_WARNINGS_CDK
+
 
 namespace cdk {
 namespace protocol {
@@ -49,6 +54,59 @@ typedef cdk::protocol::mysqlx::api::Compression_type Compression_type;
 
 class Protocol_compression;
 
+
+/*
+  Pool of I/O buffers with size-class recycling.
+
+  Buffers handed out by acquire() have power-of-two capacities. Buffers
+  returned with release() are cached and reused by later acquire() calls
+  instead of going back to the allocator. The total capacity of cached
+  buffers is bounded by a high-water mark - above it released buffers are
+  freed. One pool instance serves the read, write and compression buffers
+  of a single protocol object, so no locking is needed.
+*/
+
+class Buffer_pool
+{
+public:
+
+  ~Buffer_pool();
+
+  /*
+    Return a buffer of at least the given size. On return the size
+    parameter is updated to the actual capacity of the buffer. Throws
+    error if memory can not be allocated.
+  */
+
+  byte *acquire(size_t &size);
+
+  /*
+    Give a buffer back to the pool. The size parameter must be the
+    capacity reported by acquire(). Buffers allocated with plain
+    malloc()/realloc() can be released here as well.
+  */
+
+  void release(byte *buf, size_t size);
+
+private:
+
+  static const size_t MIN_BLOCK_SIZE = 1024;
+  static const size_t HIGH_WATER = 4*1024*1024;
+
+  /*
+    Blocks of this size and above are allocated aligned to it and marked
+    as huge-page candidates, so that the kernel can back them with
+    transparent huge pages (see acquire()). Must match the huge page
+    size of the platform.
+  */
+
+  static const size_t HUGE_BLOCK_SIZE = 2*1024*1024;
+
+  std::vector<std::pair<byte*, size_t>> m_free;
+  size_t m_cached = 0;
+};
+
+
 class Compression_algorithm
 {
   protected:
@@ -150,11 +208,125 @@ class Protocol_compression
 
     size_t   m_u_total_size = 0;
 
+    /*
+      Eagerly decoded frame data. When a compression frame is set with
+      set_compressed_buf() it is decompressed in full into this buffer
+      and uncompress() calls are then served from it. The buffer keeps
+      its capacity across frames.
+    */
+
+    std::vector<byte> m_u_frame;
+    size_t   m_u_pos = 0;       // Read position inside m_u_frame
+    bool     m_u_eager = false; // True if current frame was eagerly decoded
+
     byte    *m_c_out_buf = nullptr; // Compression OUT buffer
     size_t   m_c_out_size = 0;      // Compression OUT buffer size
 
+    Buffer_pool *m_buf_pool = nullptr; // Optional pool for the OUT buffer
+
+    /*
+      Optional pre-trained zstd dictionary loaded into the compression
+      and decompression streams. Small, repetitive messages (typical
+      document payloads) compress much better when both ends start from
+      a shared dictionary instead of an empty window.
+    */
+
+    std::vector<byte> m_zstd_dict;
+
+    /*
+      Compression effort level passed to the algorithm on creation.
+      Negative value means the algorithm-specific default (9 for zlib,
+      0 for lz4, -1 for zstd). The level ranges are algorithm specific.
+    */
+
+    int m_compression_level = -1;
+
+    /*
+      Zstd long distance matching and match window size (as a power of
+      two). LDM finds repetitions over the whole window instead of the
+      near past, which pays off on large, self-similar transfers such
+      as table snapshots. Zero window log keeps the window implied by
+      the compression level.
+    */
+
+    bool m_zstd_ldm = false;
+    int  m_zstd_window_log = 0;
+
   public:
 
+  /*
+    Set compression effort level. Must be called before the compression
+    type is set.
+  */
+
+  void set_compression_level(int level)
+  {
+    m_compression_level = level;
+  }
+
+  int compression_level() const
+  {
+    return m_compression_level;
+  }
+
+  /*
+    Set a pre-trained zstd dictionary to be used by ZSTD compression
+    streams. Must be called before the compression type is set; has no
+    effect on other algorithms. Both ends of the connection must use the
+    same dictionary.
+  */
+
+  void set_zstd_dictionary(const byte *dict, size_t len)
+  {
+    m_zstd_dict.assign(dict, dict + len);
+  }
+
+  const std::vector<byte>& zstd_dictionary() const
+  {
+    return m_zstd_dict;
+  }
+
+  /*
+    Enable zstd long distance matching. Must be called before the
+    compression type is set; has no effect on other algorithms.
+  */
+
+  void set_zstd_long_matching(bool enable)
+  {
+    m_zstd_ldm = enable;
+  }
+
+  bool zstd_long_matching() const
+  {
+    return m_zstd_ldm;
+  }
+
+  /*
+    Set the zstd match window size as a power of two. Must be called
+    before the compression type is set; has no effect on other
+    algorithms.
+  */
+
+  void set_zstd_window_log(int wlog)
+  {
+    m_zstd_window_log = wlog;
+  }
+
+  int zstd_window_log() const
+  {
+    return m_zstd_window_log;
+  }
+
+  /*
+    Use the given buffer pool when (re-)allocating the compression output
+    buffer. The pool must outlive this object.
+  */
+
+  void set_buf_pool(Buffer_pool *pool)
+  {
+    m_buf_pool = pool;
+  }
+
   Compression_type::value m_compression_type = Compression_type::NONE;
 
   Protocol_compression();
@@ -190,6 +362,7 @@ class Protocol_compression
     m_c_inp_buf = data;
     m_u_total_size = uncompressed_size;
     m_c_inp_size = compressed_size;
+    decode_frame();
   }
 
   /*
@@ -212,6 +385,8 @@ class Protocol_compression
     m_c_inp_offset = 0;
     m_u_total_size = 0;
     m_c_inp_size = 0;
+    m_u_pos = 0;
+    m_u_eager = false;
   }
 
   /*
@@ -220,6 +395,9 @@ class Protocol_compression
   */
   inline bool uncompression_finished()
   {
+    if (m_u_eager)
+      return m_u_pos >= m_u_frame.size();
+
     return (0 == m_u_total_size) &&
            (0 == m_c_inp_size);
   }
@@ -251,6 +429,12 @@ class Protocol_compression
   */
   size_t do_uncompress(byte *dst, size_t dest_size);
 
+  /*
+    Decompress the whole frame set with set_compressed_buf() into
+    m_u_frame, after which uncompress() serves data from that buffer.
+  */
+  void decode_frame();
+
 };
 
 
@@ -153,6 +153,27 @@ protected:
     throw_error("Invalid processor used to process server reply");
   }
 
+public:
+
+  /*
+    Raw decoding of Row messages (see Op_rcv::process_raw()). Column
+    boundaries found in the payload are stored here; the vector keeps
+    its capacity across rows.
+  */
+
+  struct Row_field
+  {
+    size_t pos;
+    size_t len;
+  };
+
+protected:
+
+  std::vector<Row_field, foundation::Tracking_allocator<Row_field>>
+    m_row_fields;
+
+  bool process_raw(msg_type_t, bytes) override;
+
 };
 
 
@@ -238,12 +259,31 @@ void Rcv_result_base::resume(Row_processor &prc)
 Op_rcv::Next_msg Rcv_result_base::next_msg(msg_type_t type)
 {
   m_next_state = m_result_state;
+
+  /*
+    Fast path for row streaming: once the first Row message has moved the
+    state machine to the ROWS state, every further Row message is expected,
+    changes no state and completes no stage (see the ROWS case in
+    do_next_msg()). Dispatching it directly here skips the generic
+    expected-message logic which otherwise re-walks the state tables for
+    each row of the result-set.
+  */
+
+  if (msg_type::Row == type && ROWS == m_result_state)
+    return EXPECTED;
+
   return Op_rcv::next_msg(type);
 }
 
 bool Rcv_result_base::process_next()
 {
   m_result_state = m_next_state;
+
+  // Same fast path as in next_msg(): keep reading rows until <more> is seen.
+
+  if (msg_type::Row == m_msg_type && ROWS == m_result_state)
+    return true;
+
   return Op_rcv::process_next();
 }
 
@@ -606,6 +646,223 @@ void Rcv_result_base::process_msg_with(
 }
 
 
+/*
+  Decode a protobuf varint at buf, examining up to eight bytes at a time.
+
+  A 64-bit word is loaded and the terminating byte (the first one with
+  its continuation bit clear) is located from the 0x80 bit lanes in one
+  step; the 7-bit groups are then compacted with shift-and-mask rounds
+  instead of a per-byte loop. Bytes near the end of the buffer, and
+  platforms where the word trick is not available, use the plain loop.
+
+  Returns the number of bytes consumed, or 0 if the varint is malformed,
+  truncated, or encodes a value that cannot be a sane payload length.
+*/
+
+static inline size_t decode_varint(const byte *buf, size_t size, size_t &value)
+{
+#if !CDK_BIG_ENDIAN && (defined(__GNUC__) || defined(__clang__))
+
+  if (size >= 8)
+  {
+    uint64_t word;
+    memcpy(&word, buf, 8);
+
+    uint64_t stops = ~word & UINT64_C(0x8080808080808080);
+
+    if (!stops)
+      return 0; // more than 8 varint bytes can not be a valid length
+
+    size_t len = (size_t)(__builtin_ctzll(stops) / 8) + 1;
+
+    uint64_t v = word;
+    if (len < 8)
+      v &= (UINT64_C(1) << (8*len)) - 1;
+
+    // Strip continuation bits and compact the 7-bit groups.
+
+    v &= UINT64_C(0x7F7F7F7F7F7F7F7F);
+    v = ((v & UINT64_C(0x7F007F007F007F00)) >> 1)
+        | (v & UINT64_C(0x007F007F007F007F));
+    v = ((v & UINT64_C(0x3FFF00003FFF0000)) >> 2)
+        | (v & UINT64_C(0x00003FFF00003FFF));
+    v = ((v & UINT64_C(0x0FFFFFFF00000000)) >> 4)
+        | (v & UINT64_C(0x000000000FFFFFFF));
+
+    if (v > UINT64_C(0xFFFFFFFF))
+      return 0;
+
+    value = (size_t)v;
+    return len;
+  }
+
+#endif
+
+  size_t v = 0;
+  unsigned shift = 0;
+  size_t pos = 0;
+
+  while (pos < size)
+  {
+    byte b = buf[pos++];
+    v |= (size_t)(b & 0x7F) << shift;
+
+    if (!(b & 0x80))
+    {
+      value = v;
+      return pos;
+    }
+
+    shift += 7;
+    if (shift > 28)
+      return 0;
+  }
+
+  return 0; // truncated
+}
+
+
+/*
+  Scan raw Row message payload locating column value boundaries.
+
+  On the wire a Row message is a sequence of `bytes` fields with tag 1
+  (0x0A), each followed by a varint length and the value data. The scan
+  stores an (offset, length) entry per column in the fields table.
+  Returns false if the payload deviates from this shape, in which case
+  the caller should fall back to the generic protobuf parse.
+*/
+
+static bool scan_row_fields(bytes data,
+                            std::vector<Rcv_result_base::Row_field> &fields)
+{
+  fields.clear();
+
+  const byte *buf = data.begin();
+  size_t size = data.size();
+  size_t pos = 0;
+
+  while (pos < size)
+  {
+    if (0x0A != buf[pos++])
+      return false;
+
+    // Decode the value length varint.
+
+    size_t len;
+    size_t used = decode_varint(buf + pos, size - pos, len);
+
+    if (0 == used)
+      return false;
+
+    pos += used;
+
+    if (len > size - pos)
+      return false;
+
+    PUSH_SYS_WARNINGS_CDK
+    fields.push_back({ pos, len });
+    POP_SYS_WARNINGS_CDK
+    pos += len;
+  }
+
+  return true;
+}
+
+
+/*
+  Decode a Row message directly from the receive buffer, skipping the
+  protobuf parse. The column values are reported to the row processor
+  as slices of the raw payload, so no protobuf objects are built and no
+  field data is copied on the way.
+*/
+
+bool Rcv_result_base::process_raw(msg_type_t type, bytes payload)
+{
+  /*
+    Discarded replies: a ColumnMetaData frame is dropped without the
+    protobuf parse if the processor does not want its content. The
+    column is still counted, which is all the reply state machine
+    needs (see Mdata_processor::col_raw()).
+  */
+
+  if (msg_type::ColumnMetaData == type
+      && (START == m_result_state || MDATA == m_result_state))
+  {
+    if (static_cast<Mdata_processor*>(m_prc)->col_raw(m_ccount, payload))
+    {
+      m_ccount++;
+      return true;
+    }
+    return false;
+  }
+
+  if (msg_type::Row != type || ROWS != m_result_state)
+    return false;
+
+  Row_processor &rp = *static_cast<Row_processor*>(m_prc);
+
+  /*
+    Wire passthrough: a processor operating in raw mode takes the frame
+    payload as-is and no decoding happens at all (see
+    Row_processor::row_raw()).
+  */
+
+  if (rp.row_raw(m_rcount, payload))
+  {
+    m_rcount++;
+    return true;
+  }
+
+  if (!scan_row_fields(payload, m_row_fields))
+    return false;
+
+  row_count_t rcount = m_rcount++;
+
+  if (!rp.row_begin(rcount))
+    return true; // skip this row if the processor doesn't want it
+
+  /*
+    Offer the processor shared ownership of the receive buffer backing
+    this payload, so that it can keep the column values as views into it
+    instead of copying them out (see Row_processor::row_slab()).
+  */
+
+  rp.row_slab(m_proto.rd_slab());
+
+  col_count_t ccount = 0;
+
+  for (const Row_field &field : m_row_fields)
+  {
+    if (0 == field.len)
+    {
+      rp.col_null(ccount++);
+      continue;
+    }
+
+    const byte *data = payload.begin() + field.pos;
+
+    size_t read_window = rp.col_begin(ccount, field.len);
+    size_t pos = 0;
+
+    while (field.len > pos && read_window)
+    {
+      size_t bytes_to_feed =
+        field.len - pos > read_window ? read_window : field.len - pos;
+      size_t read_window_new =
+        rp.col_data(ccount, bytes((byte*)(data + pos), bytes_to_feed));
+      pos += read_window;
+      read_window = read_window_new;
+    }
+
+    rp.col_end(ccount, field.len);
+    ++ccount;
+  }
+
+  rp.row_end(rcount);
+  return true;
+}
+
+
 /*
   Process column metadata
 */
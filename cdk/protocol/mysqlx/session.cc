@@ -86,9 +86,9 @@ struct Cap_builder : api::Any::Document::Processor
   }
 };
 
-void Protocol::start_Pipeline()
+void Protocol::start_Pipeline(size_t expected_size)
 {
-  get_impl().start_Pipeline();
+  get_impl().start_Pipeline(expected_size);
 }
 
 Protocol::Op& Protocol::snd_Pipeline()
@@ -107,6 +107,41 @@ void Protocol::set_compression(Compression_type::value compression_type,
   get_impl().set_compression(compression_type, threshold);
 }
 
+void Protocol::set_compression_dictionary(bytes dict)
+{
+  get_impl().set_compression_dictionary(dict);
+}
+
+void Protocol::set_compression_level(int level)
+{
+  get_impl().set_compression_level(level);
+}
+
+void Protocol::set_compression_long_matching(bool enable)
+{
+  get_impl().set_compression_long_matching(enable);
+}
+
+void Protocol::set_compression_window_log(int wlog)
+{
+  get_impl().set_compression_window_log(wlog);
+}
+
+void Protocol::set_validated_transport(bool enable)
+{
+  get_impl().set_validated_transport(enable);
+}
+
+void Protocol::set_skip_warnings(bool enable)
+{
+  get_impl().set_skip_warnings(enable);
+}
+
+const Protocol_stats& Protocol::get_stats() const
+{
+  return get_impl().m_stats;
+}
+
 Protocol::Op& Protocol::snd_CapabilitiesSet(const api::Any::Document& caps)
 {
   Mysqlx::Connection::CapabilitiesSet msg;
@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Benchmarks of the client protocol path against an in-process mock
+  server.
+
+  The mock is built on Protocol_server and an in-memory stream
+  (foundation::test::Mem_stream), so no network or real server is
+  involved: the measurements isolate client CPU - message framing,
+  protobuf decoding and allocation - from server and network variance.
+  The mock replays a canned session: the authentication handshake is
+  answered by Protocol_server directly, while result sets are streamed
+  as pre-serialized frames (the frame and message encodings are simple
+  enough to produce by hand, see mk_resultset() below).
+
+  This is not a correctness test and it is not run as part of the test
+  suite. Build the proto_bench target and run it manually to compare
+  protocol performance between revisions. Each benchmark reports
+  operations per second (handshakes or rows), payload throughput and
+  heap allocations per operation (via operator new interposition, so
+  that allocation regressions are visible even when timings are noisy).
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include <mysql/cdk/foundation.h>
+#include <mysql/cdk/protocol/mysqlx.h>
+
+using namespace cdk::foundation;
+using namespace cdk::protocol::mysqlx;
+
+using cdk::byte;
+
+
+/*
+  Count heap allocations made while benchmarks run. Only the number of
+  allocations is tracked -- that is enough to spot code paths which
+  start (or stop) allocating per message or per row.
+*/
+
+static uint64_t alloc_count = 0;
+
+void* operator new(size_t size)
+{
+  ++alloc_count;
+  if (void *ptr = malloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+  ++alloc_count;
+  if (void *ptr = malloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+
+/*
+  The loopback connection: client Protocol on one end, the mock on the
+  other. Large enough to hold a complete canned result set.
+*/
+
+typedef test::Mem_stream<16*1024*1024> Stream;
+
+
+/*
+  Pre-serialized frames.
+
+  A frame is a little-endian 32-bit length (which counts the type byte),
+  the message type byte and the protobuf-encoded payload. The payloads
+  used here involve only varint (wire type 0) and length-delimited
+  (wire type 2) protobuf fields, which are easy to produce by hand.
+*/
+
+void put_varint(std::string &out, uint64_t val)
+{
+  do {
+    byte b = (byte)(val & 0x7F);
+    val >>= 7;
+    if (val)
+      b |= 0x80;
+    out.push_back((char)b);
+  } while (val);
+}
+
+void put_frame(std::string &out, unsigned type, const std::string &payload)
+{
+  uint32_t len = (uint32_t)payload.size() + 1;
+  for (unsigned i = 0; i < 4; ++i)
+    out.push_back((char)((len >> (8*i)) & 0xFF));
+  out.push_back((char)type);
+  out += payload;
+}
+
+/*
+  ColumnMetaData with only the required type field (1 = SINT, 7 = BYTES).
+*/
+
+std::string mk_column(unsigned field_type)
+{
+  std::string payload;
+  payload.push_back('\x08');        // field 1 (type), wire type 0
+  put_varint(payload, field_type);
+  return payload;
+}
+
+/*
+  Row message: each field is a length-delimited entry of field 1.
+*/
+
+std::string mk_row(const std::vector<std::string> &fields)
+{
+  std::string payload;
+  for (const std::string &f : fields)
+  {
+    payload.push_back('\x0A');      // field 1 (field), wire type 2
+    put_varint(payload, f.size());
+    payload += f;
+  }
+  return payload;
+}
+
+// A SINT row field: zigzag encoded varint.
+
+std::string mk_sint(int64_t val)
+{
+  std::string out;
+  put_varint(out, (uint64_t(val) << 1) ^ uint64_t(val >> 63));
+  return out;
+}
+
+// A BYTES row field: the data followed by a terminating zero byte.
+
+std::string mk_bytes(size_t len)
+{
+  std::string out(len, 'x');
+  out.push_back('\0');
+  return out;
+}
+
+/*
+  A complete result set: metadata for each column, `rows` copies of the
+  given row, FetchDone and the final StmtExecuteOk.
+*/
+
+std::string mk_resultset(
+  const std::vector<unsigned> &col_types,
+  const std::vector<std::string> &row_fields,
+  unsigned rows
+)
+{
+  std::string out;
+
+  for (unsigned type : col_types)
+    put_frame(out, msg_type::ColumnMetaData, mk_column(type));
+
+  std::string row = mk_row(row_fields);
+
+  for (unsigned i = 0; i < rows; ++i)
+    put_frame(out, msg_type::Row, row);
+
+  put_frame(out, msg_type::FetchDone, std::string());
+  put_frame(out, msg_type::StmtExecuteOk, std::string());
+
+  return out;
+}
+
+
+/*
+  The mock server side of the loopback stream.
+*/
+
+class Mock_server
+{
+  Stream &m_conn;
+  Protocol_server m_srv;
+
+  struct : public Init_processor
+  {
+    void auth_start(const char*, bytes, bytes) {}
+    void auth_continue(bytes) {}
+  } m_init_prc;
+
+public:
+
+  Mock_server(Stream &conn)
+    : m_conn(conn), m_srv(conn)
+  {}
+
+  // Canned handshake: accept whatever the client sent.
+
+  void handle_handshake()
+  {
+    m_srv.rcv_InitMessage(m_init_prc).wait();
+    m_srv.snd_AuthenticateOK(bytes("welcome")).wait();
+  }
+
+  // Stream pre-serialized frames to the client.
+
+  void send_raw(const std::string &blob)
+  {
+    bytes data((byte*)blob.data(), blob.size());
+    Stream::Write_op wr(m_conn, buffers(data));
+    wr.wait();
+  }
+};
+
+
+/*
+  Client-side processors which consume messages doing no work, so that
+  the benchmarks measure the protocol layer itself.
+*/
+
+struct Auth_sink : public Auth_processor
+{
+  void auth_ok(bytes) {}
+  void auth_continue(bytes) {}
+};
+
+struct Mdata_sink : public Mdata_processor
+{};
+
+struct Row_sink : public Row_processor
+{
+  uint64_t m_rows = 0;
+
+  bool row_begin(row_count_t) { return true; }
+  void row_end(row_count_t) { m_rows++; }
+};
+
+struct Stmt_sink : public Stmt_processor
+{};
+
+
+/*
+  Benchmark runner: prints one line per benchmark with ops/s, payload
+  throughput and allocations per operation.
+*/
+
+using clk = std::chrono::steady_clock;
+
+void report(
+  const char *name, uint64_t ops, uint64_t bytes,
+  clk::time_point start, uint64_t allocs_before
+)
+{
+  using namespace std::chrono;
+
+  double secs = duration_cast<duration<double>>(clk::now() - start).count();
+  uint64_t allocs = alloc_count - allocs_before;
+
+  std::cout
+    << std::left << std::setw(26) << name << std::right
+    << std::setw(10) << ops << " ops"
+    << std::setw(12) << std::fixed << std::setprecision(0)
+    << (secs > 0 ? ops / secs : 0) << " ops/s"
+    << std::setw(9) << std::setprecision(1)
+    << (secs > 0 ? bytes / secs / (1024*1024) : 0) << " MB/s"
+    << std::setw(8) << (ops ? allocs / ops : 0) << " allocs/op"
+    << std::endl;
+}
+
+
+const unsigned HANDSHAKE_OPS = 5000;
+const unsigned REPLAYS = 20;
+const unsigned NARROW_ROWS = 10000;
+const unsigned WIDE_ROWS = 2000;
+
+
+void bench_handshake(Stream &conn, Protocol &proto, Mock_server &mock)
+{
+  Auth_sink auth_prc;
+
+  uint64_t allocs = alloc_count;
+  clk::time_point start = clk::now();
+
+  for (unsigned i = 0; i < HANDSHAKE_OPS; ++i)
+  {
+    conn.reset();
+    proto.snd_AuthenticateStart("MYSQL41", bytes("user"), bytes("")).wait();
+    mock.handle_handshake();
+    proto.rcv_AuthenticateReply(auth_prc).wait();
+  }
+
+  report("handshake", HANDSHAKE_OPS, 0, start, allocs);
+}
+
+
+void bench_resultset(
+  const char *name,
+  Stream &conn, Protocol &proto, Mock_server &mock,
+  const std::vector<unsigned> &col_types,
+  const std::vector<std::string> &row_fields,
+  unsigned rows
+)
+{
+  std::string blob = mk_resultset(col_types, row_fields, rows);
+
+  Mdata_sink mdata_prc;
+  Row_sink   row_prc;
+  Stmt_sink  stmt_prc;
+
+  uint64_t allocs = alloc_count;
+  clk::time_point start = clk::now();
+
+  for (unsigned i = 0; i < REPLAYS; ++i)
+  {
+    conn.reset();
+    mock.send_raw(blob);
+
+    proto.rcv_MetaData(mdata_prc).wait();
+    proto.rcv_Rows(row_prc).wait();
+    proto.rcv_StmtReply(stmt_prc).wait();
+  }
+
+  if (row_prc.m_rows != (uint64_t)rows * REPLAYS)
+  {
+    std::cerr << "ERROR: decoded " << row_prc.m_rows << " rows, expected "
+              << (uint64_t)rows * REPLAYS << std::endl;
+    exit(1);
+  }
+
+  report(name, row_prc.m_rows, (uint64_t)blob.size() * REPLAYS, start, allocs);
+}
+
+
+int main()
+{
+  try {
+
+    /*
+      Note: objects of large size can not be allocated on stack, hence
+      the stream lives on the heap.
+    */
+
+    scoped_ptr<Stream> conn(new Stream());
+
+    Protocol    proto(*conn);
+    Mock_server mock(*conn);
+
+    bench_handshake(*conn, proto, mock);
+
+    // 4 integer columns per row.
+
+    bench_resultset(
+      "rows 4 x SINT", *conn, proto, mock,
+      { 1, 1, 1, 1 },
+      { mk_sint(1), mk_sint(-42), mk_sint(123456), mk_sint(INT64_MAX) },
+      NARROW_ROWS
+    );
+
+    // 3 string columns of 100 bytes each per row.
+
+    bench_resultset(
+      "rows 3 x BYTES(100)", *conn, proto, mock,
+      { 7, 7, 7 },
+      { mk_bytes(100), mk_bytes(100), mk_bytes(100) },
+      WIDE_ROWS
+    );
+  }
+  catch (Error &err)
+  {
+    std::cerr << "ERROR: " << err << std::endl;
+    return 1;
+  }
+  catch (std::exception &ex)
+  {
+    std::cerr << "ERROR: " << ex.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
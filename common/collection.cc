@@ -328,9 +328,12 @@ void Op_idx_create::process(cdk::Any::Document::Processor &prc) const
 {
   prc.doc_begin();
 
-  for (auto it : m_map)
+  for (const auto &it : m_map)
   {
-    Value_scalar val(it.second);
+    if (m_round != it.second.m_round)
+      continue;
+
+    Value_scalar val(it.second.m_val);
     val.process_if(prc.key_val(it.first));
   }
 
@@ -391,9 +394,12 @@ void Op_create_modify_base::process(cdk::Any::Document::Processor &prc) const
 
   prc.doc_begin();
 
-  for (auto it : m_map)
+  for (const auto &it : m_map)
   {
-    Value_scalar val(it.second);
+    if (m_round != it.second.m_round)
+      continue;
+
+    Value_scalar val(it.second.m_val);
     val.process_if(prc.key_val(it.first));
   }
 
@@ -35,13 +35,18 @@
 #include "session.h"
 #include "result.h"
 #include "db_object.h"
+#include "stored_expr.h"
+#include "tree_expr.h"
 
 #include <mysql/cdk.h>
+#include <mysql/cdk/converters.h>
 #include <mysqlx/common.h>
 #include <mysqlx/common/op_if.h>
+#include <json_parser.h>
 
 PUSH_SYS_WARNINGS
 #include <bitset>
+#include <chrono>
 #include <list>
 POP_SYS_WARNINGS
 
@@ -115,11 +120,39 @@ protected:
   */
   cdk::scoped_ptr<cdk::Reply> m_reply;
 
+  /*
+    The session's execution gate, held in concurrent-reads mode from the
+    moment the command is sent until the reply is claimed by the result
+    object (see Session_impl::lock_exec()). Empty when the mode is off.
+  */
+
+  std::unique_lock<std::recursive_mutex> m_exec_guard;
+
   Shared_stmt_id m_stmt_id;
   Prepare_state  m_prepare_state = PS_EXECUTE;
   bool m_inited = false;
   bool m_completed = false;
 
+  /*
+    Set when the last execution asked the server to omit textual column
+    meta-data from the reply (see send_prepared_command()).
+  */
+
+  bool m_compact_mdata = false;
+
+  // Set when this operation was already retried after a reconnect.
+
+  bool m_reconnected = false;
+
+  /*
+    Optimizer hints attached to this operation, given as a list of
+    optimizer_switch flags (see Select_if::set_hints()). Applied for the
+    duration of each execution by SET statements pipelined around the
+    command (see init()).
+  */
+
+  std::string m_hints;
+
 public:
 
   Op_base(const Shared_session_impl &sess)
@@ -137,6 +170,7 @@ public:
     : m_sess(other.m_sess)
     , m_stmt_id(other.m_stmt_id)
     , m_prepare_state(other.m_prepare_state)
+    , m_hints(other.m_hints)
   {}
 
   virtual ~Op_base() override
@@ -179,11 +213,22 @@ public:
 
   void reset_state()
   {
+    /*
+      If this statement shape is in the session's cache, remove it - the
+      prepared statement is no longer usable.
+    */
+
+    const string key = stmt_key();
+    if (!key.empty())
+      m_sess->drop_stmt_shape(key);
+
     if (m_stmt_id.unique())
       get_session()->error_stmt_id(*m_stmt_id);
     m_stmt_id.reset();
     m_prepare_state = PS_EXECUTE;
     m_reply.reset();
+    if (m_exec_guard.owns_lock())
+      m_exec_guard.unlock();
     m_inited = false;
     m_completed = false;
   }
@@ -203,6 +248,155 @@ public:
      m_prepare_state = x;
   }
 
+  /*
+    Statement shape key for the session's prepared statement cache.
+
+    Operations which can describe their shape - the statement structure
+    without the values of named parameters and of limit/offset - return
+    a non-empty key here. Executions of same-shaped operations are then
+    counted across operation objects and routed to a shared server-side
+    prepared statement (see Session_impl::check_stmt_shape()). Operations
+    returning an empty key (the default) use prepared statements only when
+    the very same object is executed repeatedly.
+  */
+
+  virtual string stmt_key()
+  {
+    return string();
+  }
+
+  /*
+    Whether this operation can be safely executed again after the
+    connection died while it was in flight - the server may or may not
+    have acted on the original command. Only such operations are retried
+    by the auto-reconnect logic (see retry_after_reconnect()). Plain
+    reads and upserts qualify, the default is to not retry.
+  */
+
+  virtual bool is_idempotent() const
+  {
+    return false;
+  }
+
+  /*
+    Tell whether the given error means that the connection died, as
+    opposed to a server or usage error which the same connection can
+    report again.
+  */
+
+  static bool connection_broken(const cdk::Error &e)
+  {
+    using cdk::foundation::connection::io_error;
+    using cdk::foundation::connection::io_errc;
+
+    if (e.code() == io_error(io_errc::EOS)
+        || e.code() == io_error(io_errc::NO_CONNECTION))
+      return true;
+
+    const std::error_code &ec = e.code();
+
+    return ec == std::errc::connection_reset
+        || ec == std::errc::connection_aborted
+        || ec == std::errc::broken_pipe
+        || ec == std::errc::network_reset;
+  }
+
+  /*
+    Called when executing the operation failed with the given error. If
+    the connection died under an idempotent statement and the session
+    allows transparent reconnect (AUTO_RECONNECT option), re-establish
+    the connection with replayed session state and reset this operation
+    so that it can be executed again. Each operation is retried at most
+    once - if the fresh connection dies too, the error surfaces.
+  */
+
+  bool retry_after_reconnect(const cdk::Error &e)
+  {
+    if (m_reconnected || !is_idempotent() || !connection_broken(e))
+      return false;
+
+    if (!m_sess->reconnect())
+      return false;
+
+    m_reconnected = true;
+    reset_state();
+    return true;
+  }
+
+  /*
+    Consult the session's prepared statement cache before sending the
+    command (see stmt_key()).
+  */
+
+  void check_stmt_cache()
+  {
+    /*
+      If this object has already been routed to a cached statement (or
+      owns a prepared statement), keep it. Objects which do not have
+      a statement id yet can join a cached statement also in the
+      PS_PREPARE_EXECUTE state - this covers statements minted from
+      a precompiled descriptor (see precompile()).
+    */
+
+    if (m_stmt_id)
+      return;
+
+    if (PS_EXECUTE != m_prepare_state && PS_PREPARE_EXECUTE != m_prepare_state)
+      return;
+
+    const string key = stmt_key();
+
+    if (key.empty())
+      return;
+
+    switch (m_sess->check_stmt_shape(key, m_stmt_id))
+    {
+    case Session_impl::SHAPE_NEW:
+      break;
+    case Session_impl::SHAPE_SEEN:
+      m_prepare_state = PS_PREPARE_EXECUTE;
+      break;
+    case Session_impl::SHAPE_PREPARED:
+      m_prepare_state = PS_EXECUTE_PREPARED;
+      break;
+    }
+  }
+
+  /*
+    After a successful execution which used (or has just prepared) a
+    statement with a known shape, publish the statement id in the session's
+    cache so that other operation objects of the same shape can use it.
+  */
+
+  void publish_stmt_shape()
+  {
+    if (PS_EXECUTE_PREPARED != m_prepare_state || 0 == get_stmt_id())
+      return;
+
+    const string key = stmt_key();
+
+    if (!key.empty())
+      m_sess->publish_stmt_shape(key, m_stmt_id);
+  }
+
+  /*
+    Ahead-of-time compilation (see Executable_if::precompile()). Join an
+    existing prepared statement of the same shape if there is one.
+    Otherwise mark the operation so that its first execution prepares
+    a server-side statement - in the same round trip as the execution
+    itself - instead of warming up with a direct execution first. Later
+    executions of this operation, of its copies and of same-shaped
+    operations then send only the statement id and the bind values.
+  */
+
+  void precompile() override
+  {
+    check_stmt_cache();
+
+    if (PS_EXECUTE == m_prepare_state && !m_stmt_id)
+      m_prepare_state = PS_PREPARE_EXECUTE;
+  }
+
   // Async execution
 
   /*
@@ -231,8 +425,70 @@ public:
       processing logic.
     */
 
+    // Route this execution through a cached prepared statement, if possible.
+
+    check_stmt_cache();
+
+    /*
+      In concurrent-reads mode only one statement at a time may be in
+      flight on the shared connection - the gate taken here is released
+      when the reply is handed over to the result object
+      (see get_reply()).
+    */
+
+    m_exec_guard = m_sess->lock_exec();
+
+    /*
+      Optimizer hints (see Select_if::set_hints()): the hinted
+      optimizer_switch flags are applied for the duration of this
+      statement by SET statements pipelined around the command - they
+      travel in the same network round trip, so hints cost no extra
+      latency. Replies to the SET statements are examined at the next
+      transaction boundary, like those of pipelined transaction
+      commands.
+    */
+
+    if (!m_hints.empty())
+      m_sess->pipeline_session_cmd(
+        "SET SESSION optimizer_switch='" + m_hints + "'");
+
     m_sess->prepare_for_cmd();
     m_reply.reset(send_command());
+
+    if (!m_hints.empty())
+      m_sess->pipeline_session_cmd(
+        "SET SESSION optimizer_switch='" + hints_restore() + "'");
+  }
+
+  /*
+    The optimizer_switch value which restores the hinted flags to their
+    defaults ("flag=default" for every hinted flag), leaving flags not
+    named in the hints untouched.
+  */
+
+  std::string hints_restore() const
+  {
+    std::string restore;
+    size_t pos = 0;
+
+    while (pos < m_hints.length())
+    {
+      size_t end = m_hints.find(',', pos);
+      if (std::string::npos == end)
+        end = m_hints.length();
+
+      size_t eq = m_hints.find('=', pos);
+      size_t name_end = (std::string::npos == eq || eq > end) ? end : eq;
+
+      if (!restore.empty())
+        restore.push_back(',');
+      restore.append(m_hints, pos, name_end - pos);
+      restore.append("=default");
+
+      pos = end + 1;
+    }
+
+    return restore;
   }
 
   bool is_completed()
@@ -252,9 +508,32 @@ public:
   */
 
   void cont()
+  {
+    try {
+      do_cont();
+    }
+    catch (...)
+    {
+      /*
+        Do not keep the execution gate of concurrent-reads mode over a
+        failed statement - no result object will claim it.
+      */
+
+      if (m_exec_guard.owns_lock())
+        m_exec_guard.unlock();
+      throw;
+    }
+  }
+
+  void do_cont()
   {
     if (m_completed)
       return;
+
+    // Replies can be examined only once the submit batch is on the wire.
+
+    m_sess->flush_submit_batch();
+
     init();
     if (m_reply)
     {
@@ -282,6 +561,8 @@ public:
         reset_state();
         cont();
       }
+      else if (m_reply && m_reply->is_completed())
+        publish_stmt_shape();
 
     }
   }
@@ -292,11 +573,74 @@ public:
 
   void wait()
   {
-    init();
-    if (m_reply)
+    try {
+      do_wait();
+    }
+    catch (...)
+    {
+      // As in cont(), release the execution gate over a failed statement.
+
+      if (m_exec_guard.owns_lock())
+        m_exec_guard.unlock();
+      throw;
+    }
+  }
+
+  void do_wait()
+  {
+    /*
+      Arm the per-statement I/O deadline (STATEMENT_TIMEOUT session
+      option) for the duration of this blocking wait. It covers sending
+      the command as well as waiting for the server reply, so a stuck
+      server fails the statement with Error_timeout instead of blocking
+      indefinitely. The guard disarms the deadline when the wait ends.
+    */
+
+    struct Deadline_guard
+    {
+      Session_impl &m_sess;
+      Deadline_guard(Session_impl &sess) : m_sess(sess)
+      { m_sess.arm_io_deadline(); }
+      ~Deadline_guard()
+      { m_sess.disarm_io_deadline(); }
+    }
+    deadline_guard(*m_sess);
+
+    try {
+
+      // Replies can be examined only once the submit batch is on the wire.
+
+      m_sess->flush_submit_batch();
+
+      init();
+      if (m_reply)
+        m_reply->wait();
+    }
+    catch (const cdk::foundation::connection::Error_timeout&)
     {
-      m_reply->wait();
+      /*
+        The command or its reply was abandoned half-way, leaving the
+        connection in an undefined state - make sure the session is not
+        re-used.
+      */
+      m_sess->io_deadline_expired();
+      throw;
+    }
+    catch (const cdk::Error &e)
+    {
+      /*
+        If the connection died under an idempotent statement, try a
+        transparent reconnect with session-state replay and execute the
+        statement again (AUTO_RECONNECT session option).
+      */
+      if (!retry_after_reconnect(e))
+        throw;
+      wait();
+      return;
+    }
 
+    if (m_reply)
+    {
       bool retry = false;
       try {
         check_errors();
@@ -320,7 +664,8 @@ public:
         reset_state();
         wait();
       }
-
+      else
+        publish_stmt_shape();
 
     }
   }
@@ -338,7 +683,66 @@ public:
     // Can not execute operation that is already completed.
     assert(!m_completed);
 
+    /*
+      Optional statement span (see Span_tracer): covers the whole
+      synchronous execution, from sending the command to the server
+      reply. Without a tracer installed only a pointer is checked.
+    */
+
+    Span_tracer::span_t span = 0;
+    Span_tracer *tracer = trace_start(span);
+
+    try {
+      execute_prepare();
+      wait();
+      execute_cleanup();
+    }
+    catch (...)
+    {
+      trace_end(tracer, span, false);
+      throw;
+    }
+
+    trace_end(tracer, span, true);
+    return *this;
+  }
+
+  /*
+    Split asynchronous execution (see Executable_if). The command is sent
+    by submit(), then is_ready() can be used to poll for the server reply
+    and wait_execute() completes the execution.
+  */
+
+  void submit() override
+  {
+    // Can not execute operation that is already completed.
+    assert(!m_completed);
+
     execute_prepare();
+
+    /*
+      Coalesce this submission with other ones: the command is appended to
+      the session pipeline and written out together with the commands of
+      statements submitted shortly after (see
+      Session_impl::submit_batch_begin()). No-op when coalescing is
+      disabled.
+    */
+
+    m_sess->submit_batch_begin();
+    init();
+    m_sess->submit_batch_add();
+  }
+
+  bool is_ready() override
+  {
+    if (m_completed)
+      return true;
+    cont();
+    return is_completed();
+  }
+
+  Result_init& wait_execute() override
+  {
     wait();
     execute_cleanup();
 
@@ -380,17 +784,37 @@ protected:
   {
     if (use_prepared_statement())
     {
+      /*
+        If result meta-data of this prepared statement is already cached
+        from an earlier execution, ask the server to omit the textual
+        column meta-data from the reply - the cached instance is re-used
+        (see Result_impl::push_row_cache()). The numeric column attributes
+        are still sent and verified against the cache.
+      */
+
+      m_compact_mdata = bool(m_sess->cached_mdata(get_stmt_id()));
+
       return new cdk::Reply(get_cdk_session().prepared_execute(
                               get_stmt_id(),
                               limit,
-                              param
+                              param,
+                              m_compact_mdata
                               ));
     }
+    m_compact_mdata = false;
     return do_send_command();
   }
 
   cdk::Reply* send_prepared_command(const cdk::Any_list* list)
   {
+    /*
+      Note: no compact meta-data here - this path executes prepared SQL
+      statements, whose replies can carry multiple result-sets while only
+      the first one has cached meta-data.
+    */
+
+    m_compact_mdata = false;
+
     if (use_prepared_statement())
     {
       return new cdk::Reply(get_cdk_session().prepared_execute(
@@ -402,6 +826,48 @@ protected:
   }
 
 
+  /*
+    Statement span tracing, active only when the session has a tracer
+    installed (see Span_tracer). trace_start() opens the span and
+    returns the tracer (null when tracing is off); trace_end() closes it
+    reporting the statement shape hash, the server end-point and, for
+    completed DML replies, the affected row count.
+  */
+
+  Span_tracer* trace_start(Span_tracer::span_t &span)
+  {
+    Span_tracer *tracer = m_sess->tracer();
+    if (tracer)
+      span = tracer->span_start(Span_tracer::SPAN_STATEMENT);
+    return tracer;
+  }
+
+  void trace_end(Span_tracer *tracer, Span_tracer::span_t span, bool ok)
+  {
+    if (!tracer)
+      return;
+
+    Span_tracer::Span_attr attr;
+    attr.ok = ok;
+    attr.endpoint = get_cdk_session().id();
+
+    const string key = stmt_key();
+    if (!key.empty())
+      attr.shape_hash = std::hash<string>()(key);
+
+    /*
+      Row counts are reported by the server only at the end of the
+      reply, so they are available here for DML statements; replies
+      whose result set is consumed later report 0.
+    */
+
+    if (ok && m_reply && m_reply->is_completed())
+      attr.rows = m_reply->affected_rows();
+
+    tracer->span_end(Span_tracer::SPAN_STATEMENT, span, attr);
+  }
+
+
   /*
     Hooks that are called just before and after execution of the operation.
 
@@ -484,6 +950,15 @@ protected:
     m_inited = false;
     m_completed = false;
 
+    /*
+      Hand the execution gate over together with the reply - the result
+      object has already re-acquired it before claiming the reply (see
+      the Result_impl constructor).
+    */
+
+    if (m_exec_guard.owns_lock())
+      m_exec_guard.unlock();
+
     /*
       Note: caller takes ownership of the returned cdk::Reply object and for
       that reason we need to release() here to avoid double deletion of the
@@ -493,6 +968,22 @@ protected:
     return m_reply.release();
   }
 
+  uint32_t prepared_stmt_id() override
+  {
+    /*
+      Note: when executing without a prepared statement the id is 0 (or the
+      state is PS_EXECUTE after a fall-back to direct execution) and result
+      meta-data is not cached.
+    */
+
+    return PS_EXECUTE == m_prepare_state ? 0 : get_stmt_id();
+  }
+
+  bool compact_metadata() override
+  {
+    return m_compact_mdata;
+  }
+
 private:
 
   /*
@@ -569,20 +1060,47 @@ protected:
   Op_bind(Shared_session_impl sess) : Base(sess)
   {}
 
-  typedef std::map<cdk::string, Value> param_map_t;
+  /*
+    Note: To avoid re-allocating the parameter storage when the same
+    statement is bound and executed over and over, clear_params() does not
+    erase the map entries but marks them as unused by starting a new bind
+    round - the next round then overwrites keys and values in place. Only
+    entries stamped with the current round are reported to CDK.
+  */
+
+  struct Param_value
+  {
+    Value     m_val;
+    unsigned  m_round = 0;
+  };
+
+  typedef std::map<
+    cdk::string, Param_value, std::less<cdk::string>,
+    cdk::foundation::Tracking_allocator<
+      std::pair<const cdk::string, Param_value>
+    >
+  > param_map_t;
   param_map_t m_map;
+  unsigned  m_round = 1;
+  size_t    m_param_count = 0;
 
 
   // Parameters
 
   void add_param(const string &name, const Value &val) override
   {
-    auto el = m_map.emplace(name, val);
-    //substitute if exists
-    if (!el.second)
-    {
-      el.first->second = val;
-    }
+    auto it = m_map.find(name);
+
+    if (m_map.end() == it)
+      it = m_map.emplace(name, Param_value()).first;
+
+    // Count parameters bound in this round (substitutions do not count).
+
+    if (m_round != it->second.m_round)
+      ++m_param_count;
+
+    it->second.m_val = val;
+    it->second.m_round = m_round;
   }
 
   void add_param(const string &name, const cdk::string &val)
@@ -614,7 +1132,16 @@ protected:
 
   void clear_params() override
   {
-    m_map.clear();
+    // Note: entries are kept, to be re-used by the next bind round.
+
+    if (0 == ++m_round)
+    {
+      // The round counter wrapped around - drop the stale entries.
+      m_map.clear();
+      m_round = 1;
+    }
+
+    m_param_count = 0;
   }
 
 
@@ -624,9 +1151,12 @@ protected:
   {
     prc.doc_begin();
 
-    for (auto it : m_map)
+    for (const auto &it : m_map)
     {
-      Value_scalar val(it.second);
+      if (m_round != it.second.m_round)
+        continue;
+
+      Value_scalar val(it.second.m_val);
       val.process_if(prc.key_val(it.first));
     }
 
@@ -637,7 +1167,7 @@ public:
 
   cdk::Param_source* get_params()
   {
-    return m_map.empty() ? nullptr : this;
+    return 0 == m_param_count ? nullptr : this;
   }
 
   cdk::Reply* send_command() override
@@ -960,8 +1490,13 @@ class Op_group_by
   , cdk::Expr_list
 {
   using string = std::string;
+
+protected:
+
   std::vector<string> m_group_by;
 
+private:
+
 public:
 
   using Shared_session_impl = typename Base::Shared_session_impl;
@@ -1030,6 +1565,7 @@ protected:
 
   std::vector<string> m_projections;
   string  m_doc_proj;
+  std::shared_ptr<Stored_expr> m_stored_proj;
 
   using Shared_session_impl = typename Base::Shared_session_impl;
 
@@ -1041,12 +1577,14 @@ public:
   void set_proj(const string& doc) override
   {
     m_doc_proj = doc;
+    m_stored_proj.reset();
     Base::set_prepare_state(Base::PS_EXECUTE);
   }
 
   void add_proj(const string& field) override
   {
     m_projections.push_back(field);
+    m_stored_proj.reset();
     Base::set_prepare_state(Base::PS_EXECUTE);
   }
 
@@ -1055,6 +1593,7 @@ public:
     if (get_tbl_proj())
       Base::set_prepare_state(Base::PS_EXECUTE);
     m_projections.clear();
+    m_stored_proj.reset();
   }
 
   cdk::Projection* get_tbl_proj()
@@ -1081,58 +1620,106 @@ private:
 
     if (!m_doc_proj.empty())
     {
-      struct : public cdk::Expression::Processor
-      {
-        Doc_prc *m_prc;
+      auto *self = const_cast<Op_projection*>(this);
 
-        Scalar_prc* scalar()
-        {
-          common::throw_error("Scalar expression can not be used as projection");
-          return nullptr;
-        }
+      /*
+        Note: The projection document is parsed in DOCUMENT mode, so the
+        stored tree can be shared with selection criteria using the same
+        source string (see Op_select::get_where()).
+      */
 
-        List_prc* arr()
-        {
-          common::throw_error("Array expression can not be used as projection");
-          return nullptr;
-        }
+      std::string key;
+      key.push_back(char('0' + parser::Parser_mode::DOCUMENT));
+      key.push_back(':');
+      key.append(m_doc_proj);
 
-        // Report that any value is a document.
+      self->m_stored_proj = Base::m_sess->find_stored_expr(key);
 
-        Doc_prc* doc()
-        {
-          return m_prc;
-        }
+      if (!m_stored_proj)
+      {
+        parser::Expression_parser parser(
+          parser::Parser_mode::DOCUMENT, m_doc_proj
+        );
 
+        self->m_stored_proj.reset(new Stored_expr(parser));
+        Base::m_sess->store_expr(key, m_stored_proj);
       }
-      eprc;
-
-      eprc.m_prc = &prc;
 
-      parser::Expression_parser parser(
-        parser::Parser_mode::DOCUMENT, m_doc_proj
-      );
+      /*
+        Note: This throws an error if the stored expression is not
+        a document.
+      */
 
-      parser.process(eprc);
+      m_stored_proj->process(prc);
 
       return;
     }
 
-    prc.doc_begin();
+    /*
+      Like the single-document projection above, the projection document
+      built from the field list is parsed only once: the stored tree is
+      replayed on later executions and shared through the session
+      expression cache with other statements projecting the same fields.
+    */
 
-    for (string field : m_projections)
+    auto *self = const_cast<Op_projection*>(this);
+
+    if (!m_stored_proj)
     {
-      parser::Projection_parser parser(
-        parser::Parser_mode::DOCUMENT, field
-      );
+      std::string key;
+      key.push_back('P');
+      key.push_back(':');
+      for (const string &field : m_projections)
+      {
+        key.append(field);
+        key.push_back('\0');
+      }
 
-      parser.process(prc);
-    }
+      self->m_stored_proj = Base::m_sess->find_stored_expr(key);
 
-    prc.doc_end();
+      if (!m_stored_proj)
+      {
+        Proj_source src(m_projections);
+        self->m_stored_proj.reset(new Stored_expr(src));
+        Base::m_sess->store_expr(key, m_stored_proj);
+      }
+    }
 
+    m_stored_proj->process(prc);
   }
 
+  /*
+    Document expression which builds the projection document from the
+    list of "<expr> AS <path>" strings (used to record the parsed
+    projection into a Stored_expr).
+  */
+
+  struct Proj_source : public cdk::Expression::Document
+  {
+    // Note: base class look-up finds cdk string here, hence std::string.
+
+    const std::vector<std::string> &m_proj;
+
+    Proj_source(const std::vector<std::string> &proj) : m_proj(proj)
+    {}
+
+    void process(Processor &prc) const override
+    {
+      prc.doc_begin();
+
+      for (const std::string &field : m_proj)
+      {
+        parser::Projection_parser parser(
+          parser::Parser_mode::DOCUMENT, field
+        );
+
+        parser.process(prc);
+      }
+
+      prc.doc_end();
+    }
+  };
+
   // cdk::Projection
 
   void process(cdk::Projection::Processor& prc) const override
@@ -1178,19 +1765,24 @@ protected:
 
   string m_where_expr;
   bool   m_where_set = false;
-  std::unique_ptr<parser::Expression_parser> m_expr;
+  std::shared_ptr<Stored_expr> m_stored_where;
+  std::shared_ptr<Tree_expr>  m_tree_where;
   cdk::Lock_mode_value        m_lock_mode = cdk::api::Lock_mode::NONE;
   cdk::Lock_contention_value
     m_lock_contention = cdk::api::Lock_contention::DEFAULT;
 
 
-  // Note: we do not copy m_expr to avoid invoking copy ctor
-  // for Expression_parser
+  /*
+    Note: we do not copy m_stored_where - the copy looks it up in the
+    session cache (or re-parses) when it is needed. An expression tree,
+    on the other hand, is immutable and can be shared with the copy.
+  */
 
   Op_select(const Op_select &other)
     : Base(other)
     , m_where_expr(other.m_where_expr)
     , m_where_set(other.m_where_set)
+    , m_tree_where(other.m_tree_where)
     , m_lock_mode(other.m_lock_mode)
     , m_lock_contention(other.m_lock_contention)
   {}
@@ -1204,6 +1796,17 @@ public:
   {
     m_where_expr = expr;
     m_where_set = true;
+    m_tree_where.reset();
+    Base::set_prepare_state(Base::PS_EXECUTE);
+  }
+
+  void set_where(std::shared_ptr<Expr_node> tree) override
+  {
+    m_where_expr.clear();
+    m_stored_where.reset();
+    m_where_set = true;
+    m_tree_where = tree ? std::make_shared<Tree_expr>(std::move(tree))
+                        : nullptr;
     Base::set_prepare_state(Base::PS_EXECUTE);
   }
 
@@ -1223,8 +1826,49 @@ public:
     Base::set_prepare_state(Base::PS_EXECUTE);
   }
 
+  void set_hints(const string &hints) override
+  {
+    /*
+      The flags are interpolated into a SET statement (see
+      Op_base::init()) - restrict them to the characters
+      optimizer_switch flags are made of.
+    */
+
+    for (char c : hints)
+    {
+      if (!isalnum((unsigned char)c) && '_' != c && ',' != c && '=' != c)
+        common::throw_error("Invalid optimizer_switch flags");
+    }
+
+    Base::m_hints = hints;
+  }
+
+  void clear_hints() override
+  {
+    Base::m_hints.clear();
+  }
+
+  /*
+    Ahead-of-time compilation: parse the selection criteria now, so that
+    executions only replay the stored expression tree. Criteria given as
+    pre-built trees need no compilation.
+  */
+
+  void precompile() override
+  {
+    Base::precompile();
+
+    if (!m_tree_where && !m_where_expr.empty())
+      get_where();
+  }
+
   cdk::Expression* get_where() const
   {
+    // Criteria given as an expression tree need no parsing at all.
+
+    if (m_tree_where)
+      return m_tree_where.get();
+
     if (m_where_expr.empty())
     {
       if (m_where_set)
@@ -1234,8 +1878,27 @@ public:
 
     auto *self = const_cast<Op_select*>(this);
 
-    self->m_expr.reset(new parser::Expression_parser(PM, m_where_expr));
-    return m_expr.get();
+    /*
+      Re-use the expression tree stored for this source string by an earlier
+      statement in this session, if any. Otherwise parse the string, storing
+      the parsed tree for later statements (see Session_impl::m_expr_cache).
+    */
+
+    std::string key;
+    key.push_back(char('0' + PM));
+    key.push_back(':');
+    key.append(m_where_expr);
+
+    self->m_stored_where = Base::m_sess->find_stored_expr(key);
+
+    if (!m_stored_where)
+    {
+      parser::Expression_parser parser(PM, m_where_expr);
+      self->m_stored_where.reset(new Stored_expr(parser));
+      Base::m_sess->store_expr(key, m_stored_where);
+    }
+
+    return m_stored_where.get();
   }
 };
 
@@ -1257,7 +1920,8 @@ struct Op_sql
 
   string m_query;
 
-  typedef std::list<Value> param_list_t;
+  typedef std::list<Value, cdk::foundation::Tracking_allocator<Value>>
+    param_list_t;
 
   Op_sql(Shared_session_impl sess, const string &query)
     : Op_base(sess), m_query(query)
@@ -1324,21 +1988,74 @@ struct Op_sql
     return new Op_sql(*this);
   }
 
+  /*
+    Plain queries can be safely executed again after a reconnect (see
+    Op_base::is_idempotent()). Data-modifying statements can not - the
+    server may have applied the original command before the connection
+    died.
+  */
+
+  bool is_idempotent() const override
+  {
+    size_t beg = m_query.find_first_not_of(" \t\r\n(");
+
+    if (string::npos == beg)
+      return false;
+
+    size_t end = m_query.find_first_of(" \t\r\n(", beg);
+    string tok = m_query.substr(
+      beg, string::npos == end ? string::npos : end - beg
+    );
+
+    for (auto &c : tok)
+      c = (char)std::toupper((unsigned char)c);
+
+    return "SELECT" == tok || "SHOW" == tok || "EXPLAIN" == tok
+        || "DESCRIBE" == tok || "DESC" == tok;
+  }
+
   void execute_cleanup() override
   {
     clear_params();
   }
 
+  /*
+    Statement shape for the session's prepared statement cache (see
+    Op_base::stmt_key()). For an SQL statement the query text itself is the
+    shape - placeholder values are sent at execution time. Thus repeated
+    sql() calls with identical query strings share one server-side prepared
+    statement, even though each call creates a new operation object.
+  */
+
+  string stmt_key() override
+  {
+    string key("sql");
+    key.append(std::to_string(m_query.size()));
+    key.push_back(':');
+    key.append(m_query);
+    return key;
+  }
+
   cdk::Reply* send_command() override
   {
-    return do_send_command();
+    /*
+      Session-mutating statements are recorded in the session's replay
+      log (see Session_impl::restore_state()). Statements with bound
+      parameters are skipped - the log keeps statement text only, so
+      they could not be replayed.
+    */
+
+    if (!get_params() && Session_impl::is_state_stmt(m_query))
+      m_sess->log_state_stmt(m_query);
+
+    return send_prepared_command(get_params());
   }
 
   cdk::Reply* do_send_command() override
   {
     return new cdk::Reply(
           get_cdk_session().sql(
-            0,
+            get_stmt_id(),
             m_query,
             get_params()
             ));
@@ -1410,6 +2127,7 @@ inline
 cdk::Reply* Op_trx<Trx_op::BEGIN>::send_command()
 {
   get_cdk_session().begin();
+  m_sess->m_in_trx = true;
   return nullptr;
 }
 
@@ -1418,6 +2136,7 @@ inline
 cdk::Reply* Op_trx<Trx_op::COMMIT>::send_command()
 {
   get_cdk_session().commit();
+  m_sess->m_in_trx = false;
   return nullptr;
 }
 
@@ -1444,6 +2163,8 @@ struct Op_trx<Trx_op::ROLLBACK>
   cdk::Reply* send_command() override
   {
     get_cdk_session().rollback(m_name);
+    if (m_name.empty())
+      m_sess->m_in_trx = false;
     return nullptr;
   }
 
@@ -1633,19 +2354,111 @@ struct Op_create<Object_type::COLLECTION>
 };
 
 
+/*
+  Keys under which answers to existence checks are stored in the session's
+  metadata cache (see Session_impl::find_exists_state()). A key combines
+  a tag identifying the object type ('S' - schema, 'C' - collection,
+  'T' - table or view) with the schema and object name.
+*/
+
+inline
+std::string exists_key(const cdk::api::Schema_ref &schema)
+{
+  return "S:" + std::string(schema.name());
+}
+
+inline
+std::string exists_key(char tag, const cdk::api::Object_ref &obj)
+{
+  assert(obj.schema());
+  std::string key(1, tag);
+  key += ':';
+  key += std::string(obj.schema()->name());
+  key += '\0';
+  key += std::string(obj.name());
+  return key;
+}
+
+
+/*
+  Key identifying a collection in the session's document cache
+  (see Session_impl::doc_cache_find()).
+*/
+
+inline
+std::string doc_cache_key(const cdk::api::Object_ref &obj)
+{
+  std::string key;
+  if (obj.schema())
+    key += std::string(obj.schema()->name());
+  key += '\0';
+  key += std::string(obj.name());
+  return key;
+}
+
+
+/*
+  Update the cached existence state after a successful DDL operation
+  (no-op when the metadata cache is disabled).
+*/
+
+template <Object_type T>
+inline
+void note_exists(
+  Shared_session_impl sess, const cdk::api::Schema_ref &schema, bool exists
+)
+{
+  sess->store_exists_state(
+    exists_key(schema),
+    exists ? Session_impl::EXISTS_YES : Session_impl::EXISTS_NO
+  );
+}
+
+template <Object_type T>
+inline
+void note_exists(
+  Shared_session_impl sess, const cdk::api::Object_ref &obj, bool exists
+)
+{
+  if (Object_type::VIEW == T && !exists)
+  {
+    /*
+      Note: A "drop view" which actually named a table silently succeeds
+      without dropping anything (see Op_drop<Object_type::VIEW>), so the
+      state after the drop is not known.
+    */
+    sess->forget_exists_state(exists_key('T', obj));
+    return;
+  }
+
+  sess->store_exists_state(
+    exists_key(Object_type::COLLECTION == T ? 'C' : 'T', obj),
+    exists ? Session_impl::EXISTS_YES : Session_impl::EXISTS_NO
+  );
+
+  /*
+    Collections are also visible in table listings, so collection DDL
+    invalidates the corresponding table state as well.
+  */
+
+  if (Object_type::COLLECTION == T)
+    sess->forget_exists_state(exists_key('T', obj));
+}
+
+
 /*
   A helper function which constructs an operation that creates a database object
   and executes it.
 */
 
-template <Object_type T, typename... Ty>
+template <Object_type T, class Ref, typename... Ty>
 inline
 void create_object(
-  Shared_session_impl sess, Ty&&... args
+  Shared_session_impl sess, const Ref &obj, Ty&&... args
 )
 {
   try{
-    Op_create<T> create(sess, std::forward<Ty>(args)...);
+    Op_create<T> create(sess, obj, std::forward<Ty>(args)...);
     Result_impl res(create.execute());
     res.next_result();
   }
@@ -1660,6 +2473,7 @@ void create_object(
     throw;
   }
 
+  note_exists<T>(sess, obj, true);
 }
 
 
@@ -1709,14 +2523,14 @@ struct Op_modify<Object_type::COLLECTION>
   and executes it.
 */
 
-template <Object_type T, typename... Ty>
+template <Object_type T, class Ref, typename... Ty>
 inline
 void modify_object(
-  Shared_session_impl sess, Ty&&... args
+  Shared_session_impl sess, const Ref &obj, Ty&&... args
 )
 {
   try{
-    Op_modify<T> modify(sess, std::forward<Ty>(args)...);
+    Op_modify<T> modify(sess, obj, std::forward<Ty>(args)...);
     Result_impl res(modify.execute());
     res.next_result();
   }
@@ -1730,6 +2544,10 @@ void modify_object(
     }
     throw;
   }
+
+  // Note: a successful modification implies that the object exists.
+
+  note_exists<T>(sess, obj, true);
 }
 
 
@@ -1812,15 +2630,17 @@ struct Op_drop<Object_type::SCHEMA>
   and executes it.
 */
 
-template <Object_type T, typename... Ty>
+template <Object_type T, class Ref, typename... Ty>
 inline
 void drop_object(
-  Shared_session_impl sess, Ty... args
+  Shared_session_impl sess, const Ref &obj, Ty... args
 )
 {
-  Op_drop<T> drop(sess, args...);
+  Op_drop<T> drop(sess, obj, args...);
   Result_impl res(drop.execute());
   res.next_result();
+
+  note_exists<T>(sess, obj, false);
 }
 
 
@@ -2029,6 +2849,10 @@ struct Op_list<Object_type::SCHEMA>
 /*
   Helper functions which use object list queries to check existence of objects
   in the database.
+
+  When a metadata staleness budget is configured on the session
+  (METADATA_CACHE_TTL option), a recently stored answer is used instead of
+  querying the server - see Session_impl::find_exists_state().
 */
 
 inline
@@ -2036,9 +2860,56 @@ bool check_schema_exists(
   Shared_session_impl sess, cdk::api::Schema_ref &schema
 )
 {
-  Op_list<Object_type::SCHEMA> find(sess, schema.name());
-  Result_impl res(find.execute());
-  return 0 < res.count();
+  std::string key = exists_key(schema);
+
+  int state = sess->find_exists_state(key);
+
+  if (Session_impl::EXISTS_UNKNOWN == state)
+  {
+    Op_list<Object_type::SCHEMA> find(sess, schema.name());
+    Result_impl res(find.execute());
+    state = 0 < res.count() ? Session_impl::EXISTS_YES
+                            : Session_impl::EXISTS_NO;
+    sess->store_exists_state(key, state);
+  }
+
+  return Session_impl::EXISTS_NO != state;
+}
+
+/*
+  Check existence of a table, additionally telling apart plain tables and
+  views. Returns one of EXISTS_NO, EXISTS_YES (a plain table) and
+  EXISTS_VIEW.
+*/
+
+inline
+int check_table_exists(
+  Shared_session_impl sess,
+  const cdk::api::Object_ref &obj
+)
+{
+  assert(obj.schema());
+
+  std::string key = exists_key('T', obj);
+
+  int state = sess->find_exists_state(key);
+
+  if (Session_impl::EXISTS_UNKNOWN == state)
+  {
+    Op_list<Object_type::TABLE> find(sess, *obj.schema(), obj.name());
+    Result_impl res(find.execute());
+    const Row_data *row = res.get_row();
+
+    if (!row)
+      state = Session_impl::EXISTS_NO;
+    else
+      state = Op_list_objects::check_type<Object_type::VIEW>(*row)
+              ? Session_impl::EXISTS_VIEW : Session_impl::EXISTS_YES;
+
+    sess->store_exists_state(key, state);
+  }
+
+  return state;
 }
 
 template <Object_type T>
@@ -2049,9 +2920,24 @@ bool check_object_exists(
 )
 {
   assert(obj.schema());
-  Op_list<T> find(sess, *obj.schema(), obj.name());
-  Result_impl res(find.execute());
-  return 0 < res.count();
+
+  if (Object_type::TABLE == T)
+    return Session_impl::EXISTS_NO != check_table_exists(sess, obj);
+
+  std::string key = exists_key(Object_type::COLLECTION == T ? 'C' : 'T', obj);
+
+  int state = sess->find_exists_state(key);
+
+  if (Session_impl::EXISTS_UNKNOWN == state)
+  {
+    Op_list<T> find(sess, *obj.schema(), obj.name());
+    Result_impl res(find.execute());
+    state = 0 < res.count() ? Session_impl::EXISTS_YES
+                            : Session_impl::EXISTS_NO;
+    sess->store_exists_state(key, state);
+  }
+
+  return Session_impl::EXISTS_NO != state;
 }
 
 
@@ -2081,6 +2967,124 @@ bool check_object_exists(
   command to the CDK session.
 */
 
+/*
+  Expression processor which estimates the wire size of the values and
+  expressions reported to it, used to divide rows into insert chunks (see
+  Op_table_insert::do_send_command()). String-like payloads count with
+  their length, everything else with a small fixed size.
+*/
+
+struct Size_estimator
+  : public cdk::Expression::Processor
+  , cdk::Expr_processor
+  , cdk::Value_processor
+  , cdk::Expression::Processor::List_prc
+  , cdk::Expression::Document::Processor
+{
+  typedef cdk::string string;
+
+  size_t m_size = 0;
+
+  enum { VALUE_OVERHEAD = 16 };
+
+  // Any processor
+
+  Scalar_prc* scalar() override { return this; }
+  List_prc* arr() override { return this; }
+  Doc_prc* doc() override { return this; }
+
+  // Expr_processor
+
+  Value_prc* val() override { return this; }
+
+  Args_prc* op(const char*) override
+  { m_size += VALUE_OVERHEAD; return this; }
+
+  Args_prc* call(const Object_ref&) override
+  { m_size += VALUE_OVERHEAD; return this; }
+
+  void ref(const Column_ref&, const Doc_path*) override
+  { m_size += VALUE_OVERHEAD; }
+
+  void ref(const Doc_path&) override { m_size += VALUE_OVERHEAD; }
+  void param(const string&) override { m_size += VALUE_OVERHEAD; }
+  void param(uint16_t) override { m_size += VALUE_OVERHEAD; }
+  void var(const string&) override { m_size += VALUE_OVERHEAD; }
+
+  // Value_processor
+
+  void null() override { m_size += VALUE_OVERHEAD; }
+
+  void value(cdk::Type_info, const cdk::Format_info&, cdk::bytes data) override
+  { m_size += VALUE_OVERHEAD + data.size(); }
+
+  void str(const string &val) override
+  { m_size += VALUE_OVERHEAD + val.length(); }
+
+  void num(int64_t) override { m_size += VALUE_OVERHEAD; }
+  void num(uint64_t) override { m_size += VALUE_OVERHEAD; }
+  void num(float) override { m_size += VALUE_OVERHEAD; }
+  void num(double) override { m_size += VALUE_OVERHEAD; }
+  void yesno(bool) override { m_size += VALUE_OVERHEAD; }
+
+  // List/Document processors
+
+  void list_begin() override {}
+  Element_prc* list_el() override { return this; }
+  void list_end() override {}
+
+  void doc_begin() override {}
+  Any_prc* key_val(const string&) override { return this; }
+  void doc_end() override {}
+};
+
+
+/*
+  Reply object returned by insert operations which sent their data as
+  a sequence of chunks (see Op_collection_add::send_command()). It wraps
+  the reply of the last chunk and combines its statistics with the ones
+  accumulated from the replies of the chunks sent earlier.
+*/
+
+class Insert_chunk_reply
+  : public cdk::Reply
+{
+  cdk::row_count_t m_prev_rows;
+
+  // Ids generated by the earlier chunks; the ones of the last chunk are
+  // appended when the full list is first requested.
+
+  mutable std::vector<std::string> m_ids;
+  mutable bool m_ids_complete = false;
+
+public:
+
+  Insert_chunk_reply(
+    Initializer init,
+    cdk::row_count_t prev_rows,
+    std::vector<std::string> &&ids
+  )
+    : Reply(init), m_prev_rows(prev_rows), m_ids(std::move(ids))
+  {}
+
+  cdk::row_count_t affected_rows() override
+  {
+    return m_prev_rows + Reply::affected_rows();
+  }
+
+  const std::vector<std::string>& generated_ids() const override
+  {
+    if (!m_ids_complete)
+    {
+      const auto &last = Reply::generated_ids();
+      m_ids.insert(m_ids.end(), last.begin(), last.end());
+      m_ids_complete = true;
+    }
+    return m_ids;
+  }
+};
+
+
 class Op_collection_add
   : public Op_base<common::Collection_add_if>
   , public cdk::Doc_source
@@ -2090,9 +3094,53 @@ class Op_collection_add
   Object_ref    m_coll;
   std::vector<std::string> m_json;  // note: UTF8 JSON strings
   unsigned m_pos;
+  unsigned m_chunk_end = 0;  // end of the document range being sent
   const cdk::Expression *m_expr = nullptr;
   bool m_upsert = false;
 
+  /*
+    Write-combining state (see set_flush_policy()). When a flush policy
+    is set, documents accumulated by add_json() are shipped to the
+    server in pipelined chunks as the thresholds are reached, without
+    waiting for the replies; send_command() collects the chunk replies
+    and combines their statistics with the final statement.
+
+    A shipped chunk keeps its documents in its own Doc_batch for as
+    long as its reply is pending - the protocol layer may consume the
+    document source lazily, after the flush call has returned.
+  */
+
+  struct Doc_batch : public cdk::Doc_source
+  {
+    std::vector<std::string> m_docs;
+    unsigned m_pos = 0;
+
+    bool next() override
+    {
+      if (m_pos >= m_docs.size())
+        return false;
+      ++m_pos;
+      return true;
+    }
+
+    void process(cdk::Expression::Processor &ep) const override
+    {
+      ep.scalar()->val()->str(m_docs.at(m_pos - 1));
+    }
+  };
+
+  struct Flushed_chunk
+  {
+    std::shared_ptr<Doc_batch>  docs;
+    std::shared_ptr<cdk::Reply> reply;
+  };
+
+  size_t    m_flush_bytes = 0;   // 0 = write-combining disabled
+  uint64_t  m_flush_ms = 0;
+  size_t    m_pending_bytes = 0;
+  std::chrono::steady_clock::time_point  m_first_pending;
+  std::vector<Flushed_chunk>  m_flushed;
+
 public:
 
   Op_collection_add(
@@ -2106,11 +3154,47 @@ public:
     , m_upsert(upsert)
   {}
 
+  /*
+    Note: a copy takes over the operation specification (documents not
+    yet shipped and the flush policy) but not chunks already in flight -
+    their replies stay with, and are collected by, the original.
+  */
+
+  Op_collection_add(const Op_collection_add &other)
+    : Op_base(other)
+    , m_coll(other.m_coll)
+    , m_json(other.m_json)
+    , m_pos(other.m_pos)
+    , m_chunk_end(other.m_chunk_end)
+    , m_expr(other.m_expr)
+    , m_upsert(other.m_upsert)
+    , m_flush_bytes(other.m_flush_bytes)
+    , m_flush_ms(other.m_flush_ms)
+    , m_pending_bytes(other.m_pending_bytes)
+    , m_first_pending(other.m_first_pending)
+  {}
+
   Executable_if* clone() const override
   {
     return new Op_collection_add(*this);
   }
 
+  /*
+    An upsert replays the same documents with the same ids, so executing
+    it again after a reconnect converges to the same state. A plain add
+    would insert duplicates and is not retried.
+  */
+
+  bool is_idempotent() const override
+  {
+    return m_upsert;
+  }
+
+  // Plain DML: the reply carries no result set (see Result_init).
+
+  bool no_data() override
+  { return true; }
+
   /*
     Add a document specified by CDK expression. Only one such document can
     be specified. Another call to add_doc() overwrites previously specified
@@ -2129,12 +3213,73 @@ public:
 
   void add_json(const std::string &json) override
   {
+    /*
+      Write-combining: ship the pending chunk before appending a
+      document that would grow it beyond the byte threshold, or when
+      the oldest pending document has waited longer than the time
+      threshold. Flushing strictly before appending guarantees that
+      execution always has a final non-empty statement whose reply the
+      chunk statistics can be combined with.
+    */
+
+    if (0 != m_flush_bytes && !m_json.empty())
+    {
+      bool flush = m_pending_bytes + json.size() > m_flush_bytes;
+
+      if (!flush && 0 != m_flush_ms)
+        flush = std::chrono::steady_clock::now() - m_first_pending
+                >= std::chrono::milliseconds(m_flush_ms);
+
+      if (flush)
+        flush_docs();
+    }
+
+    if (m_json.empty() && 0 != m_flush_ms)
+      m_first_pending = std::chrono::steady_clock::now();
+
     m_json.push_back(json);
+    m_pending_bytes += json.size();
   }
 
   void clear_docs() override
   {
     m_json.clear();
+    m_pending_bytes = 0;
+  }
+
+  void set_flush_policy(uint64_t bytes, uint64_t ms) override
+  {
+    m_flush_bytes = (size_t)bytes;
+    m_flush_ms = ms;
+  }
+
+  /*
+    Ship the pending documents as one pipelined insert, without waiting
+    for the reply (it is collected by send_command()). The documents
+    move into a Doc_batch owned by the in-flight chunk, so the buffer
+    this operation appends to starts empty again - the add loop never
+    waits for the server.
+  */
+
+  void flush_docs()
+  {
+    if (m_json.empty())
+      return;
+
+    m_sess->doc_cache_invalidate(doc_cache_key(m_coll));
+    m_sess->prepare_for_cmd();
+
+    Flushed_chunk chunk;
+    chunk.docs = std::make_shared<Doc_batch>();
+    chunk.docs->m_docs = std::move(m_json);
+    m_json.clear();
+    m_pending_bytes = 0;
+
+    chunk.reply = std::make_shared<cdk::Reply>(
+      get_cdk_session().coll_add(m_coll, *chunk.docs, nullptr, m_upsert)
+    );
+
+    m_flushed.emplace_back(std::move(chunk));
   }
 
 
@@ -2152,17 +3297,100 @@ public:
 
   cdk::Reply* send_command() override
   {
+    cdk::row_count_t prev_rows = 0;
+    std::vector<std::string> ids;
+    bool chunked = false;
+
+    /*
+      Collect the replies of chunks already shipped by write-combining
+      flushes, in the order they were sent. Their statistics are
+      combined with the reply of the final statement below.
+    */
+
+    for (Flushed_chunk &chunk : m_flushed)
+    {
+      chunk.reply->wait();
+
+      if (chunk.reply->entry_count())
+        chunk.reply->get_error().rethrow();
+
+      prev_rows += chunk.reply->affected_rows();
+      const auto &chunk_ids = chunk.reply->generated_ids();
+      ids.insert(ids.end(), chunk_ids.begin(), chunk_ids.end());
+      chunked = true;
+    }
+
+    m_flushed.clear();
+
     // Do nothing if no documents were specified.
 
     if (!m_expr && m_json.empty())
+    {
+      // Flushes happen strictly before documents are appended, so a
+      // flushed chunk always leaves documents for the final statement.
+
+      assert(!chunked);
       return nullptr;
+    }
+
+    m_sess->doc_cache_invalidate(doc_cache_key(m_coll));
 
     // Issue coll_add statement where documents are described by list
     // of expressions defined by this instance.
 
-    return new cdk::Reply(
-      get_cdk_session().coll_add(m_coll, *this, nullptr, m_upsert)
-    );
+    if (m_expr)
+      return new cdk::Reply(
+        get_cdk_session().coll_add(m_coll, *this, nullptr, m_upsert)
+      );
+
+    /*
+      If the accumulated documents exceed the chunk byte budget
+      (INSERT_CHUNK_SIZE session option), send them as a sequence of
+      smaller inserts instead of a single huge message, to stay below the
+      server packet limit and bound the size of the messages being built.
+      Each chunk but the last one is waited for here and its statistics
+      are combined with the reply of the final chunk (see
+      Insert_chunk_reply).
+    */
+
+    const size_t budget = m_sess->insert_chunk_size();
+
+    while (true)
+    {
+      // Extend the chunk up to the byte budget (at least one document).
+
+      size_t bytes = 0;
+      m_chunk_end = m_pos;
+
+      while (m_chunk_end < m_json.size() && bytes < budget)
+        bytes += m_json[m_chunk_end++].size();
+
+      if (m_chunk_end >= unsigned(m_json.size()))
+      {
+        if (!chunked)
+          return new cdk::Reply(
+            get_cdk_session().coll_add(m_coll, *this, nullptr, m_upsert)
+          );
+
+        return new Insert_chunk_reply(
+          get_cdk_session().coll_add(m_coll, *this, nullptr, m_upsert),
+          prev_rows, std::move(ids)
+        );
+      }
+
+      cdk::Reply reply(
+        get_cdk_session().coll_add(m_coll, *this, nullptr, m_upsert)
+      );
+      reply.wait();
+
+      if (reply.entry_count())
+        reply.get_error().rethrow();
+
+      prev_rows += reply.affected_rows();
+      const auto &chunk_ids = reply.generated_ids();
+      ids.insert(ids.end(), chunk_ids.begin(), chunk_ids.end());
+      chunked = true;
+    }
   }
 
 
@@ -2175,7 +3403,7 @@ public:
       if (m_pos > 0)
         return false;
     }
-    else if (m_pos >= m_json.size())
+    else if (m_pos >= m_chunk_end)
       return false;
     ++m_pos;
     return true;
@@ -2318,6 +3546,13 @@ public:
     return new Op_collection_find(*this);
   }
 
+  // Reads are safe to execute again after a reconnect.
+
+  bool is_idempotent() const override
+  {
+    return true;
+  }
+
   cdk::Reply* do_send_command() override
   {
     return new cdk::Reply(get_cdk_session().coll_find(
@@ -2336,6 +3571,114 @@ public:
                             ));
   }
 
+  /*
+    Statement shape for the session's prepared statement cache (see
+    Op_base::stmt_key()). The key captures the structure of the statement
+    but not the values of named parameters nor the limit/offset values,
+    which are all given at execution time. Each component is length-prefixed
+    and each list is count-prefixed, so that different shapes can not
+    produce the same key.
+  */
+
+  string stmt_key() override
+  {
+    /*
+      Criteria given as a pre-built expression tree have no string form
+      which the key could capture - such statements are not shape-keyed.
+    */
+
+    if (m_tree_where)
+      return string();
+
+    string key("find");
+
+    auto add = [&key](const string &part)
+    {
+      key.append(std::to_string(part.size()));
+      key.push_back(':');
+      key.append(part);
+    };
+
+    add(m_coll.schema() ? std::string(m_coll.schema()->name())
+                        : std::string());
+    add(std::string(m_coll.name()));
+    add(m_where_expr);
+    add(m_doc_proj);
+
+    add(std::to_string(m_projections.size()));
+    for (const string &proj : m_projections)
+      add(proj);
+
+    add(std::to_string(m_order.size()));
+    for (const auto &item : m_order)
+    {
+      add(item.m_expr);
+      key.push_back(char('0' + item.m_dir));
+    }
+
+    add(std::to_string(m_group_by.size()));
+    for (const string &expr : m_group_by)
+      add(expr);
+
+    add(m_having);
+
+    key.push_back(m_has_limit ? 'L' : '-');
+    key.push_back(m_has_offset ? 'O' : '-');
+    key.push_back(char('0' + m_lock_mode));
+    key.push_back(char('0' + m_lock_contention));
+
+    return key;
+  }
+
+  /*
+    Bounded-staleness result caching (Collection_find_if interface, see
+    Session_impl::m_query_cache). The cache key extends the statement
+    shape with the values bound in the current round and the limit/offset
+    values, so that only executions of the complete same query can share
+    a result.
+  */
+
+  string query_key()
+  {
+    string key = stmt_key();
+
+    if (key.empty())
+      return key;
+
+    std::ostringstream vals;
+
+    for (const auto &it : m_map)
+    {
+      if (m_round != it.second.m_round)
+        continue;
+      vals << std::string(it.first) << '=' << it.second.m_val << ';';
+    }
+
+    if (m_has_limit)
+      vals << 'L' << m_limit << ';';
+    if (m_has_offset)
+      vals << 'O' << m_offset << ';';
+
+    key.push_back('|');
+    key.append(vals.str());
+    return key;
+  }
+
+  bool find_cached(
+    uint64_t staleness_ms, std::vector<std::string> &docs
+  ) override
+  {
+    const string key = query_key();
+    return !key.empty() && m_sess->query_cache_find(key, staleness_ms, docs);
+  }
+
+  void store_cached(std::vector<std::string> &&docs) override
+  {
+    const string key = query_key();
+    if (!key.empty())
+      m_sess->query_cache_store(key, std::move(docs));
+  }
+
 };
 
 
@@ -2376,9 +3719,16 @@ public:
     return new Op_collection_remove(*this);
   }
 
+  // Plain DML: the reply carries no result set (see Result_init).
+
+  bool no_data() override
+  { return true; }
+
 
   cdk::Reply* do_send_command() override
   {
+    m_sess->doc_cache_invalidate(doc_cache_key(m_coll));
+
     return new cdk::Reply(get_cdk_session().coll_remove(
                             get_stmt_id(),
                             m_coll,
@@ -2401,6 +3751,117 @@ public:
   interface.
 */
 
+/*
+  Streamed encoding of plain JSON documents into an expression processor.
+
+  A document which is strict JSON (no expression extensions) does not
+  need the expression parser: its SAX events can be fed straight into
+  the given processor - and through it into the protocol encoder - while
+  the text is being scanned, without materializing any parsed nodes.
+  This matters for large merge patches (see Op_collection_modify::patch
+  handling below), whose peak memory then stays independent of the patch
+  size and whose parsing overlaps with message encoding. Scalar values
+  become literal expressions, as in the expression parser.
+*/
+
+struct Json_to_expr_prc_converter
+  : public cdk::Converter<
+      Json_to_expr_prc_converter,
+      cdk::JSON_processor,
+      cdk::Expr_processor
+    >
+{
+  void null()            { m_proc->val()->null(); }
+  void num(int64_t val)  { m_proc->val()->num(val); }
+  void num(uint64_t val) { m_proc->val()->num(val); }
+  void num(float val)    { m_proc->val()->num(val); }
+  void num(double val)   { m_proc->val()->num(val); }
+  void yesno(bool val)   { m_proc->val()->yesno(val); }
+  void str(const cdk::string &val) { m_proc->val()->str(val); }
+};
+
+
+/*
+  A sink which accepts any JSON document - used to check that a document
+  is strict JSON before its events are streamed into the protocol
+  encoder (events already emitted could not be taken back if the check
+  was done while streaming).
+*/
+
+struct Json_check_prc
+  : public cdk::JSON::Processor
+  , cdk::JSON::Processor::Any_prc
+  , cdk::JSON::Processor::Any_prc::List_prc
+  , cdk::JSON_processor
+{
+  // Doc_prc
+
+  Any_prc* key_val(const string&) override { return this; }
+
+  // Any_prc
+
+  Scalar_prc* scalar() override { return this; }
+  List_prc*   arr() override { return this; }
+  Doc_prc*    doc() override { return this; }
+
+  // List_prc
+
+  Element_prc* list_el() override { return this; }
+  void list_begin() override {}
+  void list_end() override {}
+
+  // Scalar_prc
+
+  void null() override {}
+  void str(const cdk::string&) override {}
+  void num(uint64_t) override {}
+  void num(int64_t) override {}
+  void num(float) override {}
+  void num(double) override {}
+  void yesno(bool) override {}
+};
+
+
+/*
+  Stream the given document straight into an expression processor if it
+  is strict JSON. Returns false - without emitting any event - if it is
+  not; the caller then falls back to the expression parser.
+*/
+
+inline
+bool process_streamed_json(
+  const std::string &json, cdk::Expression::Processor &prc
+)
+{
+  parser::JSON_parser doc(json);
+
+  try {
+    Json_check_prc check;
+    doc.process(check);
+  }
+  catch (...)
+  {
+    return false;
+  }
+
+  cdk::Expression::Document::Processor *dprc = prc.doc();
+
+  if (dprc)
+  {
+    cdk::Expr_conv_base<
+      cdk::Doc_prc_converter<Json_to_expr_prc_converter>,
+      cdk::JSON,
+      cdk::Expression::Document
+    >
+    conv(doc);
+
+    conv.process(*dprc);
+  }
+
+  return true;
+}
+
+
 class Op_collection_modify
     : public
         Op_select< doc_mode,
@@ -2444,6 +3905,17 @@ class Op_collection_modify
       if (m_expr)
         return m_expr->process(prc);
 
+      /*
+        Merge patches which are strict JSON are streamed into the
+        protocol encoder chunk-by-chunk instead of going through the
+        expression parser (see process_streamed_json()). Patches using
+        the expression extensions fall back to the parser.
+      */
+
+      if (Impl::MERGE_PATCH == m_op && Value::EXPR == m_val.get_type()
+          && process_streamed_json(m_val.get_string(), prc))
+        return;
+
       Value::Access::process(parser::Parser_mode::DOCUMENT, m_val, prc);
     }
   };
@@ -2471,6 +3943,11 @@ public:
     return new Op_collection_modify(*this);
   }
 
+  // Plain DML: the reply carries no result set (see Result_init).
+
+  bool no_data() override
+  { return true; }
+
   cdk::Reply* do_send_command() override
   {
     // Do nothing if no update specifications were added
@@ -2478,6 +3955,8 @@ public:
     if (m_update.empty())
       return nullptr;
 
+    m_sess->doc_cache_invalidate(doc_cache_key(m_coll));
+
     m_update_it = m_update.end();
 
     return new cdk::Reply(get_cdk_session().coll_update(
@@ -2690,6 +4169,13 @@ class Op_table_select
     return new Op_table_select(*this);
   }
 
+  // Reads are safe to execute again after a reconnect.
+
+  bool is_idempotent() const override
+  {
+    return true;
+  }
+
 public:
 
   Op_table_select(Shared_session_impl sess, const cdk::api::Object_ref &table)
@@ -2719,7 +4205,35 @@ class Op_table_insert
   using Base = Op_base<common::Table_insert_if<Row_impl<VAL>>>;
   using Value = VAL;
   using string = std::string;
-  using Row_list = std::list < Row_impl<VAL> >;
+  using Field_view = typename common::Table_insert_if<Row_impl<VAL>>::Field_view;
+
+  /*
+    A single row to be inserted: either values copied into a Row_impl
+    or, for rows added through add_row_view(), byte ranges borrowed
+    from the caller which are later serialized straight into the
+    protocol message without an intermediate value copy.
+  */
+
+  struct Row_item
+  {
+    Row_impl<VAL>            m_row;
+    std::vector<cdk::bytes>  m_view;
+    bool                     m_borrowed = false;
+
+    Row_item(const Row_impl<VAL> &row)
+      : m_row(row)
+    {}
+
+    Row_item(const Field_view *fields, unsigned count)
+      : m_borrowed(true)
+    {
+      m_view.reserve(count);
+      for (unsigned pos = 0; pos < count; ++pos)
+        m_view.emplace_back((cdk::byte*)fields[pos].first, fields[pos].second);
+    }
+  };
+
+  using Row_list = std::list < Row_item >;
   using Col_list = std::list < string >;
   using Object_ref = impl::common::Object_ref;
 
@@ -2728,6 +4242,11 @@ class Op_table_insert
   Row_list   m_rows;
   typename Row_list::iterator m_cur_row;
 
+  // Range of rows being sent in the current chunk (see do_send_command()).
+
+  typename Row_list::iterator m_chunk_begin;
+  typename Row_list::iterator m_chunk_end;
+
   Col_list m_cols;
   col_count_t  m_col_count = 0;
 
@@ -2752,6 +4271,11 @@ public:
     return new Op_table_insert(*this);
   }
 
+  // Plain DML: the reply carries no result set (see Result_init).
+
+  bool no_data() override
+  { return true; }
+
   // Table_insert_if
 
   void add_column(const string &column) override
@@ -2779,6 +4303,12 @@ public:
     Base::set_prepare_state(Base::PS_EXECUTE);
   }
 
+  void add_row_view(const Field_view *fields, unsigned count) override
+  {
+    m_rows.emplace_back(fields, count);
+    Base::set_prepare_state(Base::PS_EXECUTE);
+  }
+
   void clear_rows() override
   {
     m_rows.clear();
@@ -2803,6 +4333,33 @@ private:
     return do_send_command();
   }
 
+  /*
+    Rough estimate of the wire size of a single row, used to divide rows
+    into chunks. The row values are reported to a Size_estimator the same
+    way they are later reported to CDK when the row is sent.
+  */
+
+  static size_t row_size(Row_item &item)
+  {
+    if (item.m_borrowed)
+    {
+      /*
+        Borrowed fields go to the wire unmodified; add a small margin
+        per field for the message framing.
+      */
+      size_t size = 0;
+      for (auto &fld : item.m_view)
+        size += fld.size() + 8;
+      return size;
+    }
+
+    Size_estimator es;
+    for (col_count_t pos = 0; pos < item.m_row.col_count(); ++pos)
+      Value::Access::process(parser::Parser_mode::TABLE, item.m_row.get(pos), es);
+    return es.m_size;
+  }
+
+
   cdk::Reply* do_send_command() override
   {
     // Do nothing if no rows were specified.
@@ -2810,18 +4367,63 @@ private:
     if (m_rows.empty())
       return nullptr;
 
-    // Prepare iterators to make a pass through m_rows list.
-    m_started = false;
+    /*
+      If the accumulated rows exceed the chunk byte budget
+      (INSERT_CHUNK_SIZE session option), send them as a sequence of
+      smaller inserts instead of a single huge message - see
+      Op_collection_add::send_command() for details.
+    */
 
-    return new cdk::Reply(Base::get_cdk_session().table_insert(
-                            0,
-                            m_table,
-                            *this,
-                            m_cols.empty() ? nullptr : this,
-                            nullptr
-                            )
-                          );
+    const size_t budget = Base::m_sess->insert_chunk_size();
+    cdk::row_count_t prev_rows = 0;
+    bool chunked = false;
+    m_chunk_end = m_rows.begin();
+
+    while (true)
+    {
+      // Extend the chunk up to the byte budget (at least one row).
+
+      size_t bytes = 0;
+      m_chunk_begin = m_chunk_end;
 
+      while (m_chunk_end != m_rows.end() && bytes < budget)
+        bytes += row_size(*m_chunk_end++);
+
+      // Prepare iterators to make a pass through the chunk.
+      m_started = false;
+
+      if (m_rows.end() == m_chunk_end)
+      {
+        if (!chunked)
+          return new cdk::Reply(Base::get_cdk_session().table_insert(
+                                  0,
+                                  m_table,
+                                  *this,
+                                  m_cols.empty() ? nullptr : this,
+                                  nullptr
+                                  )
+                                );
+
+        return new Insert_chunk_reply(
+          Base::get_cdk_session().table_insert(
+            0, m_table, *this, m_cols.empty() ? nullptr : this, nullptr
+          ),
+          prev_rows, {}
+        );
+      }
+
+      cdk::Reply reply(Base::get_cdk_session().table_insert(
+                         0, m_table, *this,
+                         m_cols.empty() ? nullptr : this, nullptr
+                       ));
+      reply.wait();
+
+      if (reply.entry_count())
+        reply.get_error().rethrow();
+
+      prev_rows += reply.affected_rows();
+      chunked = true;
+    }
   }
 
 
@@ -2830,12 +4432,12 @@ private:
   bool next() override
   {
     if (!m_started)
-      m_cur_row = m_rows.begin();
+      m_cur_row = m_chunk_begin;
     else
       ++m_cur_row;
 
     m_started = true;
-    return m_cur_row != m_rows.end();
+    return m_cur_row != m_chunk_end;
   }
 
 
@@ -2853,16 +4455,45 @@ private:
 
   // Row_source (Expr_list)
 
+  // Trivial Format_info for borrowed byte values (cf. Raw_format_info).
+
+  struct Raw_format
+    : public cdk::Format_info
+  {
+    bool for_type(cdk::Type_info) const override { return true; }
+    void get_info(cdk::Format<cdk::TYPE_BYTES>&) const override {}
+    using cdk::Format_info::get_info;
+  };
+
   void process(cdk::Expr_list::Processor &lp) const override
   {
     lp.list_begin();
 
-    for (col_count_t pos = 0; pos < m_cur_row->col_count(); ++pos)
+    if (m_cur_row->m_borrowed)
+    {
+      /*
+        Borrowed fields are reported as raw octet values, so the bytes
+        are written into the protocol message directly from the
+        caller's memory.
+      */
+      for (auto &fld : m_cur_row->m_view)
+      {
+        cdk::Value_processor *vprc
+          = cdk::safe_prc(lp)->list_el()->scalar()->val();
+        if (!vprc)
+          continue;
+        if (!fld.begin())
+          vprc->null();
+        else
+          vprc->value(cdk::TYPE_BYTES, Raw_format(), fld);
+      }
+    }
+    else for (col_count_t pos = 0; pos < m_cur_row->m_row.col_count(); ++pos)
     {
       auto *el = lp.list_el();
       if (el)
         Value::Access::process(
-          parser::Parser_mode::TABLE, m_cur_row->get(pos), *el
+          parser::Parser_mode::TABLE, m_cur_row->m_row.get(pos), *el
         );
     }
 
@@ -2949,6 +4580,11 @@ protected:
     return new Op_table_update(*this);
   }
 
+  // Plain DML: the reply carries no result set (see Result_init).
+
+  bool no_data() override
+  { return true; }
+
   cdk::Reply* do_send_command() override
   {
     m_set_it = m_set_values.end();
@@ -3054,6 +4690,11 @@ protected:
     return new Op_table_remove(*this);
   }
 
+  // Plain DML: the reply carries no result set (see Result_init).
+
+  bool no_data() override
+  { return true; }
+
   cdk::Reply* do_send_command() override
   {
     return new cdk::Reply(Base::get_cdk_session().table_delete(
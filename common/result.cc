@@ -37,6 +37,20 @@
 #include <sstream>
 #include <iomanip>
 #include <cctype>
+#include <algorithm>
+#include <new>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+PUSH_SYS_WARNINGS
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdio>
+#include <sys/mman.h>
+#endif
+POP_SYS_WARNINGS
 
 
 /*
@@ -75,10 +89,36 @@ convert(cdk::bytes data, Format_descr<cdk::TYPE_STRING> &fd)
   if (fd.m_format.is_set())
     return { raw.begin(), raw.size() };
 
+#ifdef NATIVE_UTF8_STRINGS
+
+  /*
+    In utf8-native mode values of columns that use a utf8 compatible
+    character set are stored exactly as received from the server - the wire
+    representation is already the utf8 string. Conversion to the wide
+    string representation happens later, and only if the user asks for a
+    wide string (see Value::get_ustring()). Other character sets still go
+    through the codec below.
+  */
+
+  switch (fd.m_format.charset())
+  {
+  case cdk::Charset::utf8:
+  case cdk::Charset::utf8mb4:
+  case cdk::Charset::ascii:
+    return std::string(raw.begin(), raw.end());
+  default:
+    break;
+  }
+
+#endif
+
   auto &codec = fd.m_codec;
   cdk::string str;
   codec.from_bytes(raw, str);
-  return (std::u16string)str;
+
+  // Note: decoded string is moved into the value, not copied.
+
+  return std::move(str);
 }
 
 
@@ -151,7 +191,7 @@ convert(cdk::bytes data, Format_descr<cdk::TYPE_DOCUMENT>&)
 
   std::string json(data.begin() + i, data.end()-1);
 
-  return Value::Access::mk_json(json);
+  return Value::Access::mk_json(std::move(json));
 }
 
 
@@ -171,16 +211,47 @@ convert(cdk::foundation::bytes data, Format_descr<cdk::TYPE_DATETIME> &)
 
 
 Result_impl::Result_impl(Result_init &init)
-  : m_sess(init.get_session()), m_reply(init.get_reply())
+  : m_sess(init.get_session())
 {
+  /*
+    Note: in concurrent-reads mode the execution gate is re-acquired
+    here, before the reply is claimed from the operation (which releases
+    its own hold when handing the reply over), so that the gate stays
+    closed from command submission until the reply is buffered below.
+  */
+
+  auto guard = m_sess->lock_exec();
+
   // Note: init.get_reply() can be NULL in the case of ignored server error
+  m_reply = init.get_reply();
+  m_pstmt_id = init.prepared_stmt_id();
+  m_compact_mdata = init.compact_metadata();
   m_sess->register_result(this);
   init.init_result(*this);
+
+  /*
+    In concurrent-reads mode buffer the complete reply and detach from
+    the session: the result is afterwards read from its private cache
+    without touching the shared connection, which frees the gate for
+    statements of other threads.
+  */
+
+  if (m_reply && m_sess->concurrent_reads())
+  {
+    store_all_results();
+    m_sess->deregister_result(this);
+  }
 }
 
 
 Result_impl::~Result_impl()
 {
+  try {
+    finish_fetch(true);
+  }
+  catch (...)
+  {}
+
   try {
     if (m_sess)
       m_sess->deregister_result(this);
@@ -196,6 +267,10 @@ Result_impl::~Result_impl()
 
 bool Result_impl::next_result()
 {
+  // A background fetch appends to the cache popped below - complete it first.
+
+  finish_fetch(true);
+
   pop_row_cache();
   if(!m_result_cache.empty())
     return true;
@@ -204,6 +279,44 @@ bool Result_impl::next_result()
   return read_next_result();
 }
 
+void Result_impl::discard()
+{
+  finish_fetch(true);
+
+  // Drop all cached result-sets (recycling their row storage).
+
+  while (!m_result_cache.empty())
+    pop_row_cache();
+
+  while (!m_result_mdata.empty())
+    m_result_mdata.pop();
+
+  m_replay_mdata.reset();
+  m_replay_spill.reset();
+  m_replay_rows = 0;
+
+  delete m_cursor;
+  m_cursor = nullptr;
+  m_pending_rows = false;
+  m_inited = true;
+
+  /*
+    Put the reply into discard mode and drive it to completion: the
+    remaining result sets are consumed from the wire and dropped frame
+    by frame, nothing is stored.
+  */
+
+  if (m_reply)
+  {
+    m_reply->discard();
+    m_reply->wait();
+  }
+
+  if (m_sess)
+    m_sess->deregister_result(this);
+}
+
+
 bool Result_impl::read_next_result()
 {
   /*
@@ -224,6 +337,25 @@ bool Result_impl::read_next_result()
   m_pending_rows = false;
   m_inited = true;
 
+  /*
+    Install the result set prepared by the replay constructor as if it
+    just arrived from the server. Its rows stay in the spool file and
+    are paged in through the spill machinery.
+  */
+
+  if (m_replay_mdata)
+  {
+    m_result_mdata.push(std::move(m_replay_mdata));
+    m_result_cache.push(Row_cache());
+    m_result_cache_size.push(m_replay_rows);
+    m_row_spill.push(std::move(m_replay_spill));
+    m_back_cache_bytes = 0;
+    m_replay_mdata.reset();
+    m_replay_spill.reset();
+    m_replay_rows = 0;
+    return true;
+  }
+
   if (!m_reply)
     return false;
 
@@ -252,123 +384,1689 @@ bool Result_impl::read_next_result()
 
 void Result_impl::push_row_cache()
 {
-  m_result_mdata.push(Shared_meta_data(new Meta_data(*m_cursor)));
+  Shared_meta_data md;
+
+  /*
+    If the command was executed through a prepared statement, meta-data
+    built on a previous execution can be re-used - result meta-data of a
+    prepared statement is fixed when the statement is prepared. The cached
+    instance is still verified against what the server sent (a schema
+    change under a live statement could alter it) and dropped on mismatch.
+
+    Note: only the first result-set of a reply uses the cache - later ones
+    would overwrite the same cache entry.
+  */
+
+  if (0 != m_pstmt_id && 0 == m_rset_count)
+  {
+    md = m_sess->cached_mdata(m_pstmt_id);
+
+    if (md && !md->matches(*m_cursor))
+      md.reset();
+
+    if (!md)
+    {
+      /*
+        Note: if the command asked the server to omit textual column
+        meta-data (possible only when the cache held an entry, so we get
+        here only after a mismatch), the instance built from the compact
+        frames lacks column names and must not replace the cache entry.
+        The next execution, seeing no cached entry, receives full
+        meta-data again.
+      */
+
+      if (m_compact_mdata)
+        m_sess->cache_mdata(m_pstmt_id, Shared_meta_data());
+
+      md.reset(new Meta_data(*m_cursor, m_sess.get()));
+
+      if (!m_compact_mdata)
+        m_sess->cache_mdata(m_pstmt_id, md);
+    }
+  }
+  else
+    md.reset(new Meta_data(*m_cursor, m_sess.get()));
+
+  m_rset_count++;
+  m_result_mdata.push(std::move(md));
   m_result_cache.push(Row_cache());
   m_result_cache_size.push(0);
+  m_row_spill.push({});
+  m_back_cache_bytes = 0;
+  m_rset_bytes = 0;
+  m_rset_rows = 0;
 }
 
 
-const Row_data* Result_impl::get_row()
+/*
+  Temporary on-disk storage for overflow rows of a stored result.
+
+  Rows are appended as flat records in their wire format (see
+  Row_data::save()) and read back strictly in the order they were
+  written. Reading goes through a memory mapping of the file, so a
+  sequential re-read of a large spilled result streams through the page
+  cache without extra buffer copies. The file is deleted by the system
+  whatever way the process exits: on POSIX systems tmpfile() unlinks it
+  right away, on Windows it is opened with the delete-on-close flag.
+*/
+
+class Result_impl::Row_spill
 {
-  // TODO: Session parameter for cache prefetch size
+#ifdef _WIN32
+  HANDLE m_file = INVALID_HANDLE_VALUE;
+  HANDLE m_mapping = NULL;
+#else
+  FILE *m_file = nullptr;
+#endif
 
-  load_cache(16);
+  byte   *m_view = nullptr;      // current read mapping, if any
+  size_t  m_view_len = 0;
 
-  if (m_result_cache.empty() || m_result_cache.front().empty())
+  size_t      m_written = 0;     // bytes written so far
+  row_count_t m_rows = 0;        // records written so far
+  size_t      m_read_pos = 0;    // read offset within the mapping
+  row_count_t m_read_rows = 0;   // records read back so far
+
+  // Scratch buffer for record serialization, keeps its capacity.
+
+  std::vector<byte> m_buf;
+
+  Row_spill() {}
+
+  bool open();
+  bool map();
+  void unmap();
+  void write(const void *data, size_t len);
+
+public:
+
+  ~Row_spill();
+
+  // Returns null if a temporary file can not be set up.
+
+  static Row_spill* create();
+
+  /*
+    Open the row section of an existing spool file (see
+    Result_impl::spool()) for reading rows back. Records are read
+    starting at the given file offset. Returns null if the file can not
+    be opened.
+  */
+
+  static Row_spill* attach(
+    const std::string &path, size_t offset, row_count_t rows
+  );
+
+  void append(const Row_data&);
+
+  bool pending() const { return m_read_rows < m_rows; }
+
+  /*
+    Decode the next spilled row into `row`, re-using its storage.
+    Returns false when all spilled rows have been read back.
+  */
+
+  bool fetch(Row_data &row);
+};
+
+
+Result_impl::Row_spill* Result_impl::Row_spill::create()
+{
+  Row_spill *spill = new (std::nothrow) Row_spill();
+  if (spill && !spill->open())
   {
-    if (m_reply->entry_count() > 0)
-      m_reply->get_error().rethrow();
+    delete spill;
+    spill = nullptr;
+  }
+  return spill;
+}
+
+
+Result_impl::Row_spill*
+Result_impl::Row_spill::attach(
+  const std::string &path, size_t offset, row_count_t rows
+)
+{
+  Row_spill *spill = new (std::nothrow) Row_spill();
+  if (!spill)
     return nullptr;
+
+  bool ok;
+  size_t file_size = 0;
+
+#ifdef _WIN32
+  spill->m_file = CreateFileA(
+    path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL, NULL
+  );
+  ok = (INVALID_HANDLE_VALUE != spill->m_file);
+  if (ok)
+  {
+    LARGE_INTEGER size;
+    ok = (FALSE != GetFileSizeEx(spill->m_file, &size));
+    file_size = (size_t)size.QuadPart;
+  }
+#else
+  spill->m_file = fopen(path.c_str(), "rb");
+  ok = (nullptr != spill->m_file);
+  if (ok && 0 == fseek(spill->m_file, 0, SEEK_END))
+  {
+    long size = ftell(spill->m_file);
+    ok = (0 <= size);
+    file_size = (size_t)size;
   }
+#endif
 
-  m_row = m_result_cache.front().front();
-  m_result_cache.front().pop_front();
-  m_result_cache_size.front()--;
-  return &m_row;
+  if (!ok || file_size < offset)
+  {
+    delete spill;
+    return nullptr;
+  }
+
+  spill->m_written = file_size;
+  spill->m_read_pos = offset;
+  spill->m_rows = rows;
+  return spill;
 }
 
 
-/*
-  Returns true if there are some rows in the cache after returning from
-  the call. If cache is empty when this method is called, it loads
-  prefetch_size rows into the cache. If prefetch_size is 0, it loads
-  all remaining rows into the cache (even if cache currently contains some
-  rows).
-  It caches elements to the last queue element, since more resultsets could have
-  been cached before.
-*/
+Result_impl::Row_spill::~Row_spill()
+{
+  unmap();
+#ifdef _WIN32
+  if (INVALID_HANDLE_VALUE != m_file)
+    CloseHandle(m_file);
+#else
+  if (m_file)
+    fclose(m_file);
+#endif
+}
 
-bool Result_impl::load_cache(row_count_t prefetch_size)
+
+bool Result_impl::Row_spill::open()
 {
-  if (!m_inited)
-    next_result();
+#ifdef _WIN32
+  wchar_t dir[MAX_PATH + 1];
+  wchar_t path[MAX_PATH + 1];
 
-  if(m_result_cache.empty())
+  if (0 == GetTempPathW(MAX_PATH + 1, dir))
+    return false;
+  if (0 == GetTempFileNameW(dir, L"mxs", 0, path))
     return false;
 
-  if (!m_result_cache.back().empty() && 0 != prefetch_size)
+  m_file = CreateFileW(
+    path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+    FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL
+  );
+  return INVALID_HANDLE_VALUE != m_file;
+#else
+  m_file = tmpfile();
+  return nullptr != m_file;
+#endif
+}
+
+
+void Result_impl::Row_spill::write(const void *data, size_t len)
+{
+#ifdef _WIN32
+  DWORD written = 0;
+  if (!WriteFile(m_file, data, (DWORD)len, &written, NULL) || written != len)
+    THROW("Failed to write to result spill file");
+#else
+  if (len != fwrite(data, 1, len, m_file))
+    THROW("Failed to write to result spill file");
+#endif
+  m_written += len;
+}
+
+
+void Result_impl::Row_spill::append(const Row_data &row)
+{
+  m_buf.clear();
+  row.save(m_buf);
+
+  uint64_t rec_len = m_buf.size();
+  write(&rec_len, sizeof(rec_len));
+  write(m_buf.data(), m_buf.size());
+  m_rows++;
+}
+
+
+bool Result_impl::Row_spill::map()
+{
+  if (m_view && m_view_len >= m_written)
     return true;
 
-  if (!m_pending_rows)
+  unmap();
+
+#ifdef _WIN32
+  m_mapping = CreateFileMappingW(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!m_mapping)
     return false;
 
-  /*
-    Note: if cache is not empty then m_cache_it correctly points at the last
-    element in the cache.
-  */
+  m_view = (byte*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, m_written);
+  if (!m_view)
+  {
+    CloseHandle(m_mapping);
+    m_mapping = NULL;
+    return false;
+  }
+#else
+  fflush(m_file);
 
-  if (m_result_cache.back().empty())
-    m_cache_it = m_result_cache.back().before_begin();
+  void *view = mmap(
+    nullptr, m_written, PROT_READ, MAP_SHARED, fileno(m_file), 0
+  );
+  if (MAP_FAILED == view)
+    return false;
+  m_view = (byte*)view;
+#endif
 
-  // Initiate row reading operation
+  m_view_len = m_written;
+  return true;
+}
 
-  if (0 < prefetch_size)
-    m_cursor->get_rows(*this, prefetch_size);
-  else
-    m_cursor->get_rows(*this);  // this reads all remaining rows
 
-  // Wait for it to complete
+void Result_impl::Row_spill::unmap()
+{
+  if (!m_view)
+    return;
 
-  m_cursor->wait();
+#ifdef _WIN32
+  UnmapViewOfFile(m_view);
+  CloseHandle(m_mapping);
+  m_mapping = NULL;
+#else
+  munmap(m_view, m_view_len);
+#endif
+
+  m_view = nullptr;
+  m_view_len = 0;
+}
+
+
+bool Result_impl::Row_spill::fetch(Row_data &row)
+{
+  if (m_read_rows >= m_rows)
+    return false;
+
+  if (!map())
+    THROW("Failed to map result spill file");
+
+  uint64_t rec_len;
+  if (m_read_pos + sizeof(rec_len) > m_view_len)
+    THROW("Corrupted result spill file");
+  memcpy(&rec_len, m_view + m_read_pos, sizeof(rec_len));
+  m_read_pos += sizeof(rec_len);
+
+  if (rec_len > m_view_len - m_read_pos
+      || !row.load(m_view + m_read_pos, (size_t)rec_len))
+    THROW("Corrupted result spill file");
+
+  m_read_pos += (size_t)rec_len;
+  m_read_rows++;
+  return true;
+}
+
+
+bool Result_impl::spill_append(const Row_data &row)
+{
+  assert(!m_row_spill.empty());
+
+  if (!m_row_spill.back())
+  {
+    m_row_spill.back().reset(Row_spill::create());
+    if (!m_row_spill.back())
+      return false;
+  }
+
+  m_row_spill.back()->append(row);
+  return true;
+}
+
+
+bool Result_impl::has_spilled_rows() const
+{
+  return !m_row_spill.empty() && m_row_spill.front()
+         && m_row_spill.front()->pending();
+}
+
+
+bool Result_impl::spill_refill(row_count_t limit)
+{
+  if (!has_spilled_rows())
+    return false;
+
+  Row_spill &spill = *m_row_spill.front();
+  Row_cache &cache = m_result_cache.front();
 
   /*
-    Cleanup after reading all rows: close the cursor if whole rset has
-    been consumed (or error happend, in which case server won't sent more
-    data).
+    Spilled rows are younger than anything in the in-memory cache (see
+    row_end()), so they are appended at its end. The cache is empty on
+    the regular read path, where finding the end is O(1).
   */
 
-  if (!m_pending_rows || m_reply->entry_count() > 0)
-  {
-    m_cursor->close();
-    m_pending_rows = false;
+  auto it = cache.before_begin();
+  for (auto cur = cache.begin(); cache.end() != cur; ++cur, ++it);
 
-    /*
-      If there are no more rsets in the reply, deregister the result so that
-      session is unlocked for the next command.
-    */
+  row_count_t loaded = 0;
 
-    if (m_reply->end_of_reply())
-      m_sess->deregister_result(this);
+  while (0 == limit || loaded < limit)
+  {
+    Row_data row;
+
+    if (!m_row_pool.empty())
+    {
+      row = std::move(m_row_pool.back());
+      m_row_pool.pop_back();
+    }
+
+    if (!spill.fetch(row))
+    {
+      recycle(std::move(row));
+      break;
+    }
+
+    it = cache.emplace_after(it, std::move(row));
+    loaded++;
   }
 
-  return !m_result_cache.back().empty();
+  /*
+    If this is also the result-set being filled, keep the append
+    iterator pointing at the last cached row (new rows keep going to the
+    spill anyway once it is active, see row_end()).
+  */
+
+  if (1 == m_result_cache.size())
+    m_cache_it = it;
+
+  return 0 < loaded;
 }
 
 
-//  Row_processor interface implementation
+/*
+  Client-side result spooling
+  ===========================
+
+  A spool file stores one result set - its meta-data followed by the
+  rows in their wire format - so that it can be decoded again later
+  without a server (see Result_impl::spool() and the replay
+  constructor). The layout is:
+
+    magic   "MYSQLXSP" (8 bytes)
+    u32     format version
+    u32     number of columns
+    u64     number of row records
+    u64     file offset of the first row record
+    column descriptions
+    row records (u64 record length + Row_data::save() image)
+
+  All integers are stored in host byte order - the file is a local
+  cache, not an interchange format.
+
+  A column description stores the scalar facts needed to rebuild the
+  column meta-data: the CDK type, the column/table/schema names, length,
+  decimals and collation (see cdk::Column_info), plus the per-type
+  encoding format parameters which are normally derived from protocol
+  meta-data (see Col_metadata in cdk/mysqlx).
+*/
 
+static const char SPOOL_MAGIC[8] = {'M','Y','S','Q','L','X','S','P'};
+static const uint32_t SPOOL_VERSION = 1;
 
-size_t Result_impl::field_begin(col_count_t pos, size_t size)
+
+static void spool_put(std::vector<byte> &out, const void *data, size_t len)
 {
-  //m_row.insert(std::pair<col_count_t, Buffer>(pos, Buffer()));
-  m_row.emplace(pos, Buffer());
-  // FIX
-  return size;
+  out.insert(out.end(), (const byte*)data, (const byte*)data + len);
 }
 
-size_t Result_impl::field_data(col_count_t pos, bytes data)
+static void spool_put_str(std::vector<byte> &out, const std::string &str)
 {
-  m_row[(unsigned)pos].append(data);
-  // FIX
-  return data.size();
+  uint32_t len = (uint32_t)str.size();
+  spool_put(out, &len, sizeof(len));
+  spool_put(out, str.data(), str.size());
 }
 
-void Result_impl::row_end(row_count_t)
+
+// Serialize the description of one column into the spool file header.
+
+static void spool_column(const Column_info &ci, std::vector<byte> &out)
 {
-  if (!m_row_filter(m_row))
-    return;
+  uint32_t type = (uint32_t)ci.m_type;
+  spool_put(out, &type, sizeof(type));
+
+  spool_put_str(out, ci.m_label.str());
+  spool_put_str(out, ci.m_name.str());
+  spool_put_str(out, ci.m_table_label.str());
+  spool_put_str(out, ci.m_table_name.str());
+  spool_put_str(out, ci.m_schema_name.str());
+  spool_put_str(out, ci.m_catalog.str());
+
+  uint64_t length = ci.m_length;
+  uint32_t decimals = ci.m_decimals;
+  uint64_t collation = ci.m_collation;
+  spool_put(out, &length, sizeof(length));
+  spool_put(out, &decimals, sizeof(decimals));
+  spool_put(out, &collation, sizeof(collation));
+
+  /*
+    Encoding format parameters, read back through the public accessors
+    of the format descriptors. Their meaning depends on the column type
+    (see Spool_column::get_info() overloads).
+  */
+
+  uint8_t  fmt = 0;
+  uint64_t width = 0;
+  uint32_t cs = 0;
+  uint8_t  kind = 0;
+
+  switch (ci.m_type)
+  {
+  case cdk::TYPE_INTEGER:
+  {
+    auto &f = ci.get<cdk::TYPE_INTEGER>().m_format;
+    fmt = (uint8_t)(
+      f.is_bit() ? cdk::Format<cdk::TYPE_INTEGER>::BIT
+      : f.is_unsigned() ? cdk::Format<cdk::TYPE_INTEGER>::UINT
+      : cdk::Format<cdk::TYPE_INTEGER>::SINT
+    );
+    width = f.length();
+    break;
+  }
+
+  case cdk::TYPE_FLOAT:
+    fmt = (uint8_t)ci.get<cdk::TYPE_FLOAT>().m_format.type();
+    break;
+
+  case cdk::TYPE_STRING:
+  {
+    auto &f = ci.get<cdk::TYPE_STRING>().m_format;
+    cs = (uint32_t)f.charset();
+    width = f.pad_width();
+    kind = (uint8_t)(f.is_set() ? 2 : f.is_enum() ? 1 : 0);
+    break;
+  }
+
+  case cdk::TYPE_DATETIME:
+  {
+    auto &f = ci.get<cdk::TYPE_DATETIME>().m_format;
+    fmt = (uint8_t)f.type();
+    kind = (uint8_t)(f.has_time() ? 1 : 0);
+    break;
+  }
+
+  // No encoding format parameters for these types.
+
+  case cdk::TYPE_DOCUMENT:
+  case cdk::TYPE_GEOMETRY:
+  case cdk::TYPE_XML:
+    break;
+
+  default:
+    width = ci.get<cdk::TYPE_BYTES>().m_format.pad_width();
+    break;
+  }
+
+  spool_put(out, &fmt, sizeof(fmt));
+  spool_put(out, &width, sizeof(width));
+  spool_put(out, &cs, sizeof(cs));
+  spool_put(out, &kind, sizeof(kind));
+}
+
+
+// Bounds-checked cursor over the header of a spool file.
+
+struct Spool_reader
+{
+  const byte *m_cur;
+  size_t      m_left;
+
+  void get(void *out, size_t len)
+  {
+    if (m_left < len)
+      THROW("Corrupted result spool file");
+    memcpy(out, m_cur, len);
+    m_cur += len;
+    m_left -= len;
+  }
+
+  std::string get_str()
+  {
+    uint32_t len;
+    get(&len, sizeof(len));
+    if (m_left < len)
+      THROW("Corrupted result spool file");
+    std::string str((const char*)m_cur, len);
+    m_cur += len;
+    m_left -= len;
+    return str;
+  }
+};
+
+
+/*
+  Column meta-data reconstructed from a spool file. Implements the cdk
+  interfaces from which common::Meta_data is normally built when a
+  result set arrives from the server (compare Col_metadata in
+  cdk/mysqlx, which plays the same role for protocol meta-data).
+*/
+
+class Spool_column
+  : public cdk::Format_info
+  , public cdk::Column_info
+{
+public:
+
+  cdk::Type_info m_type = cdk::TYPE_BYTES;
+
+  std::string m_label;
+  std::string m_col_name;
+
+  uint64_t m_length = 0;
+  uint32_t m_decimals = 0;
+  uint64_t m_collation = 0;
+
+  // Encoding format parameters (see spool_column()).
+
+  uint8_t  m_fmt = 0;
+  uint64_t m_width = 0;
+  uint32_t m_cs = 0;
+  uint8_t  m_kind = 0;
+
+  struct Schema_ref : public cdk::api::Schema_ref
+  {
+    std::string m_name;
+
+    struct Catalog_ref : public cdk::api::Ref_base
+    {
+      std::string m_name;
+      const cdk::string name() const override { return m_name; }
+    } m_catalog;
+
+    const cdk::string name() const override { return m_name; }
+    const cdk::api::Ref_base* catalog() const override { return &m_catalog; }
+  };
+
+  struct Table_ref : public cdk::api::Table_ref
+  {
+    std::string m_name;
+    std::string m_label;
+    Schema_ref  m_schema;
+    bool        m_has_schema = false;
+
+    const cdk::string name() const override { return m_label; }
+    const cdk::string orig_name() const override { return m_name; }
+    const cdk::api::Schema_ref* schema() const override
+    { return m_has_schema ? &m_schema : nullptr; }
+  };
+
+  Table_ref m_table;
+  bool      m_has_table = false;
+
+  void load(Spool_reader &rd)
+  {
+    uint32_t type;
+    rd.get(&type, sizeof(type));
+    m_type = cdk::Type_info(type);
+
+    m_label = rd.get_str();
+    m_col_name = rd.get_str();
+    m_table.m_label = rd.get_str();
+    m_table.m_name = rd.get_str();
+    m_table.m_schema.m_name = rd.get_str();
+    m_table.m_schema.m_catalog.m_name = rd.get_str();
+
+    m_has_table = !m_table.m_name.empty() || !m_table.m_label.empty();
+    m_table.m_has_schema = !m_table.m_schema.m_name.empty();
+
+    rd.get(&m_length, sizeof(m_length));
+    rd.get(&m_decimals, sizeof(m_decimals));
+    rd.get(&m_collation, sizeof(m_collation));
+
+    rd.get(&m_fmt, sizeof(m_fmt));
+    rd.get(&m_width, sizeof(m_width));
+    rd.get(&m_cs, sizeof(m_cs));
+    rd.get(&m_kind, sizeof(m_kind));
+  }
+
+  // cdk::Column_info interface.
+
+  const cdk::string name() const override { return m_label; }
+  const cdk::string orig_name() const override { return m_col_name; }
+  const cdk::api::Table_ref* table() const override
+  { return m_has_table ? &m_table : nullptr; }
+
+  length_t length() const override { return (length_t)m_length; }
+  length_t decimals() const override { return (length_t)m_decimals; }
+  cdk::collation_id_t collation() const override { return m_collation; }
+
+  // cdk::Format_info interface.
+
+  bool for_type(cdk::Type_info ti) const override
+  {
+    // Note: any column data can be presented as raw bytes.
+
+    return ti == m_type || cdk::TYPE_BYTES == ti;
+  }
+
+protected:
+
+  void get_info(cdk::Format<cdk::TYPE_INTEGER> &fmt) const override
+  {
+    using Format = cdk::Format<cdk::TYPE_INTEGER>;
+    Format::Access::set_fmt(fmt, Format::Fmt(m_fmt));
+    Format::Access::set_length(fmt, (size_t)m_width);
+  }
+
+  void get_info(cdk::Format<cdk::TYPE_FLOAT> &fmt) const override
+  {
+    using Format = cdk::Format<cdk::TYPE_FLOAT>;
+    Format::Access::set_fmt(fmt, Format::Fmt(m_fmt));
+  }
+
+  void get_info(cdk::Format<cdk::TYPE_STRING> &fmt) const override
+  {
+    using Format = cdk::Format<cdk::TYPE_STRING>;
+    Format::Access::set_cs(fmt, cdk::Charset::value(m_cs));
+    Format::Access::set_width(fmt, m_width);
+    if (2 == m_kind)
+      Format::Access::set_kind_set(fmt);
+    else if (1 == m_kind)
+      Format::Access::set_kind_enum(fmt);
+  }
+
+  void get_info(cdk::Format<cdk::TYPE_DATETIME> &fmt) const override
+  {
+    using Format = cdk::Format<cdk::TYPE_DATETIME>;
+    Format::Access::set_fmt(fmt, Format::Fmt(m_fmt), 0 != m_kind);
+  }
+
+  void get_info(cdk::Format<cdk::TYPE_BYTES> &fmt) const override
+  {
+    if (0 < m_width)
+      cdk::Format<cdk::TYPE_BYTES>::Access::set_width(fmt, m_width);
+  }
+
+  using cdk::Format_info::get_info;
+};
+
+
+// Source of replayed meta-data consumed by the Meta_data constructor.
+
+struct Spool_mdata : public cdk::Meta_data
+{
+  std::vector<Spool_column> m_cols;
+
+  col_count_t col_count() const override
+  { return (col_count_t)m_cols.size(); }
+
+  cdk::Type_info type(col_count_t pos) override
+  { return m_cols.at(pos).m_type; }
+
+  const cdk::Format_info& format(col_count_t pos) override
+  { return m_cols.at(pos); }
+
+  const cdk::Column_info& col_info(col_count_t pos) override
+  { return m_cols.at(pos); }
+};
+
+
+row_count_t Result_impl::spool(const std::string &path)
+{
+  if (!m_inited)
+    next_result();
+
+  if (m_result_mdata.empty() || !m_result_mdata.front())
+    THROW("No result set to spool");
+
+  const Meta_data &md = *m_result_mdata.front();
+
+  // Build the complete header in memory first.
+
+  std::vector<byte> hdr;
+
+  spool_put(hdr, SPOOL_MAGIC, sizeof(SPOOL_MAGIC));
+
+  uint32_t version = SPOOL_VERSION;
+  uint32_t col_num = (uint32_t)md.col_count();
+  uint64_t row_num = 0;       // patched after the rows are written
+  uint64_t data_off = 0;
+
+  spool_put(hdr, &version, sizeof(version));
+  spool_put(hdr, &col_num, sizeof(col_num));
+
+  size_t row_num_off = hdr.size();
+  spool_put(hdr, &row_num, sizeof(row_num));
+  size_t data_off_off = hdr.size();
+  spool_put(hdr, &data_off, sizeof(data_off));
+
+  for (col_count_t pos = 0; pos < md.col_count(); ++pos)
+    spool_column(md.get_column(pos), hdr);
+
+  data_off = hdr.size();
+  memcpy(hdr.data() + data_off_off, &data_off, sizeof(data_off));
+
+  FILE *file = fopen(path.c_str(), "wb");
+  if (!file)
+    THROW("Failed to create result spool file");
+
+  bool ok = (hdr.size() == fwrite(hdr.data(), 1, hdr.size(), file));
+
+  /*
+    Stream the rows through the regular consumption path, so that rows
+    buffered in memory, spilled to disk and still pending on the
+    connection are all covered.
+  */
+
+  row_count_t rows = 0;
+  std::vector<byte> rec;
+  const Row_data *row;
+
+  while (ok && (row = get_row()))
+  {
+    rec.clear();
+    row->save(rec);
+
+    uint64_t rec_len = rec.size();
+    ok = (sizeof(rec_len) == fwrite(&rec_len, 1, sizeof(rec_len), file))
+         && (rec.size() == fwrite(rec.data(), 1, rec.size(), file));
+    rows++;
+  }
+
+  // Patch the row count in the header.
+
+  if (ok)
+  {
+    row_num = rows;
+    ok = (0 == fseek(file, (long)row_num_off, SEEK_SET))
+         && (sizeof(row_num) == fwrite(&row_num, 1, sizeof(row_num), file));
+  }
+
+  ok = (0 == fclose(file)) && ok;
+
+  if (!ok)
+    THROW("Failed to write to result spool file");
+
+  return rows;
+}
+
+
+Result_impl::Result_impl(const std::string &spool_path)
+{
+  FILE *file = fopen(spool_path.c_str(), "rb");
+  if (!file)
+    THROW("Failed to open result spool file");
+
+  byte fixed[sizeof(SPOOL_MAGIC) + 2*sizeof(uint32_t) + 2*sizeof(uint64_t)];
+  std::vector<byte> cols;
+
+  bool ok = (sizeof(fixed) == fread(fixed, 1, sizeof(fixed), file));
+
+  uint32_t version = 0;
+  uint32_t col_num = 0;
+  uint64_t row_num = 0;
+  uint64_t data_off = 0;
+
+  if (ok)
+  {
+    Spool_reader rd = { fixed, sizeof(fixed) };
+    byte magic[sizeof(SPOOL_MAGIC)];
+    rd.get(magic, sizeof(magic));
+    rd.get(&version, sizeof(version));
+    rd.get(&col_num, sizeof(col_num));
+    rd.get(&row_num, sizeof(row_num));
+    rd.get(&data_off, sizeof(data_off));
+
+    ok = (0 == memcmp(magic, SPOOL_MAGIC, sizeof(magic)))
+         && SPOOL_VERSION == version
+         && sizeof(fixed) <= data_off;
+  }
+
+  if (ok)
+  {
+    cols.resize((size_t)data_off - sizeof(fixed));
+    ok = (cols.size() == fread(cols.data(), 1, cols.size(), file));
+  }
+
+  fclose(file);
+
+  if (!ok)
+    THROW("Corrupted result spool file");
+
+  Spool_mdata src;
+  src.m_cols.resize(col_num);
+
+  Spool_reader rd = { cols.data(), cols.size() };
+  for (Spool_column &col : src.m_cols)
+    col.load(rd);
+
+  m_replay_mdata.reset(new Meta_data(src));
+  m_replay_rows = (row_count_t)row_num;
+
+  m_replay_spill.reset(
+    Row_spill::attach(spool_path, (size_t)data_off, m_replay_rows)
+  );
+  if (!m_replay_spill)
+    THROW("Failed to open result spool file");
+}
+
+
+/*
+  Clamp a prefetch window against the session's result buffer budget
+  (MAX_RESULT_BUFFER option). The size of the rows a window would bring
+  in is estimated from the average size of the rows of this result-set
+  seen so far, and the window is reduced so that the estimate fits in
+  the part of the budget not used by already cached rows. Between the
+  (now smaller) windows nothing is read from the connection, so a
+  consumer which lags behind pushes back on the server through the
+  transport. The clamped window is never 0 - with the budget exhausted
+  rows are fetched one at a time, keeping the reply progressing.
+*/
+
+row_count_t Result_impl::prefetch_window() const
+{
+  return (row_count_t)(m_sess ? m_sess->prefetch_rows() : 64);
+}
+
+
+row_count_t Result_impl::apply_buffer_limit(row_count_t window) const
+{
+  size_t limit = m_sess ? m_sess->max_result_buffer() : 0;
+
+  if (0 == limit || 0 == window)
+    return window;
+
+  if (m_back_cache_bytes >= limit)
+    return 1;
+
+  // Before any row was seen there is nothing to base an estimate on.
+
+  if (0 == m_rset_rows)
+    return window;
+
+  size_t avg = m_rset_bytes / m_rset_rows;
+  row_count_t max_rows
+    = (row_count_t)((limit - m_back_cache_bytes) / (avg ? avg : 1));
+
+  if (0 == max_rows)
+    max_rows = 1;
+
+  return window < max_rows ? window : max_rows;
+}
+
+
+const Row_data* Result_impl::get_row()
+{
+  row_count_t window = apply_buffer_limit(prefetch_window());
+
+  load_cache(window);
+
+  /*
+    When the in-memory part of the cache drains, bring back a window of
+    rows spilled to disk, if any (see spill_refill()).
+  */
+
+  if (m_result_cache.empty() || m_result_cache.front().empty())
+  {
+    if (!spill_refill(window ? window : 1))
+    {
+      if (m_reply && m_reply->entry_count() > 0)
+        m_reply->get_error().rethrow();
+      return nullptr;
+    }
+  }
+
+  /*
+    A background fetch appends rows after m_cache_it which points at the
+    last cached row - complete the fetch before that row is popped below,
+    so the iterator is not left dangling.
+  */
+
+  if (m_fetch_active && m_result_cache_size.front() <= 1)
+    finish_fetch(true);
+
+  /*
+    The caller is done with the previously returned row - recycle its
+    storage and move the next row out of the cache in its place.
+  */
+
+  recycle(std::move(m_row));
+  m_row = std::move(m_result_cache.front().front());
+  m_result_cache.front().pop_front();
+  m_result_cache_size.front()--;
+
+  if (1 == m_result_cache.size())
+    m_back_cache_bytes -= std::min(m_back_cache_bytes, m_row.data_size());
+
+  /*
+    Fetch ahead: when the cache runs low on the current (and only)
+    result-set while more rows are pending, request the next batch now so
+    that reading it overlaps with consumption of the cached rows.
+  */
+
+  if (!m_fetch_active)
+  {
+    if (1 == m_result_cache.size() && m_pending_rows
+        && 2*m_result_cache_size.front() <= window)
+      start_fetch(window);
+  }
+  else
+    finish_fetch(false);
+
+  /*
+    When the caller declared which columns it will read, warm their raw
+    data up while the row handle travels back through the API layers.
+  */
+
+  if (!m_access_pattern.empty())
+    m_row.prefetch_fields(m_access_pattern.data(), m_access_pattern.size());
+
+  return &m_row;
+}
+
+
+bool Result_impl::poll_row()
+{
+  if (!m_inited)
+    next_result();
+
+  // Rows already buffered in memory or spilled to a temporary file.
+
+  if (!m_result_cache.empty() && !m_result_cache.front().empty())
+    return true;
+
+  if (has_spilled_rows())
+    return true;
+
+  // Give an in-flight fetch-ahead operation a chance to proceed.
+
+  if (m_fetch_active)
+  {
+    finish_fetch(false);
+    if (!m_result_cache.front().empty())
+      return true;
+  }
+
+  /*
+    No rows are buffered for the current result-set. Unless it is the one
+    being filled from the connection (the last one in the cache queue)
+    and more rows are pending, it is exhausted and get_row() reports end
+    of data without waiting.
+  */
+
+  if (m_result_cache.empty() || 1 < m_result_cache.size() || !m_pending_rows)
+    return true;
+
+  // Request the next batch and let it progress in the background.
+
+  if (!m_fetch_active)
+    start_fetch(apply_buffer_limit(prefetch_window()));
+
+  return !m_result_cache.front().empty();
+}
+
+
+row_count_t Result_impl::get_rows(Row_data *rows, row_count_t count)
+{
+  row_count_t fetched = 0;
+
+  while (fetched < count)
+  {
+    /*
+      Load at least as many rows as the caller still wants, so that a
+      large request is not served in prefetch-window sized portions.
+    */
+
+    row_count_t window = prefetch_window();
+    if (window < count - fetched)
+      window = count - fetched;
+    window = apply_buffer_limit(window);
+
+    load_cache(window);
+
+    // Re-load spilled rows when the in-memory cache drains.
+
+    if ((m_result_cache.empty() || m_result_cache.front().empty())
+        && !spill_refill(window))
+    {
+      if (0 == fetched && m_reply && m_reply->entry_count() > 0)
+        m_reply->get_error().rethrow();
+      break;
+    }
+
+    /*
+      The whole cache is drained below - a background fetch appending to
+      it must be completed first.
+    */
+
+    if (m_fetch_active)
+      finish_fetch(true);
+
+    Row_cache &cache = m_result_cache.front();
+    row_count_t &cached = m_result_cache_size.front();
+
+    while (fetched < count && !cache.empty())
+    {
+      rows[fetched] = std::move(cache.front());
+      cache.pop_front();
+      cached--;
+
+      if (1 == m_result_cache.size())
+        m_back_cache_bytes -=
+          std::min(m_back_cache_bytes, rows[fetched].data_size());
+
+      fetched++;
+    }
+  }
+
+  return fetched;
+}
+
+
+/*
+  Returns true if there are some rows in the cache after returning from
+  the call. If cache is empty when this method is called, it loads
+  prefetch_size rows into the cache. If prefetch_size is 0, it loads
+  all remaining rows into the cache (even if cache currently contains some
+  rows).
+  It caches elements to the last queue element, since more resultsets could have
+  been cached before.
+*/
+
+bool Result_impl::load_cache(row_count_t prefetch_size)
+{
+  if (!m_inited)
+    next_result();
+
+  if(m_result_cache.empty())
+    return false;
+
+  /*
+    If a fetch-ahead operation is in flight it must be completed before
+    any other cursor interaction. Block only when the cache is empty or
+    all remaining rows were requested; otherwise just let it progress.
+  */
+
+  if (m_fetch_active)
+    finish_fetch(m_result_cache.back().empty() || 0 == prefetch_size);
+
+  if (!m_result_cache.back().empty() && 0 != prefetch_size)
+    return true;
+
+  if (!m_pending_rows)
+    return false;
+
+  /*
+    Note: if cache is not empty then m_cache_it correctly points at the last
+    element in the cache.
+  */
+
+  if (m_result_cache.back().empty())
+    m_cache_it = m_result_cache.back().before_begin();
+
+  // Initiate row reading operation
+
+  if (0 < prefetch_size)
+    m_cursor->get_rows(*this, prefetch_size);
+  else
+    m_cursor->get_rows(*this);  // this reads all remaining rows
+
+  // Wait for it to complete
+
+  m_cursor->wait();
+
+  /*
+    Cleanup after reading all rows: close the cursor if whole rset has
+    been consumed (or error happend, in which case server won't sent more
+    data).
+  */
+
+  if (!m_pending_rows || m_reply->entry_count() > 0)
+  {
+    m_cursor->close();
+    m_pending_rows = false;
+
+    /*
+      If there are no more rsets in the reply, deregister the result so that
+      session is unlocked for the next command.
+    */
+
+    if (m_reply->end_of_reply())
+      m_sess->deregister_result(this);
+  }
+
+  return !m_result_cache.back().empty();
+}
+
+
+void Result_impl::start_fetch(row_count_t prefetch_size)
+{
+  assert(!m_fetch_active);
+
+  if (!m_pending_rows || !m_cursor)
+    return;
+
+  if (m_result_cache.back().empty())
+    m_cache_it = m_result_cache.back().before_begin();
+
+  m_cursor->get_rows(*this, prefetch_size);
+  m_fetch_active = true;
+
+  // Give the read operation an initial chance to proceed.
+
+  finish_fetch(false);
+}
+
+
+/*
+  Columnar batch fetch: decode all remaining rows of the current result
+  set into per-column vectors. Decoding proceeds column by column, so
+  each column's codec and format information stay hot over the whole
+  pass through the batch and values of one column land in contiguous
+  memory.
+*/
+
+void Result_impl::decode_column(
+  col_count_t pos, const Row_cache &rows, row_count_t row_num,
+  const Format_info &fi, Column_batch &batch,
+  std::vector<cdk::bytes> &raw_vals, size_t data_reserve
+)
+{
+  batch.nulls.reserve((size_t)row_num);
+
+  switch (fi.m_type)
+  {
+  case cdk::TYPE_INTEGER:
+  {
+    auto &fd = fi.get<cdk::TYPE_INTEGER>();
+    bool uns = fd.m_format.is_unsigned();
+
+    batch.kind = uns ? Column_batch::Kind::UINT
+                     : Column_batch::Kind::SINT;
+
+    raw_vals.clear();
+    raw_vals.reserve((size_t)row_num);
+
+    for (const Row_data &row : rows)
+    {
+      raw_vals.push_back(row.has_field(pos) ? row.field(pos)
+                                            : cdk::bytes());
+      batch.nulls.push_back(0 == raw_vals.back().size());
+    }
+
+    if (uns)
+    {
+      batch.uints.resize(raw_vals.size());
+      fd.m_codec.from_bytes_batch(
+        raw_vals.data(), raw_vals.size(), batch.uints.data()
+      );
+    }
+    else
+    {
+      batch.sints.resize(raw_vals.size());
+      fd.m_codec.from_bytes_batch(
+        raw_vals.data(), raw_vals.size(), batch.sints.data()
+      );
+    }
+    break;
+  }
+
+  case cdk::TYPE_FLOAT:
+  {
+    auto &fd = fi.get<cdk::TYPE_FLOAT>();
+
+    batch.kind = Column_batch::Kind::DOUBLE;
+
+    raw_vals.clear();
+    raw_vals.reserve((size_t)row_num);
+
+    for (const Row_data &row : rows)
+    {
+      raw_vals.push_back(row.has_field(pos) ? row.field(pos)
+                                            : cdk::bytes());
+      batch.nulls.push_back(0 == raw_vals.back().size());
+    }
+
+    batch.doubles.resize(raw_vals.size());
+    fd.m_codec.from_bytes_batch(
+      raw_vals.data(), raw_vals.size(), batch.doubles.data()
+    );
+    break;
+  }
+
+  default:
+  {
+    /*
+      Strings, documents and remaining types are kept as raw bytes in
+      the arena. String-like data has an artificial 0x00 byte appended
+      (see convert() above) which is stripped here.
+    */
+
+    bool strip = (cdk::TYPE_STRING == fi.m_type
+                  || cdk::TYPE_DOCUMENT == fi.m_type);
+
+    batch.kind = Column_batch::Kind::BYTES;
+    batch.offsets.reserve((size_t)row_num + 1);
+
+    /*
+      Pre-allocate the arena to this column's share of the size
+      announced through reserve(), if any, so that it is not grown
+      through repeated doubling while the values are appended.
+    */
+
+    if (data_reserve)
+      batch.arena.reserve(data_reserve);
+
+    for (const Row_data &row : rows)
+    {
+      batch.offsets.push_back(batch.arena.size());
+
+      cdk::bytes raw = row.has_field(pos) ? row.field(pos) : cdk::bytes();
+      bool is_null = (0 == raw.size());
+      batch.nulls.push_back(is_null);
+
+      if (!is_null)
+      {
+        size_t len = raw.size() - (strip ? 1 : 0);
+        batch.arena.insert(batch.arena.end(), raw.begin(),
+                           raw.begin() + len);
+      }
+    }
+    batch.offsets.push_back(batch.arena.size());
+    break;
+  }
+  }
+}
+
+
+/*
+  Decode one column of the cached rows into Arrow-compatible buffers.
+  The decode mirrors the Column_batch overload above, with the null
+  information additionally packed into the validity bitmap and
+  variable-length data using the 64-bit offsets of the Arrow Large
+  layouts.
+*/
+
+void Result_impl::decode_column(
+  col_count_t pos, const Row_cache &rows, row_count_t row_num,
+  const Column_info &ci, Arrow_column &col,
+  std::vector<cdk::bytes> &raw_vals, size_t data_reserve
+)
+{
+  col.name = ci.m_label.str();
+  col.length = row_num;
+
+  col.validity.assign(((size_t)row_num + 7) / 8, 0);
+
+  row_count_t row = 0;
+
+  auto mark = [&col, &row](bool is_null)
+  {
+    if (is_null)
+      col.null_count++;
+    else
+      col.validity[(size_t)(row / 8)] |= (byte)(1 << (row % 8));
+    row++;
+  };
+
+  switch (ci.m_type)
+  {
+  case cdk::TYPE_INTEGER:
+  {
+    auto &fd = ci.get<cdk::TYPE_INTEGER>();
+    bool uns = fd.m_format.is_unsigned();
+
+    col.type = uns ? Arrow_column::Type::UINT64
+                   : Arrow_column::Type::INT64;
+
+    raw_vals.clear();
+    raw_vals.reserve((size_t)row_num);
+
+    for (const Row_data &row_data : rows)
+    {
+      raw_vals.push_back(row_data.has_field(pos) ? row_data.field(pos)
+                                                 : cdk::bytes());
+      mark(0 == raw_vals.back().size());
+    }
+
+    if (uns)
+    {
+      col.uints.resize(raw_vals.size());
+      fd.m_codec.from_bytes_batch(
+        raw_vals.data(), raw_vals.size(), col.uints.data()
+      );
+    }
+    else
+    {
+      col.ints.resize(raw_vals.size());
+      fd.m_codec.from_bytes_batch(
+        raw_vals.data(), raw_vals.size(), col.ints.data()
+      );
+    }
+    break;
+  }
+
+  case cdk::TYPE_FLOAT:
+  {
+    auto &fd = ci.get<cdk::TYPE_FLOAT>();
+
+    col.type = Arrow_column::Type::FLOAT64;
+
+    raw_vals.clear();
+    raw_vals.reserve((size_t)row_num);
+
+    for (const Row_data &row_data : rows)
+    {
+      raw_vals.push_back(row_data.has_field(pos) ? row_data.field(pos)
+                                                 : cdk::bytes());
+      mark(0 == raw_vals.back().size());
+    }
+
+    col.doubles.resize(raw_vals.size());
+    fd.m_codec.from_bytes_batch(
+      raw_vals.data(), raw_vals.size(), col.doubles.data()
+    );
+    break;
+  }
+
+  default:
+  {
+    bool strip = (cdk::TYPE_STRING == ci.m_type
+                  || cdk::TYPE_DOCUMENT == ci.m_type);
+
+    col.type = strip ? Arrow_column::Type::LARGE_UTF8
+                     : Arrow_column::Type::LARGE_BINARY;
+
+    col.offsets.reserve((size_t)row_num + 1);
+
+    // Pre-allocate the data buffer as in the Column_batch decode above.
+
+    if (data_reserve)
+      col.data.reserve(data_reserve);
+
+    for (const Row_data &row_data : rows)
+    {
+      col.offsets.push_back((int64_t)col.data.size());
+
+      cdk::bytes raw = row_data.has_field(pos) ? row_data.field(pos)
+                                               : cdk::bytes();
+      bool is_null = (0 == raw.size());
+      mark(is_null);
+
+      if (!is_null)
+      {
+        size_t len = raw.size() - (strip ? 1 : 0);
+        col.data.insert(col.data.end(), raw.begin(), raw.begin() + len);
+      }
+    }
+    col.offsets.push_back((int64_t)col.data.size());
+    break;
+  }
+  }
+}
+
+
+template <class COL>
+row_count_t Result_impl::do_fetch_columnar(
+  std::vector<COL> &out, unsigned threads
+)
+{
+  out.clear();
+
+  // Bring all remaining rows of the current result set into the cache.
+
+  load_cache(0);
+
+  /*
+    The columnar output materializes the whole remaining result anyway,
+    so rows spilled to disk are brought back in full before decoding.
+  */
+
+  spill_refill(0);
+
+  if (m_result_cache.empty() || m_result_mdata.empty())
+    return 0;
+
+  Row_cache   &rows = m_result_cache.front();
+  row_count_t  row_num = m_result_cache_size.front();
+  const Shared_meta_data &md = m_result_mdata.front();
+
+  if (!md)
+    return 0;
+
+  col_count_t col_num = md->col_count();
+  out.resize(col_num);
+
+  size_t data_reserve = column_reserve_hint();
+
+  /*
+    Decode order: columns declared in the access pattern go first, so
+    that the data the application reads right away is decoded (and still
+    cache-warm) before the columns it may never look at. The remaining
+    columns follow in position order - the output always covers all of
+    them.
+  */
+
+  std::vector<col_count_t> order;
+  order.reserve(col_num);
+  {
+    std::vector<bool> planned(col_num, false);
+
+    for (col_count_t pos : m_access_pattern)
+    {
+      if (pos < col_num && !planned[pos])
+      {
+        order.push_back(pos);
+        planned[pos] = true;
+      }
+    }
+
+    for (col_count_t pos = 0; pos < col_num; ++pos)
+    {
+      if (!planned[pos])
+        order.push_back(pos);
+    }
+  }
+
+  if (threads > col_num)
+    threads = col_num;
+
+  if (threads > 1)
+  {
+    /*
+      Parallel decode: columns are independent work items (each worker
+      only reads the shared row cache and writes its own Column_batch),
+      so workers pull column positions from a shared counter and the
+      output is identical to the serial decode. The first error raised
+      by a worker is re-thrown on the calling thread once all workers
+      have finished.
+    */
+
+    std::atomic<col_count_t> next_col(0);
+    std::mutex err_mutex;
+    std::exception_ptr err;
+
+    auto worker = [&]()
+    {
+      std::vector<cdk::bytes> raw_vals;
+      col_count_t idx;
+
+      while ((idx = next_col.fetch_add(1)) < col_num)
+      {
+        col_count_t pos = order[idx];
+
+        try
+        {
+          decode_column(
+            pos, rows, row_num, md->get_column(pos), out[pos], raw_vals,
+            data_reserve
+          );
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> guard(err_mutex);
+          if (!err)
+            err = std::current_exception();
+        }
+      }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i)
+      pool.emplace_back(worker);
+
+    worker();  // the calling thread takes part in the decode
+
+    for (std::thread &thd : pool)
+      thd.join();
+
+    if (err)
+      std::rethrow_exception(err);
+  }
+  else
+  {
+    /*
+      Scratch array of per-value byte ranges handed to the batch decoding
+      entry points of the codecs, reused for each numeric column.
+    */
+
+    std::vector<cdk::bytes> raw_vals;
+
+    for (col_count_t pos : order)
+      decode_column(pos, rows, row_num, md->get_column(pos), out[pos],
+                    raw_vals, data_reserve);
+  }
+
+  // The decoded rows are consumed - their storage goes back to the pool.
+
+  for (Row_data &row : rows)
+    recycle(std::move(row));
+
+  rows.clear();
+  m_result_cache_size.front() = 0;
+  if (1 == m_result_cache.size())
+    m_back_cache_bytes = 0;
+
+  return row_num;
+}
+
+
+row_count_t Result_impl::fetch_columns(
+  std::vector<Column_batch> &out, unsigned threads
+)
+{
+  return do_fetch_columnar(out, threads);
+}
+
+
+row_count_t Result_impl::fetch_arrow(
+  std::vector<Arrow_column> &out, unsigned threads
+)
+{
+  return do_fetch_columnar(out, threads);
+}
+
+
+void Result_impl::finish_fetch(bool wait)
+{
+  if (!m_fetch_active)
+    return;
+
+  if (wait)
+    m_cursor->wait();
+  else if (!m_cursor->cont())
+    return;
+
+  m_fetch_active = false;
+
+  // Cleanup after reading all rows, as in load_cache().
+
+  if (!m_pending_rows || m_reply->entry_count() > 0)
+  {
+    m_cursor->close();
+    m_pending_rows = false;
+
+    if (m_reply->end_of_reply())
+      m_sess->deregister_result(this);
+  }
+}
+
+
+//  Row_processor interface implementation
+
+
+size_t Result_impl::field_begin(col_count_t pos, size_t size)
+{
+  /*
+    If a sink is installed for this column its data is streamed to the
+    sink as it arrives instead of being buffered in the row (the row
+    then reports the field as absent).
+  */
+
+  m_cur_sink = nullptr;
+
+  if (!m_field_sinks.empty())
+  {
+    auto it = m_field_sinks.find(pos);
+    if (m_field_sinks.end() != it)
+    {
+      m_cur_sink = &it->second;
+      return size;
+    }
+  }
+
+  m_parse_row.start_field(pos);
+  // FIX
+  return size;
+}
+
+size_t Result_impl::field_data(col_count_t, bytes data)
+{
+  /*
+    Note: the value returned by the sink becomes the protocol reader's
+    next read window, giving the consumer backpressure on the wire data.
+  */
+
+  if (m_cur_sink)
+    return (*m_cur_sink)(data);
+
+  m_parse_row.append(data);
+  // FIX
+  return data.size();
+}
+
+void Result_impl::row_end(row_count_t)
+{
+  if (!m_row_filter(m_parse_row))
+  {
+    recycle(std::move(m_parse_row));
+    return;
+  }
+
+  /*
+    Overflow rows go to the spill file. Once a row of this result-set
+    was spilled, all following ones must be spilled too so that the row
+    order is preserved (in-memory rows are consumed before spilled
+    ones). If spilling is not possible the row stays in memory.
+  */
+
+  m_rset_bytes += m_parse_row.data_size();
+  m_rset_rows++;
+
+  if ((m_back_cache_bytes > spill_threshold()
+       || (!m_row_spill.empty() && m_row_spill.back()))
+      && spill_append(m_parse_row))
+  {
+    recycle(std::move(m_parse_row));
+    m_result_cache_size.back()++;
+    return;
+  }
+
+  m_back_cache_bytes += m_parse_row.data_size();
 
-  m_cache_it = m_result_cache.back().emplace_after(m_cache_it, std::move(m_row));
+  m_cache_it =
+    m_result_cache.back().emplace_after(m_cache_it, std::move(m_parse_row));
   m_result_cache_size.back()++;
 }
 
@@ -43,6 +43,8 @@
 
 PUSH_SYS_WARNINGS
 #include <queue>
+#include <unordered_map>
+#include <cstring>
 POP_SYS_WARNINGS
 
 
@@ -53,6 +55,13 @@ namespace common {
 // TODO: Use std::variant when available
 using cdk::foundation::variant;
 
+/*
+  Containers on the result fetch path declare this allocator so that,
+  in ALLOC_STATS builds, their allocations are counted (see
+  foundation/alloc_stats.h). In normal builds it is std::allocator.
+*/
+using cdk::foundation::Tracking_allocator;
+
 
 /*
   Handling result meta-data information
@@ -72,12 +81,12 @@ using cdk::foundation::variant;
   classes are in fact templates parametrized by class STR used to store string
   data (either std::string or some wide string class).
 
-  Meta_data class contains a map from column positions to instances
-  of Column_info class. Each Column_info instance can store meta-data
+  Meta_data class contains an array of Column_info instances indexed by
+  column position. Each Column_info instance can store meta-data
   information for a single column. The Column_info instances are created in
   the Meta_data constructor which reads meta-data information from
-  cdk::Meta_data interface and adds Column_info objects to the map using add()
-  methods.
+  cdk::Meta_data interface and adds Column_info objects to the array using
+  add() methods.
 
   The CDK meta-data for a single column consists of:
 
@@ -272,6 +281,43 @@ using impl::common::Format_info;
 using impl::common::Format_descr;
 
 
+/*
+  Shared immutable string used for column meta-data names.
+
+  Names are interned in a per-session table (see Session_impl::
+  intern_name()), so that Column_info instances of different result sets
+  reference the same string object instead of each holding a copy. An
+  instance without a string behaves like an empty string.
+*/
+
+class Interned_string
+{
+  std::shared_ptr<const std::string> m_str;
+
+public:
+
+  Interned_string() = default;
+
+  Interned_string(std::shared_ptr<const std::string> str)
+    : m_str(std::move(str))
+  {}
+
+  const std::string& str() const
+  {
+    // Note: created on first use, so that loading the library runs
+    // no constructors.
+    static const std::string empty;
+    return m_str ? *m_str : empty;
+  }
+
+  operator const std::string&() const { return str(); }
+
+  bool empty() const { return !m_str || m_str->empty(); }
+
+  const char* c_str() const { return m_str ? m_str->c_str() : ""; }
+};
+
+
 /*
   Storage for single column meta-data.
 
@@ -289,7 +335,7 @@ class Column_info
 {
 public:
 
-  using string = std::string;
+  using string = Interned_string;
 
   string m_name;
   string m_label;
@@ -328,24 +374,26 @@ public:
 
   /*
     After creating Column_info instance this method should be called to
-    store information taken from cdk::Column_info interface.
+    store information taken from cdk::Column_info interface. Names are
+    interned in the session's name table when a session is given,
+    otherwise each gets its own (still shared, but unshared) string.
   */
 
-  void store_info(const cdk::Column_info &ci)
+  void store_info(const cdk::Column_info &ci, Session_impl *sess = nullptr)
   {
-    m_name = ci.orig_name();
-    m_label = ci.name();
+    m_name = intern(ci.orig_name(), sess);
+    m_label = intern(ci.name(), sess);
 
     if (ci.table())
     {
-      m_table_name = ci.table()->orig_name();
-      m_table_label = ci.table()->name();
+      m_table_name = intern(ci.table()->orig_name(), sess);
+      m_table_label = intern(ci.table()->name(), sess);
 
       if (ci.table()->schema())
       {
-        m_schema_name = ci.table()->schema()->name();
+        m_schema_name = intern(ci.table()->schema()->name(), sess);
         if (ci.table()->schema()->catalog())
-          m_catalog = ci.table()->schema()->catalog()->name();
+          m_catalog = intern(ci.table()->schema()->catalog()->name(), sess);
       }
     }
 
@@ -365,6 +413,14 @@ public:
     }
   }
 
+private:
+
+  static Interned_string intern(const cdk::string &name, Session_impl *sess)
+  {
+    if (sess)
+      return sess->intern_name(name);
+    return std::make_shared<const std::string>(std::string(name));
+  }
 };
 
 }  // common
@@ -388,16 +444,31 @@ struct Meta_data
 protected:
 
   cdk::col_count_t  m_col_count = 0;
-  std::map<cdk::col_count_t, Column_info> m_cols;
+
+  /*
+    Per-column meta-data, indexed by column position. Columns occupy
+    consecutive positions 0 .. col_count()-1, so they are kept in a
+    contiguous array instead of a node-based map - the decode loop walks
+    the columns of every row and should not hop between heap nodes.
+
+    The column types are additionally kept in a separate dense array:
+    get_type() is the single hottest meta-data query on the decode path
+    and this way it touches only a few cache lines even for wide rows.
+  */
+
+  std::vector<Column_info, Tracking_allocator<Column_info>> m_cols;
+
+  std::vector<cdk::Type_info, Tracking_allocator<cdk::Type_info>> m_types;
 
 public:
 
   /*
     Create Meta_data instance and fill it using meta-data information
-    read from the cdk::Meta_data interface.
+    read from the cdk::Meta_data interface. When a session is given,
+    column/table/schema names are interned in its name table.
   */
 
-  Meta_data(cdk::Meta_data&);
+  Meta_data(cdk::Meta_data&, Session_impl *sess = nullptr);
 
   virtual ~Meta_data() {}
 
@@ -420,27 +491,92 @@ public:
 
   cdk::Type_info get_type(cdk::col_count_t pos) const
   {
-    return get_format(pos).m_type;
+    return m_types.at(pos);
+  }
+
+  /*
+    Return position of the column with the given label, or col_count()
+    when there is none. Labels are matched case-insensitively (ASCII
+    folding, as for column names in the server); if several columns
+    share a label the first one wins. The look-up index is built once,
+    on the first call.
+  */
+
+  col_count_t col_index(const std::string &name) const
+  {
+    if (m_name_index.empty() && 0 < m_col_count)
+    {
+      for (cdk::col_count_t pos = 0; pos < m_col_count; ++pos)
+        m_name_index.emplace(fold_name(m_cols[pos].m_label), pos);
+    }
+
+    auto it = m_name_index.find(fold_name(name));
+    return m_name_index.end() != it ? it->second : m_col_count;
+  }
+
+  /*
+    Check whether this meta-data still describes the columns reported by
+    the given cdk::Meta_data instance. Only cheap scalar attributes are
+    compared - enough to detect a schema change under a prepared statement
+    without doing the full re-build with its string copies and collation
+    look-ups.
+  */
+
+  bool matches(cdk::Meta_data &md) const
+  {
+    if (md.col_count() != m_col_count)
+      return false;
+
+    for (cdk::col_count_t pos = 0; pos < m_col_count; ++pos)
+    {
+      const Column_info &col = m_cols.at(pos);
+      const cdk::Column_info &ci = md.col_info(pos);
+
+      if (md.type(pos) != col.m_type
+          || ci.collation() != col.m_collation
+          || ci.length() != col.m_length
+          || ci.decimals() != col.m_decimals)
+        return false;
+    }
+
+    return true;
   }
 
 private:
 
+  // Name look-up index, built lazily by col_index().
+
+  mutable std::unordered_map<std::string, cdk::col_count_t> m_name_index;
+
+  static std::string fold_name(const std::string &name)
+  {
+    std::string key(name);
+    for (auto &c : key)
+      if ('A' <= c && c <= 'Z')
+        c = char(c - 'A' + 'a');
+    return key;
+  }
+
   /*
     Add to this Meta_data instance information about column
     at position `pos`. The type and format information is given
     by cdk::Format_info object, additional column meta-data by
-    cdk::Column_info object.
+    cdk::Column_info object. Columns must be added in position order.
   */
 
   template<cdk::Type_info T>
   void add(
     cdk::col_count_t pos,
     const cdk::Column_info &ci,
-    const cdk::Format_info &fi
+    const cdk::Format_info &fi,
+    Session_impl *sess
   )
   {
-    m_cols.emplace(pos, Column_info(Format_descr<T>(fi)));
-    m_cols.at(pos).store_info(ci);
+    assert(pos == m_cols.size());
+    (void)pos;
+    m_cols.emplace_back(Format_descr<T>(fi));
+    m_cols.back().store_info(ci, sess);
+    m_types.push_back(T);
   }
 
   /*
@@ -452,11 +588,15 @@ private:
     cdk::col_count_t pos,
     const cdk::Column_info &ci,
     cdk::Type_info type,
-    const cdk::Format_info &fi
+    const cdk::Format_info &fi,
+    Session_impl *sess
   )
   {
-    m_cols.emplace(pos, Column_info(type, fi));
-    m_cols.at(pos).store_info(ci);
+    assert(pos == m_cols.size());
+    (void)pos;
+    m_cols.emplace_back(type, fi);
+    m_cols.back().store_info(ci, sess);
+    m_types.push_back(type);
   }
 
 };
@@ -469,13 +609,15 @@ using Shared_meta_data = std::shared_ptr<Meta_data>;
   cdk::Meta_data interface.
 
   This costructor calls appropriate add() methods to add Column_info
-  instances to the m_cols map.
+  instances to the m_cols array.
 */
 
 inline
-Meta_data::Meta_data(cdk::Meta_data &md)
+Meta_data::Meta_data(cdk::Meta_data &md, Session_impl *sess)
 {
   m_col_count = md.col_count();
+  m_cols.reserve(m_col_count);
+  m_types.reserve(m_col_count);
 
   for (col_count_t pos = 0; pos < m_col_count; ++pos)
   {
@@ -485,15 +627,15 @@ Meta_data::Meta_data(cdk::Meta_data &md)
 
     switch (ti)
     {
-    case cdk::TYPE_STRING:    add<cdk::TYPE_STRING>(pos, ci, fi);   break;
-    case cdk::TYPE_INTEGER:   add<cdk::TYPE_INTEGER>(pos, ci, fi);  break;
-    case cdk::TYPE_FLOAT:     add<cdk::TYPE_FLOAT>(pos, ci, fi);    break;
-    case cdk::TYPE_DOCUMENT:  add<cdk::TYPE_DOCUMENT>(pos, ci, fi); break;
-    case cdk::TYPE_DATETIME:  add<cdk::TYPE_DATETIME>(pos, ci, fi); break;
-    case cdk::TYPE_GEOMETRY:  add<cdk::TYPE_GEOMETRY>(pos, ci, fi); break;
-    case cdk::TYPE_XML:       add<cdk::TYPE_XML>(pos, ci, fi); break;
+    case cdk::TYPE_STRING:    add<cdk::TYPE_STRING>(pos, ci, fi, sess);   break;
+    case cdk::TYPE_INTEGER:   add<cdk::TYPE_INTEGER>(pos, ci, fi, sess);  break;
+    case cdk::TYPE_FLOAT:     add<cdk::TYPE_FLOAT>(pos, ci, fi, sess);    break;
+    case cdk::TYPE_DOCUMENT:  add<cdk::TYPE_DOCUMENT>(pos, ci, fi, sess); break;
+    case cdk::TYPE_DATETIME:  add<cdk::TYPE_DATETIME>(pos, ci, fi, sess); break;
+    case cdk::TYPE_GEOMETRY:  add<cdk::TYPE_GEOMETRY>(pos, ci, fi, sess); break;
+    case cdk::TYPE_XML:       add<cdk::TYPE_XML>(pos, ci, fi, sess); break;
     default:
-      add_raw(pos, ci, ti, fi);
+      add_raw(pos, ci, ti, fi, sess);
       break;
     }
   }
@@ -507,38 +649,404 @@ Meta_data::Meta_data(cdk::Meta_data &md)
 
 
 /*
-  Convenience wrapper around std container that is used
-  to store incoming raw bytes sequence.
-
-  TODO: More efficient implementation.
+  Data structure used to hold raw row data. Raw bytes of all non-null
+  fields of a row are stored back-to-back in a single contiguous block,
+  with a per-field index of column position, offset and length. Fields
+  must be added in increasing column order, which is how they arrive
+  from the protocol.
+
+  The index has inline capacity for typical column counts, so a row
+  requires a single allocation (the data block) unless it is very wide.
+  Previously each field was kept in its own buffer inside a
+  std::map<col_count_t, Buffer>, which cost several allocations per row
+  on the fetch path.
+
+  Alternatively, a row can be a view into a refcounted slab holding the
+  raw payload it was decoded from (see set_slab()). In that mode the
+  fields are (offset, length) entries into the shared slab and no data
+  is copied into the row at all - the slab, which is the protocol's
+  receive buffer, is kept alive by the rows referring to it.
 */
 
-class Buffer
+class Row_data
 {
-  std::vector<byte> m_impl;
+public:
+
+  /*
+    Reference to raw data of a single field, as returned by at(). It
+    remains valid as long as the Row_data instance it came from.
+  */
+
+  class Field_ref
+  {
+    cdk::bytes m_data;
+
+    Field_ref(cdk::bytes data) : m_data(data)
+    {}
+
+    friend Row_data;
+
+  public:
+
+    size_t size() const { return m_data.size(); }
+    cdk::bytes data() const { return m_data; }
+  };
+
+private:
+
+  struct Field
+  {
+    col_count_t pos;
+    size_t      off;
+    size_t      len;
+  };
+
+  // Number of fields stored without allocating the overflow index.
+
+  static const size_t INLINE_FIELDS = 16;
+
+  std::vector<byte, Tracking_allocator<byte>> m_buf;  // raw data of all fields
+  Field m_fields[INLINE_FIELDS];
+  std::vector<Field, Tracking_allocator<Field>> m_more;  // index overflow
+  size_t             m_count = 0;
+
+  // When set, field offsets refer into the slab instead of m_buf.
+
+  cdk::shared_bytes  m_slab;
+
+  const byte* data_begin() const
+  {
+    return m_slab ? m_slab.begin() : m_buf.data();
+  }
+
+  Field& field_at(size_t i)
+  {
+    return i < INLINE_FIELDS ? m_fields[i] : m_more[i - INLINE_FIELDS];
+  }
+
+  const Field& field_at(size_t i) const
+  {
+    return i < INLINE_FIELDS ? m_fields[i] : m_more[i - INLINE_FIELDS];
+  }
+
+  const Field* find_field(col_count_t pos) const
+  {
+    for (size_t i = 0; i < m_count; ++i)
+    {
+      const Field &f = field_at(i);
+      if (f.pos == pos)
+        return &f;
+      if (f.pos > pos)
+        break;
+    }
+    return nullptr;
+  }
 
 public:
 
+  /*
+    Switch the row to view mode: data appended to its fields must be
+    slices of the given slab and is stored as offsets into it, without
+    copying. Must be called on an empty row.
+  */
+
+  void set_slab(const cdk::shared_bytes &slab)
+  {
+    assert(0 == m_count && m_buf.empty());
+    m_slab = slab;
+  }
+
+  // Start a new field at given column position (must increase with each call).
+
+  void start_field(col_count_t pos)
+  {
+    assert(0 == m_count || field_at(m_count - 1).pos < pos);
+
+    Field f = { pos, m_buf.size(), 0 };
+    if (m_count < INLINE_FIELDS)
+      m_fields[m_count] = f;
+    else
+      m_more.push_back(f);
+    m_count++;
+  }
+
+  // Append raw bytes to the last started field.
+
   void append(cdk::bytes data)
   {
-    m_impl.insert(m_impl.end(), data.begin(), data.end());
+    assert(0 < m_count);
+
+    Field &f = field_at(m_count - 1);
+
+    if (m_slab)
+    {
+      /*
+        View mode: record where the data lies within the slab. Chunks of
+        one field are consecutive slices of the payload, so only the
+        first one sets the offset.
+      */
+
+      assert(m_slab.contains(data));
+
+      size_t off = (size_t)(data.begin() - m_slab.begin());
+
+      if (0 == f.len)
+        f.off = off;
+      assert(f.off + f.len == off);
+
+      f.len += data.size();
+      return;
+    }
+
+    m_buf.insert(m_buf.end(), data.begin(), data.end());
+    f.len += data.size();
   }
 
-  size_t size() const { return m_impl.size(); }
+  void clear()
+  {
+    m_buf.clear();
+    m_more.clear();
+    m_count = 0;
+    m_slab.reset();
+  }
 
-  cdk::bytes data() const
+  /*
+    Pre-allocate the raw data buffer for `bytes` bytes of field data, so
+    that fields of an owned row append without growth reallocation (has
+    no effect on rows in view mode, which store no data of their own).
+  */
+
+  void reserve(size_t bytes)
+  {
+    m_buf.reserve(bytes);
+  }
+
+  /*
+    Prefetch the raw data of the given columns into cache, ahead of the
+    lazy per-column conversion that is about to read them (see
+    Result_impl::m_access_pattern). A no-op for columns not present in
+    the row and on compilers without a prefetch intrinsic.
+  */
+
+  void prefetch_fields(const col_count_t *cols, size_t count) const
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    for (size_t i = 0; i < count; ++i)
+    {
+      const Field *f = find_field(cols[i]);
+      if (f)
+        __builtin_prefetch(data_begin() + f->off);
+    }
+#else
+    (void)cols; (void)count;
+#endif
+  }
+
+  // Number of (non-null) fields present in the row.
+
+  size_t size() const { return m_count; }
+
+  // Note: a column without a field in the row holds a null value.
+
+  bool has_field(col_count_t pos) const
+  {
+    return nullptr != find_field(pos);
+  }
+
+  cdk::bytes field(col_count_t pos) const
+  {
+    const Field *f = find_field(pos);
+    assert(f);
+    return cdk::bytes((byte*)data_begin() + f->off, f->len);
+  }
+
+  // Size in bytes of the raw field data stored in the row.
+
+  size_t data_size() const
+  {
+    if (!m_slab)
+      return m_buf.size();
+
+    size_t total = 0;
+    for (size_t i = 0; i < m_count; ++i)
+      total += field_at(i).len;
+    return total;
+  }
+
+  /*
+    Serialize the row into a flat, self-contained record appended to
+    `out` and re-create a row from such a record. The record keeps the
+    field data in its wire format; it is used by the result spill (see
+    Result_impl) to park overflow rows on disk.
+  */
+
+  void save(std::vector<byte> &out) const
+  {
+    auto put = [&out](const void *data, size_t len)
+    {
+      out.insert(out.end(), (const byte*)data, (const byte*)data + len);
+    };
+
+    uint32_t cnt = (uint32_t)m_count;
+    put(&cnt, sizeof(cnt));
+
+    for (size_t i = 0; i < m_count; ++i)
+    {
+      const Field &f = field_at(i);
+      uint32_t pos = (uint32_t)f.pos;
+      uint64_t len = f.len;
+      put(&pos, sizeof(pos));
+      put(&len, sizeof(len));
+    }
+
+    /*
+      Field data is written field by field: in view mode the fields are
+      slices of the slab with protocol framing in between, while owned
+      rows keep them back-to-back in m_buf. Either way the record holds
+      the plain concatenation.
+    */
+
+    for (size_t i = 0; i < m_count; ++i)
+    {
+      const Field &f = field_at(i);
+      put(data_begin() + f.off, f.len);
+    }
+  }
+
+  // Returns false if the record is malformed.
+
+  bool load(const byte *rec, size_t size)
+  {
+    clear();
+
+    uint32_t cnt;
+    if (size < sizeof(cnt))
+      return false;
+    memcpy(&cnt, rec, sizeof(cnt));
+    rec += sizeof(cnt);
+    size -= sizeof(cnt);
+
+    size_t hdr_len = (size_t)cnt * (sizeof(uint32_t) + sizeof(uint64_t));
+    if (size < hdr_len)
+      return false;
+
+    const byte *data = rec + hdr_len;
+    size_t data_len = size - hdr_len;
+
+    for (uint32_t i = 0; i < cnt; ++i)
+    {
+      uint32_t pos;
+      uint64_t len;
+      memcpy(&pos, rec, sizeof(pos));
+      rec += sizeof(pos);
+      memcpy(&len, rec, sizeof(len));
+      rec += sizeof(len);
+
+      if (data_len < len)
+        return false;
+
+      start_field(pos);
+      append(cdk::bytes((byte*)data, (size_t)len));
+      data += len;
+      data_len -= (size_t)len;
+    }
+
+    return true;
+  }
+
+  /*
+    Map-style accessor kept for compatibility with code written against
+    the previous std::map based layout.
+    @throws std::out_of_range if the field is not present.
+  */
+
+  Field_ref at(col_count_t pos) const
   {
-    return cdk::bytes((byte*)m_impl.data(), m_impl.size());
+    const Field *f = find_field(pos);
+    if (!f)
+      throw std::out_of_range("row field");
+    return Field_ref(cdk::bytes((byte*)data_begin() + f->off, f->len));
   }
 };
 
 
 /*
-  Data structure used to hold raw row data. It holds a Buffer with
-  raw bytes for each non-null field of a row.
+  Decoded data of a single column for a batch of rows, as produced by
+  Result_impl::fetch_columns(). Depending on the column type, values are
+  decoded into one of the typed vectors (one entry per row, null rows
+  holding 0), or kept as raw bytes in an offset-based arena. Nulls are
+  reported through the per-row null flags.
 */
 
-typedef std::map<col_count_t, Buffer> Row_data;
+struct Column_batch
+{
+  enum class Kind { SINT, UINT, DOUBLE, BYTES };
+
+  Kind kind = Kind::BYTES;
+
+  std::vector<bool>     nulls;
+
+  // Values of SINT/UINT/DOUBLE columns.
+
+  std::vector<int64_t>  sints;
+  std::vector<uint64_t> uints;
+  std::vector<double>   doubles;
+
+  /*
+    Data of BYTES columns: bytes of row i are
+    arena[offsets[i]...offsets[i+1]) (offsets has one entry more than
+    there are rows).
+  */
+
+  std::vector<byte>     arena;
+  std::vector<size_t>   offsets;
+};
+
+
+/*
+  Decoded data of a single column in Arrow-compatible layout, as produced
+  by Result_impl::fetch_arrow(). The buffers follow the Arrow columnar
+  format: an LSB bit-order validity bitmap plus either a fixed-size value
+  buffer (numeric types) or 64-bit offsets into a data buffer (the
+  Large Utf8/Binary layouts). Together with the column name and type
+  derived from result meta-data they describe an Arrow array that
+  consumers can reference without copying.
+*/
+
+struct Arrow_column
+{
+  enum class Type { INT64, UINT64, FLOAT64, LARGE_UTF8, LARGE_BINARY };
+
+  std::string  name;
+  Type         type = Type::LARGE_BINARY;
+
+  row_count_t  length = 0;
+  row_count_t  null_count = 0;
+
+  /*
+    Validity bitmap: bit (i % 8) of byte (i / 8) is set when the value
+    of row i is not null. Padded with zero bits to a whole number of
+    bytes.
+  */
+
+  std::vector<byte>     validity;
+
+  // Value buffer of INT64/UINT64/FLOAT64 columns (null rows hold 0).
+
+  std::vector<int64_t>  ints;
+  std::vector<uint64_t> uints;
+  std::vector<double>   doubles;
+
+  /*
+    Buffers of LARGE_UTF8/LARGE_BINARY columns: bytes of row i are
+    data[offsets[i]...offsets[i+1]) (offsets has length + 1 entries,
+    null rows have zero-length ranges). String data is UTF-8 without
+    a terminating null byte.
+  */
+
+  std::vector<int64_t>  offsets;
+  std::vector<byte>     data;
+};
 
 
 /*
@@ -552,8 +1060,10 @@ typedef std::map<col_count_t, Buffer> Row_data;
 
   This template is parametrized by VAL class, such as commmon::Value used
   to convert and store result data. Converted values are stored as instances
-  of VAL class in m_vals map and method get() returns references to these
-  instances.
+  of VAL class in the flat m_vals array with one slot per column, and
+  method get() returns references to these instances. Flags in m_has_val
+  tell which slots hold a converted value, so the common case of get() is
+  an index plus a branch, with conversion done on the first access only.
 
   Note: VAL class must define static method template used for converting raw
   bytes into values:
@@ -576,14 +1086,36 @@ public:
 
   Row_impl(const Row_data &data, const Shared_meta_data &md)
     : m_data(data), m_mdata(md)
-  {}
+  {
+    if (md)
+      resize_vals(md->col_count());
+  }
+
+  Row_impl(Row_data &&data, const Shared_meta_data &md)
+    : m_data(std::move(data)), m_mdata(md)
+  {
+    if (md)
+      resize_vals(md->col_count());
+  }
 
 protected:
 
   Row_data          m_data;
   Shared_meta_data  m_mdata;
-  std::map<col_count_t, Value>    m_vals;
-  col_count_t                     m_col_count = 0;
+  std::vector<Value>  m_vals;
+  std::vector<bool>   m_has_val;
+  col_count_t         m_col_count = 0;
+
+  // Grow value storage so that it covers (at least) count columns.
+
+  void resize_vals(col_count_t count)
+  {
+    if (m_vals.size() < count)
+    {
+      m_vals.resize(count);
+      m_has_val.resize(count, false);
+    }
+  }
 
 public:
 
@@ -591,9 +1123,26 @@ public:
   {
     m_data.clear();
     m_vals.clear();
+    m_has_val.clear();
     m_mdata.reset();
   }
 
+  /*
+    Re-initialize the row with new data, recycling the internal buffers
+    of the previous contents. Consecutive rows of a result usually have
+    identical field sizes, so re-seeding an existing instance avoids the
+    per-row allocations that constructing a fresh one would repeat.
+  */
+
+  void reset(const Row_data &data, const Shared_meta_data &md)
+  {
+    m_data = data;
+    m_mdata = md;
+    m_has_val.assign(m_has_val.size(), false);
+    if (md)
+      resize_vals(md->col_count());
+  }
+
   col_count_t col_count() const
   {
     return m_mdata ? m_mdata->col_count() : m_col_count;
@@ -604,10 +1153,26 @@ public:
     if (m_mdata && pos >= m_mdata->col_count())
       throw std::out_of_range("row column");
 
-    auto data = m_data.find(pos);
-
     // Note: no data at given pos means null value.
-    return data != m_data.end() ? data->second.data() : bytes{};
+    return m_data.has_field(pos) ? m_data.field(pos) : bytes{};
+  }
+
+  /*
+    Return position of the column with the given label (see
+    Meta_data::col_index()).
+    @throws std::out_of_range if the row has no meta-data or no column
+    with the given label exists.
+  */
+
+  col_count_t col_index(const std::string &name) const
+  {
+    if (!m_mdata)
+      throw std::out_of_range("no meta-data found");
+
+    col_count_t pos = m_mdata->col_index(name);
+    if (pos >= m_mdata->col_count())
+      throw std::out_of_range("unknown column " + name);
+    return pos;
   }
 
   /*
@@ -620,22 +1185,31 @@ public:
     if (m_mdata && pos >= m_mdata->col_count())
       throw std::out_of_range("row column");
 
-    auto val = m_vals.find(pos);
-
-    if (val != m_vals.end())
-      return val->second;
+    if (pos < m_has_val.size() && m_has_val[pos])
+      return m_vals[pos];
 
     if (!m_mdata)
       throw std::out_of_range("no meta-data found");
 
     const Format_info &fi = m_mdata->get_format(pos);
     convert_at(pos, fi);
-    return m_vals.at(pos);
+    return m_vals[pos];
   }
 
   void set(col_count_t pos, const Value &val)
   {
-    m_vals.emplace(pos, val);
+    resize_vals(pos + 1);
+    m_vals[pos] = val;
+    m_has_val[pos] = true;
+    if (pos >= m_col_count)
+      m_col_count = pos + 1;
+  }
+
+  void set(col_count_t pos, Value &&val)
+  {
+    resize_vals(pos + 1);
+    m_vals[pos] = std::move(val);
+    m_has_val[pos] = true;
     if (pos >= m_col_count)
       m_col_count = pos + 1;
   }
@@ -644,36 +1218,35 @@ private:
 
   void convert_at(col_count_t pos, const Format_info &fi)
   {
-    Buffer *raw = nullptr;
+    resize_vals(pos + 1);
 
-    auto data = m_data.find(pos);
+    bytes raw =
+      m_data.has_field(pos) ? m_data.field(pos) : bytes{};
 
-    if (data != m_data.end())
-      raw = &(data->second);
-
-    if (!raw || 0 == raw->size())
+    if (0 < raw.size())
     {
-      // Null value
-      m_vals.emplace(pos, Value());
-      return;
-    }
+      CDK_PROBE2(row_convert, pos, fi.m_type);
 
-    /*
-      Call static function VAL::Access:mk() to construct VAL instance from
-      raw bytes and put it into m_vals map. Aprropriate encoding format
-      information is extracted from fi.
-    */
+      /*
+        Call static function VAL::Access:mk() to construct VAL instance
+        from raw bytes and store it in the slot for given column.
+        Aprropriate encoding format information is extracted from fi.
+
+        Note: a slot which was never converted holds a default (null)
+        value, which is the correct result for a null field.
+      */
 
 #define CONVERT(T) case cdk::TYPE_##T: \
-    m_vals.emplace(pos, \
-      VAL::Access::mk(raw->data(), fi.get<cdk::TYPE_##T>()) \
-    ); \
+    m_vals[pos] = VAL::Access::mk(raw, fi.get<cdk::TYPE_##T>()); \
     break;
 
-    switch (fi.m_type)
-    {
-      CDK_TYPE_LIST(CONVERT)
+      switch (fi.m_type)
+      {
+        CDK_TYPE_LIST(CONVERT)
+      }
     }
+
+    m_has_val[pos] = true;
   }
 
 };
@@ -725,14 +1298,18 @@ Value Value::Access::mk(cdk::bytes data, impl::common::Format_descr<T> &format)
   Value val{ convert(data, format) };
 
   /*
-    Store raw representation in m_str if possible (for RAW value this is
-    already done by the constructor).
+    Store raw representation in the string storage if possible (for RAW
+    value this is already done by the constructor). USTRING values keep
+    the decoded utf16 string there instead - their raw representation is
+    not preserved (it was of use only for empty strings, whose raw form
+    is empty as well).
   */
 
   switch (val.get_type())
   {
   case Value::RAW:
   case Value::STRING:
+  case Value::USTRING:
   case Value::VNULL:
     break;
 
@@ -741,7 +1318,7 @@ Value Value::Access::mk(cdk::bytes data, impl::common::Format_descr<T> &format)
       Note: Trailing '\0' byte is used for NULL value detection and is not
       part of the data
     */
-    val.m_str.assign(data.begin(), data.end() - 1);
+    val.str_storage().assign(data.begin(), data.end() - 1);
     break;
   }
 
@@ -779,6 +1356,8 @@ namespace common {
 
 using impl::common::Shared_meta_data;
 using impl::common::Row_data;
+using impl::common::Column_batch;
+using impl::common::Arrow_column;
 using impl::common::Column_info;
 
 /*
@@ -805,12 +1384,111 @@ public:
 
   virtual cdk::Reply*      get_reply() = 0;
 
+  /*
+    Id of the server-side prepared statement used to execute the command,
+    0 if the command was not executed through a prepared statement. It
+    allows the result object to re-use result meta-data cached for this
+    statement (see Result_impl::push_row_cache()).
+  */
+
+  virtual uint32_t prepared_stmt_id() { return 0; }
+
+  /*
+    Tells whether the command asked the server to omit textual column
+    meta-data from the reply (possible only when complete meta-data for
+    the prepared statement is cached, see Op_base::send_prepared_command()).
+  */
+
+  virtual bool compact_metadata() { return false; }
+
   /*
     A hook that can perform additional initialization of the result object
     being constructed from a Result_init instance.
   */
 
   virtual void init_result(Result_impl&) {} // GCOV_EXCL_LINE
+
+  /*
+    Returns true if the statement type guarantees that the reply contains
+    no result set (plain DML such as collection add/remove or table
+    insert/update). Such a reply can be represented by the lightweight
+    Result_ack instead of a full Result_impl.
+  */
+
+  virtual bool no_data() { return false; }
+};
+
+
+/*
+  Lightweight result implementation used for statements which are known
+  to produce no result set (see Result_init::no_data()).
+
+  A plain DML acknowledgment only carries statement statistics (affected
+  rows, auto-increment value, generated document ids) and diagnostics,
+  all of which live in the cdk reply object. The row cache and meta-data
+  machinery of Result_impl is dead weight for such replies, so this
+  class keeps just the reply and serves the statistics directly from it.
+*/
+
+class Result_ack
+{
+public:
+
+  Result_ack(Result_init &init)
+    : m_sess(init.get_session()), m_reply(init.get_reply())
+  {}
+
+  cdk::row_count_t get_affected_rows() const
+  {
+    if (!m_reply)
+      THROW("Attempt to get affected rows count on empty result");
+    return m_reply->affected_rows();
+  }
+
+  cdk::row_count_t get_auto_increment() const
+  {
+    if (!m_reply)
+      THROW("Attempt to get auto increment value on empty result");
+    return m_reply->last_insert_id();
+  }
+
+  const std::vector<std::string>& get_generated_ids() const
+  {
+    if (!m_reply)
+      THROW("Attempt to get generated ids for empty result");
+    return m_reply->generated_ids();
+  }
+
+  cdk::mysqlx::Reply_timings get_timings() const
+  {
+    if (!m_reply)
+      return cdk::mysqlx::Reply_timings();
+    return m_reply->get_timings();
+  }
+
+  unsigned get_warning_count() const
+  {
+    if (!m_reply)
+      return 0;
+    m_reply->wait();
+    return m_reply->entry_count(cdk::api::Severity::WARNING);
+  }
+
+  cdk::Diagnostic_iterator& get_entries(
+    cdk::api::Severity::value level = cdk::api::Severity::ERROR
+  ) const
+  {
+    assert(m_reply);
+    return m_reply->get_entries(level);
+  }
+
+private:
+
+  // Keeps the session implementation alive, as in Result_impl.
+
+  Shared_session_impl  m_sess;
+
+  std::unique_ptr<cdk::Reply>  m_reply;
 };
 
 
@@ -833,6 +1511,16 @@ public:
 
   Result_impl(Result_init &init);
 
+  /*
+    Create a result which replays a result set stored in a spool file
+    (see spool()). Rows are paged in from the file on demand through the
+    row spill machinery and flow through the normal decode paths. A
+    replayed result is not backed by a session or server reply, so it
+    carries no diagnostics or statement statistics.
+  */
+
+  explicit Result_impl(const std::string &spool_path);
+
   virtual ~Result_impl();
 
   /*
@@ -874,10 +1562,69 @@ public:
 
   const Row_data *get_row();
 
+  /*
+    Tell, without blocking, whether get_row() can complete without waiting
+    on the connection. An in-flight fetch-ahead operation is given a
+    chance to proceed and one is started when the cache is empty while
+    rows are still pending. Returns true when a row is buffered (or
+    spilled to disk), or when the current result-set is known to be
+    exhausted - in the latter case get_row() reports end of data right
+    away.
+  */
+
+  bool poll_row();
+
+  /*
+    Fetch up to `count` rows into the caller-provided array in a single
+    pass over the row cache. Row data is moved out of the cache, not
+    copied. Returns the number of rows stored - less than `count` means
+    the current result-set is exhausted.
+  */
+
+  row_count_t get_rows(Row_data *rows, row_count_t count);
+
   // Store all remaining rows in the internal cache.
 
   void store();
 
+  /*
+    Decode all remaining rows of the current result set column-wise into
+    typed column vectors (@see Column_batch), one pass per column over
+    the cached raw data. The decoded rows are consumed. Returns the
+    number of decoded rows.
+
+    If `threads` is greater than 1, columns are decoded in parallel by
+    that many worker threads (capped at the column count). Columns are
+    independent of each other, so the output is identical to the
+    single-threaded decode; this pays off on wide rows with expensive
+    column types. The default keeps the decode on the calling thread.
+  */
+
+  row_count_t fetch_columns(std::vector<Column_batch>&, unsigned threads = 0);
+
+  /*
+    As fetch_columns(), but decode into Arrow-compatible column buffers
+    (@see Arrow_column). The column name and Arrow type are derived from
+    result meta-data, so the output describes a complete Arrow record
+    batch that can be handed over without further conversion.
+  */
+
+  row_count_t fetch_arrow(std::vector<Arrow_column>&, unsigned threads = 0);
+
+  /*
+    Write the remaining rows of the current result set, together with
+    its meta-data, to a spool file at the given path. Rows are stored as
+    length-prefixed records in their wire format (see Row_data::save()),
+    so spooling does not decode any values. The spooled rows are
+    consumed. Returns the number of rows written.
+
+    The file can later be replayed without a server using the replay
+    constructor, feeding the stored rows back through the regular row
+    and columnar fetch paths.
+  */
+
+  row_count_t spool(const std::string &path);
+
   // Store all results to cache
 
   void store_all_results();
@@ -892,9 +1639,34 @@ public:
   row_count_t count();
 
   /*
-    Discard the reply. TODO: Implement it when needed.
+    Drop everything that remains of the server reply without buffering
+    it: cached rows are recycled and result sets still on the wire are
+    discarded frame by frame as they arrive. Unlike store_all_results()
+    (which keeps the remainder readable, at the cost of buffering it
+    whole), finishing with a reply this way costs no memory however big
+    its tail is. After the call the reply is fully consumed and the
+    session is free for the next command.
   */
-  //void discard();
+
+  void discard();
+
+  /*
+    Announce the expected size of the result: (roughly) `rows` rows
+    holding `bytes` bytes of raw data in total. The server sends no row
+    count ahead, but callers often know one (a LIMIT clause, a fixed
+    batch size, table statistics) - with the announcement the row data
+    buffers and the columnar decode arenas are pre-allocated in one shot
+    instead of being grown through repeated doubling while the rows
+    arrive. This is only an allocation hint: a wrong estimate costs
+    memory or reallocation, never correctness. Must be called before the
+    rows are read to have any effect.
+  */
+
+  void reserve(row_count_t rows, size_t bytes)
+  {
+    m_reserve_rows = rows;
+    m_reserve_bytes = bytes;
+  }
 
   /*
     Methods to access result information
@@ -905,6 +1677,13 @@ public:
   cdk::row_count_t get_auto_increment() const;
   unsigned get_warning_count() const;
 
+  /*
+    Reply phase timestamps (@see cdk::mysqlx::Reply_timings). Default
+    (all zero) when there is no reply.
+  */
+
+  cdk::mysqlx::Reply_timings get_timings() const;
+
   /*
     Client-side filtering of row data. Function m_row_filter is applied
     for each received row to determine if it should be skipped.
@@ -913,6 +1692,34 @@ public:
   using Row_filter_t = std::function<bool(const Row_data&)>;
   Row_filter_t m_row_filter = [](const Row_data&) { return true; };
 
+  /*
+    Client-side streaming of raw column data. When a sink is installed
+    for a column, chunks of that column's data are passed to it as they
+    arrive from the protocol instead of being buffered inside the cached
+    row - the corresponding field of cached rows is left absent (null).
+    The value returned by the sink is the number of bytes it is ready to
+    accept next; it propagates to the protocol reader as its read
+    window, so a slow consumer throttles reading and returning 0
+    discards the rest of the field. Sinks must be installed before rows
+    of the result are read.
+  */
+
+  using Field_sink_t = std::function<size_t(bytes)>;
+  std::map<col_count_t, Field_sink_t> m_field_sinks;
+
+  /*
+    Planned column access pattern. When the application declares which
+    columns it is going to read, and in what order, the columnar decode
+    paths process the declared columns first (the remaining ones are
+    still decoded, after them) and every row handed out by get_row()
+    prefetches the raw data of the declared fields, so that the lazy
+    per-column conversion that follows hits warm cache lines instead of
+    faulting them in on first access. Empty means no plan. Must be set
+    before rows are fetched to have any effect.
+  */
+
+  std::vector<col_count_t> m_access_pattern;
+
   // Get generated document id information.
 
   const std::vector<std::string>& get_generated_ids() const;
@@ -932,6 +1739,15 @@ public:
     return m_result_mdata.front()->get_column(pos);
   }
 
+  // Position of the column with the given label (see Meta_data::col_index()).
+
+  col_count_t get_col_index(const std::string &name) const
+  {
+    if (m_result_mdata.empty() || !m_result_mdata.front())
+      THROW("No result set");
+    return m_result_mdata.front()->col_index(name);
+  }
+
 protected:
 
   Result_impl(const Result_impl&) = delete;
@@ -960,6 +1776,23 @@ protected:
 
   std::queue<Shared_meta_data>  m_result_mdata;
 
+  /*
+    Id of the server-side prepared statement which produced this result,
+    0 if the command was not executed through a prepared statement. Used
+    by push_row_cache() to re-use result meta-data cached for this
+    statement in the session.
+  */
+
+  uint32_t m_pstmt_id = 0;
+
+  // Set when the server was asked to omit textual column meta-data.
+
+  bool m_compact_mdata = false;
+
+  // Number of result-sets read so far from the server reply.
+
+  unsigned m_rset_count = 0;
+
   /*
     Method fetch_meta_data() creates a new Meta_data_base instance with
     the information taken from a CDK cursor object (or any other object
@@ -985,7 +1818,7 @@ protected:
     order of deleting them (see dtor).
   */
 
-  cdk::Reply  *m_reply;
+  cdk::Reply  *m_reply = nullptr;
   cdk::Cursor *m_cursor = nullptr;
 
   using Row_cache = std::forward_list<Row_data>;
@@ -996,6 +1829,179 @@ protected:
   std::queue<row_count_t> m_result_cache_size;
   Row_cache::iterator m_cache_it;
 
+  /*
+    Spill-to-disk for stored results. When the rows buffered for the
+    result-set currently being filled exceed SPILL_THRESHOLD bytes
+    (which happens when a big result is stored whole, for example
+    because another command was executed on the session), further rows
+    are appended to a temporary memory-mapped file in their wire format
+    instead of being kept in memory. Spilled rows are decoded back in
+    prefetch-sized windows when the in-memory part of the cache drains
+    (see spill_refill()), so worst-case memory use is bounded by the
+    window while result consumption stays transparent. One spill object
+    per cached result-set, created lazily on first overflow; note that
+    once a row of a result-set was spilled, all following rows of that
+    result-set are spilled too, which keeps the row order.
+  */
+
+  class Row_spill;
+
+  std::queue<std::shared_ptr<Row_spill>> m_row_spill;
+
+  /*
+    State of a result replayed from a spool file, prepared by the replay
+    constructor and installed as the current result-set when
+    read_next_result() is called (mimicking the arrival of a result-set
+    from the server). The rows stay in the file and are paged in through
+    the spill machinery.
+  */
+
+  Shared_meta_data            m_replay_mdata;
+  std::shared_ptr<Row_spill>  m_replay_spill;
+  row_count_t                 m_replay_rows = 0;
+
+  /*
+    Prefetch window configured for the session. Results replayed from a
+    spool file have no session and use a fixed window for paging rows in
+    from the file.
+  */
+
+  row_count_t prefetch_window() const;
+
+  // Bytes of row data buffered in memory for the result-set being filled.
+
+  size_t m_back_cache_bytes = 0;
+
+  static const size_t SPILL_THRESHOLD = 64 * 1024 * 1024;
+
+  /*
+    Cumulative size and count of the rows of the result-set being filled,
+    used to estimate the average row size when sizing prefetch windows
+    against the session's result buffer budget (see apply_buffer_limit()).
+  */
+
+  size_t      m_rset_bytes = 0;
+  row_count_t m_rset_rows = 0;
+
+  // Expected result size announced through reserve(), 0 when none was.
+
+  row_count_t m_reserve_rows = 0;
+  size_t      m_reserve_bytes = 0;
+
+  /*
+    Per-column share of the announced data size, used to pre-allocate
+    the arenas of the columnar decode paths. Returns 0 when no
+    announcement was made (or no meta-data is available yet).
+  */
+
+  size_t column_reserve_hint() const
+  {
+    if (0 == m_reserve_bytes
+        || m_result_mdata.empty() || !m_result_mdata.front())
+      return 0;
+    col_count_t cols = m_result_mdata.front()->col_count();
+    return m_reserve_bytes / (cols ? cols : 1);
+  }
+
+  /*
+    Clamp a prefetch window so that the fetched rows are not expected to
+    grow the in-memory cache beyond the MAX_RESULT_BUFFER session option.
+    Never returns 0 for a non-zero window - the budget throttles fetching,
+    it does not truncate results.
+  */
+
+  row_count_t apply_buffer_limit(row_count_t window) const;
+
+  /*
+    Threshold at which rows of a stored result start going to the spill
+    file: SPILL_THRESHOLD, or the session's result buffer budget if that
+    is smaller.
+  */
+
+  size_t spill_threshold() const
+  {
+    size_t limit = m_sess->max_result_buffer();
+    return limit && limit < SPILL_THRESHOLD ? limit : SPILL_THRESHOLD;
+  }
+
+  /*
+    Append a row to the spill file of the result-set being filled,
+    creating the file if needed. Returns false if spilling is not
+    possible (the row then stays in memory).
+  */
+
+  bool spill_append(const Row_data&);
+
+  /*
+    Move spilled rows of the current result-set back into the in-memory
+    cache, up to `limit` rows (0 = all of them). Returns true if some
+    rows were loaded.
+  */
+
+  bool spill_refill(row_count_t limit);
+
+  // Tells if the current result-set has unread rows spilled to disk.
+
+  bool has_spilled_rows() const;
+
+  /*
+    Decode one column of the cached rows into `batch` (the per-column
+    work item of fetch_columns()). `raw_vals` is caller-provided scratch
+    storage so that its allocation can be re-used across columns;
+    `data_reserve` is the initial arena allocation derived from the
+    reserve() announcement (see column_reserve_hint()), 0 for none.
+  */
+
+  static void decode_column(
+    col_count_t pos, const Row_cache &rows, row_count_t row_num,
+    const Format_info &fi, Column_batch &batch,
+    std::vector<cdk::bytes> &raw_vals, size_t data_reserve
+  );
+
+  /*
+    Overload decoding one column into the Arrow layout (the per-column
+    work item of fetch_arrow()). Takes full column meta-data since the
+    column name becomes part of the Arrow schema.
+  */
+
+  static void decode_column(
+    col_count_t pos, const Row_cache &rows, row_count_t row_num,
+    const Column_info &ci, Arrow_column &col,
+    std::vector<cdk::bytes> &raw_vals, size_t data_reserve
+  );
+
+  /*
+    Shared driver of the columnar fetch paths: brings all remaining rows
+    of the current result set into the cache and decodes them column by
+    column into `out`, dispatching to the decode_column() overload that
+    matches the output column type. `threads` as in fetch_columns().
+  */
+
+  template <class COL>
+  row_count_t do_fetch_columnar(std::vector<COL> &out, unsigned threads);
+
+  /*
+    Fetch-ahead state. When rows are consumed one by one, the next batch
+    is requested from the cursor before the cache drains and the read
+    operation is progressed in the background while already cached rows
+    are served (see start_fetch()/finish_fetch()). The flag tells that
+    such a background read is in flight; while it is set no other cursor
+    interaction may happen.
+  */
+
+  bool m_fetch_active = false;
+
+  // Start reading next batch of rows without waiting for completion.
+
+  void start_fetch(row_count_t prefetch_size);
+
+  /*
+    Progress an active background fetch. If wait is true, block until it
+    completes; otherwise only give it a chance to proceed.
+  */
+
+  void finish_fetch(bool wait);
+
   /*
     Ensure some rows are loaded into the cache. If cache is not empty, it
     returns true right away. Otherwise it loads rows into the cache. If
@@ -1036,11 +2042,18 @@ protected:
         m_cache_it.
       */
 
+      // Return storage of any unconsumed rows to the pool.
+
+      for (Row_data &row : m_result_cache.front())
+        recycle(std::move(row));
+
       m_cache_it = m_result_cache.back().end();
       m_result_cache.pop();
     }
     if (!m_result_cache_size.empty())
       m_result_cache_size.pop();
+    if (!m_row_spill.empty())
+      m_row_spill.pop();
   }
 
   // Called on each resultset to be read.
@@ -1086,14 +2099,83 @@ private:
 
   // Row_processor
 
+  /*
+    Note: m_row holds the row most recently handed out by get_row() while
+    m_parse_row is the scratch object that incoming rows are decoded into
+    before being moved to the cache. Keeping them separate ensures that a
+    fetch-ahead operation progressing in the background does not clobber
+    the row the caller is still looking at.
+  */
+
   Row_data    m_row;
+  Row_data    m_parse_row;
+
+  // Sink receiving data of the field being parsed, if one is installed.
+
+  Field_sink_t *m_cur_sink = nullptr;
+
+  /*
+    Pool of spare Row_data objects whose internal buffers keep their
+    capacity. Rows are moved in and out of the cache, so without
+    recycling every received row allocates a fresh data block and every
+    consumed one frees it - on multi-million row results this
+    malloc/free churn dominates result consumption. Consumed and
+    discarded rows return their storage here, row_begin() re-uses it;
+    the pool is bounded and released as a whole when the result is
+    destroyed.
+  */
+
+  std::vector<Row_data, cdk::foundation::Tracking_allocator<Row_data>>
+    m_row_pool;
+
+  static const size_t ROW_POOL_MAX = 256;
+
+  void recycle(Row_data &&row)
+  {
+    if (m_row_pool.size() < ROW_POOL_MAX)
+    {
+      // Keeps buffer capacities, but drops any slab reference so that
+      // pooled rows do not pin receive buffers.
+      row.clear();
+      m_row_pool.emplace_back(std::move(row));
+    }
+  }
 
   bool row_begin(row_count_t) override
   {
-    m_row.clear();
+    if (!m_row_pool.empty())
+    {
+      m_parse_row = std::move(m_row_pool.back());
+      m_row_pool.pop_back();
+    }
+    m_parse_row.clear();
+
+    /*
+      Pre-size the row's data buffer to the average row size derived
+      from the reserve() announcement, so that an owned row is filled
+      without growth reallocation. Rows taken from the pool above
+      already keep the capacity of their previous use.
+    */
+
+    if (0 < m_reserve_rows && 0 < m_reserve_bytes)
+      m_parse_row.reserve(m_reserve_bytes / m_reserve_rows);
+
     return true;
   }
 
+  /*
+    The column data of this row will be passed as views into the given
+    slab - store it as such instead of copying it into the row (see
+    Row_data::set_slab()). The slab, shared with the protocol's receive
+    buffer, stays alive for as long as rows referring to it sit in the
+    cache.
+  */
+
+  void row_slab(const cdk::shared_bytes &slab) override
+  {
+    m_parse_row.set_slab(slab);
+  }
+
   void row_end(row_count_t) override;
 
   size_t field_begin(col_count_t pos, size_t) override;
@@ -1129,6 +2211,14 @@ cdk::row_count_t Result_impl::get_auto_increment() const
   return m_reply->last_insert_id();
 }
 
+inline
+cdk::mysqlx::Reply_timings Result_impl::get_timings() const
+{
+  if (!m_reply)
+    return cdk::mysqlx::Reply_timings();
+  return m_reply->get_timings();
+}
+
 inline
 unsigned Result_impl::get_warning_count() const
 {
@@ -1148,7 +2238,8 @@ const std::vector<std::string>& Result_impl::get_generated_ids() const
 inline
 bool Result_impl::has_data() const
 {
-  return (!m_result_cache.empty() && !m_result_cache.front().empty()) || m_pending_rows;
+  return (!m_result_cache.empty() && !m_result_cache.front().empty())
+         || has_spilled_rows() || m_pending_rows;
 }
 
 
@@ -1177,7 +2268,11 @@ inline
 row_count_t Result_impl::count()
 {
   store();
-  if (entry_count() > 0)
+
+  // Note: a result replayed from a spool file has no reply object
+  // (and can not carry any diagnostics).
+
+  if (m_reply && entry_count() > 0)
     get_error().rethrow();
   row_count_t rc = 0;
   if(!m_result_cache_size.empty())
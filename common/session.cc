@@ -34,9 +34,11 @@
 #include <mysqlx/common.h>
 
 PUSH_SYS_WARNINGS
+#include <algorithm>
 #include <chrono>
 #include <ratio>
 #include <thread>
+#include <vector>
 POP_SYS_WARNINGS
 
 #include "settings.h"
@@ -49,6 +51,10 @@ POP_SYS_WARNINGS
 #include <sys/utsname.h>
 #endif
 
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
 using namespace ::mysqlx::impl::common;
 using TCPIP_options = cdk::ds::TCPIP::Options;
 using TLS_options = TCPIP_options::TLS_options;
@@ -57,7 +63,8 @@ using lock_guard = std::lock_guard<std::recursive_mutex>;
 
 void Settings_impl::clear()
 {
-  m_data = Data();
+  m_data = std::make_shared<Data>();
+  m_cached_source.reset();
 }
 
 
@@ -364,11 +371,16 @@ void prepare_options(
       switch (opt_val.first)
       {
       case Option::TLS_VERSIONS:
-        try {
-        tls_opt.add_version(opt_val.second.get_string());
-      }  catch (const cdk::Error&) {
-          //unexpected TLS versions are not errors. Only if no valid tls version
-          //is available, an error will be thrown below.
+        {
+          /*
+            Unexpected TLS versions are not errors and are probed with
+            the non-throwing parse. Only if no valid tls version is
+            available, an error will be thrown below.
+          */
+
+          TLS_options::TLS_version ver(0, 0);
+          if (TLS_options::TLS_version::parse(opt_val.second.get_string(), ver))
+            tls_opt.add_version(ver);
         }
         break;
       case Option::TLS_CIPHERSUITES:
@@ -447,6 +459,24 @@ void prepare_options(
     }
   }
 
+  if (settings.has_option(Option::COMPRESSION_LEVEL))
+  {
+    opts.set_compression_level(
+      (int)settings.get(Option::COMPRESSION_LEVEL).get_sint());
+  }
+
+  if (settings.has_option(Option::COMPRESSION_LONG_MATCHING))
+  {
+    opts.set_compression_long_matching(
+      settings.get(Option::COMPRESSION_LONG_MATCHING).get_bool());
+  }
+
+  if (settings.has_option(Option::COMPRESSION_WINDOW_LOG))
+  {
+    opts.set_compression_window_log(
+      (int)settings.get(Option::COMPRESSION_WINDOW_LOG).get_uint());
+  }
+
   // DNS+SRV
 
   if(settings.has_option(Option::DNS_SRV))
@@ -463,13 +493,25 @@ void prepare_options(
 
 void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
 {
+  /*
+    Hand out the data source built on an earlier call if the settings
+    have not changed since. DNS+SRV configurations are excluded: for
+    them every call performs a fresh lookup (see below).
+  */
+
+  if (m_cached_source)
+  {
+    src = *m_cached_source;
+    return;
+  }
+
   cdk::ds::TCPIP::Options opts;
 
   /*
     A single-host connection over Unix domain socket is considered secure.
     Otherwise SSL connection will be configured by default.
   */
-  bool socket = m_data.m_sock && (1 == m_data.m_host_cnt);
+  bool socket = m_data->m_sock && (1 == m_data->m_host_cnt);
 
   prepare_options(*this, socket, opts);
 
@@ -485,7 +527,7 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
       Note: option consistency checks are done by Setter
     */
 
-    assert(1 == m_data.m_host_cnt);
+    assert(1 == m_data->m_host_cnt);
 
     cdk::ds::DNS_SRV_source dns_srv_src(
       get(Session_option_impl::HOST).get_string(), opts
@@ -507,7 +549,7 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
   */
 
   // if priorities were not set explicitly, assign decreasing starting from 100
-  int prio = m_data.m_user_priorities ? -1 : 100;
+  int prio = m_data->m_user_priorities ? -1 : 100;
 
   /*
     Look for a priority after host/socket setting. If explicit priorities
@@ -518,7 +560,7 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
 
   auto check_prio = [this](iterator &it, int &prio) {
 
-    if (m_data.m_user_priorities)
+    if (m_data->m_user_priorities)
     {
       if (it == end() || Session_option_impl::PRIORITY != it->first)
         throw_error("No priority specified for host ...");
@@ -555,7 +597,7 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
 
     if (Session_option_impl::PORT == it->first)
     {
-      assert(0 == m_data.m_host_cnt);
+      assert(0 == m_data->m_host_cnt);
     }
     else
     {
@@ -643,7 +685,7 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
       so the case above should cover that HOST/PORT pair.
     */
     case Session_option_impl::PORT:
-      assert(0 == m_data.m_host_cnt);
+      assert(0 == m_data->m_host_cnt);
       add_host(it, default_prio);
       break;
 
@@ -657,12 +699,15 @@ void Settings_impl::get_data_source(cdk::ds::Multi_source &src)
     throw_error("No sources to connect");
   }
 
+  // Keep the built source for the next call (see above).
+
+  m_cached_source = std::make_shared<cdk::ds::Multi_source>(src);
 }
 
 
 void Settings_impl::get_attributes(cdk::ds::Attr_processor &prc)
 {
-  for(auto &el : m_data.m_connection_attr)
+  for(auto &el : m_data->m_connection_attr)
   {
     prc.attr(el.first, el.second);
   }
@@ -680,6 +725,121 @@ void Session_impl::prepare_for_cmd()
   }
 
   m_current_result = nullptr;
+  m_stmt_count++;
+
+  // Apply pending shrink requests and publish the cache footprint.
+
+  governor_checkpoint();
+}
+
+
+void Session_impl::restore_state(const Session_impl &other)
+{
+  if (other.m_state_log_off)
+    throw_error("Session state can not be restored: replay log overflowed");
+
+  prepare_for_cmd();
+
+  /*
+    Replies are collected in m_trx_pipeline so that server errors
+    surface at the next transaction boundary, like for pipelined
+    transaction commands.
+  */
+
+  if (!other.m_default_db.empty() && other.m_default_db != m_default_db)
+  {
+    std::string use_db = "USE `" + std::string(other.m_default_db) + "`";
+    m_trx_pipeline.emplace_back(
+      new cdk::Reply(m_sess->sql(0, use_db, nullptr))
+    );
+    m_default_db = other.m_default_db;
+  }
+
+  for (auto &stmt : other.m_state_log)
+  {
+    m_trx_pipeline.emplace_back(
+      new cdk::Reply(m_sess->sql(0, stmt, nullptr))
+    );
+  }
+
+  /*
+    The restored session carries the log forward, so that it can itself
+    be restored from later.
+  */
+
+  m_state_log = other.m_state_log;
+}
+
+
+bool Session_impl::reconnect()
+{
+  if (!m_auto_reconnect)
+    return false;
+
+  /*
+    Inside an explicit transaction the server-side transaction state
+    lost with the connection can not be re-created by replay - the
+    application must handle the error.
+  */
+
+  if (m_in_trx)
+    return false;
+
+  // A partial replay would silently restore partial session state.
+
+  if (m_state_log_off)
+    return false;
+
+  /*
+    A registered result still references the dead connection and can not
+    be cached from it - give up rather than corrupt it.
+  */
+
+  if (m_current_result)
+    return false;
+
+  /*
+    Replies pipelined on the dead connection are gone. They are dropped
+    without being examined, like when a dead session is released.
+  */
+
+  m_trx_batch = false;
+  m_trx_pipeline.clear();
+  m_submit_batch = false;
+  m_submit_pending = 0;
+
+  if (!m_sess.reconnect(this))
+    return false;
+
+  m_io_timed_out = false;
+
+  /*
+    Replay the recorded session state onto the fresh connection. As in
+    restore_state(), the statements are sent without waiting for their
+    replies, so that reconnect and replay travel in the same network
+    round-trip as the retried statement.
+  */
+
+  cdk::string fresh_db;
+  if (m_sess->get_default_schema())
+    fresh_db = *m_sess->get_default_schema();
+
+  if (!m_default_db.empty() && m_default_db != fresh_db)
+  {
+    std::string use_db = "USE `" + std::string(m_default_db) + "`";
+    m_trx_pipeline.emplace_back(
+      new cdk::Reply(m_sess->sql(0, use_db, nullptr))
+    );
+  }
+
+  for (auto &stmt : m_state_log)
+  {
+    m_trx_pipeline.emplace_back(
+      new cdk::Reply(m_sess->sql(0, stmt, nullptr))
+    );
+  }
+
+  return true;
 }
 
 
@@ -695,9 +855,9 @@ void Session_impl::release()
 
 
 Pooled_session::Pooled_session(
-  Session_pool_shared &pool, Session_cleanup *cleanup
+  Session_pool_shared &pool, Session_cleanup *cleanup, size_t affinity
 )
-  : m_sess_pool(pool), m_cleanup(cleanup)
+  : m_sess_pool(pool), m_cleanup(cleanup), m_affinity(affinity)
 {
   m_deadline = system_clock::now() + m_sess_pool->m_timeout;
   cont();
@@ -706,7 +866,41 @@ Pooled_session::Pooled_session(
 
 Pooled_session::Pooled_session(cdk::ds::Multi_source &ds)
 {
-  reset(new cdk::Session(ds));
+  // Keep a copy of the data source, so that reconnect() can re-establish
+  // the connection of this stand-alone session.
+
+  m_ds = std::make_shared<cdk::ds::Multi_source>(ds);
+  reset(new cdk::Session(*m_ds));
+}
+
+
+bool Pooled_session::reconnect(Session_cleanup *cleanup)
+{
+  std::shared_ptr<cdk::Session> fresh;
+
+  try {
+
+    if (m_sess_pool)
+    {
+      m_sess_pool->discard_session(*this);
+      fresh = m_sess_pool->get_session(cleanup, m_affinity);
+    }
+    else if (m_ds)
+    {
+      fresh.reset(new cdk::Session(*m_ds));
+    }
+  }
+  catch (...)
+  {
+    // Could not re-connect - the original error is reported instead.
+    return false;
+  }
+
+  if (!fresh || cdk::option_t::YES != fresh->is_valid())
+    return false;
+
+  std::shared_ptr<cdk::Session>::operator=(std::move(fresh));
+  return true;
 }
 
 
@@ -720,7 +914,12 @@ void Pooled_session::release()
   if (*this)
   {
     if (m_sess_pool)
-      m_sess_pool->release_session(*this);
+    {
+      // Prefer the thread-cached slot, falling back to the regular path.
+
+      if (!m_sess_pool->park_session(m_sess_pool, *this))
+        m_sess_pool->release_session(*this, m_affinity);
+    }
     else
       (*this)->close();
   }
@@ -745,7 +944,7 @@ bool Pooled_session::do_cont()
 
   // If session pool disabled, create session
   std::shared_ptr<cdk::Session>::operator=(
-    m_sess_pool->get_session(m_cleanup)
+    m_sess_pool->get_session(m_cleanup, m_affinity)
   );
 
   if (get())
@@ -769,10 +968,20 @@ void Pooled_session::do_wait()
     //waiting untill someone releases a session
     std::unique_lock<std::mutex> lock(m_sess_pool->m_reelase_mutex);
 
+    time_point start = system_clock::now();
+
     //prevent changing m_pool_closed before getting release condition signal
-    if (!m_sess_pool->m_pool_closed &&
-        m_sess_pool->m_release_cond.wait_until(lock, m_deadline)
-        == std::cv_status::timeout)
+    bool timeout =
+      !m_sess_pool->m_pool_closed &&
+      m_sess_pool->m_release_cond.wait_until(lock, m_deadline)
+      == std::cv_status::timeout;
+
+    m_sess_pool->m_stat_wait_usec += (uint64_t)
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        system_clock::now() - start
+      ).count();
+
+    if (timeout)
     {
       throw_error("Timeout reached when getting session from pool");
     }
@@ -810,6 +1019,11 @@ catch (...)
 
 void Session_pool::close()
 {
+  stop_maintenance();
+
+  // Drop cached idle references so that pool entries become unique.
+  clear_idle_shards();
+
   lock_guard guard(m_pool_mutex);
   //First, close all sessions
   for(auto &el : m_pool)
@@ -822,6 +1036,7 @@ void Session_pool::close()
     } catch(...)
     {}
   }
+  stat_session_removed(m_pool.size());
   m_pool.clear();
 
   //prevent changing m_pool_closed before getting release condition signal
@@ -834,108 +1049,730 @@ void Session_pool::close()
 }
 
 
-void Session_pool::release_session(cdk::shared_ptr<cdk::Session> &sess)
+void Session_pool::resize(size_t max)
+{
+  if (0 == max)
+    throw_error("Invalid pool size");
+
+  {
+    lock_guard guard(m_pool_mutex);
+
+    if (m_pool_closed)
+      throw_error("Pool was closed!");
+
+    m_max = max;
+
+    if (m_min > m_max)
+      m_min = m_max;
+  }
+
+  /*
+    When shrinking, evict surplus idle sessions right away. They are
+    taken off the shard lists first (pop_idle_session()), so active
+    checkouts proceed in parallel and the pool mutex is held only for the
+    book-keeping. The evicted sessions are closed in one batch below,
+    outside of any lock.
+  */
+
+  std::vector<std::shared_ptr<cdk::Session>> evicted;
+
+  for (;;)
+  {
+    {
+      lock_guard guard(m_pool_mutex);
+      if (m_pool.size() <= m_max)
+        break;
+    }
+
+    std::shared_ptr<cdk::Session> sess = pop_idle_session();
+
+    if (!sess)
+      break;
+
+    {
+      lock_guard guard(m_pool_mutex);
+      if (m_pool.erase(sess))
+        stat_session_removed();
+    }
+
+    evicted.push_back(sess);
+  }
+
+  for (auto &sess : evicted)
+  {
+    try {
+      sess->close();
+    }
+    catch (...)
+    {}
+  }
+
+  // Growing the pool may unblock checkouts waiting for a free session.
+
+  m_release_cond.notify_all();
+}
+
+
+void Session_pool::drain()
+{
+  {
+    lock_guard guard(m_pool_mutex);
+    m_draining = true;
+  }
+
+  // Wake up waiting checkouts so that they see the drained state.
+
+  m_release_cond.notify_all();
+}
+
+
+void Session_pool::resume()
+{
+  lock_guard guard(m_pool_mutex);
+  m_draining = false;
+}
+
+
+void Session_pool::discard_session(std::shared_ptr<cdk::Session> &sess)
+{
+  if (m_pool_closed)
+    return;
+
+  lock_guard guard(m_pool_mutex);
+
+  auto el = m_pool.find(sess);
+
+  if (el == m_pool.end())
+    return;
+
+  host_release(sess->id());
+  m_pool.erase(el);
+  stat_session_removed();
+}
+
+
+void Session_pool::release_session(
+  cdk::shared_ptr<cdk::Session> &sess, size_t affinity
+)
 {
   // Pool closed... nothing to do here!
   if (m_pool_closed)
     return;
+
+  // Extra reference which puts the released session on a shard list.
+  std::shared_ptr<cdk::Session> idle = sess;
+  std::shared_ptr<cdk::Session> surplus;
+  time_point deadline = system_clock::now() + m_time_to_live;
+
   {
     lock_guard guard(m_pool_mutex);
 
     auto el = m_pool.find(sess);
 
+    // The session is no longer checked out to its host.
+
     if (el != m_pool.end())
+      host_release(idle->id());
+
+    if (el != m_pool.end() && m_pool.size() > m_max)
     {
-      el->second.m_deadline = system_clock::now() + m_time_to_live;
+      /*
+        The pool was shrunk while this session was in use - drop the
+        session instead of caching it. It is closed below, outside of the
+        pool mutex.
+      */
+
+      m_pool.erase(el);
+      stat_session_removed();
+      el = m_pool.end();
+      surplus = idle;
+      idle.reset();
+    }
+    else if (el != m_pool.end())
+    {
+      el->second.m_deadline = deadline;
 
       // Note: we assume that session returned to the pool is no longer
       // in use and does not need a cleanup handler.
       el->second.m_cleanup = nullptr;
     }
+    else
+    {
+      // Unknown session - do not cache it for re-use.
+      idle.reset();
+    }
 
     try {
       //Reset session so that internal is unique!
       sess.reset();
     }
     catch (...) {
+      idle.reset();
       try {
         //remove session, since we got error
-        m_pool.erase(el);
+        if (el != m_pool.end())
+        {
+          m_pool.erase(el);
+          stat_session_removed();
+        }
       } catch (...)
       {}
     }
+  }
+
+  if (surplus)
+  {
+    try {
+      surplus->close();
+    }
+    catch (...)
+    {}
+  }
+
+  if (idle)
+  {
+    /*
+      Send the session reset right away, without waiting for its
+      confirmation: the server processes it while the session sits idle,
+      so the next user of the session finds it already clean and pays no
+      reset latency on checkout. If the pipelined reset can not be used,
+      the reset is left to checkout time.
+    */
+
+    try {
+      idle->reset_async();
+    }
+    catch (...)
+    {
+      // Broken session - do not cache it for re-use.
 
-    time_to_live_cleanup();
+      lock_guard guard(m_pool_mutex);
+      m_pool.erase(idle);
+      stat_session_removed();
+      idle.reset();
+    }
   }
 
+  if (idle)
+    push_idle_session(idle, deadline, affinity);
+
+  /*
+    Expired sessions are reaped by the maintenance thread (see
+    reap_expired_sessions()) - make sure it is running. Note that
+    start_maintenance() does nothing if the thread was already started.
+  */
+
+  start_maintenance();
+
   //inform a session was released
   m_release_cond.notify_one();
 }
 
 
-std::shared_ptr<cdk::Session>
-Session_pool::try_session(
-  std::shared_ptr<cdk::Session> &sess, Session_cleanup* cleanup
-)
+Session_pool::Thread_slot::~Thread_slot()
 {
-  // sess should be in the pool
-  assert(1 == m_pool.count(sess));
-
-  try
-  {
-    sess->reset();
-    if (!sess->is_valid())
-      throw;
-    m_pool[sess].m_cleanup = cleanup;
-    return sess;
-  }
-  catch (...)
+  if (m_pool && m_sess)
   {
-    // On any error add end-point to block list and remove from pool
-    m_block_list.add(sess->id());
-    m_pool.erase(sess);
+    try {
+      m_pool->release_session(m_sess);
+    }
+    catch (...)
+    {}
   }
+}
 
-  sess.reset(); // reset to be sure it is empty
-  return {};
+
+Session_pool::Thread_slot& Session_pool::thread_slot()
+{
+  static thread_local Thread_slot slot;
+  return slot;
 }
 
 
-std::shared_ptr<cdk::Session>
-Session_pool::get_pooled_session(
-  bool filter_block_listed, std::default_random_engine &r_e,
-  Session_cleanup* cleanup
+bool Session_pool::park_session(
+  Session_pool_shared &self, std::shared_ptr<cdk::Session> &sess
 )
 {
-  std::vector<std::shared_ptr<cdk::Session>> avail_sessions;
+  assert(self.get() == this);
 
-  // Find all available non-blocklisted sessions
+  if (!m_pool_enable || m_pool_closed || m_draining)
+    return false;
 
-  for (auto &sess : m_pool)
+  Thread_slot &slot = thread_slot();
+
+  if (slot.m_sess)
   {
-    long use_count = sess.first.use_count();
-    if (use_count == 1 &&
-      (!filter_block_listed ||
-        !m_block_list.is_block_listed(sess.first->id()))
-      )
-      avail_sessions.push_back(sess.first);
-  }
+    // This thread already parked a session of this pool - do not evict it.
 
-  // Return if no sessions available
+    if (slot.m_pool.get() == this)
+      return false;
 
-  if (avail_sessions.empty())
-    return {};
+    /*
+      The thread moved to a different pool - return the parked session to
+      its pool before taking over the slot.
+    */
 
-  // Randomly pick an available session that is good.
+    try {
+      slot.m_pool->release_session(slot.m_sess);
+    }
+    catch (...)
+    {}
+    slot.m_sess.reset();
+    slot.m_pool.reset();
+  }
 
-  do
-  {
-    size_t num = avail_sessions.size();
-    if (!num)
+  /*
+    Reset the parked session right away, like release_session() does for
+    sessions returned to the idle shards, so that the next same-thread
+    checkout finds it clean and pays no reset latency. If the pipelined
+    reset can not be used the session goes back to the pool as usual.
+  */
+
+  try {
+    if (!sess->reset_async())
+      return false;
+  }
+  catch (...)
+  {
+    return false;
+  }
+
+  {
+    lock_guard guard(m_pool_mutex);
+
+    auto el = m_pool.find(sess);
+
+    // Unknown session (evicted meanwhile) - do not cache it.
+
+    if (el == m_pool.end())
+      return false;
+
+    /*
+      The session is no longer in use, so it does not need a cleanup
+      handler. Its deadline stays at time_point::max() and it remains
+      checked out to its host: from the pool's point of view a parked
+      session looks exactly like one in use, so it is never handed out
+      twice nor reaped, and pool close() closes it like any other.
+    */
+
+    el->second.m_cleanup = nullptr;
+  }
+
+  slot.m_pool = self;
+  slot.m_sess = sess;
+  sess.reset();
+  return true;
+}
+
+
+std::shared_ptr<cdk::Session>
+Session_pool::take_thread_session(Session_cleanup *cleanup)
+{
+  Thread_slot &slot = thread_slot();
+
+  if (slot.m_pool.get() != this || !slot.m_sess)
+    return {};
+
+  std::shared_ptr<cdk::Session> sess = std::move(slot.m_sess);
+  slot.m_sess.reset();
+  slot.m_pool.reset();
+
+  lock_guard guard(m_pool_mutex);
+
+  auto el = m_pool.find(sess);
+
+  /*
+    The session could have been closed while parked (pool close or
+    resize) or the connection could have died - fall back to the regular
+    checkout path in that case.
+  */
+
+  if (el == m_pool.end())
+    return {};
+
+  if (cdk::option_t::YES != sess->is_valid())
+  {
+    m_pool.erase(el);
+    stat_session_removed();
+    return {};
+  }
+
+  el->second.m_cleanup = cleanup;
+  el->second.m_deadline = time_point::max();
+  ++m_stat_checkouts;
+  ++m_stat_hits;
+  return sess;
+}
+
+
+/*
+  NUMA node of the calling thread, queried from the system. On platforms
+  where the node can not be determined this returns UNKNOWN_NODE and the
+  node preference in pop_idle_session() is skipped. The query is a cheap
+  system call made only on the pool checkout/release paths.
+*/
+
+unsigned Session_pool::numa_node()
+{
+#ifdef __linux__
+  unsigned node;
+  if (0 == syscall(SYS_getcpu, nullptr, &node, nullptr))
+    return node;
+#endif
+  return UNKNOWN_NODE;
+}
+
+
+std::shared_ptr<cdk::Session> Session_pool::pop_idle_session(size_t affinity)
+{
+  const size_t start = shard_idx();
+
+  /*
+    Affinity pass: when the checkout carries a statement-shape hint,
+    take a session which was last used for the same shape - its prepared
+    statement and metadata caches are already warm for the caller. The
+    server-side cache hit is worth more than NUMA placement or host
+    striping, so this pass ignores both; when no affine session is idle
+    the regular passes below apply as if there was no hint.
+  */
+
+  if (affinity)
+  {
+    for (size_t i = 0; i < POOL_SHARDS; ++i)
+    {
+      Idle_shard &shard = m_idle_shards[(start + i) % POOL_SHARDS];
+
+      std::lock_guard<std::mutex> guard(shard.m_mutex);
+
+      for (auto it = shard.m_sessions.rbegin();
+           it != shard.m_sessions.rend(); ++it)
+      {
+        if (it->m_deadline < system_clock::now())
+          continue;
+
+        if (it->m_affinity != affinity)
+          continue;
+
+        auto sess = it->m_sess;
+        shard.m_sessions.erase(std::next(it).base());
+        --m_stat_idle;
+        ++m_stat_affinity;
+        return sess;
+      }
+    }
+  }
+
+  /*
+    Stripe checkouts across the hosts of the multi source: if some host
+    has fewer outstanding sessions than the others, prefer an idle
+    session to that host over the most recently used one. The preferred
+    host is a snapshot maintained under the pool mutex, read here
+    without taking it.
+  */
+
+  const size_t preferred = m_preferred_host.load();
+
+  /*
+    First pass over the shards: take only a session which was released
+    by a thread on the caller's NUMA node, so that the session's buffers
+    and caches keep being accessed from the memory node they were
+    allocated on (a remote session is still better than a new connection,
+    so the second pass takes any). This pass only scans - expired entries
+    are dropped by the second pass as before.
+  */
+
+  const unsigned node = numa_node();
+
+  if (UNKNOWN_NODE != node)
+  {
+    for (size_t i = 0; i < POOL_SHARDS; ++i)
+    {
+      Idle_shard &shard = m_idle_shards[(start + i) % POOL_SHARDS];
+
+      std::lock_guard<std::mutex> guard(shard.m_mutex);
+
+      for (auto it = shard.m_sessions.rbegin();
+           it != shard.m_sessions.rend(); ++it)
+      {
+        if (it->m_deadline < system_clock::now())
+          continue;
+
+        if (it->m_node != node)
+          continue;
+
+        if (preferred && it->m_sess->id() != preferred)
+          continue;
+
+        auto sess = it->m_sess;
+        shard.m_sessions.erase(std::next(it).base());
+        --m_stat_idle;
+        return sess;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < POOL_SHARDS; ++i)
+  {
+    Idle_shard &shard = m_idle_shards[(start + i) % POOL_SHARDS];
+
+    std::lock_guard<std::mutex> guard(shard.m_mutex);
+
+    if (preferred)
+    {
+      for (auto it = shard.m_sessions.rbegin();
+           it != shard.m_sessions.rend(); ++it)
+      {
+        if (it->m_deadline < system_clock::now())
+          continue;   // expired entries are handled below
+
+        if (it->m_sess->id() != preferred)
+          continue;
+
+        auto sess = it->m_sess;
+        shard.m_sessions.erase(std::next(it).base());
+        --m_stat_idle;
+        return sess;
+      }
+    }
+
+    while (!shard.m_sessions.empty())
+    {
+      auto entry = shard.m_sessions.back();
+      shard.m_sessions.pop_back();
+      --m_stat_idle;
+
+      /*
+        Expired entries are only dropped here - once the shard reference
+        is gone the pool entry is unique and the global TTL cleanup will
+        remove it.
+      */
+
+      if (entry.m_deadline < system_clock::now())
+        continue;
+
+      return entry.m_sess;
+    }
+  }
+
+  return {};
+}
+
+
+void Session_pool::push_idle_session(
+  const std::shared_ptr<cdk::Session> &sess, time_point deadline,
+  size_t affinity
+)
+{
+  Idle_shard &shard = m_idle_shards[shard_idx()];
+
+  std::lock_guard<std::mutex> guard(shard.m_mutex);
+  shard.m_sessions.push_back({ sess, deadline, numa_node(), affinity });
+  ++m_stat_idle;
+}
+
+
+void Session_pool::clear_idle_shards()
+{
+  for (Idle_shard &shard : m_idle_shards)
+  {
+    std::lock_guard<std::mutex> guard(shard.m_mutex);
+    m_stat_idle -= shard.m_sessions.size();
+    shard.m_sessions.clear();
+  }
+}
+
+
+void Session_pool::start_maintenance()
+{
+  lock_guard guard(m_pool_mutex);
+
+  if (m_maint_thread.joinable() || m_pool_closed)
+    return;
+
+  m_maint_thread = std::thread([this]() { maintenance_loop(); });
+}
+
+
+void Session_pool::stop_maintenance()
+{
+  {
+    std::unique_lock<std::mutex> lock(m_maint_mutex);
+    m_maint_stop = true;
+  }
+
+  m_maint_cond.notify_all();
+
+  if (m_maint_thread.joinable())
+    m_maint_thread.join();
+}
+
+
+void Session_pool::maintenance_loop()
+{
+  std::unique_lock<std::mutex> lock(m_maint_mutex);
+
+  while (!m_maint_stop)
+  {
+    try {
+      reap_expired_sessions();
+      warm_up();
+    }
+    catch (...)
+    {
+      /*
+        Errors during maintenance are ignored - on-demand session
+        creation reports connection errors to the user (and maintenance
+        tries again on the next round).
+      */
+    }
+
+    m_maint_cond.wait_for(lock, std::chrono::seconds(1));
+  }
+}
+
+
+void Session_pool::warm_up()
+{
+  for (;;)
+  {
+    {
+      lock_guard guard(m_pool_mutex);
+
+      if (
+        m_pool_closed || m_draining || !m_pool_enable
+        || m_pool.size() >= m_min || m_pool.size() >= m_max
+      )
+        return;
+    }
+
+    // Note: the connect happens without holding the pool mutex.
+
+    std::shared_ptr<cdk::Session> sess(new cdk::Session(m_ds));
+    time_point deadline = system_clock::now() + m_time_to_live;
+
+    {
+      lock_guard guard(m_pool_mutex);
+
+      if (m_pool_closed || m_pool.size() >= m_max)
+        return;
+
+      m_pool.emplace(sess, Sess_data{ deadline, nullptr });
+      stat_session_added();
+    }
+
+    push_idle_session(sess, deadline);
+    m_release_cond.notify_one();
+  }
+}
+
+
+std::shared_ptr<cdk::Session>
+Session_pool::try_session(
+  std::shared_ptr<cdk::Session> &sess, Session_cleanup* cleanup
+)
+{
+  // sess should be in the pool
+  assert(1 == m_pool.count(sess));
+
+  /*
+    If the connection died while the session was idle, drop the session
+    but do not block-list the end-point - an idle timeout on the server
+    side does not mean the end-point is bad.
+  */
+
+  if (!sess->check_alive())
+  {
+    m_pool.erase(sess);
+    stat_session_removed();
+    sess.reset();
+    return {};
+  }
+
+  try
+  {
+    // See the fast path of get_session() for the reset strategy.
+
+    if (!sess->reset_async())
+    {
+      sess->reset();
+      if (!sess->is_valid())
+        throw_error("Invalid session");
+    }
+    m_pool[sess].m_cleanup = cleanup;
+    ++m_stat_checkouts;
+    ++m_stat_hits;
+    host_checkout(sess->id());
+    return sess;
+  }
+  catch (...)
+  {
+    // On any error add end-point to block list and remove from pool
+    m_block_list.add(sess->id());
+    m_pool.erase(sess);
+    stat_session_removed();
+  }
+
+  sess.reset(); // reset to be sure it is empty
+  return {};
+}
+
+
+std::shared_ptr<cdk::Session>
+Session_pool::get_pooled_session(
+  bool filter_block_listed, std::default_random_engine &r_e,
+  Session_cleanup* cleanup
+)
+{
+  std::vector<std::shared_ptr<cdk::Session>> avail_sessions;
+
+  // Find all available non-blocklisted sessions
+
+  for (auto &sess : m_pool)
+  {
+    long use_count = sess.first.use_count();
+    if (use_count == 1 &&
+      (!filter_block_listed ||
+        !m_block_list.is_block_listed(sess.first->id()))
+      )
+      avail_sessions.push_back(sess.first);
+  }
+
+  // Return if no sessions available
+
+  if (avail_sessions.empty())
+    return {};
+
+  /*
+    Pick an available session that is good, striping over the hosts of
+    the multi source: only sessions to the host(s) with the fewest
+    checked-out sessions are considered, choosing randomly among them.
+  */
+
+  do
+  {
+    size_t num = avail_sessions.size();
+    if (!num)
       return {};
 
-    std::uniform_int_distribution<size_t> uniform_dist(0, num - 1);
-    size_t rnum = uniform_dist(r_e);
+    size_t least = std::numeric_limits<size_t>::max();
+
+    for (auto &s : avail_sessions)
+    {
+      size_t active = host_active_count(s->id());
+      if (active < least)
+        least = active;
+    }
+
+    std::vector<size_t> candidates;
+
+    for (size_t pos = 0; pos < num; ++pos)
+    {
+      if (host_active_count(avail_sessions[pos]->id()) == least)
+        candidates.push_back(pos);
+    }
+
+    std::uniform_int_distribution<size_t> uniform_dist(0, candidates.size() - 1);
+    size_t rnum = candidates[uniform_dist(r_e)];
     auto it = avail_sessions.begin() + rnum;
 
     // If unsuccessful try_session() will remove invalid item from m_pool
@@ -953,21 +1790,145 @@ Session_pool::get_pooled_session(
 
 
 std::shared_ptr<cdk::Session>
-Session_pool::get_session(Session_cleanup *cleanup)
+Session_pool::get_session(Session_cleanup *cleanup, size_t affinity)
 {
-  lock_guard guard(m_pool_mutex);
+  /*
+    Optional tracing of the acquire path (see Span_tracer). The guard
+    ends the span whichever way this call returns; successful returns
+    report the end-point of the session handed out via done().
+  */
 
-  bool use_blocklist = true;
+  struct Acquire_span
+  {
+    Span_tracer *m_tracer;
+    Span_tracer::span_t m_span = 0;
+    Span_tracer::Span_attr m_attr;
+
+    Acquire_span(Span_tracer *tracer)
+      : m_tracer(tracer)
+    {
+      if (m_tracer)
+        m_span = m_tracer->span_start(Span_tracer::SPAN_POOL_ACQUIRE);
+      m_attr.ok = false;
+    }
+
+    void done(size_t endpoint)
+    {
+      m_attr.endpoint = endpoint;
+      m_attr.ok = true;
+    }
+
+    ~Acquire_span()
+    {
+      if (m_tracer)
+        m_tracer->span_end(Span_tracer::SPAN_POOL_ACQUIRE, m_span, m_attr);
+    }
+  }
+  span(m_tracer.get());
 
   if (!m_pool_enable)
   {
-    return std::shared_ptr<cdk::Session>(new cdk::Session(m_ds));
+    ++m_stat_created;
+    ++m_stat_checkouts;
+    std::shared_ptr<cdk::Session> sess(new cdk::Session(m_ds));
+    span.done(sess->id());
+    return sess;
+  }
+
+  if (m_pool_closed)
+    throw_error("Pool was closed!");
+
+  if (m_draining)
+    throw_error("Pool is drained");
+
+  /*
+    Fastest path: re-use the session this thread released last, if it is
+    still parked in the thread's slot (see park_session()). It was reset
+    when parked, so no per-checkout work is needed at all.
+  */
+
+  if (auto sess = take_thread_session(cleanup))
+  {
+    span.done(sess->id());
+    return sess;
   }
 
+  /*
+    Fast path: re-use an idle session from the shard cache. Validation
+    and reset are done without holding the global pool mutex, which is
+    then taken only briefly to update pool book-keeping.
+  */
+
+  while (std::shared_ptr<cdk::Session> sess = pop_idle_session(affinity))
+  {
+    /*
+      A connection which died while the session sat idle (server-side
+      timeout, network failure) is a normal occurrence - drop the session
+      without block-listing its end-point and try the next one. The check
+      is a local, non-blocking socket probe.
+    */
+
+    if (!sess->check_alive())
+    {
+      lock_guard guard(m_pool_mutex);
+      m_pool.erase(sess);
+      stat_session_removed();
+      continue;
+    }
+
+    try
+    {
+      /*
+        Prefer the pipelined reset whose confirmation overlaps with the
+        first statement executed on the re-used session, falling back to
+        the blocking reset round-trip when the server does not support
+        keeping the session open.
+      */
+
+      if (!sess->reset_async())
+      {
+        sess->reset();
+        if (!sess->is_valid())
+          throw_error("Invalid session");
+      }
+
+      lock_guard guard(m_pool_mutex);
+
+      auto el = m_pool.find(sess);
+
+      // The session could have been evicted meanwhile (pool closed).
+
+      if (el == m_pool.end())
+        continue;
+
+      el->second.m_cleanup = cleanup;
+      el->second.m_deadline = time_point::max();
+      ++m_stat_checkouts;
+      ++m_stat_hits;
+      host_checkout(sess->id());
+      span.done(sess->id());
+      return sess;
+    }
+    catch (...)
+    {
+      // On any error add end-point to block list and remove from pool.
+
+      lock_guard guard(m_pool_mutex);
+      m_block_list.add(sess->id());
+      m_pool.erase(sess);
+      stat_session_removed();
+    }
+  }
+
+  lock_guard guard(m_pool_mutex);
+
+  bool use_blocklist = true;
+
   if (m_pool_closed)
     throw_error("Pool was closed!");
 
-  time_to_live_cleanup();
+  if (m_draining)
+    throw_error("Pool is drained");
 
   std::random_device r_d;
   std::default_random_engine r_e(r_d());
@@ -977,7 +1938,10 @@ Session_pool::get_session(Session_cleanup *cleanup)
 
   auto sess = get_pooled_session(true, r_e, cleanup);
   if (sess.get())
+  {
+    span.done(sess->id());
     return sess;
+  }
 
   /*
     If this fails, and there is space in the pool, try creating a new session
@@ -1015,6 +1979,10 @@ Session_pool::get_session(Session_cleanup *cleanup)
         ),
         Sess_data{ time_point::max(), cleanup }
       );
+      stat_session_added();
+      ++m_stat_checkouts;
+      host_checkout(ret.first->first->id());
+      span.done(ret.first->first->id());
       return ret.first->first;
     }
     catch (...)
@@ -1031,7 +1999,10 @@ Session_pool::get_session(Session_cleanup *cleanup)
 
   auto blocklisted_sess = get_pooled_session(false, r_e, cleanup);
   if (blocklisted_sess.get())
+  {
+    span.done(blocklisted_sess->id());
     return blocklisted_sess;
+  }
 
   /*
     If a session is still not found, and there is space in the pool,
@@ -1063,6 +2034,10 @@ Session_pool::get_session(Session_cleanup *cleanup)
       cdk::shared_ptr<cdk::Session>(new cdk::Session(m_ds, block_list_filter)),
       Sess_data{ time_point::max(), cleanup }
     );
+    stat_session_added();
+    ++m_stat_checkouts;
+    host_checkout(ret.first->first->id());
+    span.done(ret.first->first->id());
     return ret.first->first;
   }
 
@@ -1070,25 +2045,71 @@ Session_pool::get_session(Session_cleanup *cleanup)
 }
 
 
-void Session_pool::time_to_live_cleanup()
+void Session_pool::reap_expired_sessions()
 {
-  lock_guard guard(m_pool_mutex);
-
   time_point current_time = system_clock::now();
 
-  auto it = m_pool.begin();
-  for(; it != m_pool.end(); )
+  /*
+    First drop expired entries from the idle shards. A shard holds a
+    reference to each idle session, so without this step the pool entries
+    below would never become unique and could not be reaped.
+  */
+
+  for (Idle_shard &shard : m_idle_shards)
   {
-    if (it->first.unique() && it->second.m_deadline < current_time)
+    std::lock_guard<std::mutex> guard(shard.m_mutex);
+    auto &sessions = shard.m_sessions;
+    size_t before = sessions.size();
+    sessions.erase(
+      std::remove_if(
+        sessions.begin(), sessions.end(),
+        [current_time](const Idle_entry &entry)
+        {
+          return entry.m_deadline < current_time;
+        }
+      ),
+      sessions.end()
+    );
+    m_stat_idle -= before - sessions.size();
+  }
+
+  std::vector<std::shared_ptr<cdk::Session>> expired;
+
+  {
+    lock_guard guard(m_pool_mutex);
+
+    auto it = m_pool.begin();
+    for(; it != m_pool.end(); )
     {
-      // Note: removed session is not active and does not need calling
-      // of the cleanup handler.
-      it = m_pool.erase(it);
+      if (it->first.unique() && it->second.m_deadline < current_time)
+      {
+        // Note: removed session is not active and does not need calling
+        // of the cleanup handler.
+        expired.push_back(it->first);
+        it = m_pool.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
     }
-    else
-    {
-      ++it;
+
+    stat_session_removed(expired.size());
+  }
+
+  /*
+    Close the collected sessions in one batch, outside of the pool mutex,
+    so that threads acquiring or releasing sessions never wait for the
+    teardown (TLS shutdown, socket close).
+  */
+
+  for (auto &sess : expired)
+  {
+    try {
+      sess->close();
     }
+    catch (...)
+    {}
   }
 }
 
@@ -1134,4 +2155,40 @@ void Session_pool::set_pool_opts(Settings_impl &opts)
   {
     throw_error("Invalid POOL_MAX_IDLE_TIME value");
   }
+
+
+  if (opts.has_option(Settings_impl::Client_option_impl::POOL_MIN_SIZE))
+  {
+    size_t min_size = 0;
+
+    try{
+      min_size =
+        static_cast<size_t>(
+          opts.get(Settings_impl::Client_option_impl::POOL_MIN_SIZE)
+          .get_uint());
+    }catch(...)
+    {
+      throw_error("Invalid POOL_MIN_SIZE value");
+    }
+
+    if (min_size > m_max)
+      throw_error("POOL_MIN_SIZE can not be greater than POOL_MAX_SIZE");
+
+    set_min_size(min_size);
+
+    if (m_pool_enable && min_size > 0)
+      start_maintenance();
+  }
+
+
+  if (opts.has_option(Settings_impl::Client_option_impl::MAX_CACHE_BYTES))
+  try{
+    set_cache_budget(
+          static_cast<size_t>(
+            opts.get(Settings_impl::Client_option_impl::MAX_CACHE_BYTES)
+            .get_uint()));
+  }catch(...)
+  {
+    throw_error("Invalid MAX_CACHE_BYTES value");
+  }
 }
@@ -40,9 +40,17 @@
 #include <mysql/cdk.h>
 
 PUSH_SYS_WARNINGS
+#include <atomic>
+#include <cctype>
 #include <chrono>
+#include <limits>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #include <condition_variable>
 POP_SYS_WARNINGS
 
@@ -86,6 +94,22 @@ class Pooled_session
   time_point m_deadline;
   Session_cleanup *m_cleanup = nullptr;
 
+  /*
+    Statement-shape affinity hint of this session, 0 if none (see
+    Session_pool::get_session()). Set from the first statement shape
+    executed on the session (see Session_impl::check_stmt_shape()).
+  */
+
+  size_t m_affinity = 0;
+
+  /*
+    Data source kept by stand-alone sessions, so that the connection can
+    be re-established (see reconnect()). Null for pooled sessions, which
+    reconnect through their pool.
+  */
+
+  std::shared_ptr<cdk::ds::Multi_source> m_ds;
+
 public:
 
   /*
@@ -93,12 +117,25 @@ public:
     called if the pool decides to close this session.
   */
 
-  Pooled_session(Session_pool_shared &pool, Session_cleanup *cleanup = nullptr);
+  Pooled_session(
+    Session_pool_shared &pool, Session_cleanup *cleanup = nullptr,
+    size_t affinity = 0
+  );
 
   Pooled_session(cdk::ds::Multi_source &ds);
 
   ~Pooled_session() override;
 
+  /*
+    Re-establish the underlying connection after the current one died
+    (see Session_impl::reconnect()). A pooled session gets a fresh
+    connection from its pool, after the dead one is dropped from the
+    pool book-keeping; a stand-alone session re-connects to its stored
+    data source. Returns false if no fresh connection could be made.
+  */
+
+  bool reconnect(Session_cleanup *cleanup = nullptr);
+
   bool is_completed() const override;
   bool do_cont() override;
   void do_wait() override;
@@ -107,6 +144,29 @@ public:
 
   void release();
 
+  /*
+    Set/query the statement-shape affinity hint. The hint is used to
+    route later checkouts of the same shape back to this session after
+    it is released (and to prefer an affine replacement on reconnect()).
+  */
+
+  void set_affinity(size_t hint)
+  {
+    m_affinity = hint;
+  }
+
+  size_t affinity() const
+  {
+    return m_affinity;
+  }
+
+  // Pool which manages this session (null for a stand-alone session).
+
+  const Session_pool_shared& get_pool() const
+  {
+    return m_sess_pool;
+  }
+
 private:
 
   friend class Session_pool;
@@ -114,6 +174,70 @@ private:
 };
 
 
+/*
+  Optional tracing of connector internals.
+
+  A Span_tracer receives start/end callbacks around instrumented
+  connector operations: statement execution (see Op_base::execute())
+  and obtaining a session from the pool (see
+  Session_pool::get_session()). The interface is deliberately minimal so
+  that it can be adapted to a tracing framework such as OpenTelemetry:
+  span_start() returns an opaque token which is passed back to the
+  matching span_end(), so an adapter can carry its own span handle
+  between the two calls. Callbacks can come from any thread which
+  executes statements.
+
+  No tracer is installed by default and instrumented paths check
+  a single pointer before collecting any attributes, so tracing costs
+  nothing unless enabled (see Session_pool::set_tracer() and
+  Session_impl::set_tracer()).
+*/
+
+class Span_tracer
+{
+public:
+
+  // Kinds of spans emitted by the connector.
+
+  enum Span_kind
+  {
+    SPAN_STATEMENT,     // statement execution: command sent, reply complete
+    SPAN_POOL_ACQUIRE,  // obtaining a session from the pool
+  };
+
+  // Opaque token correlating a span_end() with its span_start().
+
+  using span_t = uint64_t;
+
+  /*
+    Attributes reported when a span ends. Not every attribute applies to
+    every span kind - those that do not keep their zero defaults.
+  */
+
+  struct Span_attr
+  {
+    uint64_t shape_hash = 0;  // statement shape hash, 0 for shapeless ones
+    size_t   endpoint = 0;    // id of the server end-point used
+    uint64_t rows = 0;        // affected rows, when the reply reports them
+    bool     ok = true;       // whether the operation succeeded
+  };
+
+  virtual span_t span_start(Span_kind kind) = 0;
+  virtual void   span_end(Span_kind kind, span_t span, const Span_attr&) = 0;
+
+  virtual ~Span_tracer() {}
+};
+
+
+// Defined in result.h
+
+struct Meta_data;
+
+// Defined in stored_expr.h
+
+class Stored_expr;
+
+
 }  // common
 }  // impl
 
@@ -126,6 +250,7 @@ using impl::common::time_point;
 using impl::common::system_clock;
 using impl::common::Pooled_session;
 using impl::common::Session_cleanup;
+using impl::common::Span_tracer;
 
 
 /*
@@ -156,6 +281,16 @@ public:
     m_max = sz;
   }
 
+  /*
+    Set the number of ready sessions which the background warm-up task
+    keeps in the pool (see maintenance_loop()). 0 disables warm-up.
+  */
+
+  void set_min_size(size_t sz)
+  {
+    m_min = sz;
+  }
+
   void set_timeout(uint64_t ms)
   {
     if (!check_num_limits<int64_t>(ms))
@@ -170,18 +305,312 @@ public:
     m_time_to_live = duration(static_cast<int64_t>(ms));
   }
 
+  /*
+    Change the maximum pool size at run-time. Growing takes effect
+    immediately (checkouts waiting for a free session are woken up).
+    Shrinking evicts surplus idle sessions, which are closed in a batch
+    outside of the pool mutex; sessions currently in use are unaffected
+    and the pool shrinks further as they are released.
+  */
+
+  void resize(size_t max);
+
+  /*
+    Stop handing out sessions while keeping the pool warm: get_session()
+    fails until resume() is called, sessions currently in use continue to
+    work and return to the pool as usual.
+  */
+
+  void drain();
+
+  void resume();
+
+  /*
+    Snapshot of pool runtime statistics, see get_stats(). All counters
+    are cumulative over the pool's lifetime except pool_size and
+    idle_count, which describe the current state.
+  */
+
+  struct Stats
+  {
+    uint64_t pool_size = 0;          // sessions currently owned by the pool
+    uint64_t idle_count = 0;         // of which idle, ready for re-use
+    uint64_t sessions_created = 0;
+    uint64_t sessions_closed = 0;
+    uint64_t checkouts = 0;          // sessions handed out by get_session()
+    uint64_t checkout_hits = 0;      // of which re-used a pooled session
+    uint64_t affinity_hits = 0;      // of which matched the affinity hint
+    uint64_t acquire_wait_usec = 0;  // total time spent waiting for a session
+  };
+
+  /*
+    Fill `stats` with a snapshot of the pool statistics. The counters are
+    plain atomics updated on the existing code paths, so taking
+    a snapshot does not lock the pool.
+  */
+
+  void get_stats(Stats &stats) const
+  {
+    stats.pool_size = m_stat_size.load();
+    stats.idle_count = m_stat_idle.load();
+    stats.sessions_created = m_stat_created.load();
+    stats.sessions_closed = m_stat_closed.load();
+    stats.checkouts = m_stat_checkouts.load();
+    stats.checkout_hits = m_stat_hits.load();
+    stats.affinity_hits = m_stat_affinity.load();
+    stats.acquire_wait_usec = m_stat_wait_usec.load();
+  }
+
+  /*
+    Install a tracer receiving span callbacks from the pool and from
+    sessions created through it (see Span_tracer). Passing an empty
+    pointer disables tracing. The tracer of a session is fixed when the
+    session implementation object is created.
+  */
+
+  void set_tracer(std::shared_ptr<Span_tracer> tracer)
+  {
+    m_tracer = std::move(tracer);
+  }
+
+  const std::shared_ptr<Span_tracer>& tracer() const
+  {
+    return m_tracer;
+  }
+
+  /*
+    Client-wide statement caches, shared by all sessions of the pool.
+
+    A stored expression tree is immutable once parsed and its replay is
+    const, so sessions can share it: an expression string parsed by one
+    session of the client is replayed by every other one instead of being
+    re-parsed per session (see Session_impl::find_stored_expr()).
+
+    Statement shapes are shared in a similar way, except that server-side
+    statement ids are per-session: what is shared is only the knowledge
+    that a shape is hot (was promoted to a prepared statement by some
+    session), so that a session which sees it for the first time prepares
+    the statement on its first execution instead of warming up with
+    direct ones (see Session_impl::check_stmt_shape()).
+
+    Both caches are guarded by their own mutex - they are consulted when
+    statements are compiled, not on the pooling fast paths.
+  */
+
+  std::shared_ptr<impl::common::Stored_expr>
+  find_shared_expr(const std::string &key)
+  {
+    std::lock_guard<std::mutex> guard(m_stmt_cache_mutex);
+
+    auto it = m_shared_exprs.find(key);
+    return m_shared_exprs.end() != it
+           ? it->second : std::shared_ptr<impl::common::Stored_expr>();
+  }
+
+  void share_expr(
+    const std::string &key,
+    const std::shared_ptr<impl::common::Stored_expr> &expr
+  )
+  {
+    std::lock_guard<std::mutex> guard(m_stmt_cache_mutex);
+
+    // Like the per-session cache, drop everything on overflow.
+
+    if (m_shared_exprs.size() >= m_shared_exprs_max)
+      m_shared_exprs.clear();
+
+    m_shared_exprs[key] = expr;
+  }
+
+  /*
+    Tell whether some session of this client has prepared a statement of
+    the given shape (see mark_hot_shape()).
+  */
+
+  bool is_hot_shape(const std::string &key)
+  {
+    std::lock_guard<std::mutex> guard(m_stmt_cache_mutex);
+    return m_hot_shapes.end() != m_hot_shapes.find(key);
+  }
+
+  /*
+    Record that the given shape was promoted to a server-side prepared
+    statement by a session of this client.
+  */
+
+  void mark_hot_shape(const std::string &key)
+  {
+    std::lock_guard<std::mutex> guard(m_stmt_cache_mutex);
+
+    if (m_hot_shapes.size() >= m_hot_shapes_max
+        && m_hot_shapes.end() == m_hot_shapes.find(key))
+      m_hot_shapes.clear();
+
+    m_hot_shapes.insert(key);
+  }
+
+  /*
+    Client-level memory governor (MAX_CACHE_BYTES client option).
+
+    Each cache of the client - the per-session result caches (cached
+    find results, per-collection document caches), the per-session
+    compile caches (parsed expressions, interned names, result
+    meta-data) and the client-wide statement caches above - is bounded
+    on its own, but an application running many sessions would have to
+    provision for the worst-case sum of the bounds. The governor tracks
+    the aggregate cache footprint and, when it exceeds the configured
+    budget or the application signals memory pressure
+    (Client::shrinkCaches()), broadcasts a shrink request which every
+    session applies at its next statement boundary - caches are owned
+    by their sessions and are never touched from another thread. The
+    bulky result caches are dropped first, the cheap-to-rebuild compile
+    caches only when that is not enough (see
+    Session_impl::governor_checkpoint()).
+
+    The aggregate is maintained by the sessions themselves: at each
+    statement boundary a session publishes the change of its own cache
+    footprint, so reading the total is a single atomic load.
+  */
+
+  void set_cache_budget(size_t bytes)
+  {
+    m_cache_budget.store(bytes, std::memory_order_relaxed);
+  }
+
+  // Aggregate cache footprint published by the sessions of this client.
+
+  size_t cache_bytes() const
+  {
+    return m_cache_bytes.load(std::memory_order_relaxed);
+  }
+
+  bool over_cache_budget() const
+  {
+    size_t budget = m_cache_budget.load(std::memory_order_relaxed);
+    return 0 != budget && cache_bytes() > budget;
+  }
+
+  /*
+    Broadcast a full shrink request (application-signalled pressure).
+    The client-wide statement caches are dropped right away, the
+    per-session caches at each session's next statement boundary.
+  */
+
+  void shrink_caches()
+  {
+    m_purge_epoch.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> guard(m_stmt_cache_mutex);
+    m_shared_exprs.clear();
+    m_hot_shapes.clear();
+  }
+
+  uint64_t trim_epoch() const
+  {
+    return m_trim_epoch.load(std::memory_order_relaxed);
+  }
+
+  uint64_t purge_epoch() const
+  {
+    return m_purge_epoch.load(std::memory_order_relaxed);
+  }
+
+  /*
+    Publish the change of one session's cache footprint (from `before`
+    to `now` bytes). When the change crosses the budget from below,
+    a trim request is broadcast to all sessions of the client.
+  */
+
+  void publish_cache_bytes(size_t before, size_t now)
+  {
+    size_t total_before;
+
+    if (now >= before)
+      total_before =
+        m_cache_bytes.fetch_add(now - before, std::memory_order_relaxed);
+    else
+      total_before =
+        m_cache_bytes.fetch_sub(before - now, std::memory_order_relaxed);
+
+    size_t total_now = total_before + now - before;
+    size_t budget = m_cache_budget.load(std::memory_order_relaxed);
+
+    if (0 != budget && total_now > budget && total_before <= budget)
+      m_trim_epoch.fetch_add(1, std::memory_order_relaxed);
+  }
+
 
 protected:
 
-  void release_session(std::shared_ptr<cdk::Session> &sess);
+  void release_session(
+    std::shared_ptr<cdk::Session> &sess, size_t affinity = 0
+  );
+
+  /*
+    Drop a dead session that is checked out from the pool. Unlike
+    release_session(), the session is never cached for re-use - its pool
+    entry is removed so that a replacement can be checked out (see
+    Pooled_session::reconnect()).
+  */
+
+  void discard_session(std::shared_ptr<cdk::Session> &sess);
 
   /*
     Returns Session if possible (available). Throws error if the pool is closed.
     If cleanup handler is given, it will be called in case this session needs
     to be closed while in use (for example, when pool is closed).
+
+    A non-zero affinity hint (a statement shape hash) makes the checkout
+    prefer an idle session which was last used for the same shape, so
+    that a shape keeps hitting the same few sessions and their prepared
+    statements and metadata caches, instead of being spread over the
+    whole pool. The hint is only a preference: when no affine session is
+    idle, the checkout proceeds exactly as without a hint.
+  */
+
+  std::shared_ptr<cdk::Session> get_session(
+    Session_cleanup* = nullptr, size_t affinity = 0
+  );
+
+  /*
+    Per-thread session slot (thread-cached checkout).
+
+    A session released by a thread is parked in that thread's slot
+    instead of going back to the idle shards, and the next checkout from
+    the same thread re-uses it without the idle-shard search, the
+    connection probe and the checkout-time reset (the session was reset
+    when it was parked). While parked, the session stays checked out
+    from the pool's point of view: its pool entry is not unique, so it
+    is never handed to another thread nor reaped, and pool close()
+    closes it like any other session. The slot returns its session to
+    the pool when the owning thread exits or starts releasing sessions
+    of a different pool.
   */
 
-  std::shared_ptr<cdk::Session> get_session(Session_cleanup* = nullptr);
+  struct Thread_slot
+  {
+    Session_pool_shared            m_pool;
+    std::shared_ptr<cdk::Session>  m_sess;
+
+    ~Thread_slot();
+  };
+
+  static Thread_slot& thread_slot();
+
+  /*
+    Park a released session in the calling thread's slot. Returns false
+    if the session can not be parked (pool closed or draining, slot
+    already holds a session of this pool, session reset not possible) -
+    the caller then releases it to the pool as usual.
+  */
+
+  bool park_session(
+    Session_pool_shared &self, std::shared_ptr<cdk::Session> &sess
+  );
+
+  // Take the session parked by the calling thread, if any.
+
+  std::shared_ptr<cdk::Session> take_thread_session(Session_cleanup*);
 
   /*
     Return an available session from the pool (not currently in use) if such session
@@ -207,12 +636,116 @@ protected:
   try_session(std::shared_ptr<cdk::Session> &sess,
                 Session_cleanup* = nullptr);
 
-  void time_to_live_cleanup();
+  /*
+    Collect expired idle sessions and close them in one batch outside of
+    the pool mutex. Runs on the maintenance thread, so that session
+    teardown (TLS shutdown, socket close) is never paid on the
+    application's request path.
+  */
+
+  void reap_expired_sessions();
+
+  // Statistics counters, see get_stats().
+
+  std::atomic<uint64_t> m_stat_size{0};
+  std::atomic<uint64_t> m_stat_idle{0};
+  std::atomic<uint64_t> m_stat_created{0};
+  std::atomic<uint64_t> m_stat_closed{0};
+  std::atomic<uint64_t> m_stat_checkouts{0};
+  std::atomic<uint64_t> m_stat_hits{0};
+  std::atomic<uint64_t> m_stat_affinity{0};
+  std::atomic<uint64_t> m_stat_wait_usec{0};
+
+  // Optional span tracer, see set_tracer().
+
+  std::shared_ptr<Span_tracer> m_tracer;
+
+  void stat_session_added()
+  {
+    ++m_stat_created;
+    ++m_stat_size;
+  }
+
+  void stat_session_removed(uint64_t how_many = 1)
+  {
+    m_stat_closed += how_many;
+    m_stat_size -= how_many;
+  }
+
+  /*
+    Checkout striping over the hosts of the multi source.
+
+    Without it the pool converges onto a single host: sessions to the
+    host which answered first are re-used most often while sessions to
+    other hosts idle out. The pool counts checked-out sessions per data
+    source id and checkouts prefer sessions to the host with the fewest
+    outstanding ones (see pop_idle_session() and get_pooled_session()).
+    Block-listed hosts are never preferred.
+
+    m_host_active is guarded by the pool mutex; m_preferred_host is
+    a snapshot of the least-loaded host which the lock-free fast path can
+    read without taking that mutex (0 = no preference).
+  */
+
+  std::map<size_t, size_t> m_host_active;
+  std::atomic<size_t> m_preferred_host{0};
+
+  // Note: must be called with the pool mutex held.
+
+  void refresh_preferred_host()
+  {
+    size_t best = 0;
+    size_t best_count = std::numeric_limits<size_t>::max();
+
+    for (auto &el : m_host_active)
+    {
+      if (m_block_list.is_block_listed(el.first))
+        continue;
+
+      if (el.second < best_count)
+      {
+        best = el.first;
+        best_count = el.second;
+      }
+    }
+
+    m_preferred_host.store(best);
+  }
+
+  void host_checkout(size_t id)
+  {
+    if (0 == id)
+      return;
+    ++m_host_active[id];
+    refresh_preferred_host();
+  }
+
+  void host_release(size_t id)
+  {
+    if (0 == id)
+      return;
+
+    auto el = m_host_active.find(id);
+    if (el != m_host_active.end() && el->second > 0)
+      --el->second;
+
+    refresh_preferred_host();
+  }
+
+  // Number of checked-out sessions to the given host.
+
+  size_t host_active_count(size_t id) const
+  {
+    auto el = m_host_active.find(id);
+    return el == m_host_active.end() ? 0 : el->second;
+  }
 
   cdk::ds::Multi_source m_ds;
   bool m_pool_enable = true;
   bool m_pool_closed = false;
+  bool m_draining = false;
   size_t m_max = 25;
+  size_t m_min = 0;
   duration m_timeout = std::chrono::minutes(10);
   duration m_time_to_live = std::chrono::minutes(10);
 
@@ -268,11 +801,121 @@ protected:
     Session_cleanup *m_cleanup;
   };
 
+  /*
+    Sharded cache of idle sessions.
+
+    Sessions returned to the pool are put on small per-shard lists, each
+    protected by its own mutex. A thread acquiring a session first looks
+    at "its" shard (chosen by thread id) and steals from the other shards
+    when that one is empty. This keeps concurrent acquires off the global
+    pool mutex, which is then needed only for the slow path: pool
+    book-keeping, session creation and TTL cleanup. Each entry carries
+    the expiration deadline of the idle session so that it can be checked
+    without the global lock.
+
+    Each entry also records the NUMA node of the thread which released
+    the session, and checkouts prefer a session last used on the
+    caller's node (see pop_idle_session()), so that the session's
+    receive buffers and decoded caches keep being accessed from the
+    memory node on which they were allocated.
+
+    Entries further carry the statement-shape affinity hint of the
+    released session and a checkout made with a hint prefers a session
+    with the matching one (see get_session()). This keeps a statement
+    shape concentrated on the few sessions which already hold its
+    prepared statement and metadata, instead of eventually preparing
+    every shape on every session of a large pool.
+  */
+
+  enum { POOL_SHARDS = 8 };
+
+  struct Idle_entry
+  {
+    std::shared_ptr<cdk::Session> m_sess;
+    time_point m_deadline;
+    unsigned   m_node;     // NUMA node which released the session
+    size_t     m_affinity; // shape-affinity hint of the session (0 = none)
+  };
+
+  struct Idle_shard
+  {
+    std::mutex m_mutex;
+    std::vector<Idle_entry> m_sessions;
+  };
+
+  Idle_shard m_idle_shards[POOL_SHARDS];
+
+  static size_t shard_idx()
+  {
+    return
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % POOL_SHARDS;
+  }
+
+  // Node id used when the platform does not expose the NUMA node.
+
+  static const unsigned UNKNOWN_NODE = std::numeric_limits<unsigned>::max();
+
+  // NUMA node on which the calling thread currently runs.
+
+  static unsigned numa_node();
+
+  /*
+    Take one idle, not yet expired session out of the shard cache. Returns
+    null pointer if all shards are empty.
+  */
+
+  std::shared_ptr<cdk::Session> pop_idle_session(size_t affinity = 0);
+
+  void push_idle_session(
+    const std::shared_ptr<cdk::Session>&, time_point deadline,
+    size_t affinity = 0
+  );
+
+  void clear_idle_shards();
+
+  /*
+    Background pool maintenance task. It reaps sessions whose idle time
+    exceeded the configured limit (see reap_expired_sessions()) and, when
+    a non-zero minimum pool size is configured, re-creates ready sessions
+    so that requests arriving after a deploy or after such cleanup do not
+    pay the full connect cost. The task is started when the pool is first
+    used and stopped when the pool is closed.
+  */
+
+  std::thread m_maint_thread;
+  std::mutex m_maint_mutex;
+  std::condition_variable m_maint_cond;
+  bool m_maint_stop = false;
+
+  void start_maintenance();
+  void stop_maintenance();
+  void maintenance_loop();
+
+  // Create ready sessions until the pool holds m_min of them.
+
+  void warm_up();
+
   std::map<cdk::shared_ptr<cdk::Session>, Sess_data> m_pool;
   std::recursive_mutex m_pool_mutex;
   std::mutex m_reelase_mutex;
   std::condition_variable m_release_cond;
 
+  // Memory governor state, see set_cache_budget() etc. above.
+
+  std::atomic<size_t>   m_cache_budget{0};
+  std::atomic<size_t>   m_cache_bytes{0};
+  std::atomic<uint64_t> m_trim_epoch{0};
+  std::atomic<uint64_t> m_purge_epoch{0};
+
+  // Client-wide statement caches, see find_shared_expr() etc. above.
+
+  std::mutex m_stmt_cache_mutex;
+  std::map<std::string, std::shared_ptr<impl::common::Stored_expr>>
+          m_shared_exprs;
+  size_t  m_shared_exprs_max = 1024;
+  std::set<std::string>  m_hot_shapes;
+  size_t  m_hot_shapes_max = 1024;
+
 
   friend Pooled_session;
 };
@@ -301,15 +944,933 @@ public:
   std::set<uint32_t>  m_stmt_id_cleanup;
   size_t              m_max_pstmt = std::numeric_limits<size_t>::max();
 
-  Session_impl(Session_pool_shared &pool)
-    : m_sess(pool, this)
-  {
-    m_sess.wait();
-    if (m_sess->get_default_schema())
-      m_default_db = *m_sess->get_default_schema();
-    if (!m_sess->is_valid())
-      m_sess->get_error().rethrow();
-  }
+  /*
+    Cached result meta-data of prepared statements, keyed by statement id.
+
+    Result meta-data of a prepared statement is fixed when the statement
+    is prepared on the server, so the Meta_data instance built on the first
+    execution can be re-used by later executions instead of being re-built
+    from the column information re-sent by the server (see
+    Result_impl::push_row_cache()). Entries are dropped when the statement
+    id is released or errors out.
+  */
+
+  std::map<uint32_t, std::shared_ptr<impl::common::Meta_data>>  m_mdata_cache;
+
+  /*
+    Interned column/table/schema names (see Column_info::store_info()).
+
+    Result meta-data repeats the same identifiers with every result set,
+    so repeated queries would copy the same names over and over. Names
+    are kept here as shared immutable strings which Column_info
+    instances reference - once a name has been seen, storing it for
+    another column is a shared-pointer assignment. The cache is capped;
+    when full, new names are no longer remembered across results.
+  */
+
+  std::unordered_map<std::string, std::shared_ptr<const std::string>>
+          m_name_cache;
+  size_t  m_name_cache_max = 1024;
+
+  std::shared_ptr<const std::string> intern_name(const cdk::string &name)
+  {
+    std::string utf8(name);
+
+    auto it = m_name_cache.find(utf8);
+    if (m_name_cache.end() != it)
+      return it->second;
+
+    auto entry = std::make_shared<const std::string>(std::move(utf8));
+
+    if (m_name_cache.size() < m_name_cache_max)
+      m_name_cache.emplace(*entry, entry);
+
+    return entry;
+  }
+
+  /*
+    Cache of server-side prepared statements keyed by statement shape.
+
+    Operations which can describe their shape - the statement structure
+    without the values of parameters and of limit/offset (see
+    Op_base::stmt_key()) - are counted here across operation objects.
+    A shape starts executing directly; once it was executed
+    m_prepare_threshold times the next execution prepares the statement
+    and publishes its id here, and later executions re-use the prepared
+    statement, even if the application builds a fresh operation object
+    for each of them. Entries are evicted in LRU order.
+  */
+
+  struct Pstmt_cache_entry
+  {
+    std::shared_ptr<uint32_t>         id;  // null until the stmt is prepared
+    std::list<std::string>::iterator  pos; // position in the LRU list
+    unsigned                          hits = 0;  // direct executions counted
+  };
+
+  std::map<std::string, Pstmt_cache_entry>  m_pstmt_cache;
+  std::list<std::string>                    m_pstmt_lru;
+  size_t                                    m_pstmt_cache_max = 128;
+
+  /*
+    Number of direct executions of a shape before it is promoted to
+    a server-side prepared statement (PREPARE_THRESHOLD session option).
+    With the default of 1 the second execution of a shape prepares it;
+    higher values keep one-off queries from consuming server
+    prepared-statement slots.
+  */
+
+  size_t m_prepare_threshold = 1;
+
+  void set_prepare_threshold(size_t n)
+  {
+    m_prepare_threshold = n;
+  }
+
+  /*
+    Cache of parsed expressions, keyed by the parser mode and the source
+    string (see find_stored_expr()).
+
+    Parsing an expression string into a Stored_expr tree happens only on
+    its first use within the session - later statements which use the same
+    string replay the stored tree instead of re-parsing (see
+    Op_select::get_where()).
+  */
+
+  std::map<std::string, std::shared_ptr<impl::common::Stored_expr>>
+          m_expr_cache;
+  size_t  m_expr_cache_max = 256;
+
+  /*
+    Number of rows read ahead into the result cache when rows are
+    consumed one by one (PREFETCH_ROWS session option).
+  */
+
+  size_t              m_prefetch_rows = 16;
+
+  void set_prefetch_rows(size_t n)
+  {
+    if (n > 0)
+      m_prefetch_rows = n;
+  }
+
+  size_t prefetch_rows() const
+  {
+    return m_prefetch_rows;
+  }
+
+  /*
+    Byte budget for a single insert message (INSERT_CHUNK_SIZE session
+    option). Insert operations which accumulate more data than this send
+    it as a sequence of smaller insert messages (see
+    Op_collection_add::send_command()).
+  */
+
+  size_t m_insert_chunk_size = 16*1024*1024;
+
+  void set_insert_chunk_size(size_t n)
+  {
+    if (n > 0)
+      m_insert_chunk_size = n;
+  }
+
+  size_t insert_chunk_size() const
+  {
+    return m_insert_chunk_size;
+  }
+
+  /*
+    Coalescing of asynchronously submitted statements (SUBMIT_WINDOW
+    session option, 0 = disabled).
+
+    When enabled, commands of statements submitted without waiting for
+    their results are accumulated in the session pipeline instead of each
+    being written to the socket on its own. The batch is sent with
+    a single write once it holds m_submit_window statements, or earlier:
+    as soon as any reply is needed (polling or waiting for a result,
+    a synchronous execution, a transaction boundary). Statements
+    coalesced this way stay independent - no expectation block is opened
+    around the batch.
+  */
+
+  size_t m_submit_window = 0;
+  size_t m_submit_pending = 0;
+  bool   m_submit_batch = false;
+
+  void set_submit_window(size_t n)
+  {
+    m_submit_window = n;
+  }
+
+  /*
+    Declare the transport trusted, enabling the protocol's
+    validated-transport mode (see cdk::Session::set_validated_transport()).
+  */
+
+  void set_validated_transport(bool enable)
+  {
+    m_sess->set_validated_transport(enable);
+  }
+
+  /*
+    Drop warning notices at protocol message dispatch (SKIP_WARNINGS
+    session option). For sessions which never examine warnings this
+    saves building and buffering diagnostics nobody reads; with the
+    option set, results report no warnings.
+  */
+
+  void set_skip_warnings(bool enable)
+  {
+    m_sess->set_skip_warnings(enable);
+  }
+
+  /*
+    Concurrent-reads mode (CONCURRENT_READS session option).
+
+    When enabled, statement execution is gated by a session-wide mutex
+    held from the moment a command is sent until its complete reply has
+    been buffered by the result object created for it (see
+    Op_base::init() and the Result_impl constructor). A buffered result
+    detaches from the session and is read from its private cache, so a
+    single session can be shared by several reader threads: their
+    statements take turns on the connection while result consumption
+    proceeds concurrently.
+
+    The mutex is recursive because the result object re-acquires the
+    gate which its operation already holds when claiming the reply.
+  */
+
+  bool m_concurrent = false;
+  std::recursive_mutex m_exec_mutex;
+
+  void set_concurrent_reads(bool enable)
+  {
+    m_concurrent = enable;
+  }
+
+  bool concurrent_reads() const
+  {
+    return m_concurrent;
+  }
+
+  /*
+    Take the execution gate in concurrent-reads mode; otherwise the
+    returned lock is empty and taking it costs nothing.
+  */
+
+  std::unique_lock<std::recursive_mutex> lock_exec()
+  {
+    if (m_concurrent)
+      return std::unique_lock<std::recursive_mutex>(m_exec_mutex);
+    return {};
+  }
+
+  /*
+    Per-statement execution timeout in milliseconds (STATEMENT_TIMEOUT
+    session option, 0 = no limit).
+
+    The timeout is enforced as an I/O deadline on the connection: it is
+    armed for the duration of each blocking statement wait (see
+    Op_base::wait()) and covers sending the command as well as waiting
+    for and reading the server reply. When the deadline expires the
+    operation throws Error_timeout leaving the connection with
+    a partially transferred reply, so the session is marked invalid and
+    discarded by the pool instead of being re-used
+    (see io_deadline_expired()).
+  */
+
+  uint64_t m_stmt_timeout = 0;
+  bool     m_io_timed_out = false;
+
+  void set_statement_timeout(uint64_t ms)
+  {
+    m_stmt_timeout = ms;
+  }
+
+  void arm_io_deadline()
+  {
+    if (m_stmt_timeout && !m_io_timed_out)
+      m_sess->set_io_deadline(m_stmt_timeout);
+  }
+
+  /*
+    Disarm the deadline after a statement wait. After a timeout the
+    deadline is deliberately left armed, so that any cleanup I/O on the
+    abandoned connection also fails fast instead of blocking.
+  */
+
+  void disarm_io_deadline()
+  {
+    if (m_stmt_timeout && !m_io_timed_out)
+      m_sess->set_io_deadline(0);
+  }
+
+  // Called when a statement wait ended with Error_timeout.
+
+  void io_deadline_expired()
+  {
+    m_io_timed_out = true;
+    m_sess->invalidate();
+  }
+
+  /*
+    Open the coalescing pipeline for a statement being submitted, unless
+    coalescing is disabled or a pipeline is already managed elsewhere
+    (explicit batches open their own).
+  */
+
+  void submit_batch_begin()
+  {
+    if (0 == m_submit_window || m_submit_batch || m_sess->pipeline_active())
+      return;
+
+    m_sess->start_pipeline(false);
+    m_submit_batch = true;
+    m_submit_pending = 0;
+  }
+
+  // Count a submitted statement, flushing a full batch.
+
+  void submit_batch_add()
+  {
+    if (!m_submit_batch)
+      return;
+
+    if (++m_submit_pending >= m_submit_window)
+      flush_submit_batch();
+  }
+
+  /*
+    Send the commands accumulated by submit coalescing. Must be called
+    before any server reply is examined - the statements of the batch are
+    not on the wire until then.
+  */
+
+  void flush_submit_batch()
+  {
+    if (!m_submit_batch)
+      return;
+
+    m_submit_batch = false;
+    m_submit_pending = 0;
+    m_sess->flush_pipeline();
+  }
+
+  /*
+    Byte budget for buffering rows of a result in memory
+    (MAX_RESULT_BUFFER session option, 0 = no limit). Enforced by
+    Result_impl, which sizes its prefetch windows so that the cached
+    rows stay within the budget and spills overflow rows of stored
+    results to a temporary file.
+  */
+
+  size_t m_max_result_buffer = 0;
+
+  void set_max_result_buffer(size_t n)
+  {
+    m_max_result_buffer = n;
+  }
+
+  size_t max_result_buffer() const
+  {
+    return m_max_result_buffer;
+  }
+
+  /*
+    Cache of object existence checks (METADATA_CACHE_TTL session option).
+
+    Existence checks done by `existsInDatabase()` and by methods like
+    `getSchema()` which accept a check flag normally query the server each
+    time (see check_schema_exists() etc. in op_impl.h). When a non-zero
+    staleness budget is configured, the answer to such a check is stored
+    here, keyed by a string combining the object type with the schema and
+    object name, and re-used until it expires. DDL executed through this
+    session updates the affected entries right away - DDL executed
+    elsewhere is noticed only once the budget has passed.
+
+    For tables the stored state also says whether the table is a view,
+    which table existence checks determine as a side effect.
+  */
+
+  enum Exists_state {
+    EXISTS_UNKNOWN = -1,  // no valid cache entry
+    EXISTS_NO      = 0,
+    EXISTS_YES     = 1,
+    EXISTS_VIEW    = 2,   // exists and is a view (tables only)
+  };
+
+  std::map<std::string, std::pair<int, time_point>> m_exists_cache;
+  std::chrono::milliseconds m_exists_ttl{0};
+
+  void set_metadata_cache_ttl(uint64_t ms)
+  {
+    m_exists_ttl = std::chrono::milliseconds(ms);
+    if (0 == ms)
+      m_exists_cache.clear();
+  }
+
+  /*
+    Look up the stored existence state for the given key. Returns
+    EXISTS_UNKNOWN if the cache is disabled, there is no entry or the
+    entry has expired - the caller should then ask the server and store
+    the answer with store_exists_state().
+  */
+
+  int find_exists_state(const std::string &key)
+  {
+    if (0 == m_exists_ttl.count())
+      return EXISTS_UNKNOWN;
+
+    auto it = m_exists_cache.find(key);
+
+    if (m_exists_cache.end() == it)
+      return EXISTS_UNKNOWN;
+
+    if (system_clock::now() > it->second.second)
+    {
+      m_exists_cache.erase(it);
+      return EXISTS_UNKNOWN;
+    }
+
+    return it->second.first;
+  }
+
+  void store_exists_state(const std::string &key, int state)
+  {
+    if (0 == m_exists_ttl.count())
+      return;
+
+    m_exists_cache[key] = { state, system_clock::now() + m_exists_ttl };
+  }
+
+  /*
+    Drop a stored state - used by DDL operations whose exact effect on it
+    is not known.
+  */
+
+  void forget_exists_state(const std::string &key)
+  {
+    m_exists_cache.erase(key);
+  }
+
+  /*
+    Opt-in cache of documents fetched by id
+    (see Collection::enableDocumentCache()).
+
+    For collections on which the cache was enabled, documents returned by
+    getOne() are kept here as JSON text keyed by the document id, so that
+    repeated reads of the same document skip the server entirely. Each
+    per-collection cache is bounded by a byte budget with LRU eviction.
+    DML executed on the collection through this session drops its entries
+    right away; writes done elsewhere are noticed only once the optional
+    TTL has passed (with no TTL, entries stay until evicted or
+    invalidated by own writes).
+  */
+
+  struct Doc_cache
+  {
+    size_t                     max_bytes = 0;
+    std::chrono::milliseconds  ttl{0};
+
+    // Bytes held by the cached entries (ids and JSON text).
+
+    size_t  bytes = 0;
+
+    struct Entry
+    {
+      std::string  json;
+      time_point   expires;
+      std::list<std::string>::iterator  pos;  // position in the LRU list
+    };
+
+    std::map<std::string, Entry>  docs;  // keyed by document id
+    std::list<std::string>        lru;   // most recently used in front
+
+    void erase(std::map<std::string, Entry>::iterator it)
+    {
+      bytes -= std::min(bytes, it->first.size() + it->second.json.size());
+      lru.erase(it->second.pos);
+      docs.erase(it);
+    }
+
+    void trim()
+    {
+      while (bytes > max_bytes)
+      {
+        assert(!lru.empty());
+        erase(docs.find(lru.back()));
+      }
+    }
+  };
+
+  // Per-collection caches, keyed as by doc_cache_key() (see op_impl.h).
+
+  std::map<std::string, Doc_cache>  m_doc_caches;
+
+  /*
+    Enable the cache for the given collection (or re-configure it,
+    keeping the cached entries). A zero byte budget disables the cache
+    and drops its entries.
+  */
+
+  void doc_cache_enable(const std::string &coll, size_t max_bytes, uint64_t ttl_ms)
+  {
+    if (0 == max_bytes)
+    {
+      m_doc_caches.erase(coll);
+      return;
+    }
+
+    Doc_cache &cache = m_doc_caches[coll];
+    cache.max_bytes = max_bytes;
+    cache.ttl = std::chrono::milliseconds(ttl_ms);
+    cache.trim();
+  }
+
+  bool doc_cache_active(const std::string &coll) const
+  {
+    return m_doc_caches.end() != m_doc_caches.find(coll);
+  }
+
+  /*
+    Look up a cached document, refreshing its LRU position. Returns false
+    if the cache is disabled for the collection or holds no valid entry
+    for the id.
+  */
+
+  bool doc_cache_find(
+    const std::string &coll, const std::string &id, std::string &json
+  )
+  {
+    auto it = m_doc_caches.find(coll);
+
+    if (m_doc_caches.end() == it)
+      return false;
+
+    Doc_cache &cache = it->second;
+    auto doc_it = cache.docs.find(id);
+
+    if (cache.docs.end() == doc_it)
+      return false;
+
+    if (0 != cache.ttl.count() && system_clock::now() > doc_it->second.expires)
+    {
+      cache.erase(doc_it);
+      return false;
+    }
+
+    cache.lru.splice(cache.lru.begin(), cache.lru, doc_it->second.pos);
+    json = doc_it->second.json;
+    return true;
+  }
+
+  void doc_cache_store(
+    const std::string &coll, const std::string &id, const std::string &json
+  )
+  {
+    auto it = m_doc_caches.find(coll);
+
+    if (m_doc_caches.end() == it)
+      return;
+
+    Doc_cache &cache = it->second;
+
+    // A document which does not fit in the budget is not cached at all.
+
+    if (id.size() + json.size() > cache.max_bytes)
+      return;
+
+    auto doc_it = cache.docs.find(id);
+    if (cache.docs.end() != doc_it)
+      cache.erase(doc_it);
+
+    cache.lru.push_front(id);
+
+    Doc_cache::Entry &entry = cache.docs[id];
+    entry.json = json;
+    entry.pos = cache.lru.begin();
+    if (0 != cache.ttl.count())
+      entry.expires = system_clock::now() + cache.ttl;
+
+    cache.bytes += id.size() + json.size();
+    cache.trim();
+  }
+
+  /*
+    Drop all entries of the collection's cache, keeping it enabled. Called
+    before DML on the collection is sent - which documents it touches is
+    not known on the client side.
+  */
+
+  void doc_cache_invalidate(const std::string &coll)
+  {
+    auto it = m_doc_caches.find(coll);
+
+    if (m_doc_caches.end() == it)
+      return;
+
+    it->second.docs.clear();
+    it->second.lru.clear();
+    it->second.bytes = 0;
+  }
+
+  /*
+    Bounded-staleness cache of complete find results
+    (see CollectionFind::executeCached()).
+
+    Entries hold a full result set as JSON text, keyed by the statement
+    fingerprint (its shape together with the bound parameter and
+    limit/offset values) and tagged with the time the result was fetched
+    from the server. Each lookup names its own staleness budget - an entry
+    older than the budget is a miss and is dropped. There is no other
+    invalidation: within the budget a cached result may not reflect later
+    writes, including writes made through this very session.
+  */
+
+  struct Query_cache_entry
+  {
+    std::vector<std::string>  docs;
+    size_t                    bytes = 0;
+    time_point                fetched;
+    std::list<std::string>::iterator  pos;  // position in the LRU list
+  };
+
+  std::map<std::string, Query_cache_entry>  m_query_cache;
+  std::list<std::string>  m_query_lru;   // most recently used in front
+  size_t  m_query_cache_bytes = 0;
+  size_t  m_query_cache_max = 16*1024*1024;
+
+  void query_cache_erase(std::map<std::string, Query_cache_entry>::iterator it)
+  {
+    m_query_cache_bytes -= std::min(m_query_cache_bytes, it->second.bytes);
+    m_query_lru.erase(it->second.pos);
+    m_query_cache.erase(it);
+  }
+
+  /*
+    Look up a cached result fetched within the given staleness budget,
+    refreshing its LRU position.
+  */
+
+  bool query_cache_find(
+    const std::string &key, uint64_t staleness_ms,
+    std::vector<std::string> &docs
+  )
+  {
+    auto it = m_query_cache.find(key);
+
+    if (m_query_cache.end() == it)
+      return false;
+
+    if (system_clock::now() >
+        it->second.fetched + std::chrono::milliseconds(staleness_ms))
+    {
+      query_cache_erase(it);
+      return false;
+    }
+
+    m_query_lru.splice(m_query_lru.begin(), m_query_lru, it->second.pos);
+    docs = it->second.docs;
+    return true;
+  }
+
+  void query_cache_store(const std::string &key, std::vector<std::string> &&docs)
+  {
+    size_t bytes = key.size();
+    for (const std::string &doc : docs)
+      bytes += doc.size();
+
+    // A result which does not fit in the budget is not cached at all.
+
+    if (bytes > m_query_cache_max)
+      return;
+
+    auto it = m_query_cache.find(key);
+    if (m_query_cache.end() != it)
+      query_cache_erase(it);
+
+    m_query_lru.push_front(key);
+
+    Query_cache_entry &entry = m_query_cache[key];
+    entry.docs = std::move(docs);
+    entry.bytes = bytes;
+    entry.fetched = system_clock::now();
+    entry.pos = m_query_lru.begin();
+
+    m_query_cache_bytes += bytes;
+
+    while (m_query_cache_bytes > m_query_cache_max)
+    {
+      assert(!m_query_lru.empty());
+      query_cache_erase(m_query_cache.find(m_query_lru.back()));
+    }
+  }
+
+  /*
+    Memory governor hooks (see Session_pool::set_cache_budget()).
+
+    The governor never touches a session's caches from another thread.
+    Instead, at each statement boundary the session checks the pool's
+    shrink epochs, applies any requested shrinking to its own caches
+    and publishes its current cache footprint (governor_checkpoint(),
+    called from prepare_for_cmd()). Stand-alone sessions have no pool
+    and are not governed.
+  */
+
+  size_t    m_published_cache_bytes = 0;
+  uint64_t  m_trim_seen = 0;
+  uint64_t  m_purge_seen = 0;
+
+  /*
+    Nominal per-entry cost, in bytes, of cache entries whose sizes are
+    not tracked exactly (map node, key, bookkeeping). The byte-heavy
+    caches (cached find results, document caches) track their sizes
+    exactly; the compile caches hold many small entries for which an
+    estimate is enough for budget purposes.
+  */
+
+  static const size_t CACHE_ENTRY_BYTES = 256;
+
+  // Estimate of the memory held by this session's caches.
+
+  size_t cache_bytes() const
+  {
+    size_t total = m_query_cache_bytes;
+
+    for (auto &cache : m_doc_caches)
+      total += cache.second.bytes;
+
+    total += CACHE_ENTRY_BYTES
+             * (m_expr_cache.size() + m_name_cache.size()
+                + m_mdata_cache.size() + m_exists_cache.size());
+
+    return total;
+  }
+
+  /*
+    Release cache memory. Level 1 drops the bulky result caches (cached
+    find results and per-collection document caches - the caches stay
+    enabled and refill on use); level 2 additionally drops the compile
+    caches (parsed expressions, interned names, prepared-statement
+    result meta-data, existence checks). Server-side prepared
+    statements are never touched - they hold server resources, not
+    client memory.
+  */
+
+  void shrink_caches(unsigned level)
+  {
+    m_query_cache.clear();
+    m_query_lru.clear();
+    m_query_cache_bytes = 0;
+
+    for (auto &cache : m_doc_caches)
+    {
+      cache.second.docs.clear();
+      cache.second.lru.clear();
+      cache.second.bytes = 0;
+    }
+
+    if (level < 2)
+      return;
+
+    m_expr_cache.clear();
+    m_name_cache.clear();
+    m_mdata_cache.clear();
+    m_exists_cache.clear();
+  }
+
+  void governor_checkpoint()
+  {
+    auto &pool = m_sess.get_pool();
+
+    if (!pool)
+      return;
+
+    uint64_t purge = pool->purge_epoch();
+    uint64_t trim = pool->trim_epoch();
+
+    if (purge != m_purge_seen)
+    {
+      m_purge_seen = purge;
+      m_trim_seen = trim;
+      shrink_caches(2);
+    }
+    else if (trim != m_trim_seen)
+    {
+      m_trim_seen = trim;
+      shrink_caches(1);
+      publish_cache_bytes();
+
+      /*
+        If the result caches alone did not bring the client under its
+        budget, let the compile caches go too. Sessions which have not
+        reached their checkpoint yet still hold their share, so under
+        pressure this prefers shrinking too much over staying over
+        budget.
+      */
+
+      if (pool->over_cache_budget())
+        shrink_caches(2);
+    }
+
+    publish_cache_bytes();
+  }
+
+  void publish_cache_bytes()
+  {
+    auto &pool = m_sess.get_pool();
+    size_t now = cache_bytes();
+
+    if (pool && now != m_published_cache_bytes)
+    {
+      pool->publish_cache_bytes(m_published_cache_bytes, now);
+      m_published_cache_bytes = now;
+    }
+  }
+
+  /*
+    Replay log of session-mutating SQL statements (see restore_state()).
+
+    SET and USE statements executed through sql() without bound
+    parameters are recorded here verbatim, so that after the session
+    dies its state can be re-established on a fresh session by replaying
+    the log. The log is capped - once the limit is hit it is dropped and
+    recording stops, as a partial replay would restore partial state.
+  */
+
+  std::vector<std::string>  m_state_log;
+  size_t                    m_state_log_max = 64;
+  bool                      m_state_log_off = false;
+
+  /*
+    Tell whether an SQL statement mutates session state which the replay
+    log should capture (currently SET and USE statements).
+  */
+
+  static bool is_state_stmt(const std::string &query)
+  {
+    size_t beg = query.find_first_not_of(" \t\r\n");
+
+    if (std::string::npos == beg)
+      return false;
+
+    size_t end = query.find_first_of(" \t\r\n", beg);
+    std::string tok = query.substr(
+      beg, std::string::npos == end ? std::string::npos : end - beg
+    );
+
+    for (auto &c : tok)
+      c = (char)std::toupper((unsigned char)c);
+
+    return "SET" == tok || "USE" == tok;
+  }
+
+  void log_state_stmt(const std::string &query)
+  {
+    if (m_state_log_off)
+      return;
+
+    if (m_state_log.size() >= m_state_log_max)
+    {
+      m_state_log.clear();
+      m_state_log_off = true;
+      return;
+    }
+
+    m_state_log.push_back(query);
+  }
+
+  /*
+    Re-establish on this session the state recorded by another (normally
+    dead) session: its current schema and its replay log. All statements
+    are sent without waiting for replies, so they travel to the server in
+    the same network round-trip as this session's next command; server
+    errors are re-thrown at the next transaction boundary (the replies
+    are examined by check_trx_pipeline()).
+  */
+
+  void restore_state(const Session_impl &other);
+
+  /*
+    Opt-in transparent reconnect (AUTO_RECONNECT session option).
+
+    When the connection dies under an idempotent statement, the session
+    re-establishes it and replays the state recorded in the replay log,
+    pipelined with the retried statement so that reconnect and replay
+    cost a single round-trip (see reconnect() and Op_base::wait()).
+    Statements executed inside an explicit transaction are never retried
+    - the server-side transaction state died with the connection.
+  */
+
+  bool m_auto_reconnect = false;
+  bool m_in_trx = false;
+
+  void set_auto_reconnect(bool enable)
+  {
+    m_auto_reconnect = enable;
+  }
+
+  /*
+    Try to re-establish the connection after the current one died.
+    Returns true when a fresh connection with replayed session state is
+    in place and the failed statement can be re-executed.
+  */
+
+  bool reconnect();
+
+  /*
+    Traffic counters of the underlying protocol connection.
+  */
+
+  const cdk::protocol::mysqlx::Protocol_stats& protocol_stats() const
+  {
+    return m_sess->protocol_stats();
+  }
+
+  /*
+    Per-phase timings of the session setup sequence.
+  */
+
+  const cdk::mysqlx::Connect_timings& connect_timings() const
+  {
+    return m_sess->connect_timings();
+  }
+
+  /*
+    Number of commands sent to the server by this session (statements,
+    admin commands, transaction control), counted in prepare_for_cmd().
+  */
+
+  uint64_t m_stmt_count = 0;
+
+  /*
+    Optional tracer receiving statement execution spans (see
+    Span_tracer). Sessions obtained from a pool inherit the pool's
+    tracer; for stand-alone sessions it can be installed directly.
+  */
+
+  std::shared_ptr<Span_tracer> m_tracer;
+
+  void set_tracer(std::shared_ptr<Span_tracer> tracer)
+  {
+    m_tracer = std::move(tracer);
+  }
+
+  Span_tracer* tracer() const
+  {
+    return m_tracer.get();
+  }
+
+  Session_impl(Session_pool_shared &pool)
+    : m_sess(pool, this)
+  {
+    m_tracer = pool->tracer();
+    m_sess.wait();
+    if (m_sess->get_default_schema())
+      m_default_db = *m_sess->get_default_schema();
+    if (!m_sess->is_valid())
+      m_sess->get_error().rethrow();
+  }
 
   Session_impl(cdk::ds::Multi_source &ms)
     : m_sess(ms)
@@ -334,6 +1895,11 @@ public:
     */
     assert(!m_current_result);
 
+    // Remove this session's share from the client's cache accounting.
+
+    if (m_sess.get_pool() && m_published_cache_bytes)
+      m_sess.get_pool()->publish_cache_bytes(m_published_cache_bytes, 0);
+
     // TODO: rollback an on-going transaction, if any?
   }
 
@@ -346,12 +1912,17 @@ public:
 
   void register_result(Result_impl *result)
   {
+    auto guard = lock_exec();
     assert(!m_current_result);
     m_current_result = result;
   }
 
   void deregister_result(Result_impl *result)
   {
+    // Note: results can be destroyed on any thread in concurrent-reads
+    // mode, so the registration is protected by the execution gate.
+
+    auto guard = lock_exec();
     if (result == m_current_result)
       m_current_result = nullptr;
   }
@@ -371,6 +1942,84 @@ public:
   }
 
 
+  /*
+    Transaction batch mode (see Session_detail::start_transaction()).
+
+    In batch mode begin/commit commands are sent to the server without
+    waiting for their replies, so that they travel in the same network
+    round-trip as the statements which follow them. Replies to such
+    commands are kept here until their status can be examined - server
+    errors are re-thrown at the next transaction boundary.
+  */
+
+  bool m_trx_batch = false;
+
+  std::list<std::unique_ptr<cdk::Reply>> m_trx_pipeline;
+
+  /*
+    Send a transaction control command without waiting for its reply.
+  */
+
+  void pipeline_trx_cmd(const char *qry)
+  {
+    check_trx_pipeline(false);
+    prepare_for_cmd();
+    m_trx_pipeline.emplace_back(
+      new cdk::Reply(m_sess->sql(0, qry, nullptr))
+    );
+  }
+
+  /*
+    Send a session-scoped SQL command (e.g. a SET statement wrapped
+    around a hinted statement, see Op_base::init()) without waiting for
+    its reply. Reuses the transaction pipeline machinery: the reply
+    travels with the surrounding commands' round trip and server errors
+    are re-thrown at the next transaction boundary.
+  */
+
+  void pipeline_session_cmd(const std::string &qry)
+  {
+    pipeline_trx_cmd(qry.c_str());
+  }
+
+  /*
+    Examine replies to pipelined transaction commands, re-throwing server
+    errors. If `wait_all` is false only replies which have already completed
+    are examined, otherwise the call blocks until all of them are complete.
+  */
+
+  void check_trx_pipeline(bool wait_all)
+  {
+    /*
+      Waiting for a pipelined transaction command requires its command to
+      be on the wire - flush a pending submit batch first.
+    */
+
+    if (wait_all && !m_trx_pipeline.empty())
+      flush_submit_batch();
+
+    while (!m_trx_pipeline.empty())
+    {
+      cdk::Reply &reply = *m_trx_pipeline.front();
+
+      if (wait_all)
+        reply.wait();
+      else
+      {
+        reply.cont();
+        if (!reply.is_completed())
+          return;
+      }
+
+      std::unique_ptr<cdk::Reply> done(std::move(m_trx_pipeline.front()));
+      m_trx_pipeline.pop_front();
+
+      if (done->entry_count())
+        done->get_error().rethrow();
+    }
+  }
+
+
   /*
     Return a non-used prepared statement id. If possible, re-uses previously
     allocated ids that are no longer in use.
@@ -384,10 +2033,18 @@ public:
       m_max_pstmt when a error occur on prepare), it will return 0, so no PS
       possible.
     */
-    if (m_sess->has_prepared_statements().state() == cdk::option_t::NO ||
-      m_stmt_id.size() >= m_max_pstmt)
+    if (m_sess->has_prepared_statements().state() == cdk::option_t::NO)
       return  0;
 
+    /*
+      Under slot pressure, demote the coldest auto-prepared shape whose
+      statement is no longer used by any operation, so that its slot can
+      be re-used by the statement being prepared now.
+    */
+
+    if (m_stmt_id.size() >= m_max_pstmt && !demote_cold_shape())
+      return 0;
+
     uint32_t val = 1;
     if (!m_stmt_id_cleanup.empty())
     {
@@ -420,6 +2077,7 @@ public:
   {
     m_stmt_id.erase(id);
     m_stmt_id_cleanup.insert(id);
+    m_mdata_cache.erase(id);
   }
 
   /*
@@ -430,6 +2088,262 @@ public:
   {
     m_stmt_id.erase(id);
     m_max_pstmt = m_stmt_id.size();
+    m_mdata_cache.erase(id);
+  }
+
+  /*
+    Access result meta-data cached for the given PS id (null if none is
+    cached).
+  */
+
+  std::shared_ptr<impl::common::Meta_data> cached_mdata(uint32_t id) const
+  {
+    auto it = m_mdata_cache.find(id);
+    return m_mdata_cache.end() != it
+           ? it->second : std::shared_ptr<impl::common::Meta_data>();
+  }
+
+  void cache_mdata(uint32_t id, const std::shared_ptr<impl::common::Meta_data> &mdata)
+  {
+    if (0 != id)
+      m_mdata_cache[id] = mdata;
+  }
+
+  enum Pstmt_shape { SHAPE_NEW, SHAPE_SEEN, SHAPE_PREPARED };
+
+  /*
+    Look up the given statement shape in the cache (see m_pstmt_cache).
+
+    Returns SHAPE_NEW if the shape was not seen before (the statement should
+    be executed directly), SHAPE_SEEN if it was seen but no statement was
+    prepared for it yet (the statement should be prepared now) and
+    SHAPE_PREPARED if a prepared statement exists - in the last case its
+    shared id is stored in `id`.
+  */
+
+  Pstmt_shape check_stmt_shape(
+    const std::string &key, std::shared_ptr<uint32_t> &id
+  )
+  {
+    auto it = m_pstmt_cache.find(key);
+
+    if (m_pstmt_cache.end() == it)
+    {
+      if (m_pstmt_cache.size() >= m_pstmt_cache_max)
+        drop_stmt_shape(m_pstmt_lru.back());
+
+      m_pstmt_lru.push_front(key);
+      auto &entry = m_pstmt_cache[key];
+      entry.pos = m_pstmt_lru.begin();
+      entry.hits = 1;
+
+      /*
+        The first shape executed on a session identifies its workload -
+        use its hash as the session's affinity hint, so that after the
+        session is released checkouts for the same shape are routed back
+        to it (see Session_pool::get_session()).
+      */
+
+      if (0 == m_sess.affinity())
+        m_sess.set_affinity(std::hash<std::string>()(key));
+
+      /*
+        If the shape is already known to be hot in another session of the
+        same client, skip the direct warm-up executions and prepare the
+        statement on this session's first execution - only the server-side
+        statement id stays per-session.
+      */
+
+      auto pool = m_sess.get_pool();
+      if (pool && pool->is_hot_shape(key))
+        return SHAPE_SEEN;
+
+      return 1 > m_prepare_threshold ? SHAPE_SEEN : SHAPE_NEW;
+    }
+
+    m_pstmt_lru.splice(m_pstmt_lru.begin(), m_pstmt_lru, it->second.pos);
+
+    if (!it->second.id || 0 == *it->second.id)
+    {
+      /*
+        A shape is promoted to a server-side prepared statement only after
+        it was executed directly m_prepare_threshold times - one-off
+        queries then never consume a prepared-statement slot.
+      */
+
+      if (++it->second.hits <= m_prepare_threshold)
+        return SHAPE_NEW;
+
+      return SHAPE_SEEN;
+    }
+
+    id = it->second.id;
+    return SHAPE_PREPARED;
+  }
+
+  /*
+    Store the id of a statement prepared for the given shape (this also
+    refreshes the entry in the LRU order).
+  */
+
+  void publish_stmt_shape(
+    const std::string &key, const std::shared_ptr<uint32_t> &id
+  )
+  {
+    auto it = m_pstmt_cache.find(key);
+
+    // Note: the entry could have been evicted in the meantime.
+
+    if (m_pstmt_cache.end() == it)
+      return;
+
+    it->second.id = id;
+    m_pstmt_lru.splice(m_pstmt_lru.begin(), m_pstmt_lru, it->second.pos);
+
+    /*
+      A prepared shape is hot by definition - share that knowledge with
+      the other sessions of the same client.
+    */
+
+    if (auto pool = m_sess.get_pool())
+      pool->mark_hot_shape(key);
+  }
+
+  /*
+    Remove the given shape from the cache. Used when the corresponding
+    prepared statement errors out or when the entry is evicted.
+  */
+
+  void drop_stmt_shape(const std::string &key)
+  {
+    auto it = m_pstmt_cache.find(key);
+
+    if (m_pstmt_cache.end() == it)
+      return;
+
+    /*
+      If the cache is the only owner of the statement id, no operation uses
+      the server-side statement any more and it can be de-allocated.
+    */
+
+    if (it->second.id && it->second.id.unique() && 0 != *it->second.id)
+      release_stmt_id(*it->second.id);
+
+    m_pstmt_lru.erase(it->second.pos);
+    m_pstmt_cache.erase(it);
+  }
+
+  /*
+    Demote the least recently used prepared shape whose server-side
+    statement is not in use by any operation, releasing its statement
+    slot. Returns true if a slot was freed. Called when a statement
+    should be prepared but all prepared-statement slots are taken (see
+    create_stmt_id()).
+  */
+
+  bool demote_cold_shape()
+  {
+    for (auto pos = m_pstmt_lru.rbegin(); pos != m_pstmt_lru.rend(); ++pos)
+    {
+      auto it = m_pstmt_cache.find(*pos);
+
+      if (m_pstmt_cache.end() == it)
+        continue;
+
+      auto &id = it->second.id;
+
+      if (id && id.unique() && 0 != *id)
+      {
+        drop_stmt_shape(*pos);
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  /*
+    Look up a stored expression (see m_expr_cache). The key should combine
+    the parser mode with the expression source string. Returns null pointer
+    if no expression is stored under the given key.
+  */
+
+  std::shared_ptr<impl::common::Stored_expr>
+  find_stored_expr(const std::string &key)
+  {
+    auto it = m_expr_cache.find(key);
+    if (m_expr_cache.end() != it)
+      return it->second;
+
+    /*
+      Fall back to the client-wide cache - an expression parsed by any
+      session of the same pool can be replayed here. A hit is remembered
+      locally so that later look-ups do not take the pool's cache mutex.
+    */
+
+    auto pool = m_sess.get_pool();
+    if (!pool)
+      return std::shared_ptr<impl::common::Stored_expr>();
+
+    auto expr = pool->find_shared_expr(key);
+
+    if (expr && m_expr_cache.size() < m_expr_cache_max)
+      m_expr_cache[key] = expr;
+
+    return expr;
+  }
+
+  void store_expr(
+    const std::string &key,
+    const std::shared_ptr<impl::common::Stored_expr> &expr
+  )
+  {
+    /*
+      Note: When the cache overflows it is simply dropped - the cost is one
+      re-parse per distinct expression used after that.
+    */
+
+    if (m_expr_cache.size() >= m_expr_cache_max)
+      m_expr_cache.clear();
+
+    m_expr_cache[key] = expr;
+
+    // Share the parsed tree with the other sessions of the same client.
+
+    if (auto pool = m_sess.get_pool())
+      pool->share_expr(key, expr);
+  }
+
+  /*
+    Read-your-writes support: pipeline a command which makes the server
+    wait until the given GTID set has been applied before executing the
+    statements which follow. The command is sent without waiting for its
+    reply, so it travels in the same network round trip as the next
+    statement on this session; its reply is examined together with the
+    pipelined transaction commands (see check_trx_pipeline()). A timeout
+    of 0 waits without limit. With a non-zero timeout an expired wait
+    does not fail the following statements - the server simply stops
+    waiting and executes them.
+  */
+
+  void pipeline_gtid_wait(const std::string &gtids, uint64_t timeout_sec)
+  {
+    /*
+      GTID sets consist of hex digits, dashes, colons, commas and
+      interval separators - anything else would break the quoting below.
+    */
+
+    if (std::string::npos != gtids.find_first_not_of(
+          "0123456789abcdefABCDEF-:,. \n"))
+      common::throw_error("Invalid GTID set");
+
+    std::string cmd("DO WAIT_FOR_EXECUTED_GTID_SET('");
+    cmd += gtids;
+    cmd += "', ";
+    cmd += std::to_string(timeout_sec);
+    cmd += ")";
+
+    pipeline_trx_cmd(cmd.c_str());
   }
 
   /*
@@ -454,9 +2368,52 @@ public:
 
   void release();
 
+  /*
+    Number of logical session handles sharing this implementation (see
+    devapi Session::multiplex()). The underlying connection is released
+    only when the last handle is closed (see Session_detail::close()).
+    Note: result objects keep the implementation alive through their
+    shared pointers but are not owners in this sense.
+  */
+
+  std::atomic<unsigned> m_logical_owners{1};
+
+  void add_logical_owner()
+  {
+    ++m_logical_owners;
+  }
+
+  // Returns true when the last logical owner is gone.
+
+  bool remove_logical_owner()
+  {
+    return 0 == --m_logical_owners;
+  }
+
   void cleanup() override
   {
+    /*
+      Commands coalesced by submit batching but never flushed are
+      discarded - nothing ever asked for their results.
+    */
+
+    if (m_submit_batch)
+    {
+      m_submit_batch = false;
+      m_submit_pending = 0;
+      m_sess->clear_pipeline();
+    }
+
     prepare_for_cmd();
+
+    /*
+      Drop replies to pipelined transaction commands without examining
+      them - the session is being closed or returned to the pool, so the
+      transaction is abandoned anyway.
+    */
+
+    m_trx_batch = false;
+    m_trx_pipeline.clear();
   }
 };
 
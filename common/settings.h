@@ -107,14 +107,14 @@ public:
 
   Setter(Settings_impl &settings)
     : m_settings(settings)
-    , m_data(settings.m_data)
+    , m_data(*settings.m_data)
   {}
 
 
   void set_client_opts(const Settings_impl &opts)
   {
     Setter set(*this);
-    for (auto &opt_val : opts.m_data.m_options)
+    for (auto &opt_val : opts.m_data->m_options)
     {
       set.add_option(opt_val.first, opt_val.second);
     }
@@ -171,8 +171,8 @@ public:
     */
 
     if (
-      m_data.m_tcpip && m_settings.m_data.m_tcpip
-      && 0 == m_settings.m_data.m_host_cnt
+      m_data.m_tcpip && m_settings.m_data->m_tcpip
+      && 0 == m_settings.m_data->m_host_cnt
     )
       throw_error("PORT without explicit HOST in multi-host settings");
 
@@ -189,7 +189,8 @@ public:
       object.
     */
 
-    m_settings.m_data = std::move(m_data);
+    m_settings.m_data = std::make_shared<Data>(std::move(m_data));
+    m_settings.m_cached_source.reset();
   }
 
   // JSON doc processor
@@ -526,6 +527,8 @@ private:
         return m_setter.key_val(Client_option_impl::POOL_QUEUE_TIMEOUT);
       else if (upper_key == "MAXIDLETIME")
         return m_setter.key_val(Client_option_impl::POOL_MAX_IDLE_TIME);
+      else if (upper_key == "MINSIZE")
+        return m_setter.key_val(Client_option_impl::POOL_MIN_SIZE);
 
       std::string msg = "Invalid pooling option: " + key;
       throw_error(msg.c_str());
@@ -0,0 +1,541 @@
+/*
+ * Copyright (c) 2020, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef MYSQLX_COMMON_STORED_EXPR_H
+#define MYSQLX_COMMON_STORED_EXPR_H
+
+#include "common.h"
+#include "db_object.h"
+
+#include <mysql/cdk.h>
+#include <expr_parser.h>
+
+PUSH_SYS_WARNINGS
+#include <list>
+#include <memory>
+#include <vector>
+POP_SYS_WARNINGS
+
+
+namespace mysqlx {
+namespace impl {
+namespace common {
+
+/*
+  Materialized form of a cdk expression.
+
+  Class Stored_expr records the processor events produced by one pass over
+  a cdk::Expression - such as a parser::Expression_parser parsing its source
+  string - into a tree of nodes, and can replay them any number of times.
+  It follows the same record/replay pattern as cdk::Doc_path_storage.
+
+  This is used to avoid re-parsing expression strings when a statement is
+  executed repeatedly: the tree built on the first execution is kept in
+  a session-level cache keyed by the source string and replayed by later
+  executions (see Op_select::get_where()).
+
+  A stored expression can also be replayed as a document expression
+  (cdk::Expression::Document), provided that the recorded expression is
+  a document - this is used for document projections (see Op_projection).
+
+  Note: literal values reported through Value_processor::value() are
+  stored as plain bytes and replayed with the trivial parser::Format_info
+  format. This matches what the expression parser reports (it uses this
+  format for all such literals), but events from a source which uses
+  a stateful encoding format would not be replayed exactly.
+*/
+
+class Stored_expr
+  : public cdk::Expression
+  , public cdk::Expression::Document
+{
+protected:
+
+  /*
+    Single node of the stored expression tree. Which of the payload members
+    are used depends on the node type.
+  */
+
+  struct Node
+  {
+    enum Type {
+      NUL,        // null literal
+      STR,        // string literal (m_str)
+      INT,        // signed integer literal (m_int)
+      UINT,       // unsigned integer literal (m_uint)
+      FLT,        // float literal (m_flt)
+      DBL,        // double literal (m_dbl)
+      BOOL,       // Boolean literal (m_bool)
+      RAW,        // literal of type m_vtype encoded as bytes (m_bytes)
+      OP,         // operator (m_name) applied to arguments (m_args)
+      CALL,       // call of function m_obj with arguments (m_args)
+      COL_REF,    // column reference (m_col, optionally m_path)
+      PATH_REF,   // document path reference (m_path)
+      PARAM_NAME, // named parameter (m_str)
+      PARAM_POS,  // positional parameter (m_pos)
+      VAR,        // variable reference (m_str)
+      ARR,        // array with elements m_args
+      DOC         // document with key-value pairs m_pairs
+    }
+    m_type = NUL;
+
+    cdk::string m_str;
+    std::string m_name;
+    int64_t     m_int = 0;
+    uint64_t    m_uint = 0;
+    float       m_flt = 0;
+    double      m_dbl = 0;
+    bool        m_bool = false;
+    uint16_t    m_pos = 0;
+
+    cdk::Type_info  m_vtype = cdk::TYPE_BYTES;
+    std::string     m_bytes;
+
+    /*
+      Storage for a table or function call reference with optional schema.
+
+      Note: Unlike common::Object_ref, this reports no schema sub-object
+      at all if the recorded reference had none, so that the replay is
+      identical to the original event.
+    */
+
+    struct Obj_ref : public cdk::api::Object_ref
+    {
+      cdk::string m_obj_name;
+      std::unique_ptr<Schema_ref> m_schema;
+
+      const cdk::string name() const override { return m_obj_name; }
+      const cdk::api::Schema_ref* schema() const override
+      { return m_schema.get(); }
+
+      void set(const cdk::api::Object_ref &obj)
+      {
+        m_obj_name = obj.name();
+        if (obj.schema())
+          m_schema.reset(new Schema_ref(obj.schema()->name()));
+      }
+    };
+
+    // Storage for a column reference [[schema.]table.]name.
+
+    struct Col_ref : public cdk::api::Column_ref
+    {
+      cdk::string m_col_name;
+      std::unique_ptr<Obj_ref> m_table;
+
+      const cdk::string name() const override { return m_col_name; }
+      const cdk::api::Table_ref* table() const override
+      { return m_table.get(); }
+
+      void set(const cdk::api::Column_ref &col)
+      {
+        m_col_name = col.name();
+        if (col.table())
+        {
+          m_table.reset(new Obj_ref());
+          m_table->set(*col.table());
+        }
+      }
+    }
+    m_col;
+
+    // Storage for a function call target.
+
+    std::unique_ptr<Obj_ref> m_obj;
+
+    cdk::Doc_path_storage m_path;
+    bool m_has_path = false;
+
+    std::vector<std::unique_ptr<Node>> m_args;
+    std::vector<std::pair<cdk::string, std::unique_ptr<Node>>> m_pairs;
+  };
+
+
+  /*
+    Processor which records events reported for a single expression node.
+    Events of sub-expressions (operator arguments, array elements, document
+    values) are recorded by child builders whose life-time spans the whole
+    recording.
+  */
+
+  struct Builder
+    : public cdk::Expression::Processor
+    , cdk::Expr_processor
+    , cdk::Value_processor
+    , cdk::Expression::Processor::List_prc
+    , cdk::Expression::Document::Processor
+  {
+    typedef cdk::string string;
+
+    Node &m_node;
+    std::list<Builder> m_kids;
+
+    Builder(Node &node) : m_node(node)
+    {}
+
+    Builder* add_child(std::vector<std::unique_ptr<Node>> &nodes)
+    {
+      nodes.emplace_back(new Node());
+      m_kids.emplace_back(*nodes.back());
+      return &m_kids.back();
+    }
+
+    // Any processor
+
+    Scalar_prc* scalar() override { return this; }
+
+    List_prc* arr() override
+    {
+      m_node.m_type = Node::ARR;
+      return this;
+    }
+
+    Doc_prc* doc() override
+    {
+      m_node.m_type = Node::DOC;
+      return this;
+    }
+
+    // Expr_processor
+
+    Value_prc* val() override { return this; }
+
+    Args_prc* op(const char *name) override
+    {
+      m_node.m_type = Node::OP;
+      m_node.m_name = name;
+      return this;
+    }
+
+    Args_prc* call(const Object_ref &obj) override
+    {
+      m_node.m_type = Node::CALL;
+      m_node.m_obj.reset(new Node::Obj_ref());
+      m_node.m_obj->set(obj);
+      return this;
+    }
+
+    void ref(const Column_ref &col, const Doc_path *path) override
+    {
+      m_node.m_type = Node::COL_REF;
+      m_node.m_col.set(col);
+      if (path)
+      {
+        m_node.m_has_path = true;
+        path->process(m_node.m_path);
+      }
+    }
+
+    void ref(const Doc_path &path) override
+    {
+      m_node.m_type = Node::PATH_REF;
+      path.process(m_node.m_path);
+    }
+
+    void param(const string &name) override
+    {
+      m_node.m_type = Node::PARAM_NAME;
+      m_node.m_str = name;
+    }
+
+    void param(uint16_t pos) override
+    {
+      m_node.m_type = Node::PARAM_POS;
+      m_node.m_pos = pos;
+    }
+
+    void var(const string &name) override
+    {
+      m_node.m_type = Node::VAR;
+      m_node.m_str = name;
+    }
+
+    // Value_processor
+
+    void null() override { m_node.m_type = Node::NUL; }
+
+    void value(
+      cdk::Type_info type, const cdk::Format_info&, cdk::bytes data
+    ) override
+    {
+      // Note: the encoding format is not stored, see the note in the class
+      // description.
+
+      m_node.m_type = Node::RAW;
+      m_node.m_vtype = type;
+      m_node.m_bytes.assign(data.begin(), data.end());
+    }
+
+    void str(const string &val) override
+    {
+      m_node.m_type = Node::STR;
+      m_node.m_str = val;
+    }
+
+    void num(int64_t val) override
+    {
+      m_node.m_type = Node::INT;
+      m_node.m_int = val;
+    }
+
+    void num(uint64_t val) override
+    {
+      m_node.m_type = Node::UINT;
+      m_node.m_uint = val;
+    }
+
+    void num(float val) override
+    {
+      m_node.m_type = Node::FLT;
+      m_node.m_flt = val;
+    }
+
+    void num(double val) override
+    {
+      m_node.m_type = Node::DBL;
+      m_node.m_dbl = val;
+    }
+
+    void yesno(bool val) override
+    {
+      m_node.m_type = Node::BOOL;
+      m_node.m_bool = val;
+    }
+
+    // List processor (operator/call arguments and array elements)
+
+    Element_prc* list_el() override
+    {
+      return add_child(m_node.m_args);
+    }
+
+    // Document processor
+
+    Any_prc* key_val(const string &key) override
+    {
+      PUSH_SYS_WARNINGS
+      m_node.m_pairs.emplace_back(key, std::unique_ptr<Node>(new Node()));
+      POP_SYS_WARNINGS
+      m_kids.emplace_back(*m_node.m_pairs.back().second);
+      return &m_kids.back();
+    }
+  };
+
+
+  Node m_root;
+
+  static void replay(const Node&, cdk::Expression::Processor&);
+  static void replay_doc(const Node&, cdk::Expression::Document::Processor&);
+
+public:
+
+  explicit Stored_expr(const cdk::Expression &src)
+  {
+    Builder bld(m_root);
+    src.process(bld);
+  }
+
+  /*
+    Record a document expression source. The root node is a document
+    whose key-value pairs are reported directly to the builder.
+  */
+
+  explicit Stored_expr(const cdk::Expression::Document &src)
+  {
+    Builder bld(m_root);
+    bld.doc();
+    src.process(bld);
+  }
+
+  // cdk::Expression
+
+  void process(cdk::Expression::Processor &prc) const override
+  {
+    replay(m_root, prc);
+  }
+
+  /*
+    cdk::Expression::Document
+
+    The stored expression must be a document in this case (this is checked
+    when a document projection is processed, see Op_projection).
+  */
+
+  void process(cdk::Expression::Document::Processor &prc) const override
+  {
+    if (Node::ARR == m_root.m_type)
+      common::throw_error("Array expression can not be used as projection");
+    if (Node::DOC != m_root.m_type)
+      common::throw_error("Scalar expression can not be used as projection");
+    replay_doc(m_root, prc);
+  }
+
+  bool is_document() const
+  {
+    return Node::DOC == m_root.m_type;
+  }
+};
+
+
+inline
+void Stored_expr::replay_doc(
+  const Node &node, cdk::Expression::Document::Processor &prc
+)
+{
+  prc.doc_begin();
+
+  for (const auto &pair : node.m_pairs)
+  {
+    auto *vprc = prc.key_val(pair.first);
+    if (vprc)
+      replay(*pair.second, *vprc);
+  }
+
+  prc.doc_end();
+}
+
+
+inline
+void Stored_expr::replay(const Node &node, cdk::Expression::Processor &prc)
+{
+  switch (node.m_type)
+  {
+  case Node::ARR:
+    {
+      auto *lprc = prc.arr();
+      if (!lprc)
+        return;
+
+      lprc->list_begin();
+
+      for (const auto &el : node.m_args)
+      {
+        auto *eprc = lprc->list_el();
+        if (eprc)
+          replay(*el, *eprc);
+      }
+
+      lprc->list_end();
+    }
+    return;
+
+  case Node::DOC:
+    {
+      auto *dprc = prc.doc();
+      if (dprc)
+        replay_doc(node, *dprc);
+    }
+    return;
+
+  default:
+    break;
+  }
+
+  auto *sprc = prc.scalar();
+  if (!sprc)
+    return;
+
+  switch (node.m_type)
+  {
+  case Node::OP:
+  case Node::CALL:
+    {
+      auto *aprc = Node::OP == node.m_type
+                   ? sprc->op(node.m_name.c_str())
+                   : sprc->call(*node.m_obj);
+      if (!aprc)
+        return;
+
+      aprc->list_begin();
+
+      for (const auto &arg : node.m_args)
+      {
+        auto *eprc = aprc->list_el();
+        if (eprc)
+          replay(*arg, *eprc);
+      }
+
+      aprc->list_end();
+    }
+    return;
+
+  case Node::COL_REF:
+    sprc->ref(node.m_col, node.m_has_path ? &node.m_path : nullptr);
+    return;
+
+  case Node::PATH_REF:
+    sprc->ref(node.m_path);
+    return;
+
+  case Node::PARAM_NAME:
+    sprc->param(node.m_str);
+    return;
+
+  case Node::PARAM_POS:
+    sprc->param(node.m_pos);
+    return;
+
+  case Node::VAR:
+    sprc->var(node.m_str);
+    return;
+
+  default:
+    break;
+  }
+
+  auto *vprc = sprc->val();
+  if (!vprc)
+    return;
+
+  switch (node.m_type)
+  {
+  case Node::NUL:  vprc->null(); return;
+  case Node::STR:  vprc->str(node.m_str); return;
+  case Node::INT:  vprc->num(node.m_int); return;
+  case Node::UINT: vprc->num(node.m_uint); return;
+  case Node::FLT:  vprc->num(node.m_flt); return;
+  case Node::DBL:  vprc->num(node.m_dbl); return;
+  case Node::BOOL: vprc->yesno(node.m_bool); return;
+
+  case Node::RAW:
+    vprc->value(
+      node.m_vtype, parser::Format_info(), cdk::bytes(node.m_bytes)
+    );
+    return;
+
+  default: return;  // GCOV_EXCL_LINE
+  }
+}
+
+}  // common
+}  // impl
+}  // mysqlx
+
+#endif
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2021, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef MYSQLX_COMMON_TREE_EXPR_H
+#define MYSQLX_COMMON_TREE_EXPR_H
+
+#include "common.h"
+#include "value.h"
+#include "db_object.h"
+
+#include <mysql/cdk.h>
+
+PUSH_SYS_WARNINGS
+#include <memory>
+#include <vector>
+POP_SYS_WARNINGS
+
+
+namespace mysqlx {
+namespace impl {
+namespace common {
+
+/*
+  Adapter which presents an expression tree built with the typed expression
+  builder API (class mysqlx::Expr of DevAPI) as a cdk expression.
+
+  Class Tree_expr walks a tree of common::Expr_node nodes and reports it
+  through cdk::Expression processor callbacks - the same interface which
+  Stored_expr replays and which the protocol layer consumes. Contrary to
+  expression strings passed to set_where(), nothing is parsed on this path.
+
+  The tree is built by user code and can be shared between statements and
+  their copies - it is never modified after construction.
+*/
+
+class Tree_expr
+  : public cdk::Expression
+{
+  std::shared_ptr<const Expr_node> m_root;
+
+  /*
+    Present the path members of a FIELD or COLUMN node as a cdk document
+    path. An empty member list denotes the whole document ("$").
+  */
+
+  struct Field_path : public cdk::api::Doc_path
+  {
+    const std::vector<std::string> &m_path;
+
+    Field_path(const std::vector<std::string> &path)
+      : m_path(path)
+    {}
+
+    void process(Processor &prc) const override
+    {
+      if (m_path.empty())
+      {
+        prc.whole_document();
+        return;
+      }
+
+      prc.list_begin();
+
+      for (const auto &member : m_path)
+      {
+        auto *eprc = prc.list_el();
+        if (eprc)
+          eprc->member(member);
+      }
+
+      prc.list_end();
+    }
+  };
+
+  // Present a FUNC node as a function call target [schema.]name.
+
+  struct Obj_ref : public cdk::api::Object_ref
+  {
+    const Expr_node &m_node;
+    Schema_ref m_schema;
+
+    Obj_ref(const Expr_node &node)
+      : m_node(node), m_schema(node.m_schema)
+    {}
+
+    const cdk::string name() const override
+    { return m_node.m_name; }
+
+    const cdk::api::Schema_ref* schema() const override
+    { return m_node.m_schema.empty() ? nullptr : &m_schema; }
+  };
+
+  // Present a COLUMN node as a column reference [[schema.]table.]name.
+
+  struct Col_ref : public cdk::api::Column_ref
+  {
+    const Expr_node &m_node;
+
+    struct Tab_ref : public cdk::api::Table_ref
+    {
+      const Expr_node &m_node;
+      Schema_ref m_schema;
+
+      Tab_ref(const Expr_node &node)
+        : m_node(node), m_schema(node.m_schema)
+      {}
+
+      const cdk::string name() const override
+      { return m_node.m_table; }
+
+      const cdk::api::Schema_ref* schema() const override
+      { return m_node.m_schema.empty() ? nullptr : &m_schema; }
+    }
+    m_table;
+
+    Col_ref(const Expr_node &node)
+      : m_node(node), m_table(node)
+    {}
+
+    const cdk::string name() const override
+    { return m_node.m_name; }
+
+    const cdk::api::Table_ref* table() const override
+    { return m_node.m_table.empty() ? nullptr : &m_table; }
+  };
+
+  static void replay(const Expr_node&, cdk::Expression::Processor&);
+
+public:
+
+  explicit Tree_expr(std::shared_ptr<const Expr_node> root)
+    : m_root(std::move(root))
+  {}
+
+  void process(cdk::Expression::Processor &prc) const override
+  {
+    if (m_root)
+      replay(*m_root, prc);
+  }
+};
+
+
+inline
+void Tree_expr::replay(const Expr_node &node, cdk::Expression::Processor &prc)
+{
+  if (Expr_node::ARRAY == node.m_kind)
+  {
+    auto *lprc = prc.arr();
+    if (!lprc)
+      return;
+
+    lprc->list_begin();
+
+    for (const auto &el : node.m_args)
+    {
+      auto *eprc = lprc->list_el();
+      if (eprc && el)
+        replay(*el, *eprc);
+    }
+
+    lprc->list_end();
+    return;
+  }
+
+  auto *sprc = prc.scalar();
+  if (!sprc)
+    return;
+
+  switch (node.m_kind)
+  {
+  case Expr_node::OP:
+  case Expr_node::FUNC:
+    {
+      cdk::Expr_processor::Args_prc *aprc;
+
+      if (Expr_node::OP == node.m_kind)
+        aprc = sprc->op(node.m_name.c_str());
+      else
+      {
+        Obj_ref obj(node);
+        aprc = sprc->call(obj);
+      }
+
+      if (!aprc)
+        return;
+
+      aprc->list_begin();
+
+      for (const auto &arg : node.m_args)
+      {
+        auto *eprc = aprc->list_el();
+        if (eprc && arg)
+          replay(*arg, *eprc);
+      }
+
+      aprc->list_end();
+    }
+    return;
+
+  case Expr_node::COLUMN:
+    {
+      Col_ref col(node);
+
+      if (node.m_path.empty())
+        sprc->ref(col, nullptr);
+      else
+      {
+        Field_path path(node.m_path);
+        sprc->ref(col, &path);
+      }
+    }
+    return;
+
+  case Expr_node::FIELD:
+    {
+      Field_path path(node.m_path);
+      sprc->ref(path);
+    }
+    return;
+
+  case Expr_node::PARAM:
+    sprc->param(cdk::string(node.m_name));
+    return;
+
+  default:  // LITERAL
+    {
+      auto *vprc = sprc->val();
+      if (vprc)
+        Value::Access::process_val(node.m_value, *vprc);
+    }
+    return;
+  }
+}
+
+}  // common
+}  // impl
+}  // mysqlx
+
+#endif
@@ -52,9 +52,22 @@ void Value::print(std::ostream &out) const
   case DOUBLE: out << m_val.v_double; return;
   case FLOAT: out << m_val.v_float; return;
   case BOOL: out << (m_val.v_bool ? "true" : "false"); return;
-  case STRING: out << m_str; return;
-  case USTRING: out << cdk::string(m_ustr); return;
-  case RAW: out << "<" << m_str.length() << " raw bytes>"; return;
+  case STRING: out << m_store.str; return;
+  case USTRING: out << cdk::string(m_store.ustr); return;
+  case RAW:
+    /*
+      Short byte sequences are printed as hex, for longer ones only
+      the length is shown.
+    */
+    if (m_store.str.length() <= 32)
+    {
+      std::string hex("0x");
+      auto *beg = (const cdk::byte*)m_store.str.data();
+      cdk::foundation::hex_encode(beg, beg + m_store.str.length(), hex);
+      out << hex;
+      return;
+    }
+    out << "<" << m_store.str.length() << " raw bytes>"; return;
   default:  out << "<unknown value>"; return;
   }
 }
@@ -88,8 +101,8 @@ void Value::Access::process_val(
     case Value::FLOAT:   prc.num(val.get_float()); break;
     case Value::DOUBLE:  prc.num(val.get_double()); break;
     case Value::BOOL:    prc.yesno(val.get_bool()); break;
-    case Value::STRING:  prc.str(val.m_str); break;
-    case Value::USTRING:  prc.str(val.m_ustr); break;
+    case Value::STRING:  prc.str(val.get_string()); break;
+    case Value::USTRING:  prc.str(val.get_ustring()); break;
     case Value::RAW:
     {
       size_t size;
@@ -136,23 +149,28 @@ const std::string& Value::get_string() const
   switch (m_type)
   {
   case USTRING:
+  case RAW:
+  case STRING:
+  case EXPR:
+  case JSON:
 
-    // UTF8 conversion
+    if (STR_UTF8 == m_tag)
+      return m_store.str;
 
-    if (!m_val.v_bool)
+    if (STR_UTF16 == m_tag)
     {
-      const_cast<Value*>(this)->m_str = cdk::string(m_ustr);
-      const_cast<Value*>(this)->m_val.v_bool = true;
+      // UTF8 conversion, done once and kept in the conversion cache.
+
+      if (!m_conv)
+      {
+        std::string conv = cdk::string(m_store.ustr);
+        m_conv = new std::string(std::move(conv));
+      }
+      return *(const std::string*)m_conv;
     }
 
     FALLTHROUGH;
 
-  case RAW:
-  case STRING:
-  case EXPR:
-  case JSON:
-    return m_str;
-
   default:
     throw Error("Value cannot be converted to string");
   }
@@ -167,20 +185,23 @@ const std::u16string& Value::get_ustring() const
   case JSON:
   case RAW:
   case STRING:
+  case USTRING:
 
-    // UTF8 conversion
+    if (STR_UTF16 == m_tag)
+      return m_store.ustr;
 
-    if (!m_val.v_bool)
+    if (STR_UTF8 == m_tag)
     {
-      const_cast<Value*>(this)->m_ustr = cdk::string(m_str);
-      const_cast<Value*>(this)->m_val.v_bool = true;
+      // UTF16 conversion, done once and kept in the conversion cache.
+
+      if (!m_conv)
+        m_conv = new std::u16string(cdk::string(m_store.str));
+
+      return *(const std::u16string*)m_conv;
     }
 
     FALLTHROUGH;
 
-  case USTRING:
-    return m_ustr;
-
   default:
     throw Error("Value cannot be converted to string");
   }
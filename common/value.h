@@ -58,16 +58,32 @@ struct Value::Access
     return (std::u16string)str;
   }
 
+  static Value mk_str(cdk::string &&str)
+  {
+    // Note: cdk::string derives from std::u16string.
+    return std::move(str);
+  }
+
   static Value mk_expr(const string &expr)
   {
     return { Value::EXPR, expr };
   }
 
+  static Value mk_expr(string &&expr)
+  {
+    return { Value::EXPR, std::move(expr) };
+  }
+
   static Value mk_json(const string &json)
   {
     return { Value::JSON, json };
   }
 
+  static Value mk_json(string &&json)
+  {
+    return { Value::JSON, std::move(json) };
+  }
+
   // Create value from raw bytes, given CDK format description.
 
   template<cdk::Type_info T>
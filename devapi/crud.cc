@@ -32,6 +32,7 @@
 
 PUSH_SYS_WARNINGS
 #include <time.h>
+#include <cstring>  // memchr() in TableBulkLoad
 #include <forward_list>
 #include <list>
 POP_SYS_WARNINGS
@@ -73,6 +74,91 @@ auto Crud_factory::mk_add(Collection &coll) -> Impl*
 }
 
 
+/*
+  Trusted-input document path used by CollectionAdd::addRaw().
+
+  Instead of the character encoding conversion done for documents added
+  via add(), only a cheap structural scan of the JSON text is performed:
+  the top-level value must be an object and quotes (with escape handling)
+  and brackets must balance. Anything beyond that is left for the server
+  to verify when the document is inserted.
+*/
+
+void Collection_add_detail::add_raw(Impl *impl, const char *json, size_t len)
+{
+  assert(impl);
+
+  const unsigned max_depth = 100;
+  char stack[max_depth];
+  unsigned depth = 0;
+  bool in_str = false;
+  const char *beg = json;
+  const char *end = json + len;
+
+  while (beg < end
+         && (' ' == *beg || '\t' == *beg || '\r' == *beg || '\n' == *beg))
+    ++beg;
+
+  if (beg == end || '{' != *beg)
+    throw Error("Raw document must be a JSON object");
+
+  for (const char *pos = beg; pos < end; ++pos)
+  {
+    char c = *pos;
+
+    if (in_str)
+    {
+      if ('\\' == c)
+      {
+        ++pos;  // skip the escaped character
+        continue;
+      }
+      if ('"' == c)
+        in_str = false;
+      continue;
+    }
+
+    switch (c)
+    {
+    case '"':
+      in_str = true;
+      break;
+
+    case '{': case '[':
+      if (max_depth == depth)
+        throw Error("Raw document is nested too deeply");
+      stack[depth++] = c;
+      break;
+
+    case '}': case ']':
+      if (0 == depth || stack[depth - 1] != ('}' == c ? '{' : '['))
+        throw Error("Raw document has unbalanced brackets");
+      --depth;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  if (in_str)
+    throw Error("Raw document has an unterminated string");
+
+  if (0 != depth)
+    throw Error("Raw document has unbalanced brackets");
+
+  impl->add_json(std::string(json, len));
+}
+
+
+auto Crud_factory::mk_remove(Collection &coll) -> Impl*
+{
+  return new Op_collection_remove(
+    coll.get_session(), Object_ref(coll)
+  );
+}
+
+
 auto Crud_factory::mk_remove(
   Collection &coll, const mysqlx::string &expr
 ) -> Impl*
@@ -101,6 +187,14 @@ auto Crud_factory::mk_find(
 }
 
 
+auto Crud_factory::mk_modify(Collection &coll) -> Impl*
+{
+  return new Op_collection_modify(
+    coll.get_session(), Object_ref(coll)
+  );
+}
+
+
 auto Crud_factory::mk_modify(
   Collection &coll, const mysqlx::string &expr
 ) -> Impl*
@@ -111,6 +205,360 @@ auto Crud_factory::mk_modify(
 }
 
 
+/*
+  Batched execution of modify operations (see CollectionModifyBatch).
+
+  The commands of all queued operations are accumulated in the session
+  pipeline and sent to the server in one network write; the replies are
+  collected afterwards, in queue order. If submitting one of the
+  operations fails, commands accumulated so far are discarded without
+  touching the connection.
+*/
+
+std::vector<Result> CollectionModifyBatch::execute()
+{
+  try {
+
+    std::vector<Result> results;
+    results.reserve(m_ops.size());
+
+    if (m_ops.empty())
+      return results;
+
+    cdk::Session &sess = *(m_coll->get_session()->m_sess);
+
+    std::list<PendingResult<Result>> pending;
+
+    sess.start_pipeline();
+
+    try {
+      for (auto &op : m_ops)
+        pending.emplace_back(op.executeAsync());
+    }
+    catch (...)
+    {
+      sess.clear_pipeline();
+      throw;
+    }
+
+    sess.flush_pipeline();
+
+    for (auto &p : pending)
+      results.emplace_back(p.get());
+
+    m_ops.clear();
+    return results;
+  }
+  CATCH_AND_WRAP
+}
+
+
+/*
+  TableBulkLoad
+  =============
+
+  Delimited text is scanned with memchr(), which uses the platform's
+  vectorized implementation, and each row is passed to the batch insert
+  statement as borrowed byte ranges (see TableInsert::values()), so the
+  field data is serialized into the protocol messages straight from the
+  input buffer. Full batches are submitted with executeAsync() and their
+  replies collected a few batches later, so parsing and network writes
+  overlap with server-side execution.
+*/
+
+// Outstanding batch replies kept before the oldest one is collected.
+
+#define BULK_LOAD_PENDING_MAX 4
+
+
+TableBulkLoad& TableBulkLoad::load(const char *data, size_t size)
+{
+  try {
+
+    const char *pos = data;
+    const char *end = data + size;
+
+    /*
+      Complete a line carried over from the previous piece. The combined
+      line is kept in m_strings so that its field views stay valid until
+      the batch holding them is sent.
+    */
+
+    if (!m_tail.empty())
+    {
+      const char *brk = (const char*)memchr(pos, m_line_sep, size);
+
+      if (!brk)
+      {
+        m_tail.append(pos, size);
+        return *this;
+      }
+
+      m_tail.append(pos, brk - pos);
+      pos = brk + 1;
+
+      m_strings.emplace_back(std::move(m_tail));
+      m_tail.clear();
+
+      const std::string &line = m_strings.back();
+      if (!line.empty())
+        parse_row(line.data(), line.length());
+    }
+
+    while (pos < end)
+    {
+      const char *brk = (const char*)memchr(pos, m_line_sep, end - pos);
+
+      if (!brk)
+      {
+        m_tail.assign(pos, end - pos);
+        break;
+      }
+
+      if (brk > pos)
+        parse_row(pos, brk - pos);
+      pos = brk + 1;
+    }
+
+    return *this;
+  }
+  CATCH_AND_WRAP
+}
+
+
+void TableBulkLoad::parse_row(const char *line, size_t len)
+{
+  // Tolerate CRLF line endings.
+
+  if ('\n' == m_line_sep && len > 0 && '\r' == line[len - 1])
+    --len;
+
+  if (0 == len)
+    return;
+
+  std::vector<bytes> fields;
+
+  const char *pos = line;
+  const char *end = line + len;
+
+  for (bool last = false; !last;)
+  {
+    if (m_quote && pos < end && m_quote == *pos)
+    {
+      // Quoted field: scan for the closing quote, a doubled quote is
+      // a literal one.
+
+      const char *p = pos + 1;
+      bool doubled = false;
+
+      while (true)
+      {
+        p = (const char*)memchr(p, m_quote, end - p);
+        if (!p)
+          throw Error("Bulk load: unterminated quoted field");
+        if (p + 1 < end && m_quote == p[1])
+        {
+          doubled = true;
+          p += 2;
+          continue;
+        }
+        break;
+      }
+
+      const char *fbeg = pos + 1;
+      const char *fend = p;
+
+      if (doubled)
+      {
+        // Only fields with embedded quotes pay an unescaping copy.
+
+        m_strings.emplace_back();
+        std::string &buf = m_strings.back();
+        buf.reserve(fend - fbeg);
+
+        for (const char *q = fbeg; q < fend; ++q)
+        {
+          buf.push_back(*q);
+          if (m_quote == *q)
+            ++q;  // skip the second quote of a pair
+        }
+
+        fbeg = buf.data();
+        fend = fbeg + buf.length();
+      }
+
+      fields.emplace_back((const byte*)fbeg, fend - fbeg);
+
+      pos = p + 1;
+      if (pos == end)
+        last = true;
+      else if (m_field_sep == *pos)
+        ++pos;
+      else
+        throw Error("Bulk load: malformed quoted field");
+    }
+    else
+    {
+      const char *sep = (const char*)memchr(pos, m_field_sep, end - pos);
+      const char *fend = sep ? sep : end;
+
+      if (size_t(fend - pos) == m_null.length()
+          && 0 == memcmp(pos, m_null.data(), m_null.length()))
+        fields.emplace_back((const byte*)nullptr, 0);
+      else
+        fields.emplace_back((const byte*)pos, fend - pos);
+
+      if (!sep)
+        last = true;
+      else
+        pos = sep + 1;
+    }
+  }
+
+  m_batch.values(fields);
+  m_row_count++;
+  m_open_rows++;
+  m_open_bytes += len;
+
+  if (m_open_bytes >= m_batch_bytes)
+    send_batch();
+}
+
+
+void TableBulkLoad::send_batch()
+{
+  /*
+    executeAsync() serializes the batch into protocol messages before
+    returning, so the borrowed field data - including the side buffers
+    in m_strings - is no longer referenced afterwards.
+  */
+
+  m_pending.emplace_back(m_batch.executeAsync());
+
+  m_batch = m_tmpl;
+  m_strings.clear();
+  m_open_bytes = 0;
+  m_open_rows = 0;
+
+  while (m_pending.size() > BULK_LOAD_PENDING_MAX)
+  {
+    m_pending.front().get();
+    m_pending.pop_front();
+  }
+}
+
+
+void TableBulkLoad::flush()
+{
+  try {
+
+    // An input not ending with a line delimiter still holds a last row.
+
+    if (!m_tail.empty())
+    {
+      m_strings.emplace_back(std::move(m_tail));
+      m_tail.clear();
+
+      const std::string &line = m_strings.back();
+      parse_row(line.data(), line.length());
+    }
+
+    if (m_open_rows > 0)
+      send_batch();
+
+    while (!m_pending.empty())
+    {
+      m_pending.front().get();
+      m_pending.pop_front();
+    }
+  }
+  CATCH_AND_WRAP
+}
+
+
+/*
+  TableBulkUpdate
+  ===============
+
+  Each added row binds the template statement and submits the bound copy
+  into the session pipeline; a full batch is flushed with one network
+  write and its replies are collected before the next batch opens. All
+  copies share the template's statement shape, so the session's
+  statement-shape cache prepares the update on the server after the
+  first few executions and later rows send only the statement id with
+  the bind values.
+*/
+
+void TableBulkUpdate::add_row(const std::vector<Value> &vals)
+{
+  if (vals.size() != m_params.size())
+    throw Error("Bulk update: row value count does not match declared parameters");
+
+  cdk::Session &sess = *(m_table->get_session()->m_sess);
+
+  if (!m_open)
+  {
+    sess.start_pipeline();
+    m_open = true;
+  }
+
+  try {
+
+    TableUpdate stmt(m_tmpl);
+
+    auto param = m_params.begin();
+    for (auto &val : vals)
+      stmt.bind(*param++, val);
+
+    m_pending.emplace_back(stmt.executeAsync());
+  }
+  catch (...)
+  {
+    /*
+      Commands of the open batch were not sent yet - discard them
+      without touching the connection.
+    */
+
+    sess.clear_pipeline();
+    m_open = false;
+    m_pending.clear();
+    throw;
+  }
+
+  m_row_count++;
+
+  if (m_pending.size() >= m_batch_rows)
+    send_batch();
+}
+
+
+void TableBulkUpdate::send_batch()
+{
+  if (!m_open)
+    return;
+
+  cdk::Session &sess = *(m_table->get_session()->m_sess);
+
+  m_open = false;
+  sess.flush_pipeline();
+
+  while (!m_pending.empty())
+  {
+    m_affected += m_pending.front().get().getAffectedItemsCount();
+    m_pending.pop_front();
+  }
+}
+
+
+void TableBulkUpdate::flush()
+{
+  try {
+    send_batch();
+  }
+  CATCH_AND_WRAP
+}
+
+
 struct Replace_cmd
   : public Executable<Result, Replace_cmd>
 {
@@ -423,6 +871,44 @@ Collection_detail::index_create(
 }
 
 
+/*
+  Client-side document cache (see Collection::enableDocumentCache()).
+  These are thin forwarders to the per-session cache kept in
+  common::Session_impl, keyed by the collection.
+*/
+
+void Collection_detail::doc_cache_enable(size_t max_bytes, uint64_t ttl_ms)
+{
+  Object_ref coll(get_schema().m_name, m_name);
+  m_sess->doc_cache_enable(doc_cache_key(coll), max_bytes, ttl_ms);
+}
+
+
+bool Collection_detail::doc_cache_active()
+{
+  Object_ref coll(get_schema().m_name, m_name);
+  return m_sess->doc_cache_active(doc_cache_key(coll));
+}
+
+
+bool
+Collection_detail::doc_cache_find(const mysqlx::string &id, std::string &json)
+{
+  Object_ref coll(get_schema().m_name, m_name);
+  return m_sess->doc_cache_find(doc_cache_key(coll), std::string(id), json);
+}
+
+
+void
+Collection_detail::doc_cache_store(
+  const mysqlx::string &id, const std::string &json
+)
+{
+  Object_ref coll(get_schema().m_name, m_name);
+  m_sess->doc_cache_store(doc_cache_key(coll), std::string(id), json);
+}
+
+
 // --------------------------------------------------------------------
 
 /*
@@ -31,6 +31,7 @@
 #include <mysql/cdk.h>
 #include <mysqlx/xdevapi.h>
 #include <json_parser.h>
+#include <expr_parser.h>
 
 /**
   @file
@@ -109,6 +110,26 @@ const Value& DbDoc::operator[](const Field &fld) const
 }
 
 
+const Value& DbDoc::operator[](const Path &path) const
+{
+  if (!m_impl || !path.m_impl)
+    throw std::out_of_range("empty document");
+
+  try {
+    return path.m_impl->resolve(*this);
+  }
+  catch (const std::out_of_range&)
+  {
+    throw;
+  }
+  catch (...)
+  {
+    try { throw; }
+    CATCH_AND_WRAP
+  }
+}
+
+
 void DbDoc::print(std::ostream &out) const
 {
   try {
@@ -210,9 +231,13 @@ public:
       m_arr_builder.reset(new Arr_builder());
       m_arr_builder->m_arr = sub.m_arr.get();
 
-      // Append the sub-array to the main array.
+      /*
+        Append the sub-array to the main array. Note: the value is moved,
+        the builder keeps operating on the array via the pointer stored
+        above.
+      */
 
-      m_arr->emplace_back(sub);
+      m_arr->emplace_back(std::move(sub));
 
       return m_arr_builder.get();
     }
@@ -229,11 +254,16 @@ public:
       Value sub;
       sub.m_type = Value::DOC;
       sub.m_doc.m_impl = std::make_shared<DbDoc::Impl>();
-      m_arr->emplace_back(sub);
 
-      // Create builder for the document and return it as the processor.
+      /*
+        Create builder for the document before the value is moved into
+        the array (the document implementation itself is shared, so it
+        stays valid).
+      */
 
       m_doc_builder.reset(new Builder(*sub.m_doc.m_impl));
+      m_arr->emplace_back(std::move(sub));
+
       return m_doc_builder.get();
     }
 
@@ -323,11 +353,249 @@ public:
 };
 
 
+/*
+  Lazy materialization of document fields
+  ---------------------------------------
+
+  A JSONDoc keeps the JSON string of the document and materializes
+  Value objects for its fields only when they are accessed. To find the
+  fields, only the structure of the document is examined - keys and the
+  byte ranges of their values - without building anything. The scanner
+  below does that; it handles the common shape of documents returned by
+  the server and reports failure otherwise (e.g. escape sequences inside
+  keys), in which case the document is parsed in full as before.
+*/
+
+namespace {
+
+struct Field_scanner
+{
+  const char *m_pos;
+  const char *m_end;
+
+  Field_scanner(const std::string &json)
+    : m_pos(json.data()), m_end(json.data() + json.length())
+  {}
+
+  void skip_ws()
+  {
+    while (m_pos < m_end &&
+           (' ' == *m_pos || '\t' == *m_pos ||
+            '\n' == *m_pos || '\r' == *m_pos))
+      ++m_pos;
+  }
+
+  bool consume(char c)
+  {
+    if (m_pos >= m_end || c != *m_pos)
+      return false;
+    ++m_pos;
+    return true;
+  }
+
+  /*
+    Skip a string literal, with position at the opening quote. If the
+    string contains escape sequences, *has_escape is set to true.
+  */
+
+  bool skip_string(bool *has_escape = nullptr)
+  {
+    if (!consume('"'))
+      return false;
+
+    while (m_pos < m_end)
+    {
+      char c = *m_pos++;
+
+      if ('"' == c)
+        return true;
+
+      if ('\\' == c)
+      {
+        if (has_escape)
+          *has_escape = true;
+        if (m_pos < m_end)
+          ++m_pos;
+      }
+    }
+
+    return false;
+  }
+
+  /*
+    Skip a complete JSON value, tracking nesting of objects and arrays.
+    Stops at the ',' or '}' which follows the value (without consuming
+    it).
+  */
+
+  bool skip_value()
+  {
+    size_t depth = 0;
+
+    while (m_pos < m_end)
+    {
+      char c = *m_pos;
+
+      if ('"' == c)
+      {
+        if (!skip_string())
+          return false;
+      }
+      else if ('{' == c || '[' == c)
+      {
+        ++depth;
+        ++m_pos;
+      }
+      else if ('}' == c || ']' == c)
+      {
+        if (0 == depth)
+          return true;  // closing brace of the enclosing object
+        --depth;
+        ++m_pos;
+      }
+      else if (',' == c && 0 == depth)
+        return true;
+      else
+        ++m_pos;
+    }
+
+    return false;
+  }
+};
+
+}  // anonymous namespace
+
+
+/*
+  Collect keys and value ranges of the top-level fields into m_ranges.
+  Returns false, leaving m_ranges empty, if the document does not follow
+  the expected shape.
+*/
+
+bool DbDoc::Impl::JSONDoc::scan_fields()
+{
+  Field_scanner sc(m_json);
+  const char *base = m_json.data();
+
+  sc.skip_ws();
+
+  if (!sc.consume('{'))
+    return false;
+
+  sc.skip_ws();
+
+  if (!sc.consume('}'))
+  {
+    while (true)
+    {
+      sc.skip_ws();
+
+      const char *key_beg = sc.m_pos + 1;
+      bool has_escape = false;
+
+      /*
+        Note: a key with escape sequences would have to be unescaped to
+        be compared with field names - leave such documents to the full
+        parser.
+      */
+
+      if (!sc.skip_string(&has_escape) || has_escape)
+      {
+        m_ranges.clear();
+        return false;
+      }
+
+      const char *key_end = sc.m_pos - 1;
+
+      sc.skip_ws();
+
+      if (!sc.consume(':'))
+      {
+        m_ranges.clear();
+        return false;
+      }
+
+      sc.skip_ws();
+
+      const char *val_beg = sc.m_pos;
+
+      if (!sc.skip_value() || sc.m_pos == val_beg)
+      {
+        m_ranges.clear();
+        return false;
+      }
+
+      m_ranges.emplace(
+        Field(key_beg, key_end),
+        std::make_pair(size_t(val_beg - base), size_t(sc.m_pos - val_beg))
+      );
+
+      if (sc.consume(','))
+        continue;
+
+      if (sc.consume('}'))
+        break;
+
+      m_ranges.clear();
+      return false;
+    }
+  }
+
+  // Only white-space can follow the document.
+
+  sc.skip_ws();
+
+  if (sc.m_pos != sc.m_end)
+  {
+    m_ranges.clear();
+    return false;
+  }
+
+  return true;
+}
+
+
+/*
+  Build the Value of the given field from its byte range and store it
+  in the map.
+*/
+
+const Value& DbDoc::Impl::JSONDoc::materialize(const Field &fld)
+{
+  auto range = m_ranges.find(fld);
+
+  if (m_ranges.end() == range)
+    throw std::out_of_range("field does not exist in the document");
+
+  std::string json(m_json, range->second.first, range->second.second);
+
+  /*
+    A document value becomes another lazy document over its slice of
+    the JSON string; other values are built with the JSON parser.
+  */
+
+  Value val;
+
+  if ('{' == json[0])
+    val = Value(DbDoc(std::move(json)));
+  else
+    val = Value::Access::mk_from_json(json);
+
+  return m_map.emplace(fld, std::move(val)).first->second;
+}
+
+
 void DbDoc::Impl::JSONDoc::prepare()
 {
   if (m_parsed)
     return;
 
+  if (scan_fields())
+  {
+    m_parsed = true;
+    return;
+  }
+
   cdk::Codec<cdk::TYPE_DOCUMENT> codec;
   Builder bld(*this);
   codec.from_bytes(cdk::bytes(m_json), bld);
@@ -335,6 +603,120 @@ void DbDoc::Impl::JSONDoc::prepare()
 }
 
 
+void DbDoc::Impl::JSONDoc::prepare_all()
+{
+  prepare();
+
+  for (auto &el : m_ranges)
+    if (m_map.end() == m_map.find(el.first))
+      materialize(el.first);
+}
+
+
+bool DbDoc::Impl::JSONDoc::has_field(const Field &fld)
+{
+  prepare();
+
+  if (m_map.end() != m_map.find(fld))
+    return true;
+
+  return m_ranges.end() != m_ranges.find(fld);
+}
+
+
+const Value& DbDoc::Impl::JSONDoc::get(const Field &fld) const
+{
+  auto *self = const_cast<JSONDoc*>(this);
+
+  self->prepare();
+
+  auto it = m_map.find(fld);
+
+  if (m_map.end() != it)
+    return it->second;
+
+  return self->materialize(fld);
+}
+
+
+// Document paths
+// --------------
+
+
+DbDoc::Path::Path(const std::string &path)
+{
+  try {
+    m_impl = std::make_shared<Impl>(path);
+  }
+  CATCH_AND_WRAP
+}
+
+
+/*
+  Parse the path string and store its steps with field names ready for
+  direct lookup in document maps.
+*/
+
+DbDoc::Path::Impl::Impl(const std::string &path)
+{
+  cdk::bytes path_bytes(path);
+  parser::Doc_field_parser doc_field(path_bytes);
+  cdk::Doc_path_storage storage;
+
+  doc_field.process(storage);
+
+  if (storage.is_whole_document() || storage.is_empty())
+    THROW("Path does not name a document field");
+
+  for (size_t pos = 0; pos < storage.length(); ++pos)
+  {
+    const auto &el = storage.get_el(pos);
+    Step step;
+
+    switch (el.m_type)
+    {
+    case cdk::Doc_path_storage::MEMBER:
+      step.m_type = Step::MEMBER;
+      step.m_name = mysqlx::string(el.m_name);
+      break;
+
+    case cdk::Doc_path_storage::ARRAY_INDEX:
+      step.m_type = Step::INDEX;
+      step.m_idx = el.m_idx;
+      break;
+
+    default:
+      THROW("Wildcard path element can not be used for document access");
+    }
+
+    m_steps.push_back(std::move(step));
+  }
+
+  // A path used with DbDoc::operator[] starts at a document field.
+
+  if (Step::MEMBER != m_steps.front().m_type)
+    THROW("Path does not start with a field name");
+}
+
+
+const Value& DbDoc::Path::Impl::resolve(const DbDoc &doc) const
+{
+  const Value *val = &doc[m_steps.front().m_name];
+
+  for (size_t pos = 1; pos < m_steps.size(); ++pos)
+  {
+    const Step &step = m_steps[pos];
+
+    if (Step::MEMBER == step.m_type)
+      val = &(*val)[step.m_name];
+    else
+      val = &(*val)[step.m_idx];
+  }
+
+  return *val;
+}
+
+
 /*
   Parse JSON string and build a corresponding Value.
 */
@@ -51,6 +51,10 @@ PUSH_SYS_WARNINGS
 #include <memory>
 #include <stack>
 #include <list>
+#include <deque>
+#include <vector>
+#include <tuple>
+#include <stdexcept>
 POP_SYS_WARNINGS
 
 
@@ -100,7 +104,7 @@ struct Value::Access
 
   static cdk::string cdk_str(const Value &val)
   {
-    return val.m_ustr;
+    return val.get_ustring();
   }
 
   static void process(
@@ -275,7 +279,198 @@ struct Object_ref : public impl::common::Object_ref
 
 
 /*
-  DbDoc implementation which stores document data in std::map.
+  Order-preserving map used for document fields.
+
+  Documents typically have a handful of fields, for which the per-entry
+  node and pointer chasing of std::map are pure overhead - document
+  materialization used to be our single biggest source of small
+  allocations. Entries are kept in a deque in insertion order, with a
+  separate vector of entry positions maintained in key order: building
+  a document is one deque append per field and lookup is a binary
+  search over the contiguous index.
+
+  Iteration follows key order, like std::map, which the iteration
+  semantics of the public DbDoc::begin()/end() rely on. References to
+  stored keys and values stay valid when the map grows - DbDoc hands
+  out references to field values while other fields can still be
+  materialized lazily (see JSONDoc) - but iterators do not.
+
+  Only the std::map interface subset used by the document
+  implementations is provided.
+*/
+
+template <class Key, class Val>
+class Small_map
+{
+public:
+
+  typedef std::pair<Key, Val> value_type;
+
+private:
+
+  std::deque<value_type> m_entries;
+  std::vector<size_t>    m_index;    // entry positions in key order
+
+  /*
+    Position in m_index of the first entry whose key is not less than
+    the given one.
+  */
+
+  size_t lower(const Key &key) const
+  {
+    size_t lo = 0, hi = m_index.size();
+    while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (m_entries[m_index[mid]].first < key)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  }
+
+  // Whether the index position found by lower() holds the given key.
+
+  bool matches(size_t pos, const Key &key) const
+  {
+    return pos < m_index.size() && !(key < m_entries[m_index[pos]].first);
+  }
+
+public:
+
+  class const_iterator;
+
+  class iterator
+  {
+    Small_map *m_map = nullptr;
+    size_t m_pos = 0;
+
+    iterator(Small_map *map, size_t pos)
+      : m_map(map), m_pos(pos)
+    {}
+
+  public:
+
+    iterator() = default;
+
+    value_type& operator*() const
+    { return m_map->m_entries[m_map->m_index[m_pos]]; }
+    value_type* operator->() const { return &operator*(); }
+
+    iterator& operator++() { ++m_pos; return *this; }
+
+    bool operator==(const iterator &other) const
+    { return m_map == other.m_map && m_pos == other.m_pos; }
+    bool operator!=(const iterator &other) const
+    { return !(*this == other); }
+
+    friend Small_map;
+    friend const_iterator;
+  };
+
+  class const_iterator
+  {
+    const Small_map *m_map = nullptr;
+    size_t m_pos = 0;
+
+    const_iterator(const Small_map *map, size_t pos)
+      : m_map(map), m_pos(pos)
+    {}
+
+  public:
+
+    const_iterator() = default;
+    const_iterator(const iterator &other)
+      : m_map(other.m_map), m_pos(other.m_pos)
+    {}
+
+    const value_type& operator*() const
+    { return m_map->m_entries[m_map->m_index[m_pos]]; }
+    const value_type* operator->() const { return &operator*(); }
+
+    const_iterator& operator++() { ++m_pos; return *this; }
+
+    /*
+      Note: non-member comparison so that iterator and const_iterator
+      can be mixed, as with std::map.
+    */
+
+    friend bool operator==(const const_iterator &a, const const_iterator &b)
+    { return a.m_map == b.m_map && a.m_pos == b.m_pos; }
+    friend bool operator!=(const const_iterator &a, const const_iterator &b)
+    { return !(a == b); }
+
+    friend Small_map;
+  };
+
+  iterator begin() { return { this, 0 }; }
+  iterator end()   { return { this, m_index.size() }; }
+  const_iterator begin() const { return { this, 0 }; }
+  const_iterator end() const   { return { this, m_index.size() }; }
+
+  size_t size() const { return m_index.size(); }
+  bool empty() const { return m_index.empty(); }
+
+  void clear()
+  {
+    m_entries.clear();
+    m_index.clear();
+  }
+
+  iterator find(const Key &key)
+  {
+    size_t pos = lower(key);
+    return { this, matches(pos, key) ? pos : m_index.size() };
+  }
+
+  const_iterator find(const Key &key) const
+  {
+    size_t pos = lower(key);
+    return { this, matches(pos, key) ? pos : m_index.size() };
+  }
+
+  const Val& at(const Key &key) const
+  {
+    size_t pos = lower(key);
+    if (!matches(pos, key))
+      throw std::out_of_range("field does not exist in the document");
+    return m_entries[m_index[pos]].second;
+  }
+
+  /*
+    Like std::map::emplace(): the entry is added only if the key is not
+    present yet and the returned iterator points at the entry with the
+    given key in either case.
+  */
+
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(const Key &key, Args&&... args)
+  {
+    size_t pos = lower(key);
+
+    if (matches(pos, key))
+      return { iterator(this, pos), false };
+
+    m_entries.emplace_back(
+      std::piecewise_construct,
+      std::forward_as_tuple(key),
+      std::forward_as_tuple(std::forward<Args>(args)...)
+    );
+    m_index.insert(m_index.begin() + pos, m_entries.size() - 1);
+
+    return { iterator(this, pos), true };
+  }
+
+  Val& operator[](const Key &key)
+  {
+    return emplace(key).first->second;
+  }
+};
+
+
+/*
+  DbDoc implementation which stores document data in an ordered map.
 */
 
 class DbDoc::Impl
@@ -291,18 +486,26 @@ class DbDoc::Impl
 
   virtual void prepare() {} // GCOV_EXCL_LINE
 
+  /*
+    Ensure that all fields are stored in m_map (a lazy implementation
+    can materialize fields on first access, see JSONDoc). Used before
+    iterating over document fields.
+  */
+
+  virtual void prepare_all() { prepare(); }
+
   // Data storage
 
-  typedef std::map<Field, Value> Map;
+  typedef Small_map<Field, Value> Map;
   Map m_map;
 
-  bool has_field(const Field &fld)
+  virtual bool has_field(const Field &fld)
   {
     prepare();
     return m_map.end() != m_map.find(fld);
   }
 
-  const Value& get(const Field &fld) const
+  virtual const Value& get(const Field &fld) const
   {
     const_cast<Impl*>(this)->prepare();
     return m_map.at(fld);
@@ -327,17 +530,20 @@ class DbDoc::Impl
       {
         first = false;
       }
-      self->m_json.append(R"(")").append(el.first).append(R"(": )");
+      self->m_json.append(R"(")");
+      cdk::foundation::json_escape(el.first, self->m_json);
+      self->m_json.append(R"(": )");
 
       switch (el.second.get_type())
       {
       case common::Value::STRING:
       case common::Value::USTRING:
       case common::Value::EXPR:
-        self->m_json
-            .append(R"(")")
-            .append(el.second.get<std::string>())
-            .append(R"(")");
+        self->m_json.append(R"(")");
+        cdk::foundation::json_escape(
+          el.second.get<std::string>(), self->m_json
+        );
+        self->m_json.append(R"(")");
         break;
       default:
         std::stringstream value_ss;
@@ -355,7 +561,7 @@ class DbDoc::Impl
 
   Map::iterator m_it;
 
-  void reset() { prepare(); m_it = m_map.begin(); }
+  void reset() { prepare_all(); m_it = m_map.begin(); }
 
   const Field& get_current_fld() { return m_it->first; }
   void next() { ++m_it; }
@@ -375,7 +581,9 @@ class DbDoc::Impl
 
 /*
   DbDoc::Impl specialization which takes document data from
-  a JSON string.
+  a JSON string. Fields are materialized into the map lazily, on
+  first access, while the retained JSON string serves as the
+  underlying storage.
 */
 
 class DbDoc::Impl::JSONDoc
@@ -384,6 +592,16 @@ class DbDoc::Impl::JSONDoc
 
   bool m_parsed;
 
+  /*
+    Byte ranges (offset, length) of top-level field values within
+    m_json, collected by a structural scan of the document without
+    building any values. A field value is built from its range on
+    first access (see materialize()).
+  */
+
+  typedef Small_map<Field, std::pair<size_t, size_t>> Ranges;
+  Ranges m_ranges;
+
 public:
 
   JSONDoc(const std::string &json)
@@ -399,6 +617,10 @@ public:
   }
 
   void prepare();
+  void prepare_all();
+
+  bool has_field(const Field &fld);
+  const Value& get(const Field &fld) const;
 
   void print(std::ostream &out) const
   {
@@ -409,6 +631,40 @@ public:
   {
     return m_json.c_str();
   }
+
+private:
+
+  bool scan_fields();
+  const Value& materialize(const Field &fld);
+};
+
+
+/*
+  Implementation of a pre-parsed document path: the sequence of path
+  steps with field names converted up-front, so that resolving the path
+  against a document is a chain of plain map lookups.
+*/
+
+class DbDoc::Path::Impl
+{
+public:
+
+  Impl(const std::string &path);
+
+  const Value& resolve(const DbDoc &doc) const;
+
+private:
+
+  struct Step
+  {
+    enum Type { MEMBER, INDEX };
+
+    Type      m_type;
+    Field     m_name;
+    uint32_t  m_idx;
+  };
+
+  std::vector<Step> m_steps;
 };
 
 
@@ -436,6 +692,22 @@ public:
 };
 
 
+/*
+  Implementation for a RowStorage instance.
+
+  Holds the raw data of the released rows together with the meta-data
+  instance that was shared with row handles of the result.
+*/
+
+class RowStorage::Impl
+{
+public:
+
+  std::vector<impl::common::Row_data>  m_rows;
+  impl::common::Shared_meta_data       m_mdata;
+};
+
+
 /*
   Internal implementation for Client objects.
 
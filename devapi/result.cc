@@ -37,6 +37,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cctype>
+#include <cstring>
 
 
 /*
@@ -66,7 +67,7 @@ public:
 void Column_detail::print(std::ostream &out) const
 {
   if (!get_impl().m_schema_name.empty())
-    out << "`" << get_impl().m_schema_name << "`.";
+    out << "`" << get_impl().m_schema_name.str() << "`.";
   string table_name = get_table_label();
   if (!table_name.empty())
     out << "`" << table_name << "`.";
@@ -177,27 +178,27 @@ Type get_api_type(cdk::Type_info type, const Format_info &fmt)
 
 mysqlx::string Column_detail::get_name() const
 {
-  return get_impl().m_name;
+  return get_impl().m_name.str();
 }
 
 mysqlx::string Column_detail::get_label() const
 {
-  return get_impl().m_label;
+  return get_impl().m_label.str();
 }
 
 mysqlx::string Column_detail::get_schema_name() const
 {
-  return get_impl().m_schema_name;
+  return get_impl().m_schema_name.str();
 }
 
 mysqlx::string Column_detail::get_table_name() const
 {
-  return get_impl().m_table_name;
+  return get_impl().m_table_name.str();
 }
 
 mysqlx::string Column_detail::get_table_label() const
 {
-  return get_impl().m_table_label;
+  return get_impl().m_table_label.str();
 }
 
 unsigned long Column_detail::get_length() const
@@ -307,58 +308,46 @@ struct CollationInfo::Access
     case_bin = CollationInfo::case_bin
   };
 
-  static CollationInfo mk(
+  static constexpr CollationInfo mk(
     CharacterSet _cs, unsigned _id, coll_case _case, const char *_name
   )
   {
-    CollationInfo ci;
-    ci.m_cs = _cs;
-    ci.m_id = _id;
-    ci.m_case = CollationInfo::coll_case(_case);
-    ci.m_name = _name;
-    return std::move(ci);
+    return CollationInfo(
+      _cs, _id, CollationInfo::coll_case(_case), _name
+    );
   }
 };
 
 
 /*
-  A helper function that reconstructs MySQL collation name from the data
-  given by COLLATIONS_XXX() lists. In most cases the collation name is just
-  a concatenation of charset name, collation and sensitivity flags - this
-  default name is passed as 'name' pre-allocated string. But there are few
-  exceptions to the general rule: 'name_bin' is the name to be used for binary
-  collations; also, individual components of the name are given to allow
-  further customization.
+  A helper that selects the MySQL collation name from the data given by
+  COLLATIONS_XXX() lists. In most cases the collation name is just a
+  concatenation of charset name, collation and sensitivity flags, passed
+  here as the pre-built 'name' literal. The exceptions are resolved at
+  compile time, so that the collation constants below are constant
+  initialized and require no code at process startup:
+
+  - binary collations use the 'name_bin' literal ("<cs>_bin"), except
+    for the binary charset itself, whose collation is named plain
+    "binary";
+
+  - for generic UCA collations, such as uca0900, the "uca" prefix is not
+    present in the MySQL collation name (the name is "utf8mb4_0900_ai_ci",
+    not "utf8mb4_uca0900_ai_ci") - these are recognized by their ids.
 */
 
-const char*
+constexpr const char*
 coll_name(
-  std::string cs, std::string coll, std::string sensitivity,
+  unsigned id, CharacterSet cs, bool bin_case,
   const char *name, const char *name_bin)
 {
-  static std::list<std::string> special;
-
-  /*
-    For generic UCA collations, such as uca0900, the "uca" prefix is
-    not present in the MySQL collation name. For example, for the uca0900
-    collation with "ai_ci" sensitivity, the collation name
-    is "utf8mb4_0900_ai_ci" but the value of 'name' is "utf8mb4_uca0900_ai_ci",
-    so we need to correct this.
-  */
-
-  if (coll.substr(0,3) == "uca")
-  {
-    special.push_back(cs + "_" + coll.substr(3) + "_" + sensitivity);
-    return special.back().c_str();
-  }
-
-  if (sensitivity == "bin")
-  {
-    // Note: special exception for "binary" collation (no _bin suffix)
-    return cs == "binary" ? "binary" : name_bin;
-  }
-  else
-    return name;
+  return
+    255 == id ? "utf8mb4_0900_ai_ci" :
+    278 == id ? "utf8mb4_0900_as_cs" :
+    305 == id ? "utf8mb4_0900_as_ci" :
+    309 == id ? "utf8mb4_0900_bin" :
+    bin_case ? (CharacterSet::binary == cs ? "binary" : name_bin) :
+    name;
 }
 
 
@@ -369,23 +358,332 @@ const CollationInfo \
 Collation<CharacterSet::CS>::COLL_CONST_NAME(COLL,CASE) = \
   CollationInfo::Access::mk(CharacterSet::CS, ID, \
     CollationInfo::Access::case_##CASE, \
-    COLL_NAME(CS,COLL,CASE));
+    COLL_NAME(CS,ID,COLL,CASE));
 
-#define COLL_NAME(CS,COLL,CASE) \
-  coll_name(#CS, #COLL, #CASE, #CS "_" #COLL "_" #CASE, #CS "_bin")
+#define COLL_NAME(CS,ID,COLL,CASE) \
+  coll_name(ID, CharacterSet::CS, COLL_CASE_IS_BIN_##CASE, \
+            #CS "_" #COLL "_" #CASE, #CS "_bin")
+
+#define COLL_CASE_IS_BIN_bin      true
+#define COLL_CASE_IS_BIN_ci       false
+#define COLL_CASE_IS_BIN_ai_ci    false
+#define COLL_CASE_IS_BIN_as_ci    false
+#define COLL_CASE_IS_BIN_cs       false
+#define COLL_CASE_IS_BIN_as_cs    false
+#define COLL_CASE_IS_BIN_as_cs_ks false
 
 // Add utf8mb4 alias for bin collation for compatibility
 
 #undef  COLLATIONS_utf8mb4_EXTRA
 #define COLLATIONS_utf8mb4_EXTRA \
 const CollationInfo Collation<CharacterSet::utf8mb4>::utf8mb4 = \
-  Collation<CharacterSet::utf8mb4>::bin;
+  CollationInfo::Access::mk(CharacterSet::utf8mb4, 46, \
+    CollationInfo::Access::case_bin, "utf8mb4_bin");
 
 CDK_CS_LIST(COLL_DEFS)
 
 #undef  COLLATIONS_utf8mb4_EXTRA
 #define COLLATIONS_utf8mb4_EXTRA
 
+
+/*
+  Collation-aware string comparison (see CollationInfo::compare()).
+
+  The functions below operate directly on the UTF-8 wire-format bytes of
+  string values, so results coming from several sessions can be merged
+  or sorted client-side without transcoding. Two collation families are
+  implemented:
+
+  - binary collations over Unicode character sets: UTF-8 is designed so
+    that byte order equals code-point order, hence byte comparison
+    (which libc vectorizes) gives the collation order directly;
+
+  - the general_ci collations of utf8mb4/utf8/ascii: every code point is
+    weighted independently of its context - code points of the cased
+    scripts (Latin, Greek, Cyrillic) weigh as their upper-case form, any
+    other code point of the basic plane weighs as itself and all
+    supplementary code points share a single weight.
+
+  The UCA collations (uca0900, unicode etc.) have multi-level,
+  context-dependent weights and are not handled here.
+
+  All collations implemented below except utf8mb4_0900_bin and the
+  binary pseudo-charset have the server's PAD SPACE attribute: the
+  shorter string is compared as if padded with spaces, so trailing
+  spaces never affect the order.
+*/
+
+namespace {
+
+// Weight of a code point under the general_ci collations.
+
+uint32_t general_ci_weight(uint32_t cp)
+{
+  // ASCII and the Latin-1 supplement.
+
+  if (cp < 0x100)
+  {
+    if ((cp >= 'a' && cp <= 'z') ||
+        (cp >= 0xE0 && cp <= 0xFE && cp != 0xF7))
+      return cp - 0x20;
+    if (0xFF == cp)    // y with diaeresis upper-cases outside the block
+      return 0x178;
+    if (0xB5 == cp)    // micro sign weighs as Greek capital Mu
+      return 0x39C;
+    return cp;
+  }
+
+  // Latin Extended-A (odd code points are the lower-case forms).
+
+  if (cp < 0x178)
+  {
+    if (0x130 == cp || 0x131 == cp)  // dotted/dotless i weigh as I
+      return 'I';
+    if (0x138 == cp || 0x149 == cp)  // kra, 'n - caseless
+      return cp;
+    return cp & ~1U;
+  }
+  if (cp >= 0x179 && cp <= 0x17E)    // Z with acute/dot/caron pairs
+    return cp & 1U ? cp : cp - 1;    // here the lower-case forms are even
+  if (0x17F == cp)                   // long s weighs as S
+    return 'S';
+
+  // Greek.
+
+  if (cp >= 0x3B1 && cp <= 0x3C9 && 0x3C2 != cp)
+    return cp - 0x20;
+  if (0x3C2 == cp)                   // final sigma weighs as Sigma
+    return 0x3A3;
+  switch (cp)                        // accented lower-case letters
+  {
+  case 0x3AC: return 0x386;
+  case 0x3AD: return 0x388;
+  case 0x3AE: return 0x389;
+  case 0x3AF: return 0x38A;
+  case 0x3CA: return 0x3AA;
+  case 0x3CB: return 0x3AB;
+  case 0x3CC: return 0x38C;
+  case 0x3CD: return 0x38E;
+  case 0x3CE: return 0x38F;
+  default: break;
+  }
+
+  // Cyrillic.
+
+  if (cp >= 0x430 && cp <= 0x44F)
+    return cp - 0x20;
+  if (cp >= 0x450 && cp <= 0x45F)
+    return cp - 0x50;
+
+  // All supplementary code points share one weight, as on the server.
+
+  if (cp > 0xFFFF)
+    return 0xFFFD;
+
+  return cp;
+}
+
+
+/*
+  Decode the next UTF-8 code point. Malformed sequences decode to the
+  replacement character, so that comparison never fails on them.
+*/
+
+uint32_t next_code_point(const unsigned char *&pos, const unsigned char *end)
+{
+  uint32_t lead = *pos++;
+
+  if (lead < 0x80)
+    return lead;
+
+  unsigned cont = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : 1;
+  uint32_t cp = lead & (0x3FU >> cont);
+
+  for (; cont > 0; --cont)
+  {
+    if (pos == end || 0x80 != (0xC0 & *pos))
+      return 0xFFFD;
+    cp = (cp << 6) | (0x3FU & *pos++);
+  }
+
+  return cp;
+}
+
+
+int compare_general_ci(const std::string &a, const std::string &b)
+{
+  using std::memcmp;
+
+  /*
+    Fast path: skip the common prefix in word-sized chunks - identical
+    bytes compare equal under any collation. The first difference is
+    then backed up to a code-point boundary (bytes 10xxxxxx are
+    continuation bytes) and collation logic starts there.
+  */
+
+  size_t common = std::min(a.length(), b.length());
+  size_t pos = 0;
+
+  while (pos + 8 <= common && 0 == memcmp(a.data() + pos, b.data() + pos, 8))
+    pos += 8;
+  while (pos < common && a[pos] == b[pos])
+    ++pos;
+  while (pos > 0 && 0x80 == (0xC0 & (unsigned char)a[pos]))
+    --pos;
+
+  auto *pa = (const unsigned char*)a.data() + pos;
+  auto *ea = (const unsigned char*)a.data() + a.length();
+  auto *pb = (const unsigned char*)b.data() + pos;
+  auto *eb = (const unsigned char*)b.data() + b.length();
+
+  // Note: an exhausted side weighs as space (PAD SPACE semantics).
+
+  while (pa != ea || pb != eb)
+  {
+    uint32_t wa
+      = pa != ea ? general_ci_weight(next_code_point(pa, ea)) : 0x20;
+    uint32_t wb
+      = pb != eb ? general_ci_weight(next_code_point(pb, eb)) : 0x20;
+
+    if (wa != wb)
+      return wa < wb ? -1 : 1;
+  }
+
+  return 0;
+}
+
+
+int compare_bin(const std::string &a, const std::string &b, bool pad)
+{
+  size_t common = std::min(a.length(), b.length());
+  int res = std::memcmp(a.data(), b.data(), common);
+
+  if (0 != res || a.length() == b.length())
+    return res;
+
+  if (!pad)
+    return a.length() < b.length() ? -1 : 1;
+
+  /*
+    PAD SPACE: the tail of the longer string decides against spaces -
+    all-space tails compare equal.
+  */
+
+  const std::string &longer = a.length() > b.length() ? a : b;
+  int sign = a.length() > b.length() ? 1 : -1;
+
+  for (size_t i = common; i < longer.length(); ++i)
+  {
+    if (0x20 != (unsigned char)longer[i])
+      return 0x20 < (unsigned char)longer[i] ? sign : -sign;
+  }
+
+  return 0;
+}
+
+
+// Collation ids of the general_ci collations over UTF-8 charsets.
+
+bool is_general_ci(unsigned id)
+{
+  return 45 == id || 33 == id || 11 == id;
+}
+
+// Binary collations whose wire format is UTF-8 (or raw) bytes.
+
+bool is_supported_bin(const CollationInfo &coll)
+{
+  if (!coll.isBinary())
+    return false;
+
+  switch (coll.getCharacterSet())
+  {
+  case CharacterSet::utf8mb4:
+  case CharacterSet::utf8:
+  case CharacterSet::ascii:
+  case CharacterSet::binary:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// NO PAD collations: utf8mb4_0900_bin and the binary pseudo-charset.
+
+bool is_no_pad(const CollationInfo &coll)
+{
+  return 309 == coll.id() || CharacterSet::binary == coll.getCharacterSet();
+}
+
+}  // anonymous namespace
+
+
+int
+internal::collation_compare(
+  const CollationInfo &coll, const std::string &a, const std::string &b
+)
+{
+  if (is_supported_bin(coll))
+    return compare_bin(a, b, !is_no_pad(coll));
+
+  if (is_general_ci(coll.id()))
+    return compare_general_ci(a, b);
+
+  THROW(
+    "Comparison is implemented only for binary and general_ci collations"
+    " over Unicode character sets"
+  );
+}
+
+
+std::string
+internal::collation_sort_key(const CollationInfo &coll, const std::string &str)
+{
+  size_t len = str.length();
+
+  if (is_supported_bin(coll))
+  {
+    // Trailing spaces are insignificant under PAD SPACE - drop them.
+
+    if (!is_no_pad(coll))
+      while (len > 0 && 0x20 == (unsigned char)str[len - 1])
+        --len;
+
+    return str.substr(0, len);
+  }
+
+  if (!is_general_ci(coll.id()))
+    THROW(
+      "Sort keys are implemented only for binary and general_ci collations"
+      " over Unicode character sets"
+    );
+
+  /*
+    A 0x20 byte in UTF-8 can only be the space character, so trailing
+    spaces can be dropped before decoding. Weights of the general_ci
+    collations fit in 16 bits and are emitted big-endian, which makes
+    memcmp() order of the keys equal to the weight order.
+  */
+
+  while (len > 0 && 0x20 == (unsigned char)str[len - 1])
+    --len;
+
+  std::string key;
+  key.reserve(2 * len);
+
+  auto *pos = (const unsigned char*)str.data();
+  auto *end = pos + len;
+
+  while (pos != end)
+  {
+    uint32_t w = general_ci_weight(next_code_point(pos, end));
+    key.push_back((char)(0xFF & (w >> 8)));
+    key.push_back((char)(0xFF & w));
+  }
+
+  return key;
+}
+
 /*
   Handling result data
   ====================
@@ -459,12 +757,236 @@ mysqlx::bytes Row_detail::get_bytes(mysqlx::col_count_t pos) const
 }
 
 
+mysqlx::bytes Row_detail::get_view(mysqlx::col_count_t pos) const
+{
+  auto &impl = get_impl();
+  cdk::bytes data = impl.m_data.at(pos).data();
+
+  /*
+    For string-like columns the raw representation carries an artificial
+    trailing 0x00 byte (used to distinguish null values from empty ones)
+    which is not part of the field data and should not be seen through
+    the view.
+  */
+
+  if (0 < data.size() && impl.m_mdata)
+  {
+    switch (impl.m_mdata->get_format(pos).m_type)
+    {
+    case cdk::TYPE_STRING:
+    case cdk::TYPE_BYTES:
+    case cdk::TYPE_DOCUMENT:
+      data = cdk::bytes(data.begin(), data.end() - 1);
+      break;
+    default:
+      break;
+    }
+  }
+
+  return mysqlx::bytes::Access::mk(data);
+}
+
+
+mysqlx::bytes Row_detail::get_geometry(mysqlx::col_count_t pos) const
+{
+  auto &impl = get_impl();
+
+  if (!impl.m_mdata || cdk::TYPE_GEOMETRY != impl.m_mdata->get_format(pos).m_type)
+    throw Error("Field is not of geometry type");
+
+  cdk::bytes data = impl.m_data.at(pos).data();
+
+  if (0 == data.size())
+    throw Error("Geometry field is NULL");
+
+  /*
+    Strip the artificial trailing 0x00 byte of the raw representation
+    (see Row::getBytes()) - the view should show only the geometry
+    value itself.
+  */
+
+  return mysqlx::bytes::Access::mk(cdk::bytes(data.begin(), data.end() - 1));
+}
+
+
 mysqlx::Value& Row_detail::get_val(mysqlx::col_count_t pos)
 {
   return get_impl().get(pos);
 }
 
 
+mysqlx::Value& Row_detail::get_val(const std::string &name)
+{
+  auto &impl = get_impl();
+  return impl.get(impl.col_index(name));
+}
+
+
+/*
+  Typed field decoding (see Row::as<>()).
+
+  Unlike get_val(), which converts a field to a Value instance using the
+  per-field type dispatch in Row_impl::convert_at(), these overloads
+  decode the raw bytes directly into the destination. The destination
+  type selects the decoding path at compile time and the codec comes
+  from the result meta-data (resolved once per result), so reading many
+  rows of a known shape pays neither for the type switch nor for the
+  intermediate Value storage.
+*/
+
+/*
+  Check that a field of the expected type holds data and return its raw
+  bytes. Throws for NULL fields - a typed destination has no way of
+  representing a null value.
+*/
+
+static cdk::bytes
+check_raw(cdk::Type_info expected, cdk::Type_info actual, cdk::bytes raw)
+{
+  if (expected != actual)
+    throw mysqlx::Error("Row field type does not match requested type");
+
+  if (0 == raw.size())
+    throw mysqlx::Error("Can not decode a NULL field into a typed value");
+
+  return raw;
+}
+
+
+void Row_detail::get_typed(mysqlx::col_count_t pos, int64_t &val)
+{
+  auto &impl = get_impl();
+  if (!impl.m_mdata)
+    throw std::out_of_range("no meta-data found");
+  auto &fi = impl.m_mdata->get_format(pos);
+  cdk::bytes raw = check_raw(cdk::TYPE_INTEGER, fi.m_type, impl.get_bytes(pos));
+  auto &fd = fi.get<cdk::TYPE_INTEGER>();
+
+  if (fd.m_format.is_unsigned())
+    throw Error("Unsigned column can not be decoded as int64_t");
+
+  fd.m_codec.from_bytes(raw, val);
+}
+
+
+void Row_detail::get_typed(mysqlx::col_count_t pos, uint64_t &val)
+{
+  auto &impl = get_impl();
+  if (!impl.m_mdata)
+    throw std::out_of_range("no meta-data found");
+  auto &fi = impl.m_mdata->get_format(pos);
+  cdk::bytes raw = check_raw(cdk::TYPE_INTEGER, fi.m_type, impl.get_bytes(pos));
+  auto &fd = fi.get<cdk::TYPE_INTEGER>();
+
+  if (!fd.m_format.is_unsigned())
+    throw Error("Signed column can not be decoded as uint64_t");
+
+  fd.m_codec.from_bytes(raw, val);
+}
+
+
+void Row_detail::get_typed(mysqlx::col_count_t pos, double &val)
+{
+  auto &impl = get_impl();
+  if (!impl.m_mdata)
+    throw std::out_of_range("no meta-data found");
+  auto &fi = impl.m_mdata->get_format(pos);
+  cdk::bytes raw = check_raw(cdk::TYPE_FLOAT, fi.m_type, impl.get_bytes(pos));
+  auto &fd = fi.get<cdk::TYPE_FLOAT>();
+
+  // A single precision column is decoded as float and widened.
+
+  if (fd.m_format.FLOAT == fd.m_format.type())
+  {
+    float tmp;
+    fd.m_codec.from_bytes(raw, tmp);
+    val = tmp;
+    return;
+  }
+
+  fd.m_codec.from_bytes(raw, val);
+}
+
+
+void Row_detail::get_typed(mysqlx::col_count_t pos, float &val)
+{
+  auto &impl = get_impl();
+  if (!impl.m_mdata)
+    throw std::out_of_range("no meta-data found");
+  auto &fi = impl.m_mdata->get_format(pos);
+  cdk::bytes raw = check_raw(cdk::TYPE_FLOAT, fi.m_type, impl.get_bytes(pos));
+  auto &fd = fi.get<cdk::TYPE_FLOAT>();
+
+  if (fd.m_format.FLOAT != fd.m_format.type())
+    throw Error("Only a FLOAT column can be decoded as float");
+
+  fd.m_codec.from_bytes(raw, val);
+}
+
+
+void Row_detail::get_typed(mysqlx::col_count_t pos, bool &val)
+{
+  auto &impl = get_impl();
+  if (!impl.m_mdata)
+    throw std::out_of_range("no meta-data found");
+  auto &fi = impl.m_mdata->get_format(pos);
+  cdk::bytes raw = check_raw(cdk::TYPE_INTEGER, fi.m_type, impl.get_bytes(pos));
+  auto &fd = fi.get<cdk::TYPE_INTEGER>();
+
+  if (fd.m_format.is_unsigned())
+  {
+    uint64_t tmp;
+    fd.m_codec.from_bytes(raw, tmp);
+    val = (0 != tmp);
+  }
+  else
+  {
+    int64_t tmp;
+    fd.m_codec.from_bytes(raw, tmp);
+    val = (0 != tmp);
+  }
+}
+
+
+void Row_detail::get_typed(mysqlx::col_count_t pos, std::string &val)
+{
+  auto &impl = get_impl();
+  if (!impl.m_mdata)
+    throw std::out_of_range("no meta-data found");
+  auto &fi = impl.m_mdata->get_format(pos);
+  cdk::bytes raw = check_raw(cdk::TYPE_STRING, fi.m_type, impl.get_bytes(pos));
+  auto &fd = fi.get<cdk::TYPE_STRING>();
+
+  // Skip the artificial trailing 0x00 byte (see Row::getBytes()).
+
+  cdk::bytes data(raw.begin(), raw.end() - 1);
+
+  /*
+    For utf8 compatible character sets (and SET values, which are
+    returned verbatim) the wire representation already is the utf8
+    string, so the bytes are copied as they are. Other character sets
+    fall back to the regular Value conversion path.
+  */
+
+  if (fd.m_format.is_set())
+  {
+    val.assign(data.begin(), data.end());
+    return;
+  }
+
+  switch (fd.m_format.charset())
+  {
+  case cdk::Charset::utf8:
+  case cdk::Charset::utf8mb4:
+  case cdk::Charset::ascii:
+    val.assign(data.begin(), data.end());
+    return;
+  default:
+    val = impl.get(pos).get<std::string>();
+  }
+}
+
+
 void Row_detail::process_one(
   std::pair<Impl*, mysqlx::col_count_t> *data, const mysqlx::Value &val
 )
@@ -484,15 +1006,38 @@ void Row_detail::process_one(
 Result_detail::Result_detail(Result_init &init)
 {
   m_owns_impl = true;
+
+  /*
+    Statements which are known to produce no result set get the
+    lightweight acknowledgment implementation which skips the row cache
+    and meta-data machinery of Result_impl (see common::Result_ack).
+  */
+
+  if (init.no_data())
+  {
+    m_ack = new common::Result_ack(init);
+    return;
+  }
+
   m_impl = new Impl(init);
 }
 
 
+Result_detail::Result_detail(const std::string &spool_path)
+{
+  m_owns_impl = true;
+  m_impl = new Impl(spool_path);
+}
+
+
 Result_detail::~Result_detail()
 {
   try {
     if (m_owns_impl)
+    {
       delete m_impl;
+      delete m_ack;
+    }
   }
   catch(...) {}
 }
@@ -501,10 +1046,14 @@ Result_detail::~Result_detail()
 auto Result_detail::operator=(Result_detail &&other)
 -> Result_detail&
 {
-  if (m_impl && m_owns_impl)
+  if (m_owns_impl)
+  {
     delete m_impl;
+    delete m_ack;
+  }
 
   m_impl = other.m_impl;
+  m_ack = other.m_ack;
 
   if (!other.m_owns_impl)
     m_owns_impl = false;
@@ -528,7 +1077,7 @@ auto Result_detail::get_impl() -> Impl&
 
 void Result_detail::check_result() const
 {
-  if (!get_impl().has_data())
+  if (m_ack || !get_impl().has_data())
     THROW("No result set");
 }
 
@@ -536,6 +1085,8 @@ void Result_detail::check_result() const
 unsigned
 Result_detail::get_warning_count() const
 {
+  if (m_ack)
+    return m_ack->get_warning_count();
   return get_impl().get_warning_count();
 }
 
@@ -546,8 +1097,8 @@ auto Result_detail::get_warning(size_t pos) -> Warning
     throw std::out_of_range("No diagnostic entry at position ...");
 
   get_warning_count();
-  auto &impl = get_impl();
-  auto &it = impl.get_entries(cdk::api::Severity::WARNING);
+  auto &it = m_ack ? m_ack->get_entries(cdk::api::Severity::WARNING)
+                   : get_impl().get_entries(cdk::api::Severity::WARNING);
   size_t curr = SIZE_MAX;
   while( curr != pos && it.next())
   {
@@ -578,32 +1129,90 @@ auto Result_detail::get_warning(size_t pos) -> Warning
 
 auto Result_detail::get_affected_rows() const -> uint64_t
 {
+  if (m_ack)
+    return m_ack->get_affected_rows();
   return get_impl().get_affected_rows();
 }
 
 auto Result_detail::get_auto_increment() const -> uint64_t
 {
+  if (m_ack)
+    return m_ack->get_auto_increment();
   return get_impl().get_auto_increment();
 }
 
 
+auto Result_detail::get_timings() const -> ResultTimings
+{
+  auto timings = m_ack ? m_ack->get_timings() : get_impl().get_timings();
+
+  ResultTimings res;
+
+  // Convert phase timestamps to microseconds since the command was
+  // sent; phases which were not reached report 0.
+
+  auto usec_since_sent = [&timings](decltype(timings.sent) ts) -> uint64_t
+  {
+    if (decltype(timings.sent)() == ts
+        || decltype(timings.sent)() == timings.sent)
+      return 0;
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+             ts - timings.sent
+           ).count();
+  };
+
+  res.first_reply_usec = usec_since_sent(timings.first_reply);
+  res.mdata_usec = usec_since_sent(timings.mdata_done);
+  res.first_row_usec = usec_since_sent(timings.first_row);
+  res.last_row_usec = usec_since_sent(timings.last_row);
+
+  return res;
+}
+
+
 auto Result_detail::get_generated_ids() const -> DocIdList
 {
+  if (m_ack)
+    return m_ack->get_generated_ids();
   return get_impl().get_generated_ids();
 }
 
 
 bool Result_detail::has_data() const
 {
+  if (m_ack)
+    return false;
   return get_impl().has_data();
 }
 
 bool Result_detail::next_result()
 {
+  if (m_ack)
+    return false;
   return get_impl().next_result();
 }
 
 
+bool Result_detail::poll_row()
+{
+  // Without row data get_row() reports end of data without waiting.
+
+  if (m_ack || !m_impl)
+    return true;
+  return m_impl->poll_row();
+}
+
+
+void Result_detail::discard()
+{
+  // Acknowledged-only results carry no data to discard.
+
+  if (m_ack || !m_impl)
+    return;
+  m_impl->discard();
+}
+
+
 /*
   RowResult
   =========
@@ -634,6 +1243,14 @@ mysqlx::col_count_t Row_result_detail<Columns>::col_count() const
 }
 
 
+template<>
+mysqlx::col_count_t
+Row_result_detail<Columns>::col_index(const mysqlx::string &name) const
+{
+  return get_impl().get_col_index(std::string(name));
+}
+
+
 template<>
 Row_result_detail<Columns>::Row_result_detail(Result_init &init)
   : Result_detail(init)
@@ -642,6 +1259,14 @@ Row_result_detail<Columns>::Row_result_detail(Result_init &init)
 }
 
 
+template<>
+Row_result_detail<Columns>::Row_result_detail(const std::string &spool_path)
+  : Result_detail(spool_path)
+{
+  next_result();
+}
+
+
 template<>
 auto Row_result_detail<Columns>::get_column(mysqlx::col_count_t pos) const
 -> const Column&
@@ -677,6 +1302,250 @@ mysqlx::row_count_t Row_result_detail<Columns>::row_count()
 }
 
 
+template<>
+mysqlx::row_count_t
+Row_result_detail<Columns>::fetch_many(Row *rows, mysqlx::row_count_t count)
+{
+  auto &impl = get_impl();
+
+  if (0 == count)
+    return 0;
+
+  /*
+    Move row data out of the result cache in one pass, then wrap each
+    Row_data into a row handle. All handles share the same meta-data
+    instance.
+  */
+
+  std::vector<Row_data> data((size_t)count);
+  row_count_t fetched = impl.get_rows(data.data(), count);
+
+  for (row_count_t i = 0; i < fetched; ++i)
+  {
+    rows[i] = internal::Row_detail(
+      std::make_shared<internal::Row_detail::Impl>(
+        std::move(data[i]), impl.get_mdata()
+      )
+    );
+  }
+
+  return fetched;
+}
+
+
+template<>
+RowStorage Row_result_detail<Columns>::release_storage()
+{
+  auto &impl = get_impl();
+
+  /*
+    Note: count() waits for and buffers the complete result, so that
+    all remaining rows can be moved out in one pass below.
+  */
+
+  auto cnt = impl.count();
+  ASSERT_NUM_LIMITS(row_count_t, cnt);
+
+  RowStorage storage;
+  storage.m_impl = std::make_shared<RowStorage::Impl>();
+
+  /*
+    Move row data out of the result cache - a handoff of the per-row
+    buffers, no field data is copied. The meta-data instance is shared
+    with row handles already produced by this result.
+  */
+
+  auto &rows = storage.m_impl->m_rows;
+  rows.resize((size_t)cnt);
+  impl.get_rows(rows.data(), (row_count_t)cnt);
+  storage.m_impl->m_mdata = impl.get_mdata();
+
+  return storage;
+}
+
+
+template<>
+void Row_result_detail<Columns>::set_access_pattern(
+  std::vector<mysqlx::col_count_t> cols
+)
+{
+  // Note: the public API and the CDK layer use different column index types.
+
+  auto &pattern = get_impl().m_access_pattern;
+  pattern.assign(cols.begin(), cols.end());
+}
+
+
+template<>
+void Row_result_detail<Columns>::stream_column(
+  mysqlx::col_count_t pos, std::function<size_t(mysqlx::bytes)> sink
+)
+{
+  get_impl().m_field_sinks[pos] =
+    [sink](cdk::bytes chunk) -> size_t
+    {
+      return sink(mysqlx::bytes::Access::mk(chunk));
+    };
+}
+
+
+template<>
+std::vector<ColumnBatch> Row_result_detail<Columns>::fetch_columns()
+{
+  std::vector<common::Column_batch> batches;
+  get_impl().fetch_columns(batches);
+
+  /*
+    Move decoded column data into the public ColumnBatch instances. The
+    vector members are of identical types, so the data is moved, not
+    copied.
+  */
+
+  std::vector<ColumnBatch> res(batches.size());
+
+  for (size_t pos = 0; pos < batches.size(); ++pos)
+  {
+    auto &src = batches[pos];
+    auto &dst = res[pos];
+
+    dst.kind    = ColumnBatch::Kind(src.kind);
+    dst.nulls   = std::move(src.nulls);
+    dst.sints   = std::move(src.sints);
+    dst.uints   = std::move(src.uints);
+    dst.doubles = std::move(src.doubles);
+    dst.arena   = std::move(src.arena);
+    dst.offsets = std::move(src.offsets);
+  }
+
+  return res;
+}
+
+
+template<>
+uint64_t Row_result_detail<Columns>::spool(const std::string &path)
+{
+  return get_impl().spool(path);
+}
+
+
+template<>
+void Row_result_detail<Columns>::reserve(
+  mysqlx::row_count_t rows, uint64_t bytes
+)
+{
+  get_impl().reserve(rows, (size_t)bytes);
+}
+
+
+template<>
+std::vector<ArrowColumn> Row_result_detail<Columns>::fetch_arrow()
+{
+  std::vector<common::Arrow_column> cols;
+  get_impl().fetch_arrow(cols);
+
+  // As in fetch_columns(), the decoded buffers are moved, not copied.
+
+  std::vector<ArrowColumn> res(cols.size());
+
+  for (size_t pos = 0; pos < cols.size(); ++pos)
+  {
+    auto &src = cols[pos];
+    auto &dst = res[pos];
+
+    dst.name       = std::move(src.name);
+    dst.type       = ArrowColumn::Type(src.type);
+    dst.length     = src.length;
+    dst.null_count = src.null_count;
+    dst.validity   = std::move(src.validity);
+    dst.ints       = std::move(src.ints);
+    dst.uints      = std::move(src.uints);
+    dst.doubles    = std::move(src.doubles);
+    dst.offsets    = std::move(src.offsets);
+    dst.data       = std::move(src.data);
+  }
+
+  return res;
+}
+
+
+/*
+  RowStorage
+  ==========
+*/
+
+
+mysqlx::row_count_t RowStorage::row_count() const
+{
+  if (!m_impl)
+    return 0;
+  auto cnt = m_impl->m_rows.size();
+  ASSERT_NUM_LIMITS(row_count_t, cnt);
+  return (row_count_t)cnt;
+}
+
+
+mysqlx::col_count_t RowStorage::col_count() const
+{
+  if (!m_impl || !m_impl->m_mdata)
+    return 0;
+  return m_impl->m_mdata->col_count();
+}
+
+
+mysqlx::bytes
+RowStorage::get_bytes(mysqlx::row_count_t row, mysqlx::col_count_t col) const
+{
+  if (!m_impl)
+    throw std::out_of_range("empty row storage");
+
+  const Row_data &data = m_impl->m_rows.at((size_t)row);
+
+  // Note: a column without a field in the row holds a null value.
+
+  if (!data.has_field(col))
+    return mysqlx::bytes();
+
+  return mysqlx::bytes::Access::mk(data.field(col));
+}
+
+
+mysqlx::bytes
+RowStorage::get_view(mysqlx::row_count_t row, mysqlx::col_count_t col) const
+{
+  if (!m_impl)
+    throw std::out_of_range("empty row storage");
+
+  const Row_data &rdata = m_impl->m_rows.at((size_t)row);
+
+  if (!rdata.has_field(col))
+    return mysqlx::bytes();
+
+  cdk::bytes data = rdata.field(col);
+
+  /*
+    As in Row_detail::get_view(), the artificial trailing 0x00 byte of
+    string-like columns is not part of the field data and should not be
+    seen through the view.
+  */
+
+  if (0 < data.size() && m_impl->m_mdata)
+  {
+    switch (m_impl->m_mdata->get_format(col).m_type)
+    {
+    case cdk::TYPE_STRING:
+    case cdk::TYPE_BYTES:
+    case cdk::TYPE_DOCUMENT:
+      data = cdk::bytes(data.begin(), data.end() - 1);
+      break;
+    default:
+      break;
+    }
+  }
+
+  return mysqlx::bytes::Access::mk(data);
+}
+
+
 /*
   DocResult
   =========
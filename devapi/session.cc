@@ -232,6 +232,61 @@ void Client_detail::close()
 }
 
 
+void Client_detail::resize_pool(size_t max)
+{
+  if (!m_impl)
+    THROW("Invalid client");
+  m_impl->resize(max);
+}
+
+
+void Client_detail::drain_pool()
+{
+  if (!m_impl)
+    THROW("Invalid client");
+  m_impl->drain();
+}
+
+
+void Client_detail::resume_pool()
+{
+  if (!m_impl)
+    THROW("Invalid client");
+  m_impl->resume();
+}
+
+
+void Client_detail::shrink_caches()
+{
+  if (!m_impl)
+    THROW("Invalid client");
+  m_impl->shrink_caches();
+}
+
+
+ClientStats Client_detail::get_stats() const
+{
+  if (!m_impl)
+    THROW("Invalid client");
+
+  common::Session_pool::Stats stats;
+  m_impl->get_stats(stats);
+
+  ClientStats res;
+
+  res.pool_size = stats.pool_size;
+  res.idle_count = stats.idle_count;
+  res.sessions_created = stats.sessions_created;
+  res.sessions_closed = stats.sessions_closed;
+  res.checkouts = stats.checkouts;
+  res.checkout_hits = stats.checkout_hits;
+  res.affinity_hits = stats.affinity_hits;
+  res.acquire_wait_usec = stats.acquire_wait_usec;
+
+  return res;
+}
+
+
 /*
   Session implementation
   ======================
@@ -245,6 +300,52 @@ Session_detail::Session_detail(common::Settings_impl &settings)
     settings.get_data_source(source);
     m_impl = std::make_shared<Impl>(source);
 
+    using Option = common::Settings_impl::Session_option_impl;
+
+    if (settings.has_option(Option::PREFETCH_ROWS))
+      m_impl->set_prefetch_rows(
+        (size_t)settings.get(Option::PREFETCH_ROWS).get_uint());
+
+    if (settings.has_option(Option::INSERT_CHUNK_SIZE))
+      m_impl->set_insert_chunk_size(
+        (size_t)settings.get(Option::INSERT_CHUNK_SIZE).get_uint());
+
+    if (settings.has_option(Option::METADATA_CACHE_TTL))
+      m_impl->set_metadata_cache_ttl(
+        settings.get(Option::METADATA_CACHE_TTL).get_uint());
+
+    if (settings.has_option(Option::MAX_RESULT_BUFFER))
+      m_impl->set_max_result_buffer(
+        (size_t)settings.get(Option::MAX_RESULT_BUFFER).get_uint());
+
+    if (settings.has_option(Option::PREPARE_THRESHOLD))
+      m_impl->set_prepare_threshold(
+        (size_t)settings.get(Option::PREPARE_THRESHOLD).get_uint());
+
+    if (settings.has_option(Option::SUBMIT_WINDOW))
+      m_impl->set_submit_window(
+        (size_t)settings.get(Option::SUBMIT_WINDOW).get_uint());
+
+    if (settings.has_option(Option::VALIDATED_TRANSPORT))
+      m_impl->set_validated_transport(
+        settings.get(Option::VALIDATED_TRANSPORT).get_bool());
+
+    if (settings.has_option(Option::STATEMENT_TIMEOUT))
+      m_impl->set_statement_timeout(
+        settings.get(Option::STATEMENT_TIMEOUT).get_uint());
+
+    if (settings.has_option(Option::AUTO_RECONNECT))
+      m_impl->set_auto_reconnect(
+        settings.get(Option::AUTO_RECONNECT).get_bool());
+
+    if (settings.has_option(Option::SKIP_WARNINGS))
+      m_impl->set_skip_warnings(
+        settings.get(Option::SKIP_WARNINGS).get_bool());
+
+    if (settings.has_option(Option::CONCURRENT_READS))
+      m_impl->set_concurrent_reads(
+        settings.get(Option::CONCURRENT_READS).get_bool());
+
   }
   catch (const cdk::foundation::connection::TLS::Options::TLS_version::Error &e)
   {
@@ -293,22 +394,187 @@ void Session_detail::prepare_for_cmd()
 }
 
 
+Session_detail::Session_detail(Shared_session_impl impl)
+{
+  m_impl = std::move(impl);
+  m_impl->add_logical_owner();
+}
+
+
 void Session_detail::close()
 {
-  m_impl->release();
+  /*
+    The implementation can be shared by several logical sessions (see
+    Session::multiplex()) - the underlying connection is released only
+    when the last of them is closed.
+  */
+
+  if (m_impl->remove_logical_owner())
+    m_impl->release();
   m_impl.reset();
 }
 
 
 
+// ---------------------------------------------------------------------
+
+/*
+  Read-your-writes support (see Session::waitForExecutedGtidSet()).
+*/
+
+void Session_detail::wait_executed_gtids(const string &gtids, unsigned timeout_sec)
+{
+  m_impl->pipeline_gtid_wait(std::string(gtids), timeout_sec);
+}
+
+
+// ---------------------------------------------------------------------
+
+/*
+  Session bootstrap (see Session::bootstrap()).
+
+  The declared preamble is built as a list of regular statement ops whose
+  commands are accumulated in the session pipeline and sent with a single
+  write. Server replies are examined only after the whole batch is on the
+  wire, so the preamble costs one network round trip regardless of how
+  many statements it declares.
+*/
+
+void SessionBootstrap::execute()
+{
+  if (!m_impl)
+    THROW("Invalid session");
+
+  /*
+    The ops implementing the preamble, in the order in which they are
+    sent, each paired with the collection check it implements (null for
+    plain statements).
+  */
+
+  std::list<
+    std::pair<
+      std::unique_ptr<Executable_if>,
+      const std::pair<std::string, std::string>*
+    >
+  > ops;
+
+  if (!m_schema.empty())
+    ops.emplace_back(
+      std::unique_ptr<Executable_if>(
+        new Op_sql(m_impl, "USE `" + m_schema + "`")
+      ),
+      nullptr
+    );
+
+  for (auto &var : m_vars)
+  {
+    std::unique_ptr<Op_sql> op(
+      new Op_sql(m_impl, "SET SESSION " + var.first + " = ?")
+    );
+    op->add_param((const impl::common::Value&)var.second);
+    ops.emplace_back(std::move(op), nullptr);
+  }
+
+  for (auto &stmt : m_stmts)
+    ops.emplace_back(
+      std::unique_ptr<Executable_if>(new Op_sql(m_impl, stmt)),
+      nullptr
+    );
+
+  for (auto &check : m_checks)
+  {
+    Schema_ref schema(check.first);
+    ops.emplace_back(
+      std::unique_ptr<Executable_if>(
+        new Op_list<Object_type::COLLECTION>(m_impl, schema, check.second)
+      ),
+      &check
+    );
+  }
+
+  if (ops.empty())
+  {
+    m_impl.reset();
+    return;
+  }
+
+  /*
+    Send the whole preamble as one explicit pipeline. A pending submit
+    batch is flushed first so that the coalescing layer does not manage
+    the pipeline under us.
+  */
+
+  m_impl->flush_submit_batch();
+  m_impl->m_sess->start_pipeline(false);
+
+  try {
+    for (auto &op : ops)
+      op.first->submit();
+    m_impl->m_sess->flush_pipeline();
+  }
+  catch (...)
+  {
+    m_impl->m_sess->clear_pipeline();
+    throw;
+  }
+
+  /*
+    Examine the replies in submission order. A server error of one of
+    the statements is thrown from the corresponding wait; replies of the
+    statements that follow are discarded when the session sends its next
+    command.
+  */
+
+  for (auto &op : ops)
+  {
+    Result_init &init = op.first->wait_execute();
+
+    if (!op.second)
+      continue;
+
+    // A collection check: the list_objects reply must contain a row.
+
+    Result_impl res(init);
+    if (!res.get_row())
+      throw_error(
+        ("Collection `" + op.second->first + "`.`" + op.second->second
+         + "` does not exist").c_str()
+      );
+  }
+
+  // The builder can not be executed again.
+
+  m_impl.reset();
+}
+
+
 // ---------------------------------------------------------------------
 
 /*
   Transactions.
 */
 
-void Session_detail::start_transaction()
+void Session_detail::start_transaction(bool batch)
 {
+  if (batch)
+  {
+    /*
+      Batch mode: the command is sent without waiting for the server reply,
+      so that it travels in the same network round-trip as the first
+      statement of the transaction. Its status is examined at the next
+      transaction boundary (see Session_impl::check_trx_pipeline()).
+    */
+
+    m_impl->m_trx_batch = true;
+    m_impl->m_in_trx = true;
+    m_impl->pipeline_trx_cmd("START TRANSACTION");
+    return;
+  }
+
+  // Errors of earlier pipelined commands surface at transaction boundaries.
+
+  m_impl->check_trx_pipeline(true);
+
   Op_trx<Trx_op::BEGIN> cmd(m_impl);
   cmd.execute();
 }
@@ -316,6 +582,16 @@ void Session_detail::start_transaction()
 
 void Session_detail::commit()
 {
+  if (m_impl->m_trx_batch)
+  {
+    m_impl->m_trx_batch = false;
+    m_impl->m_in_trx = false;
+    m_impl->pipeline_trx_cmd("COMMIT");
+    return;
+  }
+
+  m_impl->check_trx_pipeline(true);
+
   Op_trx<Trx_op::COMMIT> cmd(m_impl);
   cmd.execute();
 }
@@ -325,6 +601,12 @@ void Session_detail::rollback(const mysqlx::string &sp)
 {
   Op_trx<Trx_op::ROLLBACK> cmd(m_impl, sp);
   cmd.execute();
+
+  if (sp.empty())
+  {
+    m_impl->m_trx_batch = false;
+    m_impl->check_trx_pipeline(true);
+  }
 }
 
 mysqlx::string Session_detail::savepoint_set(const mysqlx::string &sp)
@@ -341,6 +623,70 @@ void Session_detail::savepoint_remove(const mysqlx::string &sp)
 }
 
 
+SessionStats Session_detail::get_stats() const
+{
+  if (!m_impl)
+    THROW("Invalid session");
+
+  const auto &stats = m_impl->protocol_stats();
+
+  SessionStats res;
+
+  res.stmts_executed = m_impl->m_stmt_count;
+  res.bytes_sent = stats.bytes_sent;
+  res.bytes_received = stats.bytes_received;
+  res.msgs_sent = stats.msgs_sent;
+  res.msgs_received = stats.msgs_received;
+  res.frames_sent = stats.frames_sent;
+  res.frames_received = stats.frames_received;
+  res.uncompressed_sent = stats.uncompressed_sent;
+  res.uncompressed_received = stats.uncompressed_received;
+  res.max_write_size = stats.max_write_size;
+
+  const auto &timings = m_impl->connect_timings();
+
+  res.connect_tcp_usec = timings.tcp_usec;
+  res.connect_tls_usec = timings.tls_usec;
+  res.connect_caps_usec = timings.caps_usec;
+  res.connect_auth_usec = timings.auth_usec;
+
+  res.allocs = cdk::foundation::alloc_stats_count();
+
+  return res;
+}
+
+
+void Session_detail::set_notice_handler(
+  std::function<void(unsigned, mysqlx::bytes)> handler
+)
+{
+  if (!m_impl)
+    THROW("Invalid session");
+
+  if (!handler)
+  {
+    m_impl->m_sess->set_notice_handler(cdk::mysqlx::Session::Notice_handler());
+    return;
+  }
+
+  m_impl->m_sess->set_notice_handler(
+    [handler](unsigned type, cdk::bytes data)
+    {
+      handler(type, mysqlx::bytes(data.begin(), data.size()));
+    }
+  );
+}
+
+
+void Session_detail::restore_state(const Session_detail &other)
+{
+  if (!m_impl || !other.m_impl)
+    THROW("Invalid session");
+
+  m_impl->restore_state(*other.m_impl);
+}
+
+
 // ---------------------------------------------------------------------
 
 
@@ -437,6 +783,33 @@ void Schema_detail::drop_collection(const mysqlx::string& name)
 }
 
 
+/*
+  Existence checks.
+
+  The list queries are the same as the ones behind the corresponding
+  Name_src, but the answer can be served from (and is stored in) the
+  session's metadata cache - see check_schema_exists() and related
+  helpers in op_impl.h.
+*/
+
+bool Schema_detail::schema_exists()
+{
+  Schema_ref schema(m_name);
+  return check_schema_exists(m_sess, schema);
+}
+
+
+unsigned Schema_detail::object_exists(Obj_type type, const mysqlx::string &name)
+{
+  Object_ref obj(m_name, name);
+
+  if (TABLE == type)
+    return (unsigned)check_table_exists(m_sess, obj);
+
+  return check_object_exists<Object_type::COLLECTION>(m_sess, obj) ? 1 : 0;
+}
+
+
 
 Schema_detail::Name_src::Name_src(
   const Schema &sch,
@@ -49,6 +49,7 @@
 #include "common/error.h"
 #include "common/util.h"
 #include "common/value.h"
+#include "common/expr.h"
 #include "common/settings.h"
 
 PUSH_SYS_WARNINGS
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef MYSQLX_COMMON_EXPR_H
+#define MYSQLX_COMMON_EXPR_H
+
+
+#include "api.h"
+#include "value.h"
+
+PUSH_SYS_WARNINGS
+#include <memory>
+#include <string>
+#include <vector>
+POP_SYS_WARNINGS
+
+
+namespace mysqlx {
+MYSQLX_ABI_BEGIN(2,0)
+
+namespace common {
+
+/*
+  A single node of an expression tree built directly by user code.
+
+  Such trees are produced by the typed expression builder API (class
+  mysqlx::Expr of DevAPI) and passed to operation implementations through
+  the Select_if::set_where() interface. The connector walks the tree and
+  reports it to the protocol layer through cdk expression processor
+  callbacks, so no expression string is ever built or parsed on this path.
+
+  Which of the payload members are used depends on the node kind. Operator
+  names stored in OP nodes are the protocol operator names, the same which
+  the expression parser reports ("==", "&&", "not", "like", "between", "in"
+  and so on, see the operator list in the parser).
+
+  Note: document paths are stored as a list of field names. Paths with
+  array indexes or wildcards are not expressible here - such criteria can
+  still be given as expression strings.
+*/
+
+struct Expr_node
+{
+  enum Kind {
+    LITERAL,  ///< literal value stored in m_value
+    FIELD,    ///< document field with path members m_path (empty = whole doc)
+    COLUMN,   ///< column reference [[m_schema.]m_table.]m_name[->m_path]
+    PARAM,    ///< named parameter m_name
+    OP,       ///< operator m_name applied to arguments m_args
+    FUNC,     ///< call of function [m_schema.]m_name with arguments m_args
+    ARRAY     ///< array with elements m_args
+  };
+
+  Kind m_kind = LITERAL;
+
+  Value m_value;
+  std::string m_name;
+  std::string m_table;
+  std::string m_schema;
+  std::vector<std::string> m_path;
+  std::vector<std::shared_ptr<Expr_node>> m_args;
+};
+
+}  // common
+
+MYSQLX_ABI_END(2,0)
+}  // mysqlx
+
+#endif
@@ -43,7 +43,11 @@
 
 #include "api.h"
 #include "../common_constants.h"
+#include <cstdint>  // uint64_t in Collection_find_if::find_cached()
+#include <memory>   // std::shared_ptr in Select_if::set_where()
 #include <string>
+#include <utility>  // std::pair in Table_insert_if::Field_view
+#include <vector>   // document lists in Collection_find_if
 
 
 namespace mysqlx {
@@ -52,6 +56,7 @@ namespace common {
 
 class Result_init;
 class Value;
+struct Expr_node;
 
 #define LOCK_MODE(X,N)  X = N,
 enum Lock_mode
@@ -98,6 +103,34 @@ struct Executable_if
 
   virtual Result_init& execute() = 0;
 
+  /*
+    Split asynchronous execution: submit() starts executing the operation
+    without waiting for the server reply, is_ready() drives the execution
+    forward and tells (without blocking) whether the reply has arrived and
+    wait_execute() waits for completion, returning the same Result_init
+    reference as execute() does.
+  */
+
+  virtual void submit() = 0;
+
+  virtual bool is_ready() = 0;
+
+  virtual Result_init& wait_execute() = 0;
+
+  /*
+    Perform ahead-of-time compilation of the operation: everything which
+    does not depend on parameter values bound at execution time. After
+    this call the first execution prepares a server-side statement in the
+    same round trip and later executions send only the statement id and
+    the bind values. Errors in the operation specification (such as syntax
+    errors in criteria) are reported here instead of at execution time.
+
+    The default does nothing - operations compile what they can and leave
+    the rest to the first execution.
+  */
+
+  virtual void precompile() {}
+
   virtual Executable_if *clone() const = 0;
 
   virtual ~Executable_if() {}
@@ -202,10 +235,28 @@ struct Select_if : public Base
 
   virtual void set_where(const string&) = 0;
 
+  /*
+    Set selection criteria as an expression tree built with the typed
+    expression builder API (see common/expr.h). The tree is reported to
+    the protocol layer directly, without parsing any expression string.
+  */
+
+  virtual void set_where(std::shared_ptr<Expr_node>) = 0;
+
   // Define lock mode for rows/documents returned by the query.
 
   virtual void set_lock_mode(Lock_mode, Lock_contention) = 0;
   virtual void clear_lock_mode() = 0;
+
+  /*
+    Attach optimizer hints to the operation, given as a list of
+    optimizer_switch flags (such as "prefer_ordering_index=off"). The
+    flags are applied on the server for the duration of each execution
+    of this operation only (see Op_base::init()).
+  */
+
+  virtual void set_hints(const string&) = 0;
+  virtual void clear_hints() = 0;
 };
 
 
@@ -213,7 +264,24 @@ struct Select_if : public Base
 
 
 struct Collection_find_if : public Select_if<Proj_if>
-{};
+{
+  /*
+    Bounded-staleness execution support (see CollectionFind::executeCached()).
+
+    find_cached() looks in the session's query cache for a result of this
+    very statement - same shape and same bound parameter and limit values -
+    fetched within the given staleness budget (in milliseconds). On a hit
+    the cached documents are returned as JSON text. On a miss the caller
+    executes the statement and hands the fetched documents to
+    store_cached() for later executions.
+  */
+
+  virtual bool find_cached(
+    uint64_t staleness_ms, std::vector<std::string> &docs
+  ) = 0;
+
+  virtual void store_cached(std::vector<std::string> &&docs) = 0;
+};
 
 
 /*
@@ -229,6 +297,17 @@ struct Collection_add_if : public Executable_if
 
   virtual void add_json(const std::string&) = 0;
   virtual void clear_docs() = 0;
+
+  /*
+    Enable write-combining of added documents: accumulated documents
+    are shipped to the server in pipelined chunks whenever the pending
+    chunk would grow beyond `bytes`, or the oldest pending document is
+    older than `ms` milliseconds (0 disables the time trigger).
+    Execution ships what remains and combines the statistics of all
+    chunks (see CollectionAdd::autoFlush()).
+  */
+
+  virtual void set_flush_policy(uint64_t bytes, uint64_t ms) = 0;
 };
 
 
@@ -294,6 +373,18 @@ struct Table_insert_if : public Executable_if
 
   virtual void add_row(const Row_impl&) = 0;
   virtual void clear_rows() = 0;
+
+  /*
+    Pass to the implementation a borrowed row of `count` fields, each
+    given as a byte range holding the raw value. Contrary to add_row()
+    the field data is not copied - the caller must keep it valid until
+    the operation has been executed. A field with a null base pointer
+    denotes SQL NULL.
+  */
+
+  using Field_view = std::pair<const byte*, size_t>;
+
+  virtual void add_row_view(const Field_view *fields, unsigned count) = 0;
 };
 
 
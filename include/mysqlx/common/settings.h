@@ -49,6 +49,7 @@ PUSH_SYS_WARNINGS
 #include <map>
 #include <bitset>
 #include <sstream>
+#include <memory>
 POP_SYS_WARNINGS
 
 
@@ -157,12 +158,12 @@ public:
 
   iterator begin() const
   {
-    return m_data.m_options.cbegin();
+    return m_data->m_options.cbegin();
   }
 
   iterator end() const
   {
-    return m_data.m_options.cend();
+    return m_data->m_options.cend();
   }
 
   /*
@@ -236,7 +237,51 @@ protected:
 
   };
 
-  Data m_data;
+  /*
+    Settings data is kept behind a shared pointer and treated as immutable
+    while shared: copying a Settings_impl object, or passing settings
+    around when creating new sessions, only bumps the reference count
+    instead of deep-copying the option list with all its string values.
+    Code that modifies the data must first detach it from other settings
+    objects which share it, see data_detach().
+  */
+
+DLL_WARNINGS_PUSH
+
+  std::shared_ptr<Data> m_data = std::make_shared<Data>();
+
+DLL_WARNINGS_POP
+
+  const Data& data() const
+  {
+    return *m_data;
+  }
+
+  /*
+    Get settings data for modification, detaching it first if it is
+    shared with other settings objects (copy-on-write).
+  */
+
+  Data& data_detach()
+  {
+    if (1 < m_data.use_count())
+      m_data = std::make_shared<Data>(*m_data);
+    return *m_data;
+  }
+
+DLL_WARNINGS_PUSH
+
+  /*
+    CDK data source built from the current settings, cached by
+    get_data_source() so that creating many sessions from one settings
+    object does not rebuild it every time. Reset whenever settings
+    change. Not used for DNS+SRV configurations, which perform a fresh
+    lookup for every session.
+  */
+
+  std::shared_ptr<cdk::ds::Multi_source> m_cached_source;
+
+DLL_WARNINGS_POP
 
 };
 
@@ -311,13 +356,13 @@ const common::Value& Settings_impl::get(int opt) const
 {
   using std::find_if;
 
-  auto it = find_if(m_data.m_options.crbegin(), m_data.m_options.crend(),
+  auto it = find_if(m_data->m_options.crbegin(), m_data->m_options.crend(),
     [opt](opt_val_t el) -> bool { return el.first == opt; }
   );
 
   static Value null_value;
 
-  if (it == m_data.m_options.crend())
+  if (it == m_data->m_options.crend())
     return null_value;
 
   return it->second;
@@ -334,17 +379,17 @@ bool Settings_impl::has_option(int opt) const
   switch (opt)
   {
   case Session_option_impl::TLS_VERSIONS:
-    if (m_data.m_tls_vers)
+    if (m_data->m_tls_vers)
       return true;
     break;
 
   case Session_option_impl::TLS_CIPHERSUITES:
-    if (m_data.m_tls_ciphers)
+    if (m_data->m_tls_ciphers)
       return true;
     break;
 
   case Session_option_impl::COMPRESSION_ALGORITHMS:
-    if (m_data.m_compression_algorithms)
+    if (m_data->m_compression_algorithms)
       return true;
     break;
 
@@ -352,8 +397,8 @@ bool Settings_impl::has_option(int opt) const
     break;
   }
 
-  return m_data.m_options.cend() !=
-  find_if(m_data.m_options.cbegin(), m_data.m_options.cend(),
+  return m_data->m_options.cend() !=
+  find_if(m_data->m_options.cbegin(), m_data->m_options.cend(),
     [opt](opt_val_t el) -> bool { return el.first == opt; }
   );
 
@@ -363,7 +408,8 @@ bool Settings_impl::has_option(int opt) const
 inline
 void Settings_impl::erase(int opt)
 {
-  m_data.erase(opt);
+  data_detach().erase(opt);
+  m_cached_source.reset();
 }
 
 
@@ -38,6 +38,8 @@
 
 PUSH_SYS_WARNINGS
 #include <string>
+#include <new>
+#include <utility>
 POP_SYS_WARNINGS
 
 
@@ -84,15 +86,44 @@ protected:
 
   Type m_type;
 
-  // TODO: Use std::variant to save space
+  /*
+    String storage.
+
+    A value holds at most one string: the utf8 string for STRING, RAW,
+    EXPR and JSON values (and for the raw representation of values decoded
+    from the wire), or the utf16 string for USTRING values. Both encodings
+    share a single slot in m_store, so that a value does not pay for the
+    encoding it does not use and constructs at most one string object per
+    cell. Small strings then live entirely inside the value object thanks
+    to the small-string optimization of the standard string classes.
+
+    The string of the other encoding, when requested through get_string()
+    or get_ustring(), is created on first use and kept in m_conv. It
+    points at a std::string when the stored string is utf16 and at a
+    std::u16string otherwise. The cache is not copied together with a
+    value - a copy re-creates it on demand.
+  */
+
+  enum Str_tag { STR_NONE, STR_UTF8, STR_UTF16 };
 
   DLL_WARNINGS_PUSH
 
-  std::string     m_str;
-  std::u16string  m_ustr;
+  union Str_store
+  {
+    std::string    str;
+    std::u16string ustr;
+
+    Str_store() {}
+    ~Str_store() {}
+  };
+
+  Str_store m_store;
+  mutable void *m_conv = nullptr;
 
   DLL_WARNINGS_POP
 
+  Str_tag m_tag = STR_NONE;
+
   union {
     double   v_double;
     float    v_float;
@@ -101,6 +132,91 @@ protected:
     bool     v_bool;
   } m_val;
 
+  /*
+    Return the stored utf8/utf16 string, creating an empty one if the value
+    stores no string yet. Must not be called when a string of the other
+    encoding is stored.
+  */
+
+  std::string& str_storage()
+  {
+    if (STR_UTF8 != m_tag)
+    {
+      new (&m_store.str) std::string();
+      m_tag = STR_UTF8;
+    }
+    return m_store.str;
+  }
+
+  std::u16string& ustr_storage()
+  {
+    if (STR_UTF16 != m_tag)
+    {
+      new (&m_store.ustr) std::u16string();
+      m_tag = STR_UTF16;
+    }
+    return m_store.ustr;
+  }
+
+  // Drop the conversion cache and destroy the stored string (if any).
+
+  void clear_str()
+  {
+    if (m_conv)
+    {
+      if (STR_UTF16 == m_tag)
+        delete (std::string*)m_conv;
+      else
+        delete (std::u16string*)m_conv;
+      m_conv = nullptr;
+    }
+
+    switch (m_tag)
+    {
+    case STR_UTF8:  m_store.str.~basic_string();  break;
+    case STR_UTF16: m_store.ustr.~basic_string(); break;
+    default: break;
+    }
+
+    m_tag = STR_NONE;
+  }
+
+  // Initialize own (empty) string storage from another value.
+
+  void copy_str(const Value &other)
+  {
+    switch (other.m_tag)
+    {
+    case STR_UTF8:
+      new (&m_store.str) std::string(other.m_store.str);
+      break;
+    case STR_UTF16:
+      new (&m_store.ustr) std::u16string(other.m_store.ustr);
+      break;
+    default:
+      break;
+    }
+    m_tag = other.m_tag;
+  }
+
+  void move_str(Value &&other)
+  {
+    switch (other.m_tag)
+    {
+    case STR_UTF8:
+      new (&m_store.str) std::string(std::move(other.m_store.str));
+      break;
+    case STR_UTF16:
+      new (&m_store.ustr) std::u16string(std::move(other.m_store.ustr));
+      break;
+    default:
+      break;
+    }
+    m_tag = other.m_tag;
+    m_conv = other.m_conv;
+    other.m_conv = nullptr;
+  }
+
   void print(std::ostream&) const override;
 
   template <typename T>
@@ -116,17 +232,73 @@ public:
   Value() : m_type(VNULL)
   {}
 
+  Value(const Value &other)
+    : m_type(other.m_type), m_val(other.m_val)
+  {
+    copy_str(other);
+  }
+
+  Value(Value &&other)
+    : m_type(other.m_type), m_val(other.m_val)
+  {
+    move_str(std::move(other));
+  }
+
+  Value& operator=(const Value &other)
+  {
+    if (this != &other)
+    {
+      clear_str();
+      m_type = other.m_type;
+      m_val = other.m_val;
+      copy_str(other);
+    }
+    return *this;
+  }
+
+  Value& operator=(Value &&other)
+  {
+    if (this != &other)
+    {
+      clear_str();
+      m_type = other.m_type;
+      m_val = other.m_val;
+      move_str(std::move(other));
+    }
+    return *this;
+  }
+
+  ~Value()
+  {
+    clear_str();
+  }
+
 
   // Construct an item from a string
-  Value(const std::string& str) : m_type(STRING), m_str(str)
+  Value(const std::string& str) : m_type(STRING)
   {
     m_val.v_bool = false;
+    str_storage() = str;
+  }
+
+  Value(std::string &&str) : m_type(STRING)
+  {
+    m_val.v_bool = false;
+    str_storage() = std::move(str);
   }
 
   Value(const std::u16string &str)
-    : m_type(USTRING), m_ustr(str)
+    : m_type(USTRING)
+  {
+    m_val.v_bool = false;
+    ustr_storage() = str;
+  }
+
+  Value(std::u16string &&str)
+    : m_type(USTRING)
   {
     m_val.v_bool = false;
+    ustr_storage() = std::move(str);
   }
 
 
@@ -154,8 +326,8 @@ public:
   // Construct an item from bytes
   Value(const byte *ptr, size_t len) : m_type(RAW)
   {
-    // Note: bytes are copied to m_str member.
-    m_str.assign((const char*)ptr, len);
+    // Note: bytes are copied to the string storage.
+    str_storage().assign((const char*)ptr, len);
   }
 
   // Other numeric conversions
@@ -263,24 +435,24 @@ public:
     switch (m_type)
     {
     case USTRING:
-      if (!m_ustr.empty())
+      if (STR_UTF16 == m_tag && !m_store.ustr.empty())
       {
         if (size)
-          *size = m_ustr.size() * sizeof(char16_t);
-        return (const byte*)m_ustr.data();
+          *size = m_store.ustr.size() * sizeof(char16_t);
+        return (const byte*)m_store.ustr.data();
       }
       FALLTHROUGH;
 
     default:
-      if (m_str.empty())
+      if (STR_UTF8 != m_tag || m_store.str.empty())
         throw Error("Value cannot be converted to raw bytes");
       FALLTHROUGH;
 
     case RAW:
     case STRING:
       if (size)
-        *size = m_str.length();
-      return (const byte*)m_str.data();
+        *size = m_store.str.length();
+      return (const byte*)m_store.str.data();
 
     }
   }
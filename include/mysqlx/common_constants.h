@@ -67,6 +67,11 @@
   the pool (ms). (No timeout by default)*/                                     \
   OPT_NUM(x,POOL_MAX_IDLE_TIME,4)/*!< time for a connection to be in the pool
   without being used (ms).(Will not expire by default)*/                       \
+  OPT_NUM(x,POOL_MIN_SIZE,5) /*!< number of ready connections maintained in
+  the pool by a background warm-up task. (Defaults to 0 - no warm-up)*/        \
+  OPT_NUM(x,MAX_CACHE_BYTES,6) /*!< byte budget for the client-side caches
+  aggregated over all sessions of the client; when exceeded, caches are
+  shrunk in priority order. (Defaults to 0 - no budget)*/                      \
   END_LIST
 
 
@@ -138,6 +143,115 @@
     Specify compression algorithms in order of preference
   */                                                                        \
   OPT_STR(x,COMPRESSION_ALGORITHMS,18)                                      \
+  /*!
+    Compression effort level for the negotiated algorithm. The meaning of
+    the value is algorithm specific; if not set the algorithm default
+    is used.
+  */                                                                        \
+  OPT_NUM(x,COMPRESSION_LEVEL,19)                                           \
+  /*!
+    Number of rows read ahead into the internal cache when result rows
+    are consumed one by one. Default is 16.
+  */                                                                        \
+  OPT_NUM(x,PREFETCH_ROWS,20)                                               \
+  /*!
+    Byte budget for a single insert message. Add/insert operations which
+    accumulate more data send it as a sequence of smaller inserts instead
+    of one big message. Default is 16MB.
+  */                                                                        \
+  OPT_NUM(x,INSERT_CHUNK_SIZE,21)                                           \
+  /*!
+    Time budget, in milliseconds, for re-using answers to object existence
+    checks (`existsInDatabase()` and the `getSchema()`, `getCollection()`
+    and `getTable()` methods with the check flag set) without contacting
+    the server. Default is 0, which means every check queries the server.
+  */                                                                        \
+  OPT_NUM(x,METADATA_CACHE_TTL,22)                                          \
+  /*!
+    Byte budget for buffering rows of a result in memory. When the rows
+    cached for a result approach the budget, further rows are fetched from
+    the server in correspondingly smaller portions (pushing back on the
+    server via the network) and rows of stored results overflow to a
+    temporary file instead of growing the cache. Default is 0, which means
+    no limit.
+  */                                                                        \
+  OPT_NUM(x,MAX_RESULT_BUFFER,23)                                           \
+  /*!
+    Number of times a statement shape must be executed before the connector
+    promotes it to a server-side prepared statement. Default is 1, which
+    means the second execution of a shape prepares it; higher values keep
+    one-off queries from consuming server prepared-statement slots.
+  */                                                                        \
+  OPT_NUM(x,PREPARE_THRESHOLD,24)                                           \
+  /*!
+    Number of asynchronously submitted statements coalesced into one
+    network write. Commands of statements submitted without waiting for
+    their results are batched and sent together once this many have
+    accumulated, or as soon as any result is asked for. Default is 0,
+    which sends each statement on its own.
+  */                                                                        \
+  OPT_NUM(x,SUBMIT_WINDOW,25)                                               \
+  /*!
+    Declare the transport trusted and skip redundant protocol validation.
+    Fixed-shape server messages which repeat byte-identically are then
+    decoded once and their parse re-used for identical frames. Meant for
+    connections on which the transport layer already excludes corruption
+    (e.g. TLS). Disabled by default.
+  */                                                                        \
+  OPT_BOOL(x,VALIDATED_TRANSPORT,26)                                        \
+  /*!
+    Time budget, in milliseconds, for executing a single statement. When
+    the budget is exhausted before the server reply was fully received,
+    the statement fails with a timeout error and the session is closed
+    (the connection is left mid-reply and can not be safely re-used).
+    Default is 0, which means no limit.
+  */                                                                        \
+  OPT_NUM(x,STATEMENT_TIMEOUT,27)                                           \
+  /*!
+    Transparently reconnect after the connection died under an
+    idempotent statement (reads, upserts). The connection is
+    re-established and the session state recorded in the replay log is
+    replayed, pipelined with the re-executed statement. Statements
+    inside an explicit transaction, non-idempotent statements and
+    sessions whose replay log overflowed are not retried - the error is
+    reported as usual. Disabled by default.
+  */                                                                        \
+  OPT_BOOL(x,AUTO_RECONNECT,28)                                             \
+  /*!
+    Drop warning notices of server replies inside the protocol layer,
+    before any diagnostic objects are built. Meant for sessions which
+    never examine warnings, e.g. fire-and-forget writers talking to
+    verbosely configured servers; with this option set, results report
+    no warnings. Errors and state-change notices are not affected.
+    Disabled by default.
+  */                                                                        \
+  OPT_BOOL(x,SKIP_WARNINGS,29)                                              \
+  /*!
+    Enable long distance matching for ZSTD compression. The compressor
+    then searches for repetitions over its whole match window instead
+    of the near past, which significantly improves the ratio of large,
+    self-similar transfers such as table snapshots, at the cost of
+    extra memory on both ends. Ignored when another compression
+    algorithm is negotiated. Disabled by default.
+  */                                                                        \
+  OPT_BOOL(x,COMPRESSION_LONG_MATCHING,30)                                  \
+  /*!
+    ZSTD match window size, given as a power of two (e.g. 27 for a
+    128MB window). Default is 0, which keeps the window implied by the
+    compression level. Ignored when another compression algorithm is
+    negotiated.
+  */                                                                        \
+  OPT_NUM(x,COMPRESSION_WINDOW_LOG,31)                                      \
+  /*!
+    Allow sharing one session between several reader threads. Statement
+    submission is serialized internally and each statement's complete
+    reply is buffered before the next statement runs, so results can be
+    consumed concurrently while statements take turns on the
+    connection. Best suited for read-only workloads; note that session
+    state (current schema, transactions) is shared by all threads.
+    Disabled by default.
+  */                                                                        \
+  OPT_BOOL(x,CONCURRENT_READS,32)                                           \
   END_LIST
 
 
@@ -160,6 +274,20 @@
   X("tls-ciphersuites", TLS_CIPHERSUITES) \
   X("compression", COMPRESSION) \
   X("compression-algorithms", COMPRESSION_ALGORITHMS) \
+  X("compression-level", COMPRESSION_LEVEL) \
+  X("prefetch-rows", PREFETCH_ROWS) \
+  X("insert-chunk-size", INSERT_CHUNK_SIZE) \
+  X("metadata-cache-ttl", METADATA_CACHE_TTL) \
+  X("max-result-buffer", MAX_RESULT_BUFFER) \
+  X("prepare-threshold", PREPARE_THRESHOLD) \
+  X("submit-window", SUBMIT_WINDOW) \
+  X("validated-transport", VALIDATED_TRANSPORT) \
+  X("statement-timeout", STATEMENT_TIMEOUT) \
+  X("auto-reconnect", AUTO_RECONNECT) \
+  X("skip-warnings", SKIP_WARNINGS) \
+  X("compression-long-matching", COMPRESSION_LONG_MATCHING) \
+  X("compression-window-log", COMPRESSION_WINDOW_LOG) \
+  X("concurrent-reads", CONCURRENT_READS) \
   END_LIST
 
 
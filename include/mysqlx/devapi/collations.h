@@ -92,6 +92,26 @@ const char* characterSetName(CharacterSet id)
   @ingroup devapi_res
 */
 
+struct CollationInfo;
+
+namespace internal {
+
+/*
+  Implementations of CollationInfo::compare() and CollationInfo::sortKey()
+  (see devapi/result.cc).
+*/
+
+PUBLIC_API int collation_compare(
+  const CollationInfo&, const std::string&, const std::string&
+);
+
+PUBLIC_API std::string collation_sort_key(
+  const CollationInfo&, const std::string&
+);
+
+}  // internal
+
+
 struct CollationInfo
 {
   /// Numeric collation id, as used by MySQL server.
@@ -118,6 +138,42 @@ struct CollationInfo
   bool  isBinary() const { return m_case == case_bin; }
 
 
+  /**
+    Compare two strings according to this collation, operating directly
+    on their UTF-8 wire-format bytes (no copying or transcoding).
+    Returns a negative value, zero or a positive value when `a` sorts
+    before, equal to or after `b`, like the server would order them.
+
+    Implemented for binary collations over Unicode character sets
+    (where byte order equals code-point order) and for the general_ci
+    collations of the utf8mb4, utf8 and ascii character sets; other
+    collations throw an error. Note that for the general_ci family the
+    cased scripts are Latin, Greek and Cyrillic - as on the server,
+    other code points weigh as themselves.
+  */
+
+  int compare(const std::string &a, const std::string &b) const
+  {
+    return internal::collation_compare(*this, a, b);
+  }
+
+  /**
+    Return a binary sort key for string `str` (given in its UTF-8 wire
+    format) such that comparing sort keys with plain memcmp() orders
+    strings the way compare() does. Useful when the same strings take
+    part in many comparisons, e.g. when sorting or merging large
+    results: the per-comparison cost drops to a memcmp().
+
+    For PAD SPACE collations trailing spaces are insignificant in the
+    keys, matching how the server compares such strings.
+  */
+
+  std::string sortKey(const std::string &str) const
+  {
+    return internal::collation_sort_key(*this, str);
+  }
+
+
   bool  operator==(const CollationInfo &other) const
   {
     return m_id == other.m_id;
@@ -137,8 +193,22 @@ private:
   coll_case m_case;
   const char *m_name;
 
+  /*
+    Note: This constexpr constructor makes it possible to constant
+    initialize the collation constants defined in result.cc, so that
+    they require no initialization code at process startup.
+  */
+
+  constexpr CollationInfo(
+    CharacterSet cs, unsigned id, coll_case cc, const char *name
+  )
+    : m_cs(cs), m_id(id), m_case(cc), m_name(name)
+  {}
+
 public:
 
+  CollationInfo() = default;
+
   struct Access;
   friend Access;
 };
@@ -46,6 +46,7 @@
   - CollectionRemove
   - CollectionFind
   - CollectionModify
+  - CollectionModifyBatch
 
   CRUD operation objects can be created directly, or assigned from
   result of DevAPI methods that create such operations:
@@ -73,6 +74,13 @@
 #include "result.h"
 #include "executable.h"
 #include "crud.h"
+#include "expr_builder.h"
+
+PUSH_SYS_WARNINGS
+#include <list>
+#include <sstream>
+#include <vector>
+POP_SYS_WARNINGS
 
 
 namespace mysqlx {
@@ -209,6 +217,65 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Add a document given as a raw UTF8 JSON string, trusting the input.
+
+    Unlike `add()`, which performs a character encoding conversion of the
+    given string, this method ships the bytes to the server as-is. The
+    only client-side check is a fast structural scan: the document must
+    start with `{` and quotes and brackets must balance. It is meant for
+    pre-validated payloads produced by the application's own serializers,
+    for which full client-side processing duplicates the validation done
+    by the server. A malformed document which passes the structural scan
+    is rejected by the server when the operation is executed.
+  */
+
+  CollectionAdd& addRaw(const std::string &json)
+  {
+    try {
+      add_raw(get_impl(), json.data(), json.length());
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// @copydoc addRaw(const std::string&)
+
+  CollectionAdd& addRaw(const char *json, size_t len)
+  {
+    try {
+      add_raw(get_impl(), json, len);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Enable write-combining of added documents.
+
+    With a policy set, documents accumulated by `add()`/`addRaw()` are
+    shipped to the server in pipelined chunks as soon as the pending
+    chunk would grow beyond `bytes`, or the oldest pending document has
+    waited longer than `ms` milliseconds (0 disables the time trigger);
+    the add loop never waits for the server. `execute()` ships the
+    remaining documents, waits for all chunk replies and returns a
+    single `Result` combining their statistics and generated document
+    ids. Errors of flushed chunks are also reported by `execute()`.
+
+    This suits high-frequency small inserts: accumulating a million
+    tiny documents costs a few thousand round trips instead of holding
+    them all in memory or executing them one by one.
+  */
+
+  CollectionAdd& autoFlush(uint64_t bytes, uint64_t ms = 0)
+  {
+    try {
+      get_impl()->set_flush_policy(bytes, ms);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Collection_add_if;
@@ -275,6 +342,21 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Create an operation which removes documents selected by an expression
+    built with the typed expression builder API (see class `Expr`).
+  */
+
+  CollectionRemove(Collection &coll, const Expr &criteria)
+  {
+    try {
+      reset(internal::Crud_factory::mk_remove(coll));
+      static_cast<common::Collection_remove_if*>(get_impl())
+        ->set_where(criteria.getTree());
+    }
+    CATCH_AND_WRAP
+  }
+
 
   CollectionRemove(const internal::Collection_remove_cmd &other)
   {
@@ -304,11 +386,60 @@ namespace internal {
 
 struct Collection_find_cmd
   : public Executable<DocResult, CollectionFind>
-{};
+{
+  /**
+    Execute the operation with a bounded staleness budget, given in
+    milliseconds.
+
+    If the same query - same criteria, projection, ordering and bound
+    parameter and limit values - was executed through this session within
+    the budget, its documents are returned from a client-side cache without
+    contacting the server. Otherwise the operation is executed normally and
+    the fetched documents are cached for later calls.
+
+    Unlike execute(), the complete result is materialized in memory and
+    returned as a list of documents. A cached result may not reflect writes
+    made after it was fetched, including writes made through this very
+    session - choose the budget accordingly. Queries with criteria given
+    as pre-built expression trees are always sent to the server.
+  */
+
+  std::vector<DbDoc> executeCached(uint64_t staleness_ms)
+  {
+    try {
+      auto *impl = static_cast<common::Collection_find_if*>(get_impl());
+
+      std::vector<DbDoc> res;
+      std::vector<std::string> docs;
+
+      if (impl->find_cached(staleness_ms, docs))
+      {
+        for (std::string &json : docs)
+          res.push_back(DbDoc(std::move(json)));
+        return res;
+      }
+
+      DocResult result = execute();
+
+      for (DbDoc doc = result.fetchOne(); doc; doc = result.fetchOne())
+      {
+        std::ostringstream buf;
+        buf << doc;
+        docs.push_back(buf.str());
+        res.push_back(doc);
+      }
+
+      impl->store_cached(std::move(docs));
+      return res;
+    }
+    CATCH_AND_WRAP
+  }
+};
 
 struct Collection_find_base
   : public Group_by< Having< Sort< Limit< Offset< Bind_parameters<
-      Set_lock< Collection_find_cmd, common::Collection_find_if >
+      Set_hint< Set_lock< Collection_find_cmd, common::Collection_find_if >,
+                common::Collection_find_if >
     > > > > > >
 {};
 
@@ -357,6 +488,21 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Create an operation which returns documents selected by an expression
+    built with the typed expression builder API (see class `Expr`).
+  */
+
+  CollectionFind(Collection &coll, const Expr &criteria)
+  {
+    try {
+      reset(internal::Crud_factory::mk_find(coll));
+      static_cast<common::Collection_find_if*>(get_impl())
+        ->set_where(criteria.getTree());
+    }
+    CATCH_AND_WRAP
+  }
+
 
   CollectionFind(const internal::Collection_find_cmd &other)
   {
@@ -458,6 +604,21 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Create an operation which modifies documents selected by an expression
+    built with the typed expression builder API (see class `Expr`).
+  */
+
+  CollectionModify(Collection &coll, const Expr &criteria)
+  {
+    try {
+      reset(internal::Crud_factory::mk_modify(coll));
+      static_cast<common::Collection_modify_if*>(get_impl())
+        ->set_where(criteria.getTree());
+    }
+    CATCH_AND_WRAP
+  }
+
 
   CollectionModify(const internal::Collection_modify_cmd &other)
   {
@@ -586,6 +747,103 @@ protected:
 
 };
 
+
+// ----------------------------------------------------------------------
+
+/*
+  Batched modify operations
+  =========================
+*/
+
+
+/**
+  Accumulates modify operations and executes them as a single batch.
+
+  Independent modify operations queued with `add()` are sent to the server
+  as one pipelined sequence of update commands when `execute()` is called:
+  the commands travel in a single network write and their replies are
+  collected afterwards, one `Result` per queued operation, in the order in
+  which the operations were queued. For many small single-document patches
+  this costs one network round-trip instead of one per patch - the
+  update-side counterpart of adding many documents with a single
+  `CollectionAdd` operation.
+
+  A queued operation is copied into the batch, so the original statement
+  object stays valid and can be re-bound and queued again. If one of the
+  operations fails, the error is thrown after the results of the preceding
+  operations have been collected; results of the operations that follow
+  the failed one are discarded (as with `executeAll()`).
+
+  Example:
+  ~~~~~~
+    CollectionModifyBatch batch(coll);
+    CollectionModify patch = coll.modify("_id = :id").set("synced", true);
+
+    for (const std::string &id : ids)
+      batch.add(patch.bind("id", id));
+
+    std::vector<Result> results = batch.execute();
+  ~~~~~~
+
+  @ingroup devapi_op
+*/
+
+class PUBLIC_API CollectionModifyBatch
+{
+public:
+
+  /**
+    Create an empty batch of modify operations on the given collection.
+
+    The collection object must stay alive while the batch is used.
+  */
+
+  CollectionModifyBatch(Collection &coll)
+    : m_coll(&coll)
+  {}
+
+  /**
+    Queue a modify operation in the batch.
+
+    The operation is not executed at this point - a copy of it, with its
+    current parameter bindings, is stored in the batch and sent to the
+    server by `execute()`.
+  */
+
+  CollectionModifyBatch& add(const CollectionModify &op)
+  {
+    try {
+      m_ops.emplace_back(op);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Return the number of operations queued in the batch.
+
+  size_t size() const
+  {
+    return m_ops.size();
+  }
+
+  /**
+    Execute the queued operations as one pipelined batch and return their
+    results, in the order in which the operations were queued.
+
+    The batch is empty afterwards and can be filled and executed again.
+  */
+
+  std::vector<Result> execute();
+
+private:
+
+  Collection *m_coll;
+
+  DLL_WARNINGS_PUSH
+  std::list<CollectionModify>  m_ops;
+  DLL_WARNINGS_POP
+};
+
 MYSQLX_ABI_END(2,0)
 }  // mysqlx namespace
 
@@ -42,12 +42,15 @@ PUSH_SYS_WARNINGS
 #include <forward_list>
 #include <string.h>  // for memcpy
 #include <utility>   // std::move etc
+#include <system_error>
 POP_SYS_WARNINGS
 
 
 #define CATCH_AND_WRAP \
   catch (const ::mysqlx::Error&) { throw; }       \
   catch (const std::out_of_range&) { throw; }     \
+  catch (const std::system_error &e)              \
+  { throw ::mysqlx::Error(e); }                   \
   catch (const std::exception &e)                 \
   { throw ::mysqlx::Error(e.what()); }            \
   catch (const char *e)                           \
@@ -90,6 +93,33 @@ public:
   Error(const char *msg)
     : common::Error(msg)
   {}
+
+  /*
+    Wrap an error reported via a system error code. For errors which
+    originate from the server the MySQL error code is preserved and can
+    be examined with getCode().
+  */
+
+  Error(const std::system_error &e)
+    : common::Error(e.what())
+  {
+    if (0 == strcmp(e.code().category().name(), "server"))
+      m_code = unsigned(e.code().value());
+  }
+
+  /**
+    Return the MySQL server error code for this error, 0 if the error
+    did not originate from the server.
+  */
+
+  unsigned getCode() const
+  {
+    return m_code;
+  }
+
+protected:
+
+  unsigned m_code = 0;
 };
 
 
@@ -64,9 +64,11 @@ struct PUBLIC_API Crud_factory
   using Impl = common::Executable_if;
 
   static Impl* mk_add(Collection &coll);
+  static Impl* mk_remove(Collection &coll);
   static Impl* mk_remove(Collection &coll, const string &expr);
   static Impl* mk_find(Collection &coll);
   static Impl* mk_find(Collection &coll, const string &expr);
+  static Impl* mk_modify(Collection &coll);
   static Impl* mk_modify(Collection &coll, const string &expr);
 
   static Impl* mk_insert(Table &tbl);
@@ -379,6 +381,23 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Remove values bound to placeholders so far.
+
+    This way a fully built statement can be re-executed with fresh
+    parameter values without constructing it from scratch: clear the old
+    binds, bind new values and execute again.
+  */
+
+  BindOperation& clearBind()
+  {
+    try {
+      get_impl()->clear_params();
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Bind_if;
@@ -439,6 +458,23 @@ public:
     return *this;
   }
 
+  /**
+    Remove values bound to named parameters so far.
+
+    This way a fully built statement can be re-executed with fresh
+    parameter values without constructing it from scratch: clear the old
+    binds, bind new values and execute again.
+  */
+
+  BindOperation& clearBind()
+  {
+    try {
+      get_impl()->clear_params();
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Bind_if;
@@ -501,6 +537,53 @@ protected:
 };
 
 
+/// @copydoc Offset
+
+template <class Base, class IMPL>
+class Set_hint
+  : public Base
+{
+  using Operation = Base;
+
+public:
+
+  /**
+    Attach optimizer hints to the operation.
+
+    The hints are given as a list of flags of the server's
+    `optimizer_switch` system variable, for example
+    `"prefer_ordering_index=off"` or `"mrr=off,batched_key_access=off"`.
+    They are applied on the server for the duration of each execution of
+    this operation only, without affecting other statements of the
+    session, and cost no extra network round trip. This way index and
+    plan choices of hot queries can be pinned without rewriting them as
+    raw SQL and losing the structured API and its statement caching.
+
+    Note: an invalid flag is reported by the server like an error of a
+    pipelined transaction command, i.e. at the next transaction
+    boundary.
+  */
+
+  Operation& hint(const std::string &flags)
+  {
+    try {
+      get_impl()->set_hints(flags);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+protected:
+
+  using Impl = IMPL;
+
+  Impl* get_impl()
+  {
+    return static_cast<Impl*>(Base::get_impl());
+  }
+};
+
+
 }   // internal
 MYSQLX_ABI_END(2,0)
 } // mysqlx
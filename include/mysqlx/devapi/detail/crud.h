@@ -149,13 +149,23 @@ protected:
 
   static void process_one(Impl *impl, const DbDoc &doc)
   {
-    // TODO: Do it better when we support sending structured
-    // document descriptions to the server.
+    /*
+      Hand the UTF8 JSON representation of the document directly to the
+      implementation. For documents created from JSON this is the
+      retained input string; otherwise the representation is built
+      (and cached) by the document implementation. Note: the previous
+      implementation here serialized the document through a string
+      stream and an utf8->utf16->utf8 conversion for every document
+      added.
+    */
+
+    if (doc.isNull())
+    {
+      impl->add_json("{}");
+      return;
+    }
 
-    std::ostringstream buf;
-    buf << doc;
-    // Note: utf8 conversion using mysqlx::string.
-    impl->add_json(mysqlx::string(buf.str()));
+    impl->add_json(doc.get_json());
   }
 
   template <typename... T>
@@ -164,6 +174,15 @@ protected:
     Args_prc::process_args(impl, args...);
   }
 
+  /*
+    Trusted-input path used by CollectionAdd::addRaw(): the document is
+    given as raw UTF8 JSON text which is shipped to the server as-is.
+    Only a fast structural scan of the text (quote and bracket balance)
+    is performed client-side. Defined in devapi/crud.cc.
+  */
+
+  static void add_raw(Impl *impl, const char *json, size_t len);
+
   friend Args_prc;
 };
 
@@ -263,6 +282,23 @@ protected:
     Add_row::process_one(impl, row.first);
   }
 
+  /*
+    Pass a borrowed row to the implementation. Only the byte ranges are
+    stored - the field data remains owned by the caller (see
+    TableInsert::values(const std::vector<bytes>&)).
+  */
+
+  static void add_row_view(Impl *impl, const std::vector<bytes> &row)
+  {
+    std::vector<Impl::Field_view> fields;
+    fields.reserve(row.size());
+    for (auto &fld : row)
+      fields.emplace_back(fld.begin(), fld.size());
+    impl->add_row_view(
+      fields.empty() ? nullptr : fields.data(), (unsigned)fields.size()
+    );
+  }
+
   friend Args_processor<Add_column, Impl*>;
   friend Args_processor<Add_row, Impl*>;
   friend Args_processor<Add_value, Impl*>;
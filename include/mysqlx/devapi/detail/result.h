@@ -44,6 +44,7 @@
 #include "../collations.h"
 
 #include <deque>
+#include <functional>
 
 
 namespace mysqlx {
@@ -59,10 +60,212 @@ namespace common {
 class Result_init;
 class Column_info;
 class Result_impl;
+class Result_ack;
 
 }  // common
 
 
+/**
+  Decoded data of a single column for a batch of rows, as produced by
+  `RowResult::fetchColumns()`.
+
+  Depending on `kind`, values are found in one of the typed vectors
+  (one entry per row, with null rows holding 0), or as raw bytes in the
+  offset-based arena. Null fields are reported through the per-row
+  `nulls` flags for all kinds.
+*/
+
+struct ColumnBatch
+{
+  enum class Kind { SINT, UINT, DOUBLE, BYTES };
+
+  Kind kind = Kind::BYTES;
+
+  /// Per-row null flags.
+
+  std::vector<bool>     nulls;
+
+  /// Values of SINT/UINT/DOUBLE columns.
+
+  std::vector<int64_t>  sints;
+  std::vector<uint64_t> uints;
+  std::vector<double>   doubles;
+
+  /**
+    Data of BYTES columns: bytes of row `i` are
+    `arena[offsets[i]...offsets[i+1])` (`offsets` has one entry more
+    than there are rows). String data is UTF-8 without the terminating
+    null byte.
+  */
+
+  std::vector<unsigned char> arena;
+  std::vector<size_t>        offsets;
+};
+
+
+/**
+  Decoded data of a single column in Arrow-compatible layout, as
+  produced by `RowResult::fetchArrow()`.
+
+  The buffers follow the Arrow columnar format: a validity bitmap in
+  LSB bit order (bit `i % 8` of byte `i / 8` is set when the value of
+  row `i` is not null, padded with zero bits to a whole number of
+  bytes), plus either a fixed-size value buffer (numeric types, null
+  rows holding 0) or 64-bit offsets into a data buffer (the Arrow
+  `LargeUtf8`/`LargeBinary` layouts, `offsets` has `length + 1`
+  entries). Together with the column name and type taken from result
+  meta-data the buffers describe a complete Arrow array and can be
+  referenced by Arrow consumers without copying.
+*/
+
+struct ArrowColumn
+{
+  enum class Type { INT64, UINT64, FLOAT64, LARGE_UTF8, LARGE_BINARY };
+
+  std::string  name;
+  Type         type = Type::LARGE_BINARY;
+
+  uint64_t     length = 0;      ///< number of rows
+  uint64_t     null_count = 0;
+
+  std::vector<unsigned char> validity;
+
+  std::vector<int64_t>  ints;
+  std::vector<uint64_t> uints;
+  std::vector<double>   doubles;
+
+  std::vector<int64_t>       offsets;
+  std::vector<unsigned char> data;
+};
+
+
+/**
+  Per-phase latency breakdown of the reply which produced a result.
+
+  All values are microseconds elapsed since the statement was handed
+  over to the connection, measured on a monotonic clock inside the
+  connector. A zero value means that the corresponding phase was not
+  reached - for example `first_row_usec` and `last_row_usec` stay zero
+  for results without row data, and `last_row_usec` is only known once
+  the whole result has been consumed or buffered.
+
+  The breakdown tells server-side latency (`first_reply_usec`) from
+  connector-side processing (`last_row_usec - first_row_usec`) without
+  resorting to packet captures.
+
+  @see Result::getTimings()
+*/
+
+struct ResultTimings
+{
+  uint64_t first_reply_usec = 0;  ///< first message of the reply decoded
+  uint64_t mdata_usec = 0;        ///< result-set meta-data complete
+  uint64_t first_row_usec = 0;    ///< first row decoded
+  uint64_t last_row_usec = 0;     ///< end of the row stream
+};
+
+
+/**
+  Owned storage for the rows of a result, as produced by
+  `RowResult::releaseStorage()`.
+
+  A `RowStorage` instance holds the raw row data and the meta-data
+  donated by the result it was released from. Field data is exposed as
+  raw bytes or as borrowed string views which stay valid for the
+  lifetime of the storage (or any copy of it), independently of the
+  result and the session that produced it.
+*/
+
+class PUBLIC_API RowStorage
+{
+public:
+
+  RowStorage() = default;
+
+  /// Return the number of rows held in the storage.
+
+  row_count_t rowCount() const
+  {
+    try {
+      return row_count();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Return the number of fields in each row.
+
+  col_count_t colCount() const
+  {
+    try {
+      return col_count();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Get raw bytes of the field at position `col` of row `row`.
+
+    The raw representation is the same as for `Row::getBytes()`.
+
+    @returns null bytes range if the field is NULL.
+    @throws out_of_range if the given row does not exist.
+  */
+
+  bytes getBytes(row_count_t row, col_count_t col) const
+  {
+    try {
+      return get_bytes(row, col);
+    }
+    CATCH_AND_WRAP
+  }
+
+#if defined(__cpp_lib_string_view)
+
+  /**
+    Get value of the field at position `col` of row `row` as a borrowed
+    string view.
+
+    As with `Row::getView()`, for fields of type STRING, JSON or BYTES
+    the artificial trailing 0x00 byte of the raw representation is not
+    included in the view. The view stays valid as long as this storage
+    (or a copy of it) exists.
+
+    @returns empty view if the field is NULL.
+    @throws out_of_range if the given row does not exist.
+  */
+
+  std::string_view getView(row_count_t row, col_count_t col) const
+  {
+    try {
+      bytes data = get_view(row, col);
+      return { reinterpret_cast<const char*>(data.begin()), data.size() };
+    }
+    CATCH_AND_WRAP
+  }
+
+#endif
+
+  /// Check if this storage holds row data or is null.
+  operator bool() const { return nullptr != m_impl; }
+
+private:
+
+  class INTERNAL Impl;
+  DLL_WARNINGS_PUSH
+  std::shared_ptr<Impl>  m_impl;
+  DLL_WARNINGS_POP
+
+  row_count_t row_count() const;
+  col_count_t col_count() const;
+  bytes get_bytes(row_count_t, col_count_t) const;
+  bytes get_view(row_count_t, col_count_t) const;
+
+  /// @cond IGNORED
+  friend internal::Row_result_detail<Columns>;
+  /// @endcond
+};
+
+
 namespace internal {
 
 
@@ -84,6 +287,13 @@ protected:
 
   Result_detail(common::Result_init&);
 
+  /*
+    Create a result which replays a result set stored in a spool file
+    (see RowResult::spool()).
+  */
+
+  explicit Result_detail(const std::string &spool_path);
+
   // Note: move semantics is implemented by move assignment operator.
 
   Result_detail(Result_detail &&other)
@@ -108,6 +318,8 @@ protected:
   uint64_t get_affected_rows() const;
   uint64_t get_auto_increment() const;
 
+  ResultTimings get_timings() const;
+
   using DocIdList = internal::List_initializer<const std::vector<std::string>&>;
 
   DocIdList get_generated_ids() const;
@@ -119,11 +331,32 @@ protected:
   // Note: needs to be called before accessing the first result set.
   bool next_result();
 
+  /*
+    Non-blocking check whether the next row can be fetched without
+    waiting on the connection (see common::Result_impl::poll_row()).
+  */
+
+  bool poll_row();
+
+  /*
+    Drop the remainder of the reply without buffering it (see
+    common::Result_impl::discard()).
+  */
+
+  void discard();
+
 protected:
 
   Impl  *m_impl = nullptr;
   bool m_owns_impl = false;
 
+  /*
+    Lightweight implementation used instead of m_impl for statements
+    which are known to produce no result set (see common::Result_ack).
+  */
+
+  common::Result_ack *m_ack = nullptr;
+
   /*
     Source for WarningList initializer.
   */
@@ -353,6 +586,10 @@ protected:
   Row_result_detail() = default;
   Row_result_detail(common::Result_init&);
 
+  // Replay a result set stored in a spool file (see RowResult::fromSpool()).
+
+  explicit Row_result_detail(const std::string &spool_path);
+
   Row_result_detail(Row_result_detail&&) = default;
   Row_result_detail& operator=(Row_result_detail&&) = default;
 
@@ -367,6 +604,64 @@ protected:
 
   row_count_t row_count();
 
+  /*
+    Decode all remaining rows into typed column vectors, one ColumnBatch
+    per result column (see RowResult::fetchColumns()).
+  */
+
+  std::vector<ColumnBatch> fetch_columns();
+
+  /*
+    Decode all remaining rows into Arrow-compatible column buffers, one
+    ArrowColumn per result column (see RowResult::fetchArrow()).
+  */
+
+  std::vector<ArrowColumn> fetch_arrow();
+
+  /*
+    Write all remaining rows, with meta-data, to a spool file (see
+    RowResult::spool()).
+  */
+
+  uint64_t spool(const std::string &path);
+
+  /*
+    Fill the caller-provided array with up to `count` next rows of the
+    result in a single pass over the row cache (see
+    RowResult::fetchMany()).
+  */
+
+  row_count_t fetch_many(Row *rows, row_count_t count);
+
+  /*
+    Announce the expected result size so that row storage is
+    pre-allocated in one shot (see RowResult::reserve()).
+  */
+
+  void reserve(row_count_t rows, uint64_t bytes);
+
+  /*
+    Move the raw data of all remaining rows, with the result meta-data,
+    into a RowStorage instance owned by the caller (see
+    RowResult::releaseStorage()).
+  */
+
+  RowStorage release_storage();
+
+  /*
+    Install a sink receiving raw data of the given column in chunks as
+    it arrives from the server (see RowResult::streamColumn()).
+  */
+
+  void stream_column(col_count_t, std::function<size_t(bytes)>);
+
+  /*
+    Declare which columns will be accessed, and in what order (see
+    RowResult::accessPattern()).
+  */
+
+  void set_access_pattern(std::vector<col_count_t>);
+
   Row get_row()
   {
     if (!iterator_next())
@@ -383,6 +678,7 @@ private:
 protected:
 
   col_count_t     col_count() const;
+  col_count_t     col_index(const string&) const;
   const Column&   get_column(col_count_t) const;
   const Columns&  get_columns() const;
 
@@ -72,7 +72,24 @@ protected:
 
   col_count_t col_count() const;
   bytes       get_bytes(col_count_t) const;
+  bytes       get_view(col_count_t) const;
+  bytes       get_geometry(col_count_t) const;
   Value&      get_val(col_count_t);
+  Value&      get_val(const std::string &name);
+
+  /*
+    Typed field decoding used by Row::as<>(). Each overload decodes the
+    raw field bytes directly into the destination, using the codec
+    resolved from the result meta-data - no Value instance is created
+    and no per-field type dispatch is done.
+  */
+
+  void get_typed(col_count_t, int64_t&);
+  void get_typed(col_count_t, uint64_t&);
+  void get_typed(col_count_t, double&);
+  void get_typed(col_count_t, float&);
+  void get_typed(col_count_t, bool&);
+  void get_typed(col_count_t, std::string&);
 
   void clear()
   {
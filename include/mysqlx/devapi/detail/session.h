@@ -59,6 +59,79 @@ namespace common {
   class Result_impl;
 }
 
+
+/**
+  Aggregate counters describing protocol traffic of a session.
+
+  Counters accumulate over the whole life-time of the session. Byte counts
+  refer to (possibly compressed) data on the wire; the `uncompressed_*`
+  members give the corresponding payload sizes before compression was
+  applied (when sending) or after it was undone (when receiving), so that
+  the achieved compression ratio can be computed.
+
+  @see Session::getStats()
+*/
+
+struct SessionStats
+{
+  uint64_t stmts_executed = 0;    ///< commands sent to the server
+  uint64_t bytes_sent = 0;        ///< raw bytes written to the connection
+  uint64_t bytes_received = 0;    ///< raw bytes read from the connection
+  uint64_t msgs_sent = 0;         ///< protocol messages sent
+  uint64_t msgs_received = 0;     ///< protocol messages received
+  uint64_t frames_sent = 0;       ///< compressed frames sent
+  uint64_t frames_received = 0;   ///< compressed frames received
+  uint64_t uncompressed_sent = 0;     ///< payload bytes before compression
+  uint64_t uncompressed_received = 0; ///< payload bytes after uncompression
+  uint64_t max_write_size = 0;    ///< largest single write, in bytes
+
+  /**
+    Per-phase timings of the connect sequence, in microseconds: transport
+    connect (including name resolution), TLS capability exchange and
+    handshake, capability negotiation (compression, connection
+    attributes) and the authentication exchange. Filled once when the
+    session is established; `connect_tls_usec` is zero for non-TLS
+    connections.
+  */
+
+  uint64_t connect_tcp_usec = 0;   ///< transport connect phase
+  uint64_t connect_tls_usec = 0;   ///< TLS handshake phase
+  uint64_t connect_caps_usec = 0;  ///< capability negotiation phase
+  uint64_t connect_auth_usec = 0;  ///< authentication phase
+
+  /**
+    Heap allocations made by instrumented hot-path containers. The count
+    is process-wide, not per-session: snapshot it around an operation and
+    look at the difference. Stays zero unless the connector was built
+    with the ALLOC_STATS option.
+  */
+
+  uint64_t allocs = 0;
+};
+
+
+/**
+  Runtime statistics of the session pool owned by a client.
+
+  All counters are cumulative over the client's life-time except
+  `pool_size` and `idle_count`, which describe the current state of the
+  pool. Taking a snapshot is cheap and does not block pool operations.
+
+  @see Client::getStats()
+*/
+
+struct ClientStats
+{
+  uint64_t pool_size = 0;          ///< sessions currently owned by the pool
+  uint64_t idle_count = 0;         ///< of which idle, ready for re-use
+  uint64_t sessions_created = 0;   ///< sessions created so far
+  uint64_t sessions_closed = 0;    ///< sessions closed so far
+  uint64_t checkouts = 0;          ///< sessions handed out by getSession()
+  uint64_t checkout_hits = 0;      ///< of which re-used a pooled session
+  uint64_t affinity_hits = 0;      ///< of which matched the statement-shape affinity of the caller
+  uint64_t acquire_wait_usec = 0;  ///< total time spent waiting for a session
+};
+
 namespace internal {
 
 class Schema_detail;
@@ -105,6 +178,17 @@ protected:
 
   void index_drop(const string &name);
   void index_create(const string &name, Value &&spec);
+
+  /*
+    Client-side cache of documents fetched by id - see
+    Collection::enableDocumentCache() and the doc_cache_xxx() methods
+    of common::Session_impl which implement it.
+  */
+
+  void doc_cache_enable(size_t max_bytes, uint64_t ttl_ms);
+  bool doc_cache_active();
+  bool doc_cache_find(const string &id, std::string &json);
+  void doc_cache_store(const string &id, const std::string &json);
 };
 
 
@@ -229,6 +313,17 @@ protected:
                          CollectionOptions options);
   void  drop_collection(const string &name);
 
+  /*
+    Existence checks for the schema itself and for objects inside it.
+    A recently stored answer can be used instead of querying the server,
+    see the METADATA_CACHE_TTL session option. object_exists() returns 0
+    if there is no such object, 1 if it exists and 2 if the existing
+    object is a view (tables only).
+  */
+
+  bool     schema_exists();
+  unsigned object_exists(Obj_type type, const string &name);
+
   friend Collection_detail;
 
   struct Access;
@@ -285,6 +380,13 @@ struct PUBLIC_API Client_detail
 
   void close();
 
+  ClientStats get_stats() const;
+
+  void resize_pool(size_t max);
+  void drain_pool();
+  void resume_pool();
+  void shrink_caches();
+
 protected:
 
   Client_detail(Client_detail && other)
@@ -372,6 +474,14 @@ protected:
   Session_detail(common::Settings_impl&);
   Session_detail(common::Shared_session_pool&);
 
+  /*
+    Create a logical session sharing the implementation of an existing
+    one (see Session::multiplex()). Registers itself as an additional
+    logical owner of the implementation.
+  */
+
+  Session_detail(Shared_session_impl impl);
+
   virtual ~Session_detail()
   {
     try {
@@ -385,12 +495,35 @@ protected:
   void drop_schema(const string &name);
   string get_default_schema_name();
 
-  void start_transaction();
+  void start_transaction(bool batch = false);
   void commit();
   void rollback(const string &sp = string());
   string savepoint_set(const string &sp = string());
   void savepoint_remove(const string&);
 
+  SessionStats get_stats() const;
+
+  /*
+    Install a callback receiving global notices pushed by the server
+    (see Session::setNoticeHandler()).
+  */
+
+  void set_notice_handler(std::function<void(unsigned, bytes)>);
+
+  /*
+    Replay on this session the session state recorded by another session
+    (see Session::restoreStateFrom()).
+  */
+
+  void restore_state(const Session_detail &other);
+
+  /*
+    Pipeline a wait for the given GTID set on this session
+    (see Session::waitForExecutedGtidSet()).
+  */
+
+  void wait_executed_gtids(const string &gtids, unsigned timeout_sec);
+
 
   common::Session_impl& get_impl()
   {
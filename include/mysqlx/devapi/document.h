@@ -58,6 +58,7 @@ class SessionSettings;
 
 namespace internal{
 class Schema_detail;
+struct Collection_add_detail;
 
 } //internal
 
@@ -153,6 +154,21 @@ public:
   }
 
 
+  /**
+    A document path such as `"address.city"` or `"items[2].name"`,
+    parsed once and usable to access fields of many documents (see
+    below).
+  */
+
+  class Path;
+
+  /**
+    Return value of the field given by a pre-parsed document path.
+  */
+
+  const Value& operator[](const Path&) const;
+
+
   /**
     Print JSON description of the document.
   */
@@ -176,6 +192,7 @@ public:
   friend DocResult;
   friend Value;
   friend internal::Schema_detail;
+  friend internal::Collection_add_detail;
 };
 
 
@@ -197,6 +214,52 @@ public:
 };
 
 
+/**
+  Pre-parsed document path.
+
+  The path string is parsed once, when the Path instance is created,
+  and the instance can then be used to access fields of any number of
+  documents without parsing the path again:
+
+  ~~~~~~
+  DbDoc::Path city("address.city");
+  for (DbDoc doc : result)
+    std::cout << doc[city] << std::endl;
+  ~~~~~~
+
+  Wildcard path elements (`"*"`, `"[*]"`, `"**"`), which do not name a
+  single field, can not be used in a path meant for document access and
+  are reported as an error when the path is parsed.
+
+  @ingroup devapi_res
+*/
+
+class PUBLIC_API DbDoc::Path
+{
+  class INTERNAL Impl;
+
+DLL_WARNINGS_PUSH
+
+  std::shared_ptr<Impl> m_impl;
+
+DLL_WARNINGS_POP
+
+public:
+
+  explicit Path(const std::string &path);
+
+  explicit Path(const char *path)
+    : Path(std::string(path))
+  {}
+
+  explicit Path(const mysqlx::string &path)
+    : Path(std::string(path))
+  {}
+
+  friend DbDoc;
+};
+
+
 // Value class
 // ===========
 
@@ -41,6 +41,8 @@
 #include "result.h"
 #include "../common/op_if.h"
 
+#include <tuple>
+
 
 namespace mysqlx {
 MYSQLX_ABI_BEGIN(2,0)
@@ -48,6 +50,94 @@ MYSQLX_ABI_BEGIN(2,0)
 using std::ostream;
 
 
+/**
+  Future-like handle for an operation submitted with
+  `Executable::executeAsync()`.
+
+  The handle owns its own copy of the submitted operation, so the original
+  statement object can be modified or executed again independently. Method
+  `isReady()` polls for the server reply without blocking, `get()` waits
+  for the reply and returns the result (it can be called only once).
+
+  Errors reported by the server are thrown from `isReady()` or `get()`,
+  whichever sees them first.
+
+  @note A session processes one statement at a time. Submitting or
+  executing another statement on the same session while this one is
+  pending first caches its result, the same way as it happens for
+  overlapping results of synchronous executions.
+
+  The template parameter `Res` is the type of result that is returned by
+  `get()` method.
+*/
+
+template <class Res>
+class PendingResult
+{
+private:
+
+  using Impl = common::Executable_if;
+
+  std::unique_ptr<Impl> m_impl;
+
+  PendingResult(Impl *impl)
+    : m_impl(impl)
+  {
+    try {
+      m_impl->submit();
+    }
+    CATCH_AND_WRAP
+  }
+
+public:
+
+  PendingResult(PendingResult &&other) = default;
+  PendingResult& operator=(PendingResult &&other) = default;
+
+  // Note: a pending result can not be copied.
+
+  PendingResult(const PendingResult&) = delete;
+  PendingResult& operator=(const PendingResult&) = delete;
+
+
+  /// Check whether the result is ready, without blocking.
+
+  bool isReady()
+  {
+    try {
+      check_if_valid();
+      return m_impl->is_ready();
+    }
+    CATCH_AND_WRAP
+  }
+
+
+  /// Wait for the operation to complete and return its result.
+
+  Res get()
+  {
+    try {
+      check_if_valid();
+      Res res(m_impl->wait_execute());
+      m_impl.reset();
+      return res;
+    }
+    CATCH_AND_WRAP
+  }
+
+private:
+
+  void check_if_valid() const
+  {
+    if (!m_impl)
+      throw Error("Result of asynchronous operation was already consumed");
+  }
+
+  template <class R, class O>
+  friend class Executable;
+};
+
+
 /**
   Represents an operation that can be executed.
 
@@ -66,6 +156,12 @@ using std::ostream;
 template <class Res, class Op>
 class Executable
 {
+public:
+
+  // Type of result returned by execute().
+
+  using Result_type = Res;
+
 private:
   using Impl = common::Executable_if;
 
@@ -160,8 +256,194 @@ public:
     CATCH_AND_WRAP
   }
 
+
+  /**
+    Submit given operation for execution without waiting for its result.
+
+    The operation is sent to the server and a `PendingResult` handle is
+    returned which can be used to poll for and eventually obtain the
+    result. The handle gets its own copy of the operation, so this
+    statement object remains valid and can be modified or executed again
+    while the submitted operation is pending.
+  */
+
+  PendingResult<Res> executeAsync()
+  {
+    try {
+      check_if_valid();
+      return PendingResult<Res>(m_impl->clone());
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Compile the statement ahead of time.
+
+    Everything which does not depend on bound parameter values is compiled
+    now: criteria given as strings are parsed into stored expression trees
+    and the first execution prepares a server-side statement in the same
+    round trip as the execution itself. Later executions of this statement,
+    of its copies and of same-shaped statements send only the statement id
+    and the bind values. Errors in the statement specification are reported
+    here instead of at execution time.
+
+    @see `StatementDescriptor`
+  */
+
+  Executable& compile()
+  {
+    try {
+      check_if_valid();
+      m_impl->precompile();
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
   struct Access;
   friend Access;
+
+  ///  StatementScheduler needs to clone the implementation of queued statements.
+  friend class StatementScheduler;
+};
+
+
+namespace internal {
+
+/*
+  Minimal C++11 replacement for std::index_sequence (which is C++14) used
+  by executeAll() below to unpack a tuple of pending results.
+*/
+
+template <std::size_t... I>
+struct Index_seq {};
+
+template <std::size_t N, std::size_t... I>
+struct Make_index_seq
+  : Make_index_seq<N-1, N-1, I...>
+{};
+
+template <std::size_t... I>
+struct Make_index_seq<0, I...>
+{
+  using type = Index_seq<I...>;
+};
+
+
+/*
+  Collect results of pending operations, in the order in which they were
+  submitted. Braced initialization of the result tuple guarantees that
+  the get() calls are evaluated left-to-right.
+*/
+
+template <class... Res, std::size_t... I>
+inline
+std::tuple<Res...>
+get_all(std::tuple<PendingResult<Res>...> &pending, Index_seq<I...>)
+{
+  return std::tuple<Res...>{ std::get<I>(pending).get()... };
+}
+
+}  // internal
+
+
+/**
+  Execute several independent statements, sending them all to the server
+  before waiting for any reply.
+
+  All statements are first submitted as with `Executable::executeAsync()`,
+  so their commands travel to the server in a single pipeline, and then
+  their results are collected and returned as a tuple, in the same order
+  in which the statements were given. For N independent statements issued
+  over the same session this costs one network round-trip instead of N.
+
+  An error reported for one of the statements is thrown after the preceding
+  statements have delivered their results; results of the statements that
+  follow the failed one are then discarded.
+
+  Example:
+  ~~~~~~
+    DocResult     users, orders;
+    std::tie(users, orders)
+      = executeAll(coll_users.find("..."), coll_orders.find("..."));
+  ~~~~~~
+*/
+
+template <class... Stmt>
+std::tuple<typename std::decay<Stmt>::type::Result_type...>
+executeAll(Stmt&&... stmts)
+{
+  try {
+    std::tuple<PendingResult<typename std::decay<Stmt>::type::Result_type>...>
+      pending{ stmts.executeAsync()... };
+    return internal::get_all(
+      pending, typename internal::Make_index_seq<sizeof...(Stmt)>::type()
+    );
+  }
+  CATCH_AND_WRAP
+}
+
+
+/**
+  Immutable, shareable descriptor of a pre-compiled statement.
+
+  A descriptor is constructed once, typically at application start-up, from
+  a fully specified statement (criteria, projection, sorts - everything
+  except the bind values). Construction compiles the statement ahead of
+  time, as `Executable::compile()` does, and reports specification errors
+  immediately. Method `statement()` then mints independent executable
+  copies which only need their parameters bound:
+
+  ~~~~~~
+    StatementDescriptor<CollectionFind> find_by_age(
+      coll.find("age > :age").sort("name")
+    );
+
+    // later, on any thread:
+
+    auto stmt = find_by_age.statement();
+    DocResult res = stmt.bind("age", 18).execute();
+  ~~~~~~
+
+  The first minted statement to be executed prepares a server-side
+  statement in the same round trip as the execution; statements minted
+  afterwards recognize the prepared statement through the session's
+  statement-shape cache and send only the statement id with the bind
+  values. The descriptor itself is never executed and, being immutable,
+  can be shared freely between threads (each minted statement is still
+  owned by one thread, like any other statement object).
+
+  The template parameter `Op` is the statement type being described, such
+  as `CollectionFind` or `TableSelect`.
+
+  @ingroup devapi
+*/
+
+template <class Op>
+class StatementDescriptor
+{
+  Op m_stmt;
+
+public:
+
+  /**
+    Create a descriptor of the given statement, compiling it ahead of
+    time. The statement is copied - the original remains an independent,
+    modifiable object.
+  */
+
+  StatementDescriptor(const Op &stmt)
+    : m_stmt(stmt)
+  {
+    m_stmt.compile();
+  }
+
+  /// Mint an executable copy of the described statement.
+
+  Op statement() const
+  {
+    return m_stmt;
+  }
 };
 
 
@@ -0,0 +1,496 @@
+/*
+ * Copyright (c) 2021, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef MYSQLX_DEVAPI_EXPR_BUILDER_H
+#define MYSQLX_DEVAPI_EXPR_BUILDER_H
+
+/**
+  @file
+  Typed expression builder API.
+*/
+
+#include "common.h"
+#include "document.h"
+#include "../common/expr.h"
+
+
+namespace mysqlx {
+MYSQLX_ABI_BEGIN(2,0)
+
+/**
+  An expression built as a tree of typed nodes instead of a string.
+
+  Expressions of this kind are composed with the static factory methods
+  of this class and with overloaded C++ operators, for example:
+
+  ~~~~~~
+    auto crit = Expr::column("age") >= 18
+                && Expr::column("name").like("J%");
+    RowResult res = tbl.select().where(crit).execute();
+
+    DocResult docs
+      = coll.find(Expr::field("count") > Expr::param("min"))
+            .bind("min", 10).execute();
+  ~~~~~~
+
+  Contrary to criteria given as strings, such expressions are handed to
+  the protocol layer as ready trees - no expression string is built by
+  the caller nor parsed by the connector. This is meant for code which
+  generates queries programmatically and would otherwise assemble strings
+  only for the connector to tokenize them again.
+
+  An `Expr` instance is an immutable handle to a tree node; composing
+  bigger expressions shares sub-trees instead of copying them.
+
+  @note Overloaded operators `&&` and `||` build an expression to be
+  evaluated by the server - they do not short-circuit.
+
+  @note Operators without a C++ counterpart are available through methods
+  such as `like()` or `between()`, or through the generic `op()` factory
+  which accepts any operator name known to the protocol.
+
+  @ingroup devapi
+*/
+
+class Expr
+{
+  using Node = common::Expr_node;
+
+  std::shared_ptr<Node> m_node;
+
+  explicit Expr(Node::Kind kind)
+    : m_node(std::make_shared<Node>())
+  {
+    m_node->m_kind = kind;
+  }
+
+  void add_args()
+  {}
+
+  template <typename A, typename... Rest>
+  void add_args(const A &first, Rest&&... rest)
+  {
+    m_node->m_args.push_back(Expr(first).m_node);
+    add_args(std::forward<Rest>(rest)...);
+  }
+
+public:
+
+  /**
+    Create a literal expression from a value (implicit, so that plain
+    values can be used directly as operands of composed expressions).
+  */
+
+  Expr(const Value &val)
+    : Expr(Node::LITERAL)
+  {
+    m_node->m_value = (const common::Value&)val;
+  }
+
+  /// Create a literal expression from a value.
+
+  static Expr lit(const Value &val)
+  {
+    return Expr(val);
+  }
+
+  /**
+    Reference to a document field given by the names of the path members,
+    such as `field("address", "city")` for `address.city`. Without
+    arguments the whole document is referenced.
+  */
+
+  template <typename... PATH>
+  static Expr field(PATH... members)
+  {
+    Expr e(Node::FIELD);
+    e.m_node->m_path = { std::string(members)... };
+    return e;
+  }
+
+  /// Reference to a column of the queried table.
+
+  static Expr column(const std::string &name)
+  {
+    Expr e(Node::COLUMN);
+    e.m_node->m_name = name;
+    return e;
+  }
+
+  /// Reference to a column qualified by a table name.
+
+  static Expr column(const std::string &table, const std::string &name)
+  {
+    Expr e = column(name);
+    e.m_node->m_table = table;
+    return e;
+  }
+
+  /// Reference to a column qualified by schema and table names.
+
+  static Expr column(
+    const std::string &schema, const std::string &table,
+    const std::string &name
+  )
+  {
+    Expr e = column(table, name);
+    e.m_node->m_schema = schema;
+    return e;
+  }
+
+  /**
+    For a column reference: reference a document field inside a JSON
+    column (`col->$.path`). Path members are given like for `field()`.
+  */
+
+  template <typename... PATH>
+  Expr path(PATH... members) const
+  {
+    Expr e(Node::COLUMN);
+    *e.m_node = *m_node;
+    e.m_node->m_path = { std::string(members)... };
+    return e;
+  }
+
+  /// Named parameter, to be bound with `bind()` before execution.
+
+  static Expr param(const std::string &name)
+  {
+    Expr e(Node::PARAM);
+    e.m_node->m_name = name;
+    return e;
+  }
+
+  /**
+    Application of the named operator to the given arguments. Operator
+    names are the protocol names reported by the expression parser, such
+    as "==", "&&", "not" or "like". This is the generic factory behind
+    the overloaded operators and comparison methods.
+  */
+
+  template <typename... ARGS>
+  static Expr op(const std::string &name, const ARGS&... args)
+  {
+    Expr e(Node::OP);
+    e.m_node->m_name = name;
+    e.add_args(args...);
+    return e;
+  }
+
+  /// Call of the named function with the given arguments.
+
+  template <typename... ARGS>
+  static Expr func(const std::string &name, const ARGS&... args)
+  {
+    Expr e(Node::FUNC);
+    e.m_node->m_name = name;
+    e.add_args(args...);
+    return e;
+  }
+
+  /// Array expression with the given elements.
+
+  template <typename... ARGS>
+  static Expr array(const ARGS&... elems)
+  {
+    Expr e(Node::ARRAY);
+    e.add_args(elems...);
+    return e;
+  }
+
+  // Comparisons without a C++ operator counterpart.
+
+  /// SQL LIKE pattern match.
+
+  template <typename E>
+  Expr like(const E &pattern) const
+  {
+    return op("like", *this, pattern);
+  }
+
+  /// Negated SQL LIKE pattern match.
+
+  template <typename E>
+  Expr notLike(const E &pattern) const
+  {
+    return op("not_like", *this, pattern);
+  }
+
+  /// Regular expression match.
+
+  template <typename E>
+  Expr regexp(const E &pattern) const
+  {
+    return op("regexp", *this, pattern);
+  }
+
+  /// BETWEEN range check (inclusive).
+
+  template <typename L, typename H>
+  Expr between(const L &low, const H &high) const
+  {
+    return op("between", *this, low, high);
+  }
+
+  /// IN check against an explicit list of values.
+
+  template <typename... ARGS>
+  Expr in(const ARGS&... args) const
+  {
+    return op("in", *this, args...);
+  }
+
+  /// Negated IN check.
+
+  template <typename... ARGS>
+  Expr notIn(const ARGS&... args) const
+  {
+    return op("not_in", *this, args...);
+  }
+
+  /// IS NULL check.
+
+  Expr isNull() const
+  {
+    return op("is", *this, Expr(Value()));
+  }
+
+  /// IS NOT NULL check.
+
+  Expr isNotNull() const
+  {
+    return op("is_not", *this, Expr(Value()));
+  }
+
+  ///@cond IGNORED
+
+  const std::shared_ptr<common::Expr_node>& getTree() const
+  {
+    return m_node;
+  }
+
+  ///@endcond
+};
+
+
+/*
+  Overloaded operators which compose expressions. Each binary operator is
+  defined for two expressions and for an expression combined with a plain
+  value on either side (a value alone can not implicitly pass through two
+  conversions to become an expression).
+*/
+
+#define MYSQLX_EXPR_BINARY_OP(OP, NAME) \
+inline Expr operator OP(const Expr &lhs, const Expr &rhs) \
+{ return Expr::op(NAME, lhs, rhs); } \
+inline Expr operator OP(const Expr &lhs, const Value &rhs) \
+{ return Expr::op(NAME, lhs, Expr(rhs)); } \
+inline Expr operator OP(const Value &lhs, const Expr &rhs) \
+{ return Expr::op(NAME, Expr(lhs), rhs); }
+
+MYSQLX_EXPR_BINARY_OP(==, "==")
+MYSQLX_EXPR_BINARY_OP(!=, "!=")
+MYSQLX_EXPR_BINARY_OP(<,  "<")
+MYSQLX_EXPR_BINARY_OP(<=, "<=")
+MYSQLX_EXPR_BINARY_OP(>,  ">")
+MYSQLX_EXPR_BINARY_OP(>=, ">=")
+MYSQLX_EXPR_BINARY_OP(&&, "&&")
+MYSQLX_EXPR_BINARY_OP(||, "||")
+MYSQLX_EXPR_BINARY_OP(+,  "+")
+MYSQLX_EXPR_BINARY_OP(-,  "-")
+MYSQLX_EXPR_BINARY_OP(*,  "*")
+MYSQLX_EXPR_BINARY_OP(/,  "/")
+MYSQLX_EXPR_BINARY_OP(%,  "%")
+MYSQLX_EXPR_BINARY_OP(&,  "&")
+MYSQLX_EXPR_BINARY_OP(|,  "|")
+MYSQLX_EXPR_BINARY_OP(^,  "^")
+
+#undef MYSQLX_EXPR_BINARY_OP
+
+
+/// Logical negation of an expression.
+
+inline Expr operator!(const Expr &e)
+{
+  return Expr::op("!", e);
+}
+
+/// Arithmetic negation of an expression.
+
+inline Expr operator-(const Expr &e)
+{
+  return Expr::op("-", e);
+}
+
+/// Bitwise negation of an expression.
+
+inline Expr operator~(const Expr &e)
+{
+  return Expr::op("~", e);
+}
+
+
+/*
+  Compile-time validation of identifier terms
+  -------------------------------------------
+
+  Criteria built with class Expr avoid the expression parser, but the
+  identifiers used in them (column, field and parameter names) are still
+  plain strings which the server rejects only at execution time. The
+  constexpr predicate below classifies simple unquoted identifiers at
+  compile time, so that code generating criteria from literals can turn
+  a typo into a compilation error, for example:
+
+    static_assert(mysqlx::internal::valid_ident("user_id"), "bad column");
+
+  With compilers which support string literal template arguments (C++20)
+  the user-defined literals in namespace mysqlx::literals apply this
+  check implicitly, see below.
+*/
+
+namespace internal {
+
+/// Tell whether `c` can appear in an unquoted identifier.
+
+constexpr bool ident_char(char c)
+{
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z')
+      || ('0' <= c && c <= '9') || '_' == c || '$' == c;
+}
+
+/// Tell whether all characters of `s` can appear in an identifier.
+
+constexpr bool ident_chars(const char *s)
+{
+  return '\0' == *s || (ident_char(*s) && ident_chars(s + 1));
+}
+
+/**
+  Tell whether `s` is a valid unquoted identifier: non-empty, not
+  starting with a digit and consisting of identifier characters only.
+  Identifiers which require quoting can still be used with the regular
+  `Expr` factories, which pass them to the server as-is.
+*/
+
+constexpr bool valid_ident(const char *s)
+{
+  return '\0' != *s && !('0' <= *s && *s <= '9') && ident_chars(s);
+}
+
+}  // internal
+
+
+#if defined(__cpp_nontype_template_args) \
+    && __cpp_nontype_template_args >= 201911L
+
+/**
+  User-defined literals building expression terms with the identifier
+  validated at compile time:
+
+  ~~~~~~
+    using namespace mysqlx::literals;
+
+    auto crit = "age"_col >= 18 && "name"_col.like("J%");
+    auto doc_crit = "count"_field > "min"_param;
+  ~~~~~~
+
+  A literal which is not a valid unquoted identifier fails the
+  static_assert and the build. Available only with compilers which
+  accept string literal template arguments (C++20); otherwise use the
+  `Expr` factories, optionally with an explicit static_assert on
+  `internal::valid_ident()`.
+*/
+
+namespace literals {
+
+namespace detail {
+
+/// Holder which makes a string literal usable as a template argument.
+
+template <std::size_t N>
+struct ident_str
+{
+  char m_data[N] = {};
+
+  constexpr ident_str(const char (&s)[N])
+  {
+    for (std::size_t i = 0; i < N; ++i)
+      m_data[i] = s[i];
+  }
+};
+
+}  // detail
+
+
+/// Column reference with the name validated at compile time.
+
+template <detail::ident_str S>
+Expr operator""_col()
+{
+  static_assert(
+    internal::valid_ident(S.m_data),
+    "not a valid unquoted column name"
+  );
+  return Expr::column(S.m_data);
+}
+
+/// Document field reference with the name validated at compile time.
+
+template <detail::ident_str S>
+Expr operator""_field()
+{
+  static_assert(
+    internal::valid_ident(S.m_data),
+    "not a valid unquoted field name"
+  );
+  return Expr::field(S.m_data);
+}
+
+/// Named parameter with the name validated at compile time.
+
+template <detail::ident_str S>
+Expr operator""_param()
+{
+  static_assert(
+    internal::valid_ident(S.m_data),
+    "not a valid unquoted parameter name"
+  );
+  return Expr::param(S.m_data);
+}
+
+}  // literals
+
+#endif  // string literal template arguments
+
+
+MYSQLX_ABI_END(2,0)
+}  // mysqlx
+
+#endif
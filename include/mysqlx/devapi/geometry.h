@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+#ifndef MYSQLX_GEOMETRY_H
+#define MYSQLX_GEOMETRY_H
+
+/**
+  @file
+  Zero-copy access to GEOMETRY values (see `GeometryView`).
+*/
+
+#include "common.h"
+
+PUSH_SYS_WARNINGS
+#include <cstring>
+#include <limits>
+POP_SYS_WARNINGS
+
+
+namespace mysqlx {
+MYSQLX_ABI_BEGIN(2,0)
+
+/**
+  Non-owning view of a GEOMETRY value in MySQL internal storage format.
+
+  MySQL stores geometries as a 4 byte SRID followed by the WKB
+  (well-known binary) representation of the geometry
+  (see https://dev.mysql.com/doc/refman/8.0/en/gis-data-formats.html).
+  A `GeometryView` describes such a value in place - typically the raw
+  bytes of a row field obtained with `Row::getGeometry()` - and answers
+  common structural questions without copying the data out or building a
+  geometry object:
+
+  - `getSRID()`, `getType()` decode only the fixed headers,
+  - `getPointCount()` walks the structure but skips over the coordinate
+    arrays,
+  - `getBoundingBox()` scans the coordinates in place.
+
+  The WKB bytes themselves are available through `getWKB()` for code
+  that feeds them to a geometry library.
+
+  @note Like `bytes`, the view does not own the data - it remains valid
+  only as long as the row it was obtained from.
+
+  @note Only the 2-dimensional geometry types produced by MySQL are
+  understood. Malformed or truncated values are reported with an Error.
+
+  @ingroup devapi_res
+*/
+
+class GeometryView
+{
+public:
+
+  /// WKB geometry type constants.
+
+  enum class Type : uint32_t
+  {
+    Point              = 1,
+    LineString         = 2,
+    Polygon            = 3,
+    MultiPoint         = 4,
+    MultiLineString    = 5,
+    MultiPolygon       = 6,
+    GeometryCollection = 7,
+  };
+
+  /// Axis-aligned bounding box of a geometry.
+
+  struct Bounds
+  {
+    double xmin;
+    double ymin;
+    double xmax;
+    double ymax;
+  };
+
+  /**
+    Create a view of the given geometry value, which must be in the
+    MySQL internal format (SRID header followed by WKB).
+  */
+
+  explicit GeometryView(bytes raw)
+    : m_raw(raw)
+  {
+    if (raw.size() < 4 + WKB_HEADER)
+      throw Error("Malformed geometry value");
+  }
+
+  /// Return the SRID of the geometry.
+
+  uint32_t getSRID() const
+  {
+    uint32_t srid;
+    std::memcpy(&srid, m_raw.begin(), 4);
+    if (!host_little())
+      srid = swap_u32(srid);
+    return srid;
+  }
+
+  /// Return the WKB type of the (top-level) geometry.
+
+  Type getType() const
+  {
+    Cursor c = wkb_cursor();
+    bool le = read_order(c);
+    return (Type)read_u32(c, le);
+  }
+
+  /**
+    Return the total number of points (coordinate pairs) in the
+    geometry. Coordinate arrays are skipped over, not scanned.
+  */
+
+  uint64_t getPointCount() const
+  {
+    Cursor c = wkb_cursor();
+    uint64_t count = 0;
+    scan(c, count, nullptr, 0);
+    return count;
+  }
+
+  /**
+    Return the bounding box of the geometry, scanning the coordinates
+    in place.
+
+    @throws Error if the geometry contains no points.
+  */
+
+  Bounds getBoundingBox() const
+  {
+    Cursor c = wkb_cursor();
+    uint64_t count = 0;
+    Bounds bb = {
+      std::numeric_limits<double>::infinity(),
+      std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::infinity()
+    };
+    scan(c, count, &bb, 0);
+    if (0 == count)
+      throw Error("Geometry contains no points");
+    return bb;
+  }
+
+  /// Return the WKB representation (the value without the SRID header).
+
+  bytes getWKB() const
+  {
+    return bytes(m_raw.begin() + 4, m_raw.end());
+  }
+
+private:
+
+  // Minimal WKB size: byte order byte + type.
+
+  static const size_t WKB_HEADER = 5;
+
+  bytes m_raw;
+
+  struct Cursor
+  {
+    const byte *pos;
+    const byte *end;
+  };
+
+  Cursor wkb_cursor() const
+  {
+    return { m_raw.begin() + 4, m_raw.end() };
+  }
+
+  static bool host_little()
+  {
+    const uint16_t probe = 1;
+    return 0 != *reinterpret_cast<const unsigned char*>(&probe);
+  }
+
+  static uint32_t swap_u32(uint32_t val)
+  {
+    return  (val >> 24) | ((val >> 8) & 0x0000FF00)
+          | ((val << 8) & 0x00FF0000) | (val << 24);
+  }
+
+  static void need(const Cursor &c, size_t howmany)
+  {
+    if ((size_t)(c.end - c.pos) < howmany)
+      throw Error("Malformed geometry value");
+  }
+
+  // Read the WKB byte-order byte; returns true for little-endian data.
+
+  static bool read_order(Cursor &c)
+  {
+    need(c, 1);
+    byte order = *c.pos++;
+    if (order > 1)
+      throw Error("Malformed geometry value");
+    return 1 == order;
+  }
+
+  static uint32_t read_u32(Cursor &c, bool le)
+  {
+    need(c, 4);
+    uint32_t val;
+    std::memcpy(&val, c.pos, 4);
+    c.pos += 4;
+    if (le != host_little())
+      val = swap_u32(val);
+    return val;
+  }
+
+  static double read_double(Cursor &c, bool le)
+  {
+    need(c, 8);
+    byte buf[8];
+    if (le == host_little())
+      std::memcpy(buf, c.pos, 8);
+    else
+      for (unsigned i = 0; i < 8; ++i)
+        buf[i] = c.pos[7 - i];
+    c.pos += 8;
+    double val;
+    std::memcpy(&val, buf, 8);
+    return val;
+  }
+
+  /*
+    Visit the points of a run of `count` coordinate pairs: skip over
+    them when only counting, scan them when a bounding box is being
+    accumulated.
+  */
+
+  static void visit_points(Cursor &c, uint32_t count, Bounds *bb, bool le)
+  {
+    if (!bb)
+    {
+      need(c, 16 * (size_t)count);
+      c.pos += 16 * (size_t)count;
+      return;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      double x = read_double(c, le);
+      double y = read_double(c, le);
+      if (x < bb->xmin) bb->xmin = x;
+      if (y < bb->ymin) bb->ymin = y;
+      if (x > bb->xmax) bb->xmax = x;
+      if (y > bb->ymax) bb->ymax = y;
+    }
+  }
+
+  /*
+    Walk one WKB geometry, accumulating the point count and, when bb is
+    given, the bounding box. Nested geometries recurse with a depth
+    limit so that malformed data can not exhaust the stack.
+  */
+
+  static void scan(Cursor &c, uint64_t &count, Bounds *bb, unsigned depth)
+  {
+    if (depth > 32)
+      throw Error("Malformed geometry value");
+
+    bool le = read_order(c);
+    Type type = (Type)read_u32(c, le);
+
+    switch (type)
+    {
+    case Type::Point:
+      count += 1;
+      visit_points(c, 1, bb, le);
+      break;
+
+    case Type::LineString:
+      {
+        uint32_t points = read_u32(c, le);
+        count += points;
+        visit_points(c, points, bb, le);
+      }
+      break;
+
+    case Type::Polygon:
+      {
+        uint32_t rings = read_u32(c, le);
+        for (uint32_t i = 0; i < rings; ++i)
+        {
+          uint32_t points = read_u32(c, le);
+          count += points;
+          visit_points(c, points, bb, le);
+        }
+      }
+      break;
+
+    case Type::MultiPoint:
+    case Type::MultiLineString:
+    case Type::MultiPolygon:
+    case Type::GeometryCollection:
+      {
+        uint32_t items = read_u32(c, le);
+        for (uint32_t i = 0; i < items; ++i)
+          scan(c, count, bb, depth + 1);
+      }
+      break;
+
+    default:
+      throw Error("Unknown geometry type");
+    }
+  }
+};
+
+
+MYSQLX_ABI_END(2,0)
+}  // mysqlx
+
+#endif
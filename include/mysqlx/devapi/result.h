@@ -42,6 +42,29 @@
 #include "collations.h"
 #include "detail/result.h"
 
+/*
+  Optional C++20 coroutine support.
+
+  The connector itself is built as C++11 and its ABI does not depend on
+  coroutines - the awaitable `RowStream` class below is header-only and
+  gets compiled only when the user's translation unit provides coroutine
+  support.
+*/
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+
+PUSH_SYS_WARNINGS
+#include <coroutine>
+POP_SYS_WARNINGS
+
+#if defined(__cpp_lib_coroutine)
+#define MYSQLX_HAVE_COROUTINES 1
+#endif
+
+#endif
+#endif
+
 
 namespace mysqlx {
 MYSQLX_ABI_BEGIN(2,0)
@@ -54,11 +77,13 @@ class Collection;
 class Result;
 class Row;
 class RowResult;
+class RowStream;
 class SqlResult;
 class DbDoc;
 class DocResult;
 
 template <class Res, class Op> class Executable;
+template <class Res> class PendingResult;
 
 
 namespace internal {
@@ -120,6 +145,18 @@ public:
     } CATCH_AND_WRAP
   }
 
+  /**
+    Get the per-phase latency breakdown of the reply which produced
+    this result (@see ResultTimings).
+  */
+
+  ResultTimings getTimings() const
+  {
+    try {
+      return Result_detail::get_timings();
+    } CATCH_AND_WRAP
+  }
+
 protected:
 
   // Wrap base ctors/assginment with catch handlers
@@ -150,6 +187,12 @@ protected:
   {}
   CATCH_AND_WRAP
 
+  explicit Result_common(const std::string &spool_path)
+  try
+    : Base(spool_path)
+  {}
+  CATCH_AND_WRAP
+
 };
 
 }  // internal namespace
@@ -221,6 +264,10 @@ private:
 
   template <class Res, class Op>
   friend class Executable;
+  template <class Res>
+  friend class PendingResult;
+  template <class Res>
+  friend class ScheduledResult;
   friend Collection;
 };
 
@@ -552,11 +599,19 @@ bool Row_result_detail<Columns>::iterator_next();
 template<> PUBLIC_API
 col_count_t Row_result_detail<Columns>::col_count() const;
 
+template<> PUBLIC_API
+col_count_t Row_result_detail<Columns>::col_index(const string&) const;
+
 template<> PUBLIC_API
 Row_result_detail<Columns>::Row_result_detail(
   common::Result_init &init
 );
 
+template<> PUBLIC_API
+Row_result_detail<Columns>::Row_result_detail(
+  const std::string &spool_path
+);
+
 template<> PUBLIC_API
 auto Row_result_detail<Columns>::get_column(col_count_t pos) const
 -> const Column&;
@@ -568,6 +623,35 @@ auto internal::Row_result_detail<Columns>::get_columns() const
 template<> PUBLIC_API
 row_count_t internal::Row_result_detail<Columns>::row_count();
 
+template<> PUBLIC_API
+std::vector<ColumnBatch> internal::Row_result_detail<Columns>::fetch_columns();
+
+template<> PUBLIC_API
+std::vector<ArrowColumn> internal::Row_result_detail<Columns>::fetch_arrow();
+
+template<> PUBLIC_API
+uint64_t internal::Row_result_detail<Columns>::spool(const std::string&);
+
+template<> PUBLIC_API
+row_count_t
+internal::Row_result_detail<Columns>::fetch_many(Row*, row_count_t);
+
+template<> PUBLIC_API
+RowStorage internal::Row_result_detail<Columns>::release_storage();
+
+template<> PUBLIC_API
+void internal::Row_result_detail<Columns>::reserve(row_count_t, uint64_t);
+
+template<> PUBLIC_API
+void internal::Row_result_detail<Columns>::stream_column(
+  col_count_t, std::function<size_t(bytes)>
+);
+
+template<> PUBLIC_API
+void internal::Row_result_detail<Columns>::set_access_pattern(
+  std::vector<col_count_t>
+);
+
 } // internal
 
 
@@ -602,6 +686,23 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Return the 0-based position of the column with the given label.
+
+    Labels (column aliases, or names if no alias was set) are matched
+    case-insensitively using a look-up index built once per result; when
+    several columns share a label the first one is reported. Returns
+    `getColumnCount()` when there is no such column.
+  */
+
+  col_count_t columnIndex(const string &name) const
+  {
+    try {
+      return Row_result_detail::col_index(name);
+    }
+    CATCH_AND_WRAP
+  }
+
   /// Return `Column` object describing the given column of the result.
 
   const Column& getColumn(col_count_t pos) const
@@ -656,6 +757,190 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Fetch up to `count` next rows into the caller-provided array.
+
+    Consecutive entries of `rows` are filled with the next rows of the
+    result in a single pass over the internal row cache, which avoids the
+    per-row call overhead of `fetchOne()` when draining large results.
+    Returns the number of rows stored - a value smaller than `count`
+    means the result contains no more rows. Rows fetched this way are not
+    included in the results of `fetchOne()` or `fetchAll()`.
+  */
+
+  row_count_t fetchMany(Row *rows, row_count_t count)
+  {
+    try {
+      return Row_result_detail::fetch_many(rows, count);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Stream raw data of the given column to a sink instead of buffering
+    it inside fetched rows.
+
+    The sink is called with consecutive chunks of the column's raw data
+    as they arrive from the server, so a large BLOB/TEXT value never has
+    to be held in connector memory as a whole. The value returned by the
+    sink is the number of bytes it is ready to accept next - it is used
+    as the read window of the protocol reader, giving a slow consumer
+    backpressure on the wire; returning 0 discards the rest of the
+    field. Fields delivered this way are reported as NULL in the fetched
+    rows. The sink must be installed before any row of the result is
+    fetched, and data arrives while rows are being fetched.
+  */
+
+  void streamColumn(col_count_t pos, std::function<size_t(bytes)> sink)
+  {
+    try {
+      Row_result_detail::stream_column(pos, sink);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Declare which columns will be accessed, and in what order.
+
+    Values are converted from their raw form lazily, on first access -
+    declaring the planned access order (for example `{0, 3, 7}`) turns
+    that reactive decode into a planned one: rows returned by
+    `fetchOne()` prefetch the raw data of the declared fields ahead of
+    the accesses, and `fetchColumns()`/`fetchArrow()` decode the
+    declared columns first. Columns that are never accessed are simply
+    never converted on the row path; the columnar fetches still produce
+    all columns, after the declared ones. This is only a performance
+    hint. Call it before fetching any rows.
+  */
+
+  void accessPattern(std::vector<col_count_t> cols)
+  {
+    try {
+      Row_result_detail::set_access_pattern(std::move(cols));
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Return all remaining rows decoded into per-column vectors.
+
+    For each column of the result a `ColumnBatch` instance is returned
+    which holds values of that column for all the fetched rows. This
+    column-wise layout avoids building individual `Row` objects and is
+    preferred when bulk-processing large results. Rows that have already
+    been fetched using `fetchOne()` are not included.
+  */
+
+  std::vector<ColumnBatch> fetchColumns()
+  {
+    try {
+      return Row_result_detail::fetch_columns();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Return all remaining rows decoded into Arrow-compatible column
+    buffers.
+
+    For each column of the result an `ArrowColumn` instance is returned
+    holding validity bitmap, value or offset/data buffers, and the
+    column name and type, laid out as the corresponding Arrow array
+    (`Int64`/`UInt64`/`Float64`/`LargeUtf8`/`LargeBinary`). The buffers
+    can be handed to Arrow-based consumers without converting or copying
+    the values again. Rows that have already been fetched using
+    `fetchOne()` are not included.
+  */
+
+  std::vector<ArrowColumn> fetchArrow()
+  {
+    try {
+      return Row_result_detail::fetch_arrow();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Transfer the storage of all remaining rows out of the result.
+
+    The raw row data and the result meta-data are moved into the
+    returned `RowStorage` instance - a handoff of the underlying
+    buffers, no field values are copied. The application owns the
+    storage and string views obtained from it stay valid for as long
+    as the storage exists, independently of this result and of the
+    session that produced it. After the call the result contains no
+    more rows. Rows that have already been fetched using `fetchOne()`
+    are not included.
+  */
+
+  RowStorage releaseStorage()
+  {
+    try {
+      return Row_result_detail::release_storage();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Announce the expected size of the result to pre-allocate storage.
+
+    The server does not send a row count ahead of the rows, but the
+    application often knows one - a `LIMIT` clause, a fixed batch size,
+    or table statistics. Announcing (roughly) `rows` rows holding
+    `bytes` bytes of raw data in total lets the connector allocate the
+    row buffers and the columnar decode arenas in one shot instead of
+    growing them through repeated doubling while the rows arrive. This
+    is only an allocation hint - a wrong estimate wastes some memory or
+    reallocation but never affects the result contents. Call it before
+    fetching any rows.
+  */
+
+  void reserve(row_count_t rows, uint64_t bytes)
+  {
+    try {
+      Row_result_detail::reserve(rows, bytes);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Write all remaining rows of the result, together with its meta-data,
+    to a spool file at the given path.
+
+    Rows are stored in their wire format without decoding any values,
+    so spooling runs at transfer speed. The spooled rows are consumed
+    from this result. Returns the number of rows written. The file can
+    later be replayed without a server using `fromSpool()`, which is
+    useful for rebuilding caches offline or rehearsing decode
+    performance on a stored result.
+  */
+
+  uint64_t spool(const std::string &path)
+  {
+    try {
+      return Row_result_detail::spool(path);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Create a result which replays a result set stored in a spool file
+    (see `spool()`).
+
+    The stored rows are paged in from the file on demand and flow
+    through the regular row and columnar fetch paths, without any server
+    involved. A replayed result is not connected to a session and
+    carries no warnings or statement statistics.
+  */
+
+  static RowResult fromSpool(const std::string &path)
+  {
+    try {
+      return RowResult(path);
+    }
+    CATCH_AND_WRAP
+  }
+
   /**
     Returns the number of rows contained in the result.
 
@@ -701,13 +986,137 @@ private:
     : Result_common(init)
   {}
 
+  explicit RowResult(const std::string &spool_path)
+    : Result_common(spool_path)
+  {}
+
 public:
 
   template <class Res, class Op> friend class Executable;
+  template <class Res> friend class PendingResult;
+  template <class Res> friend class ScheduledResult;
   friend SqlResult;
   friend DocResult;
+  friend RowStream;
+};
+
+
+#ifdef MYSQLX_HAVE_COROUTINES
+
+/**
+  Awaitable stream of rows of a `RowResult` (requires C++20 coroutines).
+
+  Expression `co_await stream` produces the next row of the result, or a
+  null `Row` once all rows have been consumed. When the next row is
+  already buffered inside the connector the await completes immediately;
+  otherwise the consuming coroutine suspends instead of blocking the
+  thread, as `fetchOne()` would, and is resumed from `poll()` once its
+  row has arrived. This way a driver loop on a small thread pool can
+  interleave many result drains:
+
+  ~~~~~~
+    // consumer coroutine (any task type)
+
+    RowStream stream(res);
+    while (Row r = co_await stream)
+      process(r);
+
+    // driver loop
+
+    while (...)
+      for (RowStream *s : streams)
+        s->poll();
+  ~~~~~~
+
+  No particular coroutine task type is imposed - the stream is a plain
+  awaitable which can be used from any coroutine. The `RowResult` object
+  and the stream must stay alive until the consuming coroutine has
+  finished; the usual rule that a result can be consumed by at most one
+  thread at a time extends to one consumer coroutine per stream.
+
+  @ingroup devapi_res
+*/
+
+class RowStream
+{
+public:
+
+  RowStream(RowResult &res)
+    : m_res(res)
+  {}
+
+  // A stream is tied to one result and one consumer - no copying.
+
+  RowStream(const RowStream&) = delete;
+  RowStream& operator=(const RowStream&) = delete;
+
+
+  /*
+    Awaitable interface used by co_await.
+  */
+
+  /// Tell if the next row can be produced without suspending.
+
+  bool await_ready()
+  {
+    try {
+      return m_res.poll_row();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Park the consumer coroutine on the stream until poll() resumes it.
+
+  void await_suspend(std::coroutine_handle<> consumer)
+  {
+    m_consumer = consumer;
+  }
+
+  /// Produce the awaited row (a null `Row` at the end of the result).
+
+  Row await_resume()
+  {
+    return m_res.fetchOne();
+  }
+
+
+  /**
+    Progress the pending reply without blocking and resume the consumer
+    coroutine suspended on this stream once its row has arrived.
+
+    Returns true if a consumer is still suspended on the stream after the
+    call, that is, the stream needs further polling. Note that the resumed
+    consumer typically runs up to its next `co_await` on this stream,
+    parking itself on it again.
+  */
+
+  bool poll()
+  {
+    try {
+
+      if (!m_consumer)
+        return false;
+
+      if (!m_res.poll_row())
+        return true;  // the awaited row is still in transit
+
+      auto consumer = m_consumer;
+      m_consumer = nullptr;
+      consumer.resume();
+
+      return bool(m_consumer);
+    }
+    CATCH_AND_WRAP
+  }
+
+private:
+
+  RowResult &m_res;
+  std::coroutine_handle<> m_consumer;
 };
 
+#endif  // MYSQLX_HAVE_COROUTINES
+
 
 /**
   %Result of an SQL query or command.
@@ -768,6 +1177,27 @@ public:
   }
 
 
+  /**
+    Discard all remaining results of the reply without reading them in.
+
+    Remaining rows and result sets are dropped as they arrive from the
+    server, so finishing with a reply whose tail is large (for example
+    a summary result followed by a huge detail set which is not needed)
+    does not buffer that tail in memory - unlike executing another
+    statement while the reply is still live, which stores the remainder
+    first. After this call no more data can be read from the result and
+    the session is ready for the next statement.
+  */
+
+  void discard()
+  {
+    try {
+      Result_detail::discard();
+    }
+    CATCH_AND_WRAP
+  }
+
+
   /**
     Get the auto-increment value if one was generated by a table insert
     statement.
@@ -789,6 +1219,10 @@ private:
 
   template <class Res, class Op>
   friend class Executable;
+  template <class Res>
+  friend class PendingResult;
+  template <class Res>
+  friend class ScheduledResult;
 };
 
 
@@ -900,6 +1334,10 @@ private:
   friend DbDoc;
   template <class Res, class Op>
   friend class Executable;
+  template <class Res>
+  friend class PendingResult;
+  template <class Res>
+  friend class ScheduledResult;
 };
 
 MYSQLX_ABI_END(2,0)
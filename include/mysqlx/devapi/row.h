@@ -39,9 +39,15 @@
 
 #include "common.h"
 #include "document.h"
+#include "geometry.h"
 #include "detail/row.h"
 
 #include <memory>
+#include <tuple>
+
+#if defined(__cpp_lib_string_view)
+#include <string_view>
+#endif
 
 
 namespace mysqlx {
@@ -150,13 +156,64 @@ public:
   }
 
 
+#if defined(__cpp_lib_string_view)
+
+  /**
+    Get value of row field at position `pos` as a borrowed string view.
+
+    Unlike `get()`, which copies string data into an owned `Value`, the
+    returned view refers directly to the raw bytes held by this row and
+    remains valid as long as some copy of the row exists. For fields of
+    type STRING, JSON or BYTES the artificial trailing 0x00 byte of the
+    raw representation (see `getBytes()`) is not included in the view.
+    For other types the view shows the raw x-protocol encoding of the
+    value.
+
+    @returns empty view if given field is NULL.
+    @throws out_of_range if given row was not fetched from server.
+  */
+
+  std::string_view getView(col_count_t pos) const
+  {
+    try {
+      bytes data = Row_detail::get_view(pos);
+      return { reinterpret_cast<const char*>(data.begin()), data.size() };
+    }
+    CATCH_AND_WRAP
+  }
+
+#endif
+
+
+  /**
+    Get a zero-copy view of a GEOMETRY field at position `pos`.
+
+    The returned `GeometryView` refers directly to the raw bytes held by
+    this row (no copy is made) and remains valid as long as some copy of
+    the row exists. It gives access to the SRID, the WKB type, the point
+    count and the bounding box of the value, and to the WKB bytes
+    themselves.
+
+    @throws Error if the field is not of type GEOMETRY or is NULL.
+    @throws out_of_range if given row was not fetched from server.
+  */
+
+  GeometryView getGeometry(col_count_t pos) const
+  {
+    try {
+      return GeometryView(Row_detail::get_geometry(pos));
+    }
+    CATCH_AND_WRAP
+  }
+
+
   /**
     Get reference to row field at position `pos`.
 
     @throws out_of_range if given field does not exist in the row.
   */
 
-  Value& get(col_count_t pos)
+  Value& get(col_count_t pos) &
   {
     try {
       return Row_detail::get_val(pos);
@@ -164,6 +221,92 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Get value of row field at position `pos`, moved out of the row.
+
+    This overload is used when the row itself is a temporary, such as in
+    `res.fetchOne().get(0)` - the field value is moved into the result
+    instead of being copied out of a row that is about to be destroyed.
+  */
+
+  Value get(col_count_t pos) &&
+  {
+    try {
+      return std::move(Row_detail::get_val(pos));
+    }
+    CATCH_AND_WRAP
+  }
+
+
+  /**
+    Get reference to the row field with the given column label.
+
+    The label is matched case-insensitively against the result's column
+    labels using a look-up index built once per result; when several
+    columns share a label, the first one is used.
+
+    @throws out_of_range if no column with the given label exists.
+  */
+
+  Value& get(const string &name) &
+  {
+    try {
+      return Row_detail::get_val(std::string(name));
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Same as above, moving the value out of a temporary row.
+
+  Value get(const string &name) &&
+  {
+    try {
+      return std::move(Row_detail::get_val(std::string(name)));
+    }
+    CATCH_AND_WRAP
+  }
+
+
+  /**
+    Get values of all row fields at once, converted to the given types.
+
+    Returns a `std::tuple` with one element per row field, in field
+    order. The element types must match the column types of the result:
+    `int64_t` for signed and `uint64_t` for unsigned integer columns,
+    `double` or `float` for floating point columns, `bool` for integer
+    columns treated as flags and `std::string` (utf8) for string
+    columns.
+
+    Unlike `get()`, which converts a field to a `Value` instance first,
+    this method decodes the raw field bytes directly into the tuple
+    elements, using codecs resolved from the result meta-data. When many
+    rows of a known shape are read, this avoids the per-field type
+    dispatch and the intermediate value storage:
+
+    ~~~~~~
+      int64_t id; std::string name; double score;
+      while (Row r = res.fetchOne())
+      {
+        std::tie(id, name, score) = r.as<int64_t, std::string, double>();
+        ...
+      }
+    ~~~~~~
+
+    @throws Error if an element type does not match the type of the
+    corresponding column or the field is NULL.
+  */
+
+  template <typename... Types>
+  std::tuple<Types...> as()
+  {
+    std::tuple<Types...> values;
+    try {
+      fill_values<0>(values);
+    }
+    CATCH_AND_WRAP
+    return values;
+  }
+
 
   /**
     Set value of row field at position `pos`.
@@ -229,6 +372,24 @@ public:
 
 private:
 
+  /*
+    Helpers for as<>(): decode the field at position I into the I-th
+    tuple element, recursing over the remaining elements.
+  */
+
+  template <size_t I, typename... Types>
+  typename std::enable_if<I == sizeof...(Types)>::type
+  fill_values(std::tuple<Types...>&)
+  {}
+
+  template <size_t I, typename... Types>
+  typename std::enable_if<(I < sizeof...(Types))>::type
+  fill_values(std::tuple<Types...> &values)
+  {
+    Row_detail::get_typed(static_cast<col_count_t>(I), std::get<I>(values));
+    fill_values<I + 1>(values);
+  }
+
   using internal::Row_detail::m_impl;
 
   /// @cond IGNORED
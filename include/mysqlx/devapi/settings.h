@@ -518,6 +518,7 @@ public:
     - `tls-ciphersuites=[...]` : see `SessionOption::TLS_CIPHERSUITES`
     - `compression=...` : see `SessionOption::COMPRESSION`
     - `compression-algorithms=[...]` : see `SessionOption::COMPRESSION_ALGORITHMS`
+    - `compression-level=...` : see `SessionOption::COMPRESSION_LEVEL`
   */
 
   SessionSettings(const string &uri)
@@ -876,7 +877,8 @@ public:
         "enabled": true,
         "maxSize": 25,
         "queueTimeout": 1000,
-        "maxIdleTime": 5000}
+        "maxIdleTime": 5000,
+        "minSize": 4}
     }
     ~~~~~~
 
@@ -898,6 +900,10 @@ public:
                      an available session will wait in the pool before it is
                      removed.
                      By default it doesn't cleans sessions.
+    - `minSize` : integer that defines the number of ready sessions kept in
+                  the pool by a background warm-up task, so that sessions
+                  acquired after an idle period do not pay the connect cost.
+                  Defaults to 0 (no warm-up).
 
   */
 
@@ -920,7 +926,8 @@ public:
         "enabled": true,
         "maxSize": 25,
         "queueTimeout": 1000,
-        "maxIdleTime": 5000}
+        "maxIdleTime": 5000,
+        "minSize": 4}
     }
     ~~~~~~
 
@@ -942,6 +949,10 @@ public:
                      an available session will wait in the pool before it is
                      removed.
                      By default it doesn't cleans sessions.
+    - `minSize` : integer that defines the number of ready sessions kept in
+                  the pool by a background warm-up task, so that sessions
+                  acquired after an idle period do not pay the connect cost.
+                  Defaults to 0 (no warm-up).
 
   */
 
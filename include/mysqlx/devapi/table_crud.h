@@ -63,6 +63,12 @@
 #include "result.h"
 #include "executable.h"
 #include "crud.h"
+#include "expr_builder.h"
+
+PUSH_SYS_WARNINGS
+#include <list>
+#include <vector>
+POP_SYS_WARNINGS
 
 
 namespace mysqlx {
@@ -73,6 +79,8 @@ class Table;
 // ---------------------------------------------------------------------------
 
 class TableInsert;
+class TableBulkLoad;
+class TableBulkUpdate;
 
 namespace internal {
 
@@ -160,6 +168,33 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Add a row of borrowed values to the list of rows to be inserted.
+
+    Each element of `row` is a byte range holding the raw representation
+    of one field. Contrary to the other `values()` overloads the data is
+    not copied - it is serialized into the protocol message directly
+    from the given memory, which the caller must keep valid until the
+    statement (including any copies of it) has been executed. This
+    avoids moving each value through intermediate copies when inserting
+    data which is already in memory, such as rows read from a
+    memory-mapped file.
+
+    The fields are sent as plain octet literals which the server
+    converts to the target column types following the usual SQL
+    conversion rules. An element with a null base pointer is inserted
+    as SQL `NULL`.
+  */
+
+  TableInsert& values(const std::vector<bytes> &row)
+  {
+    try {
+      add_row_view(get_impl(), row);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
   /**
     Add rows from a container such as vector or list.
   */
@@ -213,10 +248,188 @@ protected:
 
   ///@cond IGNORED
   friend Table;
+  // TableBulkLoad sets the column list of its internal insert statement.
+  friend TableBulkLoad;
   ///@endcond
 };
 
 
+/**
+  Bulk-load of delimited text (CSV/TSV) into a table.
+
+  The loader parses delimited text straight into insert statements using
+  the borrowing `TableInsert::values()` path, so field data travels from
+  the input buffer into the protocol messages without being copied into
+  `Row` or `Value` objects. Rows are accumulated into batches of roughly
+  `setBatchSize()` bytes; each full batch is submitted without waiting
+  for the reply of the previous one, so parsing overlaps with server
+  execution.
+
+  The input can be given in one piece - e.g. a whole memory-mapped
+  file - or streamed in consecutive pieces with repeated `load()` calls;
+  a row split across pieces is carried over. Each piece must stay valid
+  until the rows parsed from it have been sent, which is guaranteed
+  after the next batch boundary and, at the latest, when `flush()`
+  returns.
+
+  Format: fields separated by the field delimiter (default `,`), rows by
+  the line delimiter (default `\n`, a preceding `\r` is ignored). Empty
+  lines are skipped. A field may be enclosed in the quote character
+  (default `"`), in which case delimiters inside it are literal and a
+  doubled quote denotes a single one; only fields which actually contain
+  doubled quotes are unescaped into a side buffer, everything else is
+  borrowed as-is. An unquoted field equal to the null marker (default
+  `\N`) is inserted as SQL `NULL`.
+
+  `flush()` sends the final partial batch and collects all outstanding
+  replies; a loader discarded without `flush()` does not send buffered
+  rows. Server errors are thrown from the call which collects the
+  failed reply.
+
+  Example - load a memory-mapped CSV file:
+  ~~~~~~
+    TableBulkLoad load(tbl, "id", "name", "price");
+    load.load(file_data, file_size);
+    load.flush();
+    std::cout << load.getRowCount() << " rows loaded" << std::endl;
+  ~~~~~~
+
+  @ingroup devapi_op
+*/
+
+class PUBLIC_API TableBulkLoad
+{
+public:
+
+  /// Create a loader inserting into all columns of the table, in order.
+
+  TableBulkLoad(Table &table)
+    : m_tmpl(table), m_batch(m_tmpl)
+  {}
+
+  /// Create a loader inserting into the given columns.
+
+  template <class... Cols>
+  TableBulkLoad(Table &table, const Cols&... cols)
+    : m_tmpl(table), m_batch(m_tmpl)
+  {
+    try {
+      TableInsert::add_columns(m_tmpl.get_impl(), cols...);
+      m_batch = m_tmpl;
+    }
+    CATCH_AND_WRAP
+  }
+
+  // Note: a loader can not be copied.
+
+  TableBulkLoad(const TableBulkLoad&) = delete;
+  TableBulkLoad& operator=(const TableBulkLoad&) = delete;
+
+  /// Set the field delimiter (default `,`).
+
+  TableBulkLoad& setFieldDelimiter(char c)
+  {
+    m_field_sep = c;
+    return *this;
+  }
+
+  /// Set the line delimiter (default `\n`).
+
+  TableBulkLoad& setLineDelimiter(char c)
+  {
+    m_line_sep = c;
+    return *this;
+  }
+
+  /// Set the quote character; 0 disables quote handling (default `"`).
+
+  TableBulkLoad& setQuote(char c)
+  {
+    m_quote = c;
+    return *this;
+  }
+
+  /// Set the marker denoting SQL `NULL` in unquoted fields (default `\N`).
+
+  TableBulkLoad& setNullMarker(const std::string &marker)
+  {
+    try {
+      m_null = marker;
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Set the byte budget after which a batch of rows is sent (default 16MB).
+
+  TableBulkLoad& setBatchSize(size_t bytes)
+  {
+    if (bytes > 0)
+      m_batch_bytes = bytes;
+    return *this;
+  }
+
+  /**
+    Parse a piece of delimited text and send full batches of rows.
+
+    Can be called repeatedly with consecutive pieces of the input; an
+    incomplete final line is carried over to the next call and completed
+    by it or by `flush()`.
+  */
+
+  TableBulkLoad& load(const char *data, size_t size);
+
+  TableBulkLoad& load(bytes data)
+  {
+    return load((const char*)data.begin(), data.size());
+  }
+
+  /// Send the remaining rows and collect all outstanding replies.
+
+  void flush();
+
+  /// Number of rows parsed and passed to insert statements so far.
+
+  uint64_t getRowCount() const
+  {
+    return m_row_count;
+  }
+
+private:
+
+  void parse_row(const char *line, size_t len);
+  void send_batch();
+
+  TableInsert m_tmpl;   // table and column list, no rows
+  TableInsert m_batch;  // the batch being accumulated
+
+  char m_field_sep = ',';
+  char m_line_sep = '\n';
+  char m_quote = '"';
+
+  size_t m_batch_bytes = 16*1024*1024;
+
+  DLL_WARNINGS_PUSH
+
+  std::string m_null = "\\N";
+
+  // Line carried over between load() calls.
+  std::string m_tail;
+
+  // Keeps unescaped quoted fields (and completed carried-over lines)
+  // alive until the batch referring to them is sent.
+  std::list<std::string> m_strings;
+
+  std::list<PendingResult<Result>> m_pending;
+
+  DLL_WARNINGS_POP
+
+  size_t    m_open_bytes = 0;
+  uint64_t  m_open_rows = 0;
+  uint64_t  m_row_count = 0;
+};
+
+
 // ---------------------------------------------------------------------------
 
 class TableSelect;
@@ -231,7 +444,8 @@ namespace internal {
 
   struct Table_select_base
     : public Group_by < Having < Order_by < Limit < Offset< Bind_parameters<
-        Set_lock< Table_select_cmd, common::Table_select_if >
+        Set_hint< Set_lock< Table_select_cmd, common::Table_select_if >,
+                  common::Table_select_if >
       > > > > > >
   {};
 
@@ -305,6 +519,21 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Specify row selection criteria as an expression built with the typed
+    expression builder API (see class `Expr`). No expression string is
+    built or parsed on this path.
+  */
+
+  Operation& where(const Expr &criteria)
+  {
+    try {
+      get_impl()->set_where(criteria.getTree());
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Table_select_if;
@@ -368,6 +597,12 @@ public:
     where(expr);
   }
 
+  TableUpdate(Table &table, const Expr &criteria)
+    : TableUpdate(table)
+  {
+    where(criteria);
+  }
+
   TableUpdate(const internal::Table_update_cmd &other)
   {
     internal::Table_update_cmd::operator=(other);
@@ -409,6 +644,20 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Specify selection criteria as an expression built with the typed
+    expression builder API (see class `Expr`).
+  */
+
+  Operation& where(const Expr &criteria)
+  {
+    try {
+      get_impl()->set_where(criteria.getTree());
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Table_update_if;
@@ -420,10 +669,180 @@ protected:
 
   ///@cond IGNORED
   friend Table;
+  friend TableBulkUpdate;
   ///@endcond
 };
 
 
+// ----------------------------------------------------------------------
+
+/*
+  Bulk updates
+  ============
+*/
+
+
+/**
+  Bulk update of many rows with per-row bind values.
+
+  The updater holds one update statement shape - the `set()` and
+  `where()` clauses, with named `:param` placeholders - and a rowset of
+  values for those placeholders, one tuple per row to update. Rows are
+  accumulated into batches of `setBatchSize()` statements; a full batch
+  is sent to the server as one pipelined sequence of update commands in a
+  single network write, and the replies are collected before the next
+  batch is opened, so memory use stays flat for arbitrarily large
+  rowsets.
+
+  The X Protocol has no multi-row update message, so each row travels as
+  its own update command. All rows share one statement shape, which the
+  session's statement-shape cache turns into a server-side prepared
+  statement after the first few executions - later rows send only the
+  statement id and the bind values.
+
+  `flush()` sends the final partial batch and collects its replies; an
+  updater discarded without `flush()` does not send buffered rows.
+  Server errors are thrown from the call which collects the failed
+  reply; replies of the rows that follow the failed one in its batch are
+  discarded.
+
+  Example - reconcile quantities:
+  ~~~~~~
+    TableBulkUpdate upd(tbl, "id", "qty");
+    upd.set("qty", expr(":qty")).where("id = :id");
+
+    for (auto &rec : reconciled)
+      upd.row(rec.id, rec.qty);
+
+    upd.flush();
+    std::cout << upd.getAffectedItemsCount() << " rows updated" << std::endl;
+  ~~~~~~
+
+  @ingroup devapi_op
+*/
+
+class PUBLIC_API TableBulkUpdate
+{
+public:
+
+  /**
+    Create a bulk updater for the given table.
+
+    The `params` name the statement parameters which each row binds, in
+    the order in which `row()` lists the values.
+  */
+
+  template <class... Params>
+  TableBulkUpdate(Table &table, const Params&... params)
+    : m_table(&table), m_tmpl(table)
+  {
+    try {
+      m_params = { string(params)... };
+    }
+    CATCH_AND_WRAP
+  }
+
+  // Note: an updater can not be copied.
+
+  TableBulkUpdate(const TableBulkUpdate&) = delete;
+  TableBulkUpdate& operator=(const TableBulkUpdate&) = delete;
+
+  /**
+    Set the given field in updated rows to the given value.
+
+    As in `TableUpdate::set()`, the value can be a literal or an
+    expression given as `expr(<string>)`; expressions can refer to the
+    declared `:param` placeholders.
+  */
+
+  TableBulkUpdate& set(const string &field, const Value &val)
+  {
+    m_tmpl.set(field, val);
+    return *this;
+  }
+
+  /// Specify selection criteria for the rows updated by each tuple.
+
+  TableBulkUpdate& where(const string &expr)
+  {
+    m_tmpl.where(expr);
+    return *this;
+  }
+
+  /// Set the number of rows sent as one pipelined batch (default 1024).
+
+  TableBulkUpdate& setBatchSize(size_t rows)
+  {
+    if (rows > 0)
+      m_batch_rows = rows;
+    return *this;
+  }
+
+  /**
+    Add a row of values for the declared parameters, sending a full
+    batch of update commands.
+  */
+
+  template <class... Values>
+  TableBulkUpdate& row(const Values&... vals)
+  {
+    try {
+      add_row({ Value(vals)... });
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+  TableBulkUpdate& row(const std::vector<Value> &vals)
+  {
+    try {
+      add_row(vals);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Send the remaining rows and collect all outstanding replies.
+
+  void flush();
+
+  /// Total number of table rows updated by collected replies so far.
+
+  uint64_t getAffectedItemsCount() const
+  {
+    return m_affected;
+  }
+
+  /// Number of rows added to the updater so far.
+
+  uint64_t getRowCount() const
+  {
+    return m_row_count;
+  }
+
+private:
+
+  void add_row(const std::vector<Value>&);
+  void send_batch();
+
+  Table *m_table;
+  TableUpdate m_tmpl;
+
+  size_t m_batch_rows = 1024;
+
+  DLL_WARNINGS_PUSH
+
+  std::vector<string> m_params;
+  std::list<PendingResult<Result>> m_pending;
+
+  DLL_WARNINGS_POP
+
+  bool m_open = false;  // a pipelined batch is being accumulated
+  uint64_t m_row_count = 0;
+  uint64_t m_affected = 0;
+};
+
+
 // ---------------------------------------------------------------------------
 
 class TableRemove;
@@ -470,6 +889,12 @@ public:
     where(expr);
   }
 
+  TableRemove(Table &table, const Expr &criteria)
+    : TableRemove(table)
+  {
+    where(criteria);
+  }
+
   TableRemove(const internal::Table_remove_cmd &other)
   {
     internal::Table_remove_cmd::operator=(other);
@@ -495,6 +920,20 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Specify selection criteria as an expression built with the typed
+    expression builder API (see class `Expr`).
+  */
+
+  Operation& where(const Expr &criteria)
+  {
+    try {
+      get_impl()->set_where(criteria.getTree());
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
 protected:
 
   using Impl = common::Table_remove_if;
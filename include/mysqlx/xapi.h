@@ -102,6 +102,15 @@ typedef object_id* MYSQLX_GUID;
 
 #define RESULT_OK 0
 
+/**
+  Return value indicating that an asynchronously executed statement
+  is still waiting for the server reply.
+
+  @see mysqlx_async_poll()
+*/
+
+#define RESULT_PENDING 2
+
 /**
   Return value flag indicating that the last reading operation
   did not finish reading to the end and there is still more data
@@ -301,6 +310,16 @@ typedef struct mysqlx_row_struct mysqlx_row_t;
 typedef struct mysqlx_result_struct mysqlx_result_t;
 
 
+/**
+  Type of asynchronous execution handles.
+
+  @see mysqlx_execute_async(), mysqlx_async_poll(), mysqlx_async_wait(),
+       mysqlx_async_wait_any()
+*/
+
+typedef struct mysqlx_async_struct mysqlx_async_t;
+
+
 /**
   The data type identifiers used in MYSQLX API.
 */
@@ -426,6 +445,7 @@ mysqlx_opt_type_t;
 #define OPT_TLS_CIPHERSUITES(A) MYSQLX_OPT_TLS_CIPHERSUITES, (A)
 #define OPT_COMPRESSION(A) MYSQLX_OPT_COMPRESSION, (unsigned int)(A)
 #define OPT_COMPRESSION_ALGORITHMS(A) MYSQLX_OPT_COMPRESSION_ALGORITHMS, (const char*)(A)
+#define OPT_COMPRESSION_LEVEL(A) MYSQLX_OPT_COMPRESSION_LEVEL, (int)(A)
 
 
 /**
@@ -574,7 +594,8 @@ mysqlx_lock_contention_t;
         "enabled": true,
         "maxSize": 25,
         "queueTimeout": 1000,
-        "maxIdleTime": 5000}
+        "maxIdleTime": 5000,
+        "minSize": 4}
     }
   ~~~~~~
 
@@ -595,6 +616,10 @@ mysqlx_lock_contention_t;
                     an available session will wait in the pool before it is
                     removed.
                     By default it doesn't cleans sessions.
+  - `minSize` : integer that defines the number of ready sessions kept in the
+                pool by a background warm-up task, so that sessions acquired
+                after an idle period do not pay the connect cost.
+                Defaults to 0 (no warm-up).
 
   @param conn_string    connection string
   @param client_opts    client options in the form of a JSON string.
@@ -628,7 +653,8 @@ mysqlx_get_client_from_url(const char *conn_string, const char *client_opts,
         "enabled": true,
         "maxSize": 25,
         "queueTimeout": 1000,
-        "maxIdleTime": 5000}
+        "maxIdleTime": 5000,
+        "minSize": 4}
     }
   ~~~~~~
 
@@ -649,6 +675,10 @@ mysqlx_get_client_from_url(const char *conn_string, const char *client_opts,
                     an available session will wait in the pool before it is
                     removed.
                     By default it doesn't cleans sessions.
+  - `minSize` : integer that defines the number of ready sessions kept in the
+                pool by a background warm-up task, so that sessions acquired
+                after an idle period do not pay the connect cost.
+                Defaults to 0 (no warm-up).
 
   @param opt  handle to client configuration data
   @param[out] error     if error happens during connect the error object
@@ -812,6 +842,7 @@ mysqlx_get_session(const char *host, int port, const char *user,
   - `tls-ciphersuites=[...]` : see `#MYSQLX_OPT_TLS_CIPHERSUITES`
   - `compression=...` : see `#MYSQLX_OPT_COMPRESSION`
   - `compression-algorithms=[...]` : see `#MYSQLX_OPT_COMPRESSION_ALGORITHMS`
+  - `compression-level=...` : see `#MYSQLX_OPT_COMPRESSION_LEVEL`
 
 
   @note The session returned by the function must be properly closed using
@@ -2368,6 +2399,142 @@ PUBLIC_API mysqlx_result_t *
 mysqlx_execute(mysqlx_stmt_t *stmt);
 
 
+/**
+  Start executing a statement without waiting for the server reply
+
+  The statement is sent to the server and the function returns
+  immediately with a handle representing the execution in progress.
+  Use `mysqlx_async_poll()` to check for its completion without blocking
+  and `mysqlx_async_wait()` to complete the execution and obtain the
+  result.
+
+  The handle is owned by the statement: it is valid until the statement
+  handle is freed or the statement is executed again. Only one
+  asynchronous execution per statement can be in progress; different
+  statements can execute in parallel and can be waited on together with
+  `mysqlx_async_wait_any()`.
+
+  @param stmt statement handle
+
+  @return handle representing the asynchronous execution, or NULL on
+          error. The statement is set to an error state and errors can
+          be examined using the statement handle.
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API mysqlx_async_t *
+mysqlx_execute_async(mysqlx_stmt_t *stmt);
+
+
+/**
+  Check whether an asynchronously executed statement has completed
+
+  The call does not block, but it advances protocol processing of the
+  statement, so polling drives the execution forward.
+
+  @param handle asynchronous execution handle returned by
+         `mysqlx_execute_async()`
+
+  @return `RESULT_OK` if the execution has completed and
+          `mysqlx_async_wait()` will not block; `RESULT_PENDING` if the
+          statement is still waiting for the server reply;
+          `RESULT_ERROR` on error
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API int
+mysqlx_async_poll(mysqlx_async_t *handle);
+
+
+/**
+  Complete an asynchronous statement execution and get its result
+
+  Blocks until the server reply arrives, if it did not arrive yet.
+  Subsequent calls on the same handle return the same result handle.
+
+  @param handle asynchronous execution handle returned by
+         `mysqlx_execute_async()`
+
+  @return handle that can be used to access results of the operation,
+          with the same validity rules as for `mysqlx_execute()`.
+          On error NULL is returned.
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API mysqlx_result_t *
+mysqlx_async_wait(mysqlx_async_t *handle);
+
+
+/**
+  Wait until one of the given asynchronous executions completes
+
+  Polls the given handles, driving protocol processing of all of their
+  statements, until at least one of them is ready. NULL entries in the
+  array are skipped.
+
+  @param handles array of asynchronous execution handles
+  @param count number of entries in the array
+  @param[out] pos if not NULL, set to the index of a completed handle
+
+  @return `RESULT_OK` when a completed handle was found (its index is
+          stored in `pos`); `RESULT_ERROR` if the array holds no valid
+          handles. A handle whose statement failed is reported as
+          completed -- the error surfaces when it is waited on.
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API int
+mysqlx_async_wait_any(mysqlx_async_t **handles, size_t count, size_t *pos);
+
+
+/**
+  Start a statement batch on the session
+
+  Commands of statements started with `mysqlx_execute_async()` while a
+  batch is active are accumulated and sent to the server as a single
+  network write when the batch is flushed with `mysqlx_batch_flush()`.
+  This saves one round-trip per statement when issuing many small
+  statements.
+
+  While a batch is active, synchronous execution with `mysqlx_execute()`
+  is not allowed on the session and waiting on the asynchronous handles
+  of batched statements fails -- complete the batch first, then examine
+  per-statement results by waiting on their handles.
+
+  @param sess session handle
+
+  @return `RESULT_OK` - on success; `RESULT_ERROR` - on error (for
+          example, when a batch is already active)
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API int
+mysqlx_batch_begin(mysqlx_session_t *sess);
+
+
+/**
+  Send all statements batched on the session to the server
+
+  After the flush, results of the batched statements are obtained by
+  waiting on their asynchronous execution handles, in any order.
+
+  @param sess session handle
+
+  @return `RESULT_OK` - on success; `RESULT_ERROR` - on error (for
+          example, when no batch is active)
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API int
+mysqlx_batch_flush(mysqlx_session_t *sess);
+
+
 /**
   Bind values for parametrized statements.
 
@@ -2415,6 +2582,31 @@ mysqlx_execute(mysqlx_stmt_t *stmt);
 PUBLIC_API int mysqlx_stmt_bind(mysqlx_stmt_t *stmt, ...);
 
 
+/**
+  Reset a statement handle so that it can be executed again.
+
+  Re-using one handle across executions avoids re-creating the statement
+  for every call: the statement specification and its compiled shape are
+  kept, and when the statement was prepared on the server its
+  prepared-statement id is preserved, so the next execution sends only
+  the statement id with the new parameter values. The previous result of
+  the handle is freed (a pending asynchronous execution is completed
+  first), its diagnostics are cleared and all parameter binds are
+  removed - bind new values with `mysqlx_stmt_bind()` before executing
+  the handle again.
+
+  @param stmt statement handle
+
+  @return `RESULT_OK` - on success; `RESULT_ERROR` - on error
+
+  @see mysqlx_stmt_bind(), mysqlx_execute()
+
+  @ingroup xapi_stmt
+*/
+
+PUBLIC_API int mysqlx_stmt_reset(mysqlx_stmt_t *stmt);
+
+
 /**
   Specify a table query projection.
 
@@ -2894,6 +3086,36 @@ mysqlx_get_bytes(mysqlx_row_t* row, uint32_t col,
                  uint64_t offset, void *buf, size_t *buf_len);
 
 
+/**
+  Get a pointer to raw bytes stored in a row, without copying them.
+
+  This is a zero-copy variant of mysqlx_get_bytes(): instead of writing
+  the column data into a caller supplied buffer, it returns a pointer to
+  the internal buffer of the row handle. The data has the same raw
+  x-protocol representation as described for mysqlx_get_bytes() (note
+  the extra 0x00 byte at the end of BYTES and STRING values).
+
+  The returned pointer remains valid as long as the row handle itself,
+  that is, until the result the row was fetched from is freed or the
+  next result is read. The data must not be modified through it.
+
+  @param row row handle
+  @param col zero-based column number
+  @param[out] buf set to a pointer to the column data, or NULL if the
+              value in the requested column is NULL
+  @param[out] buf_len set to the length of the column data in bytes
+
+  @return `RESULT_OK` - on success; `RESULT_NULL` when the value in the
+          requested column is NULL; `RESULT_ERROR` - on error
+
+  @ingroup xapi_res
+*/
+
+PUBLIC_API int
+mysqlx_get_bytes_ref(mysqlx_row_t* row, uint32_t col,
+                     const void **buf, size_t *buf_len);
+
+
 /**
   Get an unsigned integer number from a row.
 
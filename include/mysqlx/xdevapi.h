@@ -92,11 +92,19 @@
 
 #include "devapi/common.h"
 #include "devapi/result.h"
+#include "devapi/expr_builder.h"
 #include "devapi/collection_crud.h"
 #include "devapi/table_crud.h"
 #include "devapi/settings.h"
 #include "devapi/detail/session.h"
 
+PUSH_SYS_WARNINGS
+#include <chrono>
+#include <deque>    // producer queues in StatementScheduler
+#include <list>     // statement entries in StatementScheduler
+#include <thread>   // sleep_for() in runTransaction()
+POP_SYS_WARNINGS
+
 namespace mysqlx {
 MYSQLX_ABI_BEGIN(2,0)
 
@@ -611,10 +619,10 @@ public:
       /*
         Note: We get from server a list of schemata filtered by the name of
         this schema - if the schema exists the list should not be empty.
+        A recently stored answer can be re-used instead, see the
+        METADATA_CACHE_TTL session option.
       */
-      internal::Session_detail::Name_src list(*m_sess, m_name);
-      list.iterator_start();
-      return list.iterator_next();
+      return const_cast<Schema*>(this)->schema_exists();
     }
     CATCH_AND_WRAP
   }
@@ -925,8 +933,8 @@ public:
   bool existsInDatabase() const
   {
     try {
-      Schema::StringList list(m_schema, Schema::COLLECTION, m_name);
-      return list.begin() != list.end();
+      return 0 != const_cast<Collection*>(this)
+                  ->m_schema.object_exists(Schema::COLLECTION, m_name);
     }
     CATCH_AND_WRAP
   }
@@ -987,6 +995,24 @@ public:
     CATCH_AND_WRAP;
   }
 
+  /**
+    Return an operation which finds documents that satisfy given criteria.
+
+    The criteria are specified as an expression built with the typed
+    expression builder API (see class `Expr`). Contrary to criteria given
+    as strings, no expression string is built or parsed on this path.
+
+    @see `Expr`
+  */
+
+  CollectionFind find(const Expr &criteria)
+  {
+    try {
+      return CollectionFind(*this, criteria);
+    }
+    CATCH_AND_WRAP;
+  }
+
   /**
     Return an operation which adds documents to the collection.
 
@@ -1038,6 +1064,21 @@ public:
     CATCH_AND_WRAP;
   }
 
+  /**
+    Return an operation which removes documents satisfying criteria given
+    as an expression built with the typed expression builder API.
+
+    @see `Expr`
+  */
+
+  CollectionRemove remove(const Expr &criteria)
+  {
+    try {
+      return CollectionRemove(*this, criteria);
+    }
+    CATCH_AND_WRAP;
+  }
+
   /**
     Return an operation which modifies documents that satisfy given criteria.
 
@@ -1064,16 +1105,90 @@ public:
     CATCH_AND_WRAP;
   }
 
+  /**
+    Return an operation which modifies documents satisfying criteria given
+    as an expression built with the typed expression builder API.
+
+    @see `Expr`
+  */
+
+  CollectionModify modify(const Expr &criteria)
+  {
+    try {
+      return CollectionModify(*this, criteria);
+    }
+    CATCH_AND_WRAP;
+  }
+
   /**
     Return the document with the given id.
 
     Returns null document if a document with the given id does not exist in
     the collection.
+
+    If the document cache is enabled for this collection (see
+    `enableDocumentCache()`), the document may be served from the cache
+    without contacting the server.
   */
 
   DbDoc getOne(const string &id)
   {
-    return find("_id = :id").bind("id", id).execute().fetchOne();
+    try {
+
+      std::string json;
+
+      if (Collection_detail::doc_cache_find(id, json))
+        return DbDoc(std::move(json));
+
+      DbDoc doc = find("_id = :id").bind("id", id).execute().fetchOne();
+
+      if (!doc.isNull() && Collection_detail::doc_cache_active())
+      {
+        std::ostringstream buf;
+        buf << doc;
+        Collection_detail::doc_cache_store(id, buf.str());
+      }
+
+      return doc;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Enable client-side caching of documents returned by `getOne()`.
+
+    Documents fetched by id are kept in a per-collection cache inside the
+    session, bounded by the given byte budget with least-recently-used
+    eviction, so that repeated `getOne()` calls for the same document skip
+    the server entirely. Add, modify, remove and replace operations
+    executed on the collection through the same session drop the cached
+    documents right away; writes done by other clients are noticed only
+    once `ttl_ms` milliseconds have passed since a document was cached.
+    With a zero `ttl_ms` cached documents are invalidated only by this
+    client's own writes - appropriate for collections this client alone
+    modifies.
+
+    Calling the method again re-configures the cache keeping its current
+    contents. The cache is shared by all `Collection` objects of the same
+    session which refer to this collection.
+  */
+
+  void enableDocumentCache(size_t max_bytes, uint64_t ttl_ms = 0)
+  {
+    try {
+      Collection_detail::doc_cache_enable(max_bytes, ttl_ms);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Disable the document cache, dropping the cached documents.
+
+  void disableDocumentCache()
+  {
+    try {
+      Collection_detail::doc_cache_enable(0, 0);
+    }
+    CATCH_AND_WRAP
   }
 
   /**
@@ -1179,6 +1294,7 @@ public:
   friend CollectionAdd;
   friend CollectionRemove;
   friend CollectionModify;
+  friend CollectionModifyBatch;
 
   ///@cond IGNORE
   friend internal::Crud_factory;
@@ -1560,6 +1676,7 @@ private:
   friend TableInsert;
   friend TableRemove;
   friend TableUpdate;
+  friend TableBulkUpdate;
 
   ///@cond IGNORE
   friend internal::Crud_factory;
@@ -1574,15 +1691,15 @@ bool Table::existsInDatabase() const
     /*
       Note: When checking existence, we also determine if this is a view or
       a plain table because this information is fetched from the server when
-      querying for a list of tables.
+      querying for a list of tables (2 below means an existing view).
     */
-    Schema::TableList list(m_schema, m_name);
-    auto it = list.begin();
+    unsigned state =
+      const_cast<Table*>(this)->m_schema.object_exists(Schema::TABLE, m_name);
 
-    if (!(it != list.end()))
+    if (0 == state)
       return false;
 
-    const_cast<Table*>(this)->m_type = (*it).isView() ? VIEW : TABLE;
+    const_cast<Table*>(this)->m_type = (2 == state) ? VIEW : TABLE;
     return true;
   }
   CATCH_AND_WRAP
@@ -1635,6 +1752,124 @@ uint64_t Collection::count()
 using SqlStatement = internal::SQL_statement;
 
 
+/**
+  Builder which declares a session initialization preamble and executes
+  it as one pipelined batch.
+
+  A typical application runs the same preamble on every new session:
+  select the working schema, set a few session variables, make sure the
+  collections it uses exist. Executed one by one these statements cost
+  one network round trip each. A bootstrap executes the whole declared
+  preamble in a single round trip: all commands are accumulated in the
+  session pipeline and flushed with one write, and only then are the
+  server replies examined.
+
+  ~~~~~~
+    sess.bootstrap()
+        .schema("app")
+        .variable("sql_mode", "TRADITIONAL")
+        .checkCollection("app", "users")
+        .execute();
+  ~~~~~~
+
+  The batch sends the selected schema first, then the variables, then
+  the SQL statements and finally the collection checks. Errors are
+  reported from `execute()`: a server error of one of the preamble
+  statements is thrown after the preceding statements have delivered
+  their replies, and replies of the statements that follow the failed
+  one are discarded.
+
+  Objects of this class are created by `Session::bootstrap()`.
+
+  @ingroup devapi
+*/
+
+class PUBLIC_API SessionBootstrap
+{
+public:
+
+  SessionBootstrap(SessionBootstrap &&other) = default;
+
+  // Note: a bootstrap builder can not be copied.
+
+  SessionBootstrap(const SessionBootstrap&) = delete;
+  SessionBootstrap& operator=(const SessionBootstrap&) = delete;
+
+
+  /// Select the given schema as the current schema of the session.
+
+  SessionBootstrap& schema(const string &name)
+  {
+    m_schema = name;
+    return *this;
+  }
+
+  /**
+    Set a session system variable to the given value.
+
+    The value is bound as a statement parameter, so string values need
+    no quoting.
+  */
+
+  SessionBootstrap& variable(const string &name, Value val)
+  {
+    m_vars.emplace_back(std::string(name), std::move(val));
+    return *this;
+  }
+
+  /// Add an arbitrary SQL statement to the preamble.
+
+  SessionBootstrap& sql(const string &stmt)
+  {
+    m_stmts.emplace_back(stmt);
+    return *this;
+  }
+
+  /**
+    Check that the given collection exists in the given schema.
+
+    The check travels in the same batch as the rest of the preamble;
+    `execute()` throws an error if the collection does not exist.
+  */
+
+  SessionBootstrap& checkCollection(const string &schema, const string &name)
+  {
+    m_checks.emplace_back(std::string(schema), std::string(name));
+    return *this;
+  }
+
+  /**
+    Execute the declared preamble as one pipelined batch.
+
+    All commands are sent to the server with a single write and their
+    replies are examined afterwards, in the order in which the preamble
+    was declared. The builder can not be used after it was executed.
+  */
+
+  void execute();
+
+private:
+
+  using Session_impl = internal::Shared_session_impl;
+
+  DLL_WARNINGS_PUSH
+
+  Session_impl m_impl;
+  std::string  m_schema;
+  std::list<std::pair<std::string, Value>> m_vars;
+  std::list<std::string> m_stmts;
+  std::list<std::pair<std::string, std::string>> m_checks;
+
+  DLL_WARNINGS_POP
+
+  SessionBootstrap(const Session_impl &impl)
+    : m_impl(impl)
+  {}
+
+  friend Session;
+};
+
+
 /**
   Represents a session which gives access to data stored in a data store.
 
@@ -1840,16 +2075,120 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Return a builder for executing this session's initialization preamble
+    in one round trip.
+
+    Declare the preamble on the returned builder and call its `execute()`
+    method - all declared commands are then sent to the server as one
+    pipelined batch (see `SessionBootstrap`).
+  */
+
+  SessionBootstrap bootstrap()
+  {
+    try {
+      return SessionBootstrap(m_impl);
+    }
+    CATCH_AND_WRAP
+  }
+
+
+  /**
+    Create another logical session sharing this session's physical
+    connection.
+
+    Logical sessions let independent components of an application hold
+    their own session handle without each one costing a TCP/TLS
+    connection and a server-side thread. The X Protocol has no
+    frame-level interleaving, so statements of all logical sessions are
+    serialized on the shared connection in the order they are executed;
+    a result still being read when a sibling session executes a
+    statement is buffered first, exactly as when the same session
+    executes another statement.
+
+    Server-side session state - current schema, session variables, an
+    open transaction - belongs to the shared connection and is seen by
+    all logical sessions, so they are best suited for autocommit
+    statement traffic. Like `Session` itself, logical sessions are not
+    thread-safe: all sessions sharing one connection must be used from
+    one thread at a time.
+
+    The connection is released only when the last logical session
+    sharing it is closed.
+  */
+
+  Session multiplex()
+  {
+    try {
+      return Session(m_impl);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Return the GTID set executed on the server of this session.
+
+    The returned value can be used as a read-your-writes token: after
+    writing through this session, pass it to
+    `waitForExecutedGtidSet()` on a session connected to a replica
+    (or to `Client::getSession()` which takes a GTID set) to make sure
+    statements on that session see the writes. Querying the token costs
+    one round trip; the waits themselves are pipelined and cost none.
+
+    Returns an empty string when the server does not use GTIDs.
+  */
+
+  string getExecutedGtidSet()
+  {
+    try {
+      return sql("SELECT @@global.gtid_executed")
+             .execute().fetchOne()[0].get<string>();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Require that the server of this session has applied the given GTID
+    set before executing the statements that follow.
+
+    The wait is pipelined: the command travels to the server in the same
+    network round trip as the next statement executed on this session, and
+    the server starts that statement only after the GTIDs were applied, so
+    reads routed to a replica see the writes the GTID set describes.
+
+    A `timeout_sec` of 0 waits without limit. With a non-zero timeout an
+    expired wait does not fail the following statements - the server stops
+    waiting and executes them against the possibly stale data. Errors of
+    the wait command itself (such as a malformed GTID set) are reported at
+    the next transaction boundary on this session.
+  */
+
+  Session& waitForExecutedGtidSet(const string &gtids, unsigned timeout_sec = 0)
+  {
+    try {
+      Session_detail::wait_executed_gtids(gtids, timeout_sec);
+      return *this;
+    }
+    CATCH_AND_WRAP
+  }
+
   /**
     Start a new transaction.
 
     Throws error if previously opened transaction is not closed.
+
+    In batch mode the command is sent to the server without waiting for
+    its reply, so that it travels in the same network round-trip as the
+    first statement of the transaction. The `commit()` which ends such a
+    transaction is likewise not waited for. Server errors reported for
+    these commands are thrown at the next transaction boundary on this
+    session.
   */
 
-  void startTransaction()
+  void startTransaction(bool batch = false)
   {
     try {
-      Session_detail::start_transaction();
+      Session_detail::start_transaction(batch);
     }
     CATCH_AND_WRAP
   }
@@ -1885,6 +2224,65 @@ public:
     CATCH_AND_WRAP
   }
 
+  /**
+    Execute a function as a transaction, retrying it on lock conflicts.
+
+    A transaction is started, `body` is invoked and the transaction is
+    committed. If the server reports a deadlock or a lock wait timeout,
+    the transaction is rolled back and the whole sequence is executed
+    again, with an exponentially growing delay before each new attempt,
+    for up to `attempts` executions in total. Statements executed by
+    `body` re-use their server-side prepared statements on a retry, so
+    repeating the transaction does not repeat parsing or preparation.
+
+    Any other error, and a lock conflict in the final attempt, rolls the
+    transaction back and is re-thrown.
+
+    @note `body` can be executed several times and so it should not have
+    side effects outside of the transaction.
+  */
+
+  template <class Body>
+  void runTransaction(Body &&body, unsigned attempts = 3)
+  {
+    const unsigned ER_LOCK_WAIT_TIMEOUT = 1205;
+    const unsigned ER_LOCK_DEADLOCK = 1213;
+
+    unsigned delay_ms = 10;
+
+    for (;;)
+    {
+      try {
+        startTransaction();
+        body();
+        commit();
+        return;
+      }
+      catch (const Error &err)
+      {
+        try { rollback(); } catch (...) {}
+
+        if (
+          (ER_LOCK_DEADLOCK != err.getCode()
+           && ER_LOCK_WAIT_TIMEOUT != err.getCode())
+          || attempts <= 1
+        )
+          throw;
+      }
+      catch (...)
+      {
+        // Exceptions thrown by `body` are propagated to the caller.
+
+        try { rollback(); } catch (...) {}
+        throw;
+      }
+
+      --attempts;
+      std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+      delay_ms *= 2;
+    }
+  }
+
   /**
     Roll back opened transaction to specified savepoint.
 
@@ -1968,6 +2366,79 @@ public:
   }
 
 
+  /**
+    Get aggregate counters describing protocol traffic of this session.
+
+    Counters accumulate since the session was created (@see SessionStats).
+  */
+
+  SessionStats getStats()
+  {
+    try {
+      return Session_detail::get_stats();
+    }
+    CATCH_AND_WRAP
+  }
+
+
+  /**
+    Subscribe to global notices pushed by the server.
+
+    The handler is called with the notice type (see X Protocol
+    `Mysqlx.Notice.Frame`) and the raw notice payload of every notice
+    with global scope that the server sends on this session, including
+    types the connector itself does not interpret, such as group
+    replication state changes. This allows reacting to server-side
+    events - for example invalidating client-side caches - without
+    polling.
+
+    The handler runs on the thread which is reading a server reply at
+    the time the notice arrives: the connector reads from the connection
+    only while a statement is executing or a result is being fetched, so
+    a notice sent while the session is idle is delivered at the start of
+    the next interaction with the server. The handler must not throw and
+    must not execute statements on this session.
+
+    Passing an empty function removes the subscription.
+  */
+
+  void setNoticeHandler(std::function<void(unsigned, bytes)> handler)
+  {
+    try {
+      Session_detail::set_notice_handler(std::move(handler));
+    }
+    CATCH_AND_WRAP
+  }
+
+
+  /**
+    Re-establish on this session the session state of another session.
+
+    Each session records the SQL statements which mutate session state -
+    `SET` and `USE` statements executed through sql() without bound
+    parameters - together with its current schema. When `other` dies
+    mid-use, calling this method on a freshly created session replays
+    that record here, so that the new session is equivalent to the lost
+    one without the application re-issuing its setup sequence.
+
+    The whole record is sent without waiting for replies, so it reaches
+    the server in the same network round-trip as the next statement
+    executed on this session. Server errors from replayed statements are
+    reported at the next transaction boundary.
+
+    Throws an error if `other` executed more state-mutating statements
+    than the record can hold.
+  */
+
+  void restoreStateFrom(const Session &other)
+  {
+    try {
+      Session_detail::restore_state(other);
+    }
+    CATCH_AND_WRAP
+  }
+
+
   /**
     Close this session.
 
@@ -1983,6 +2454,17 @@ public:
     CATCH_AND_WRAP
   }
 
+private:
+
+  /*
+    Create a logical session sharing the implementation of an existing
+    one (see multiplex()).
+  */
+
+  Session(internal::Shared_session_impl impl)
+    : internal::Session_detail(std::move(impl))
+  {}
+
 protected:
 
   using internal::Session_detail::m_impl;
@@ -2066,6 +2548,104 @@ public:
     return *this;
   }
 
+  /**
+    Get a session whose server has applied the given GTID set.
+
+    The session is taken from the pool as with `getSession()` and a wait
+    for the GTIDs is pipelined on it: the wait command travels to the
+    server in the same round trip as the first statement executed on the
+    session and that statement runs only after the GTIDs were applied.
+    Use this for read-your-writes when reads are routed to replicas,
+    passing the GTID set obtained with `Session::getExecutedGtidSet()`
+    from the session which did the write.
+  */
+
+  Session getSession(const string &gtid_set, unsigned timeout_sec = 0);
+
+  /**
+    Change the maximum number of sessions in this client's pool.
+
+    Growing the pool takes effect immediately: threads waiting for a free
+    session are woken up. Shrinking evicts surplus idle sessions right
+    away while sessions currently in use keep working - the pool shrinks
+    further as they are released.
+  */
+
+  void resizePool(size_t max)
+  {
+    try {
+      Client_detail::resize_pool(max);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Stop handing out sessions while keeping the pool warm.
+
+    After this call getSession() throws until resumePool() is called.
+    Sessions currently in use continue to work and return to the pool as
+    usual, so resuming does not cold-start new connections.
+  */
+
+  void drainPool()
+  {
+    try {
+      Client_detail::drain_pool();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /// Start handing out sessions again after drainPool().
+
+  void resumePool()
+  {
+    try {
+      Client_detail::resume_pool();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Get runtime statistics of this client's session pool.
+
+    Returns a snapshot of pool counters such as the current pool size,
+    the number of idle sessions and the total time spent waiting for
+    a free session (@see ClientStats). Taking the snapshot is cheap and
+    does not block sessions being acquired or released.
+  */
+
+  ClientStats getStats()
+  {
+    try {
+      return Client_detail::get_stats();
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Release memory held by the client-side caches.
+
+    Signals memory pressure to this client: the client-wide statement
+    caches are dropped right away and every session of the client drops
+    its own caches (cached find results, document caches, parsed
+    expressions, interned names, result meta-data) at its next
+    statement boundary. The caches stay enabled and refill on use, so
+    only warm-up cost is lost. Server-side prepared statements are not
+    affected.
+
+    The same shrinking happens automatically, bulky result caches
+    first, when the aggregate cache footprint of the client exceeds the
+    budget set with the `ClientOption::MAX_CACHE_BYTES` option.
+  */
+
+  void shrinkCaches()
+  {
+    try {
+      Client_detail::shrink_caches();
+    }
+    CATCH_AND_WRAP
+  }
+
 };
 
 
@@ -2079,6 +2659,18 @@ try
   : internal::Session_detail(client.get_session_pool())
 {}CATCH_AND_WRAP
 
+
+inline
+Session Client::getSession(const string &gtid_set, unsigned timeout_sec)
+{
+  try {
+    Session sess(*this);
+    sess.waitForExecutedGtidSet(gtid_set, timeout_sec);
+    return sess;
+  }
+  CATCH_AND_WRAP
+}
+
 /**
   @ingroup devapi
   Function to get Session object.
@@ -2104,6 +2696,381 @@ Client getClient(P...p)
 }
 
 
+/*
+  Weighted fair statement scheduler
+*/
+
+class StatementScheduler;
+
+namespace internal {
+
+/*
+  A statement queued in a `StatementScheduler`. It moves through the
+  states queued -> submitted -> consumed; between submission and the
+  arrival of its complete reply its wire size counts against the
+  scheduler's bytes-in-flight limit.
+*/
+
+struct Sched_entry
+{
+  std::unique_ptr<common::Executable_if>  impl;
+  uint64_t  bytes = 0;        // wire size, measured at submission
+  bool      submitted = false;
+  bool      counted = false;  // counts against the in-flight limit
+  std::list<Sched_entry>::iterator  pos;
+};
+
+}  // internal
+
+
+/**
+  Handle for the result of a statement queued in a `StatementScheduler`.
+
+  Like `PendingResult`, but the statement might not have been sent to
+  the server yet - `get()` first drives the scheduler until it is. The
+  scheduler must stay alive until the handle is consumed or destroyed;
+  destroying an unconsumed handle leaves the statement in the scheduler,
+  which still submits it and discards its result.
+*/
+
+template <class Res>
+class ScheduledResult
+{
+public:
+
+  ScheduledResult(ScheduledResult &&other)
+  {
+    operator=(std::move(other));
+  }
+
+  ScheduledResult& operator=(ScheduledResult &&other)
+  {
+    m_sched = other.m_sched;
+    m_entry = other.m_entry;
+    other.m_entry = nullptr;
+    return *this;
+  }
+
+  // Note: a scheduled result can not be copied.
+
+  ScheduledResult(const ScheduledResult&) = delete;
+  ScheduledResult& operator=(const ScheduledResult&) = delete;
+
+  /// Check whether the result is ready, without blocking.
+
+  bool isReady();
+
+  /**
+    Return the result of the statement, first submitting it (and queued
+    statements scheduled before it) if it has not been sent yet.
+  */
+
+  Res get();
+
+private:
+
+  ScheduledResult(StatementScheduler *sched, internal::Sched_entry *entry)
+    : m_sched(sched), m_entry(entry)
+  {}
+
+  StatementScheduler     *m_sched = nullptr;
+  internal::Sched_entry  *m_entry = nullptr;
+
+  friend StatementScheduler;
+};
+
+
+/**
+  Admission control for statements submitted over a shared session.
+
+  When one session multiplexes several logical streams - say a bulk
+  insert feed and latency-sensitive point reads - submitting statements
+  in arrival order lets the bulk stream monopolize the connection. The
+  scheduler queues statements per producer and submits them in weighted
+  round-robin order: each round a producer with weight `w` may send up
+  to `w` statements before the next producer gets its turn.
+
+  An optional bytes-in-flight limit bounds the amount of statement data
+  sent but not yet acknowledged by a complete server reply, so a queued
+  bulk statement can not fill the send path arbitrarily far ahead of an
+  interleaved read. The size of a statement is measured when it is
+  submitted; the limit never blocks when nothing is in flight, so it can
+  not deadlock regardless of its value.
+
+  Statements are queued with `enqueue()`, which copies the statement
+  like `Executable::executeAsync()` does, and are sent by `drive()` or,
+  lazily, by the returned `ScheduledResult` handles. Results should be
+  collected in submission order, as with `executeAll()`. The scheduler
+  is not thread-safe - like the session it feeds, it is meant to be
+  driven by one thread which multiplexes the streams.
+
+  Example:
+  ~~~~~~
+    StatementScheduler sched(sess, 256*1024);
+
+    auto bulk = sched.addProducer(1);
+    auto oltp = sched.addProducer(8);
+
+    auto ins  = sched.enqueue(bulk, tbl.insert().values(...));
+    auto find = sched.enqueue(oltp, coll.find("..."));
+
+    DocResult docs = find.get();  // not starved by the insert feed
+    Result    res  = ins.get();
+  ~~~~~~
+*/
+
+class StatementScheduler
+{
+public:
+
+  /**
+    Create a scheduler submitting statements over the given session.
+
+    `bytes_in_flight_limit` bounds the statement bytes sent but not yet
+    acknowledged; 0 means no limit. The limit is checked before each
+    submission, so it can be exceeded by at most the size of one
+    statement. The session must stay alive as long as the scheduler.
+  */
+
+  StatementScheduler(Session &sess, uint64_t bytes_in_flight_limit = 0)
+    : m_sess(&sess), m_limit(bytes_in_flight_limit)
+  {}
+
+  // Note: a scheduler can not be copied.
+
+  StatementScheduler(const StatementScheduler&) = delete;
+  StatementScheduler& operator=(const StatementScheduler&) = delete;
+
+  /**
+    Register a logical stream of statements and return its handle.
+
+    Each scheduling round a producer may submit up to `weight` queued
+    statements, so relative weights determine the share of the session
+    each stream gets under contention.
+  */
+
+  size_t addProducer(unsigned weight = 1)
+  {
+    try {
+      if (0 == weight)
+        throw Error("Producer weight must be positive");
+      m_producers.push_back(Producer());
+      m_producers.back().weight = weight;
+      return m_producers.size() - 1;
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Queue a statement on behalf of the given producer.
+
+    The statement is copied, like by `Executable::executeAsync()`, so it
+    remains valid and can be modified or executed again. It is not sent
+    yet - submission happens in scheduling order, from `drive()` or from
+    a `ScheduledResult` method.
+  */
+
+  template <class Res, class Op>
+  ScheduledResult<Res> enqueue(size_t producer, const Executable<Res, Op> &stmt)
+  {
+    try {
+      if (producer >= m_producers.size())
+        throw Error("Invalid producer handle");
+      if (!stmt.m_impl)
+        throw Error("Attempt to use invalid operation");
+
+      m_entries.emplace_back();
+      internal::Sched_entry &entry = m_entries.back();
+      entry.pos = std::prev(m_entries.end());
+      entry.impl.reset(stmt.m_impl->clone());
+      m_producers[producer].m_queue.push_back(&entry);
+
+      return ScheduledResult<Res>(this, &entry);
+    }
+    CATCH_AND_WRAP
+  }
+
+  /**
+    Submit as many queued statements as the weights and the in-flight
+    limit allow, without blocking.
+  */
+
+  void drive()
+  {
+    try {
+      do_drive();
+    }
+    CATCH_AND_WRAP
+  }
+
+private:
+
+  struct Producer
+  {
+    unsigned  weight = 1;
+    std::deque<internal::Sched_entry*>  m_queue;
+  };
+
+  Session  *m_sess;
+  uint64_t  m_limit;
+  uint64_t  m_in_flight = 0;
+
+  std::list<internal::Sched_entry>  m_entries;
+  std::vector<Producer>             m_producers;
+
+  bool over_limit() const
+  {
+    return 0 != m_limit && m_in_flight >= m_limit;
+  }
+
+  /*
+    Stop counting submitted statements whose complete reply has arrived
+    against the in-flight limit. Polling the replies also drives the
+    protocol, so repeated calls make progress while waiting.
+  */
+
+  void release_completed()
+  {
+    for (auto &entry : m_entries)
+    {
+      if (!entry.counted || !entry.submitted)
+        continue;
+
+      if (entry.impl->is_ready())
+      {
+        entry.counted = false;
+        m_in_flight -= entry.bytes;
+      }
+    }
+  }
+
+  /*
+    Send a statement, measuring its wire size as the growth of the
+    session's sent-bytes counter.
+  */
+
+  void submit(internal::Sched_entry &entry)
+  {
+    uint64_t before = m_sess->getStats().bytes_sent;
+
+    entry.impl->submit();
+
+    entry.bytes = m_sess->getStats().bytes_sent - before;
+    entry.submitted = true;
+    entry.counted = true;
+    m_in_flight += entry.bytes;
+  }
+
+  /*
+    Weighted round-robin submission: visit producers in turn, letting
+    each send up to `weight` statements per round, until all queues are
+    empty or the in-flight limit is reached.
+  */
+
+  void do_drive()
+  {
+    release_completed();
+
+    bool progress = true;
+
+    while (progress)
+    {
+      progress = false;
+
+      for (auto &prod : m_producers)
+      {
+        for (unsigned n = 0; n < prod.weight && !prod.m_queue.empty(); ++n)
+        {
+          if (over_limit())
+          {
+            release_completed();
+            if (over_limit())
+              return;
+          }
+
+          submit(*prod.m_queue.front());
+          prod.m_queue.pop_front();
+          progress = true;
+        }
+      }
+    }
+  }
+
+  /*
+    Drive submission until the given statement has been sent. If the
+    in-flight limit blocks it, poll outstanding replies until capacity
+    is freed - the limit never blocks when nothing is in flight, so
+    there is always a reply to wait for.
+  */
+
+  void drive_until(internal::Sched_entry *entry)
+  {
+    while (!entry->submitted)
+    {
+      do_drive();
+
+      if (!entry->submitted)
+      {
+        release_completed();
+        if (over_limit())
+          std::this_thread::yield();
+      }
+    }
+  }
+
+  void consume(internal::Sched_entry *entry)
+  {
+    if (entry->counted)
+      m_in_flight -= entry->bytes;
+    m_entries.erase(entry->pos);
+  }
+
+  template <class R>
+  friend class ScheduledResult;
+};
+
+
+template <class Res>
+inline
+bool ScheduledResult<Res>::isReady()
+{
+  try {
+    if (!m_entry)
+      throw Error("Result of scheduled operation was already consumed");
+
+    if (!m_entry->submitted)
+    {
+      m_sched->drive();
+      if (!m_entry->submitted)
+        return false;
+    }
+
+    return m_entry->impl->is_ready();
+  }
+  CATCH_AND_WRAP
+}
+
+
+template <class Res>
+inline
+Res ScheduledResult<Res>::get()
+{
+  try {
+    if (!m_entry)
+      throw Error("Result of scheduled operation was already consumed");
+
+    m_sched->drive_until(m_entry);
+
+    Res res(m_entry->impl->wait_execute());
+    m_sched->consume(m_entry);
+    m_entry = nullptr;
+
+    return res;
+  }
+  CATCH_AND_WRAP
+}
+
+
 /*
    Schema class implementation
 */
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Connect-path benchmark.
+
+  Breaks the session setup time into its phases - transport connect,
+  TLS handshake, capability negotiation and authentication - using the
+  per-phase timings reported by Session::getStats(), and prints the
+  average of each phase over a number of connects. This complements the
+  single "connect" number of connector_bench when investigating where
+  connect time is spent.
+
+  The server is located the same way as for the other benchmarks: the
+  xplugin port must be set with the XPLUGIN_PORT environment variable,
+  and XPLUGIN_HOST, XPLUGIN_USER and XPLUGIN_PASSWORD can override the
+  defaults (localhost, root, no password).
+
+  Per-phase budgets can be asserted by setting any of the environment
+  variables
+
+    BUDGET_TCP_USEC, BUDGET_TLS_USEC, BUDGET_CAPS_USEC, BUDGET_AUTH_USEC
+
+  to a limit in microseconds; the program exits with an error when the
+  average of the corresponding phase exceeds its budget. Run against the
+  ngs_mockup server (cdk/extra/ngs_mockup) this turns the benchmark into
+  a regression check on connector-side connect overhead, with server
+  processing time out of the picture. The mockup speaks neither TLS nor
+  compression, so connects to it must disable both, e.g.:
+
+    ngs_mockup 33060 &
+    XPLUGIN_PORT=33060 BUDGET_CAPS_USEC=1000 \
+      ./connect_bench "ssl-mode=DISABLED&compression=DISABLED"
+
+  An optional first argument is appended to the connection string as
+  shown above.
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+#include <mysqlx/xdevapi.h>
+
+using namespace mysqlx;
+
+
+const unsigned CONNECT_OPS = 50;
+
+
+/*
+  Average of one connect phase over all runs, checked against the budget
+  from the given environment variable (no check if it is not set).
+*/
+
+struct Phase
+{
+  const char *m_name;
+  const char *m_budget_var;
+  uint64_t    m_total_usec = 0;
+
+  Phase(const char *name, const char *budget_var)
+    : m_name(name), m_budget_var(budget_var)
+  {}
+
+  // Returns false if the phase average exceeds its budget.
+
+  bool report()
+  {
+    uint64_t avg = m_total_usec / CONNECT_OPS;
+
+    std::cout
+      << std::left << std::setw(8) << m_name << std::right
+      << std::setw(9) << avg << " usec avg";
+
+    const char *budget = getenv(m_budget_var);
+
+    if (!budget || !atoi(budget))
+    {
+      std::cout << std::endl;
+      return true;
+    }
+
+    bool ok = avg <= (uint64_t)atoi(budget);
+
+    std::cout << "   (budget " << budget << " usec: "
+              << (ok ? "OK" : "EXCEEDED") << ")" << std::endl;
+    return ok;
+  }
+};
+
+
+int main(int argc, char *argv[])
+{
+  const char *port = getenv("XPLUGIN_PORT");
+
+  if (!port || !atoi(port))
+  {
+    std::cout << "XPLUGIN_PORT not set - skipping benchmarks" << std::endl;
+    return 0;
+  }
+
+  const char *host = getenv("XPLUGIN_HOST");
+  const char *user = getenv("XPLUGIN_USER");
+  const char *pwd  = getenv("XPLUGIN_PASSWORD");
+
+  std::ostringstream uri_os;
+  uri_os << "mysqlx://" << (user && *user ? user : "root");
+  if (pwd && *pwd)
+    uri_os << ":" << pwd;
+  uri_os << "@" << (host && *host ? host : "localhost") << ":" << port;
+  if (argc > 1)
+    uri_os << "/?" << argv[1];
+  std::string uri = uri_os.str();
+
+  Phase phases[] = {
+    { "tcp",  "BUDGET_TCP_USEC"  },
+    { "tls",  "BUDGET_TLS_USEC"  },
+    { "caps", "BUDGET_CAPS_USEC" },
+    { "auth", "BUDGET_AUTH_USEC" },
+  };
+
+  try {
+
+    for (unsigned i = 0; i < CONNECT_OPS; ++i)
+    {
+      Session sess(uri);
+      auto stats = sess.getStats();
+
+      phases[0].m_total_usec += stats.connect_tcp_usec;
+      phases[1].m_total_usec += stats.connect_tls_usec;
+      phases[2].m_total_usec += stats.connect_caps_usec;
+      phases[3].m_total_usec += stats.connect_auth_usec;
+
+      sess.close();
+    }
+
+    std::cout << "connect phases, average over "
+              << CONNECT_OPS << " connects:" << std::endl;
+
+    bool ok = true;
+
+    for (Phase &phase : phases)
+      ok = phase.report() && ok;
+
+    if (!ok)
+    {
+      std::cerr << "ERROR: phase budget exceeded" << std::endl;
+      return 1;
+    }
+  }
+  catch (const Error &err)
+  {
+    std::cerr << "ERROR: " << err << std::endl;
+    return 1;
+  }
+  catch (const std::exception &ex)
+  {
+    std::cerr << "ERROR: " << ex.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  End-to-end benchmarks for the connector: connect time, session pool
+  checkout rate, point select latency, large result throughput and
+  document add rate.
+
+  This is not a correctness test and it is not run as part of the test
+  suite. Build the connector_bench target and run it manually against a
+  live server to compare connector performance between revisions. The
+  server is located the same way as for the unit tests: the xplugin port
+  must be set with the XPLUGIN_PORT environment variable, and
+  XPLUGIN_HOST, XPLUGIN_USER and XPLUGIN_PASSWORD can override the
+  defaults (localhost, root, no password).
+
+  Each benchmark reports operations per second, heap allocations per
+  operation (via operator new interposition, so that allocation
+  regressions are visible even when timings are noisy) and, where a
+  session is involved, network bytes per operation taken from the session
+  traffic counters (see Session::getStats()).
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include <mysqlx/xdevapi.h>
+
+using namespace mysqlx;
+
+
+/*
+  Count heap allocations made while benchmarks run. Only the number of
+  allocations is tracked. The counter is atomic because the connector
+  can allocate from background threads (pool maintenance, fetch-ahead).
+*/
+
+static std::atomic<uint64_t> alloc_count(0);
+
+void* operator new(size_t size)
+{
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = malloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = malloc(size))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+
+/*
+  Measurement helpers.
+
+  A Bench instance brackets the measured loop: it snapshots the clock,
+  the allocation counter and (optionally) the session traffic counters,
+  and report() prints one result line.
+*/
+
+using clk = std::chrono::steady_clock;
+
+struct Bench
+{
+  const char *m_name;
+  Session    *m_sess;       // session whose traffic is counted, can be null
+  uint64_t    m_bytes_before = 0;
+  uint64_t    m_allocs_before;
+  clk::time_point m_start;
+
+  Bench(const char *name, Session *sess = nullptr)
+    : m_name(name), m_sess(sess)
+  {
+    if (m_sess)
+    {
+      auto stats = m_sess->getStats();
+      m_bytes_before = stats.bytes_sent + stats.bytes_received;
+    }
+    m_allocs_before = alloc_count.load();
+    m_start = clk::now();
+  }
+
+  void report(uint64_t ops)
+  {
+    using namespace std::chrono;
+
+    double secs = duration_cast<duration<double>>(clk::now() - m_start).count();
+    uint64_t allocs = alloc_count.load() - m_allocs_before;
+
+    std::cout
+      << std::left << std::setw(22) << m_name << std::right
+      << std::setw(9) << ops << " ops"
+      << std::setw(12) << std::fixed << std::setprecision(0)
+      << (secs > 0 ? ops / secs : 0) << " ops/s"
+      << std::setw(9) << (ops ? allocs / ops : 0) << " allocs/op";
+
+    if (m_sess)
+    {
+      auto stats = m_sess->getStats();
+      uint64_t bytes = stats.bytes_sent + stats.bytes_received - m_bytes_before;
+      std::cout << std::setw(9) << (ops ? bytes / ops : 0) << " bytes/op";
+    }
+
+    std::cout << std::endl;
+  }
+};
+
+
+/*
+  Benchmark scenarios. Sizes are chosen so that a full run takes seconds,
+  not minutes, while each loop still runs long enough to average out
+  per-operation noise.
+*/
+
+const unsigned CONNECT_OPS = 50;
+const unsigned POOL_OPS = 2000;
+const unsigned SELECT_OPS = 1000;
+const unsigned ADD_OPS = 1000;
+const unsigned RESULT_ROWS = 50000;
+
+const char *SCHEMA_NAME = "concpp_bench";
+
+
+void bench_connect(const std::string &uri)
+{
+  Bench b("connect");
+
+  for (unsigned i = 0; i < CONNECT_OPS; ++i)
+  {
+    Session sess(uri);
+    sess.close();
+  }
+
+  b.report(CONNECT_OPS);
+}
+
+
+void bench_pool(const std::string &uri)
+{
+  Client client(uri);
+
+  // Warm up the pool so that checkouts re-use a pooled session.
+  client.getSession().close();
+
+  Bench b("pool checkout");
+
+  for (unsigned i = 0; i < POOL_OPS; ++i)
+    client.getSession().close();
+
+  b.report(POOL_OPS);
+
+  client.close();
+}
+
+
+void bench_point_select(Session &sess, Table &tbl)
+{
+  // Warm up so that the statement gets server-side prepared.
+
+  auto select = tbl.select("v").where("id = :id");
+  select.bind("id", 0).execute().fetchOne();
+  select.bind("id", 1).execute().fetchOne();
+
+  Bench b("point select", &sess);
+
+  for (unsigned i = 0; i < SELECT_OPS; ++i)
+  {
+    Row row = select.bind("id", (int)(i % RESULT_ROWS)).execute().fetchOne();
+    if (row.isNull())
+      throw std::runtime_error("point select returned no row");
+  }
+
+  b.report(SELECT_OPS);
+}
+
+
+void bench_large_result(Session &sess, Table &tbl)
+{
+  Bench b("large result", &sess);
+
+  uint64_t rows = 0;
+  RowResult res = tbl.select("id", "v").execute();
+
+  for (Row row = res.fetchOne(); !row.isNull(); row = res.fetchOne())
+  {
+    // Touch a field so that decoding is included in the measurement.
+    if (row[0].isNull())
+      throw std::runtime_error("unexpected NULL in result");
+    ++rows;
+  }
+
+  if (rows != RESULT_ROWS)
+    throw std::runtime_error("large result returned wrong row count");
+
+  b.report(rows);
+}
+
+
+void bench_doc_add(Session &sess, Collection &coll)
+{
+  Bench b("document add", &sess);
+
+  for (unsigned i = 0; i < ADD_OPS; ++i)
+  {
+    std::ostringstream doc;
+    doc << R"({ "seq": )" << i
+        << R"(, "name": "item-)" << i
+        << R"(", "tags": [ "bench", "run" ] })";
+    coll.add(doc.str()).execute();
+  }
+
+  b.report(ADD_OPS);
+}
+
+
+/*
+  Create the schema used by the benchmarks: a table with RESULT_ROWS rows
+  of roughly 100 bytes each and an empty collection.
+*/
+
+void setup(Session &sess)
+{
+  sess.dropSchema(SCHEMA_NAME);
+  Schema sch = sess.createSchema(SCHEMA_NAME);
+
+  sess.sql(
+    std::string("CREATE TABLE ") + SCHEMA_NAME +
+    ".t (id INT PRIMARY KEY, v VARCHAR(100))"
+  ).execute();
+
+  sch.createCollection("c");
+
+  std::cout << "Populating " << RESULT_ROWS << " rows..." << std::endl;
+
+  // Note: multi-row inserts keep the setup phase short.
+
+  Table tbl = sch.getTable("t");
+  auto insert = tbl.insert("id", "v");
+
+  for (unsigned i = 0; i < RESULT_ROWS; ++i)
+  {
+    insert.values((int)i, std::string(90, 'x'));
+    if (0 == (i + 1) % 1000)
+    {
+      insert.execute();
+      insert = tbl.insert("id", "v");
+    }
+  }
+
+  insert.execute();
+}
+
+
+int main()
+{
+  const char *port = getenv("XPLUGIN_PORT");
+
+  if (!port || !atoi(port))
+  {
+    std::cout << "XPLUGIN_PORT not set - skipping benchmarks" << std::endl;
+    return 0;
+  }
+
+  const char *host = getenv("XPLUGIN_HOST");
+  const char *user = getenv("XPLUGIN_USER");
+  const char *pwd  = getenv("XPLUGIN_PASSWORD");
+
+  std::ostringstream uri_os;
+  uri_os << "mysqlx://" << (user && *user ? user : "root");
+  if (pwd && *pwd)
+    uri_os << ":" << pwd;
+  uri_os << "@" << (host && *host ? host : "localhost") << ":" << port;
+  std::string uri = uri_os.str();
+
+  try {
+
+    Session sess(uri);
+    setup(sess);
+
+    Schema sch = sess.getSchema(SCHEMA_NAME);
+    Table tbl = sch.getTable("t");
+    Collection coll = sch.getCollection("c");
+
+    std::cout << std::endl;
+
+    bench_connect(uri);
+    bench_pool(uri);
+    bench_point_select(sess, tbl);
+    bench_large_result(sess, tbl);
+    bench_doc_add(sess, coll);
+
+    sess.dropSchema(SCHEMA_NAME);
+  }
+  catch (const Error &err)
+  {
+    std::cerr << "ERROR: " << err << std::endl;
+    return 1;
+  }
+  catch (const std::exception &ex)
+  {
+    std::cerr << "ERROR: " << ex.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
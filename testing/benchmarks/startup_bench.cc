@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2022, Oracle and/or its affiliates.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0, as
+ * published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms,
+ * as designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an
+ * additional permission to link the program and your derivative works
+ * with the separately licensed software that they have included with
+ * MySQL.
+ *
+ * Without limiting anything contained in the foregoing, this file,
+ * which is part of MySQL Connector/C++, is also subject to the
+ * Universal FOSS Exception, version 1.0, a copy of which can be found at
+ * http://oss.oracle.com/licenses/universal-foss-exception.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+ */
+
+/*
+  Library startup benchmark.
+
+  Measures the time spent in dlopen() of the connector shared library -
+  that is, the cost of its static initializers and relocations - and,
+  when a connection string is given, the time from loading the library
+  to the first established session. Short-lived processes pay these
+  costs on every run, so they are tracked here as a benchmark of their
+  own, separate from the steady-state benchmarks in connector_bench.
+
+  The program is deliberately not linked against the connector: the
+  library is loaded through dlopen() and the session entry points are
+  resolved with dlsym() (the XAPI ones, as these have plain C linkage).
+
+  Usage:
+
+    startup_bench <path-to-libmysqlcppconn8.so> [<connection-string>]
+
+  Note: dlopen() can be measured only once per process - after that the
+  library stays loaded - so for stable numbers run the program several
+  times and compare the distributions.
+*/
+
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+#include <dlfcn.h>
+
+typedef std::chrono::steady_clock clock_type;
+
+static uint64_t usec_since(clock_type::time_point start)
+{
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+    clock_type::now() - start
+  ).count();
+}
+
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr
+      << "usage: " << argv[0]
+      << " <path-to-connector-library> [<connection-string>]" << std::endl;
+    return 1;
+  }
+
+  auto start = clock_type::now();
+
+  void *lib = dlopen(argv[1], RTLD_NOW);
+
+  uint64_t load_usec = usec_since(start);
+
+  if (!lib)
+  {
+    std::cerr << "dlopen failed: " << dlerror() << std::endl;
+    return 1;
+  }
+
+  std::cout << "dlopen: " << load_usec << " usec" << std::endl;
+
+  if (argc < 3)
+    return 0;
+
+  /*
+    First session: resolve the XAPI session entry points and connect.
+    The reported time includes any initialization the connector deferred
+    from load time to first use.
+  */
+
+  typedef void* (*get_session_fn)(const char*, void**);
+  typedef void  (*close_session_fn)(void*);
+
+  get_session_fn get_session
+    = (get_session_fn)dlsym(lib, "mysqlx_get_session_from_url");
+  close_session_fn close_session
+    = (close_session_fn)dlsym(lib, "mysqlx_session_close");
+
+  if (!get_session || !close_session)
+  {
+    std::cerr << "could not resolve session entry points: "
+              << dlerror() << std::endl;
+    return 1;
+  }
+
+  void *error = nullptr;
+  void *sess = get_session(argv[2], &error);
+
+  uint64_t first_session_usec = usec_since(start);
+
+  if (!sess)
+  {
+    std::cerr << "could not create session" << std::endl;
+    return 1;
+  }
+
+  close_session(sess);
+
+  std::cout << "dlopen + first session: " << first_session_usec
+            << " usec" << std::endl;
+
+  return 0;
+}
@@ -101,6 +101,22 @@ public:
     if (!data)
       return nullptr;
 
+    /*
+      A fetched row is documented to be valid only until the next fetch,
+      so instead of growing the row set with each call, recycle the
+      previously fetched row structure - its internal buffers are
+      re-used when their capacities suffice, which avoids a pair of
+      same-size allocations per row when draining large results.
+    */
+
+    if (!m_row_set.empty())
+    {
+      mysqlx_row_struct &row = m_row_set.back();
+      row.Mysqlx_diag::clear();
+      row.reset(*data, m_result_mdata.front());
+      return &row;
+    }
+
     m_row_set.emplace_back(*data, m_result_mdata.front());
     return &m_row_set.back();
   }
@@ -113,6 +129,9 @@ public:
 };
 
 
+struct mysqlx_async_struct;
+
+
 struct mysqlx_stmt_struct : public Mysqlx_diag
 {
 private:
@@ -122,6 +141,7 @@ private:
 
   mysqlx_session_struct &m_session;
   cdk::scoped_ptr<mysqlx_result_struct>   m_result;
+  cdk::scoped_ptr<mysqlx_async_struct>    m_async;
 
 public:
 
@@ -165,6 +185,28 @@ public:
     return new_result(m_impl->execute());
   }
 
+  /*
+    Prepare the statement handle for the next execution
+    (see mysqlx_stmt_reset()).
+
+    Discards the previous result and diagnostics and clears parameter
+    binds. The statement specification, its compiled shape and
+    a server-side prepared statement, when one exists, are preserved, so
+    re-executing the handle repeats neither construction nor preparation.
+  */
+
+  void reset();
+
+  /*
+    Start executing the statement without waiting for the server reply
+    and return a handle that can be used to poll for, or wait for, its
+    completion (see mysqlx_execute_async()). The handle is owned by this
+    statement and stays valid until the statement is freed or executed
+    again.
+  */
+
+  mysqlx_async_struct *submit();
+
   int sql_bind(va_list &args);
   int sql_bind(cdk::string s);
 
@@ -204,6 +246,75 @@ public:
 typedef mysqlx_stmt_struct mysqlx_stmt_t;
 
 
+/*
+  Handle for asynchronous statement execution.
+
+  The handle drives the split execution interface of the operation
+  implementation (Executable_if): the statement was submitted when the
+  handle was created, is_ready() advances protocol processing without
+  blocking and wait() completes the execution producing the result.
+*/
+
+struct mysqlx_async_struct
+  : public Mysqlx_diag
+{
+  mysqlx_stmt_struct &m_stmt;
+  mysqlx_result_struct *m_result = nullptr;
+
+  mysqlx_async_struct(mysqlx_stmt_struct &stmt)
+    : m_stmt(stmt)
+  {}
+
+  bool is_ready()
+  {
+    return nullptr != m_result || m_stmt.m_impl->is_ready();
+  }
+
+  /*
+    Complete the execution, blocking if the server reply did not arrive
+    yet. Subsequent calls return the same result handle.
+  */
+
+  mysqlx_result_struct* wait()
+  {
+    if (!m_result)
+      m_result = m_stmt.new_result(m_stmt.m_impl->wait_execute());
+    return m_result;
+  }
+};
+
+
+inline
+mysqlx_async_struct *mysqlx_stmt_struct::submit()
+{
+  Mysqlx_diag::clear();
+  m_impl->submit();
+  m_async.reset(new mysqlx_async_struct(*this));
+  return m_async.get();
+}
+
+
+inline
+void mysqlx_stmt_struct::reset()
+{
+  /*
+    A submitted execution whose reply was not collected yet must be
+    completed first - otherwise its reply would be mistaken for the
+    reply of the next execution.
+  */
+
+  if (m_async)
+    m_async->wait();
+
+  m_async.reset(NULL);
+  m_result.reset(NULL);
+  Mysqlx_diag::clear();
+
+  if (Bind_if *bind = dynamic_cast<Bind_if*>(m_impl.get()))
+    bind->clear_params();
+}
+
+
 /*
   The stmt_traits<> template defines implementation class for different
   CRUD operations identified by mysqlx_op_enum constants.
@@ -365,6 +365,22 @@ int mysqlx_stmt_bind(mysqlx_stmt_struct *stmt, ...)
 }
 
 
+/*
+  Reset a statement handle so that it can be executed again
+  (see mysqlx_stmt_struct::reset()).
+*/
+
+int mysqlx_stmt_reset(mysqlx_stmt_struct *stmt)
+{
+  SAFE_EXCEPTION_BEGIN(stmt, RESULT_ERROR)
+
+  stmt->reset();
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(stmt, RESULT_ERROR)
+}
+
+
 int mysqlx_set_insert_row(mysqlx_stmt_struct *stmt, ...)
 {
   SAFE_EXCEPTION_BEGIN(stmt, RESULT_ERROR)
@@ -628,12 +644,158 @@ mysqlx_result_struct * STDCALL mysqlx_execute(mysqlx_stmt_struct *stmt)
   if (!stmt || !stmt->session_valid() || stmt->get_error())
     return NULL;
 
+  if (stmt->get_session().in_batch())
+    throw Mysqlx_exception(
+      "Synchronous execution is not allowed while a statement batch"
+      " is active; use mysqlx_execute_async()"
+    );
+
   return stmt->exec();
 
   SAFE_EXCEPTION_END(stmt, NULL)
 }
 
 
+/*
+  Statement batching
+  -------------------------------------------------------------------------
+
+  Between mysqlx_batch_begin() and mysqlx_batch_flush() commands of
+  statements started with mysqlx_execute_async() are accumulated in the
+  session pipeline and sent to the server as a single batch when the
+  batch is flushed. Results are obtained per statement, by waiting on
+  the asynchronous execution handles after the flush.
+*/
+
+int STDCALL mysqlx_batch_begin(mysqlx_session_struct *sess)
+{
+  SAFE_EXCEPTION_BEGIN(sess, RESULT_ERROR)
+
+  sess->batch_begin();
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(sess, RESULT_ERROR)
+}
+
+
+int STDCALL mysqlx_batch_flush(mysqlx_session_struct *sess)
+{
+  SAFE_EXCEPTION_BEGIN(sess, RESULT_ERROR)
+
+  sess->batch_flush();
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(sess, RESULT_ERROR)
+}
+
+
+/*
+  Asynchronous statement execution
+  -------------------------------------------------------------------------
+
+  mysqlx_execute_async() sends the statement to the server without
+  waiting for the reply and returns a handle which is polled with
+  mysqlx_async_poll() and completed with mysqlx_async_wait(). The handle
+  is owned by the statement, like result handles are.
+*/
+
+mysqlx_async_struct * STDCALL mysqlx_execute_async(mysqlx_stmt_struct *stmt)
+{
+  SAFE_EXCEPTION_BEGIN(stmt, NULL)
+
+  if (!stmt || !stmt->session_valid() || stmt->get_error())
+    return NULL;
+
+  return stmt->submit();
+
+  SAFE_EXCEPTION_END(stmt, NULL)
+}
+
+
+int STDCALL mysqlx_async_poll(mysqlx_async_struct *handle)
+{
+  SAFE_EXCEPTION_BEGIN(handle, RESULT_ERROR)
+
+  // A statement whose batch was not flushed yet can not complete.
+
+  if (!handle->m_result && handle->m_stmt.get_session().in_batch())
+    return RESULT_PENDING;
+
+  return handle->is_ready() ? RESULT_OK : RESULT_PENDING;
+
+  SAFE_EXCEPTION_END(handle, RESULT_ERROR)
+}
+
+
+mysqlx_result_struct * STDCALL mysqlx_async_wait(mysqlx_async_struct *handle)
+{
+  SAFE_EXCEPTION_BEGIN(handle, NULL)
+
+  if (!handle->m_result && handle->m_stmt.get_session().in_batch())
+    throw Mysqlx_exception(
+      "Cannot wait on a batched statement before the batch is flushed"
+    );
+
+  return handle->wait();
+
+  SAFE_EXCEPTION_END(handle, NULL)
+}
+
+
+int STDCALL mysqlx_async_wait_any(
+  mysqlx_async_struct **handles, size_t count, size_t *pos
+)
+{
+  if (!handles)
+    return RESULT_ERROR;
+
+  size_t valid = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (handles[i])
+      ++valid;
+  }
+
+  if (0 == valid)
+    return RESULT_ERROR;
+
+  /*
+    Note: polling a handle drives the protocol processing of its
+    statement, the same way cdk async operations are driven by cont()
+    inside wait(), so this loop makes progress on all pending
+    statements while waiting.
+  */
+
+  for (;;)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      if (!handles[i])
+        continue;
+
+      try {
+        if (handles[i]->is_ready())
+        {
+          if (pos)
+            *pos = i;
+          return RESULT_OK;
+        }
+      }
+      catch (...)
+      {
+        /*
+          A failed statement is reported as the ready one -- the error
+          is seen by the caller when waiting on the handle.
+        */
+        if (pos)
+          *pos = i;
+        return RESULT_OK;
+      }
+    }
+  }
+}
+
+
 int STDCALL mysqlx_set_update_values(mysqlx_stmt_struct *stmt, ...)
 {
   SAFE_EXCEPTION_BEGIN(stmt, RESULT_ERROR)
@@ -872,6 +1034,41 @@ int STDCALL mysqlx_get_bytes(
 }
 
 
+int STDCALL mysqlx_get_bytes_ref(
+  mysqlx_row_struct* row,
+  uint32_t col,
+  const void **buf, size_t *buf_len
+)
+{
+  SAFE_EXCEPTION_BEGIN(row, RESULT_ERROR)
+  OUT_BUF_CHECK(buf, row, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+  OUT_BUF_CHECK(buf_len, row, MYSQLX_ERROR_OUTPUT_BUFFER_NULL, RESULT_ERROR)
+
+  CHECK_COLUMN_RANGE(col, row)
+
+  /*
+    Note: get_bytes() returns a view into the raw row data retained by
+    the row handle, so no copy is made here -- the caller borrows the
+    internal buffer.
+  */
+
+  bytes b = row->get_bytes(col);
+
+  if (b.size() == 0)
+  {
+    *buf = nullptr;
+    *buf_len = 0;
+    return RESULT_NULL;
+  }
+
+  *buf = b.begin();
+  *buf_len = b.size();
+  return RESULT_OK;
+
+  SAFE_EXCEPTION_END(row, RESULT_ERROR)
+}
+
+
 
 int STDCALL mysqlx_get_uint(mysqlx_row_struct* row, uint32_t col, uint64_t *val)
 {
@@ -149,6 +149,7 @@ struct mysqlx_session_struct
 {
   using Stmt_cache = std::forward_list<mysqlx_stmt_struct>;
   std::string m_savepoint_name;
+  bool m_batch = false;
 
 public:
 
@@ -210,6 +211,31 @@ public:
 
   cdk::Session &get_session() { return *(m_impl->m_sess); }
 
+  /*
+    Statement batching (see mysqlx_batch_begin()). While a batch is
+    active, commands of submitted statements are accumulated in the cdk
+    session pipeline and sent to the server in one shot when the batch
+    is flushed.
+  */
+
+  bool in_batch() const { return m_batch; }
+
+  void batch_begin()
+  {
+    if (m_batch)
+      throw Mysqlx_exception("Statement batch already active");
+    get_session().start_pipeline();
+    m_batch = true;
+  }
+
+  void batch_flush()
+  {
+    if (!m_batch)
+      throw Mysqlx_exception("No active statement batch");
+    m_batch = false;
+    get_session().flush_pipeline();
+  }
+
   /*
     Execute a plain SQL query (supports parameters and placeholders)
     PARAMETERS:
@@ -52,6 +52,52 @@ mysqlx_session_struct::mysqlx_session_struct(
   cdk::ds::Multi_source ds;
   opt->get_data_source(ds);
   m_impl = std::make_shared<Session_impl>(ds);
+
+  using Option = Settings_impl::Session_option_impl;
+
+  if (opt->has_option(MYSQLX_OPT_PREFETCH_ROWS))
+    m_impl->set_prefetch_rows(
+      (size_t)opt->get(Option::PREFETCH_ROWS).get_uint());
+
+  if (opt->has_option(MYSQLX_OPT_INSERT_CHUNK_SIZE))
+    m_impl->set_insert_chunk_size(
+      (size_t)opt->get(Option::INSERT_CHUNK_SIZE).get_uint());
+
+  if (opt->has_option(MYSQLX_OPT_METADATA_CACHE_TTL))
+    m_impl->set_metadata_cache_ttl(
+      opt->get(Option::METADATA_CACHE_TTL).get_uint());
+
+  if (opt->has_option(MYSQLX_OPT_MAX_RESULT_BUFFER))
+    m_impl->set_max_result_buffer(
+      (size_t)opt->get(Option::MAX_RESULT_BUFFER).get_uint());
+
+  if (opt->has_option(MYSQLX_OPT_PREPARE_THRESHOLD))
+    m_impl->set_prepare_threshold(
+      (size_t)opt->get(Option::PREPARE_THRESHOLD).get_uint());
+
+  if (opt->has_option(MYSQLX_OPT_SUBMIT_WINDOW))
+    m_impl->set_submit_window(
+      (size_t)opt->get(Option::SUBMIT_WINDOW).get_uint());
+
+  if (opt->has_option(MYSQLX_OPT_VALIDATED_TRANSPORT))
+    m_impl->set_validated_transport(
+      opt->get(Option::VALIDATED_TRANSPORT).get_bool());
+
+  if (opt->has_option(MYSQLX_OPT_STATEMENT_TIMEOUT))
+    m_impl->set_statement_timeout(
+      opt->get(Option::STATEMENT_TIMEOUT).get_uint());
+
+  if (opt->has_option(MYSQLX_OPT_AUTO_RECONNECT))
+    m_impl->set_auto_reconnect(
+      opt->get(Option::AUTO_RECONNECT).get_bool());
+
+  if (opt->has_option(MYSQLX_OPT_SKIP_WARNINGS))
+    m_impl->set_skip_warnings(
+      opt->get(Option::SKIP_WARNINGS).get_bool());
+
+  if (opt->has_option(MYSQLX_OPT_CONCURRENT_READS))
+    m_impl->set_concurrent_reads(
+      opt->get(Option::CONCURRENT_READS).get_bool());
 }
 
 